@@ -3221,6 +3221,10 @@
  *
  * Uncomment to set the maximum plaintext size of the incoming I/O buffer
  * independently of the outgoing I/O buffer.
+ *
+ * On memory-constrained builds that set tlsconfigMAX_FRAGMENT_LENGTH, and
+ * only connect to servers that accept the MFL extension, this can be lowered
+ * to the same value.
  */
 //#define MBEDTLS_SSL_IN_CONTENT_LEN              16384
 
@@ -75,6 +75,19 @@
     #define pkcs11configSUPPRESS_ECDSA_MECHANISM    0
 #endif
 
+/* @ingroup pkcs11_macros
+ * @brief Give each session its own DRBG.
+ *
+ * When set to 1, every session seeds a CTR-DRBG of its own from the module
+ * entropy source when it is opened. C_GenerateRandom, C_Sign and
+ * C_GenerateKeyPair then use it in stead of the module DRBG, so that sessions
+ * used by different tasks do not wait on the lock of one shared DRBG. Costs
+ * one mbedtls_ctr_drbg_context per session.
+ */
+#ifndef pkcs11configSESSION_DRBG
+    #define pkcs11configSESSION_DRBG    0
+#endif
+
 /**
  * @brief Represents string to be logged when mbedTLS returned error
  * does not contain a high-level code.
@@ -286,6 +299,9 @@ typedef struct P11Session
     CK_OBJECT_HANDLE xSignKeyHandle;             /**< @brief Object handle to the signing key. */
     mbedtls_pk_context xSignKey;                 /**< @brief Signing key.  Set during C_SignInit. */
     mbedtls_sha256_context xSHA256Context;       /**< @brief Context for in progress digest operation. */
+    #if ( pkcs11configSESSION_DRBG == 1 )
+        mbedtls_ctr_drbg_context xMbedDrbgCtx;   /**< @brief CTR-DRBG context for this session, seeded when the session is opened. */
+    #endif
 } P11Session_t;
 
 /*-----------------------------------------------------------*/
@@ -363,6 +379,23 @@ static P11Session_t * prvSessionPointerFromHandle( CK_SESSION_HANDLE xSession )
     return pxSession;
 }
 
+/**
+ * @brief Returns the DRBG that a session draws random numbers from.
+ */
+static mbedtls_ctr_drbg_context * prvSessionDrbg( P11Session_t * pxSession )
+{
+    mbedtls_ctr_drbg_context * pxDrbg = NULL;
+
+    #if ( pkcs11configSESSION_DRBG == 1 )
+        pxDrbg = &pxSession->xMbedDrbgCtx;
+    #else
+        ( void ) pxSession;
+        pxDrbg = &xP11Context.xMbedDrbgCtx;
+    #endif
+
+    return pxDrbg;
+}
+
 /**
  * @brief Determines if an operation is in progress.
  */
@@ -1901,6 +1934,10 @@ CK_DECLARE_FUNCTION( CK_RV, C_OpenSession )( CK_SLOT_ID slotID,
     P11Session_t * pxSessionObj = NULL;
     uint32_t ulSessionCount = 0;
 
+    #if ( pkcs11configSESSION_DRBG == 1 )
+        int32_t lMbedTLSResult = 0;
+    #endif
+
     ( void ) ( slotID );
     ( void ) ( pApplication );
 
@@ -1987,6 +2024,28 @@ CK_DECLARE_FUNCTION( CK_RV, C_OpenSession )( CK_SLOT_ID slotID,
                 xResult = CKR_HOST_MEMORY;
             }
         }
+
+        #if ( pkcs11configSESSION_DRBG == 1 )
+            if( CKR_OK == xResult )
+            {
+                /* The session address keeps the DRBGs of sessions that are
+                 * seeded at the same time apart. */
+                mbedtls_ctr_drbg_init( &pxSessionObj->xMbedDrbgCtx );
+                lMbedTLSResult = mbedtls_ctr_drbg_seed( &pxSessionObj->xMbedDrbgCtx,
+                                                        mbedtls_entropy_func,
+                                                        &xP11Context.xMbedEntropyContext,
+                                                        ( const unsigned char * ) &pxSessionObj,
+                                                        sizeof( pxSessionObj ) );
+
+                if( 0 != lMbedTLSResult )
+                {
+                    LogError( ( "Could not open a session. Failed to seed the session DRBG: mbed TLS error = %s : %s.",
+                                mbedtlsHighLevelCodeOrDefault( lMbedTLSResult ),
+                                mbedtlsLowLevelCodeOrDefault( lMbedTLSResult ) ) );
+                    xResult = CKR_FUNCTION_FAILED;
+                }
+            }
+        #endif /* if ( pkcs11configSESSION_DRBG == 1 ) */
     }
 
     if( CKR_OK == xResult )
@@ -2032,6 +2091,10 @@ CK_DECLARE_FUNCTION( CK_RV, C_OpenSession )( CK_SLOT_ID slotID,
                 vSemaphoreDelete( pxSessionObj->xVerifyMutex );
             }
 
+            #if ( pkcs11configSESSION_DRBG == 1 )
+                mbedtls_ctr_drbg_free( &pxSessionObj->xMbedDrbgCtx );
+            #endif
+
             ( void ) memset( pxSessionObj, 0, sizeof( P11Session_t ) );
             *phSession = CK_INVALID_HANDLE;
         }
@@ -2102,6 +2165,10 @@ CK_DECLARE_FUNCTION( CK_RV, C_CloseSession )( CK_SESSION_HANDLE hSession )
 
         mbedtls_sha256_free( &pxSession->xSHA256Context );
 
+        #if ( pkcs11configSESSION_DRBG == 1 )
+            mbedtls_ctr_drbg_free( &pxSession->xMbedDrbgCtx );
+        #endif
+
         /* memset clears the open flag, so there is no need to set it to CK_FALSE */
         ( void ) memset( pxSession, 0, sizeof( P11Session_t ) );
         LogInfo( ( "Successfully closed PKCS #11 session." ) );
@@ -3996,7 +4063,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE hSession,
                                                       pxSignatureBuffer,
                                                       &xExpectedInputLength,
                                                       mbedtls_ctr_drbg_random,
-                                                      &xP11Context.xMbedDrbgCtx );
+                                                      prvSessionDrbg( pxSessionObj ) );
 
                     if( lMbedTLSResult != 0 )
                     {
@@ -4731,7 +4798,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_GenerateKeyPair )( CK_SESSION_HANDLE hSession,
     uint32_t xPrivateRequiredAttributeMap = ( LABEL_IN_TEMPLATE | PRIVATE_IN_TEMPLATE | SIGN_IN_TEMPLATE );
     uint32_t xAttributeMap = 0;
 
-    const P11Session_t * pxSession = prvSessionPointerFromHandle( hSession );
+    P11Session_t * pxSession = prvSessionPointerFromHandle( hSession );
     CK_RV xResult = prvCheckValidSessionAndModule( pxSession );
 
     #if ( pkcs11configSUPPRESS_ECDSA_MECHANISM == 1 )
@@ -4846,7 +4913,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_GenerateKeyPair )( CK_SESSION_HANDLE hSession,
         lMbedTLSResult = mbedtls_ecp_gen_key( MBEDTLS_ECP_DP_SECP256R1,
                                               mbedtls_pk_ec( xCtx ),
                                               mbedtls_ctr_drbg_random,
-                                              &xP11Context.xMbedDrbgCtx );
+                                              prvSessionDrbg( pxSession ) );
 
         if( 0 != lMbedTLSResult )
         {
@@ -4947,7 +5014,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_GenerateRandom )( CK_SESSION_HANDLE hSession,
     CK_RV xResult = CKR_OK;
     int32_t lMbedTLSResult = 0;
 
-    const P11Session_t * pxSession = prvSessionPointerFromHandle( hSession );
+    P11Session_t * pxSession = prvSessionPointerFromHandle( hSession );
 
     xResult = prvCheckValidSessionAndModule( pxSession );
 
@@ -4961,7 +5028,7 @@ CK_DECLARE_FUNCTION( CK_RV, C_GenerateRandom )( CK_SESSION_HANDLE hSession,
 
     if( xResult == CKR_OK )
     {
-        lMbedTLSResult = mbedtls_ctr_drbg_random( &xP11Context.xMbedDrbgCtx, RandomData, ulRandomLen );
+        lMbedTLSResult = mbedtls_ctr_drbg_random( prvSessionDrbg( pxSession ), RandomData, ulRandomLen );
 
         if( lMbedTLSResult != 0 )
         {
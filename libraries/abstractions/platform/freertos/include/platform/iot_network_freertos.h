@@ -159,6 +159,23 @@ size_t IotNetworkAfr_ReceiveUpto( void * pConnection,
                                   uint8_t * pBuffer,
                                   size_t bufferSize );
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+/**
+ * @brief An implementation of #IotNetworkInterface_t::peek for FreeRTOS
+ * Secure Sockets.
+ */
+    size_t IotNetworkAfr_Peek( void * pConnection,
+                               const uint8_t ** pBuffer );
+
+/**
+ * @brief An implementation of #IotNetworkInterface_t::consume for FreeRTOS
+ * Secure Sockets.
+ */
+    void IotNetworkAfr_Consume( void * pConnection,
+                                size_t bytesConsumed );
+#endif
+
 /**
  * @brief An implementation of #IotNetworkInterface_t::close for FreeRTOS
  * Secure Sockets.
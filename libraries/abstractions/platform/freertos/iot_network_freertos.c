@@ -108,7 +108,11 @@ const IotNetworkInterface_t IotNetworkAfr =
     .receive            = IotNetworkAfr_Receive,
     .receiveUpto        = IotNetworkAfr_ReceiveUpto,
     .close              = IotNetworkAfr_Close,
-    .destroy            = IotNetworkAfr_Destroy
+    .destroy            = IotNetworkAfr_Destroy,
+    #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+        .peek           = IotNetworkAfr_Peek,
+        .consume        = IotNetworkAfr_Consume
+    #endif
 };
 
 /*-----------------------------------------------------------*/
@@ -145,6 +149,10 @@ static void _networkReceiveTask( void * pArgument )
     int32_t socketStatus = 0;
     EventBits_t connectionFlags = 0;
 
+    #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+        const void * pData = NULL;
+    #endif
+
     /* Cast network connection to the correct type. */
     _networkConnection_t * pNetworkConnection = pArgument;
 
@@ -158,10 +166,18 @@ static void _networkReceiveTask( void * pArgument )
          * MULTIPLE CALLS OF RECEIVE. */
         do
         {
-            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                         &( pNetworkConnection->bufferedByte ),
-                                         1,
-                                         0 );
+            #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+                /* Wait for data without taking it from the socket, so that no
+                 * byte needs to be buffered. */
+                socketStatus = SOCKETS_Peek( pNetworkConnection->socket,
+                                             &pData,
+                                             0 );
+            #else
+                socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                             &( pNetworkConnection->bufferedByte ),
+                                             1,
+                                             0 );
+            #endif
 
             connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
 
@@ -178,7 +194,9 @@ static void _networkReceiveTask( void * pArgument )
             break;
         }
 
-        pNetworkConnection->bufferedByteValid = true;
+        #if ( socketsconfigENABLE_ZERO_COPY_RECV == 0 )
+            pNetworkConnection->bufferedByteValid = true;
+        #endif
 
         /* Invoke the network callback. */
         pNetworkConnection->receiveCallback( pNetworkConnection,
@@ -232,6 +250,7 @@ static IotNetworkError_t _tlsSetup( const IotNetworkCredentials_t * pAfrCredenti
 {
     IOT_FUNCTION_ENTRY( IotNetworkError_t, IOT_NETWORK_SUCCESS );
     int32_t socketStatus = SOCKETS_ERROR_NONE;
+    uint32_t maxFragmentLength = 0;
 
     /* ALPN options for AWS IoT. */
     const char * ppcALPNProtos[] = { socketsAWS_IOT_ALPN_MQTT };
@@ -265,6 +284,23 @@ static IotNetworkError_t _tlsSetup( const IotNetworkCredentials_t * pAfrCredenti
         }
     }
 
+    /* Set the maximum fragment length, if requested. */
+    if( pAfrCredentials->maxFragmentLength != 0 )
+    {
+        maxFragmentLength = ( uint32_t ) pAfrCredentials->maxFragmentLength;
+        socketStatus = SOCKETS_SetSockOpt( tcpSocket,
+                                           0,
+                                           SOCKETS_SO_MAX_FRAGMENT_LENGTH,
+                                           &maxFragmentLength,
+                                           sizeof( maxFragmentLength ) );
+
+        if( socketStatus != SOCKETS_ERROR_NONE )
+        {
+            IotLogError( "Failed to set max fragment length option for new connection." );
+            IOT_SET_AND_GOTO_CLEANUP( IOT_NETWORK_SYSTEM_ERROR );
+        }
+    }
+
     /* Set SNI option. */
     if( pAfrCredentials->disableSni == false )
     {
@@ -625,6 +661,67 @@ size_t IotNetworkAfr_ReceiveUpto( void * pConnection,
 
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+    size_t IotNetworkAfr_Peek( void * pConnection,
+                               const uint8_t ** pBuffer )
+    {
+        int32_t socketStatus = 0;
+        size_t bytesAvailable = 0;
+        const void * pData = NULL;
+
+        /* Cast network connection to the correct type. */
+        _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
+
+        /* The receive task does not buffer a byte when data is peeked. */
+        configASSERT( pNetworkConnection->bufferedByteValid == false );
+
+        /* Block and wait for incoming data. */
+        do
+        {
+            socketStatus = SOCKETS_Peek( pNetworkConnection->socket,
+                                         &pData,
+                                         0 );
+
+            /* The return value EWOULDBLOCK means no data was received within
+             * the socket timeout. Ignore it and try again. */
+        } while( socketStatus == SOCKETS_EWOULDBLOCK );
+
+        if( socketStatus <= 0 )
+        {
+            IotLogError( "Error %ld while receiving data.", ( long int ) socketStatus );
+        }
+        else
+        {
+            *pBuffer = ( const uint8_t * ) pData;
+            bytesAvailable = ( size_t ) socketStatus;
+        }
+
+        return bytesAvailable;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void IotNetworkAfr_Consume( void * pConnection,
+                                size_t bytesConsumed )
+    {
+        int32_t socketStatus = 0;
+
+        /* Cast network connection to the correct type. */
+        _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
+
+        socketStatus = SOCKETS_Consume( pNetworkConnection->socket, bytesConsumed );
+
+        if( socketStatus != SOCKETS_ERROR_NONE )
+        {
+            IotLogError( "Error %ld while consuming received data.", ( long int ) socketStatus );
+        }
+    }
+
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 IotNetworkError_t IotNetworkAfr_Close( void * pConnection )
 {
     int32_t socketStatus = SOCKETS_ERROR_NONE;
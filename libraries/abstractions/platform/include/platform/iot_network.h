@@ -71,6 +71,10 @@ typedef enum IotNetworkError
  * @function_brief{platform_network_function_receive}
  * - @function_name{platform_network_function_receiveupto}
  * @function_brief{platform_network_function_receiveupto}
+ * - @function_name{platform_network_function_peek}
+ * @function_brief{platform_network_function_peek}
+ * - @function_name{platform_network_function_consume}
+ * @function_brief{platform_network_function_consume}
  * - @function_name{platform_network_function_close}
  * @function_brief{platform_network_function_close}
  * - @function_name{platform_network_function_destroy}
@@ -95,6 +99,12 @@ typedef enum IotNetworkError
  * @function_page{IotNetworkInterface_t::receiveUpto,platform_network,receiveupto}
  * @function_snippet{platform_network,receiveupto,this}
  * @copydoc IotNetworkInterface_t::receiveUpto
+ * @function_page{IotNetworkInterface_t::peek,platform_network,peek}
+ * @function_snippet{platform_network,peek,this}
+ * @copydoc IotNetworkInterface_t::peek
+ * @function_page{IotNetworkInterface_t::consume,platform_network,consume}
+ * @function_snippet{platform_network,consume,this}
+ * @copydoc IotNetworkInterface_t::consume
  * @function_page{IotNetworkInterface_t::close,platform_network,close}
  * @function_snippet{platform_network,close,this}
  * @copydoc IotNetworkInterface_t::close
@@ -281,6 +291,44 @@ typedef struct IotNetworkInterface
     /* @[declare_platform_network_destroy] */
     IotNetworkError_t ( * destroy )( void * pConnection );
     /* @[declare_platform_network_destroy] */
+
+    /**
+     * @brief Give access to incoming data without copying it.
+     *
+     * Waits for incoming data like @ref platform_network_function_receive,
+     * but leaves it in the buffers of the network stack. The data is not
+     * removed until [consume](@ref platform_network_function_consume) is called,
+     * so calling this function again returns the same data. The data may be
+     * only a part of what has been received.
+     *
+     * This function is optional and may be `NULL`. When it is `NULL`, `consume`
+     * must be `NULL` as well.
+     *
+     * @param[in] pConnection The connection to receive data on, defined by
+     * the network stack.
+     * @param[out] pBuffer Set to the first byte that has not been consumed yet.
+     *
+     * @return The number of bytes available at `*pBuffer`, or 0 on error or
+     * timeout.
+     */
+    /* @[declare_platform_network_peek] */
+    size_t ( * peek )( void * pConnection,
+                       const uint8_t ** pBuffer );
+    /* @[declare_platform_network_peek] */
+
+    /**
+     * @brief Remove incoming data that was returned by
+     * [peek](@ref platform_network_function_peek).
+     *
+     * @param[in] pConnection The connection to receive data on, defined by
+     * the network stack.
+     * @param[in] bytesConsumed The number of bytes to remove, at most the
+     * number returned by the last call to `peek`.
+     */
+    /* @[declare_platform_network_consume] */
+    void ( * consume )( void * pConnection,
+                        size_t bytesConsumed );
+    /* @[declare_platform_network_consume] */
 } IotNetworkInterface_t;
 
 /**
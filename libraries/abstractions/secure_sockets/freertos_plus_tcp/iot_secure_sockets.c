@@ -55,6 +55,7 @@ typedef struct SSOCKETContext
     uint32_t ulServerCertificateLength;
     char ** ppcAlpnProtocols;
     uint32_t ulAlpnProtocolsCount;
+    uint32_t ulMaxFragmentLength;
     BaseType_t xConnectAttempted;
 } SSOCKETContext_t, * SSOCKETContextPtr_t;
 
@@ -177,10 +178,12 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
         {
             xTLSParams.ulSize = sizeof( xTLSParams );
             xTLSParams.pcDestination = pxContext->pcDestination;
+            xTLSParams.usDestinationPort = pxAddress->usPort;
             xTLSParams.pcServerCertificate = pxContext->pcServerCertificate;
             xTLSParams.ulServerCertificateLength = pxContext->ulServerCertificateLength;
             xTLSParams.ppcAlpnProtocols = ( const char ** ) pxContext->ppcAlpnProtocols;
             xTLSParams.ulAlpnProtocolsCount = pxContext->ulAlpnProtocolsCount;
+            xTLSParams.ulMaxFragmentLength = pxContext->ulMaxFragmentLength;
             xTLSParams.pvCallerContext = pxContext;
             xTLSParams.pxNetworkRecv = prvNetworkRecv;
             xTLSParams.pxNetworkSend = prvNetworkSend;
@@ -245,6 +248,83 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+    int32_t SOCKETS_Peek( Socket_t xSocket,
+                          const void ** ppvData,
+                          uint32_t ulFlags )
+    {
+        int32_t lStatus = SOCKETS_SOCKET_ERROR;
+        SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+        const unsigned char * pucData = NULL;
+
+        if( ( xSocket != SOCKETS_INVALID_SOCKET ) &&
+            ( ppvData != NULL ) )
+        {
+            pxContext->xRecvFlags = ( BaseType_t ) ulFlags;
+
+            if( pdTRUE == pxContext->xRequireTLS )
+            {
+                /* Point into the TLS record buffer, if negotiated. */
+                lStatus = TLS_Peek( pxContext->pvTLSContext, &pucData );
+            }
+            else
+            {
+                /* Point into the stream buffer of the TCP socket. */
+                lStatus = FreeRTOS_recv( pxContext->xSocket, &pucData, 0, FREERTOS_ZERO_COPY );
+            }
+
+            if( lStatus > 0 )
+            {
+                *ppvData = pucData;
+            }
+        }
+        else
+        {
+            lStatus = SOCKETS_EINVAL;
+        }
+
+        return lStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    int32_t SOCKETS_Consume( Socket_t xSocket,
+                             size_t xLength )
+    {
+        int32_t lStatus = SOCKETS_ERROR_NONE;
+        SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+
+        if( xSocket != SOCKETS_INVALID_SOCKET )
+        {
+            if( pdTRUE == pxContext->xRequireTLS )
+            {
+                TLS_Consume( pxContext->pvTLSContext, xLength );
+            }
+            else if( xLength > 0U )
+            {
+                /* A receive without a buffer drops the data. */
+                lStatus = FreeRTOS_recv( pxContext->xSocket, NULL, xLength, 0 );
+
+                if( lStatus >= 0 )
+                {
+                    lStatus = SOCKETS_ERROR_NONE;
+                }
+            }
+            else
+            {
+                /* Nothing to consume. */
+            }
+        }
+        else
+        {
+            lStatus = SOCKETS_EINVAL;
+        }
+
+        return lStatus;
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
 int32_t SOCKETS_Send( Socket_t xSocket,
                       const void * pvBuffer,
                       size_t xDataLength,
@@ -404,6 +484,37 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 
                 break;
 
+            case SOCKETS_SO_MAX_FRAGMENT_LENGTH:
+
+                /* Do not set the fragment length if the socket is possibly already connected. */
+                if( pxContext->xConnectAttempted == pdTRUE )
+                {
+                    lStatus = SOCKETS_EISCONN;
+                }
+                else if( ( NULL == pvOptionValue ) || ( sizeof( uint32_t ) != xOptionLength ) )
+                {
+                    lStatus = SOCKETS_EINVAL;
+                }
+                else
+                {
+                    /* Only the lengths of RFC 6066 can be negotiated. */
+                    switch( *( ( const uint32_t * ) pvOptionValue ) ) /*lint !e9087 pvOptionValue passed should be of uint32_t */
+                    {
+                        case 512U:
+                        case 1024U:
+                        case 2048U:
+                        case 4096U:
+                            pxContext->ulMaxFragmentLength = *( ( const uint32_t * ) pvOptionValue ); /*lint !e9087 pvOptionValue passed should be of uint32_t */
+                            break;
+
+                        default:
+                            lStatus = SOCKETS_EINVAL;
+                            break;
+                    }
+                }
+
+                break;
+
             case SOCKETS_SO_NONBLOCK:
                 xTimeout = 0;
 
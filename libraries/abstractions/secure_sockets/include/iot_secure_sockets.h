@@ -167,6 +167,7 @@ typedef struct xSOCKET * Socket_t; /**< @brief Socket handle data type. */
 #define SOCKETS_SO_REQUIRE_TLS                   ( 8 )  /**< Toggle client enforcement of TLS. */
 #define SOCKETS_SO_NONBLOCK                      ( 9 )  /**< Socket is nonblocking. */
 #define SOCKETS_SO_ALPN_PROTOCOLS                ( 10 ) /**< Application protocol list to be included in TLS ClientHello. */
+#define SOCKETS_SO_MAX_FRAGMENT_LENGTH           ( 11 ) /**< Largest TLS record that the server may send, as a uint32_t: 512, 1024, 2048 or 4096. */
 #define SOCKETS_SO_WAKEUP_CALLBACK               ( 17 ) /**< Set the callback to be called whenever there is data available on the socket for reading. */
 
 /**@} */
@@ -317,6 +318,45 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
                       uint32_t ulFlags );
 /* @[declare_secure_sockets_recv] */
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+/**
+ * @brief Gives access to received data without copying it.
+ *
+ * Waits for data like SOCKETS_Recv() does, but leaves the data where the
+ * network stack keeps it: the decrypted TLS record of a secure socket, or the
+ * TCP stream buffer. The data is not removed until SOCKETS_Consume() is called,
+ * so calling SOCKETS_Peek() again returns the same data. The data may be only
+ * a part of what has been received.
+ *
+ * @param[in] xSocket The handle of the socket from which data is being received.
+ * @param[out] ppvData Set to the first byte that has not been consumed yet.
+ * @param[in] ulFlags Not currently used. Should be set to 0.
+ *
+ * @return
+ * * The number of bytes available at *ppvData.
+ * * If a timeout occurred before data could be received then 0 is returned.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+    int32_t SOCKETS_Peek( Socket_t xSocket,
+                          const void ** ppvData,
+                          uint32_t ulFlags );
+
+/**
+ * @brief Removes data that was returned by SOCKETS_Peek().
+ *
+ * @param[in] xSocket The handle of the socket from which data is being received.
+ * @param[in] xLength The number of bytes to remove, at most the number that
+ * was returned by the last call to SOCKETS_Peek().
+ *
+ * @return
+ * * @ref SOCKETS_ERROR_NONE if the data was removed.
+ * * If an error occurred, a negative value is returned. @ref SocketsErrors
+ */
+    int32_t SOCKETS_Consume( Socket_t xSocket,
+                             size_t xLength );
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
 /**
  * @brief Transmit data to the remote socket.
  *
@@ -472,6 +512,10 @@ int32_t SOCKETS_Close( Socket_t xSocket );
  *      - The ALPN list is expressed as an array of NULL-terminated ANSI
  *        strings.
  *      - xOptionLength is the number of items in the array.
+ *    - @ref SOCKETS_SO_MAX_FRAGMENT_LENGTH
+ *      - Ask the server to send TLS records of at most this many bytes.
+ *      - pvOptionValue is a pointer to a uint32_t of 512, 1024, 2048 or 4096.
+ *      - xOptionLength is sizeof( uint32_t ).
  *
  * @return
  * * On success, 0 is returned.
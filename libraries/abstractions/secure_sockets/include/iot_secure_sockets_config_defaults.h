@@ -69,4 +69,16 @@
     #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 0 )
 #endif
 
+/**
+ * @brief By default, zero-copy receive is disabled.
+ *
+ * When set to 1, SOCKETS_Peek and SOCKETS_Consume give access to received
+ * data in place: in the TLS record buffer for secure sockets, or in the TCP
+ * stream buffer otherwise. Only ports that implement these functions support
+ * this option.
+ */
+#ifndef socketsconfigENABLE_ZERO_COPY_RECV
+    #define socketsconfigENABLE_ZERO_COPY_RECV    ( 0 )
+#endif
+
 #endif /* AWS_INC_SECURE_SOCKETS_CONFIG_DEFAULTS_H_ */
@@ -112,6 +112,7 @@ typedef struct _ss_ctx_t
 
     char ** ppcAlpnProtocols;
     uint32_t ulAlpnProtocolsCount;
+    uint32_t ulMaxFragmentLength;
     uint32_t ulRefcount;
 } ss_ctx_t;
 
@@ -443,6 +444,7 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
 
         tls_params.ulSize = sizeof( tls_params );
         tls_params.pcDestination = ctx->destination;
+        tls_params.usDestinationPort = pxAddress->usPort;
         tls_params.pcServerCertificate = ctx->server_cert;
         tls_params.ulServerCertificateLength = ctx->server_cert_len;
         tls_params.pvCallerContext = ctx;
@@ -450,6 +452,7 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
         tls_params.pxNetworkSend = prvNetworkSend;
         tls_params.ppcAlpnProtocols = ( const char ** ) ctx->ppcAlpnProtocols;
         tls_params.ulAlpnProtocolsCount = ctx->ulAlpnProtocolsCount;
+        tls_params.ulMaxFragmentLength = ctx->ulMaxFragmentLength;
 
         status = TLS_Init( &ctx->tls_ctx, &tls_params );
 
@@ -809,6 +812,34 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 
             break;
 
+        case SOCKETS_SO_MAX_FRAGMENT_LENGTH:
+
+            if( ctx->status & SS_STATUS_CONNECTED )
+            {
+                return SOCKETS_EISCONN;
+            }
+
+            if( ( NULL == pvOptionValue ) || ( sizeof( uint32_t ) != xOptionLength ) )
+            {
+                return SOCKETS_EINVAL;
+            }
+
+            /* Only the lengths of RFC 6066 can be negotiated. */
+            switch( *( const uint32_t * ) pvOptionValue )
+            {
+                case 512:
+                case 1024:
+                case 2048:
+                case 4096:
+                    ctx->ulMaxFragmentLength = *( const uint32_t * ) pvOptionValue;
+                    break;
+
+                default:
+                    return SOCKETS_EINVAL;
+            }
+
+            break;
+
         default:
             return SOCKETS_ENOPROTOOPT;
     }
@@ -1092,6 +1092,9 @@ TEST_GROUP_RUNNER( Full_TCP )
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Shutdown );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Close );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Recv_ByteByByte );
+    #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+        RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_PeekConsume );
+    #endif
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_SendRecv_VaryLength );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Socket_ConcurrentCount );
     RUN_TEST_CASE( Full_TCP, AFQP_SOCKETS_Socket_InvalidInputParams );
@@ -1117,6 +1120,9 @@ TEST_GROUP_RUNNER( Full_TCP )
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Shutdown );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Close );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_Recv_ByteByByte );
+        #if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+            RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_PeekConsume );
+        #endif
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_SendRecv_VaryLength );
         /* SECURE_SOCKETS_Socket_InvalidTooManySockets has not been implemented. */
         /*SECURE_SOCKETS_Socket_InvalidInputParams DNE.*/
@@ -1898,6 +1904,73 @@ TEST( Full_TCP, AFQP_SECURE_SOCKETS_Recv_ByteByByte )
 
 /*-----------------------------------------------------------*/
 
+#if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 )
+
+/* Receives an echoed message with SOCKETS_Peek() and SOCKETS_Consume(), a
+ * few bytes at a time, so that most of the data returned by a peek is left
+ * for the next one. */
+    static void prvSOCKETS_PeekConsume( Server_t xConn )
+    {
+        BaseType_t xResult = pdFAIL;
+        int32_t lPeeked;
+        int32_t lPeekedAgain;
+        size_t xConsumed;
+        size_t xBytesReceived = 0;
+        const size_t xMessageLength = 100;
+        const uint8_t * pucData = NULL;
+        const uint8_t * pucDataAgain = NULL;
+        uint8_t * pucTxBuffer = ( uint8_t * ) pcTxBuffer;
+
+        /* Attempt to establish the requested connection. */
+        xResult = prvConnectHelperWithRetry( &xSocket, xConn, xReceiveTimeOut, xSendTimeOut, &xSocketOpen );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Failed to connect" );
+
+        prvCreateTxData( ( char * ) pucTxBuffer, xMessageLength, 0 );
+        xResult = prvSendHelper( xSocket, pucTxBuffer, xMessageLength );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( pdPASS, xResult, "Data failed to send" );
+
+        while( xBytesReceived < xMessageLength )
+        {
+            lPeeked = SOCKETS_Peek( xSocket, ( const void ** ) &pucData, 0 );
+            TEST_ASSERT_GREATER_THAN_INT32_MESSAGE( 0, lPeeked, "SOCKETS_Peek returned no data" );
+            TEST_ASSERT_LESS_OR_EQUAL_UINT32( xMessageLength - xBytesReceived, ( uint32_t ) lPeeked );
+            TEST_ASSERT_EQUAL_UINT8_ARRAY( &pucTxBuffer[ xBytesReceived ], pucData, lPeeked );
+
+            /* Nothing is removed until it is consumed. */
+            lPeekedAgain = SOCKETS_Peek( xSocket, ( const void ** ) &pucDataAgain, 0 );
+            TEST_ASSERT_EQUAL_INT32( lPeeked, lPeekedAgain );
+            TEST_ASSERT_EQUAL_PTR( pucData, pucDataAgain );
+
+            xConsumed = ( lPeeked < 7 ) ? ( size_t ) lPeeked : 7U;
+            xResult = SOCKETS_Consume( xSocket, xConsumed );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "SOCKETS_Consume failed" );
+            xBytesReceived += xConsumed;
+        }
+
+        xResult = prvShutdownHelper( xSocket );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to shutdown" );
+
+        xResult = prvCloseHelper( xSocket, &xSocketOpen );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to close" );
+    }
+
+    TEST( Full_TCP, AFQP_SOCKETS_PeekConsume )
+    {
+        tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+        prvSOCKETS_PeekConsume( eNonsecure );
+    }
+
+    TEST( Full_TCP, AFQP_SECURE_SOCKETS_PeekConsume )
+    {
+        tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+        prvSOCKETS_PeekConsume( eSecure );
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( socketsconfigENABLE_ZERO_COPY_RECV == 1 ) */
+
 static void prvSOCKETS_SendRecv_VaryLength( Server_t xConn )
 {
     BaseType_t xResult;
@@ -2032,6 +2032,7 @@ static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsC
     IotHttpsReturnCode_t parserStatus = IOT_HTTPS_OK;
     IotHttpsReturnCode_t networkStatus = IOT_HTTPS_OK;
     size_t numBytesRecv = 0;
+    const uint8_t * pReceivedData = NULL;
 
     /* Disable -Wunused-but-set-variable for local variables used for logging. */
     ( void ) pHttpParserErrorDescription;
@@ -2040,11 +2041,34 @@ static IotHttpsReturnCode_t _flushHttpsNetworkData( _httpsConnection_t * pHttpsC
     while( pHttpsResponse->parserState < PARSER_STATE_BODY_COMPLETE )
     {
         IotLogDebug( "Now clearing the rest of the response data on the socket. " );
-        networkStatus = _networkRecv( pHttpsConnection, flushBuffer, IOT_HTTPS_MAX_FLUSH_BUFFER_SIZE, &numBytesRecv );
+
+        if( pHttpsConnection->pNetworkInterface->peek != NULL )
+        {
+            /* The data is thrown away, so parse it where the network stack has received it. */
+            numBytesRecv = pHttpsConnection->pNetworkInterface->peek( pHttpsConnection->pNetworkConnection,
+                                                                      &pReceivedData );
+
+            if( numBytesRecv == 0 )
+            {
+                IotLogError( "Error in receiving the HTTPS response message." );
+                networkStatus = IOT_HTTPS_NETWORK_ERROR;
+            }
+        }
+        else
+        {
+            networkStatus = _networkRecv( pHttpsConnection, flushBuffer, IOT_HTTPS_MAX_FLUSH_BUFFER_SIZE, &numBytesRecv );
+            pReceivedData = flushBuffer;
+        }
 
         /* Run this through the parser so that we can get the end of the HTTP message, instead of simply timing out the socket to stop.
          * If we relied on the socket timeout to stop reading the network socket, then the server may close the connection. */
-        parserStatus = _parseHttpsMessage( &( pHttpsResponse->httpParserInfo ), ( char * ) flushBuffer, numBytesRecv );
+        parserStatus = _parseHttpsMessage( &( pHttpsResponse->httpParserInfo ), ( char * ) pReceivedData, numBytesRecv );
+
+        if( ( pHttpsConnection->pNetworkInterface->peek != NULL ) && ( numBytesRecv > 0 ) )
+        {
+            pHttpsConnection->pNetworkInterface->consume( pHttpsConnection->pNetworkConnection,
+                                                          numBytesRecv );
+        }
 
         if( HTTPS_FAILED( parserStatus ) )
         {
@@ -140,6 +140,7 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 {
     IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
     size_t dataBytesRead = 0;
+    const uint8_t * pReceivedData = NULL;
 
     /* Default functions for retrieving packet type and length. */
     uint8_t ( * getPacketType )( void *,
@@ -210,8 +211,32 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
         EMPTY_ELSE_MARKER;
     }
 
+    /* Use the remaining data where the network stack has received it, if the
+     * whole packet is there. PUBLISH packets are kept after the receive callback
+     * returns, so they are always copied. */
+    if( ( pIncomingPacket->remainingLength > 0 ) &&
+        ( ( pIncomingPacket->type & 0xf0 ) != MQTT_PACKET_TYPE_PUBLISH ) &&
+        ( pMqttConnection->pNetworkInterface->peek != NULL ) )
+    {
+        if( pMqttConnection->pNetworkInterface->peek( pNetworkConnection,
+                                                      &pReceivedData ) >= pIncomingPacket->remainingLength )
+        {
+            pIncomingPacket->pRemainingData = ( uint8_t * ) pReceivedData;
+            pIncomingPacket->remainingDataInPlace = true;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Allocate a buffer for the remaining data and read the data. */
-    if( pIncomingPacket->remainingLength > 0 )
+    if( ( pIncomingPacket->remainingLength > 0 ) &&
+        ( pIncomingPacket->remainingDataInPlace == false ) )
     {
         pIncomingPacket->pRemainingData = IotMqtt_MallocMessage( pIncomingPacket->remainingLength );
 
@@ -255,7 +280,8 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 
     if( status != IOT_MQTT_SUCCESS )
     {
-        if( pIncomingPacket->pRemainingData != NULL )
+        if( ( pIncomingPacket->pRemainingData != NULL ) &&
+            ( pIncomingPacket->remainingDataInPlace == false ) )
         {
             IotMqtt_FreeMessage( pIncomingPacket->pRemainingData );
         }
@@ -753,14 +779,44 @@ static void _flushPacket( void * pNetworkConnection,
                           const _mqttConnection_t * pMqttConnection,
                           size_t length )
 {
-    size_t bytesFlushed = 0;
+    size_t bytesFlushed = 0, bytesAvailable = 0;
     uint8_t receivedByte = 0;
+    const uint8_t * pReceivedData = NULL;
+
+    if( pMqttConnection->pNetworkInterface->peek != NULL )
+    {
+        /* Drop the data in place, as much as has been received at a time. */
+        while( bytesFlushed < length )
+        {
+            bytesAvailable = pMqttConnection->pNetworkInterface->peek( pNetworkConnection,
+                                                                       &pReceivedData );
+
+            if( bytesAvailable == 0 )
+            {
+                break;
+            }
+            else if( bytesAvailable > length - bytesFlushed )
+            {
+                bytesAvailable = length - bytesFlushed;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
 
-    for( bytesFlushed = 0; bytesFlushed < length; bytesFlushed++ )
+            pMqttConnection->pNetworkInterface->consume( pNetworkConnection,
+                                                         bytesAvailable );
+            bytesFlushed += bytesAvailable;
+        }
+    }
+    else
     {
-        ( void ) _IotMqtt_GetNextByte( pNetworkConnection,
-                                       pMqttConnection->pNetworkInterface,
-                                       &receivedByte );
+        for( bytesFlushed = 0; bytesFlushed < length; bytesFlushed++ )
+        {
+            ( void ) _IotMqtt_GetNextByte( pNetworkConnection,
+                                           pMqttConnection->pNetworkInterface,
+                                           &receivedByte );
+        }
     }
 }
 
@@ -773,11 +829,30 @@ bool _IotMqtt_GetNextByte( void * pNetworkConnection,
     bool status = false;
     uint8_t incomingByte = 0;
     size_t bytesReceived = 0;
+    const uint8_t * pReceivedData = NULL;
 
-    /* Attempt to read 1 byte. */
-    bytesReceived = pNetworkInterface->receive( pNetworkConnection,
-                                                &incomingByte,
-                                                1 );
+    if( pNetworkInterface->peek != NULL )
+    {
+        /* Take 1 byte from the received data in place, which is cheaper than
+         * a receive of 1 byte. */
+        if( pNetworkInterface->peek( pNetworkConnection, &pReceivedData ) > 0 )
+        {
+            incomingByte = *pReceivedData;
+            pNetworkInterface->consume( pNetworkConnection, 1 );
+            bytesReceived = 1;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        /* Attempt to read 1 byte. */
+        bytesReceived = pNetworkInterface->receive( pNetworkConnection,
+                                                    &incomingByte,
+                                                    1 );
+    }
 
     /* Set the output parameter and return success if 1 byte was read. */
     if( bytesReceived == 1 )
@@ -920,8 +995,14 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
         status = _deserializeIncomingPacket( pMqttConnection,
                                              &incomingPacket );
 
-        /* Free any buffers allocated for the MQTT packet. */
-        if( incomingPacket.pRemainingData != NULL )
+        /* Free any buffers allocated for the MQTT packet, or remove the
+         * packet from the network buffers if it was used in place. */
+        if( incomingPacket.remainingDataInPlace == true )
+        {
+            pMqttConnection->pNetworkInterface->consume( pNetworkConnection,
+                                                         incomingPacket.remainingLength );
+        }
+        else if( incomingPacket.pRemainingData != NULL )
         {
             IotMqtt_FreeMessage( incomingPacket.pRemainingData );
         }
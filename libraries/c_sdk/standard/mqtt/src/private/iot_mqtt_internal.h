@@ -398,6 +398,12 @@ typedef struct _mqttPacket
     size_t remainingLength;    /**< @brief (Input) Length of the remaining data in the MQTT packet. */
     uint16_t packetIdentifier; /**< @brief (Output) MQTT packet identifier. */
     uint8_t type;              /**< @brief (Input) A value identifying the packet type. */
+
+    /**
+     * @brief Whether `pRemainingData` points into the buffers of the network
+     * stack, from #IotNetworkInterface_t.peek, rather than to an allocated buffer.
+     */
+    bool remainingDataInPlace;
 } _mqttPacket_t;
 
 /*-------------------- MQTT struct validation functions ---------------------*/
@@ -477,6 +477,36 @@ static size_t _receive( void * pConnection,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Simulates a network peek function.
+ */
+static size_t _peek( void * pConnection,
+                     const uint8_t ** pBuffer )
+{
+    _receiveContext_t * pReceiveContext = pConnection;
+
+    *pBuffer = pReceiveContext->pData + pReceiveContext->dataIndex;
+
+    return pReceiveContext->dataLength - pReceiveContext->dataIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Simulates a network consume function.
+ */
+static void _consume( void * pConnection,
+                      size_t bytesConsumed )
+{
+    _receiveContext_t * pReceiveContext = pConnection;
+
+    TEST_ASSERT_LESS_OR_EQUAL( pReceiveContext->dataLength - pReceiveContext->dataIndex, bytesConsumed );
+
+    pReceiveContext->dataIndex += bytesConsumed;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief A network close function that reports if it was invoked.
  */
@@ -544,6 +574,8 @@ TEST_SETUP( MQTT_Unit_Receive )
     serializer.getRemainingLength = _getRemainingLength;
 
     _networkInterface.receive = _receive;
+    _networkInterface.peek = NULL;
+    _networkInterface.consume = NULL;
     _networkInterface.close = _close;
     networkInfo.pNetworkInterface = &_networkInterface;
     networkInfo.disconnectCallback.function = _disconnectCallback;
@@ -607,8 +639,10 @@ TEST_GROUP_RUNNER( MQTT_Unit_Receive )
     RUN_TEST_CASE( MQTT_Unit_Receive, ConnackInvalid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PublishValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PublishInvalid );
+    RUN_TEST_CASE( MQTT_Unit_Receive, PublishFlushInPlace );
     RUN_TEST_CASE( MQTT_Unit_Receive, PubackValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, PubackInvalid );
+    RUN_TEST_CASE( MQTT_Unit_Receive, PubackInPlace );
     RUN_TEST_CASE( MQTT_Unit_Receive, SubackValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, SubackInvalid );
     RUN_TEST_CASE( MQTT_Unit_Receive, UnsubackValid );
@@ -1136,6 +1170,51 @@ TEST( MQTT_Unit_Receive, PublishInvalid )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests that a PUBLISH that cannot be stored is dropped where the
+ * network stack has received it, without dropping the packet after it.
+ */
+TEST( MQTT_Unit_Receive, PublishFlushInPlace )
+{
+    uint8_t pBuffer[ sizeof( _pPublishTemplate ) + sizeof( _pPingrespTemplate ) ] = { 0 };
+    _receiveContext_t receiveContext = { 0 };
+
+    /* A PUBLISH followed by a PINGRESP, received together. */
+    ( void ) memcpy( pBuffer, _pPublishTemplate, sizeof( _pPublishTemplate ) );
+    ( void ) memcpy( pBuffer + sizeof( _pPublishTemplate ), _pPingrespTemplate, sizeof( _pPingrespTemplate ) );
+
+    receiveContext.pData = pBuffer;
+    receiveContext.dataLength = sizeof( pBuffer );
+
+    /* Read received data in place. */
+    _networkInterface.peek = _peek;
+    _networkInterface.consume = _consume;
+
+    /* The buffer for the PUBLISH cannot be allocated. Its remaining data is
+     * flushed, but the data returned by the peek that belongs to the PINGRESP
+     * must be left. */
+    UnityMalloc_MakeMallocFailAfterCount( 0 );
+    IotMqtt_ReceiveCallback( &receiveContext,
+                             _pMqttConnection );
+    UnityMalloc_MakeMallocFailAfterCount( -1 );
+
+    TEST_ASSERT_EQUAL( sizeof( _pPublishTemplate ), receiveContext.dataIndex );
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+
+    /* The PINGRESP is processed next. */
+    _pMqttConnection->keepAliveFailure = true;
+    IotMqtt_ReceiveCallback( &receiveContext,
+                             _pMqttConnection );
+
+    TEST_ASSERT_EQUAL( sizeof( pBuffer ), receiveContext.dataIndex );
+    TEST_ASSERT_EQUAL_INT( false, _pMqttConnection->keepAliveFailure );
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests the behavior of @ref mqtt_function_receivecallback with a
  * spec-compliant PUBACK.
@@ -1179,6 +1258,49 @@ TEST( MQTT_Unit_Receive, PubackValid )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests the behavior of @ref mqtt_function_receivecallback with a
+ * PUBACK that is read where the network stack has received it.
+ */
+TEST( MQTT_Unit_Receive, PubackInPlace )
+{
+    _mqttOperation_t publish = INITIALIZE_OPERATION( IOT_MQTT_PUBLISH_TO_SERVER );
+    _receiveContext_t receiveContext = { 0 };
+
+    /* Create the wait semaphore so notifications don't crash. The value of
+     * this semaphore will not be checked, so the maxValue argument is arbitrary. */
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( publish.u.operation.notify.waitSemaphore ),
+                                                      0,
+                                                      10 ) );
+
+    /* Read received data in place. */
+    _networkInterface.peek = _peek;
+    _networkInterface.consume = _consume;
+
+    /* Process a valid PUBACK; all of it should be consumed. */
+    {
+        DECLARE_PACKET( _pPubackTemplate, pPuback, pubackSize );
+        _operationResetAndPush( &publish );
+
+        receiveContext.pData = pPuback;
+        receiveContext.dataLength = pubackSize;
+
+        IotMqtt_ReceiveCallback( &receiveContext,
+                                 _pMqttConnection );
+
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, publish.u.operation.status );
+        TEST_ASSERT_EQUAL( pubackSize, receiveContext.dataIndex );
+    }
+
+    IotSemaphore_Destroy( &( publish.u.operation.notify.waitSemaphore ) );
+
+    /* Network close function should not have been invoked. */
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests the behavior of @ref mqtt_function_receivecallback with a PUBACK
  * that doesn't comply to MQTT spec.
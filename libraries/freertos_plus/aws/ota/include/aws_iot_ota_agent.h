@@ -424,6 +424,10 @@ typedef struct OTA_FileContext
     uint32_t ulUpdaterVersion;  /*!< Used by OTA self-test detection, the version of FW that did the update. */
     bool bIsInSelfTest;         /*!< True if the job is in self test mode. */
     uint8_t * pucProtocols;     /*!< Authorization scheme. */
+    void * pvSigVerifyContext;  /*!< Signature verification context fed by the agent as blocks are received, or NULL. */
+    uint32_t ulHashedBytes;     /*!< Number of bytes from the start of the file included in pvSigVerifyContext. */
+    uint32_t ulDeltaPatch;      /*!< Non-zero if the file is a patch against the running image rather than the image itself. */
+    uint32_t ulCompression;     /*!< How the file is compressed for transfer, 0 if it isn't. */
 } OTA_FileContext_t;
 
 /**
@@ -517,6 +521,9 @@ typedef struct
 #define kOTA_Err_EventQueueSendFailed    0x2c000000UL     /*!< Posting event message to the event queue failed. */
 #define kOTA_Err_InvalidDataProtocol     0x2d000000UL     /*!< Job does not have a valid protocol for data transfer. */
 #define kOTA_Err_OTAAgentStopped         0x2e000000UL     /*!< Returned when operations are performed that requires OTA Agent running & its stopped. */
+#define kOTA_Err_DeltaNotSupported       0x2f000000UL     /*!< The file is a delta patch but delta updates are not enabled. */
+#define kOTA_Err_PatchFailed             0x30000000UL     /*!< The delta patch is malformed or does not apply to the running image. */
+#define kOTA_Err_DecompressFailed        0x31000000UL     /*!< The compressed file is malformed or of an unsupported type. */
 /* @[define_ota_err_codes] */
 
 /* @[define_ota_err_code_helpers] */
@@ -59,6 +59,25 @@
 /* OTA interface includes. */
 #include "aws_iot_ota_interface.h"
 
+#if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+    /* Crypto includes for the incremental signature check. */
+    #include "iot_crypto.h"
+
+    #if ( OTA_MAX_NUM_REORDER_BLOCKS < 1 )
+        #error "otaconfigMAX_NUM_REORDER_BLOCKS must be at least 1 when otaconfigINCREMENTAL_SIGNATURE_CHECK is enabled."
+    #endif
+#endif
+
+#if ( OTA_DELTA_UPDATE == 1 )
+    /* Delta patch includes. */
+    #include "aws_iot_ota_delta.h"
+#endif
+
+#if ( OTA_COMPRESSED_FILES == 1 )
+    /* Decompression includes. */
+    #include "aws_iot_ota_decompress.h"
+#endif
+
 /* OTA event handler definiton. */
 
 typedef OTA_Err_t ( * OTAEventHandler_t )( OTA_EventData_t * pxEventMsg );
@@ -89,6 +108,66 @@ typedef union MultiParmPtr
     void ** ppvPtr;
 } MultiParmPtr_t;
 
+#if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+
+/* Value of a free slot in the reorder buffer. */
+
+    #define OTA_REORDER_SLOT_FREE    0xffffffffUL
+
+/* Blocks that arrived ahead of the hash position are held here until the blocks
+ * before them have been hashed. The storage is allocated on first use. */
+
+    typedef struct
+    {
+        uint8_t * pucData;                                          /* OTA_MAX_NUM_REORDER_BLOCKS blocks of OTA_FILE_BLOCK_SIZE bytes. */
+        uint32_t ulBlockIndex[ OTA_MAX_NUM_REORDER_BLOCKS ];        /* Block held in each slot or OTA_REORDER_SLOT_FREE. */
+        uint32_t ulBlockSize[ OTA_MAX_NUM_REORDER_BLOCKS ];         /* Size of the block held in each slot. */
+    } OTA_ReorderBuffer_t;
+
+    static OTA_ReorderBuffer_t xReorderBuffer;
+#endif /* if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 ) */
+
+#if ( OTA_DELTA_UPDATE == 1 )
+
+/* The patch being applied when the file being received is a delta patch. */
+
+    static OTA_DeltaContext_t xDeltaContext;
+#endif
+
+#if ( OTA_COMPRESSED_FILES == 1 )
+
+/* The decoder of the file being received when it is compressed. */
+
+    static OTA_DecompressContext_t xDecompressContext;
+#endif
+
+#if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+
+/* Marks a saved download state and its layout version. */
+
+    #define OTA_RX_STATE_MAGIC    0x4f545231UL
+
+/* Header of the download state saved through the PAL. It is followed by the block bitmap. */
+
+    typedef struct
+    {
+        uint32_t ulMagic;        /* OTA_RX_STATE_MAGIC. */
+        uint32_t ulServerFileID; /* The file ID from the job document. */
+        uint32_t ulFileSize;     /* The size of the file in bytes. */
+        uint32_t ulIdentity;     /* Hash of the file signature, identifying the image being received. */
+        uint32_t ulBitmapLen;    /* Length of the block bitmap that follows, in bytes. */
+        uint32_t ulCodecLen;     /* Length of the decoder state after the bitmap, 0 if the file isn't compressed. */
+    } OTA_RxStateHeader_t;
+
+/* Size of the decoder state saved with the bitmap of the specified file. */
+
+    #if ( OTA_COMPRESSED_FILES == 1 )
+        #define OTA_RX_CODEC_STATE_LEN( C )    ( ( ( C )->ulCompression != OTA_COMPRESSION_NONE ) ? sizeof( xDecompressContext.xState ) : 0U )
+    #else
+        #define OTA_RX_CODEC_STATE_LEN( C )    0U
+    #endif
+#endif /* if ( OTA_RESUMABLE_DOWNLOAD == 1 ) */
+
 /* Array containing pointer to the OTA event structures used to send events to the OTA task. */
 
 static OTA_EventMsg_t xQueueData[ OTA_NUM_MSG_Q_ENTRIES ];
@@ -176,6 +255,63 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
 
 static bool prvOTA_Close( OTA_FileContext_t * const C );
 
+/* Check if the file has to be received in order, because it is a patch or is compressed. */
+
+static bool prvIsStreamedFile( const OTA_FileContext_t * C );
+
+/* Store a received block, decompressing it or applying it as a patch as needed. */
+
+static IngestResult_t prvStoreFileBlock( OTA_FileContext_t * C,
+                                         uint32_t ulBlockIndex,
+                                         uint8_t * pucPayload,
+                                         uint32_t ulBlockSize );
+
+/* Check that a patch or compressed file produced the whole image once its last block is in. */
+
+static IngestResult_t prvFinishStreamedFile( OTA_FileContext_t * C,
+                                             OTA_Err_t * pxCloseResult );
+
+#if ( OTA_COMPRESSED_FILES == 1 )
+
+/* Pass decompressed data on to the patch when a compressed file is a delta patch. */
+
+    static int16_t prvApplyPatchData( OTA_FileContext_t * const C,
+                                      uint32_t ulOffset,
+                                      uint8_t * const pacData,
+                                      uint32_t ulSize );
+#endif
+
+#if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+
+/* Save the block bitmap of the file so the download can be resumed after a reset. */
+
+    static void prvSaveRxState( OTA_FileContext_t * C );
+
+/* Restore the block bitmap and reopen the partial file of an interrupted download. */
+
+    static bool prvRestoreRxState( OTA_FileContext_t * C,
+                                   uint32_t ulNumBlocks,
+                                   uint32_t ulBitmapLen );
+#endif
+
+#if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+
+/* Start hashing the file in the specified OTA context as its blocks are received. */
+
+    static void prvSigCheckStart( OTA_FileContext_t * C );
+
+/* Add a received block to the running signature check of the file. */
+
+    static void prvSigCheckUpdate( OTA_FileContext_t * C,
+                                   uint32_t ulBlockIndex,
+                                   const uint8_t * pucData,
+                                   uint32_t ulBlockSize );
+
+/* Drop the running signature check, leaving the PAL to hash the whole file at close. */
+
+    static void prvSigCheckStop( OTA_FileContext_t * C );
+#endif
+
 
 /* Internal function to set the image state including an optional reason code. */
 
@@ -251,6 +387,7 @@ static OTA_Err_t prvInSelfTestHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvInitFileHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvProcessDataHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvRequestDataHandler( OTA_EventData_t * pxEventData );
+static OTA_Err_t prvRequestDataTimeoutHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvShutdownHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvCloseFileHandler( OTA_EventData_t * pxEventData );
 static OTA_Err_t prvUserAbortHandler( OTA_EventData_t * pxEventData );
@@ -294,31 +431,35 @@ static OTA_AgentContext_t xOTA_Agent =
     .ulNumOfBlocksToReceive        = 1,
     .xStatistics                   = { 0 },
     .xOTA_ThreadSafetyMutex        = NULL,
-    .ulRequestMomentum             = 0
+    .ulRequestMomentum             = 0,
+    .ulRequestWindow               = 1,
+    .ulMaxRequestWindow            = 1,
+    .ulRequestsInFlight            = 0,
+    .ulNextRequestBlock            = 0
 };
 
 static OTAStateTableEntry_t OTATransitionTable[] =
 {
-    /*STATE ,                              EVENT ,                               ACTION ,               NEXT STATE                         */
-    { eOTA_AgentState_Ready,               eOTA_AgentEvent_Start,               prvStartHandler,           eOTA_AgentState_RequestingJob       },
-    { eOTA_AgentState_RequestingJob,       eOTA_AgentEvent_RequestJobDocument,  prvRequestJobHandler,      eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_RequestingJob,       eOTA_AgentEvent_RequestTimer,        prvRequestJobHandler,      eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_WaitingForJob,       eOTA_AgentEvent_ReceivedJobDocument, prvProcessJobHandler,      eOTA_AgentState_CreatingFile        },
-    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_StartSelfTest,       prvInSelfTestHandler,      eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_CreateFile,          prvInitFileHandler,        eOTA_AgentState_RequestingFileBlock },
-    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_RequestTimer,        prvInitFileHandler,        eOTA_AgentState_RequestingFileBlock },
-    { eOTA_AgentState_RequestingFileBlock, eOTA_AgentEvent_RequestFileBlock,    prvRequestDataHandler,     eOTA_AgentState_WaitingForFileBlock },
-    { eOTA_AgentState_RequestingFileBlock, eOTA_AgentEvent_RequestTimer,        prvRequestDataHandler,     eOTA_AgentState_WaitingForFileBlock },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_ReceivedFileBlock,   prvProcessDataHandler,     eOTA_AgentState_WaitingForFileBlock },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestTimer,        prvRequestDataHandler,     eOTA_AgentState_WaitingForFileBlock },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestFileBlock,    prvRequestDataHandler,     eOTA_AgentState_WaitingForFileBlock },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestJobDocument,  prvRequestJobHandler,      eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_ReceivedJobDocument, prvJobNotificationHandler, eOTA_AgentState_RequestingJob       },
-    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_CloseFile,           prvCloseFileHandler,       eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_Suspended,           eOTA_AgentEvent_Resume,              prvResumeHandler,          eOTA_AgentState_RequestingJob       },
-    { eOTA_AgentState_All,                 eOTA_AgentEvent_Suspend,             prvSuspendHandler,         eOTA_AgentState_Suspended           },
-    { eOTA_AgentState_All,                 eOTA_AgentEvent_UserAbort,           prvUserAbortHandler,       eOTA_AgentState_WaitingForJob       },
-    { eOTA_AgentState_All,                 eOTA_AgentEvent_Shutdown,            prvShutdownHandler,        eOTA_AgentState_ShuttingDown        },
+    /*STATE ,                              EVENT ,                               ACTION ,                  NEXT STATE                         */
+    { eOTA_AgentState_Ready,               eOTA_AgentEvent_Start,               prvStartHandler,              eOTA_AgentState_RequestingJob       },
+    { eOTA_AgentState_RequestingJob,       eOTA_AgentEvent_RequestJobDocument,  prvRequestJobHandler,         eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_RequestingJob,       eOTA_AgentEvent_RequestTimer,        prvRequestJobHandler,         eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_WaitingForJob,       eOTA_AgentEvent_ReceivedJobDocument, prvProcessJobHandler,         eOTA_AgentState_CreatingFile        },
+    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_StartSelfTest,       prvInSelfTestHandler,         eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_CreateFile,          prvInitFileHandler,           eOTA_AgentState_RequestingFileBlock },
+    { eOTA_AgentState_CreatingFile,        eOTA_AgentEvent_RequestTimer,        prvInitFileHandler,           eOTA_AgentState_RequestingFileBlock },
+    { eOTA_AgentState_RequestingFileBlock, eOTA_AgentEvent_RequestFileBlock,    prvRequestDataHandler,        eOTA_AgentState_WaitingForFileBlock },
+    { eOTA_AgentState_RequestingFileBlock, eOTA_AgentEvent_RequestTimer,        prvRequestDataTimeoutHandler, eOTA_AgentState_WaitingForFileBlock },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_ReceivedFileBlock,   prvProcessDataHandler,        eOTA_AgentState_WaitingForFileBlock },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestTimer,        prvRequestDataTimeoutHandler, eOTA_AgentState_WaitingForFileBlock },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestFileBlock,    prvRequestDataHandler,        eOTA_AgentState_WaitingForFileBlock },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_RequestJobDocument,  prvRequestJobHandler,         eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_ReceivedJobDocument, prvJobNotificationHandler,    eOTA_AgentState_RequestingJob       },
+    { eOTA_AgentState_WaitingForFileBlock, eOTA_AgentEvent_CloseFile,           prvCloseFileHandler,          eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_Suspended,           eOTA_AgentEvent_Resume,              prvResumeHandler,             eOTA_AgentState_RequestingJob       },
+    { eOTA_AgentState_All,                 eOTA_AgentEvent_Suspend,             prvSuspendHandler,            eOTA_AgentState_Suspended           },
+    { eOTA_AgentState_All,                 eOTA_AgentEvent_UserAbort,           prvUserAbortHandler,          eOTA_AgentState_WaitingForJob       },
+    { eOTA_AgentState_All,                 eOTA_AgentEvent_Shutdown,            prvShutdownHandler,           eOTA_AgentState_ShuttingDown        },
 };
 
 static const char * pcOTA_AgentState_Strings[ eOTA_AgentState_All ] =
@@ -1037,6 +1178,12 @@ static OTA_Err_t prvInitFileHandler( OTA_EventData_t * pxEventData )
         /* Reset the request momentum. */
         xOTA_Agent.ulRequestMomentum = 0;
 
+        /* Start the new file transfer with a single request in flight. The window
+         * opens up as requests are answered, up to the limit set by the data interface. */
+        xOTA_Agent.ulRequestWindow = 1;
+        xOTA_Agent.ulRequestsInFlight = 0;
+        xOTA_Agent.ulNextRequestBlock = 0;
+
         xEventMsg.xEventId = eOTA_AgentEvent_RequestFileBlock;
 
         if( !OTA_SignalEvent( &xEventMsg ) )
@@ -1048,6 +1195,70 @@ static OTA_Err_t prvInitFileHandler( OTA_EventData_t * pxEventData )
     return xErr;
 }
 
+/*
+ * Return the index of the first block at or after ulStartBlock that has not been
+ * received yet, or the total number of blocks if there is none.
+ */
+static uint32_t prvNextMissingBlock( const OTA_FileContext_t * C,
+                                     uint32_t ulStartBlock,
+                                     uint32_t ulNumBlocks )
+{
+    uint32_t ulBlock = ulStartBlock;
+
+    while( ( ulBlock < ulNumBlocks ) &&
+           ( ( C->pucRxBlockBitmap[ ulBlock >> LOG2_BITS_PER_BYTE ] & ( 1U << ( ulBlock % BITS_PER_BYTE ) ) ) == 0U ) )
+    {
+        ulBlock++;
+    }
+
+    return ulBlock;
+}
+
+/*
+ * Send data requests until the request window is full. Each request asks for the
+ * next range of missing blocks starting at ulNextRequestBlock, which the data
+ * interface advances past the blocks it asked for. Once every missing block has
+ * been asked for, we wait for the outstanding requests to drain and then start
+ * over from the first missing block so that lost blocks are requested again.
+ */
+static OTA_Err_t prvFillRequestWindow( void )
+{
+    OTA_Err_t xErr = kOTA_Err_None;
+    OTA_FileContext_t * C = &xOTA_Agent.pxOTA_Files[ xOTA_Agent.ulFileIndex ];
+    uint32_t ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+    uint32_t ulRequestWindow = xOTA_Agent.ulRequestWindow;
+
+    /* Blocks of a patch or compressed file are only used in order, so requesting ahead is wasted. */
+    if( prvIsStreamedFile( C ) == true )
+    {
+        ulRequestWindow = 1U;
+    }
+
+    if( C->pucRxBlockBitmap != NULL )
+    {
+        xOTA_Agent.ulNextRequestBlock = prvNextMissingBlock( C, xOTA_Agent.ulNextRequestBlock, ulNumBlocks );
+
+        if( ( xOTA_Agent.ulNextRequestBlock >= ulNumBlocks ) && ( xOTA_Agent.ulRequestsInFlight == 0U ) )
+        {
+            xOTA_Agent.ulNextRequestBlock = prvNextMissingBlock( C, 0, ulNumBlocks );
+        }
+    }
+
+    while( ( xErr == kOTA_Err_None ) &&
+           ( xOTA_Agent.ulRequestsInFlight < ulRequestWindow ) &&
+           ( xOTA_Agent.ulNextRequestBlock < ulNumBlocks ) )
+    {
+        xErr = xOTA_DataInterface.prvRequestFileBlock( &xOTA_Agent );
+
+        if( xErr == kOTA_Err_None )
+        {
+            xOTA_Agent.ulRequestsInFlight++;
+        }
+    }
+
+    return xErr;
+}
+
 static OTA_Err_t prvRequestDataHandler( OTA_EventData_t * pxEventData )
 {
     ( void ) pxEventData;
@@ -1062,7 +1273,7 @@ static OTA_Err_t prvRequestDataHandler( OTA_EventData_t * pxEventData )
         if( xOTA_Agent.ulRequestMomentum < otaconfigMAX_NUM_REQUEST_MOMENTUM )
         {
             /* Request data blocks. */
-            xErr = xOTA_DataInterface.prvRequestFileBlock( &xOTA_Agent );
+            xErr = prvFillRequestWindow();
 
             /* Each request increases the momentum until a response is received. Too much momentum is
              * interpreted as a failure to communicate and will cause us to abort the OTA. */
@@ -1098,6 +1309,24 @@ static OTA_Err_t prvRequestDataHandler( OTA_EventData_t * pxEventData )
     return xErr;
 }
 
+/*
+ * The request timer expired without a data block arriving. Consider all outstanding
+ * requests lost, halve the request window and request the missing blocks again
+ * starting from the first one.
+ */
+static OTA_Err_t prvRequestDataTimeoutHandler( OTA_EventData_t * pxEventData )
+{
+    DEFINE_OTA_METHOD_NAME( "prvRequestDataTimeoutHandler" );
+
+    xOTA_Agent.ulRequestWindow = ( xOTA_Agent.ulRequestWindow + 1U ) / 2U;
+    xOTA_Agent.ulRequestsInFlight = 0;
+    xOTA_Agent.ulNextRequestBlock = 0;
+
+    OTA_LOG_L2( "[%s] Request window reduced to %u.\r\n", OTA_METHOD_NAME, xOTA_Agent.ulRequestWindow );
+
+    return prvRequestDataHandler( pxEventData );
+}
+
 static OTA_Err_t prvProcessDataHandler( OTA_EventData_t * pxEventData )
 {
     DEFINE_OTA_METHOD_NAME( "prvProcessDataMessage" );
@@ -1194,6 +1423,20 @@ static OTA_Err_t prvProcessDataHandler( OTA_EventData_t * pxEventData )
         }
         else
         {
+            /* All blocks of one request have arrived. Retire it and, since the link keeps
+             * up with the current window, allow one more request in flight. */
+            xOTA_Agent.ulNumOfBlocksToReceive = otaconfigMAX_NUM_BLOCKS_REQUEST;
+
+            if( xOTA_Agent.ulRequestsInFlight > 0U )
+            {
+                xOTA_Agent.ulRequestsInFlight--;
+            }
+
+            if( xOTA_Agent.ulRequestWindow < xOTA_Agent.ulMaxRequestWindow )
+            {
+                xOTA_Agent.ulRequestWindow++;
+            }
+
             prvStartRequestTimer( otaconfigFILE_REQUEST_WAIT_MS );
 
             xEventMsg.xEventId = eOTA_AgentEvent_RequestFileBlock;
@@ -1271,6 +1514,11 @@ static OTA_Err_t prvSuspendHandler( OTA_EventData_t * pxEventData )
     ( void ) pxEventData;
     OTA_Err_t xErr = kOTA_Err_None;
 
+    #if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+        /* Save the download progress in case the device is reset while suspended. */
+        prvSaveRxState( &xOTA_Agent.pxOTA_Files[ xOTA_Agent.ulFileIndex ] );
+    #endif
+
     /* Log the state change to suspended state.*/
     OTA_LOG_L1( "[%s] OTA Agent is suspended.\r\n", OTA_METHOD_NAME );
 
@@ -1457,6 +1705,10 @@ static void prvOTA_FreeContext( OTA_FileContext_t * const C )
             vPortFree( C->pucProtocols ); /* Free the pucProtocols string memory. */
             C->pucProtocols = NULL;
         }
+
+        #if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+            prvSigCheckStop( C ); /* Free the running signature check if the PAL did not consume it. */
+        #endif
     }
 }
 
@@ -1478,6 +1730,14 @@ static bool prvOTA_Close( OTA_FileContext_t * const C )
 
     if( C != NULL )
     {
+        #if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+            /* The transfer is over unless the agent is only shutting down, so the saved state is no longer needed. */
+            if( ( xOTA_Agent.eState != eOTA_AgentState_ShuttingDown ) && ( C->pucFilePath != NULL ) )
+            {
+                ( void ) prvPAL_SaveRxState( C, NULL, 0 );
+            }
+        #endif
+
         /*
          * Abort any active file access and release the file resource, if needed.
          */
@@ -2067,6 +2327,8 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
         { OTA_JSON_AUTH_SCHEME_KEY,     OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, pucAuthScheme )  }, eModelParamType_StringCopy,  JSMN_STRING    },
         { cOTA_JSON_FileSignatureKey,   OTA_JOB_PARAM_REQUIRED, { offsetof( OTA_FileContext_t, pxSignature )    }, eModelParamType_SigBase64,   JSMN_STRING    },
         { OTA_JSON_FILE_ATTRIBUTE_KEY,  OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulFileAttributes )}, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_FILE_DELTA_KEY,      OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulDeltaPatch )   }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
+        { OTA_JSON_FILE_COMPRESSION_KEY, OTA_JOB_PARAM_OPTIONAL, { offsetof( OTA_FileContext_t, ulCompression ) }, eModelParamType_UInt32,      JSMN_PRIMITIVE },
     };
 
     OTA_Err_t xOTAErr = kOTA_Err_None;
@@ -2378,8 +2640,46 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
 
             pstUpdateFile->ulBlocksRemaining = ulNumBlocks; /* Initialize our blocks remaining counter. */
 
-            /* Create/Open the OTA file on the file system. */
-            xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+            if( ( OTA_DELTA_UPDATE == 0U ) && ( pstUpdateFile->ulDeltaPatch != 0U ) )
+            {
+                /* Writing the patch out as the image would only fail the signature check. */
+                OTA_LOG_L1( "[%s] Error: The file is a delta patch but delta updates are not enabled.\r\n", OTA_METHOD_NAME );
+                xErr = kOTA_Err_DeltaNotSupported;
+            }
+            else if( ( pstUpdateFile->ulCompression != OTA_COMPRESSION_NONE ) &&
+                     ( ( OTA_COMPRESSED_FILES == 0U ) || ( pstUpdateFile->ulCompression != OTA_COMPRESSION_LZ ) ) )
+            {
+                OTA_LOG_L1( "[%s] Error: Compression type %u is not supported.\r\n", OTA_METHOD_NAME, pstUpdateFile->ulCompression );
+                xErr = kOTA_Err_DecompressFailed;
+            }
+            else
+            {
+                #if ( OTA_COMPRESSED_FILES == 1 )
+                    /* Set up the decoder first, a resumed download restores its state. */
+                    if( pstUpdateFile->ulCompression != OTA_COMPRESSION_NONE )
+                    {
+                        OTA_Decompress_Init( &xDecompressContext,
+                                             pstUpdateFile,
+                                             ( pstUpdateFile->ulDeltaPatch != 0U ) ? prvApplyPatchData : xOTA_Agent.xPALCallbacks.xWriteBlock );
+                    }
+                #endif
+
+                #if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+                    /* Pick up an interrupted download of the same file where it left off. A patch
+                     * can't be resumed since its progress lives in the patch context. */
+                    if( ( pstUpdateFile->ulDeltaPatch == 0U ) &&
+                        ( prvRestoreRxState( pstUpdateFile, ulNumBlocks, ulBitmapLen ) == true ) )
+                    {
+                        xErr = kOTA_Err_None;
+                    }
+                #endif
+
+                if( xErr != kOTA_Err_None )
+                {
+                    /* Create/Open the OTA file on the file system. */
+                    xErr = xOTA_Agent.xPALCallbacks.xCreateFileForRx( pstUpdateFile );
+                }
+            }
 
             if( xErr != kOTA_Err_None )
             {
@@ -2387,6 +2687,19 @@ static OTA_FileContext_t * prvGetFileContextFromJob( const char * pcRawMsg,
                 ( void ) prvOTA_Close( pstUpdateFile ); /* Ignore false result since we're setting the pointer to null on the next line. */
                 pstUpdateFile = NULL;
             }
+            else
+            {
+                #if ( OTA_DELTA_UPDATE == 1 )
+                    if( pstUpdateFile->ulDeltaPatch != 0U )
+                    {
+                        OTA_Delta_Init( &xDeltaContext, pstUpdateFile, prvPAL_ReadBaseImage, xOTA_Agent.xPALCallbacks.xWriteBlock );
+                    }
+                #endif
+
+                #if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+                    prvSigCheckStart( pstUpdateFile );
+                #endif
+            }
         }
         else
         {
@@ -2424,6 +2737,395 @@ static bool prvValidateDataBlock( const OTA_FileContext_t * C,
     return bRet;
 }
 
+#if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+
+/*
+ * Identify the image being received by an FNV-1a hash of its signature, so a saved
+ * state is never applied to a different build that happens to reuse the file ID and size.
+ */
+    static uint32_t prvRxStateIdentity( const OTA_FileContext_t * C )
+    {
+        uint32_t ulHash = 2166136261UL;
+        uint32_t ulIndex;
+
+        if( C->pxSignature != NULL )
+        {
+            for( ulIndex = 0; ulIndex < C->pxSignature->usSize; ulIndex++ )
+            {
+                ulHash ^= C->pxSignature->ucData[ ulIndex ];
+                ulHash *= 16777619UL;
+            }
+        }
+
+        return ulHash;
+    }
+
+    static void prvSaveRxState( OTA_FileContext_t * C )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvSaveRxState" );
+
+        OTA_RxStateHeader_t xHeader;
+        uint8_t * pucState;
+        uint32_t ulNumBlocks;
+        OTA_Err_t xErr;
+
+        if( ( C->pucRxBlockBitmap != NULL ) && ( C->pucFile != NULL ) && ( C->ulDeltaPatch == 0U ) )
+        {
+            ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+
+            xHeader.ulMagic = OTA_RX_STATE_MAGIC;
+            xHeader.ulServerFileID = C->ulServerFileID;
+            xHeader.ulFileSize = C->ulFileSize;
+            xHeader.ulIdentity = prvRxStateIdentity( C );
+            xHeader.ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
+            xHeader.ulCodecLen = OTA_RX_CODEC_STATE_LEN( C );
+
+            pucState = ( uint8_t * ) pvPortMalloc( sizeof( xHeader ) + xHeader.ulBitmapLen + xHeader.ulCodecLen ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+            if( pucState != NULL )
+            {
+                ( void ) memcpy( pucState, &xHeader, sizeof( xHeader ) );
+                ( void ) memcpy( &pucState[ sizeof( xHeader ) ], C->pucRxBlockBitmap, xHeader.ulBitmapLen );
+
+                #if ( OTA_COMPRESSED_FILES == 1 )
+                    /* Blocks are decoded in order and fully flushed, so the decoder state matches the bitmap. */
+                    if( xHeader.ulCodecLen != 0U )
+                    {
+                        ( void ) memcpy( &pucState[ sizeof( xHeader ) + xHeader.ulBitmapLen ], &xDecompressContext.xState, xHeader.ulCodecLen );
+                    }
+                #endif
+
+                xErr = prvPAL_SaveRxState( C, pucState, sizeof( xHeader ) + xHeader.ulBitmapLen + xHeader.ulCodecLen );
+
+                if( xErr != kOTA_Err_None )
+                {
+                    OTA_LOG_L1( "[%s] Warning: failed to save the download state (0x%08x).\r\n", OTA_METHOD_NAME, xErr );
+                }
+
+                vPortFree( pucState );
+            }
+        }
+    }
+
+    static bool prvRestoreRxState( OTA_FileContext_t * C,
+                                   uint32_t ulNumBlocks,
+                                   uint32_t ulBitmapLen )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvRestoreRxState" );
+
+        OTA_RxStateHeader_t xHeader;
+        uint8_t * pucState;
+        uint32_t ulCodecLen = OTA_RX_CODEC_STATE_LEN( C );
+        uint32_t ulStateSize = sizeof( xHeader ) + ulBitmapLen + ulCodecLen;
+        uint32_t ulBlock;
+        uint32_t ulBlocksRemaining = 0;
+        bool bResumed = false;
+
+        pucState = ( uint8_t * ) pvPortMalloc( ulStateSize ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+
+        if( pucState != NULL )
+        {
+            if( prvPAL_LoadRxState( C, pucState, ulStateSize ) == ulStateSize )
+            {
+                ( void ) memcpy( &xHeader, pucState, sizeof( xHeader ) );
+
+                if( ( xHeader.ulMagic == OTA_RX_STATE_MAGIC ) &&
+                    ( xHeader.ulServerFileID == C->ulServerFileID ) &&
+                    ( xHeader.ulFileSize == C->ulFileSize ) &&
+                    ( xHeader.ulIdentity == prvRxStateIdentity( C ) ) &&
+                    ( xHeader.ulBitmapLen == ulBitmapLen ) &&
+                    ( xHeader.ulCodecLen == ulCodecLen ) )
+                {
+                    for( ulBlock = 0; ulBlock < ulNumBlocks; ulBlock++ )
+                    {
+                        if( ( pucState[ sizeof( xHeader ) + ( ulBlock >> LOG2_BITS_PER_BYTE ) ] & ( 1U << ( ulBlock % BITS_PER_BYTE ) ) ) != 0U )
+                        {
+                            ulBlocksRemaining++;
+                        }
+                    }
+
+                    /* A finished download would have been closed, so only resume partial ones. */
+                    if( ( ulBlocksRemaining > 0U ) && ( prvPAL_ResumeFileForRx( C ) == kOTA_Err_None ) )
+                    {
+                        ( void ) memcpy( C->pucRxBlockBitmap, &pucState[ sizeof( xHeader ) ], ulBitmapLen );
+                        C->ulBlocksRemaining = ulBlocksRemaining;
+
+                        #if ( OTA_COMPRESSED_FILES == 1 )
+                            if( ulCodecLen != 0U )
+                            {
+                                ( void ) memcpy( &xDecompressContext.xState, &pucState[ sizeof( xHeader ) + ulBitmapLen ], ulCodecLen );
+                            }
+                        #endif
+                        bResumed = true;
+
+                        OTA_LOG_L1( "[%s] Resuming download, %u of %u blocks remaining.\r\n", OTA_METHOD_NAME, ulBlocksRemaining, ulNumBlocks );
+                    }
+                }
+            }
+
+            vPortFree( pucState );
+        }
+
+        if( bResumed == false )
+        {
+            /* Whatever was saved does not belong to this download. */
+            ( void ) prvPAL_SaveRxState( C, NULL, 0 );
+        }
+
+        return bResumed;
+    }
+
+#endif /* if ( OTA_RESUMABLE_DOWNLOAD == 1 ) */
+
+#if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+
+    static void prvSigCheckStart( OTA_FileContext_t * C )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvSigCheckStart" );
+
+        BaseType_t xAsymmetricAlgorithm = cryptoASYMMETRIC_ALGORITHM_ECDSA;
+        BaseType_t xHashAlgorithm = cryptoHASH_ALGORITHM_SHA256;
+        uint32_t ulSlot;
+        uint32_t ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
+
+        C->pvSigVerifyContext = NULL;
+        C->ulHashedBytes = 0;
+
+        /* The signature method supported by the PAL is named by its job document key, e.g. "sig-sha256-ecdsa". */
+        if( strstr( cOTA_JSON_FileSignatureKey, "sha1" ) != NULL )
+        {
+            xHashAlgorithm = cryptoHASH_ALGORITHM_SHA1;
+        }
+
+        if( strstr( cOTA_JSON_FileSignatureKey, "rsa" ) != NULL )
+        {
+            xAsymmetricAlgorithm = cryptoASYMMETRIC_ALGORITHM_RSA;
+        }
+
+        if( ( C->ulBlocksRemaining != ulNumBlocks ) || ( prvIsStreamedFile( C ) == true ) )
+        {
+            /* A resumed download already has blocks on file that were never hashed, and the
+             * blocks of a patch or a compressed file are not the image that was signed. Leave it to the PAL to hash
+             * the whole file at close. */
+        }
+        else if( CRYPTO_SignatureVerificationStart( &C->pvSigVerifyContext, xAsymmetricAlgorithm, xHashAlgorithm ) == pdFALSE )
+        {
+            /* Not fatal. The PAL will hash the whole file when it is closed. */
+            OTA_LOG_L1( "[%s] Warning: unable to start the incremental signature check.\r\n", OTA_METHOD_NAME );
+            C->pvSigVerifyContext = NULL;
+        }
+
+        for( ulSlot = 0; ulSlot < OTA_MAX_NUM_REORDER_BLOCKS; ulSlot++ )
+        {
+            xReorderBuffer.ulBlockIndex[ ulSlot ] = OTA_REORDER_SLOT_FREE;
+        }
+    }
+
+    static void prvSigCheckStop( OTA_FileContext_t * C )
+    {
+        if( C->pvSigVerifyContext != NULL )
+        {
+            /* Calling the final step with only the context frees it. */
+            ( void ) CRYPTO_SignatureVerificationFinal( C->pvSigVerifyContext, NULL, 0, NULL, 0 );
+            C->pvSigVerifyContext = NULL;
+        }
+
+        if( xReorderBuffer.pucData != NULL )
+        {
+            vPortFree( xReorderBuffer.pucData );
+            xReorderBuffer.pucData = NULL;
+        }
+    }
+
+    static void prvSigCheckUpdate( OTA_FileContext_t * C,
+                                   uint32_t ulBlockIndex,
+                                   const uint8_t * pucData,
+                                   uint32_t ulBlockSize )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvSigCheckUpdate" );
+
+        uint32_t ulSlot;
+        uint32_t ulNextBlock;
+
+        if( C->pvSigVerifyContext != NULL )
+        {
+            if( ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ) == C->ulHashedBytes )
+            {
+                CRYPTO_SignatureVerificationUpdate( C->pvSigVerifyContext, pucData, ulBlockSize );
+                C->ulHashedBytes += ulBlockSize;
+
+                /* Hash any held back blocks that now follow on. */
+                ulSlot = 0;
+
+                while( ulSlot < OTA_MAX_NUM_REORDER_BLOCKS )
+                {
+                    ulNextBlock = C->ulHashedBytes >> otaconfigLOG2_FILE_BLOCK_SIZE;
+
+                    if( xReorderBuffer.ulBlockIndex[ ulSlot ] == ulNextBlock )
+                    {
+                        CRYPTO_SignatureVerificationUpdate( C->pvSigVerifyContext,
+                                                            &xReorderBuffer.pucData[ ulSlot * OTA_FILE_BLOCK_SIZE ],
+                                                            xReorderBuffer.ulBlockSize[ ulSlot ] );
+                        C->ulHashedBytes += xReorderBuffer.ulBlockSize[ ulSlot ];
+                        xReorderBuffer.ulBlockIndex[ ulSlot ] = OTA_REORDER_SLOT_FREE;
+                        ulSlot = 0; /* Restart the search for the block after this one. */
+                    }
+                    else
+                    {
+                        ulSlot++;
+                    }
+                }
+            }
+            else
+            {
+                /* The block is ahead of the hash position. Hold it back if there is room. */
+                if( xReorderBuffer.pucData == NULL )
+                {
+                    xReorderBuffer.pucData = ( uint8_t * ) pvPortMalloc( OTA_MAX_NUM_REORDER_BLOCKS * OTA_FILE_BLOCK_SIZE ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+                }
+
+                for( ulSlot = 0; ulSlot < OTA_MAX_NUM_REORDER_BLOCKS; ulSlot++ )
+                {
+                    if( xReorderBuffer.ulBlockIndex[ ulSlot ] == OTA_REORDER_SLOT_FREE )
+                    {
+                        break;
+                    }
+                }
+
+                if( ( xReorderBuffer.pucData != NULL ) && ( ulSlot < OTA_MAX_NUM_REORDER_BLOCKS ) )
+                {
+                    ( void ) memcpy( &xReorderBuffer.pucData[ ulSlot * OTA_FILE_BLOCK_SIZE ], pucData, ulBlockSize );
+                    xReorderBuffer.ulBlockIndex[ ulSlot ] = ulBlockIndex;
+                    xReorderBuffer.ulBlockSize[ ulSlot ] = ulBlockSize;
+                }
+                else
+                {
+                    OTA_LOG_L1( "[%s] Block %u is too far out of order, the file will be hashed at close.\r\n", OTA_METHOD_NAME, ulBlockIndex );
+                    prvSigCheckStop( C );
+                }
+            }
+
+            /* The held back blocks are no longer needed once the whole file is hashed. */
+            if( ( C->ulHashedBytes == C->ulFileSize ) && ( xReorderBuffer.pucData != NULL ) )
+            {
+                vPortFree( xReorderBuffer.pucData );
+                xReorderBuffer.pucData = NULL;
+            }
+        }
+    }
+
+#endif /* if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 ) */
+
+#if ( OTA_COMPRESSED_FILES == 1 )
+
+/* Output of the decompressor when the compressed file is a patch. */
+
+    static int16_t prvApplyPatchData( OTA_FileContext_t * const C,
+                                      uint32_t ulOffset,
+                                      uint8_t * const pacData,
+                                      uint32_t ulSize )
+    {
+        int16_t sResult = -1;
+
+        ( void ) C;
+        ( void ) ulOffset; /* The decompressor writes in order, which is all the patch needs. */
+
+        #if ( OTA_DELTA_UPDATE == 1 )
+            if( OTA_Delta_Apply( &xDeltaContext, pacData, ulSize ) == kOTA_Err_None )
+            {
+                sResult = ( int16_t ) ulSize;
+            }
+        #else
+            ( void ) pacData;
+            ( void ) ulSize;
+        #endif
+
+        return sResult;
+    }
+#endif
+
+static bool prvIsStreamedFile( const OTA_FileContext_t * C )
+{
+    return ( C->ulDeltaPatch != 0U ) || ( C->ulCompression != OTA_COMPRESSION_NONE );
+}
+
+static IngestResult_t prvStoreFileBlock( OTA_FileContext_t * C,
+                                         uint32_t ulBlockIndex,
+                                         uint8_t * pucPayload,
+                                         uint32_t ulBlockSize )
+{
+    DEFINE_OTA_METHOD_NAME( "prvStoreFileBlock" );
+
+    IngestResult_t eIngestResult = eIngest_Result_Accepted_Continue;
+    int32_t iBytesWritten;
+
+    if( C->ulCompression != OTA_COMPRESSION_NONE )
+    {
+        #if ( OTA_COMPRESSED_FILES == 1 )
+            /* The decompressor passes what it produces on to the file, or to the patch. */
+            if( OTA_Decompress_Apply( &xDecompressContext, pucPayload, ulBlockSize ) != kOTA_Err_None )
+            {
+                eIngestResult = eIngest_Result_DecompressFailed;
+            }
+        #else
+            eIngestResult = eIngest_Result_DecompressFailed; /* Not reached, the job is rejected. */
+        #endif
+    }
+    else if( C->ulDeltaPatch != 0U )
+    {
+        #if ( OTA_DELTA_UPDATE == 1 )
+            /* Rebuild the next part of the image from the patch and the running image. */
+            if( OTA_Delta_Apply( &xDeltaContext, pucPayload, ulBlockSize ) != kOTA_Err_None )
+            {
+                eIngestResult = eIngest_Result_PatchFailed;
+            }
+        #else
+            eIngestResult = eIngest_Result_PatchFailed; /* Not reached, the job is rejected. */
+        #endif
+    }
+    else
+    {
+        iBytesWritten = xOTA_Agent.xPALCallbacks.xWriteBlock( C, ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ), pucPayload, ulBlockSize );
+
+        if( iBytesWritten < 0 )
+        {
+            OTA_LOG_L1( "[%s] Error (%d) writing file block\r\n", OTA_METHOD_NAME, iBytesWritten );
+            eIngestResult = eIngest_Result_WriteBlockFailed;
+        }
+    }
+
+    return eIngestResult;
+}
+
+static IngestResult_t prvFinishStreamedFile( OTA_FileContext_t * C,
+                                             OTA_Err_t * pxCloseResult )
+{
+    IngestResult_t eIngestResult = eIngest_Result_Accepted_Continue;
+
+    #if ( OTA_COMPRESSED_FILES == 1 )
+        if( ( C->ulCompression != OTA_COMPRESSION_NONE ) && ( OTA_Decompress_Finish( &xDecompressContext ) != kOTA_Err_None ) )
+        {
+            *pxCloseResult = kOTA_Err_DecompressFailed;
+            eIngestResult = eIngest_Result_DecompressFailed;
+        }
+    #endif
+
+    #if ( OTA_DELTA_UPDATE == 1 )
+        /* Write out the end of the new image and make sure the patch was complete. */
+        if( ( eIngestResult == eIngest_Result_Accepted_Continue ) &&
+            ( C->ulDeltaPatch != 0U ) && ( OTA_Delta_Finish( &xDeltaContext ) != kOTA_Err_None ) )
+        {
+            *pxCloseResult = kOTA_Err_PatchFailed;
+            eIngestResult = eIngest_Result_PatchFailed;
+        }
+    #endif
+
+    ( void ) C;
+    ( void ) pxCloseResult;
+
+    return eIngestResult;
+}
+
 /*
  * prvIngestDataBlock
  *
@@ -2450,6 +3152,7 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     uint8_t * pucPayload = NULL;
     size_t xPayloadSize = 0;
     uint32_t ulByte = 0;
+    uint32_t ulNextBlock = 0;
     uint8_t ucBitMask = 0;
 
     /* Check if the file context is NULL. */
@@ -2536,24 +3239,45 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
         }
     }
 
+    /* A patch or compressed file is processed in order, so every block before the next one to
+     * use has been received. A block ahead of it can't be used yet, so drop it and request again
+     * from the stream position. */
+    if( ( eIngestResult == eIngest_Result_Uninitialized ) && ( prvIsStreamedFile( C ) == true ) )
+    {
+        ulNextBlock = ( ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE ) - C->ulBlocksRemaining;
+
+        if( ulBlockIndex != ulNextBlock )
+        {
+            OTA_LOG_L1( "[%s] Block %u is out of order, dropping it.\r\n", OTA_METHOD_NAME, ulBlockIndex );
+            xOTA_Agent.ulNextRequestBlock = ulNextBlock;
+            eIngestResult = eIngest_Result_OutOfOrder_Continue;
+            *pxCloseResult = kOTA_Err_None; /* This is a success path. */
+        }
+    }
+
     /* Process the received data block. */
     if( eIngestResult == eIngest_Result_Uninitialized )
     {
         if( C->pucFile != NULL )
         {
-            int32_t iBytesWritten = xOTA_Agent.xPALCallbacks.xWriteBlock( C, ( ulBlockIndex * OTA_FILE_BLOCK_SIZE ), pucPayload, ulBlockSize );
+            eIngestResult = prvStoreFileBlock( C, ulBlockIndex, pucPayload, ulBlockSize );
 
-            if( iBytesWritten < 0 )
-            {
-                OTA_LOG_L1( "[%s] Error (%d) writing file block\r\n", OTA_METHOD_NAME, iBytesWritten );
-                eIngestResult = eIngest_Result_WriteBlockFailed;
-            }
-            else
+            if( eIngestResult == eIngest_Result_Accepted_Continue )
             {
                 C->pucRxBlockBitmap[ ulByte ] &= ~ucBitMask; /* Mark this block as received in our bitmap. */
                 C->ulBlocksRemaining--;
-                eIngestResult = eIngest_Result_Accepted_Continue;
                 *pxCloseResult = kOTA_Err_None;
+
+                #if ( OTA_INCREMENTAL_SIGNATURE_CHECK == 1 )
+                    prvSigCheckUpdate( C, ulBlockIndex, pucPayload, ulBlockSize );
+                #endif
+
+                #if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+                    if( ( C->ulBlocksRemaining % OTA_RX_STATE_SAVE_INTERVAL ) == 0U )
+                    {
+                        prvSaveRxState( C );
+                    }
+                #endif
             }
         }
         else
@@ -2574,7 +3298,20 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
             vPortFree( C->pucRxBlockBitmap ); /* Free the bitmap now that we're done with the download. */
             C->pucRxBlockBitmap = NULL;
 
-            if( C->pucFile != NULL )
+            #if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+                ( void ) prvPAL_SaveRxState( C, NULL, 0 ); /* Nothing left to resume. */
+            #endif
+
+            if( prvIsStreamedFile( C ) == true )
+            {
+                eIngestResult = prvFinishStreamedFile( C, pxCloseResult );
+            }
+
+            if( eIngestResult != eIngest_Result_Accepted_Continue )
+            {
+                /* The image is incomplete. The file is aborted when the context is closed. */
+            }
+            else if( C->pucFile != NULL )
             {
                 *pxCloseResult = xOTA_Agent.xPALCallbacks.xCloseFile( C );
 
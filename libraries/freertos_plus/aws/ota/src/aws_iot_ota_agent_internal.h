@@ -55,6 +55,51 @@
 #else
     #define OTA_NUM_MSG_Q_ENTRIES    20U                   /* Maximum number of entries in the OTA message queue. */
 #endif
+#ifdef otaconfigMAX_NUM_OUTSTANDING_REQUESTS
+    #define OTA_MAX_NUM_OUTSTANDING_REQUESTS    otaconfigMAX_NUM_OUTSTANDING_REQUESTS
+#else
+    #define OTA_MAX_NUM_OUTSTANDING_REQUESTS    1U         /* Maximum number of data requests kept in flight. 1 disables pipelining. */
+#endif
+#ifdef otaconfigINCREMENTAL_SIGNATURE_CHECK
+    #define OTA_INCREMENTAL_SIGNATURE_CHECK    otaconfigINCREMENTAL_SIGNATURE_CHECK
+#else
+    #define OTA_INCREMENTAL_SIGNATURE_CHECK    0U           /* Hash file blocks as they are received instead of reading the file back at close. */
+#endif
+#ifdef otaconfigMAX_NUM_REORDER_BLOCKS
+    #define OTA_MAX_NUM_REORDER_BLOCKS    otaconfigMAX_NUM_REORDER_BLOCKS
+#else
+    #define OTA_MAX_NUM_REORDER_BLOCKS    2U                /* Number of out of order blocks held back for the incremental signature check. */
+#endif
+#ifdef otaconfigRESUMABLE_DOWNLOAD
+    #define OTA_RESUMABLE_DOWNLOAD    otaconfigRESUMABLE_DOWNLOAD
+#else
+    #define OTA_RESUMABLE_DOWNLOAD    0U                    /* Persist the block bitmap so an interrupted download can be resumed. */
+#endif
+#ifdef otaconfigRX_STATE_SAVE_INTERVAL
+    #define OTA_RX_STATE_SAVE_INTERVAL    otaconfigRX_STATE_SAVE_INTERVAL
+#else
+    #define OTA_RX_STATE_SAVE_INTERVAL    16U               /* Number of received blocks between saves of the download state. */
+#endif
+#ifdef otaconfigDELTA_UPDATE
+    #define OTA_DELTA_UPDATE    otaconfigDELTA_UPDATE
+#else
+    #define OTA_DELTA_UPDATE    0U                          /* Accept files that are binary patches against the running image. */
+#endif
+#ifdef otaconfigDELTA_BUFFER_SIZE
+    #define OTA_DELTA_BUFFER_SIZE    otaconfigDELTA_BUFFER_SIZE
+#else
+    #define OTA_DELTA_BUFFER_SIZE    512U                   /* Size of each of the running image and new image buffers used to apply a patch. */
+#endif
+#ifdef otaconfigCOMPRESSED_FILES
+    #define OTA_COMPRESSED_FILES    otaconfigCOMPRESSED_FILES
+#else
+    #define OTA_COMPRESSED_FILES    0U                      /* Accept files that are compressed for transfer. */
+#endif
+#ifdef otaconfigDECOMPRESS_WINDOW_SIZE
+    #define OTA_DECOMPRESS_WINDOW_SIZE    otaconfigDECOMPRESS_WINDOW_SIZE
+#else
+    #define OTA_DECOMPRESS_WINDOW_SIZE    1024U             /* Largest match offset supported in a compressed file. A power of 2. */
+#endif
 
 /* Job document parser constants. */
 #define OTA_MAX_JSON_TOKENS         64U                                                                         /* Number of JSON tokens supported in a single parser call. */
@@ -88,9 +133,12 @@ typedef enum
     eIngest_Result_BadData = -8,            /* The data block from the server was malformed. */
     eIngest_Result_WriteBlockFailed = -9,   /* The PAL layer failed to write the file block. */
     eIngest_Result_NullResultPointer = -10, /* The pointer to the close result pointer was null. */
+    eIngest_Result_PatchFailed = -11,       /* The block could not be applied as a patch to the running image. */
+    eIngest_Result_DecompressFailed = -12,  /* The block could not be decompressed. */
     eIngest_Result_Uninitialized = -127,    /* Software BUG: We forgot to set the result code. */
     eIngest_Result_Accepted_Continue = 0,   /* The block was accepted and we're expecting more. */
     eIngest_Result_Duplicate_Continue = 1,  /* The block was a duplicate but that's OK. Continue. */
+    eIngest_Result_OutOfOrder_Continue = 2, /* The block is ahead of the stream position of a patch or compressed file. It was dropped and will be requested again. */
 } IngestResult_t;
 
 /* Generic JSON document parser errors. */
@@ -205,7 +253,7 @@ enum
  * size, attributes, etc. The following value specifies the number of parameters
  * that are included in the job document model although some may be optional. */
 
-#define OTA_NUM_JOB_PARAMS              ( 20 ) /* Number of parameters in the job document. */
+#define OTA_NUM_JOB_PARAMS              ( 22 ) /* Number of parameters in the job document. */
 
 /* Keys in OTA job doc . */
 #define OTA_JSON_CLIENT_TOKEN_KEY       "clientToken"
@@ -224,10 +272,16 @@ enum
 #define OTA_JSON_FILE_SIZE_KEY          "filesize"
 #define OTA_JSON_FILE_ID_KEY            "fileid"
 #define OTA_JSON_FILE_ATTRIBUTE_KEY     "attr"
+#define OTA_JSON_FILE_DELTA_KEY         "delta"
+#define OTA_JSON_FILE_COMPRESSION_KEY   "compression"
 #define OTA_JSON_FILE_CERT_NAME_KEY     "certfile"
 #define OTA_JSON_UPDATE_DATA_URL_KEY    "update_data_url"
 #define OTA_JSON_AUTH_SCHEME_KEY        "auth_scheme"
 
+/* Values of the compression key of a file in the OTA job doc. */
+#define OTA_COMPRESSION_NONE            0U /* The file is sent as it is. */
+#define OTA_COMPRESSION_LZ              1U /* The file is an LZ4 stream with a small window, see aws_iot_ota_decompress.h. */
+
 /* This is the OTA statistics structure to hold useful info. */
 
 typedef struct ota_agent_statistics
@@ -260,6 +314,10 @@ typedef struct ota_agent_context
     OTA_AgentStatistics_t xStatistics;                      /* The OTA agent statistics block. */
     SemaphoreHandle_t xOTA_ThreadSafetyMutex;               /* Mutex used to ensure thread safety while managing data buffers. */
     uint32_t ulRequestMomentum;                             /* The number of requests sent before a response was received. */
+    uint32_t ulRequestWindow;                               /* Number of data requests currently allowed to be in flight. */
+    uint32_t ulMaxRequestWindow;                            /* Upper limit of the request window, set by the data interface. */
+    uint32_t ulRequestsInFlight;                            /* Number of data requests sent whose blocks have not all arrived. */
+    uint32_t ulNextRequestBlock;                            /* Index of the first block not covered by an outstanding request. */
 } OTA_AgentContext_t;
 
 /* The OTA Agent event and data structures. */
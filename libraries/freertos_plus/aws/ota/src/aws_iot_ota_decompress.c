@@ -0,0 +1,361 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_ota_decompress.c
+ * @brief Streaming decompression of compressed OTA files.
+ */
+
+/* Standard library includes. */
+#include <string.h>
+
+/* OTA decompression includes. */
+#include "aws_iot_ota_decompress.h"
+
+/* Mask to turn a position in the file into an index in the window. */
+#define OTA_DECOMPRESS_WINDOW_MASK    ( OTA_DECOMPRESS_WINDOW_SIZE - 1U )
+
+/* Largest write passed to the output callback, which returns a 16 bit count. */
+#define OTA_DECOMPRESS_MAX_WRITE      0x4000U
+
+/* Length nibble value that is extended by the following bytes. */
+#define OTA_DECOMPRESS_LEN_EXTEND     15U
+
+/* Read a little endian 32 bit field of the stream header. */
+
+static uint32_t prvReadLE32( const uint8_t * pucField )
+{
+    return ( ( uint32_t ) pucField[ 0 ] ) |
+           ( ( uint32_t ) pucField[ 1 ] << 8 ) |
+           ( ( uint32_t ) pucField[ 2 ] << 16 ) |
+           ( ( uint32_t ) pucField[ 3 ] << 24 );
+}
+
+/* Write out the decompressed bytes that are only in the window so far. */
+
+static bool prvFlushOutput( OTA_DecompressContext_t * pxCtx )
+{
+    OTA_DecompressState_t * pxState = &pxCtx->xState;
+    uint32_t ulIndex;
+    uint32_t ulLength;
+    bool bResult = true;
+
+    while( ( bResult == true ) && ( pxState->ulWrittenPos < pxState->ulOutPos ) )
+    {
+        /* Write up to the end of the window, where the pending bytes wrap around. */
+        ulIndex = pxState->ulWrittenPos & OTA_DECOMPRESS_WINDOW_MASK;
+        ulLength = pxState->ulOutPos - pxState->ulWrittenPos;
+
+        if( ulLength > ( OTA_DECOMPRESS_WINDOW_SIZE - ulIndex ) )
+        {
+            ulLength = OTA_DECOMPRESS_WINDOW_SIZE - ulIndex;
+        }
+
+        if( ulLength > OTA_DECOMPRESS_MAX_WRITE )
+        {
+            ulLength = OTA_DECOMPRESS_MAX_WRITE;
+        }
+
+        if( pxCtx->xWriteOutput( pxCtx->C, pxState->ulWrittenPos, &pxState->ucWindow[ ulIndex ], ulLength ) == ( int16_t ) ulLength )
+        {
+            pxState->ulWrittenPos += ulLength;
+        }
+        else
+        {
+            bResult = false;
+        }
+    }
+
+    return bResult;
+}
+
+/* Add a byte to the decompressed file. */
+
+static bool prvPutByte( OTA_DecompressContext_t * pxCtx,
+                        uint8_t ucByte )
+{
+    OTA_DecompressState_t * pxState = &pxCtx->xState;
+    bool bResult = false;
+
+    if( pxState->ulOutPos < pxState->ulOutSize )
+    {
+        pxState->ucWindow[ pxState->ulOutPos & OTA_DECOMPRESS_WINDOW_MASK ] = ucByte;
+        pxState->ulOutPos++;
+        bResult = true;
+
+        /* Write the window out before it starts overwriting bytes that were not written yet. */
+        if( ( pxState->ulOutPos - pxState->ulWrittenPos ) == OTA_DECOMPRESS_WINDOW_SIZE )
+        {
+            bResult = prvFlushOutput( pxCtx );
+        }
+    }
+
+    return bResult;
+}
+
+/* Copy a match from the window. */
+
+static OTA_DecompressStep_t prvCopyMatch( OTA_DecompressContext_t * pxCtx )
+{
+    OTA_DecompressState_t * pxState = &pxCtx->xState;
+    OTA_DecompressStep_t eStep = eOTA_DecompressState_Error;
+    uint32_t ulLength = pxState->ulMatchLen + OTA_DECOMPRESS_MIN_MATCH;
+    bool bResult = true;
+
+    if( ulLength <= ( pxState->ulOutSize - pxState->ulOutPos ) )
+    {
+        while( ( bResult == true ) && ( ulLength > 0U ) )
+        {
+            bResult = prvPutByte( pxCtx, pxState->ucWindow[ ( pxState->ulOutPos - pxState->ulOffset ) & OTA_DECOMPRESS_WINDOW_MASK ] );
+            ulLength--;
+        }
+
+        if( bResult == true )
+        {
+            eStep = ( pxState->ulOutPos == pxState->ulOutSize ) ? eOTA_DecompressState_Done : eOTA_DecompressState_Token;
+        }
+    }
+
+    return eStep;
+}
+
+/* Move on once the literal length of a sequence is known. */
+
+static OTA_DecompressStep_t prvLiteralLenComplete( OTA_DecompressState_t * pxState )
+{
+    OTA_DecompressStep_t eStep = eOTA_DecompressState_Error;
+
+    if( pxState->ulLiteralLen > ( pxState->ulOutSize - pxState->ulOutPos ) )
+    {
+        /* More literals than there is file left. */
+    }
+    else if( pxState->ulLiteralLen > 0U )
+    {
+        eStep = eOTA_DecompressState_Literals;
+    }
+    else if( pxState->ulOutPos == pxState->ulOutSize )
+    {
+        eStep = eOTA_DecompressState_Done;
+    }
+    else
+    {
+        pxState->ulOffset = 0;
+        pxState->ulFieldLen = 0;
+        eStep = eOTA_DecompressState_Offset;
+    }
+
+    return eStep;
+}
+
+/* Decode one byte of the stream. */
+
+static OTA_DecompressStep_t prvDecodeByte( OTA_DecompressContext_t * pxCtx,
+                                           uint8_t ucByte )
+{
+    OTA_DecompressState_t * pxState = &pxCtx->xState;
+    OTA_DecompressStep_t eStep = eOTA_DecompressState_Error;
+
+    switch( pxState->eStep )
+    {
+        case eOTA_DecompressState_Header:
+            pxState->ucHeader[ pxState->ulFieldLen ] = ucByte;
+            pxState->ulFieldLen++;
+            eStep = eOTA_DecompressState_Header;
+
+            if( pxState->ulFieldLen == OTA_DECOMPRESS_HEADER_SIZE )
+            {
+                pxState->ulOutSize = prvReadLE32( &pxState->ucHeader[ 4 ] );
+                pxState->ulWindowSize = prvReadLE32( &pxState->ucHeader[ 8 ] );
+
+                if( ( prvReadLE32( &pxState->ucHeader[ 0 ] ) != OTA_DECOMPRESS_MAGIC ) ||
+                    ( pxState->ulWindowSize == 0U ) ||
+                    ( pxState->ulWindowSize > OTA_DECOMPRESS_WINDOW_SIZE ) )
+                {
+                    eStep = eOTA_DecompressState_Error;
+                }
+                else
+                {
+                    eStep = ( pxState->ulOutSize == 0U ) ? eOTA_DecompressState_Done : eOTA_DecompressState_Token;
+                }
+            }
+
+            break;
+
+        case eOTA_DecompressState_Token:
+            pxState->ulLiteralLen = ( uint32_t ) ucByte >> 4;
+            pxState->ulMatchLen = ( uint32_t ) ucByte & 0x0fU;
+            eStep = ( pxState->ulLiteralLen == OTA_DECOMPRESS_LEN_EXTEND ) ? eOTA_DecompressState_LiteralLen : prvLiteralLenComplete( pxState );
+            break;
+
+        case eOTA_DecompressState_LiteralLen:
+            pxState->ulLiteralLen += ucByte;
+
+            if( pxState->ulLiteralLen > ( pxState->ulOutSize - pxState->ulOutPos ) )
+            {
+                /* Stop before the length can overflow. */
+            }
+            else if( ucByte == 0xffU )
+            {
+                eStep = eOTA_DecompressState_LiteralLen;
+            }
+            else
+            {
+                eStep = prvLiteralLenComplete( pxState );
+            }
+
+            break;
+
+        case eOTA_DecompressState_Literals:
+
+            if( prvPutByte( pxCtx, ucByte ) == true )
+            {
+                pxState->ulLiteralLen--;
+                eStep = eOTA_DecompressState_Literals;
+
+                if( pxState->ulLiteralLen == 0U )
+                {
+                    eStep = prvLiteralLenComplete( pxState );
+                }
+            }
+
+            break;
+
+        case eOTA_DecompressState_Offset:
+            pxState->ulOffset |= ( uint32_t ) ucByte << ( 8U * pxState->ulFieldLen );
+            pxState->ulFieldLen++;
+            eStep = eOTA_DecompressState_Offset;
+
+            if( pxState->ulFieldLen == 2U )
+            {
+                /* The match must lie within the window and within what was produced so far. */
+                if( ( pxState->ulOffset == 0U ) ||
+                    ( pxState->ulOffset > pxState->ulWindowSize ) ||
+                    ( pxState->ulOffset > pxState->ulOutPos ) )
+                {
+                    eStep = eOTA_DecompressState_Error;
+                }
+                else if( pxState->ulMatchLen == OTA_DECOMPRESS_LEN_EXTEND )
+                {
+                    eStep = eOTA_DecompressState_MatchLen;
+                }
+                else
+                {
+                    eStep = prvCopyMatch( pxCtx );
+                }
+            }
+
+            break;
+
+        case eOTA_DecompressState_MatchLen:
+            pxState->ulMatchLen += ucByte;
+
+            if( pxState->ulMatchLen > ( pxState->ulOutSize - pxState->ulOutPos ) )
+            {
+                /* Stop before the length can overflow. */
+            }
+            else if( ucByte == 0xffU )
+            {
+                eStep = eOTA_DecompressState_MatchLen;
+            }
+            else
+            {
+                eStep = prvCopyMatch( pxCtx );
+            }
+
+            break;
+
+        default:
+            /* Nothing may follow the end of the stream. */
+            break;
+    }
+
+    return eStep;
+}
+
+/*-----------------------------------------------------------*/
+
+void OTA_Decompress_Init( OTA_DecompressContext_t * pxCtx,
+                          OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteOutput )
+{
+    ( void ) memset( pxCtx, 0, sizeof( OTA_DecompressContext_t ) );
+
+    pxCtx->C = C;
+    pxCtx->xWriteOutput = xWriteOutput;
+    pxCtx->xState.eStep = eOTA_DecompressState_Header;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t OTA_Decompress_Apply( OTA_DecompressContext_t * pxCtx,
+                                const uint8_t * pucData,
+                                uint32_t ulSize )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Decompress_Apply" );
+
+    OTA_DecompressState_t * pxState = &pxCtx->xState;
+    uint32_t ulIndex = 0;
+
+    while( ( ulIndex < ulSize ) && ( pxState->eStep != eOTA_DecompressState_Error ) )
+    {
+        pxState->eStep = prvDecodeByte( pxCtx, pucData[ ulIndex ] );
+        ulIndex++;
+    }
+
+    pxState->ulInPos += ulIndex;
+
+    /* Leave nothing behind in the window so the written file always matches the input consumed. */
+    if( ( pxState->eStep != eOTA_DecompressState_Error ) && ( prvFlushOutput( pxCtx ) == false ) )
+    {
+        pxState->eStep = eOTA_DecompressState_Error;
+    }
+
+    if( pxState->eStep == eOTA_DecompressState_Error )
+    {
+        OTA_LOG_L1( "[%s] Error: decompression failed at offset %u, output offset %u.\r\n", OTA_METHOD_NAME, pxState->ulInPos, pxState->ulOutPos );
+    }
+
+    return ( pxState->eStep == eOTA_DecompressState_Error ) ? kOTA_Err_DecompressFailed : kOTA_Err_None;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t OTA_Decompress_Finish( OTA_DecompressContext_t * pxCtx )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Decompress_Finish" );
+
+    OTA_Err_t xErr = kOTA_Err_DecompressFailed;
+
+    if( ( pxCtx->xState.eStep == eOTA_DecompressState_Done ) && ( pxCtx->xState.ulWrittenPos == pxCtx->xState.ulOutSize ) )
+    {
+        xErr = kOTA_Err_None;
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] Error: compressed file ended after %u of %u bytes.\r\n", OTA_METHOD_NAME, pxCtx->xState.ulOutPos, pxCtx->xState.ulOutSize );
+    }
+
+    return xErr;
+}
@@ -0,0 +1,140 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef __AWS_IOT_OTA_DECOMPRESS__H__
+#define __AWS_IOT_OTA_DECOMPRESS__H__
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+
+/*
+ * Compressed file format.
+ *
+ * A compressed file is an LZ4 block stream whose match offsets are limited to a small window,
+ * so that it can be decompressed as it streams in with only OTA_DECOMPRESS_WINDOW_SIZE bytes of
+ * history. The stream starts with a header of 32 bit little endian fields:
+ *
+ *      magic           OTA_DECOMPRESS_MAGIC
+ *      size            Size of the decompressed file.
+ *      window size     Largest match offset used by the stream. At most OTA_DECOMPRESS_WINDOW_SIZE.
+ *
+ * followed by LZ4 sequences. Each one has a token byte, whose high nibble is the literal length
+ * and low nibble the match length minus 4, with a nibble of 15 extended by following bytes as in
+ * LZ4. The literals come next, then a 16 bit little endian match offset. The last sequence ends
+ * after its literals, once the whole file has been produced.
+ */
+#define OTA_DECOMPRESS_MAGIC          0x315a4c4fUL /* "OLZ1" */
+#define OTA_DECOMPRESS_HEADER_SIZE    12U
+#define OTA_DECOMPRESS_MIN_MATCH      4U
+
+#if ( ( OTA_DECOMPRESS_WINDOW_SIZE & ( OTA_DECOMPRESS_WINDOW_SIZE - 1U ) ) != 0U ) || ( OTA_DECOMPRESS_WINDOW_SIZE > 65536U )
+    #error "otaconfigDECOMPRESS_WINDOW_SIZE must be a power of 2 no larger than 65536."
+#endif
+
+/**
+ * @brief Where the decoder is in the compressed stream.
+ */
+typedef enum
+{
+    eOTA_DecompressState_Header,      /* Collecting the stream header. */
+    eOTA_DecompressState_Token,       /* Expecting a sequence token. */
+    eOTA_DecompressState_LiteralLen,  /* Collecting extra literal length bytes. */
+    eOTA_DecompressState_Literals,    /* Copying literals. */
+    eOTA_DecompressState_Offset,      /* Collecting the match offset. */
+    eOTA_DecompressState_MatchLen,    /* Collecting extra match length bytes. */
+    eOTA_DecompressState_Done,        /* The whole file has been produced. */
+    eOTA_DecompressState_Error        /* The stream is malformed or a write failed. */
+} OTA_DecompressStep_t;
+
+/**
+ * @brief Decoder state.
+ *
+ * Holds no pointers, so it can be saved with the download state and restored after a reset.
+ */
+typedef struct
+{
+    OTA_DecompressStep_t eStep;                     /* Where the decoder is in the stream. */
+    uint32_t ulInPos;                               /* Number of compressed bytes consumed. */
+    uint8_t ucHeader[ OTA_DECOMPRESS_HEADER_SIZE ]; /* The stream header being collected. */
+    uint32_t ulOutSize;                             /* Size of the decompressed file from the header. */
+    uint32_t ulWindowSize;                          /* Largest match offset from the header. */
+    uint32_t ulLiteralLen;                          /* Literals left to copy, or the length being collected. */
+    uint32_t ulMatchLen;                            /* Match length being collected. */
+    uint32_t ulOffset;                              /* Match offset being collected. */
+    uint32_t ulFieldLen;                            /* Number of bytes collected for the current field. */
+    uint32_t ulOutPos;                              /* Number of decompressed bytes produced. */
+    uint32_t ulWrittenPos;                          /* Number of decompressed bytes written out. */
+    uint8_t ucWindow[ OTA_DECOMPRESS_WINDOW_SIZE ]; /* The most recently produced bytes. */
+} OTA_DecompressState_t;
+
+/**
+ * @brief Decompression context.
+ */
+typedef struct
+{
+    OTA_FileContext_t * C;                      /* The file context passed to xWriteOutput. */
+    pxOTAPALWriteBlockCallback_t xWriteOutput;  /* Writes the decompressed file. */
+    OTA_DecompressState_t xState;               /* Decoder state. */
+} OTA_DecompressContext_t;
+
+/**
+ * @brief Prepare to decompress a file.
+ *
+ * @param[out] pxCtx The decompression context to initialize.
+ * @param[in] C The file context passed to xWriteOutput.
+ * @param[in] xWriteOutput Writes the decompressed file.
+ */
+void OTA_Decompress_Init( OTA_DecompressContext_t * pxCtx,
+                          OTA_FileContext_t * C,
+                          pxOTAPALWriteBlockCallback_t xWriteOutput );
+
+/**
+ * @brief Decompress the next part of a file.
+ *
+ * The compressed stream must be passed in order but may be split anywhere. All output produced
+ * from the data has been written by the time this returns.
+ *
+ * @param[in] pxCtx The decompression context.
+ * @param[in] pucData The next compressed bytes.
+ * @param[in] ulSize Number of compressed bytes.
+ *
+ * @return kOTA_Err_None on success, otherwise kOTA_Err_DecompressFailed. Once an error is
+ * returned, every later call fails.
+ */
+OTA_Err_t OTA_Decompress_Apply( OTA_DecompressContext_t * pxCtx,
+                                const uint8_t * pucData,
+                                uint32_t ulSize );
+
+/**
+ * @brief Check that the whole file was decompressed.
+ *
+ * @param[in] pxCtx The decompression context.
+ *
+ * @return kOTA_Err_None if the whole file was produced, otherwise kOTA_Err_DecompressFailed.
+ */
+OTA_Err_t OTA_Decompress_Finish( OTA_DecompressContext_t * pxCtx );
+
+#endif /* ifndef __AWS_IOT_OTA_DECOMPRESS__H__ */
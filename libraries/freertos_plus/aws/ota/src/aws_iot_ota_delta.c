@@ -0,0 +1,316 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_iot_ota_delta.c
+ * @brief Streaming application of delta patches against the running image.
+ */
+
+/* Standard library includes. */
+#include <string.h>
+
+/* OTA delta includes. */
+#include "aws_iot_ota_delta.h"
+
+/* Read a little endian 32 bit field of the patch. */
+
+static uint32_t prvReadLE32( const uint8_t * pucField )
+{
+    return ( ( uint32_t ) pucField[ 0 ] ) |
+           ( ( uint32_t ) pucField[ 1 ] << 8 ) |
+           ( ( uint32_t ) pucField[ 2 ] << 16 ) |
+           ( ( uint32_t ) pucField[ 3 ] << 24 );
+}
+
+/* Write out the buffered part of the new image. */
+
+static bool prvFlushImage( OTA_DeltaContext_t * pxCtx )
+{
+    bool bResult = true;
+
+    if( pxCtx->ulImageLen > 0U )
+    {
+        if( pxCtx->xWriteImage( pxCtx->C,
+                                pxCtx->ulImagePos - pxCtx->ulImageLen,
+                                pxCtx->ucImage,
+                                pxCtx->ulImageLen ) != ( int16_t ) pxCtx->ulImageLen )
+        {
+            bResult = false;
+        }
+
+        pxCtx->ulImageLen = 0;
+    }
+
+    return bResult;
+}
+
+/* Add a byte to the new image. */
+
+static bool prvPutImageByte( OTA_DeltaContext_t * pxCtx,
+                             uint8_t ucByte )
+{
+    bool bResult = false;
+
+    if( pxCtx->ulImagePos < pxCtx->ulNewSize )
+    {
+        pxCtx->ucImage[ pxCtx->ulImageLen ] = ucByte;
+        pxCtx->ulImageLen++;
+        pxCtx->ulImagePos++;
+        bResult = true;
+
+        if( pxCtx->ulImageLen == OTA_DELTA_BUFFER_SIZE )
+        {
+            bResult = prvFlushImage( pxCtx );
+        }
+    }
+
+    return bResult;
+}
+
+/* Get the byte at the current position in the running image and move past it. */
+
+static bool prvGetBaseByte( OTA_DeltaContext_t * pxCtx,
+                            uint8_t * pucByte )
+{
+    bool bResult = false;
+    uint32_t ulLength;
+
+    if( pxCtx->ulBasePos < pxCtx->ulBaseSize )
+    {
+        if( ( pxCtx->ulBasePos < pxCtx->ulBaseStart ) ||
+            ( pxCtx->ulBasePos >= ( pxCtx->ulBaseStart + pxCtx->ulBaseLen ) ) )
+        {
+            /* Refill the cache starting at the current position. */
+            ulLength = pxCtx->ulBaseSize - pxCtx->ulBasePos;
+
+            if( ulLength > OTA_DELTA_BUFFER_SIZE )
+            {
+                ulLength = OTA_DELTA_BUFFER_SIZE;
+            }
+
+            pxCtx->ulBaseStart = pxCtx->ulBasePos;
+            pxCtx->ulBaseLen = 0;
+
+            if( pxCtx->xReadBase( pxCtx->C, pxCtx->ulBasePos, pxCtx->ucBase, ulLength ) == ( int16_t ) ulLength )
+            {
+                pxCtx->ulBaseLen = ulLength;
+            }
+        }
+
+        if( pxCtx->ulBasePos < ( pxCtx->ulBaseStart + pxCtx->ulBaseLen ) )
+        {
+            *pucByte = pxCtx->ucBase[ pxCtx->ulBasePos - pxCtx->ulBaseStart ];
+            pxCtx->ulBasePos++;
+            bResult = true;
+        }
+    }
+
+    return bResult;
+}
+
+/* Move to the next record once the diff and extra bytes of the current one are done. */
+
+static OTA_DeltaState_t prvEndRecord( OTA_DeltaContext_t * pxCtx )
+{
+    OTA_DeltaState_t eState = eOTA_DeltaState_Error;
+    int64_t llBasePos = ( int64_t ) pxCtx->ulBasePos + ( int64_t ) pxCtx->lSeek;
+
+    if( ( llBasePos >= 0 ) && ( llBasePos <= ( int64_t ) pxCtx->ulBaseSize ) )
+    {
+        pxCtx->ulBasePos = ( uint32_t ) llBasePos;
+        eState = ( pxCtx->ulImagePos == pxCtx->ulNewSize ) ? eOTA_DeltaState_Done : eOTA_DeltaState_Record;
+    }
+
+    return eState;
+}
+
+/* Act on a completed patch header or record control fields. */
+
+static OTA_DeltaState_t prvFieldComplete( OTA_DeltaContext_t * pxCtx )
+{
+    OTA_DeltaState_t eState = eOTA_DeltaState_Error;
+    uint32_t ulImageLeft;
+
+    pxCtx->ulFieldLen = 0;
+
+    if( pxCtx->eState == eOTA_DeltaState_Header )
+    {
+        if( prvReadLE32( &pxCtx->ucField[ 0 ] ) == OTA_DELTA_MAGIC )
+        {
+            pxCtx->ulBaseSize = prvReadLE32( &pxCtx->ucField[ 4 ] );
+            pxCtx->ulNewSize = prvReadLE32( &pxCtx->ucField[ 8 ] );
+            eState = ( pxCtx->ulNewSize == 0U ) ? eOTA_DeltaState_Done : eOTA_DeltaState_Record;
+        }
+    }
+    else
+    {
+        pxCtx->ulDiffLeft = prvReadLE32( &pxCtx->ucField[ 0 ] );
+        pxCtx->ulExtraLeft = prvReadLE32( &pxCtx->ucField[ 4 ] );
+        pxCtx->lSeek = ( int32_t ) prvReadLE32( &pxCtx->ucField[ 8 ] );
+        ulImageLeft = pxCtx->ulNewSize - pxCtx->ulImagePos;
+
+        /* A record may not produce more than what is left of the new image. */
+        if( ( pxCtx->ulDiffLeft <= ulImageLeft ) && ( pxCtx->ulExtraLeft <= ( ulImageLeft - pxCtx->ulDiffLeft ) ) )
+        {
+            if( pxCtx->ulDiffLeft > 0U )
+            {
+                eState = eOTA_DeltaState_Diff;
+            }
+            else if( pxCtx->ulExtraLeft > 0U )
+            {
+                eState = eOTA_DeltaState_Extra;
+            }
+            else
+            {
+                eState = prvEndRecord( pxCtx );
+            }
+        }
+    }
+
+    return eState;
+}
+
+/*-----------------------------------------------------------*/
+
+void OTA_Delta_Init( OTA_DeltaContext_t * pxCtx,
+                     OTA_FileContext_t * C,
+                     OTA_DeltaIOCallback_t xReadBase,
+                     OTA_DeltaIOCallback_t xWriteImage )
+{
+    ( void ) memset( pxCtx, 0, sizeof( OTA_DeltaContext_t ) );
+
+    pxCtx->C = C;
+    pxCtx->xReadBase = xReadBase;
+    pxCtx->xWriteImage = xWriteImage;
+    pxCtx->eState = eOTA_DeltaState_Header;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t OTA_Delta_Apply( OTA_DeltaContext_t * pxCtx,
+                           const uint8_t * pucPatch,
+                           uint32_t ulSize )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Delta_Apply" );
+
+    uint32_t ulIndex = 0;
+    uint32_t ulFieldSize;
+    uint8_t ucBaseByte = 0;
+
+    while( ( ulIndex < ulSize ) && ( pxCtx->eState != eOTA_DeltaState_Error ) )
+    {
+        switch( pxCtx->eState )
+        {
+            case eOTA_DeltaState_Header:
+            case eOTA_DeltaState_Record:
+                ulFieldSize = ( pxCtx->eState == eOTA_DeltaState_Header ) ? OTA_DELTA_HEADER_SIZE : OTA_DELTA_RECORD_SIZE;
+                pxCtx->ucField[ pxCtx->ulFieldLen ] = pucPatch[ ulIndex ];
+                pxCtx->ulFieldLen++;
+
+                if( pxCtx->ulFieldLen == ulFieldSize )
+                {
+                    pxCtx->eState = prvFieldComplete( pxCtx );
+                }
+
+                break;
+
+            case eOTA_DeltaState_Diff:
+
+                if( ( prvGetBaseByte( pxCtx, &ucBaseByte ) == false ) ||
+                    ( prvPutImageByte( pxCtx, ( uint8_t ) ( ucBaseByte + pucPatch[ ulIndex ] ) ) == false ) )
+                {
+                    pxCtx->eState = eOTA_DeltaState_Error;
+                }
+                else
+                {
+                    pxCtx->ulDiffLeft--;
+
+                    if( pxCtx->ulDiffLeft == 0U )
+                    {
+                        pxCtx->eState = ( pxCtx->ulExtraLeft > 0U ) ? eOTA_DeltaState_Extra : prvEndRecord( pxCtx );
+                    }
+                }
+
+                break;
+
+            case eOTA_DeltaState_Extra:
+
+                if( prvPutImageByte( pxCtx, pucPatch[ ulIndex ] ) == false )
+                {
+                    pxCtx->eState = eOTA_DeltaState_Error;
+                }
+                else
+                {
+                    pxCtx->ulExtraLeft--;
+
+                    if( pxCtx->ulExtraLeft == 0U )
+                    {
+                        pxCtx->eState = prvEndRecord( pxCtx );
+                    }
+                }
+
+                break;
+
+            default:
+                /* Nothing may follow the end of the patch. */
+                pxCtx->eState = eOTA_DeltaState_Error;
+                break;
+        }
+
+        ulIndex++;
+    }
+
+    pxCtx->ulPatchOffset += ulIndex;
+
+    if( pxCtx->eState == eOTA_DeltaState_Error )
+    {
+        OTA_LOG_L1( "[%s] Error: patch failed at offset %u, image offset %u.\r\n", OTA_METHOD_NAME, pxCtx->ulPatchOffset, pxCtx->ulImagePos );
+    }
+
+    return ( pxCtx->eState == eOTA_DeltaState_Error ) ? kOTA_Err_PatchFailed : kOTA_Err_None;
+}
+
+/*-----------------------------------------------------------*/
+
+OTA_Err_t OTA_Delta_Finish( OTA_DeltaContext_t * pxCtx )
+{
+    DEFINE_OTA_METHOD_NAME( "OTA_Delta_Finish" );
+
+    OTA_Err_t xErr = kOTA_Err_PatchFailed;
+
+    if( pxCtx->eState == eOTA_DeltaState_Done )
+    {
+        if( prvFlushImage( pxCtx ) == true )
+        {
+            xErr = kOTA_Err_None;
+        }
+    }
+    else
+    {
+        OTA_LOG_L1( "[%s] Error: patch ended after %u of %u image bytes.\r\n", OTA_METHOD_NAME, pxCtx->ulImagePos, pxCtx->ulNewSize );
+    }
+
+    return xErr;
+}
@@ -0,0 +1,149 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef __AWS_IOT_OTA_DELTA__H__
+#define __AWS_IOT_OTA_DELTA__H__
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_agent_internal.h"
+
+/*
+ * Delta patch format.
+ *
+ * A delta patch rebuilds the new image from the image that is currently running. It follows the
+ * bsdiff layout but interleaves the control, diff and extra data so that it can be applied as it
+ * streams in, with no more RAM than two OTA_DELTA_BUFFER_SIZE buffers. All fields are 32 bit
+ * little endian.
+ *
+ * The patch starts with a header:
+ *
+ *      magic       OTA_DELTA_MAGIC
+ *      base size   Size of the running image the patch was made against.
+ *      new size    Size of the image the patch produces.
+ *
+ * followed by records until the whole new image has been produced:
+ *
+ *      diff length     Number of diff bytes that follow.
+ *      extra length    Number of extra bytes that follow the diff bytes.
+ *      seek            Signed offset to move the running image position by after the record.
+ *      diff bytes      Each one is added, modulo 256, to the next byte of the running image.
+ *      extra bytes     Copied to the new image as they are.
+ */
+#define OTA_DELTA_MAGIC          0x31544c44UL /* "DLT1" */
+#define OTA_DELTA_HEADER_SIZE    12U
+#define OTA_DELTA_RECORD_SIZE    12U
+
+/**
+ * @brief Reads from the running image or writes to the new image.
+ *
+ * Has the same signature as prvPAL_WriteBlock(). Returns the number of bytes transferred or a
+ * negative value on error.
+ */
+typedef int16_t (* OTA_DeltaIOCallback_t)( OTA_FileContext_t * const C,
+                                           uint32_t ulOffset,
+                                           uint8_t * const pcData,
+                                           uint32_t ulBlockSize );
+
+/**
+ * @brief Where the patch parser is in the patch.
+ */
+typedef enum
+{
+    eOTA_DeltaState_Header,  /* Collecting the patch header. */
+    eOTA_DeltaState_Record,  /* Collecting the control fields of a record. */
+    eOTA_DeltaState_Diff,    /* Applying the diff bytes of a record. */
+    eOTA_DeltaState_Extra,   /* Copying the extra bytes of a record. */
+    eOTA_DeltaState_Done,    /* The whole new image has been produced. */
+    eOTA_DeltaState_Error    /* The patch is malformed or an image access failed. */
+} OTA_DeltaState_t;
+
+/**
+ * @brief State of a patch being applied.
+ */
+typedef struct
+{
+    OTA_FileContext_t * C;                      /* The file context passed to the I/O callbacks. */
+    OTA_DeltaIOCallback_t xReadBase;            /* Reads the running image. */
+    OTA_DeltaIOCallback_t xWriteImage;          /* Writes the new image. */
+    OTA_DeltaState_t eState;                    /* Where the parser is in the patch. */
+    uint32_t ulPatchOffset;                     /* Number of patch bytes consumed so far. */
+    uint8_t ucField[ OTA_DELTA_RECORD_SIZE ];   /* The header or control fields being collected. */
+    uint32_t ulFieldLen;                        /* Number of bytes collected in ucField. */
+    uint32_t ulBaseSize;                        /* Size of the running image from the patch header. */
+    uint32_t ulNewSize;                         /* Size of the new image from the patch header. */
+    uint32_t ulDiffLeft;                        /* Diff bytes left in the current record. */
+    uint32_t ulExtraLeft;                       /* Extra bytes left in the current record. */
+    int32_t lSeek;                              /* Seek of the current record. */
+    uint32_t ulBasePos;                         /* Position in the running image. */
+    uint32_t ulImagePos;                        /* Number of new image bytes produced so far. */
+    uint8_t ucBase[ OTA_DELTA_BUFFER_SIZE ];    /* Cached part of the running image. */
+    uint32_t ulBaseStart;                       /* Running image offset of ucBase[ 0 ]. */
+    uint32_t ulBaseLen;                         /* Number of valid bytes in ucBase. */
+    uint8_t ucImage[ OTA_DELTA_BUFFER_SIZE ];   /* New image bytes not written yet. */
+    uint32_t ulImageLen;                        /* Number of valid bytes in ucImage. */
+} OTA_DeltaContext_t;
+
+/**
+ * @brief Prepare to apply a patch.
+ *
+ * @param[out] pxCtx The patch context to initialize.
+ * @param[in] C The file context passed to the I/O callbacks.
+ * @param[in] xReadBase Reads the running image.
+ * @param[in] xWriteImage Writes the new image.
+ */
+void OTA_Delta_Init( OTA_DeltaContext_t * pxCtx,
+                     OTA_FileContext_t * C,
+                     OTA_DeltaIOCallback_t xReadBase,
+                     OTA_DeltaIOCallback_t xWriteImage );
+
+/**
+ * @brief Apply the next part of a patch.
+ *
+ * The patch must be passed in order but may be split anywhere.
+ *
+ * @param[in] pxCtx The patch context.
+ * @param[in] pucPatch The next patch bytes.
+ * @param[in] ulSize Number of patch bytes.
+ *
+ * @return kOTA_Err_None on success, otherwise kOTA_Err_PatchFailed. Once an error is returned,
+ * every later call fails.
+ */
+OTA_Err_t OTA_Delta_Apply( OTA_DeltaContext_t * pxCtx,
+                           const uint8_t * pucPatch,
+                           uint32_t ulSize );
+
+/**
+ * @brief Finish applying a patch.
+ *
+ * Writes out the last of the new image and checks that the whole patch was received.
+ *
+ * @param[in] pxCtx The patch context.
+ *
+ * @return kOTA_Err_None if the whole new image was produced, otherwise kOTA_Err_PatchFailed.
+ */
+OTA_Err_t OTA_Delta_Finish( OTA_DeltaContext_t * pxCtx );
+
+#endif /* ifndef __AWS_IOT_OTA_DELTA__H__ */
@@ -88,6 +88,10 @@ OTA_Err_t prvPAL_CreateFileForRx( OTA_FileContext_t * const C );
  * never be NULL.
  *
  * If the signature verification fails, file close should still be attempted.
+ * If C->pvSigVerifyContext is not NULL, the OTA agent has already fed the first C->ulHashedBytes
+ * bytes of the file to it as the blocks were received. When that covers the whole file, the PAL may
+ * pass the context straight to CRYPTO_SignatureVerificationFinal() instead of reading the file back.
+ * A PAL that takes ownership of the context must set C->pvSigVerifyContext to NULL.
  *
  * @param[in] C OTA file context information.
  *
@@ -124,6 +128,79 @@ int16_t prvPAL_WriteBlock( OTA_FileContext_t * const C,
                            uint8_t * const pcData,
                            uint32_t ulBlockSize );
 
+/**
+ * @brief Open the partially received file of an interrupted download for writing.
+ *
+ * Only used when otaconfigRESUMABLE_DOWNLOAD is enabled. Unlike prvPAL_CreateFileForRx(), the
+ * blocks already written to the file must be kept. The PAL should fail if the file does not exist
+ * or cannot belong to the download described by C, for example if it is larger than C->ulFileSize.
+ * A compressed file (C->ulCompression != 0) is written out decompressed, so it can be larger than
+ * C->ulFileSize, which is the compressed size.
+ *
+ * @param[in] C OTA file context information.
+ *
+ * @return The OTA PAL layer error code combined with the MCU specific error code. See OTA Agent
+ * error codes information in aws_iot_ota_agent.h.
+ *
+ * kOTA_Err_None is returned when the partial file was opened.
+ * kOTA_Err_RxFileCreateFailed is returned if the partial file cannot be opened.
+ */
+OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C );
+
+/**
+ * @brief Save the download state of the file in the specified OTA context.
+ *
+ * Only used when otaconfigRESUMABLE_DOWNLOAD is enabled. The state is an opaque blob built by the
+ * OTA agent that must survive a reset. Every block marked as received in the state has already been
+ * passed to prvPAL_WriteBlock(), so the PAL must make those writes persistent before storing the
+ * state. If pucState is NULL, any saved state for the file shall be erased.
+ *
+ * @param[in] C OTA file context information.
+ * @param[in] pucState Pointer to the state to save, or NULL to erase the saved state.
+ * @param[in] ulStateSize Size of the state in bytes.
+ *
+ * @return kOTA_Err_None on success, otherwise an OTA PAL layer error code.
+ */
+OTA_Err_t prvPAL_SaveRxState( OTA_FileContext_t * const C,
+                              const uint8_t * pucState,
+                              uint32_t ulStateSize );
+
+/**
+ * @brief Load the download state previously saved by prvPAL_SaveRxState().
+ *
+ * Only used when otaconfigRESUMABLE_DOWNLOAD is enabled.
+ *
+ * @param[in] C OTA file context information.
+ * @param[out] pucState Buffer to load the state into.
+ * @param[in] ulMaxStateSize Size of the buffer in bytes.
+ *
+ * @return The number of bytes loaded, or 0 if there is no saved state.
+ */
+uint32_t prvPAL_LoadRxState( OTA_FileContext_t * const C,
+                             uint8_t * pucState,
+                             uint32_t ulMaxStateSize );
+
+/**
+ * @brief Read part of the image that is currently running.
+ *
+ * Only used when otaconfigDELTA_UPDATE is enabled. A delta patch describes the new image in terms
+ * of the running one, so the agent reads the running image while it applies the patch. The new
+ * image is still written with prvPAL_WriteBlock(), in order and in pieces of up to
+ * otaconfigDELTA_BUFFER_SIZE bytes, so the PAL must not write over the running image while it is
+ * being read. Note that C->ulFileSize is the size of the patch, not of the new image.
+ *
+ * @param[in] C OTA file context information.
+ * @param[in] ulOffset Offset into the running image to read from.
+ * @param[out] pacData Buffer to read into.
+ * @param[in] ulBlockSize Number of bytes to read.
+ *
+ * @return The number of bytes read, or a negative error code from the platform abstraction layer.
+ */
+int16_t prvPAL_ReadBaseImage( OTA_FileContext_t * const C,
+                              uint32_t ulOffset,
+                              uint8_t * const pacData,
+                              uint32_t ulBlockSize );
+
 /**
  * @brief Activate the newest MCU image received via OTA.
  *
@@ -1021,6 +1021,9 @@ OTA_Err_t _AwsIotOTA_InitFileTransfer_HTTP( OTA_AgentContext_t * pAgentCtx )
     /* Exit directly if everything succeed. */
     IotLogInfo( "Start requesting %u bytes from HTTP server.", ( unsigned int ) httpFileSize );
 
+    /* The downloader handles one range request at a time. */
+    pAgentCtx->ulMaxRequestWindow = 1;
+
     OTA_FUNCTION_CLEANUP_BEGIN();
 
     if( cleanupRequired )
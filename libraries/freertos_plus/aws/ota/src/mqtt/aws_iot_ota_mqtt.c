@@ -787,6 +787,10 @@ OTA_Err_t prvInitFileTransfer_Mqtt( OTA_AgentContext_t * pxAgentCtx )
         else
         {
             OTA_LOG_L1( "[%s] OK: %s\n\r", OTA_METHOD_NAME, xOTAUpdateDataSubscription.pTopicFilter );
+
+            /* The streaming service answers each request independently, so allow
+             * several requests to be in flight at once. */
+            pxAgentCtx->ulMaxRequestWindow = OTA_MAX_NUM_OUTSTANDING_REQUESTS;
             xResult = kOTA_Err_None;
         }
     }
@@ -807,26 +811,51 @@ OTA_Err_t prvRequestFileBlock_Mqtt( OTA_AgentContext_t * pxAgentCtx )
 
     size_t xMsgSizeFromStream;
     uint32_t ulNumBlocks, ulBitmapLen;
+    uint32_t ulFirstByte, ulBlock, ulRequested;
     uint32_t ulMsgSizeToPublish = 0;
     uint32_t ulTopicLen = 0;
     IotMqttError_t eResult = IOT_MQTT_STATUS_PENDING;
     OTA_Err_t xErr = kOTA_Err_Uninitialized;
     char pcMsg[ OTA_REQUEST_MSG_MAX_SIZE ];
     char pcTopicBuffer[ OTA_MAX_TOPIC_LEN ];
+    uint8_t pucRequestBitmap[ OTA_MAX_BLOCK_BITMAP_SIZE ];
 
     /*
      * Get the current file context.
      */
     OTA_FileContext_t * C = &( pxAgentCtx->pxOTA_Files[ pxAgentCtx->ulFileIndex ] );
 
-    /* Reset number of blocks requested. */
-    pxAgentCtx->ulNumOfBlocksToReceive = otaconfigMAX_NUM_BLOCKS_REQUEST;
+    /* Reset number of blocks requested when starting a new window of requests. */
+    if( pxAgentCtx->ulRequestsInFlight == 0U )
+    {
+        pxAgentCtx->ulNumOfBlocksToReceive = otaconfigMAX_NUM_BLOCKS_REQUEST;
+    }
 
-    if( C != NULL )
+    if( ( C != NULL ) && ( C->pucRxBlockBitmap != NULL ) )
     {
         ulNumBlocks = ( C->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
         ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
 
+        /* The request bitmap starts at the byte holding the next block to request. Blocks
+         * before it are either received or covered by a request that is still in flight. */
+        ulFirstByte = pxAgentCtx->ulNextRequestBlock >> LOG2_BITS_PER_BYTE;
+
+        if( ulFirstByte >= ulBitmapLen )
+        {
+            ulFirstByte = 0;
+            pxAgentCtx->ulNextRequestBlock = 0;
+        }
+
+        ulBitmapLen -= ulFirstByte;
+
+        if( ulBitmapLen > sizeof( pucRequestBitmap ) )
+        {
+            ulBitmapLen = sizeof( pucRequestBitmap );
+        }
+
+        ( void ) memcpy( pucRequestBitmap, &C->pucRxBlockBitmap[ ulFirstByte ], ulBitmapLen );
+        pucRequestBitmap[ 0 ] &= ( uint8_t ) ( 0xffU << ( pxAgentCtx->ulNextRequestBlock % BITS_PER_BYTE ) );
+
         if( pdTRUE == OTA_CBOR_Encode_GetStreamRequestMessage(
                 ( uint8_t * ) pcMsg,
                 sizeof( pcMsg ),
@@ -834,12 +863,25 @@ OTA_Err_t prvRequestFileBlock_Mqtt( OTA_AgentContext_t * pxAgentCtx )
                 OTA_CLIENT_TOKEN,
                 ( int32_t ) C->ulServerFileID,
                 ( int32_t ) ( OTA_FILE_BLOCK_SIZE & 0x7fffffffUL ), /* Mask to keep lint happy. It's still a constant. */
-                0,
-                C->pucRxBlockBitmap,
+                ( int32_t ) ( ulFirstByte << LOG2_BITS_PER_BYTE ),
+                pucRequestBitmap,
                 ulBitmapLen,
                 otaconfigMAX_NUM_BLOCKS_REQUEST ) )
         {
             xErr = kOTA_Err_None;
+
+            /* Move the request cursor past the missing blocks the service will send for this request. */
+            ulRequested = 0;
+
+            for( ulBlock = pxAgentCtx->ulNextRequestBlock; ( ulBlock < ulNumBlocks ) && ( ulRequested < otaconfigMAX_NUM_BLOCKS_REQUEST ); ulBlock++ )
+            {
+                if( ( C->pucRxBlockBitmap[ ulBlock >> LOG2_BITS_PER_BYTE ] & ( 1U << ( ulBlock % BITS_PER_BYTE ) ) ) != 0U )
+                {
+                    ulRequested++;
+                }
+            }
+
+            pxAgentCtx->ulNextRequestBlock = ulBlock;
         }
         else
         {
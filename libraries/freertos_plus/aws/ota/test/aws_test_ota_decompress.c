@@ -0,0 +1,320 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_decompress.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+
+
+/* Size of the test file. It spans several windows. */
+#define otatestDECOMPRESS_FILE_SIZE        ( 4U * OTA_DECOMPRESS_WINDOW_SIZE + 300U )
+#define otatestDECOMPRESS_MAX_STREAM       ( otatestDECOMPRESS_FILE_SIZE + ( otatestDECOMPRESS_FILE_SIZE / 8U ) + 64U )
+
+/* Length of the literal runs and repeats of the test file. */
+#define otatestDECOMPRESS_LITERAL_RUN      40U
+#define otatestDECOMPRESS_REPEAT_RUN       300U
+
+static uint8_t ucFile[ otatestDECOMPRESS_FILE_SIZE ];
+static uint8_t ucOutFile[ otatestDECOMPRESS_FILE_SIZE ];
+static uint8_t ucStream[ otatestDECOMPRESS_MAX_STREAM ];
+static uint32_t ulStreamSize;
+static uint32_t ulLastOffset;
+static OTA_DecompressContext_t xDecompressCtx;
+
+/*-----------------------------------------------------------*/
+
+static int16_t prvWriteFile( OTA_FileContext_t * const C,
+                             uint32_t ulOffset,
+                             uint8_t * const pacData,
+                             uint32_t ulBlockSize )
+{
+    int16_t sResult = -1;
+
+    ( void ) C;
+
+    if( ( ulOffset + ulBlockSize ) <= sizeof( ucOutFile ) )
+    {
+        memcpy( &ucOutFile[ ulOffset ], pacData, ulBlockSize );
+        sResult = ( int16_t ) ulBlockSize;
+    }
+
+    return sResult;
+}
+
+static void prvPutLE32( uint32_t ulValue )
+{
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ulValue;
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ( ulValue >> 8 );
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ( ulValue >> 16 );
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ( ulValue >> 24 );
+}
+
+static void prvPutLength( uint32_t ulLength )
+{
+    while( ulLength >= 0xffU )
+    {
+        ucStream[ ulStreamSize++ ] = 0xffU;
+        ulLength -= 0xffU;
+    }
+
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ulLength;
+}
+
+/* Add a sequence of literals followed by a match, or just literals if the match length is 0. */
+static void prvPutSequence( const uint8_t * pucLiterals,
+                            uint32_t ulLiteralLen,
+                            uint32_t ulOffset,
+                            uint32_t ulMatchLen )
+{
+    uint32_t ulLiteralNibble = ( ulLiteralLen < 15U ) ? ulLiteralLen : 15U;
+    uint32_t ulMatchNibble = 0;
+
+    if( ulMatchLen > 0U )
+    {
+        ulMatchNibble = ( ( ulMatchLen - OTA_DECOMPRESS_MIN_MATCH ) < 15U ) ? ( ulMatchLen - OTA_DECOMPRESS_MIN_MATCH ) : 15U;
+    }
+
+    ucStream[ ulStreamSize++ ] = ( uint8_t ) ( ( ulLiteralNibble << 4 ) | ulMatchNibble );
+
+    if( ulLiteralNibble == 15U )
+    {
+        prvPutLength( ulLiteralLen - 15U );
+    }
+
+    memcpy( &ucStream[ ulStreamSize ], pucLiterals, ulLiteralLen );
+    ulStreamSize += ulLiteralLen;
+
+    if( ulMatchLen > 0U )
+    {
+        ulLastOffset = ulStreamSize;
+        ucStream[ ulStreamSize++ ] = ( uint8_t ) ulOffset;
+        ucStream[ ulStreamSize++ ] = ( uint8_t ) ( ulOffset >> 8 );
+
+        if( ulMatchNibble == 15U )
+        {
+            prvPutLength( ulMatchLen - OTA_DECOMPRESS_MIN_MATCH - 15U );
+        }
+    }
+}
+
+/*
+ * The test file alternates runs of fresh bytes with repeats of earlier data, at offsets
+ * from a few bytes (overlapping the bytes being produced) up to the whole window. Build
+ * the file and its compressed stream.
+ */
+static void prvBuildStream( void )
+{
+    uint32_t ulPos = 0;
+    uint32_t ulLiteralStart;
+    uint32_t ulRun;
+    uint32_t ulOffset;
+    uint32_t ulIndex;
+    uint32_t ulSequence = 0;
+
+    ulStreamSize = 0;
+    prvPutLE32( OTA_DECOMPRESS_MAGIC );
+    prvPutLE32( otatestDECOMPRESS_FILE_SIZE );
+    prvPutLE32( OTA_DECOMPRESS_WINDOW_SIZE );
+
+    while( ulPos < otatestDECOMPRESS_FILE_SIZE )
+    {
+        ulRun = otatestDECOMPRESS_LITERAL_RUN + ( ulSequence % 3U );
+
+        if( ulRun > ( otatestDECOMPRESS_FILE_SIZE - ulPos ) )
+        {
+            ulRun = otatestDECOMPRESS_FILE_SIZE - ulPos;
+        }
+
+        for( ulIndex = 0; ulIndex < ulRun; ulIndex++ )
+        {
+            ucFile[ ulPos + ulIndex ] = ( uint8_t ) ( ( ulPos + ulIndex ) * 13U + ulSequence );
+        }
+
+        ulLiteralStart = ulPos;
+        ulPos += ulRun;
+
+        /* Cycle through short, medium and whole window offsets. */
+        ulOffset = ( ulSequence % 3U == 0U ) ? 3U : ( ( ulSequence % 3U == 1U ) ? 200U : OTA_DECOMPRESS_WINDOW_SIZE );
+
+        if( ulOffset > ulPos )
+        {
+            ulOffset = ulPos;
+        }
+
+        ulRun = otatestDECOMPRESS_REPEAT_RUN;
+
+        if( ulRun > ( otatestDECOMPRESS_FILE_SIZE - ulPos ) )
+        {
+            ulRun = otatestDECOMPRESS_FILE_SIZE - ulPos;
+        }
+
+        if( ulRun < OTA_DECOMPRESS_MIN_MATCH )
+        {
+            ulRun = 0;
+        }
+
+        for( ulIndex = 0; ulIndex < ulRun; ulIndex++ )
+        {
+            ucFile[ ulPos + ulIndex ] = ucFile[ ulPos + ulIndex - ulOffset ];
+        }
+
+        prvPutSequence( &ucFile[ ulLiteralStart ], ulPos - ulLiteralStart, ulOffset, ulRun );
+        ulPos += ulRun;
+        ulSequence++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_DECOMPRESS );
+
+TEST_SETUP( Full_OTA_DECOMPRESS )
+{
+    prvBuildStream();
+    memset( ucOutFile, 0, sizeof( ucOutFile ) );
+    OTA_Decompress_Init( &xDecompressCtx, NULL, prvWriteFile );
+}
+
+TEST_TEAR_DOWN( Full_OTA_DECOMPRESS )
+{
+}
+
+TEST_GROUP_RUNNER( Full_OTA_DECOMPRESS )
+{
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, DecompressWholeFile );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, DecompressInPieces );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, ResumeFromSavedState );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, RejectBadMagic );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, RejectWindowTooLarge );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, RejectTruncatedStream );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, RejectTrailingData );
+    RUN_TEST_CASE( Full_OTA_DECOMPRESS, RejectOffsetOutsideWindow );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_DECOMPRESS, DecompressWholeFile )
+{
+    TEST_ASSERT_TRUE( ulStreamSize < otatestDECOMPRESS_FILE_SIZE );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Finish( &xDecompressCtx ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucFile, ucOutFile, sizeof( ucFile ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, DecompressInPieces )
+{
+    uint32_t ulOffset = 0;
+    uint32_t ulPiece = 1;
+
+    /* Split the stream at every kind of boundary, including inside the header and lengths. */
+    while( ulOffset < ulStreamSize )
+    {
+        if( ulPiece > ( ulStreamSize - ulOffset ) )
+        {
+            ulPiece = ulStreamSize - ulOffset;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Apply( &xDecompressCtx, &ucStream[ ulOffset ], ulPiece ) );
+
+        /* Everything produced so far has been written out. */
+        TEST_ASSERT_EQUAL_UINT32( xDecompressCtx.xState.ulOutPos, xDecompressCtx.xState.ulWrittenPos );
+
+        ulOffset += ulPiece;
+        ulPiece = ( ulPiece % 41U ) + 1U;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Finish( &xDecompressCtx ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucFile, ucOutFile, sizeof( ucFile ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, ResumeFromSavedState )
+{
+    OTA_DecompressState_t xSavedState;
+    uint32_t ulSplit = ulStreamSize / 2U;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulSplit ) );
+    memcpy( &xSavedState, &xDecompressCtx.xState, sizeof( xSavedState ) );
+
+    /* Continue in a fresh context as the agent does after a reset. */
+    OTA_Decompress_Init( &xDecompressCtx, NULL, prvWriteFile );
+    memcpy( &xDecompressCtx.xState, &xSavedState, sizeof( xSavedState ) );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Apply( &xDecompressCtx, &ucStream[ ulSplit ], ulStreamSize - ulSplit ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Finish( &xDecompressCtx ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucFile, ucOutFile, sizeof( ucFile ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, RejectBadMagic )
+{
+    ucStream[ 0 ] ^= 0xffU;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Finish( &xDecompressCtx ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, RejectWindowTooLarge )
+{
+    uint32_t ulWindow = OTA_DECOMPRESS_WINDOW_SIZE + 1U;
+
+    ucStream[ 8 ] = ( uint8_t ) ulWindow;
+    ucStream[ 9 ] = ( uint8_t ) ( ulWindow >> 8 );
+    ucStream[ 10 ] = ( uint8_t ) ( ulWindow >> 16 );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, RejectTruncatedStream )
+{
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize - 1U ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Finish( &xDecompressCtx ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, RejectTrailingData )
+{
+    ucStream[ ulStreamSize ] = 0U;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize + 1U ) );
+}
+
+TEST( Full_OTA_DECOMPRESS, RejectOffsetOutsideWindow )
+{
+    /* Point the last match one byte further back than the window reaches. */
+    ucStream[ ulLastOffset ] = ( uint8_t ) ( OTA_DECOMPRESS_WINDOW_SIZE + 1U );
+    ucStream[ ulLastOffset + 1U ] = ( uint8_t ) ( ( OTA_DECOMPRESS_WINDOW_SIZE + 1U ) >> 8 );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_DecompressFailed, OTA_Decompress_Apply( &xDecompressCtx, ucStream, ulStreamSize ) );
+}
@@ -0,0 +1,254 @@
+/*
+ * FreeRTOS OTA V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* OTA includes. */
+#include "aws_iot_ota_agent.h"
+#include "aws_iot_ota_delta.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+#include "unity.h"
+
+/* Sizes of the test images. They span several delta buffers. */
+#define otatestDELTA_BASE_SIZE     ( 3U * OTA_DELTA_BUFFER_SIZE + 100U )
+#define otatestDELTA_NEW_SIZE      ( 3U * OTA_DELTA_BUFFER_SIZE + 60U )
+#define otatestDELTA_MAX_PATCH     ( otatestDELTA_NEW_SIZE + 128U )
+
+/* Layout of the test patch. */
+#define otatestDELTA_DIFF1_LEN     ( 2U * OTA_DELTA_BUFFER_SIZE + 10U )
+#define otatestDELTA_EXTRA1_LEN    50U
+#define otatestDELTA_SEEK1         90
+#define otatestDELTA_DIFF2_LEN     ( otatestDELTA_NEW_SIZE - otatestDELTA_DIFF1_LEN - otatestDELTA_EXTRA1_LEN )
+
+static uint8_t ucBaseImage[ otatestDELTA_BASE_SIZE ];
+static uint8_t ucNewImage[ otatestDELTA_NEW_SIZE ];
+static uint8_t ucOutImage[ otatestDELTA_NEW_SIZE ];
+static uint8_t ucPatch[ otatestDELTA_MAX_PATCH ];
+static uint32_t ulPatchSize;
+static OTA_DeltaContext_t xDeltaCtx;
+
+/*-----------------------------------------------------------*/
+
+static int16_t prvReadBase( OTA_FileContext_t * const C,
+                            uint32_t ulOffset,
+                            uint8_t * const pacData,
+                            uint32_t ulBlockSize )
+{
+    int16_t sResult = -1;
+
+    ( void ) C;
+
+    if( ( ulOffset + ulBlockSize ) <= sizeof( ucBaseImage ) )
+    {
+        memcpy( pacData, &ucBaseImage[ ulOffset ], ulBlockSize );
+        sResult = ( int16_t ) ulBlockSize;
+    }
+
+    return sResult;
+}
+
+static int16_t prvWriteImage( OTA_FileContext_t * const C,
+                              uint32_t ulOffset,
+                              uint8_t * const pacData,
+                              uint32_t ulBlockSize )
+{
+    int16_t sResult = -1;
+
+    ( void ) C;
+
+    if( ( ulOffset + ulBlockSize ) <= sizeof( ucOutImage ) )
+    {
+        memcpy( &ucOutImage[ ulOffset ], pacData, ulBlockSize );
+        sResult = ( int16_t ) ulBlockSize;
+    }
+
+    return sResult;
+}
+
+static void prvPutLE32( uint32_t ulValue )
+{
+    ucPatch[ ulPatchSize++ ] = ( uint8_t ) ulValue;
+    ucPatch[ ulPatchSize++ ] = ( uint8_t ) ( ulValue >> 8 );
+    ucPatch[ ulPatchSize++ ] = ( uint8_t ) ( ulValue >> 16 );
+    ucPatch[ ulPatchSize++ ] = ( uint8_t ) ( ulValue >> 24 );
+}
+
+/*
+ * The new image is the start of the base image with every byte incremented, some
+ * fresh bytes, then the end of the base image skipping 90 bytes, left unchanged.
+ * Build the new image and the patch that turns the base image into it.
+ */
+static void prvBuildPatch( void )
+{
+    uint32_t ulIndex;
+    uint32_t ulBasePos;
+
+    for( ulIndex = 0; ulIndex < sizeof( ucBaseImage ); ulIndex++ )
+    {
+        ucBaseImage[ ulIndex ] = ( uint8_t ) ( ulIndex * 7U );
+    }
+
+    ulPatchSize = 0;
+    prvPutLE32( OTA_DELTA_MAGIC );
+    prvPutLE32( otatestDELTA_BASE_SIZE );
+    prvPutLE32( otatestDELTA_NEW_SIZE );
+
+    prvPutLE32( otatestDELTA_DIFF1_LEN );
+    prvPutLE32( otatestDELTA_EXTRA1_LEN );
+    prvPutLE32( ( uint32_t ) otatestDELTA_SEEK1 );
+
+    for( ulIndex = 0; ulIndex < otatestDELTA_DIFF1_LEN; ulIndex++ )
+    {
+        ucNewImage[ ulIndex ] = ( uint8_t ) ( ucBaseImage[ ulIndex ] + 1U );
+        ucPatch[ ulPatchSize++ ] = 1U;
+    }
+
+    for( ulIndex = 0; ulIndex < otatestDELTA_EXTRA1_LEN; ulIndex++ )
+    {
+        ucNewImage[ otatestDELTA_DIFF1_LEN + ulIndex ] = ( uint8_t ) ( 0xa5U ^ ulIndex );
+        ucPatch[ ulPatchSize++ ] = ( uint8_t ) ( 0xa5U ^ ulIndex );
+    }
+
+    prvPutLE32( otatestDELTA_DIFF2_LEN );
+    prvPutLE32( 0 );
+    prvPutLE32( 0 );
+
+    ulBasePos = otatestDELTA_DIFF1_LEN + otatestDELTA_SEEK1;
+
+    for( ulIndex = 0; ulIndex < otatestDELTA_DIFF2_LEN; ulIndex++ )
+    {
+        ucNewImage[ otatestDELTA_DIFF1_LEN + otatestDELTA_EXTRA1_LEN + ulIndex ] = ucBaseImage[ ulBasePos + ulIndex ];
+        ucPatch[ ulPatchSize++ ] = 0U;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_OTA_DELTA );
+
+TEST_SETUP( Full_OTA_DELTA )
+{
+    prvBuildPatch();
+    memset( ucOutImage, 0, sizeof( ucOutImage ) );
+    OTA_Delta_Init( &xDeltaCtx, NULL, prvReadBase, prvWriteImage );
+}
+
+TEST_TEAR_DOWN( Full_OTA_DELTA )
+{
+}
+
+TEST_GROUP_RUNNER( Full_OTA_DELTA )
+{
+    RUN_TEST_CASE( Full_OTA_DELTA, ApplyWholePatch );
+    RUN_TEST_CASE( Full_OTA_DELTA, ApplyPatchInPieces );
+    RUN_TEST_CASE( Full_OTA_DELTA, RejectBadMagic );
+    RUN_TEST_CASE( Full_OTA_DELTA, RejectTruncatedPatch );
+    RUN_TEST_CASE( Full_OTA_DELTA, RejectTrailingData );
+    RUN_TEST_CASE( Full_OTA_DELTA, RejectRecordPastImageEnd );
+    RUN_TEST_CASE( Full_OTA_DELTA, RejectSeekOutsideBase );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_OTA_DELTA, ApplyWholePatch )
+{
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Finish( &xDeltaCtx ) );
+    TEST_ASSERT_EQUAL_UINT32( ulPatchSize, xDeltaCtx.ulPatchOffset );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucOutImage, sizeof( ucNewImage ) );
+}
+
+TEST( Full_OTA_DELTA, ApplyPatchInPieces )
+{
+    uint32_t ulOffset = 0;
+    uint32_t ulPiece = 1;
+
+    /* Split the patch at every kind of boundary, including inside the header and records. */
+    while( ulOffset < ulPatchSize )
+    {
+        if( ulPiece > ( ulPatchSize - ulOffset ) )
+        {
+            ulPiece = ulPatchSize - ulOffset;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Apply( &xDeltaCtx, &ucPatch[ ulOffset ], ulPiece ) );
+        ulOffset += ulPiece;
+        ulPiece = ( ulPiece % 37U ) + 1U;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Finish( &xDeltaCtx ) );
+    TEST_ASSERT_EQUAL_UINT8_ARRAY( ucNewImage, ucOutImage, sizeof( ucNewImage ) );
+}
+
+TEST( Full_OTA_DELTA, RejectBadMagic )
+{
+    ucPatch[ 0 ] ^= 0xffU;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Finish( &xDeltaCtx ) );
+}
+
+TEST( Full_OTA_DELTA, RejectTruncatedPatch )
+{
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_None, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize - 1U ) );
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Finish( &xDeltaCtx ) );
+}
+
+TEST( Full_OTA_DELTA, RejectTrailingData )
+{
+    ucPatch[ ulPatchSize ] = 0U;
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize + 1U ) );
+}
+
+TEST( Full_OTA_DELTA, RejectRecordPastImageEnd )
+{
+    /* Make the first record claim one more extra byte than the new image has room for. */
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 4U ] = ( uint8_t ) ( otatestDELTA_NEW_SIZE - otatestDELTA_DIFF1_LEN + 1U );
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 5U ] = ( uint8_t ) ( ( otatestDELTA_NEW_SIZE - otatestDELTA_DIFF1_LEN + 1U ) >> 8 );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize ) );
+}
+
+TEST( Full_OTA_DELTA, RejectSeekOutsideBase )
+{
+    /* Seek back past the start of the base image. */
+    uint32_t ulSeek = ( uint32_t ) ( -( int32_t ) ( otatestDELTA_DIFF1_LEN + 1U ) );
+
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 8U ] = ( uint8_t ) ulSeek;
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 9U ] = ( uint8_t ) ( ulSeek >> 8 );
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 10U ] = ( uint8_t ) ( ulSeek >> 16 );
+    ucPatch[ OTA_DELTA_HEADER_SIZE + 11U ] = ( uint8_t ) ( ulSeek >> 24 );
+
+    TEST_ASSERT_EQUAL_UINT32( kOTA_Err_PatchFailed, OTA_Delta_Apply( &xDeltaCtx, ucPatch, ulPatchSize ) );
+}
@@ -47,6 +47,7 @@
 
 #include "aws_ota_codesigner_certificate.h"
 #include "aws_test_ota_config.h"
+#include "aws_ota_agent_config.h"
 
 
 /* The Texas Instruments CC3220SF has special requirements on its file system security.
@@ -169,6 +170,12 @@ TEST_GROUP_RUNNER( Full_OTA_PAL )
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_WriteBlock_WriteSingleByte );
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_WriteBlock_WriteManyBlocks );
 
+    #if ( otaconfigRESUMABLE_DOWNLOAD == 1 )
+        RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ResumeFileForRx_PartialFile );
+        RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ResumeFileForRx_FileTooLarge );
+        RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ResumeFileForRx_CompressedFile );
+    #endif
+
     /* This test resets the device so it is not valid for an MCU. */
     RUN_TEST_CASE( Full_OTA_PAL, prvPAL_ActivateNewImage );
 
@@ -617,6 +624,80 @@ TEST( Full_OTA_PAL, prvPAL_WriteBlock_WriteManyBlocks )
     }
 }
 
+#if ( otaconfigRESUMABLE_DOWNLOAD == 1 )
+
+/**
+ * @brief Write ulNumBlocks blocks of ucDummyData to the firmware file and close it, as if
+ * the download had been interrupted.
+ */
+    static void prvWritePartialFile( uint32_t ulNumBlocks )
+    {
+        OTA_Err_t xOtaStatus;
+        int16_t sNumBytesWritten;
+        uint32_t ulIndex;
+
+        xOtaFile.pucFilePath = ( uint8_t * ) otatestpalFIRMWARE_FILE;
+        xOtaStatus = prvPAL_CreateFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+
+        for( ulIndex = 0; ulIndex < ulNumBlocks; ulIndex++ )
+        {
+            sNumBytesWritten = prvPAL_WriteBlock( &xOtaFile, ulIndex * sizeof( ucDummyData ), ucDummyData, sizeof( ucDummyData ) );
+            TEST_ASSERT_EQUAL_INT( sizeof( ucDummyData ), sNumBytesWritten );
+        }
+
+        /* Closing the file keeps what was written. */
+        xOtaStatus = prvPAL_Abort( &xOtaFile );
+        TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
+    }
+
+/**
+ * @brief Reopen a file that holds part of the download. Verify success.
+ */
+    TEST( Full_OTA_PAL, prvPAL_ResumeFileForRx_PartialFile )
+    {
+        OTA_Err_t xOtaStatus;
+
+        prvWritePartialFile( 1 );
+
+        xOtaFile.ulFileSize = sizeof( ucDummyData ) * testotapalNUM_WRITE_BLOCKS;
+        xOtaStatus = prvPAL_ResumeFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+    }
+
+/**
+ * @brief A file larger than the one being received was not written by this download.
+ * Verify it is not reopened.
+ */
+    TEST( Full_OTA_PAL, prvPAL_ResumeFileForRx_FileTooLarge )
+    {
+        OTA_Err_t xOtaStatus;
+
+        prvWritePartialFile( testotapalNUM_WRITE_BLOCKS );
+
+        xOtaFile.ulFileSize = sizeof( ucDummyData );
+        xOtaStatus = prvPAL_ResumeFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_RxFileCreateFailed, xOtaStatus & ~kOTA_PAL_ErrMask );
+    }
+
+/**
+ * @brief A compressed file is written out decompressed, so the partial file can be larger
+ * than the compressed size of the download. Verify it is reopened.
+ */
+    TEST( Full_OTA_PAL, prvPAL_ResumeFileForRx_CompressedFile )
+    {
+        OTA_Err_t xOtaStatus;
+
+        prvWritePartialFile( testotapalNUM_WRITE_BLOCKS );
+
+        xOtaFile.ulFileSize = sizeof( ucDummyData );
+        xOtaFile.ulCompression = 1U; /* An LZ4 stream, see aws_iot_ota_decompress.h. */
+        xOtaStatus = prvPAL_ResumeFileForRx( &xOtaFile );
+        TEST_ASSERT_EQUAL( kOTA_Err_None, xOtaStatus );
+    }
+
+#endif /* if ( otaconfigRESUMABLE_DOWNLOAD == 1 ) */
+
 /**
  * Call prvPAL_ActivateNewImage() and verify success. This function is expected to
  * reset the device, so this test is only supported on the Windows Simulator environment.
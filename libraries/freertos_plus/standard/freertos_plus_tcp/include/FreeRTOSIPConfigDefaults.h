@@ -147,6 +147,34 @@ from the FreeRTOSIPConfig.h configuration header file. */
 		#define	ipconfigTCP_WIN_SEG_COUNT		( 256 )
 	#endif
 
+	/* The maximum number of blocks in a SACK option, which reports the ranges
+	of data that were received out-of-order.  The TCP options can hold at most
+	4 blocks.  Each block adds 8 bytes to the TCP header of every socket's last
+	packet and to the minimum size of a network buffer. */
+	#ifndef ipconfigTCP_SACK_BLOCKS
+		#define ipconfigTCP_SACK_BLOCKS		( 3 )
+	#endif
+
+	#if( ipconfigTCP_SACK_BLOCKS < 1 ) || ( ipconfigTCP_SACK_BLOCKS > 4 )
+		#error ipconfigTCP_SACK_BLOCKS must be between 1 and 4
+	#endif
+
+	/* Congestion control of the transmission window, the algorithm used by
+	new TCP sockets:
+	0: none, only the peer's window limits transmission
+	1: NewReno (RFC 5681, RFC 6582)
+	2: CUBIC (RFC 8312), NewReno can still be selected per socket
+	The algorithm of a socket can be changed with the option
+	FREERTOS_SO_TCP_CONGESTION.  It needs the sliding window.  It is off by
+	default, so that existing applications keep their throughput. */
+	#ifndef ipconfigTCP_CONGESTION_CONTROL
+		#define ipconfigTCP_CONGESTION_CONTROL	0
+	#endif
+
+	#if( ipconfigTCP_CONGESTION_CONTROL != 0 ) && ( ipconfigUSE_TCP_WIN == 0 )
+		#error ipconfigTCP_CONGESTION_CONTROL requires ipconfigUSE_TCP_WIN
+	#endif
+
 	#ifndef ipconfigIGNORE_UNKNOWN_PACKETS
 		/* When non-zero, TCP will not send RST packets in reply to
 		TCP packets which are unknown, or out-of-order. */
@@ -317,6 +345,18 @@ from the FreeRTOSIPConfig.h configuration header file. */
 	#define ipconfigEVENT_QUEUE_LENGTH		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
 #endif
 
+/* The maximum number of events that the IP-task will take from its queue
+before it checks the network timers again.  When larger than 1, wake-ups of
+UDP sockets are postponed until the end of a batch, so that a socket which
+receives several packets in a row is woken up only once. */
+#ifndef ipconfigIP_TASK_EVENT_BATCH
+	#define ipconfigIP_TASK_EVENT_BATCH		1
+#endif
+
+#if( ipconfigIP_TASK_EVENT_BATCH < 1 )
+	#error ipconfigIP_TASK_EVENT_BATCH must be at least 1
+#endif
+
 #ifndef ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND
 	#define ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND	1
 #endif
@@ -543,6 +583,102 @@ answers on successive calls to FreeRTOS_gethostbyname(). */
 	#define ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM 0
 #endif
 
+/* The implementations of usGenerateChecksum() that can be chosen with
+ipconfigCHECKSUM_BACKEND:
+ipCHECKSUM_BACKEND_C32: portable C, summing 32-bit words.  Best for small MCUs.
+ipCHECKSUM_BACKEND_C64: portable C with a 64-bit accumulator, for 64-bit CPUs
+	and for Cortex-M7 class CPUs.
+ipCHECKSUM_BACKEND_SSE2: x86 SSE2, or AVX2 when the compiler targets it.
+ipCHECKSUM_BACKEND_NEON: ARM NEON, e.g. Cortex-A53. */
+#define ipCHECKSUM_BACKEND_C32		0
+#define ipCHECKSUM_BACKEND_C64		1
+#define ipCHECKSUM_BACKEND_SSE2		2
+#define ipCHECKSUM_BACKEND_NEON		3
+
+#ifndef ipconfigCHECKSUM_BACKEND
+	#define ipconfigCHECKSUM_BACKEND	ipCHECKSUM_BACKEND_C32
+#endif
+
+#if( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_SSE2 ) && !defined( __SSE2__ )
+	#error ipCHECKSUM_BACKEND_SSE2 needs a compiler that targets SSE2
+#endif
+
+#if( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_NEON ) && !defined( __ARM_NEON )
+	#error ipCHECKSUM_BACKEND_NEON needs a compiler that targets NEON
+#endif
+
+/* When non-zero, the TCP payload is checksummed while it is copied between the
+network buffers and the socket streams, so that it is read once instead of
+twice.  It is only done in the directions in which the driver does not check or
+set the checksums, see ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM and
+ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM. */
+#ifndef ipconfigTCP_CHECKSUM_WHILE_COPYING
+	#define ipconfigTCP_CHECKSUM_WHILE_COPYING	0
+#endif
+
+#define ipTCP_RX_CHECKSUM_WHILE_COPYING		( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 ) && ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 0 ) )
+#define ipTCP_TX_CHECKSUM_WHILE_COPYING		( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 ) && ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 ) )
+
+/* When non-zero, consecutive full-size TCP segments are sent as one large
+packet, which is only split into MSS-sized packets just before they are passed
+to xNetworkInterfaceOutput().  Up to ipconfigTCP_SEGMENTATION_MAX_SEGMENTS
+segments are combined.  The large packets need network buffers of a variable
+size, as provided by BufferAllocation_2.c; with fixed-size buffers the option
+has no effect. */
+#ifndef ipconfigTCP_SEGMENTATION_OFFLOAD
+	#define ipconfigTCP_SEGMENTATION_OFFLOAD		0
+#endif
+
+#ifndef ipconfigTCP_SEGMENTATION_MAX_SEGMENTS
+	#define ipconfigTCP_SEGMENTATION_MAX_SEGMENTS	8
+#endif
+
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+	#if( ipconfigUSE_TCP_WIN == 0 )
+		#error ipconfigTCP_SEGMENTATION_OFFLOAD requires ipconfigUSE_TCP_WIN
+	#endif
+	#if( ipconfigTCP_SEGMENTATION_MAX_SEGMENTS < 2 ) || ( ( ipconfigTCP_SEGMENTATION_MAX_SEGMENTS * ipconfigNETWORK_MTU ) > 65535 )
+		#error ipconfigTCP_SEGMENTATION_MAX_SEGMENTS must be at least 2, and the combined packet must fit in 64 KB
+	#endif
+#endif
+
+/* When non-zero, a chain of received packets (see
+ipconfigUSE_LINKED_RX_MESSAGES) is checked for consecutive in-order TCP
+segments of the same connection.  The payload of all but the last one is stored
+directly, and the connection is only updated and acknowledged once, when the
+last segment is handled. */
+#ifndef ipconfigTCP_RX_COALESCING
+	#define ipconfigTCP_RX_COALESCING		0
+#endif
+
+/* When larger than 0, the TCP connections are handled by this many worker
+tasks in stead of by the IP-task.  A connection is assigned to a worker by a
+hash of its local port, remote IP address and remote port, and the IP-task
+passes the received TCP packets to the queue of that worker.  ARP, DHCP, DNS,
+ICMP and UDP remain on the IP-task, which also passes the packets of the
+workers to xNetworkInterfaceOutput().  The workers share a recursive mutex, so
+configUSE_RECURSIVE_MUTEXES must be 1. */
+#ifndef ipconfigIP_TCP_WORKER_TASKS
+	#define ipconfigIP_TCP_WORKER_TASKS		0
+#endif
+
+#ifndef ipconfigIP_TCP_WORKER_QUEUE_LENGTH
+	#define ipconfigIP_TCP_WORKER_QUEUE_LENGTH	ipconfigEVENT_QUEUE_LENGTH
+#endif
+
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	#if( ipconfigUSE_TCP == 0 )
+		#error ipconfigIP_TCP_WORKER_TASKS requires ipconfigUSE_TCP
+	#endif
+	#if( ipconfigIP_TCP_WORKER_TASKS > 255 )
+		#error ipconfigIP_TCP_WORKER_TASKS must be less than 256
+	#endif
+	#if( ipconfigTCP_RX_COALESCING != 0 ) || ( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 )
+		/* Both keep the state of the packet being handled in a static variable. */
+		#error ipconfigIP_TCP_WORKER_TASKS can not be combined with ipconfigTCP_RX_COALESCING or ipconfigTCP_CHECKSUM_WHILE_COPYING
+	#endif
+#endif
+
 #ifndef ipconfigDHCP_REGISTER_HOSTNAME
 	#define ipconfigDHCP_REGISTER_HOSTNAME 0
 #endif
@@ -555,6 +691,44 @@ answers on successive calls to FreeRTOS_gethostbyname(). */
 	#define ipconfigSOCKET_HAS_USER_WAKE_CALLBACK 0
 #endif
 
+/* When non-zero, bound sockets are also stored in hash tables so that an
+incoming packet finds its socket without walking the lists of all bound
+sockets: UDP and listening TCP sockets are hashed on their local port, connected
+TCP sockets on their local port plus the remote IP-address and port.  The value
+is the number of buckets per table and must be a power of two.  Each bucket
+costs a List_t, and each socket two extra ListItem_t's. */
+#ifndef ipconfigSOCKET_HASH_BUCKETS
+	#define ipconfigSOCKET_HASH_BUCKETS 0
+#endif
+
+#if( ipconfigSOCKET_HASH_BUCKETS < 0 ) || ( ( ipconfigSOCKET_HASH_BUCKETS & ( ipconfigSOCKET_HASH_BUCKETS - 1 ) ) != 0 )
+	#error ipconfigSOCKET_HASH_BUCKETS must be zero or a power of two
+#endif
+
+/* When non-zero, the rows of the ARP cache are also stored in a hash table,
+indexed on their IP-address, so that resolving an address does not walk the
+whole cache.  Rows in use are kept in least-recently-used order, the least
+recently used row is replaced when the cache is full.  The cache is aged in
+ipARP_AGE_PASSES smaller steps.  The value is the number of buckets and must
+be a power of two.  Each bucket costs a List_t, and each cache row two
+ListItem_t's. */
+#ifndef ipconfigARP_CACHE_HASH_BUCKETS
+	#define ipconfigARP_CACHE_HASH_BUCKETS 0
+#endif
+
+#if( ipconfigARP_CACHE_HASH_BUCKETS < 0 ) || ( ( ipconfigARP_CACHE_HASH_BUCKETS & ( ipconfigARP_CACHE_HASH_BUCKETS - 1 ) ) != 0 )
+	#error ipconfigARP_CACHE_HASH_BUCKETS must be zero or a power of two
+#endif
+
+/* When non-zero, the TCP sockets that need attention are kept in a list that
+is sorted on their deadline, in the same way as the kernel keeps its delayed
+tasks.  A TCP timer event then only visits the sockets whose time has come, in
+stead of walking all bound TCP sockets.  Each TCP socket costs two extra
+ListItem_t's. */
+#ifndef ipconfigTCP_TIMER_QUEUE
+	#define ipconfigTCP_TIMER_QUEUE 0
+#endif
+
 #ifndef ipconfigSUPPORT_SELECT_FUNCTION
 	#define ipconfigSUPPORT_SELECT_FUNCTION 0
 #endif
@@ -609,4 +783,45 @@ connections, hang protection can help reduce the impact of SYN floods. */
 	#define ipconfigSELECT_USES_NOTIFY		0
 #endif
 
+/* When non-zero, a socket set keeps a list of its member sockets and a list of
+the members that have become ready.  vSocketSelect() will only visit the
+members of the set in stead of all bound sockets, and FreeRTOS_select_ready()
+can be used to wait for ready sockets at a cost that depends on the number of
+ready sockets only.  Each socket costs two extra ListItem_t's. */
+#ifndef ipconfigSELECT_USES_READY_LIST
+	#define ipconfigSELECT_USES_READY_LIST	0
+#endif
+
+#if( ( ipconfigSELECT_USES_READY_LIST != 0 ) && ( ipconfigSUPPORT_SELECT_FUNCTION == 0 ) )
+	#error ipconfigSELECT_USES_READY_LIST requires ipconfigSUPPORT_SELECT_FUNCTION
+#endif
+
+/* When non-zero, asynchronous look-ups (FreeRTOS_gethostbyname_a()) share one
+UDP socket in stead of creating a socket per request.  Concurrent look-ups of
+the same name are answered by a single DNS request, the DNS cache is kept in
+hash buckets, and cache entries that are in use will be refreshed in the
+background when less than ipconfigDNS_PREFETCH_SECONDS of their TTL is left. */
+#ifndef ipconfigDNS_ASYNC_RESOLVER
+	#define ipconfigDNS_ASYNC_RESOLVER		0
+#endif
+
+#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+	#if( ipconfigDNS_USE_CALLBACKS == 0 ) || ( ipconfigUSE_DNS_CACHE == 0 )
+		#error ipconfigDNS_ASYNC_RESOLVER requires ipconfigDNS_USE_CALLBACKS and ipconfigUSE_DNS_CACHE
+	#endif
+
+	/* The number of hash buckets for the DNS cache, must be a power of two. */
+	#ifndef ipconfigDNS_CACHE_HASH_BUCKETS
+		#define ipconfigDNS_CACHE_HASH_BUCKETS	8
+	#endif
+
+	#if( ipconfigDNS_CACHE_HASH_BUCKETS <= 0 ) || ( ( ipconfigDNS_CACHE_HASH_BUCKETS & ( ipconfigDNS_CACHE_HASH_BUCKETS - 1 ) ) != 0 )
+		#error ipconfigDNS_CACHE_HASH_BUCKETS must be a power of two
+	#endif
+
+	#ifndef ipconfigDNS_PREFETCH_SECONDS
+		#define ipconfigDNS_PREFETCH_SECONDS	10U
+	#endif
+#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 #endif /* FREERTOS_DEFAULT_IP_CONFIG_H */
@@ -101,6 +101,17 @@ eARPLookupResult_t eARPGetCacheEntry( uint32_t *pulIPAddress, MACAddress_t * con
  */
 void vARPAgeCache( void );
 
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	/* With a hashed ARP cache, each call to vARPAgeCache() only visits a part
+	of the cache, and the ARP timer runs ipARP_AGE_PASSES times as often, so
+	that each entry is still aged once every ipARP_TIMER_PERIOD_MS. */
+	#ifndef ipARP_AGE_PASSES
+		#define ipARP_AGE_PASSES	8
+	#endif
+#else
+	#define ipARP_AGE_PASSES		1
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
 /*
  * Send out an ARP request for the IP address contained in pxNetworkBuffer, and
  * add an entry into the ARP table that indicates that an ARP reply is
@@ -136,6 +136,14 @@ uint32_t FreeRTOS_gethostbyname( const char *pcHostName );
 	extern void vDNSCheckCallBack( void *pvSearchID );
 #endif
 
+#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+	/*
+	 * Returns pdTRUE if xSocket is the socket that is shared by all
+	 * asynchronous DNS requests.  Replies to it are handled by the IP-task.
+	 */
+	BaseType_t xIsDNSResolverSocket( Socket_t xSocket );
+#endif
+
 
 #ifdef __cplusplus
 }	/* extern "C" */
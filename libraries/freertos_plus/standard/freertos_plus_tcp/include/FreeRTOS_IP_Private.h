@@ -445,6 +445,20 @@ eFrameProcessingResult_t eConsiderFrameForProcessing( const uint8_t * const pucE
  */
 uint16_t usGenerateChecksum( uint16_t usSum, const uint8_t * pucNextData, size_t uxByteCount );
 
+/*
+ * Copy uxByteCount bytes from pucSource to pucDestination, and return the
+ * checksum that usGenerateChecksum() would give for pucDestination.  The data
+ * is read only once.
+ */
+uint16_t usGenerateChecksumCopy( uint16_t usSum, uint8_t *pucDestination, const uint8_t *pucSource, size_t uxByteCount );
+
+/*
+ * Add the checksum usNext, of data that starts uxOffset bytes after the data
+ * of the checksum usSum.  Both checksums must have been calculated with an
+ * initial value of zero.
+ */
+uint16_t usChecksumCombine( uint16_t usSum, uint16_t usNext, size_t uxOffset );
+
 /* Socket related private functions. */
 
 /*
@@ -483,6 +497,20 @@ BaseType_t xIPIsNetworkTaskReady( void );
 	 */
 	TickType_t xTCPTimerCheck( BaseType_t xWillSleep );
 
+	#if( ipconfigTCP_TIMER_QUEUE != 0 )
+		/*
+		 * The field 'usTimeout' of a TCP socket has been changed, or the socket
+		 * has events for its owner.  Let xTCPTimerCheck() look at the socket.
+		 * May be called by any task.
+		 */
+		void vTCPTimerRequest( struct xSOCKET *pxSocket );
+
+		#define ipTCP_TIMER_REQUEST( pxSocket )		vTCPTimerRequest( pxSocket )
+	#else
+		/* xTCPTimerCheck() visits all sockets anyway. */
+		#define ipTCP_TIMER_REQUEST( pxSocket )		do {} while( ipFALSE_BOOL )
+	#endif /* ipconfigTCP_TIMER_QUEUE */
+
 	/* Every TCP socket has a buffer space just big enough to store
 	the last TCP header received.
 	As a reference of this field may be passed to DMA, force the
@@ -554,6 +582,15 @@ BaseType_t xIPIsNetworkTaskReady( void );
 								 * This counter is separate from the xmitCount in the
 								 * TCP win segments */
 		uint8_t ucTCPState;		/* TCP state: see eTCP_STATE */
+		#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+			uint8_t ucWorker;	/* The index of the worker task that handles this socket */
+		#endif /* ipconfigIP_TCP_WORKER_TASKS */
+		#if( ipconfigTCP_TIMER_QUEUE != 0 )
+			ListItem_t xTimerListItem;		/* Sorted on the tick count at which 'usTimeout' expires */
+			ListItem_t xAttentionListItem;	/* Used by vTCPTimerRequest() */
+		#else
+			struct xSOCKET *pxNextDue;		/* Used by xTCPTimerCheck() to chain the sockets that need attention */
+		#endif /* ipconfigTCP_TIMER_QUEUE */
 		struct xSOCKET *pxPeerSocket;	/* for server socket: child, for child socket: parent */
 		#if( ipconfigTCP_KEEP_ALIVE == 1 )
 			uint8_t ucKeepRepCount;
@@ -628,6 +665,12 @@ typedef struct xSOCKET
 	EventGroupHandle_t xEventGroup;
 
 	ListItem_t xBoundSocketListItem; /* Used to reference the socket from a bound sockets list. */
+	#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+		ListItem_t xPortHashListItem; /* Bound sockets: used to find the socket by its local port. */
+		#if( ipconfigUSE_TCP == 1 )
+			ListItem_t xConnHashListItem; /* Connected TCP sockets: used to find the socket by its 4-tuple. */
+		#endif /* ipconfigUSE_TCP */
+	#endif /* ipconfigSOCKET_HASH_BUCKETS */
 	TickType_t xReceiveBlockTime; /* if recv[to] is called while no data is available, wait this amount of time. Unit in clock-ticks */
 	TickType_t xSendBlockTime; /* if send[to] is called while there is not enough space to send, wait this amount of time. Unit in clock-ticks */
 
@@ -648,6 +691,10 @@ typedef struct xSOCKET
 		/* These bits indicate the events which have actually occurred.
 		They are maintained by the IP-task */
 		EventBits_t xSocketBits;
+		#if( ipconfigSELECT_USES_READY_LIST != 0 )
+			ListItem_t xSelectMemberItem;	/* Item in the member list of 'pxSocketSet'. */
+			ListItem_t xSelectReadyItem;	/* Item in the ready list of 'pxSocketSet'. */
+		#endif /* ipconfigSELECT_USES_READY_LIST */
 	#endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 	/* TCP/UDP specific fields: */
 	/* Before accessing any member of this structure, it should be confirmed */
@@ -672,6 +719,15 @@ typedef struct xSOCKET
 	 */
 	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort );
 
+	#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+		/*
+		 * Called by the IP-task once the remote IP-address and port of a TCP
+		 * socket are known: (re-)file the socket under its 4-tuple so that
+		 * pxTCPSocketLookup() can find it without a search.
+		 */
+		void vTCPSocketHashConnection( FreeRTOS_Socket_t *pxSocket );
+	#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 #endif /* ipconfigUSE_TCP */
 
 /*
@@ -679,6 +735,14 @@ typedef struct xSOCKET
  */
 FreeRTOS_Socket_t *pxUDPSocketLookup( UBaseType_t uxLocalPort );
 
+/*
+ * Return the list that holds the bound sockets of protocol xProtocol that use
+ * port xPort (network-byte-order): the hash bucket of the port when
+ * ipconfigSOCKET_HASH_BUCKETS is non-zero, otherwise the list of all bound
+ * sockets.  The list may also contain sockets bound to other ports.
+ */
+List_t *pxSocketListForPort( BaseType_t xProtocol, TickType_t xPort );
+
 /*
  * Called when the application has generated a UDP packet to send.
  */
@@ -721,6 +785,16 @@ int32_t lTCPAddRxdata(FreeRTOS_Socket_t *pxSocket, size_t uxOffset, const uint8_
  */
 void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket );
 
+#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
+	/*
+	 * Postpone the wake-up of a socket until the IP-task has finished its
+	 * current batch of events.  vSocketWakeUpDeferred() wakes up all sockets
+	 * that were postponed.
+	 */
+	void vSocketWakeUpLater( FreeRTOS_Socket_t *pxSocket );
+	void vSocketWakeUpDeferred( void );
+#endif
+
 /*
  * Some helping function, their meaning should be clear.
  * Going by MISRA rules, these utility functions should not be defined
@@ -791,18 +865,69 @@ NetworkBufferDescriptor_t *pxUDPPayloadBuffer_to_NetworkBuffer( const void * pvB
 	void vTCPStateChange( FreeRTOS_Socket_t *pxSocket, enum eTCP_STATE eTCPState );
 #endif /* ipconfigUSE_TCP */
 
-/* Returns pdTRUE is this function is called from the IP-task */
+/* Returns pdTRUE is this function is called from the IP-task, or from one of
+the TCP worker tasks. */
 BaseType_t xIsCallingFromIPTask( void );
 
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	/*
+	 * Returns the index of the TCP worker task that calls this function, or -1
+	 * when it is called from any other task.
+	 */
+	BaseType_t xTCPWorkerCurrent( void );
+
+	/*
+	 * Returns the index of the TCP worker task that handles the connection with
+	 * the given local port, remote IP address and remote port, all in host
+	 * byte order.
+	 */
+	UBaseType_t uxTCPWorkerForConnection( uint16_t usLocalPort, uint32_t ulRemoteIP, uint16_t usRemotePort );
+
+	/*
+	 * Called by a TCP worker task to have a packet sent by the IP-task.  When
+	 * xReleaseAfterSend is pdFALSE, a copy of the packet is sent.
+	 */
+	BaseType_t xTCPWorkerOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend );
+
+	/*
+	 * The lists of TCP sockets, and the sockets that are shared between the
+	 * worker tasks such as a listening socket, are protected by a recursive
+	 * mutex.
+	 */
+	void vTCPWorkerLock( void );
+	void vTCPWorkerUnlock( void );
+
+	#define ipTCP_SOCKETS_LOCK()		vTCPWorkerLock()
+	#define ipTCP_SOCKETS_UNLOCK()		vTCPWorkerUnlock()
+#else
+	/* Only the IP-task accesses the TCP sockets, no locking is needed. */
+	#define ipTCP_SOCKETS_LOCK()
+	#define ipTCP_SOCKETS_UNLOCK()
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 #if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 typedef struct xSOCKET_SET
 {
 	EventGroupHandle_t xSelectGroup;
+	#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		List_t xMemberList;			/* All sockets that belong to this set. */
+		List_t xReadyList;			/* The members that have events to report. */
+		BaseType_t xLevelReported;	/* A level-triggered member has been reported and must be checked again. */
+	#endif /* ipconfigSELECT_USES_READY_LIST */
 } SocketSelect_t;
 
 extern void vSocketSelect( SocketSelect_t *pxSocketSet );
 
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+	/* Make a socket a member of a socket set, or, when 'pxSocketSet' is NULL,
+	remove it from its current set.  May be called from any task. */
+	void vSocketSetMember( FreeRTOS_Socket_t *pxSocket, SocketSelect_t *pxSocketSet );
+
+	/* Called by the IP-task when 'xBits' have occurred on a member of a set. */
+	void vSocketSetReady( FreeRTOS_Socket_t *pxSocket, EventBits_t xBits );
+#endif /* ipconfigSELECT_USES_READY_LIST */
+
 /* Define the data that must be passed for a 'eSocketSelectEvent'. */
 typedef struct xSocketSelectMessage
 {
@@ -132,6 +132,10 @@ FreeRTOS_setsockopt(). */
 
 #define FREERTOS_SO_SET_LOW_HIGH_WATER	( 18 )
 
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	#define FREERTOS_SO_TCP_CONGESTION	( 19 )		/* Select the congestion control algorithm, parameter is a pointer to a BaseType_t FREERTOS_TCP_CC_xxx */
+#endif
+
 #define FREERTOS_NOT_LAST_IN_FRAGMENTED_PACKET 	( 0x80 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 #define FREERTOS_FRAGMENTED_PACKET				( 0x40 )  /* For internal use only, but also part of an 8-bit bitwise value. */
 
@@ -156,6 +160,19 @@ typedef struct xWIN_PROPS {
 	int32_t lRxWinSize;	/* Unit: MSS */
 } WinProperties_t;
 
+/* Congestion control algorithms for the 'FREERTOS_SO_TCP_CONGESTION' option. */
+#define FREERTOS_TCP_CC_NEWRENO			( 1 )
+#define FREERTOS_TCP_CC_CUBIC			( 2 )		/* Only when ipconfigTCP_CONGESTION_CONTROL is 2 */
+
+typedef struct xTCP_CONGESTION_INFO {
+	/* Returned by FreeRTOS_GetCongestionInfo() */
+	BaseType_t xAlgorithm;		/* FREERTOS_TCP_CC_xxx */
+	uint32_t ulCWnd;			/* Congestion window, unit: bytes */
+	uint32_t ulSSThresh;		/* Slow start threshold, unit: bytes */
+	uint32_t ulFastRecoveries;	/* Number of times fast recovery was entered */
+	uint32_t ulTimeouts;		/* Number of losses detected by a retransmission time-out */
+} TCPCongestionInfo_t;
+
 typedef struct xLOW_HIGH_WATER {
 	/* Structure to pass for the 'FREERTOS_SO_SET_LOW_HIGH_WATER' option */
 	size_t uxLittleSpace;	/* Send a STOP when buffer space drops below X bytes */
@@ -259,6 +276,11 @@ BaseType_t FreeRTOS_GetRemoteAddress( ConstSocket_t xSocket, struct freertos_soc
 	/* Returns the actual size of MSS being used. */
 	BaseType_t FreeRTOS_mss( ConstSocket_t xSocket );
 
+	#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+		/* Returns the state and counters of the congestion control. */
+		BaseType_t FreeRTOS_GetCongestionInfo( ConstSocket_t xSocket, TCPCongestionInfo_t *pxInfo );
+	#endif
+
 #endif
 
 /* For internal use only: return the connection status. */
@@ -399,6 +421,10 @@ void FreeRTOS_netstat( void );
 		eSELECT_ALL		= 0x000F,
 		/* Reserved for internal use: */
 		eSELECT_CALL_IP	= 0x0010,
+		/* Only with ipconfigSELECT_USES_READY_LIST: report the events of a
+		socket only once in FreeRTOS_select_ready(), in stead of as long as
+		they persist. */
+		eSELECT_EDGE	= 0x0020,
 		/* end */
 	} eSelectEvent_t;
 
@@ -409,6 +435,17 @@ void FreeRTOS_netstat( void );
 	EventBits_t FreeRTOS_FD_ISSET( Socket_t xSocket, SocketSet_t xSocketSet );
 	BaseType_t FreeRTOS_select( SocketSet_t xSocketSet, TickType_t xBlockTimeTicks );
 
+	#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		/* A socket and the events that were found by FreeRTOS_select_ready(). */
+		typedef struct xSOCKET_READY
+		{
+			Socket_t xSocket;
+			EventBits_t xEvents;
+		} SocketReady_t;
+
+		BaseType_t FreeRTOS_select_ready( SocketSet_t xSocketSet, SocketReady_t *pxReady, BaseType_t xMaxCount, TickType_t xBlockTimeTicks );
+	#endif /* ipconfigSELECT_USES_READY_LIST */
+
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION */
 
 #ifdef __cplusplus
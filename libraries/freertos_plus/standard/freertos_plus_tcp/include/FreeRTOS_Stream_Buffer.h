@@ -225,6 +225,21 @@ size_t uxStreamBufferAdd( StreamBuffer_t *pxBuffer, size_t uxOffset, const uint8
  */
 size_t uxStreamBufferGet( StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t *pucData, size_t uxMaxCount, BaseType_t xPeek );
 
+#if( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 )
+	/*
+	 * Copy bytes into the free space at uxHead, without moving any of the
+	 * markers, and return their checksum in *pusChecksum.  A call to
+	 * uxStreamBufferAdd() with pucData == NULL will add them later on.
+	 */
+	size_t uxStreamBufferPlaceChecksum( StreamBuffer_t *pxBuffer, const uint8_t *pucData, size_t uxByteCount, uint16_t *pusChecksum );
+
+	/*
+	 * Like uxStreamBufferGet() in peek mode, also returning the checksum of
+	 * the bytes read in *pusChecksum.
+	 */
+	size_t uxStreamBufferPeekChecksum( const StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t *pucData, size_t uxMaxCount, uint16_t *pusChecksum );
+#endif /* ipconfigTCP_CHECKSUM_WHILE_COPYING */
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
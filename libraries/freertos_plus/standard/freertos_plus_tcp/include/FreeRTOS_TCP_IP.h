@@ -32,6 +32,13 @@ extern "C" {
 
 BaseType_t xProcessReceivedTCPPacket( NetworkBufferDescriptor_t *pxDescriptor );
 
+#if( ipconfigTCP_RX_COALESCING != 0 )
+	/* Called by the IP-task while walking a chain of received packets, to
+	see whether pxBuffer and pxNextBuffer are consecutive segments of the
+	same TCP connection. */
+	void vTCPCheckCoalescing( const NetworkBufferDescriptor_t *pxBuffer, const NetworkBufferDescriptor_t *pxNextBuffer );
+#endif
+
 typedef enum eTCP_STATE {
 	/* Comments about the TCP states are borrowed from the very useful
 	 * Wiki page:
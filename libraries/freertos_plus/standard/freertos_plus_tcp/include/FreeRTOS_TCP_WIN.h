@@ -54,7 +54,7 @@ typedef struct xTCP_SEGMENT
 		{
 			uint32_t
 				ucTransmitCount : 8,/* Number of times the segment has been transmitted, used to calculate the RTT */
-				ucDupAckCount : 8,	/* Counts the number of times that a higher segment was ACK'd. After 3 times a Fast Retransmission takes place */
+				ucDupAckCount : 8,	/* Set to 3 when 3 higher segments were SACK'd and a Fast Retransmission takes place, cleared at a time-out */
 				bOutstanding : 1,	/* It the peer's turn, we're just waiting for an ACK */
 				bAcked : 1,			/* This segment has been acknowledged */
 				bIsForRx : 1;		/* pdTRUE if segment is used for reception */
@@ -77,13 +77,59 @@ typedef struct xTCP_WINSIZE
  * If TCP time-stamps are being used, they will occupy 12 bytes in
  * each packet, and thus the message space will become smaller
  */
-/* Keep this as a multiple of 4 */
+/* Keep this as a multiple of 4.  With a sliding window, there must be space
+for the SACK option: 4 bytes plus 8 bytes per block. */
 #if( ipconfigUSE_TCP_WIN == 1 )
-	#define ipSIZE_TCP_OPTIONS	16U
+	#if( ipconfigTCP_SACK_BLOCKS > 1 )
+		#define ipSIZE_TCP_OPTIONS	( 4U + ( 8U * ( ipconfigTCP_SACK_BLOCKS ) ) )
+	#else
+		#define ipSIZE_TCP_OPTIONS	16U
+	#endif
 #else
 	#define ipSIZE_TCP_OPTIONS	12U
 #endif
 
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	struct xTCP_WINDOW;
+
+	/*
+	 * A congestion control algorithm.  The window itself takes care of slow
+	 * start, fast recovery and time-outs.  The algorithm decides how far the
+	 * congestion window is reduced after a loss and how it grows once it has
+	 * reached the slow start threshold.
+	 */
+	typedef struct xTCP_CONGESTION_OPS
+	{
+		/* A loss was detected: set ulSSThresh.  ulFlightSize is the number of
+		bytes outstanding, xTimeout is pdTRUE for a retransmission time-out. */
+		void ( * fnOnLoss )( struct xTCP_WINDOW *pxWindow, uint32_t ulFlightSize, BaseType_t xTimeout );
+		/* Congestion avoidance: 'ulAcked' new bytes were acknowledged while
+		the window was at or above ulSSThresh.  Grow ulCWnd. */
+		void ( * fnOnAck )( struct xTCP_WINDOW *pxWindow, uint32_t ulAcked );
+	} TCPCongestionOps_t;
+
+	typedef struct xTCP_CONGESTION
+	{
+		const TCPCongestionOps_t *pxOps;	/* The algorithm in use */
+		BaseType_t xAlgorithm;				/* Its number: FREERTOS_TCP_CC_NEWRENO or FREERTOS_TCP_CC_CUBIC */
+		uint32_t ulCWnd;					/* Congestion window: the number of bytes that may be outstanding */
+		uint32_t ulSSThresh;				/* Slow start threshold */
+		uint32_t ulRecover;					/* The highest sequence number sent when the current recovery started */
+		uint32_t ulAckedBytes;				/* Bytes acknowledged since ulCWnd last grew in congestion avoidance */
+		uint32_t ulFastRecoveries;			/* The number of times fast recovery was entered */
+		uint32_t ulTimeouts;				/* The number of losses detected by a retransmission time-out */
+		uint8_t ucRecovery;					/* Recovery state, see winCC_RECOVERY_xxx */
+		#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+			BaseType_t xEpochStarted;		/* CUBIC: the growth curve after the last loss has started */
+			uint32_t ulEpochStart;			/* CUBIC: time in ms when it started */
+			uint32_t ulK;					/* CUBIC: time in ms it takes to grow back to ulWMax */
+			uint32_t ulWMax;				/* CUBIC: window size just before the last reduction */
+			uint32_t ulOrigin;				/* CUBIC: window size at the plateau of the curve */
+			uint32_t ulWEst;				/* CUBIC: estimate of the window Reno would have */
+		#endif
+	} TCPCongestion_t;
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+
 /*
  *	Every TCP connection owns a TCP window for the administration of all packets
  *	It owns two sets of segment descriptors, incoming and outgoing
@@ -125,6 +171,9 @@ typedef struct xTCP_WINDOW
 	uint32_t ulOptionsData[ipSIZE_TCP_OPTIONS/sizeof(uint32_t)];	/* Contains the options we send out */
 	List_t xTxSegments;					/* A linked list of all transmission segments, sorted on sequence number */
 	List_t xRxSegments;					/* A linked list of reception segments, order depends on sequence of arrival */
+	#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+		TCPCongestion_t xCongestion;	/* Congestion control of the transmissions */
+	#endif
 #else
 	/* For tiny TCP, there is only 1 outstanding TX segment */
 	TCPSegment_t xTxSegment;			/* Priority queue */
@@ -191,12 +240,25 @@ BaseType_t xTCPWindowTxDone( const TCPWindow_t *pxWindow );
  * apPos will point to a location with the circular data buffer: txStream */
 uint32_t ulTCPWindowTxGet( TCPWindow_t *pxWindow, uint32_t ulWindowSize, int32_t *plPosition );
 
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+	/* Fetches a new segment that starts at lPosition in txStream, so that it
+	 * can be sent along with the previous one(s).  When xPeek is true, the
+	 * segment is only looked at.  Returns 0 if there is no such segment. */
+	uint32_t ulTCPWindowTxGetNext( TCPWindow_t *pxWindow, uint32_t ulWindowSize, int32_t lPosition, BaseType_t xPeek );
+#endif
+
 /* Receive a normal ACK */
 uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
 
 /* Receive a SACK option */
 uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast );
 
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	/* Select the congestion control algorithm, FREERTOS_TCP_CC_NEWRENO or
+	FREERTOS_TCP_CC_CUBIC.  Returns pdFAIL if it is not available. */
+	BaseType_t xTCPWindowSetCongestion( TCPWindow_t *pxWindow, BaseType_t xAlgorithm );
+#endif
+
 
 #ifdef __cplusplus
 }	/* extern "C" */
@@ -57,6 +57,15 @@ entry is still valid and can therefore be refreshed. */
 	#define arpGRATUITOUS_ARP_PERIOD					( pdMS_TO_TICKS( 20000U ) )
 #endif
 
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	/* The TCP worker tasks read the cache while the IP-task updates it. */
+	#define arpCACHE_ENTER_CRITICAL()	taskENTER_CRITICAL()
+	#define arpCACHE_EXIT_CRITICAL()	taskEXIT_CRITICAL()
+#else
+	#define arpCACHE_ENTER_CRITICAL()	do {} while( ipFALSE_BOOL )
+	#define arpCACHE_EXIT_CRITICAL()	do {} while( ipFALSE_BOOL )
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -64,11 +73,73 @@ entry is still valid and can therefore be refreshed. */
  */
 static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress_t * const pxMACAddress );
 
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	/*
+	 * Map an IP-address onto the index of a hash bucket.
+	 */
+	static UBaseType_t prvARPHashIndex( uint32_t ulIPAddress );
+
+	/*
+	 * Return the row that holds ulIPAddress, or -1 when it is not in the cache.
+	 */
+	static BaseType_t prvARPFindAddress( uint32_t ulIPAddress );
+
+	/*
+	 * Return a row that can be used for a new entry: either a free row, or the
+	 * least recently used row, which will be cleared first.
+	 */
+	static BaseType_t prvARPAllocateRow( void );
+
+	/*
+	 * Store ulIPAddress in row x, and move the row to the right hash bucket.
+	 */
+	static void prvARPSetAddress( BaseType_t x, uint32_t ulIPAddress );
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
+/*
+ * Clear a row of the ARP cache.
+ */
+static void prvARPClearRow( BaseType_t x );
+
 /*-----------------------------------------------------------*/
 
 /* The ARP cache. */
 static ARPCacheRow_t xARPCache[ ipconfigARP_CACHE_ENTRIES ];
 
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	/* The place of each row of xARPCache[] in a hash bucket, and in either
+	xARPUsedList or xARPFreeList. */
+	typedef struct xARP_CACHE_LINKS
+	{
+		ListItem_t xHashItem;
+		ListItem_t xUsageItem;
+	} ARPCacheLinks_t;
+
+	static ARPCacheLinks_t xARPCacheLinks[ ipconfigARP_CACHE_ENTRIES ];
+
+	/* The rows in use, hashed on their IP-address. */
+	static List_t xARPHashTable[ ipconfigARP_CACHE_HASH_BUCKETS ];
+
+	/* The rows in use, the least recently used row comes first. */
+	static List_t xARPUsedList;
+
+	/* The rows that are not in use. */
+	static List_t xARPFreeList;
+
+	/* The next row to be visited by vARPAgeCache(). */
+	static BaseType_t xARPAgeIndex = 0;
+
+	#define arpROW_INDEX( pxRow )	( ( BaseType_t ) ( ( pxRow ) - xARPCache ) )
+	#define arpROW_IS_USED( x )		( listLIST_ITEM_CONTAINER( &( xARPCacheLinks[ x ].xHashItem ) ) != NULL )
+
+	/* Make row x the most recently used row. */
+	#define arpROW_TOUCH( x )								\
+		do {												\
+			( void ) uxListRemove( &( xARPCacheLinks[ x ].xUsageItem ) );	\
+			vListInsertEnd( &xARPUsedList, &( xARPCacheLinks[ x ].xUsageItem ) );	\
+		} while( ipFALSE_BOOL )
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
 /* The time at which the last gratuitous ARP was sent.  Gratuitous ARPs are used
 to ensure ARP tables are up to date and to detect IP address conflicts. */
 static TickType_t xLastGratuitousARPTime = ( TickType_t ) 0;
@@ -181,7 +252,9 @@ uint32_t ulTargetProtocolAddress, ulSenderProtocolAddress;
 			if( ( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
 			{
 				lResult = xARPCache[ x ].ulIPAddress;
-				( void ) memset( &xARPCache[ x ], 0, sizeof( xARPCache[ x ] ) );
+				arpCACHE_ENTER_CRITICAL();
+				prvARPClearRow( x );
+				arpCACHE_EXIT_CRITICAL();
 				break;
 			}
 		}
@@ -198,7 +271,9 @@ BaseType_t x = 0;
 BaseType_t xIpEntry = -1;
 BaseType_t xMacEntry = -1;
 BaseType_t xUseEntry = 0;
-uint8_t ucMinAgeFound = 0U;
+#if( ipconfigARP_CACHE_HASH_BUCKETS == 0 )
+	uint8_t ucMinAgeFound = 0U;
+#endif
 
 #if( ipconfigARP_STORES_REMOTE_ADDRESSES == 0 )
 	/* Only process the IP address if it is on the local network.
@@ -216,6 +291,107 @@ uint8_t ucMinAgeFound = 0U;
 
 	if( pdTRUE )
 #endif
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	{
+		/* The rows that are found must not be cleared or moved by another
+		task before they are updated. */
+		arpCACHE_ENTER_CRITICAL();
+
+		xIpEntry = prvARPFindAddress( ulIPAddress );
+
+		if( xIpEntry >= 0 )
+		{
+			if( pxMACAddress == NULL )
+			{
+				/* There is already an entry for this address, maybe waiting
+				for an ARP reply. */
+				arpCACHE_EXIT_CRITICAL();
+				return;
+			}
+
+			if( memcmp( xARPCache[ xIpEntry ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 )
+			{
+				/* The most common path, see the comment in the loop below. */
+				xARPCache[ xIpEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+				xARPCache[ xIpEntry ].ucValid = ( uint8_t ) pdTRUE;
+				arpROW_TOUCH( xIpEntry );
+				arpCACHE_EXIT_CRITICAL();
+				return;
+			}
+		}
+
+		if( pxMACAddress != NULL )
+		{
+		const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xARPUsedList ) );
+		const ListItem_t *pxIterator;
+
+			/* Look for a row with the same MAC-address but a different
+			IP-address.  This only happens for addresses that are not yet in
+			the cache. */
+			for( pxIterator = listGET_NEXT( pxEnd ); pxIterator != pxEnd; pxIterator = listGET_NEXT( pxIterator ) )
+			{
+				x = arpROW_INDEX( ipPOINTER_CAST( ARPCacheRow_t *, listGET_LIST_ITEM_OWNER( pxIterator ) ) );
+
+				if( ( x != xIpEntry ) &&
+					( memcmp( xARPCache[ x ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) ) == 0 ) )
+				{
+		#if( ipconfigARP_STORES_REMOTE_ADDRESSES != 0 )
+					BaseType_t bIsLocal[ 2 ];
+					bIsLocal[ 0 ] = ( ( xARPCache[ x ].ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
+					bIsLocal[ 1 ] = ( ( ulIPAddress & xNetworkAddressing.ulNetMask ) == ( ( *ipLOCAL_IP_ADDRESS_POINTER ) & xNetworkAddressing.ulNetMask ) );
+					if( bIsLocal[ 0 ] == bIsLocal[ 1 ] )
+					{
+						xMacEntry = x;
+					}
+		#else
+					xMacEntry = x;
+		#endif
+				}
+			}
+		}
+
+		if( xMacEntry >= 0 )
+		{
+			xUseEntry = xMacEntry;
+
+			if( xIpEntry >= 0 )
+			{
+				/* Both the MAC address as well as the IP address were found in
+				different locations: clear the entry which matches the
+				IP-address */
+				prvARPClearRow( xIpEntry );
+			}
+		}
+		else if( xIpEntry >= 0 )
+		{
+			/* An entry containing the IP-address was found, but it had a different MAC address */
+			xUseEntry = xIpEntry;
+		}
+		else
+		{
+			xUseEntry = prvARPAllocateRow();
+		}
+
+		prvARPSetAddress( xUseEntry, ulIPAddress );
+
+		if( pxMACAddress != NULL )
+		{
+			( void ) memcpy( xARPCache[ xUseEntry ].xMACAddress.ucBytes, pxMACAddress->ucBytes, sizeof( pxMACAddress->ucBytes ) );
+
+			iptraceARP_TABLE_ENTRY_CREATED( ulIPAddress, (*pxMACAddress) );
+			/* And this entry does not need immediate attention */
+			xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_AGE;
+			xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdTRUE;
+		}
+		else
+		{
+			xARPCache[ xUseEntry ].ucAge = ( uint8_t ) ipconfigMAX_ARP_RETRANSMISSIONS;
+			xARPCache[ xUseEntry ].ucValid = ( uint8_t ) pdFALSE;
+		}
+
+		arpCACHE_EXIT_CRITICAL();
+	}
+#else
 	{
 		/* Start with the maximum possible number. */
 		ucMinAgeFound--;
@@ -309,6 +485,8 @@ uint8_t ucMinAgeFound = 0U;
 			}
 		}
 
+		arpCACHE_ENTER_CRITICAL();
+
 		if( xMacEntry >= 0 )
 		{
 			xUseEntry = xMacEntry;
@@ -318,7 +496,7 @@ uint8_t ucMinAgeFound = 0U;
 				/* Both the MAC address as well as the IP address were found in
 				different locations: clear the entry which matches the
 				IP-address */
-				( void ) memset( &( xARPCache[ xIpEntry ] ), 0, sizeof( ARPCacheRow_t ) );
+				prvARPClearRow( xIpEntry );
 			}
 		}
 		else if( xIpEntry >= 0 )
@@ -352,7 +530,10 @@ uint8_t ucMinAgeFound = 0U;
 		{
 			/* Nothing will be stored. */
 		}
+
+		arpCACHE_EXIT_CRITICAL();
 	}
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
 }
 /*-----------------------------------------------------------*/
 
@@ -489,6 +670,29 @@ static eARPLookupResult_t prvCacheLookup( uint32_t ulAddressToLookup, MACAddress
 BaseType_t x;
 eARPLookupResult_t eReturn = eARPCacheMiss;
 
+	arpCACHE_ENTER_CRITICAL();
+
+	#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	{
+		/* Only the hash bucket of the address is searched. */
+		x = prvARPFindAddress( ulAddressToLookup );
+
+		if( x >= 0 )
+		{
+			if( xARPCache[ x ].ucValid == ( uint8_t ) pdFALSE )
+			{
+				/* This entry is waiting an ARP reply, so is not valid. */
+				eReturn = eCantSendPacket;
+			}
+			else
+			{
+				( void ) memcpy( pxMACAddress->ucBytes, xARPCache[ x ].xMACAddress.ucBytes, sizeof( MACAddress_t ) );
+				eReturn = eARPCacheHit;
+				arpROW_TOUCH( x );
+			}
+		}
+	}
+	#else
 	/* Loop through each entry in the ARP cache. */
 	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
 	{
@@ -511,6 +715,9 @@ eARPLookupResult_t eReturn = eARPCacheMiss;
 			break;
 		}
 	}
+	#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
+	arpCACHE_EXIT_CRITICAL();
 
 	return eReturn;
 }
@@ -520,10 +727,20 @@ void vARPAgeCache( void )
 {
 BaseType_t x;
 TickType_t xTimeNow;
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	BaseType_t xCount;
 
+	/* Visit the next part of the cache, all rows are visited once in
+	ipARP_AGE_PASSES calls. */
+	for( xCount = 0; xCount < ( ( ipconfigARP_CACHE_ENTRIES + ipARP_AGE_PASSES - 1 ) / ipARP_AGE_PASSES ); xCount++ )
+	{
+		x = xARPAgeIndex;
+		xARPAgeIndex = ( xARPAgeIndex + 1 ) % ipconfigARP_CACHE_ENTRIES;
+#else
 	/* Loop through each entry in the ARP cache. */
 	for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
 	{
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
 		/* If the entry is valid (its age is greater than zero). */
 		if( xARPCache[ x ].ucAge > 0U )
 		{
@@ -553,7 +770,17 @@ TickType_t xTimeNow;
 			{
 				/* The entry is no longer valid.  Wipe it out. */
 				iptraceARP_TABLE_ENTRY_EXPIRED( xARPCache[ x ].ulIPAddress );
-				xARPCache[ x ].ulIPAddress = 0UL;
+				#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+				{
+					arpCACHE_ENTER_CRITICAL();
+					prvARPClearRow( x );
+					arpCACHE_EXIT_CRITICAL();
+				}
+				#else
+				{
+					xARPCache[ x ].ulIPAddress = 0UL;
+				}
+				#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
 			}
 		}
 	}
@@ -607,7 +834,12 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 		}
 		#endif
 
+		#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		/* A TCP worker task must also pass the packet to the IP-task. */
+		if( ( xIsCallingFromIPTask() != 0 ) && ( xTCPWorkerCurrent() < 0 ) )
+		#else
 		if( xIsCallingFromIPTask() != 0 )
+		#endif
 		{
 			/* Only the IP-task is allowed to call this function directly. */
 			( void ) xNetworkInterfaceOutput( pxNetworkBuffer, pdTRUE );
@@ -684,10 +916,145 @@ ARPPacket_t *pxARPPacket;
 
 void FreeRTOS_ClearARP( void )
 {
+	arpCACHE_ENTER_CRITICAL();
+
 	( void ) memset( xARPCache, 0, sizeof( xARPCache ) );
+
+	#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	{
+	BaseType_t x;
+
+		for( x = 0; x < ipconfigARP_CACHE_HASH_BUCKETS; x++ )
+		{
+			vListInitialise( &( xARPHashTable[ x ] ) );
+		}
+
+		vListInitialise( &xARPUsedList );
+		vListInitialise( &xARPFreeList );
+
+		for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+		{
+			vListInitialiseItem( &( xARPCacheLinks[ x ].xHashItem ) );
+			listSET_LIST_ITEM_OWNER( &( xARPCacheLinks[ x ].xHashItem ), ipPOINTER_CAST( void *, &( xARPCache[ x ] ) ) );
+			vListInitialiseItem( &( xARPCacheLinks[ x ].xUsageItem ) );
+			listSET_LIST_ITEM_OWNER( &( xARPCacheLinks[ x ].xUsageItem ), ipPOINTER_CAST( void *, &( xARPCache[ x ] ) ) );
+			vListInsertEnd( &xARPFreeList, &( xARPCacheLinks[ x ].xUsageItem ) );
+		}
+	}
+	#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
+	arpCACHE_EXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
 
+static void prvARPClearRow( BaseType_t x )
+{
+	#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+	{
+		if( arpROW_IS_USED( x ) )
+		{
+			/* Move the row from the hash table and the used list to the free
+			list. */
+			( void ) uxListRemove( &( xARPCacheLinks[ x ].xHashItem ) );
+			( void ) uxListRemove( &( xARPCacheLinks[ x ].xUsageItem ) );
+			vListInsertEnd( &xARPFreeList, &( xARPCacheLinks[ x ].xUsageItem ) );
+		}
+	}
+	#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
+	( void ) memset( &( xARPCache[ x ] ), 0, sizeof( ARPCacheRow_t ) );
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+
+	static UBaseType_t prvARPHashIndex( uint32_t ulIPAddress )
+	{
+	uint32_t ulHash = ulIPAddress ^ ( ulIPAddress >> 16 );
+
+		/* Multiplicative (Fibonacci) hashing, in the same way as the socket
+		hash tables do. */
+		ulHash *= 0x9E3779B1UL;
+
+		return ( UBaseType_t ) ( ulHash >> 16 ) & ( ( UBaseType_t ) ipconfigARP_CACHE_HASH_BUCKETS - 1U );
+	}
+
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+
+	static BaseType_t prvARPFindAddress( uint32_t ulIPAddress )
+	{
+	const List_t *pxBucket = &( xARPHashTable[ prvARPHashIndex( ulIPAddress ) ] );
+	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxBucket ) );
+	const ListItem_t *pxIterator;
+	const ARPCacheRow_t *pxRow;
+	BaseType_t xResult = -1;
+
+		for( pxIterator = listGET_NEXT( pxEnd ); pxIterator != pxEnd; pxIterator = listGET_NEXT( pxIterator ) )
+		{
+			pxRow = ipPOINTER_CAST( const ARPCacheRow_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+			if( pxRow->ulIPAddress == ulIPAddress )
+			{
+				xResult = arpROW_INDEX( pxRow );
+				break;
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+
+	static BaseType_t prvARPAllocateRow( void )
+	{
+	const List_t *pxList;
+	BaseType_t x;
+
+		if( listLIST_IS_EMPTY( &xARPFreeList ) == pdFALSE )
+		{
+			pxList = &xARPFreeList;
+		}
+		else
+		{
+			/* The cache is full, replace the least recently used row. */
+			pxList = &xARPUsedList;
+		}
+
+		x = arpROW_INDEX( ipPOINTER_CAST( ARPCacheRow_t *, listGET_OWNER_OF_HEAD_ENTRY( pxList ) ) );
+		prvARPClearRow( x );
+
+		return x;
+	}
+
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+
+	static void prvARPSetAddress( BaseType_t x, uint32_t ulIPAddress )
+	{
+		if( arpROW_IS_USED( x ) )
+		{
+			( void ) uxListRemove( &( xARPCacheLinks[ x ].xHashItem ) );
+		}
+
+		xARPCache[ x ].ulIPAddress = ulIPAddress;
+		vListInsertEnd( &( xARPHashTable[ prvARPHashIndex( ulIPAddress ) ] ), &( xARPCacheLinks[ x ].xHashItem ) );
+
+		/* The row is now the most recently used one. */
+		( void ) uxListRemove( &( xARPCacheLinks[ x ].xUsageItem ) );
+		vListInsertEnd( &xARPUsedList, &( xARPCacheLinks[ x ].xUsageItem ) );
+	}
+
+#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+/*-----------------------------------------------------------*/
+
 #if 1
 BaseType_t xCheckLoopback( NetworkBufferDescriptor_t * const pxDescriptor, BaseType_t bReleaseAfterSend )
 {
@@ -166,6 +166,15 @@ static uint32_t prvGetHostByName( const char *pcHostName,
 								  TickType_t uxIdentifier,
 								  TickType_t uxReadTimeOut_ticks );
 
+/*
+ * Create a DNS request for 'pcHostName' and send it from 'xDNSSocket', either
+ * to the DNS server or, for names without a dot, to the LLMNR address.
+ * Returns pdPASS when the message was handed over to the IP-task.
+ */
+static BaseType_t prvSendDNSRequest( Socket_t xDNSSocket,
+									 const char *pcHostName,
+									 TickType_t uxIdentifier );
+
 #if( ipconfigDNS_USE_CALLBACKS != 0 )
 	static void vDNSSetCallBack( const char *pcHostName,
 								 void *pvSearchID,
@@ -217,15 +226,79 @@ static uint32_t prvGetHostByName( const char *pcHostName,
 #if( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
 		uint8_t  ucNumIPAddresses;
 		uint8_t  ucCurrentIPAddress;
+#endif
+#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		ListItem_t xHashItem;          /* Links the row in its hash bucket 'xDNSHashTable[]'. */
+		uint16_t usRefreshIdentifier;  /* The identifier of the outstanding refresh request. */
+		uint8_t ucUsed;                /* The row was looked up since it was stored. */
+		uint8_t ucRefreshing;          /* A refresh request has been sent for this row. */
 #endif
 	} DNSCacheRow_t;
 
 	static DNSCacheRow_t xDNSCache[ ipconfigDNS_CACHE_ENTRIES ];
 
+	/* Look up the row that stores 'pcName', returns -1 when not found. */
+	static BaseType_t prvDNSCacheFind( const char *pcName );
+
+	/* Mark the row as unused. */
+	static void prvDNSCacheRemove( BaseType_t xEntry );
+
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		/* The rows are hashed on their name, each bucket is a list of rows. */
+		static List_t xDNSHashTable[ ipconfigDNS_CACHE_HASH_BUCKETS ];
+
+		/* The number of rows that are in use. */
+		static UBaseType_t uxDNSCacheRows = 0U;
+
+		/* The socket that is shared by all asynchronous look-ups. */
+		static Socket_t xDNSResolverSocket = NULL;
+
+		/* Return the socket shared by all asynchronous look-ups, create it
+		when it doesn't exist yet. */
+		static Socket_t prvDNSResolverSocket( void );
+
+		/* Called by the DNS timer: remove rows that have expired and send
+		refresh requests for rows that are in use and about to expire.
+		Returns the number of rows still in use. */
+		static UBaseType_t uxDNSCachePrefetch( void );
+
+		/* Returns pdTRUE if a reply to 'pcName' with identifier 'uxIdentifier'
+		is the answer to a refresh request. */
+		static BaseType_t xDNSCacheIsRefreshing( const char *pcName,
+												  TickType_t uxIdentifier );
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 	/* Utility function: Clear DNS cache by calling this function. */
 	void FreeRTOS_dnsclear( void )
 	{
-		( void ) memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		{
+		BaseType_t x;
+
+			vTaskSuspendAll();
+			{
+				( void ) memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+
+				for( x = 0; x < ipconfigDNS_CACHE_HASH_BUCKETS; x++ )
+				{
+					vListInitialise( &( xDNSHashTable[ x ] ) );
+				}
+
+				for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+				{
+					vListInitialiseItem( &( xDNSCache[ x ].xHashItem ) );
+					listSET_LIST_ITEM_OWNER( &( xDNSCache[ x ].xHashItem ), ipPOINTER_CAST( void *, &( xDNSCache[ x ] ) ) );
+				}
+
+				uxDNSCacheRows = 0U;
+			}
+			( void ) xTaskResumeAll();
+		}
+		#else
+		{
+			( void ) memset( xDNSCache, 0x0, sizeof( xDNSCache ) );
+		}
+		#endif /* ipconfigDNS_ASYNC_RESOLVER */
 	}
 #endif /* ipconfigUSE_DNS_CACHE == 1 */
 
@@ -355,6 +428,13 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 
 	static List_t xCallbackList;
 
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		/* Find an outstanding asynchronous look-up of 'pcHostName'.  Returns
+		pdTRUE and sets '*puxIdentifier' to its identifier when found. */
+		static BaseType_t xDNSFindPending( const char *pcHostName,
+										   TickType_t *puxIdentifier );
+	#endif
+
 	/* Define FreeRTOS_gethostbyname() as a normal blocking call. */
 	uint32_t FreeRTOS_gethostbyname( const char *pcHostName )
 	{
@@ -366,6 +446,13 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	void vDNSInitialise( void )
 	{
 		vListInitialise( &xCallbackList );
+
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		{
+			/* Initialise the hash buckets of the DNS cache. */
+			FreeRTOS_dnsclear();
+		}
+		#endif
 	}
 	/*-----------------------------------------------------------*/
 
@@ -407,7 +494,13 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 		}
 		( void ) xTaskResumeAll();
 
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		/* The timer is also needed to refresh the cache, as long as it has
+		entries. */
+		if( ( uxDNSCachePrefetch() == 0U ) && ( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE ) )
+		#else
 		if( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE )
+		#endif
 		{
 			vIPSetDnsTimerEnableState( pdFALSE );
 		}
@@ -459,8 +552,41 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 	}
 	/*-----------------------------------------------------------*/
 
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		static BaseType_t xDNSFindPending( const char *pcHostName,
+										   TickType_t *puxIdentifier )
+		{
+		BaseType_t xResult = pdFALSE;
+		const ListItem_t * pxIterator;
+		const ListItem_t * xEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xCallbackList ) );
+
+			vTaskSuspendAll();
+			{
+				for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
+					 pxIterator != ( const ListItem_t * ) xEnd;
+					 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+				{
+				const DNSCallback_t *pxCallback = ipPOINTER_CAST( const DNSCallback_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+					if( strcmp( pxCallback->pcName, pcHostName ) == 0 )
+					{
+						*puxIdentifier = listGET_LIST_ITEM_VALUE( pxIterator );
+						xResult = pdTRUE;
+						break;
+					}
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			return xResult;
+		}
+		/*-----------------------------------------------------------*/
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 	/* A DNS reply was received, see if there is any matching entry and
-	call the handler.  Returns pdTRUE if uxIdentifier was recognised. */
+	call the handler.  Returns pdTRUE if uxIdentifier was recognised.
+	When look-ups are shared, all call-backs waiting for this identifier
+	will be called. */
 	static BaseType_t xDNSDoCallback( TickType_t uxIdentifier,
 									  const char *pcName,
 									  uint32_t ulIPAddress )
@@ -473,24 +599,37 @@ typedef struct xDNSAnswerRecord DNSAnswerRecord_t;
 		{
 			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( xEnd );
 				 pxIterator != ( const ListItem_t * ) xEnd;
-				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+				 )
 			{
 				if( listGET_LIST_ITEM_VALUE( pxIterator ) == uxIdentifier )
 				{
 				DNSCallback_t *pxCallback = ipPOINTER_CAST( DNSCallback_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
 
+					/* Move to the next item because this item will be removed. */
+					pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator );
+
 					pxCallback->pCallbackFunction( pcName, pxCallback->pvSearchID, ulIPAddress );
 					( void ) uxListRemove( &pxCallback->xListItem );
 					vPortFree( pxCallback );
 
+					#if( ipconfigDNS_ASYNC_RESOLVER == 0 )
 					if( listLIST_IS_EMPTY( &xCallbackList ) != pdFALSE )
 					{
 						/* The list of outstanding requests is empty. No need for periodic polling. */
 						vIPSetDnsTimerEnableState( pdFALSE );
 					}
+					#endif
 
 					xResult = pdTRUE;
-					break;
+					#if( ipconfigDNS_ASYNC_RESOLVER == 0 )
+					{
+						break;
+					}
+					#endif
+				}
+				else
+				{
+					pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator );
 				}
 			}
 		}
@@ -603,6 +742,19 @@ TickType_t uxIdentifier = 0U;
 			{
 				if( ulIPAddress == 0UL )
 				{
+					#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+					{
+						if( xDNSFindPending( pcHostName, &( uxIdentifier ) ) != pdFALSE )
+						{
+							/* The same name is being looked up already: wait
+							for the reply to that request in stead of sending
+							another one. */
+							vDNSSetCallBack( pcHostName, pvSearchID, pCallback, uxTimeout, uxIdentifier );
+							xHasRandom = pdFALSE;
+						}
+					}
+					#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 					/* The user has provided a callback function, so do not block on recvfrom() */
 					if( xHasRandom != pdFALSE )
 					{
@@ -638,93 +790,39 @@ uint32_t ulIPAddress = 0UL;
 uint32_t ulAddressLength = sizeof( struct freertos_sockaddr );
 BaseType_t xAttempt;
 int32_t lBytes;
-size_t uxPayloadLength, uxExpectedPayloadLength;
 TickType_t uxWriteTimeOut_ticks = ipconfigDNS_SEND_BLOCK_TIME_TICKS;
 
-#if( ipconfigUSE_LLMNR == 1 )
-	BaseType_t bHasDot = pdFALSE;
-#endif /* ipconfigUSE_LLMNR == 1 */
-
-	/* If LLMNR is being used then determine if the host name includes a '.' -
-	if not then LLMNR can be used as the lookup method. */
-	#if( ipconfigUSE_LLMNR == 1 )
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+	if( uxReadTimeOut_ticks == 0U )
 	{
-	const char *pucPtr;
+		/* This DNS lookup is asynchronous, using a call-back: send the
+		request once from the shared socket.  The reply will be handled by
+		the IP-task. */
+		xDNSSocket = prvDNSResolverSocket();
 
-		for( pucPtr = pcHostName; *pucPtr != ( char ) 0; pucPtr++ )
+		if( xDNSSocket != NULL )
 		{
-			if( *pucPtr == '.' )
-			{
-				bHasDot = pdTRUE;
-				break;
-			}
+			( void ) prvSendDNSRequest( xDNSSocket, pcHostName, uxIdentifier );
 		}
 	}
-	#endif /* ipconfigUSE_LLMNR == 1 */
-
-	/* Two is added at the end for the count of characters in the first
-	subdomain part and the string end byte. */
-	uxExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2U;
-
-	xDNSSocket = prvCreateDNSSocket();
-
-	if( xDNSSocket != NULL )
+	else
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
 	{
-		/* Ideally we should check for the return value. But since we are passing
-		correct parameters, and xDNSSocket is != NULL, the return value is 
-		going to be '0' i.e. success. Thus, return value is discarded */
-		( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, &( uxWriteTimeOut_ticks ), sizeof( TickType_t ) );
-		( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, &( uxReadTimeOut_ticks ),  sizeof( TickType_t ) );
+		xDNSSocket = prvCreateDNSSocket();
 
-		for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
+		if( xDNSSocket != NULL )
 		{
-		size_t uxHeaderBytes;
-		NetworkBufferDescriptor_t *pxNetworkBuffer;
-		uint8_t *pucUDPPayloadBuffer = NULL, *pucReceiveBuffer;
-
-			/* Get a buffer.  This uses a maximum delay, but the delay will be
-			capped to ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value
-			still needs to be tested. */
-
-			uxHeaderBytes = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER;
-
-			pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxHeaderBytes + uxExpectedPayloadLength, 0UL );
-			if( pxNetworkBuffer != NULL )
-			{
-				pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ uxHeaderBytes ] );
-			}
+			/* Ideally we should check for the return value. But since we are passing
+			correct parameters, and xDNSSocket is != NULL, the return value is 
+			going to be '0' i.e. success. Thus, return value is discarded */
+			( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_SNDTIMEO, &( uxWriteTimeOut_ticks ), sizeof( TickType_t ) );
+			( void ) FreeRTOS_setsockopt( xDNSSocket, 0, FREERTOS_SO_RCVTIMEO, &( uxReadTimeOut_ticks ),  sizeof( TickType_t ) );
 
-			if( pucUDPPayloadBuffer != NULL )
+			for( xAttempt = 0; xAttempt < ipconfigDNS_REQUEST_ATTEMPTS; xAttempt++ )
 			{
-				/* Create the message in the obtained buffer. */
-				uxPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, uxIdentifier );
+			uint8_t *pucReceiveBuffer;
 
-				iptraceSENDING_DNS_REQUEST();
-
-				/* Obtain the DNS server address. */
-				FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulIPAddress );
-
-				/* Send the DNS message. */
-#if( ipconfigUSE_LLMNR == 1 )
-				if( bHasDot == pdFALSE )
-				{
-					/* Use LLMNR addressing. */
-					( ipPOINTER_CAST( DNSMessage_t *, pucUDPPayloadBuffer ) )->usFlags = 0;
-					xAddress.sin_addr = ipLLMNR_IP_ADDR; /* Is in network byte order. */
-					xAddress.sin_port = ipLLMNR_PORT;
-					xAddress.sin_port = FreeRTOS_ntohs( xAddress.sin_port );
-				}
-				else
-#endif
-				{
-					/* Use DNS server. */
-					xAddress.sin_addr = ulIPAddress;
-					xAddress.sin_port = dnsDNS_PORT;
-				}
-
-				ulIPAddress = 0UL;
-
-				if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, uxPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
+				if( prvSendDNSRequest( xDNSSocket, pcHostName, uxIdentifier ) != pdFAIL )
 				{
 					/* Wait for the reply. */
 					lBytes = FreeRTOS_recvfrom( xDNSSocket, &pucReceiveBuffer, 0, FREERTOS_ZERO_COPY, &xAddress, &ulAddressLength );
@@ -768,27 +866,111 @@ TickType_t uxWriteTimeOut_ticks = ipconfigDNS_SEND_BLOCK_TIME_TICKS;
 						}
 					}
 				}
-				else
+
+				if( uxReadTimeOut_ticks == 0U )
 				{
-					/* The message was not sent so the stack will not be
-					releasing the zero copy - it must be released here. */
-					vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+					/* This DNS lookup is asynchronous, using a call-back:
+					send the request only once. */
+					break;
 				}
 			}
 
-			if( uxReadTimeOut_ticks == 0U )
+			/* Finished with the socket. */
+			( void ) FreeRTOS_closesocket( xDNSSocket );
+		}
+	}
+
+	return ulIPAddress;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendDNSRequest( Socket_t xDNSSocket,
+									 const char *pcHostName,
+									 TickType_t uxIdentifier )
+{
+struct freertos_sockaddr xAddress;
+uint32_t ulDNSServerAddress;
+size_t uxPayloadLength, uxExpectedPayloadLength, uxHeaderBytes;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+uint8_t *pucUDPPayloadBuffer;
+BaseType_t xReturn = pdFAIL;
+
+#if( ipconfigUSE_LLMNR == 1 )
+	BaseType_t bHasDot = pdFALSE;
+#endif /* ipconfigUSE_LLMNR == 1 */
+
+	/* If LLMNR is being used then determine if the host name includes a '.' -
+	if not then LLMNR can be used as the lookup method. */
+	#if( ipconfigUSE_LLMNR == 1 )
+	{
+	const char *pucPtr;
+
+		for( pucPtr = pcHostName; *pucPtr != ( char ) 0; pucPtr++ )
+		{
+			if( *pucPtr == '.' )
 			{
-				/* This DNS lookup is asynchronous, using a call-back:
-				send the request only once. */
+				bHasDot = pdTRUE;
 				break;
 			}
 		}
+	}
+	#endif /* ipconfigUSE_LLMNR == 1 */
+
+	/* Two is added at the end for the count of characters in the first
+	subdomain part and the string end byte. */
+	uxExpectedPayloadLength = sizeof( DNSMessage_t ) + strlen( pcHostName ) + sizeof( uint16_t ) + sizeof( uint16_t ) + 2U;
+
+	/* Get a buffer.  This uses a maximum delay, but the delay will be
+	capped to ipconfigUDP_MAX_SEND_BLOCK_TIME_TICKS so the return value
+	still needs to be tested. */
+
+	uxHeaderBytes = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER;
+
+	pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxHeaderBytes + uxExpectedPayloadLength, 0UL );
+
+	if( pxNetworkBuffer != NULL )
+	{
+		pucUDPPayloadBuffer = &( pxNetworkBuffer->pucEthernetBuffer[ uxHeaderBytes ] );
+
+		/* Create the message in the obtained buffer. */
+		uxPayloadLength = prvCreateDNSMessage( pucUDPPayloadBuffer, pcHostName, uxIdentifier );
+
+		iptraceSENDING_DNS_REQUEST();
 
-		/* Finished with the socket. */
-		( void ) FreeRTOS_closesocket( xDNSSocket );
+		/* Obtain the DNS server address. */
+		FreeRTOS_GetAddressConfiguration( NULL, NULL, NULL, &ulDNSServerAddress );
+
+		/* Send the DNS message. */
+#if( ipconfigUSE_LLMNR == 1 )
+		if( bHasDot == pdFALSE )
+		{
+			/* Use LLMNR addressing. */
+			( ipPOINTER_CAST( DNSMessage_t *, pucUDPPayloadBuffer ) )->usFlags = 0;
+			xAddress.sin_addr = ipLLMNR_IP_ADDR; /* Is in network byte order. */
+			xAddress.sin_port = ipLLMNR_PORT;
+			xAddress.sin_port = FreeRTOS_ntohs( xAddress.sin_port );
+		}
+		else
+#endif
+		{
+			/* Use DNS server. */
+			xAddress.sin_addr = ulDNSServerAddress;
+			xAddress.sin_port = dnsDNS_PORT;
+		}
+
+		if( FreeRTOS_sendto( xDNSSocket, pucUDPPayloadBuffer, uxPayloadLength, FREERTOS_ZERO_COPY, &xAddress, sizeof( xAddress ) ) != 0 )
+		{
+			xReturn = pdPASS;
+		}
+		else
+		{
+			/* The message was not sent so the stack will not be
+			releasing the zero copy - it must be released here. */
+			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+		}
 	}
 
-	return ulIPAddress;
+	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
@@ -1286,6 +1468,17 @@ BaseType_t xReturn = pdTRUE;
 									The result may be stored in the DNS cache. */
 									xDoStore = pdTRUE;
 								}
+								#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+								else if( xDNSCacheIsRefreshing( pcName, ( TickType_t ) pxDNSMessageHeader->usIdentifier ) != pdFALSE )
+								{
+									/* The answer to a refresh of a cached entry. */
+									xDoStore = pdTRUE;
+								}
+								#endif
+								else
+								{
+									/* Not requested by this device. */
+								}
 							}
 							#endif	/* ipconfigDNS_USE_CALLBACKS == 1 */
 							#if( ipconfigUSE_DNS_CACHE == 1 )
@@ -1642,6 +1835,66 @@ BaseType_t xReturn;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+
+	static Socket_t prvDNSResolverSocket( void )
+	{
+	Socket_t xSocket = xDNSResolverSocket;
+	TickType_t uxWriteTimeOut_ticks = ipconfigDNS_SEND_BLOCK_TIME_TICKS;
+
+		/* The IP-task can not create the socket, because FreeRTOS_bind()
+		waits for the IP-task. */
+		if( ( xSocket == NULL ) && ( xIsCallingFromIPTask() == pdFALSE ) )
+		{
+			xSocket = prvCreateDNSSocket();
+
+			if( xSocket != NULL )
+			{
+				( void ) FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &( uxWriteTimeOut_ticks ), sizeof( TickType_t ) );
+
+				taskENTER_CRITICAL();
+				{
+					if( xDNSResolverSocket == NULL )
+					{
+						xDNSResolverSocket = xSocket;
+						xSocket = NULL;
+					}
+				}
+				taskEXIT_CRITICAL();
+
+				if( xSocket != NULL )
+				{
+					/* Another task has created the socket in the mean time. */
+					( void ) FreeRTOS_closesocket( xSocket );
+				}
+
+				xSocket = xDNSResolverSocket;
+			}
+		}
+
+		return xSocket;
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xIsDNSResolverSocket( Socket_t xSocket )
+	{
+	BaseType_t xReturn;
+
+		if( xDNSResolverSocket == xSocket )
+		{
+			xReturn = pdTRUE;
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 #if( ( ipconfigUSE_NBNS == 1 ) || ( ipconfigUSE_LLMNR == 1 ) )
 
 	static void prvReplyDNSMessage( NetworkBufferDescriptor_t *pxNetworkBuffer,
@@ -1693,6 +1946,92 @@ BaseType_t xReturn;
 
 #if( ipconfigUSE_DNS_CACHE == 1 )
 
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		/* Return the index of the hash bucket for 'pcName'. */
+		static BaseType_t prvDNSHashName( const char *pcName )
+		{
+		uint32_t ulHash = 2166136261UL;
+		const char *pcPtr;
+
+			/* A FNV-1a hash of the name. */
+			for( pcPtr = pcName; *pcPtr != ( char ) 0; pcPtr++ )
+			{
+				ulHash ^= ( uint32_t ) ( uint8_t ) *pcPtr;
+				ulHash *= 16777619UL;
+			}
+
+			return ( BaseType_t ) ( ulHash & ( ( uint32_t ) ipconfigDNS_CACHE_HASH_BUCKETS - 1UL ) );
+		}
+		/*-----------------------------------------------------------*/
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
+	static BaseType_t prvDNSCacheFind( const char *pcName )
+	{
+	BaseType_t xEntry = -1;
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		const List_t *pxBucket = &( xDNSHashTable[ prvDNSHashName( pcName ) ] );
+		const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxBucket ) );
+		const ListItem_t *pxIterator;
+	#else
+		BaseType_t x;
+	#endif
+
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		{
+			/* Only visit the rows in the bucket of this name. */
+			for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+				 pxIterator != pxEnd;
+				 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+			{
+			const DNSCacheRow_t *pxRow = ipPOINTER_CAST( const DNSCacheRow_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+				if( strcmp( pxRow->pcName, pcName ) == 0 )
+				{
+					xEntry = ( BaseType_t ) ( pxRow - xDNSCache );
+					break;
+				}
+			}
+		}
+		#else
+		{
+			/* For each entry in the DNS cache table. */
+			for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+			{
+				if( xDNSCache[ x ].pcName[ 0 ] == ( char ) 0 )
+				{
+					continue;
+				}
+
+				if( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 )
+				{
+					xEntry = x;
+					break;
+				}
+			}
+		}
+		#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
+		return xEntry;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvDNSCacheRemove( BaseType_t xEntry )
+	{
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		{
+			/* A row is in a hash bucket as long as it has a name. */
+			if( xDNSCache[ xEntry ].pcName[ 0 ] != ( char ) 0 )
+			{
+				( void ) uxListRemove( &( xDNSCache[ xEntry ].xHashItem ) );
+				uxDNSCacheRows--;
+			}
+		}
+		#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
+		xDNSCache[ xEntry ].pcName[ 0 ] = ( char ) 0;
+	}
+	/*-----------------------------------------------------------*/
+
 	static BaseType_t prvProcessDNSCache( const char *pcName,
 									uint32_t *pulIP,
 									uint32_t ulTTL,
@@ -1703,66 +2042,85 @@ BaseType_t xReturn;
 	uint32_t ulCurrentTimeSeconds = ( xTaskGetTickCount() / portTICK_PERIOD_MS ) / 1000U;
 	uint32_t ulIPAddressIndex = 0;
 	static BaseType_t xFreeEntry = 0;
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		BaseType_t xStartTimer = pdFALSE;
+	#endif
 
 		configASSERT( ( pcName != NULL ) );
 
-		/* For each entry in the DNS cache table. */
-		for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
 		{
-			if( xDNSCache[ x ].pcName[ 0 ] == ( char ) 0 )
-			{
-				continue;
-			}
+			/* The hash buckets are accessed by the IP-task and by the tasks
+			that do a look-up. */
+			vTaskSuspendAll();
+		}
+		#endif
+
+		x = prvDNSCacheFind( pcName );
 
-			if( strcmp( xDNSCache[ x ].pcName, pcName ) == 0 )
+		if( x >= 0 )
+		{
+			/* Is this function called for a lookup or to add/update an IP address? */
+			if( xLookUp != pdFALSE )
 			{
-				/* Is this function called for a lookup or to add/update an IP address? */
-				if( xLookUp != pdFALSE )
+				/* Confirm that the record is still fresh. */
+				if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
 				{
-					/* Confirm that the record is still fresh. */
-					if( ulCurrentTimeSeconds < ( xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL ) ) )
-					{
 #if( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
-					uint8_t ucIndex;
-						/* The ucCurrentIPAddress value increments without bound and will rollover, */
-						/*  modulo it by the number of IP addresses to keep it in range.     */
-						/*  Also perform a final modulo by the max number of IP addresses    */
-						/*  per DNS cache entry to prevent out-of-bounds access in the event */
-						/*  that ucNumIPAddresses has been corrupted.                        */
-						ucIndex = xDNSCache[ x ].ucCurrentIPAddress % xDNSCache[ x ].ucNumIPAddresses;
-						ucIndex = ucIndex % ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
-						ulIPAddressIndex = ucIndex;
-
-						xDNSCache[ x ].ucCurrentIPAddress++;
+				uint8_t ucIndex;
+					/* The ucCurrentIPAddress value increments without bound and will rollover, */
+					/*  modulo it by the number of IP addresses to keep it in range.     */
+					/*  Also perform a final modulo by the max number of IP addresses    */
+					/*  per DNS cache entry to prevent out-of-bounds access in the event */
+					/*  that ucNumIPAddresses has been corrupted.                        */
+					ucIndex = xDNSCache[ x ].ucCurrentIPAddress % xDNSCache[ x ].ucNumIPAddresses;
+					ucIndex = ucIndex % ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY;
+					ulIPAddressIndex = ucIndex;
+
+					xDNSCache[ x ].ucCurrentIPAddress++;
 #endif
-						*pulIP = xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ];
-					}
-					else
+					*pulIP = xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ];
+
+					#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
 					{
-						/* Age out the old cached record. */
-						xDNSCache[ x ].pcName[ 0 ] = ( char ) 0;
+						/* The row is in use, refresh it before it expires. */
+						xDNSCache[ x ].ucUsed = 1U;
 					}
+					#endif
 				}
 				else
 				{
+					/* Age out the old cached record. */
+					prvDNSCacheRemove( x );
+				}
+			}
+			else
+			{
 #if( ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY > 1 )
-					if ( xDNSCache[ x ].ucNumIPAddresses < ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
-					{
-						/* If more answers exist than there are IP address storage slots */
-						/* they will overwrite entry 0 */
+				if ( xDNSCache[ x ].ucNumIPAddresses < ( uint8_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY )
+				{
+					/* If more answers exist than there are IP address storage slots */
+					/* they will overwrite entry 0 */
 
-						ulIPAddressIndex = xDNSCache[ x ].ucNumIPAddresses;
-						xDNSCache[ x ].ucNumIPAddresses++;
-					}
-#endif
-					xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ] = *pulIP;
-					xDNSCache[ x ].ulTTL = ulTTL;
-					xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
+					ulIPAddressIndex = xDNSCache[ x ].ucNumIPAddresses;
+					xDNSCache[ x ].ucNumIPAddresses++;
 				}
+#endif
+				xDNSCache[ x ].ulIPAddresses[ ulIPAddressIndex ] = *pulIP;
+				xDNSCache[ x ].ulTTL = ulTTL;
+				xDNSCache[ x ].ulTimeWhenAddedInSeconds = ulCurrentTimeSeconds;
 
-				xFound = pdTRUE;
-				break;
+				#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+				{
+					/* The row must be looked up again before it will be
+					refreshed again. */
+					xDNSCache[ x ].ucUsed = 0U;
+					xDNSCache[ x ].ucRefreshing = 0U;
+				}
+				#endif
 			}
+
+			xFound = pdTRUE;
 		}
 
 		if( xFound == pdFALSE )
@@ -1776,6 +2134,28 @@ BaseType_t xReturn;
 				/* Add or update the item. */
 				if( strlen( pcName ) < ( size_t ) ipconfigDNS_CACHE_NAME_LENGTH )
 				{
+					#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+					{
+					BaseType_t xCount;
+
+						/* Prefer an empty row above overwriting a row that is
+						still in use. */
+						for( xCount = 0;
+							 ( xCount < ipconfigDNS_CACHE_ENTRIES ) && ( xDNSCache[ xFreeEntry ].pcName[ 0 ] != ( char ) 0 ) && ( uxDNSCacheRows < ( UBaseType_t ) ipconfigDNS_CACHE_ENTRIES );
+							 xCount++ )
+						{
+							xFreeEntry++;
+
+							if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
+							{
+								xFreeEntry = 0;
+							}
+						}
+
+						prvDNSCacheRemove( xFreeEntry );
+					}
+					#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 					( void ) strcpy( xDNSCache[ xFreeEntry ].pcName, pcName );
 
 					xDNSCache[ xFreeEntry ].ulIPAddresses[ 0 ] = *pulIP;
@@ -1792,6 +2172,21 @@ BaseType_t xReturn;
 								( ( uint32_t ) ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY - 1U ) );
 #endif
 
+					#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+					{
+						xDNSCache[ xFreeEntry ].ucUsed = 0U;
+						xDNSCache[ xFreeEntry ].ucRefreshing = 0U;
+						vListInsertEnd( &( xDNSHashTable[ prvDNSHashName( pcName ) ] ), &( xDNSCache[ xFreeEntry ].xHashItem ) );
+						uxDNSCacheRows++;
+
+						if( uxDNSCacheRows == 1U )
+						{
+							/* The DNS timer will look for rows to refresh. */
+							xStartTimer = pdTRUE;
+						}
+					}
+					#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 					xFreeEntry++;
 
 					if( xFreeEntry == ipconfigDNS_CACHE_ENTRIES )
@@ -1802,12 +2197,102 @@ BaseType_t xReturn;
 			}
 		}
 
+		#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		{
+			( void ) xTaskResumeAll();
+
+			if( xStartTimer != pdFALSE )
+			{
+				vIPReloadDNSTimer( 1000U );
+			}
+		}
+		#endif
+
 		if( ( xLookUp == 0 ) || ( *pulIP != 0UL ) )
 		{
 			FreeRTOS_debug_printf( ( "prvProcessDNSCache: %s: '%s' @ %lxip\n", ( xLookUp != 0 ) ? "look-up" : "add", pcName, FreeRTOS_ntohl( *pulIP ) ) );
 		}
 		return xFound;
 	}
+	/*-----------------------------------------------------------*/
+
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+		static BaseType_t xDNSCacheIsRefreshing( const char *pcName,
+												  TickType_t uxIdentifier )
+		{
+		BaseType_t x;
+		BaseType_t xResult = pdFALSE;
+
+			vTaskSuspendAll();
+			{
+				x = prvDNSCacheFind( pcName );
+
+				if( ( x >= 0 ) &&
+					( xDNSCache[ x ].ucRefreshing != 0U ) &&
+					( ( TickType_t ) xDNSCache[ x ].usRefreshIdentifier == uxIdentifier ) )
+				{
+					xResult = pdTRUE;
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			return xResult;
+		}
+		/*-----------------------------------------------------------*/
+
+		static UBaseType_t uxDNSCachePrefetch( void )
+		{
+		BaseType_t x;
+		BaseType_t xRefresh;
+		uint32_t ulCurrentTimeSeconds = ( xTaskGetTickCount() / portTICK_PERIOD_MS ) / 1000U;
+		uint32_t ulExpireTime, ulNumber;
+		Socket_t xSocket = xDNSResolverSocket;
+
+			for( x = 0; x < ipconfigDNS_CACHE_ENTRIES; x++ )
+			{
+				xRefresh = pdFALSE;
+
+				vTaskSuspendAll();
+				{
+					if( xDNSCache[ x ].pcName[ 0 ] != ( char ) 0 )
+					{
+						ulExpireTime = xDNSCache[ x ].ulTimeWhenAddedInSeconds + FreeRTOS_ntohl( xDNSCache[ x ].ulTTL );
+
+						if( ulCurrentTimeSeconds >= ulExpireTime )
+						{
+							prvDNSCacheRemove( x );
+						}
+						else if( ( xSocket != NULL ) &&
+								 ( xDNSCache[ x ].ucUsed != 0U ) &&
+								 ( xDNSCache[ x ].ucRefreshing == 0U ) &&
+								 ( ( ulExpireTime - ulCurrentTimeSeconds ) <= ( uint32_t ) ipconfigDNS_PREFETCH_SECONDS ) )
+						{
+							/* The row will be refreshed only once. */
+							xDNSCache[ x ].ucRefreshing = 1U;
+							xRefresh = pdTRUE;
+						}
+						else
+						{
+							/* Nothing to do for this row. */
+						}
+					}
+				}
+				( void ) xTaskResumeAll();
+
+				if( ( xRefresh != pdFALSE ) && ( xApplicationGetRandomNumber( &( ulNumber ) ) != pdFALSE ) )
+				{
+					/* The reply will be recognised by its identifier.  Should the
+					row be taken by another name in the mean time, the reply will
+					not be stored. */
+					xDNSCache[ x ].usRefreshIdentifier = ( uint16_t ) ( ulNumber & 0xffffU );
+					( void ) prvSendDNSRequest( xSocket, xDNSCache[ x ].pcName, ( TickType_t ) xDNSCache[ x ].usRefreshIdentifier );
+				}
+			}
+
+			return uxDNSCacheRows;
+		}
+		/*-----------------------------------------------------------*/
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
 
 #endif /* ipconfigUSE_DNS_CACHE */
 
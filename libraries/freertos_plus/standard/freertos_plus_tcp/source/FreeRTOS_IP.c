@@ -45,6 +45,11 @@
 #include "NetworkBufferManagement.h"
 #include "FreeRTOS_DNS.h"
 
+#if( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_SSE2 )
+	#include <immintrin.h>
+#elif( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_NEON )
+	#include <arm_neon.h>
+#endif
 
 /* Used to ensure the structure packing is having the desired effect.  The
 'volatile' is used to prevent compiler warnings about comparing a constant with
@@ -97,6 +102,13 @@ shorted in the Windows simulator as simulated time is not real time. */
 	#define ipTCP_TIMER_PERIOD_MS	( 1000U )
 #endif
 
+/* The IP-task only handles the TCP sockets when there are no TCP worker tasks. */
+#define ipIP_TASK_HANDLES_TCP		( ( ipconfigUSE_TCP == 1 ) && ( ipconfigIP_TCP_WORKER_TASKS == 0 ) )
+
+/* The checksum of a received TCP packet is not verified by the IP-task when it
+is checked while copying, or when it is left to the TCP worker tasks. */
+#define ipTCP_RX_CHECKSUM_DEFERRED	( ipTCP_RX_CHECKSUM_WHILE_COPYING || ( ( ipconfigIP_TCP_WORKER_TASKS > 0 ) && ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 0 ) ) )
+
 /* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
 driver will filter incoming packets and only pass the stack those packets it
 considers need processing.  In this case ipCONSIDER_FRAME_FOR_PROCESSING() can
@@ -167,6 +179,11 @@ typedef union _xUnionPtr
  */
 static void prvIPTask( void *pvParameters );
 
+/*
+ * Handle a single event that was taken from the network event queue.
+ */
+static void prvProcessIPEvent( const IPStackEvent_t *pxReceivedEvent );
+
 /*
  * Called when new data is available from the network interface.
  */
@@ -235,11 +252,41 @@ static eFrameProcessingResult_t prvAllowIPPacket( const IPPacket_t * const pxIPP
 												  const NetworkBufferDescriptor_t * const pxNetworkBuffer,
 												  UBaseType_t uxHeaderLength );
 
-#if( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 )
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	/*
+	 * Create the mutex, the event queues and the TCP worker tasks.
+	 */
+	static BaseType_t prvTCPWorkersInit( void );
+
+	/*
+	 * A TCP worker task.  It handles the received packets, the timers and the
+	 * closing of the TCP sockets that hash to it.
+	 */
+	static void prvTCPWorkerTask( void *pvParameters );
+
+	/*
+	 * Called by the IP-task to pass a received TCP packet on to the worker task
+	 * that handles its connection.
+	 */
+	static BaseType_t prvTCPWorkerReceive( NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+	/*
+	 * Returns the index of the TCP worker task that owns the connection of a
+	 * received TCP packet.
+	 */
+	static UBaseType_t prvTCPWorkerForPacket( const NetworkBufferDescriptor_t * const pxNetworkBuffer );
+
+	/*
+	 * Let all TCP worker tasks check their sockets.
+	 */
+	static void prvTCPWorkersWakeUp( void );
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+#if( ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) || ipTCP_RX_CHECKSUM_DEFERRED )
 	/* Even when the driver takes care of checksum calculations,
 	the IP-task will still check if the length fields are OK. */
 	static BaseType_t xCheckSizeFields( const uint8_t * const pucEthernetBuffer, size_t uxBufferLength );
-#endif	/* ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) */
+#endif	/* ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) || ipTCP_RX_CHECKSUM_DEFERRED */
 
 /*-----------------------------------------------------------*/
 
@@ -273,7 +320,7 @@ being called by a task (in which case it is ok to block) or by the IP task
 itself (in which case it is not ok to block). */
 static TaskHandle_t xIPTaskHandle = NULL;
 
-#if( ipconfigUSE_TCP != 0 )
+#if( ipIP_TASK_HANDLES_TCP )
 	/* Set to a non-zero value if one or more TCP message have been processed
 	within the last round. */
 	static BaseType_t xProcessedTCPMessage;
@@ -295,7 +342,7 @@ static IPTimer_t xARPTimer;
 #if( ipconfigUSE_DHCP != 0 )
 	static IPTimer_t xDHCPTimer;
 #endif
-#if( ipconfigUSE_TCP != 0 )
+#if( ipIP_TASK_HANDLES_TCP )
 	static IPTimer_t xTCPTimer;
 #endif
 #if( ipconfigDNS_USE_CALLBACKS != 0 )
@@ -312,6 +359,23 @@ static BaseType_t xIPTaskInitialised = pdFALSE;
 	static UBaseType_t uxQueueMinimumSpace = ipconfigEVENT_QUEUE_LENGTH;
 #endif
 
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	/* The administration of a TCP worker task. */
+	typedef struct xTCP_WORKER
+	{
+		TaskHandle_t xTaskHandle;			/* The handle of the worker task. */
+		QueueHandle_t xEventQueue;			/* The events that were passed to this worker. */
+		IPTimer_t xTCPTimer;				/* Same as the IP-task's TCP timer, but for the sockets of this worker. */
+		BaseType_t xProcessedTCPMessage;	/* Set when a TCP packet was processed within the last round. */
+	} TCPWorker_t;
+
+	static TCPWorker_t xTCPWorkers[ ipconfigIP_TCP_WORKER_TASKS ];
+
+	/* Protects the lists of bound sockets and the listening sockets, which are
+	shared between the IP-task and the worker tasks. */
+	static SemaphoreHandle_t xTCPWorkerMutex = NULL;
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 /*-----------------------------------------------------------*/
 
 /* Coverity want to make pvParameters const, which would make it incompatible. */
@@ -320,8 +384,6 @@ static void prvIPTask( void *pvParameters )
 {
 IPStackEvent_t xReceivedEvent;
 TickType_t xNextIPSleep;
-FreeRTOS_Socket_t *pxSocket;
-struct freertos_sockaddr xAddress;
 
 	/* Just to prevent compiler warnings about unused parameters. */
 	( void ) pvParameters;
@@ -335,7 +397,7 @@ struct freertos_sockaddr xAddress;
 	send this message if a previously connected network is disconnected. */
 	FreeRTOS_NetworkDown();
 
-	#if( ipconfigUSE_TCP == 1 )
+	#if( ipIP_TASK_HANDLES_TCP )
 	{
 		/* Initialise the TCP timer. */
 		prvIPTimerReload( &xTCPTimer, pdMS_TO_TICKS( ipTCP_TIMER_PERIOD_MS ) );
@@ -367,178 +429,211 @@ struct freertos_sockaddr xAddress;
 			xReceivedEvent.eEventType = eNoEvent;
 		}
 
-		#if( ipconfigCHECK_IP_QUEUE_SPACE != 0 )
+		prvProcessIPEvent( &xReceivedEvent );
+
+		#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
 		{
-			if( xReceivedEvent.eEventType != eNoEvent )
-			{
-			UBaseType_t uxCount;
+		UBaseType_t uxEventCount;
 
-				uxCount = uxQueueSpacesAvailable( xNetworkEventQueue );
-				if( uxQueueMinimumSpace > uxCount )
+			/* Handle the events that are already waiting, up to a maximum, before
+			the timers are checked again.  This saves a round trip through the
+			scheduler for every received packet at high packet rates.  TCP already
+			postpones its acknowledgements and wake-ups until the queue is empty,
+			which is now at the end of a batch. */
+			for( uxEventCount = 1U; ( xReceivedEvent.eEventType != eNoEvent ) && ( uxEventCount < ( UBaseType_t ) ipconfigIP_TASK_EVENT_BATCH ); uxEventCount++ )
+			{
+				if( xQueueReceive( xNetworkEventQueue, ipPOINTER_CAST( void *, &xReceivedEvent ), ( TickType_t ) 0 ) == pdFALSE )
 				{
-					uxQueueMinimumSpace = uxCount;
+					break;
 				}
+
+				prvProcessIPEvent( &xReceivedEvent );
 			}
+
+			/* Wake up the owners of the UDP sockets that received packets. */
+			vSocketWakeUpDeferred();
 		}
-		#endif /* ipconfigCHECK_IP_QUEUE_SPACE */
+		#endif /* ipconfigIP_TASK_EVENT_BATCH */
 
-		iptraceNETWORK_EVENT_RECEIVED( xReceivedEvent.eEventType );
+		if( xNetworkDownEventPending != pdFALSE )
+		{
+			/* A network down event could not be posted to the network event
+			queue because the queue was full.
+			As this code runs in the IP-task, it can be done directly by
+			calling prvProcessNetworkDownEvent(). */
+			prvProcessNetworkDownEvent();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvProcessIPEvent( const IPStackEvent_t *pxReceivedEvent )
+{
+FreeRTOS_Socket_t *pxSocket;
+struct freertos_sockaddr xAddress;
 
-		switch( xReceivedEvent.eEventType )
+	#if( ipconfigCHECK_IP_QUEUE_SPACE != 0 )
+	{
+		if( pxReceivedEvent->eEventType != eNoEvent )
 		{
-			case eNetworkDownEvent :
-				/* Attempt to establish a connection. */
-				xNetworkUp = pdFALSE;
-				prvProcessNetworkDownEvent();
-				break;
+		UBaseType_t uxCount;
 
-			case eNetworkRxEvent:
-				/* The network hardware driver has received a new packet.  A
-				pointer to the received buffer is located in the pvData member
-				of the received event structure. */
-				prvHandleEthernetPacket( ipPOINTER_CAST( NetworkBufferDescriptor_t *, xReceivedEvent.pvData ) );
-				break;
+			uxCount = uxQueueSpacesAvailable( xNetworkEventQueue );
+			if( uxQueueMinimumSpace > uxCount )
+			{
+				uxQueueMinimumSpace = uxCount;
+			}
+		}
+	}
+	#endif /* ipconfigCHECK_IP_QUEUE_SPACE */
 
-			case eNetworkTxEvent:
-				/* Send a network packet. The ownership will  be transferred to
-				the driver, which will release it after delivery. */
-				( void ) xNetworkInterfaceOutput( ipPOINTER_CAST( NetworkBufferDescriptor_t *, xReceivedEvent.pvData ), pdTRUE );
-				break;
+	iptraceNETWORK_EVENT_RECEIVED( pxReceivedEvent->eEventType );
 
-			case eARPTimerEvent :
-				/* The ARP timer has expired, process the ARP cache. */
-				vARPAgeCache();
-				break;
+	switch( pxReceivedEvent->eEventType )
+	{
+		case eNetworkDownEvent :
+			/* Attempt to establish a connection. */
+			xNetworkUp = pdFALSE;
+			prvProcessNetworkDownEvent();
+			break;
 
-			case eSocketBindEvent:
-				/* FreeRTOS_bind (a user API) wants the IP-task to bind a socket
-				to a port. The port number is communicated in the socket field
-				usLocalPort. vSocketBind() will actually bind the socket and the
-				API will unblock as soon as the eSOCKET_BOUND event is
-				triggered. */
-				pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, xReceivedEvent.pvData );
-				xAddress.sin_addr = 0U;	/* For the moment. */
-				xAddress.sin_port = FreeRTOS_ntohs( pxSocket->usLocalPort );
-				pxSocket->usLocalPort = 0U;
-				( void ) vSocketBind( pxSocket, &xAddress, sizeof( xAddress ), pdFALSE );
-
-				/* Before 'eSocketBindEvent' was sent it was tested that
-				( xEventGroup != NULL ) so it can be used now to wake up the
-				user. */
-				pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_BOUND;
-				vSocketWakeUpUser( pxSocket );
-				break;
+		case eNetworkRxEvent:
+			/* The network hardware driver has received a new packet.  A
+			pointer to the received buffer is located in the pvData member
+			of the received event structure. */
+			prvHandleEthernetPacket( ipPOINTER_CAST( NetworkBufferDescriptor_t *, pxReceivedEvent->pvData ) );
+			break;
 
-			case eSocketCloseEvent :
-				/* The user API FreeRTOS_closesocket() has sent a message to the
-				IP-task to actually close a socket. This is handled in
-				vSocketClose().  As the socket gets closed, there is no way to
-				report back to the API, so the API won't wait for the result */
-				( void ) vSocketClose( ipPOINTER_CAST( FreeRTOS_Socket_t *, xReceivedEvent.pvData ) );
-				break;
+		case eNetworkTxEvent:
+			/* Send a network packet. The ownership will  be transferred to
+			the driver, which will release it after delivery. */
+			( void ) xNetworkInterfaceOutput( ipPOINTER_CAST( NetworkBufferDescriptor_t *, pxReceivedEvent->pvData ), pdTRUE );
+			break;
 
-			case eStackTxEvent :
-				/* The network stack has generated a packet to send.  A
-				pointer to the generated buffer is located in the pvData
-				member of the received event structure. */
-				vProcessGeneratedUDPPacket( ipPOINTER_CAST( NetworkBufferDescriptor_t *, xReceivedEvent.pvData ) );
-				break;
+		case eARPTimerEvent :
+			/* The ARP timer has expired, process the ARP cache. */
+			vARPAgeCache();
+			break;
 
-			case eDHCPEvent:
-				/* The DHCP state machine needs processing. */
-				#if( ipconfigUSE_DHCP == 1 )
-				{
-					/* Process DHCP messages for a given end-point. */
-					vDHCPProcess( pdFALSE );
-				}
-				#endif /* ipconfigUSE_DHCP */
-				break;
+		case eSocketBindEvent:
+			/* FreeRTOS_bind (a user API) wants the IP-task to bind a socket
+			to a port. The port number is communicated in the socket field
+			usLocalPort. vSocketBind() will actually bind the socket and the
+			API will unblock as soon as the eSOCKET_BOUND event is
+			triggered. */
+			pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, pxReceivedEvent->pvData );
+			xAddress.sin_addr = 0U;	/* For the moment. */
+			xAddress.sin_port = FreeRTOS_ntohs( pxSocket->usLocalPort );
+			pxSocket->usLocalPort = 0U;
+			( void ) vSocketBind( pxSocket, &xAddress, sizeof( xAddress ), pdFALSE );
+
+			/* Before 'eSocketBindEvent' was sent it was tested that
+			( xEventGroup != NULL ) so it can be used now to wake up the
+			user. */
+			pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_BOUND;
+			vSocketWakeUpUser( pxSocket );
+			break;
 
-			case eSocketSelectEvent :
-				/* FreeRTOS_select() has got unblocked by a socket event,
-				vSocketSelect() will check which sockets actually have an event
-				and update the socket field xSocketBits. */
-				#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
-				{
-					#if( ipconfigSELECT_USES_NOTIFY != 0 )
-					{
-						SocketSelectMessage_t *pxMessage = ipPOINTER_CAST( SocketSelectMessage_t *, xReceivedEvent.pvData );
-						vSocketSelect( pxMessage->pxSocketSet );
-						( void ) xTaskNotifyGive( pxMessage->xTaskhandle );
-					}
-					#else
-					{
-						vSocketSelect( ipPOINTER_CAST( SocketSelect_t *, xReceivedEvent.pvData ) );
-					}
-					#endif	/* ( ipconfigSELECT_USES_NOTIFY != 0 ) */
-				}
-				#endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
-				break;
+		case eSocketCloseEvent :
+			/* The user API FreeRTOS_closesocket() has sent a message to the
+			IP-task to actually close a socket. This is handled in
+			vSocketClose().  As the socket gets closed, there is no way to
+			report back to the API, so the API won't wait for the result */
+			( void ) vSocketClose( ipPOINTER_CAST( FreeRTOS_Socket_t *, pxReceivedEvent->pvData ) );
+			break;
+
+		case eStackTxEvent :
+			/* The network stack has generated a packet to send.  A
+			pointer to the generated buffer is located in the pvData
+			member of the received event structure. */
+			vProcessGeneratedUDPPacket( ipPOINTER_CAST( NetworkBufferDescriptor_t *, pxReceivedEvent->pvData ) );
+			break;
+
+		case eDHCPEvent:
+			/* The DHCP state machine needs processing. */
+			#if( ipconfigUSE_DHCP == 1 )
+			{
+				/* Process DHCP messages for a given end-point. */
+				vDHCPProcess( pdFALSE );
+			}
+			#endif /* ipconfigUSE_DHCP */
+			break;
 
-			case eSocketSignalEvent :
-				#if( ipconfigSUPPORT_SIGNALS != 0 )
+		case eSocketSelectEvent :
+			/* FreeRTOS_select() has got unblocked by a socket event,
+			vSocketSelect() will check which sockets actually have an event
+			and update the socket field xSocketBits. */
+			#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
+			{
+				#if( ipconfigSELECT_USES_NOTIFY != 0 )
 				{
-					/* Some task wants to signal the user of this socket in
-					order to interrupt a call to recv() or a call to select(). */
-					( void ) FreeRTOS_SignalSocket( ipPOINTER_CAST( Socket_t, xReceivedEvent.pvData ) );
+					SocketSelectMessage_t *pxMessage = ipPOINTER_CAST( SocketSelectMessage_t *, pxReceivedEvent->pvData );
+					vSocketSelect( pxMessage->pxSocketSet );
+					( void ) xTaskNotifyGive( pxMessage->xTaskhandle );
 				}
-				#endif /* ipconfigSUPPORT_SIGNALS */
-				break;
-
-			case eTCPTimerEvent :
-				#if( ipconfigUSE_TCP == 1 )
+				#else
 				{
-					/* Simply mark the TCP timer as expired so it gets processed
-					the next time prvCheckNetworkTimers() is called. */
-					xTCPTimer.bExpired = pdTRUE_UNSIGNED;
+					vSocketSelect( ipPOINTER_CAST( SocketSelect_t *, pxReceivedEvent->pvData ) );
 				}
-				#endif /* ipconfigUSE_TCP */
-				break;
+				#endif	/* ( ipconfigSELECT_USES_NOTIFY != 0 ) */
+			}
+			#endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+			break;
 
-			case eTCPAcceptEvent:
-				/* The API FreeRTOS_accept() was called, the IP-task will now
-				check if the listening socket (communicated in pvData) actually
-				received a new connection. */
-				#if( ipconfigUSE_TCP == 1 )
-				{
-					pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, xReceivedEvent.pvData );
+		case eSocketSignalEvent :
+			#if( ipconfigSUPPORT_SIGNALS != 0 )
+			{
+				/* Some task wants to signal the user of this socket in
+				order to interrupt a call to recv() or a call to select(). */
+				( void ) FreeRTOS_SignalSocket( ipPOINTER_CAST( Socket_t, pxReceivedEvent->pvData ) );
+			}
+			#endif /* ipconfigSUPPORT_SIGNALS */
+			break;
 
-					if( xTCPCheckNewClient( pxSocket ) != pdFALSE )
-					{
-						pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_ACCEPT;
-						vSocketWakeUpUser( pxSocket );
-					}
-				}
-				#endif /* ipconfigUSE_TCP */
-				break;
+		case eTCPTimerEvent :
+			#if( ipIP_TASK_HANDLES_TCP )
+			{
+				/* Simply mark the TCP timer as expired so it gets processed
+				the next time prvCheckNetworkTimers() is called. */
+				xTCPTimer.bExpired = pdTRUE_UNSIGNED;
+			}
+			#endif /* ipIP_TASK_HANDLES_TCP */
+			break;
+
+		case eTCPAcceptEvent:
+			/* The API FreeRTOS_accept() was called, the IP-task will now
+			check if the listening socket (communicated in pvData) actually
+			received a new connection. */
+			#if( ipconfigUSE_TCP == 1 )
+			{
+				pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, pxReceivedEvent->pvData );
 
-			case eTCPNetStat:
-				/* FreeRTOS_netstat() was called to have the IP-task print an
-				overview of all sockets and their connections */
-				#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_PRINTF == 1 ) )
+				if( xTCPCheckNewClient( pxSocket ) != pdFALSE )
 				{
-					vTCPNetStat();
+					pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_ACCEPT;
+					vSocketWakeUpUser( pxSocket );
 				}
-				#endif /* ipconfigUSE_TCP */
-				break;
+			}
+			#endif /* ipconfigUSE_TCP */
+			break;
 
-			case eNoEvent:
-				/* xQueueReceive() returned because of a normal time-out. */
-				break;
+		case eTCPNetStat:
+			/* FreeRTOS_netstat() was called to have the IP-task print an
+			overview of all sockets and their connections */
+			#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_PRINTF == 1 ) )
+			{
+				vTCPNetStat();
+			}
+			#endif /* ipconfigUSE_TCP */
+			break;
 
-			default :
-				/* Should not get here. */
-				break;
-		}
+		case eNoEvent:
+			/* xQueueReceive() returned because of a normal time-out. */
+			break;
 
-		if( xNetworkDownEventPending != pdFALSE )
-		{
-			/* A network down event could not be posted to the network event
-			queue because the queue was full.
-			As this code runs in the IP-task, it can be done directly by
-			calling prvProcessNetworkDownEvent(). */
-			prvProcessNetworkDownEvent();
-		}
+		default :
+			/* Should not get here. */
+			break;
 	}
 }
 /*-----------------------------------------------------------*/
@@ -551,6 +646,14 @@ BaseType_t xReturn;
 	{
 		xReturn = pdTRUE;
 	}
+	#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	else if( xTCPWorkerCurrent() >= 0 )
+	{
+		/* A TCP worker task does the work of the IP-task for its sockets,
+		and it may not block on the IP-task either. */
+		xReturn = pdTRUE;
+	}
+	#endif /* ipconfigIP_TCP_WORKER_TASKS */
 	else
 	{
 		xReturn = pdFALSE;
@@ -587,6 +690,12 @@ static void prvHandleEthernetPacket( NetworkBufferDescriptor_t *pxBuffer )
 			/* Make it NULL to avoid using it later on. */
 			pxBuffer->pxNextBuffer = NULL;
 
+			#if( ipconfigTCP_RX_COALESCING != 0 )
+			{
+				vTCPCheckCoalescing( pxBuffer, pxNextBuffer );
+			}
+			#endif
+
 			prvProcessEthernetPacket( pxBuffer );
 			pxBuffer = pxNextBuffer;
 
@@ -625,7 +734,7 @@ TickType_t xMaximumSleepTime;
 	}
 	#endif /* ipconfigUSE_DHCP */
 
-	#if( ipconfigUSE_TCP == 1 )
+	#if( ipIP_TASK_HANDLES_TCP )
 	{
 		if( xTCPTimer.ulRemainingTime < xMaximumSleepTime )
 		{
@@ -678,7 +787,7 @@ static void prvCheckNetworkTimers( void )
 	}
 	#endif /* ipconfigDNS_USE_CALLBACKS */
 
-	#if( ipconfigUSE_TCP == 1 )
+	#if( ipIP_TASK_HANDLES_TCP )
 	{
 	BaseType_t xWillSleep;
 	TickType_t xNextTime;
@@ -714,10 +823,292 @@ static void prvCheckNetworkTimers( void )
 			xProcessedTCPMessage = 0;
 		}
 	}
-	#endif /* ipconfigUSE_TCP == 1 */
+	#endif /* ipIP_TASK_HANDLES_TCP */
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+
+	static BaseType_t prvTCPWorkersInit( void )
+	{
+	TCPWorker_t *pxWorker;
+	UBaseType_t uxIndex;
+	BaseType_t xReturn = pdPASS;
+
+		xTCPWorkerMutex = xSemaphoreCreateRecursiveMutex();
+
+		if( xTCPWorkerMutex == NULL )
+		{
+			xReturn = pdFAIL;
+		}
+
+		for( uxIndex = 0U; ( xReturn == pdPASS ) && ( uxIndex < ( UBaseType_t ) ipconfigIP_TCP_WORKER_TASKS ); uxIndex++ )
+		{
+			pxWorker = &( xTCPWorkers[ uxIndex ] );
+			pxWorker->xEventQueue = xQueueCreate( ipconfigIP_TCP_WORKER_QUEUE_LENGTH, sizeof( IPStackEvent_t ) );
+
+			if( pxWorker->xEventQueue == NULL )
+			{
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				xReturn = xTaskCreate( prvTCPWorkerTask,
+									   "TCP-worker",
+									   ( uint16_t )ipconfigIP_TASK_STACK_SIZE_WORDS,
+									   ( void * ) pxWorker,
+									   ( UBaseType_t )ipconfigIP_TASK_PRIORITY,
+									   &( pxWorker->xTaskHandle ) );
+			}
+		}
+
+		if( xReturn != pdPASS )
+		{
+			FreeRTOS_debug_printf( ( "prvTCPWorkersInit: could not create the TCP workers\n" ) );
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	/* Coverity want to make pvParameters const, which would make it incompatible. */
+	/* coverity[misra_c_2012_rule_8_13_violation] */
+	static void prvTCPWorkerTask( void *pvParameters )
+	{
+	TCPWorker_t *pxWorker = ipPOINTER_CAST( TCPWorker_t *, pvParameters );
+	IPStackEvent_t xReceivedEvent;
+	NetworkBufferDescriptor_t *pxNetworkBuffer;
+	TickType_t xNextSleep;
+	BaseType_t xWillSleep;
+	BaseType_t xCheckTCPSockets;
+
+		prvIPTimerReload( &( pxWorker->xTCPTimer ), pdMS_TO_TICKS( ipTCP_TIMER_PERIOD_MS ) );
+
+		for( ;; )
+		{
+			/* The same logic as in prvCheckNetworkTimers(): check the sockets
+			when the timer has expired, or when packets were handled and there
+			is nothing left to do. */
+			if( uxQueueMessagesWaiting( pxWorker->xEventQueue ) == 0U )
+			{
+				xWillSleep = pdTRUE;
+			}
+			else
+			{
+				xWillSleep = pdFALSE;
+			}
+
+			xCheckTCPSockets = prvIPTimerCheck( &( pxWorker->xTCPTimer ) );
+
+			if( ( pxWorker->xProcessedTCPMessage != pdFALSE ) && ( xWillSleep != pdFALSE ) )
+			{
+				xCheckTCPSockets = pdTRUE;
+			}
+
+			if( xCheckTCPSockets != pdFALSE )
+			{
+				prvIPTimerStart( &( pxWorker->xTCPTimer ), xTCPTimerCheck( xWillSleep ) );
+				pxWorker->xProcessedTCPMessage = pdFALSE;
+			}
+
+			xNextSleep = pxWorker->xTCPTimer.ulRemainingTime;
+
+			if( xNextSleep > ipconfigMAX_IP_TASK_SLEEP_TIME )
+			{
+				xNextSleep = ipconfigMAX_IP_TASK_SLEEP_TIME;
+			}
+
+			if( xQueueReceive( pxWorker->xEventQueue, ipPOINTER_CAST( void *, &xReceivedEvent ), xNextSleep ) != pdFALSE )
+			{
+				switch( xReceivedEvent.eEventType )
+				{
+					case eNetworkRxEvent:
+						/* A TCP packet that was passed on by the IP-task. */
+						pxNetworkBuffer = ipPOINTER_CAST( NetworkBufferDescriptor_t *, xReceivedEvent.pvData );
+
+						#if( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 0 )
+						/* The IP-task only checked the length fields, the checksum
+						is verified here, so that the work is spread as well. */
+						if( usGenerateProtocolChecksum( pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength, pdFALSE ) != ipCORRECT_CRC )
+						{
+							vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						}
+						else
+						#endif /* ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM */
+						if( xProcessReceivedTCPPacket( pxNetworkBuffer ) != pdPASS )
+						{
+							vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						}
+						else
+						{
+							/* The buffer is now owned by the TCP socket. */
+						}
+
+						pxWorker->xProcessedTCPMessage = pdTRUE;
+						break;
+
+					case eTCPTimerEvent:
+						pxWorker->xTCPTimer.bExpired = pdTRUE_UNSIGNED;
+						break;
+
+					case eSocketCloseEvent:
+						( void ) vSocketClose( ipPOINTER_CAST( FreeRTOS_Socket_t *, xReceivedEvent.pvData ) );
+						break;
+
+					default:
+						/* Other events are handled by the IP-task. */
+						break;
+				}
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvTCPWorkerForPacket( const NetworkBufferDescriptor_t * const pxNetworkBuffer )
+	{
+	const TCPPacket_t *pxTCPPacket = ipPOINTER_CAST( const TCPPacket_t *, pxNetworkBuffer->pucEthernetBuffer );
+	UBaseType_t uxWorker = 0U;
+
+		/* IP options have been removed by prvProcessIPPacket().  TCPPacket_t
+		includes space for TCP options, so its size can not be used here: a bare
+		ACK is shorter, and must still go to the worker that owns the socket.  A
+		packet that is too short for a TCP header is dropped by
+		xProcessReceivedTCPPacket() without looking at any socket. */
+		if( pxNetworkBuffer->xDataLength >= ( size_t ) ( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) )
+		{
+			uxWorker = uxTCPWorkerForConnection( FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usDestinationPort ),
+												 FreeRTOS_ntohl( pxTCPPacket->xIPHeader.ulSourceIPAddress ),
+												 FreeRTOS_ntohs( pxTCPPacket->xTCPHeader.usSourcePort ) );
+		}
+
+		return uxWorker;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvTCPWorkerReceive( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+	{
+	UBaseType_t uxWorker = prvTCPWorkerForPacket( pxNetworkBuffer );
+	IPStackEvent_t xEvent;
+	BaseType_t xReturn;
+
+		xEvent.eEventType = eNetworkRxEvent;
+		xEvent.pvData = ( void * ) pxNetworkBuffer;
+
+		/* The IP-task may not block on a worker, drop the packet when its queue
+		is full.  The peer will send it again. */
+		xReturn = xQueueSendToBack( xTCPWorkers[ uxWorker ].xEventQueue, &xEvent, ( TickType_t ) 0 );
+
+		if( xReturn != pdPASS )
+		{
+			iptraceETHERNET_RX_EVENT_LOST();
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPWorkersWakeUp( void )
+	{
+	IPStackEvent_t xEvent;
+	UBaseType_t uxIndex;
+
+		xEvent.eEventType = eTCPTimerEvent;
+		xEvent.pvData = NULL;
+
+		for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigIP_TCP_WORKER_TASKS; uxIndex++ )
+		{
+			/* As for the IP-task, there is no need to send the event to a worker
+			that is awake handling other events. */
+			xTCPWorkers[ uxIndex ].xTCPTimer.bExpired = pdTRUE_UNSIGNED;
+
+			if( uxQueueMessagesWaiting( xTCPWorkers[ uxIndex ].xEventQueue ) == 0U )
+			{
+				( void ) xQueueSendToBack( xTCPWorkers[ uxIndex ].xEventQueue, &xEvent, ( TickType_t ) 0 );
+			}
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xTCPWorkerCurrent( void )
+	{
+	TaskHandle_t xCurrentTask = xTaskGetCurrentTaskHandle();
+	BaseType_t xIndex;
+	BaseType_t xReturn = -1;
+
+		for( xIndex = 0; xIndex < ( BaseType_t ) ipconfigIP_TCP_WORKER_TASKS; xIndex++ )
+		{
+			if( ( xTCPWorkers[ xIndex ].xTaskHandle != NULL ) && ( xTCPWorkers[ xIndex ].xTaskHandle == xCurrentTask ) )
+			{
+				xReturn = xIndex;
+				break;
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	UBaseType_t uxTCPWorkerForConnection( uint16_t usLocalPort, uint32_t ulRemoteIP, uint16_t usRemotePort )
+	{
+	uint32_t ulHash;
+
+		/* Mix the bits, so that many connections from a single peer will
+		still be spread over the workers. */
+		ulHash = ulRemoteIP ^ ( ( ( uint32_t ) usRemotePort << 16 ) | ( uint32_t ) usLocalPort );
+		ulHash ^= ulHash >> 16;
+		ulHash *= 0x45D9F3BUL;
+		ulHash ^= ulHash >> 16;
+
+		return ( UBaseType_t ) ( ulHash % ( uint32_t ) ipconfigIP_TCP_WORKER_TASKS );
+	}
+	/*-----------------------------------------------------------*/
+
+	BaseType_t xTCPWorkerOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t xReleaseAfterSend )
+	{
+	NetworkBufferDescriptor_t *pxBuffer = pxNetworkBuffer;
+	IPStackEvent_t xSendEvent;
+	BaseType_t xReturn = pdFAIL;
+
+		if( xReleaseAfterSend == pdFALSE )
+		{
+			/* The caller keeps its buffer, the IP-task will send a copy. */
+			pxBuffer = pxDuplicateNetworkBufferWithDescriptor( pxNetworkBuffer, pxNetworkBuffer->xDataLength );
+		}
+
+		if( pxBuffer != NULL )
+		{
+			xSendEvent.eEventType = eNetworkTxEvent;
+			xSendEvent.pvData = ( void * ) pxBuffer;
+
+			/* Only the IP-task talks to the network interface.  A worker does
+			not block on it: when the queue is full the packet is dropped, and
+			TCP will send it again. */
+			xReturn = xSendEventStructToIPTask( &xSendEvent, ( TickType_t ) 0 );
+
+			if( xReturn != pdPASS )
+			{
+				vReleaseNetworkBufferAndDescriptor( pxBuffer );
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPWorkerLock( void )
+	{
+		( void ) xSemaphoreTakeRecursive( xTCPWorkerMutex, portMAX_DELAY );
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPWorkerUnlock( void )
+	{
+		( void ) xSemaphoreGiveRecursive( xTCPWorkerMutex );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 static void prvIPTimerStart( IPTimer_t *pxTimer, TickType_t xTime )
 {
 	vTaskSetTimeOutState( &pxTimer->xTimeOut );
@@ -1039,13 +1430,33 @@ BaseType_t xReturn = pdFALSE;
 			/* Prepare the sockets interface. */
 			vNetworkSocketsInit();
 
-			/* Create the task that processes Ethernet and stack events. */
-			xReturn = xTaskCreate( prvIPTask,
-								   "IP-task",
-								   ( uint16_t )ipconfigIP_TASK_STACK_SIZE_WORDS,
-								   NULL,
-								   ( UBaseType_t )ipconfigIP_TASK_PRIORITY,
-								   &( xIPTaskHandle ) );
+			#if( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+			{
+				/* The lists of the ARP cache must be initialised before use. */
+				FreeRTOS_ClearARP();
+			}
+			#endif /* ipconfigARP_CACHE_HASH_BUCKETS */
+
+			#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+			{
+				xReturn = prvTCPWorkersInit();
+			}
+			#else
+			{
+				xReturn = pdPASS;
+			}
+			#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+			if( xReturn == pdPASS )
+			{
+				/* Create the task that processes Ethernet and stack events. */
+				xReturn = xTaskCreate( prvIPTask,
+									   "IP-task",
+									   ( uint16_t )ipconfigIP_TASK_STACK_SIZE_WORDS,
+									   NULL,
+									   ( UBaseType_t )ipconfigIP_TASK_PRIORITY,
+									   &( xIPTaskHandle ) );
+			}
 		}
 		else
 		{
@@ -1223,6 +1634,7 @@ BaseType_t xSendEventStructToIPTask( const IPStackEvent_t *pxEvent, TickType_t u
 {
 BaseType_t xReturn, xSendMessage;
 TickType_t uxUseTimeout = uxTimeout;
+QueueHandle_t xEventQueue = xNetworkEventQueue;
 
 	if( ( xIPIsNetworkTaskReady() == pdFALSE ) && ( pxEvent->eEventType != eNetworkDownEvent ) )
 	{
@@ -1234,7 +1646,7 @@ TickType_t uxUseTimeout = uxTimeout;
 	{
 		xSendMessage = pdTRUE;
 
-		#if( ipconfigUSE_TCP == 1 )
+		#if( ipIP_TASK_HANDLES_TCP )
 		{
 			if( pxEvent->eEventType == eTCPTimerEvent )
 			{
@@ -1251,7 +1663,32 @@ TickType_t uxUseTimeout = uxTimeout;
 				}
 			}
 		}
-		#endif /* ipconfigUSE_TCP */
+		#endif /* ipIP_TASK_HANDLES_TCP */
+
+		#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		{
+			if( pxEvent->eEventType == eTCPTimerEvent )
+			{
+				/* The TCP sockets are checked by the worker tasks. */
+				prvTCPWorkersWakeUp();
+				xSendMessage = pdFALSE;
+			}
+			else if( pxEvent->eEventType == eSocketCloseEvent )
+			{
+			const FreeRTOS_Socket_t *pxSocket = ipPOINTER_CAST( const FreeRTOS_Socket_t *, pxEvent->pvData );
+
+				if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+				{
+					/* A TCP socket is closed by the worker task that owns it. */
+					xEventQueue = xTCPWorkers[ pxSocket->u.xTCP.ucWorker ].xEventQueue;
+				}
+			}
+			else
+			{
+				/* All other events are handled by the IP-task. */
+			}
+		}
+		#endif /* ipconfigIP_TCP_WORKER_TASKS */
 
 		if( xSendMessage != pdFALSE )
 		{
@@ -1262,7 +1699,7 @@ TickType_t uxUseTimeout = uxTimeout;
 				uxUseTimeout = ( TickType_t ) 0;
 			}
 
-			xReturn = xQueueSendToBack( xNetworkEventQueue, pxEvent, uxUseTimeout );
+			xReturn = xQueueSendToBack( xEventQueue, pxEvent, uxUseTimeout );
 
 			if( xReturn == pdFAIL )
 			{
@@ -1413,7 +1850,7 @@ void vIPNetworkUpCalls( void )
 	#endif /* ipconfigDNS_USE_CALLBACKS != 0 */
 
 	/* Set remaining time to 0 so it will become active immediately. */
-	prvIPTimerReload( &xARPTimer, pdMS_TO_TICKS( ipARP_TIMER_PERIOD_MS ) );
+	prvIPTimerReload( &xARPTimer, pdMS_TO_TICKS( ipARP_TIMER_PERIOD_MS ) / ( TickType_t ) ipARP_AGE_PASSES );
 }
 /*-----------------------------------------------------------*/
 
@@ -1603,6 +2040,18 @@ eFrameProcessingResult_t eReturn = eProcessBuffer;
 				/* Check sum in IP-header not correct. */
 				eReturn = eReleaseBuffer;
 			}
+			#if( ipTCP_RX_CHECKSUM_DEFERRED )
+			else if( pxIPHeader->ucProtocol == ( uint8_t ) ipPROTOCOL_TCP )
+			{
+				/* The TCP checksum will be verified later, by a TCP worker
+				task or while the payload is copied to the socket.  Only
+				check the length fields here. */
+				if( xCheckSizeFields( ( uint8_t * )( pxNetworkBuffer->pucEthernetBuffer ), pxNetworkBuffer->xDataLength ) != pdPASS )
+				{
+					eReturn = eReleaseBuffer;
+				}
+			}
+			#endif /* ipTCP_RX_CHECKSUM_DEFERRED */
 			/* Is the upper-layer checksum (TCP/UDP/ICMP) correct? */
 			else if( usGenerateProtocolChecksum( ( uint8_t * )( pxNetworkBuffer->pucEthernetBuffer ), pxNetworkBuffer->xDataLength, pdFALSE ) != ipCORRECT_CRC )
 			{
@@ -1833,6 +2282,16 @@ uint8_t ucProtocol;
 
 #if ipconfigUSE_TCP == 1
 					case ipPROTOCOL_TCP :
+						#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+						{
+							/* Pass the packet on to the worker task that
+							handles the connection. */
+							if( prvTCPWorkerReceive( pxNetworkBuffer ) == pdPASS )
+							{
+								eReturn = eFrameConsumed;
+							}
+						}
+						#else
 						{
 
 							if( xProcessReceivedTCPPacket( pxNetworkBuffer ) == pdPASS )
@@ -1844,6 +2303,7 @@ uint8_t ucProtocol;
 							to be called just before the IP-task blocks. */
 							xProcessedTCPMessage++;
 						}
+						#endif /* ipconfigIP_TCP_WORKER_TASKS */
 						break;
 #endif
 					default	:
@@ -1983,7 +2443,7 @@ uint8_t ucProtocol;
 #endif /* ( ipconfigREPLY_TO_INCOMING_PINGS == 1 ) || ( ipconfigSUPPORT_OUTGOING_PINGS == 1 ) */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 )
+#if( ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) || ipTCP_RX_CHECKSUM_DEFERRED )
 	/* Although the driver will take care of checksum calculations,
 	the IP-task will still check if the length fields are OK. */
 	static BaseType_t xCheckSizeFields( const uint8_t * const pucEthernetBuffer, size_t uxBufferLength )
@@ -2100,7 +2560,7 @@ uint8_t ucProtocol;
 
 		return xResult;
 	}
-#endif /* ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) */
+#endif /* ( ipconfigDRIVER_INCLUDED_RX_IP_CHECKSUM == 1 ) || ipTCP_RX_CHECKSUM_DEFERRED */
 /*-----------------------------------------------------------*/
 
 uint16_t usGenerateProtocolChecksum( const uint8_t * const pucEthernetBuffer, size_t uxBufferLength, BaseType_t xOutgoingPacket )
@@ -2376,6 +2836,251 @@ BaseType_t location = 0;
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * The checksum implementation behind usGenerateChecksumCopy(), and behind
+ * usGenerateChecksum() unless ipCHECKSUM_BACKEND_C32 is selected.  The data at
+ * pucSource is summed, and copied to pucDestination unless that is NULL.  The
+ * result is the same as the one of the C32 implementation for the data at
+ * pucDestination, or at pucSource when there is no destination.
+ *
+ * Memory is read as native words that are added to a 64-bit accumulator.  The
+ * one's complement sum does not depend on the byte order, except that a start
+ * at an odd address swaps the bytes of the result, as in the C32 version.
+ * Carries are only folded back at the end.  A vector unit, when selected,
+ * handles the bulk of the data, the remainder is done by the plain C loop.
+ */
+static uint16_t prvChecksumCopy( uint16_t usSum, uint8_t *pucDestination, const uint8_t *pucSource, size_t uxByteCount )
+{
+const uint8_t *pucFrom = pucSource;
+uint8_t *pucTo = pucDestination;
+size_t uxLength = uxByteCount;
+uint64_t ullSum;
+uint32_t ulWord;
+uint16_t usWord;
+uint8_t ucBytes[ 2 ];
+BaseType_t xOddAddress;
+uintptr_t uxAddress;
+
+	/* Swap the input (little endian platform only). */
+	ullSum = ( uint64_t ) FreeRTOS_ntohs( usSum );
+
+	/* The position of the bytes in the packet is known from the destination,
+	if there is one. */
+	/* coverity[misra_c_2012_rule_11_4_violation] */
+	uxAddress = ( pucTo != NULL ) ? ( ( uintptr_t ) pucTo ) : ( ( uintptr_t ) pucFrom );	/*lint !e923*/
+	xOddAddress = ( ( uxAddress & 1U ) != 0U ) ? pdTRUE : pdFALSE;
+
+	if( ( xOddAddress != pdFALSE ) && ( uxLength >= 1U ) )
+	{
+		/* Pretend that the first byte is the second byte of a word, the
+		remaining words will then be written at even addresses. */
+		ucBytes[ 0 ] = 0U;
+		ucBytes[ 1 ] = pucFrom[ 0 ];
+		( void ) memcpy( &usWord, ucBytes, sizeof( usWord ) );
+		ullSum += usWord;
+		if( pucTo != NULL )
+		{
+			*( pucTo ) = pucFrom[ 0 ];
+			pucTo++;
+		}
+		pucFrom++;
+		uxLength--;
+	}
+
+	#if( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_SSE2 )
+	{
+	uint64_t ullLanes[ 2 ];
+
+		#if defined( __AVX2__ )
+		{
+		const __m256i xZero = _mm256_setzero_si256();
+		__m256i xAcc0 = xZero, xAcc1 = xZero;
+		__m256i xData;
+		__m128i xAcc;
+
+			/* Each 32-bit word is widened to a 64-bit lane, which can not
+			overflow. */
+			while( uxLength >= 32U )
+			{
+				xData = _mm256_loadu_si256( ( const __m256i * ) pucFrom );
+				if( pucTo != NULL )
+				{
+					_mm256_storeu_si256( ( __m256i * ) pucTo, xData );
+					pucTo += 32;
+				}
+				xAcc0 = _mm256_add_epi64( xAcc0, _mm256_unpacklo_epi32( xData, xZero ) );
+				xAcc1 = _mm256_add_epi64( xAcc1, _mm256_unpackhi_epi32( xData, xZero ) );
+				pucFrom += 32;
+				uxLength -= 32U;
+			}
+
+			xAcc0 = _mm256_add_epi64( xAcc0, xAcc1 );
+			xAcc = _mm_add_epi64( _mm256_castsi256_si128( xAcc0 ), _mm256_extracti128_si256( xAcc0, 1 ) );
+			_mm_storeu_si128( ( __m128i * ) ullLanes, xAcc );
+		}
+		#else
+		{
+		const __m128i xZero = _mm_setzero_si128();
+		__m128i xAcc0 = xZero, xAcc1 = xZero;
+		__m128i xData0, xData1;
+
+			/* Each 32-bit word is widened to a 64-bit lane, which can not
+			overflow. */
+			while( uxLength >= 32U )
+			{
+				xData0 = _mm_loadu_si128( ( const __m128i * ) pucFrom );
+				xData1 = _mm_loadu_si128( ( const __m128i * ) &( pucFrom[ 16 ] ) );
+				if( pucTo != NULL )
+				{
+					_mm_storeu_si128( ( __m128i * ) pucTo, xData0 );
+					_mm_storeu_si128( ( __m128i * ) &( pucTo[ 16 ] ), xData1 );
+					pucTo += 32;
+				}
+				xAcc0 = _mm_add_epi64( xAcc0, _mm_unpacklo_epi32( xData0, xZero ) );
+				xAcc1 = _mm_add_epi64( xAcc1, _mm_unpackhi_epi32( xData0, xZero ) );
+				xAcc0 = _mm_add_epi64( xAcc0, _mm_unpacklo_epi32( xData1, xZero ) );
+				xAcc1 = _mm_add_epi64( xAcc1, _mm_unpackhi_epi32( xData1, xZero ) );
+				pucFrom += 32;
+				uxLength -= 32U;
+			}
+
+			_mm_storeu_si128( ( __m128i * ) ullLanes, _mm_add_epi64( xAcc0, xAcc1 ) );
+		}
+		#endif /* __AVX2__ */
+
+		/* The sum of the lanes might carry out of 64 bits. */
+		ullSum += ullLanes[ 0 ];
+		if( ullSum < ullLanes[ 0 ] )
+		{
+			ullSum++;
+		}
+		ullSum += ullLanes[ 1 ];
+		if( ullSum < ullLanes[ 1 ] )
+		{
+			ullSum++;
+		}
+	}
+	#elif( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_NEON )
+	{
+	uint64x2_t xAcc0 = vdupq_n_u64( 0U ), xAcc1 = vdupq_n_u64( 0U );
+	uint8x16_t xData0, xData1;
+	uint64_t ullLane;
+
+		/* Pairs of 32-bit words are added to 64-bit lanes, which can not
+		overflow. */
+		while( uxLength >= 32U )
+		{
+			xData0 = vld1q_u8( pucFrom );
+			xData1 = vld1q_u8( &( pucFrom[ 16 ] ) );
+			if( pucTo != NULL )
+			{
+				vst1q_u8( pucTo, xData0 );
+				vst1q_u8( &( pucTo[ 16 ] ), xData1 );
+				pucTo += 32;
+			}
+			xAcc0 = vpadalq_u32( xAcc0, vreinterpretq_u32_u8( xData0 ) );
+			xAcc1 = vpadalq_u32( xAcc1, vreinterpretq_u32_u8( xData1 ) );
+			pucFrom += 32;
+			uxLength -= 32U;
+		}
+
+		xAcc0 = vaddq_u64( xAcc0, xAcc1 );
+		ullLane = vgetq_lane_u64( xAcc0, 0 );
+		ullSum += ullLane;
+		if( ullSum < ullLane )
+		{
+			ullSum++;
+		}
+		ullLane = vgetq_lane_u64( xAcc0, 1 );
+		ullSum += ullLane;
+		if( ullSum < ullLane )
+		{
+			ullSum++;
+		}
+	}
+	#endif /* ipconfigCHECKSUM_BACKEND */
+
+	/* Fold the accumulator to 32 bits, so that the loop below can not
+	overflow it. */
+	ullSum = ( ullSum & 0xFFFFFFFFU ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xFFFFFFFFU ) + ( ullSum >> 32 );
+
+	/* 16 bytes at a time, the words are accessed with memcpy() because the
+	addresses are only known to be even. */
+	while( uxLength >= 16U )
+	{
+	uint32_t ulWords[ 4 ];
+
+		( void ) memcpy( ulWords, pucFrom, sizeof( ulWords ) );
+		if( pucTo != NULL )
+		{
+			( void ) memcpy( pucTo, ulWords, sizeof( ulWords ) );
+			pucTo += 16;
+		}
+		ullSum += ( uint64_t ) ulWords[ 0 ] + ulWords[ 1 ] + ulWords[ 2 ] + ulWords[ 3 ];
+		pucFrom += 16;
+		uxLength -= 16U;
+	}
+
+	while( uxLength >= 4U )
+	{
+		( void ) memcpy( &ulWord, pucFrom, sizeof( ulWord ) );
+		if( pucTo != NULL )
+		{
+			( void ) memcpy( pucTo, &ulWord, sizeof( ulWord ) );
+			pucTo += 4;
+		}
+		ullSum += ulWord;
+		pucFrom += 4;
+		uxLength -= 4U;
+	}
+
+	if( uxLength >= 2U )
+	{
+		( void ) memcpy( &usWord, pucFrom, sizeof( usWord ) );
+		if( pucTo != NULL )
+		{
+			( void ) memcpy( pucTo, &usWord, sizeof( usWord ) );
+			pucTo += 2;
+		}
+		ullSum += usWord;
+		pucFrom += 2;
+		uxLength -= 2U;
+	}
+
+	if( uxLength != 0U )
+	{
+		/* One more byte, the first byte of a word. */
+		ucBytes[ 0 ] = pucFrom[ 0 ];
+		ucBytes[ 1 ] = 0U;
+		( void ) memcpy( &usWord, ucBytes, sizeof( usWord ) );
+		if( pucTo != NULL )
+		{
+			*( pucTo ) = pucFrom[ 0 ];
+		}
+		ullSum += usWord;
+	}
+
+	/* Now add all carries. */
+	ullSum = ( ullSum & 0xFFFFFFFFU ) + ( ullSum >> 32 );
+	ullSum = ( ullSum & 0xFFFFFFFFU ) + ( ullSum >> 32 );
+	ulWord = ( uint32_t ) ullSum;
+	ulWord = ( ulWord & 0xFFFFU ) + ( ulWord >> 16 );
+	ulWord = ( ulWord & 0xFFFFU ) + ( ulWord >> 16 );
+
+	if( xOddAddress != pdFALSE )
+	{
+		/* The checksum was calculated starting at an odd position. */
+		ulWord = ( ( ulWord & 0xFFU ) << 8 ) | ( ( ulWord & 0xFF00U ) >> 8 );
+	}
+
+	/* swap the output (little endian platform only). */
+	return FreeRTOS_htons( ( uint16_t ) ulWord );
+}
+/*-----------------------------------------------------------*/
+
+#if( ipconfigCHECKSUM_BACKEND == ipCHECKSUM_BACKEND_C32 )
+
 /**
  * This method generates a checksum for a given IPv4 header, per RFC791 (page 14).
  * The checksum algorithm is decribed as:
@@ -2535,6 +3240,39 @@ size_t uxDataLengthBytes = uxByteCount;
 	/* swap the output (little endian platform only). */
 	return FreeRTOS_htons( ( (uint16_t) xSum.u32 ) );
 }
+
+#else /* ipconfigCHECKSUM_BACKEND */
+
+uint16_t usGenerateChecksum( uint16_t usSum, const uint8_t * pucNextData, size_t uxByteCount )
+{
+	return prvChecksumCopy( usSum, NULL, pucNextData, uxByteCount );
+}
+
+#endif /* ipconfigCHECKSUM_BACKEND */
+/*-----------------------------------------------------------*/
+
+uint16_t usGenerateChecksumCopy( uint16_t usSum, uint8_t *pucDestination, const uint8_t *pucSource, size_t uxByteCount )
+{
+	return prvChecksumCopy( usSum, pucDestination, pucSource, uxByteCount );
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usChecksumCombine( uint16_t usSum, uint16_t usNext, size_t uxOffset )
+{
+uint32_t ulSum = ( uint32_t ) usNext;
+
+	if( ( uxOffset & 1U ) != 0U )
+	{
+		/* The next data starts at an odd position, its bytes are summed in
+		the other half of the words. */
+		ulSum = ( ( ulSum & 0xFFU ) << 8 ) | ( ( ulSum & 0xFF00U ) >> 8 );
+	}
+
+	ulSum += ( uint32_t ) usSum;
+	ulSum = ( ulSum & 0xFFFFU ) + ( ulSum >> 16 );
+
+	return ( uint16_t ) ulSum;
+}
 /*-----------------------------------------------------------*/
 
 /* This function is used in other files, has external linkage e.g. in
@@ -2836,6 +3574,11 @@ const char *pcName;
 }
 /*-----------------------------------------------------------*/
 
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+	#include "iot_freertos_tcp_test_access_ip_define.h"
+#endif
+
 /* Provide access to private members for verification. */
 #ifdef FREERTOS_TCP_ENABLE_VERIFICATION
 	#include "aws_freertos_ip_verification_access_ip_define.h"
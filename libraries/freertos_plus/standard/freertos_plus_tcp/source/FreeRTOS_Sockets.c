@@ -57,6 +57,12 @@ port number. */
 xBoundUDPSocketsList or xBoundTCPSocketsList */
 #define socketSOCKET_IS_BOUND( pxSocket )	  ( listLIST_ITEM_CONTAINER( & ( pxSocket )->xBoundSocketListItem ) != NULL )
 
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+	/* Internal bit in the event group of a socket set, it is set when a socket
+	has been added to the ready list of the set. */
+	#define socketSELECT_READY_BIT	( ( EventBits_t ) 0x0040U )
+#endif /* ipconfigSELECT_USES_READY_LIST */
+
 /* If FreeRTOS_sendto() is called on a socket that is not bound to a port
 number then, depending on the FreeRTOSIPConfig.h settings, it might be that a
 port number is automatically generated for the socket.  Automatically generated
@@ -82,6 +88,39 @@ range 1024-65535" excluding those already in use (inbound or outbound). */
 	#define ipTCP_TIMER_PERIOD_MS	( 1000U )
 #endif
 
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigSOCKET_HASH_BUCKETS > 0 ) )
+	/* Fold the 4-tuple of a TCP connection, with the local IP-address left out,
+	into the 32-bit value that selects its bucket in xTCPConnHashTable. */
+	#define socketTCP_CONNECTION_KEY( uxLocalPort, ulRemoteIP, uxRemotePort ) \
+		( ( ( uint32_t ) ( ulRemoteIP ) ) ^ ( ( ( uint32_t ) ( uxRemotePort ) ) << 16 ) ^ ( ( uint32_t ) ( uxLocalPort ) ) )
+#endif
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
+	/* Every task that handles TCP sockets has its own set of timer lists. */
+	#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		#define socketTCP_TIMER_LIST_COUNT			ipconfigIP_TCP_WORKER_TASKS
+		#define socketTCP_TIMER_INDEX( pxSocket )	( ( UBaseType_t ) ( pxSocket )->u.xTCP.ucWorker )
+	#else
+		#define socketTCP_TIMER_LIST_COUNT			1
+		#define socketTCP_TIMER_INDEX( pxSocket )	( 0U )
+	#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+	/* The TCP sockets that need attention, sorted on their deadline.  As in the
+	kernel, deadlines that lie beyond an overflow of the tick count are stored
+	in a second list, and the lists are swapped when the tick count overflows.
+	Only the task that handles the sockets accesses these two lists.  The
+	attention list is filled by vTCPTimerRequest(), which may be called by any
+	task, so it is protected by a critical section. */
+	typedef struct xTCP_TIMER_LISTS
+	{
+		List_t xLists[ 2 ];
+		List_t *pxCurrentList;
+		List_t *pxOverflowList;
+		List_t xAttentionList;
+		TickType_t xLastTime;
+	} TCPTimerLists_t;
+#endif /* ipconfigTCP_TIMER_QUEUE */
+
 /* Some helper macro's for defining the 20/80 % limits of uxLittleSpace / uxEnoughSpace. */
 #define sock20_PERCENT						20U
 #define sock80_PERCENT						80U
@@ -103,6 +142,14 @@ static uint16_t prvGetPrivatePortNumber( BaseType_t xProtocol );
  */
 static const ListItem_t * pxListFindListItemWithValue( const List_t *pxList, TickType_t xWantedItemValue );
 
+#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+	/*
+	 * Map a port number, or the 4-tuple of a TCP connection folded into 32 bits,
+	 * onto the index of a hash bucket.
+	 */
+	static UBaseType_t prvSocketHashIndex( uint32_t ulValue );
+#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 /*
  * Return pdTRUE only if pxSocket is valid and bound, as far as can be
  * determined.
@@ -151,6 +198,14 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	static BaseType_t prvTCPConnectStart( FreeRTOS_Socket_t * pxSocket, struct freertos_sockaddr const * pxAddress );
 #endif /* ipconfigUSE_TCP */
 
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
+	/*
+	 * Insert a socket in the timer lists, at 'usTimeout' ticks from 'xNow'.
+	 * When it was already waiting, the earliest of the two deadlines is kept.
+	 */
+	static void prvTCPTimerSchedule( TCPTimerLists_t *pxLists, FreeRTOS_Socket_t *pxSocket, TickType_t xNow );
+#endif /* ipconfigTCP_TIMER_QUEUE */
+
 #if( ipconfigUSE_TCP == 1 )
 	/*
 	 * Check if it makes any sense to wait for a connect event.
@@ -164,7 +219,17 @@ static BaseType_t prvDetermineSocketSize( BaseType_t xDomain, BaseType_t xType,
 	/* Executed by the IP-task, it will check all sockets belonging to a set */
 	static void prvFindSelectedSocket( SocketSelect_t *pxSocketSet );
 
+	/* Executed by the IP-task, returns the select events of a single socket. */
+	static EventBits_t prvSocketSelectBits( FreeRTOS_Socket_t *pxSocket );
+
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+
+	/* Add a member of a socket set to the ready list of that set. */
+	static void prvSocketSetInsertReady( FreeRTOS_Socket_t *pxSocket );
+
+#endif /* ipconfigSELECT_USES_READY_LIST */
 /*-----------------------------------------------------------*/
 
 /* The list that contains mappings between sockets and port numbers.  Accesses
@@ -175,6 +240,35 @@ static List_t xBoundUDPSocketsList;
 	List_t xBoundTCPSocketsList;
 #endif /* ipconfigUSE_TCP == 1 */
 
+#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+	/* Each bound socket is also stored in one of these buckets, selected by its
+	local port.  The item value is the port in network-byte-order, the same value
+	as stored in xBoundSocketListItem.  Sockets are appended to a bucket, so a
+	listening socket comes before the child sockets that it created.  The same
+	protection as for the bound socket lists applies. */
+	static List_t xUDPPortHashTable[ ipconfigSOCKET_HASH_BUCKETS ];
+
+	#if ipconfigUSE_TCP == 1
+		static List_t xTCPPortHashTable[ ipconfigSOCKET_HASH_BUCKETS ];
+
+		/* TCP sockets whose peer is known are also stored in a bucket selected
+		by the local port, the remote IP-address and the remote port.  Only the
+		IP-task accesses this table. */
+		static List_t xTCPConnHashTable[ ipconfigSOCKET_HASH_BUCKETS ];
+	#endif /* ipconfigUSE_TCP == 1 */
+#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
+	static TCPTimerLists_t xTCPTimerLists[ socketTCP_TIMER_LIST_COUNT ];
+#endif /* ipconfigTCP_TIMER_QUEUE */
+
+#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
+	/* Sockets whose wake-up has been postponed until the IP-task has handled
+	its current batch of events.  Only the IP-task accesses this array. */
+	static FreeRTOS_Socket_t *pxDeferredWakeUps[ ipconfigIP_TASK_EVENT_BATCH ];
+	static UBaseType_t uxDeferredWakeUpCount = 0U;
+#endif
+
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvValidSocket( const FreeRTOS_Socket_t *pxSocket, BaseType_t xProtocol, BaseType_t xIsBound )
@@ -213,6 +307,39 @@ void vNetworkSocketsInit( void )
 		vListInitialise( &xBoundTCPSocketsList );
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
+
+	#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = 0U; uxIndex < ( UBaseType_t ) socketTCP_TIMER_LIST_COUNT; uxIndex++ )
+		{
+			vListInitialise( &( xTCPTimerLists[ uxIndex ].xLists[ 0 ] ) );
+			vListInitialise( &( xTCPTimerLists[ uxIndex ].xLists[ 1 ] ) );
+			vListInitialise( &( xTCPTimerLists[ uxIndex ].xAttentionList ) );
+			xTCPTimerLists[ uxIndex ].pxCurrentList = &( xTCPTimerLists[ uxIndex ].xLists[ 0 ] );
+			xTCPTimerLists[ uxIndex ].pxOverflowList = &( xTCPTimerLists[ uxIndex ].xLists[ 1 ] );
+			xTCPTimerLists[ uxIndex ].xLastTime = xTaskGetTickCount();
+		}
+	}
+	#endif /* ipconfigTCP_TIMER_QUEUE */
+
+	#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = 0U; uxIndex < ( UBaseType_t ) ipconfigSOCKET_HASH_BUCKETS; uxIndex++ )
+		{
+			vListInitialise( &( xUDPPortHashTable[ uxIndex ] ) );
+			#if( ipconfigUSE_TCP == 1 )
+			{
+				vListInitialise( &( xTCPPortHashTable[ uxIndex ] ) );
+				vListInitialise( &( xTCPConnHashTable[ uxIndex ] ) );
+			}
+			#endif  /* ipconfigUSE_TCP == 1 */
+		}
+	}
+	#endif /* ipconfigSOCKET_HASH_BUCKETS */
 }
 /*-----------------------------------------------------------*/
 
@@ -344,6 +471,28 @@ Socket_t xReturn;
 				vListInitialiseItem( &( pxSocket->xBoundSocketListItem ) );
 				listSET_LIST_ITEM_OWNER( &( pxSocket->xBoundSocketListItem ), ipPOINTER_CAST( void *, pxSocket ) );
 
+				#if( ipconfigSELECT_USES_READY_LIST != 0 )
+				{
+					vListInitialiseItem( &( pxSocket->xSelectMemberItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->xSelectMemberItem ), ipPOINTER_CAST( void *, pxSocket ) );
+					vListInitialiseItem( &( pxSocket->xSelectReadyItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->xSelectReadyItem ), ipPOINTER_CAST( void *, pxSocket ) );
+				}
+				#endif /* ipconfigSELECT_USES_READY_LIST */
+
+				#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+				{
+					vListInitialiseItem( &( pxSocket->xPortHashListItem ) );
+					listSET_LIST_ITEM_OWNER( &( pxSocket->xPortHashListItem ), ipPOINTER_CAST( void *, pxSocket ) );
+					#if( ipconfigUSE_TCP == 1 )
+					{
+						vListInitialiseItem( &( pxSocket->xConnHashListItem ) );
+						listSET_LIST_ITEM_OWNER( &( pxSocket->xConnHashListItem ), ipPOINTER_CAST( void *, pxSocket ) );
+					}
+					#endif /* ipconfigUSE_TCP == 1 */
+				}
+				#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 				pxSocket->xReceiveBlockTime = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
 				pxSocket->xSendBlockTime	= ipconfigSOCK_DEFAULT_SEND_BLOCK_TIME;
 				pxSocket->ucSocketOptions   = ( uint8_t ) FREERTOS_SO_UDPCKSUM_OUT;
@@ -353,6 +502,15 @@ Socket_t xReturn;
 				{
 					if( xProtocol == FREERTOS_IPPROTO_TCP )
 					{
+						#if( ipconfigTCP_TIMER_QUEUE != 0 )
+						{
+							vListInitialiseItem( &( pxSocket->u.xTCP.xTimerListItem ) );
+							listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xTimerListItem ), ipPOINTER_CAST( void *, pxSocket ) );
+							vListInitialiseItem( &( pxSocket->u.xTCP.xAttentionListItem ) );
+							listSET_LIST_ITEM_OWNER( &( pxSocket->u.xTCP.xAttentionListItem ), ipPOINTER_CAST( void *, pxSocket ) );
+						}
+						#endif /* ipconfigTCP_TIMER_QUEUE */
+
 						/* StreamSize is expressed in number of bytes */
 						/* Round up buffer sizes to nearest multiple of MSS */
 						pxSocket->u.xTCP.usCurMSS     = ( uint16_t ) ipconfigTCP_MSS;
@@ -408,6 +566,13 @@ Socket_t xReturn;
 			}
 			else
 			{
+				#if( ipconfigSELECT_USES_READY_LIST != 0 )
+				{
+					vListInitialise( &( pxSocketSet->xMemberList ) );
+					vListInitialise( &( pxSocketSet->xReadyList ) );
+				}
+				#endif /* ipconfigSELECT_USES_READY_LIST */
+
 				/* Lint wants at least a comment, in case the macro is empty. */
 				iptraceMEM_STATS_CREATE( tcpSOCKET_SET, pxSocketSet, sizeof( *pxSocketSet ) + sizeof( StaticEventGroup_t ) );
 			}
@@ -427,6 +592,30 @@ Socket_t xReturn;
 
 		iptraceMEM_STATS_DELETE( pxSocketSet );
 
+		#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		{
+		FreeRTOS_Socket_t *pxSocket;
+
+			/* Detach the remaining members from the set. */
+			taskENTER_CRITICAL();
+			{
+				while( listLIST_IS_EMPTY( &( pxSocketSet->xMemberList ) ) == pdFALSE )
+				{
+					pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_OWNER_OF_HEAD_ENTRY( &( pxSocketSet->xMemberList ) ) );
+					( void ) uxListRemove( &( pxSocket->xSelectMemberItem ) );
+
+					if( listLIST_ITEM_CONTAINER( &( pxSocket->xSelectReadyItem ) ) != NULL )
+					{
+						( void ) uxListRemove( &( pxSocket->xSelectReadyItem ) );
+					}
+
+					pxSocket->pxSocketSet = NULL;
+				}
+			}
+			taskEXIT_CRITICAL();
+		}
+		#endif /* ipconfigSELECT_USES_READY_LIST */
+
 		vEventGroupDelete( pxSocketSet->xSelectGroup );
 		vPortFree( pxSocketSet );
 	}
@@ -447,13 +636,27 @@ Socket_t xReturn;
 
 		/* Make sure we're not adding bits which are reserved for internal use,
 		such as eSELECT_CALL_IP */
-		pxSocket->xSelectBits |= xBitsToSet & ( ( EventBits_t ) eSELECT_ALL );
+		#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		{
+			pxSocket->xSelectBits |= xBitsToSet & ( ( ( EventBits_t ) eSELECT_ALL ) | ( ( EventBits_t ) eSELECT_EDGE ) );
+		}
+		#else
+		{
+			pxSocket->xSelectBits |= xBitsToSet & ( ( EventBits_t ) eSELECT_ALL );
+		}
+		#endif /* ipconfigSELECT_USES_READY_LIST */
 
 		if( ( pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_ALL ) ) != ( EventBits_t ) 0U )
 		{
 			/* Adding a socket to a socket set. */
 			pxSocket->pxSocketSet = ( SocketSelect_t * ) xSocketSet;
 
+			#if( ipconfigSELECT_USES_READY_LIST != 0 )
+			{
+				vSocketSetMember( pxSocket, pxSocketSet );
+			}
+			#endif /* ipconfigSELECT_USES_READY_LIST */
+
 			/* Now have the IP-task call vSocketSelect() to see if the set contains
 			any sockets which are 'ready' and set the proper bits. */
 			prvFindSelectedSocket( pxSocketSet );
@@ -473,7 +676,16 @@ Socket_t xReturn;
 		configASSERT( pxSocket != NULL );
 		configASSERT( xSocketSet != NULL );
 
-		pxSocket->xSelectBits &= ~( xBitsToClear & ( ( EventBits_t ) eSELECT_ALL ) );
+		#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		{
+			pxSocket->xSelectBits &= ~( xBitsToClear & ( ( ( EventBits_t ) eSELECT_ALL ) | ( ( EventBits_t ) eSELECT_EDGE ) ) );
+		}
+		#else
+		{
+			pxSocket->xSelectBits &= ~( xBitsToClear & ( ( EventBits_t ) eSELECT_ALL ) );
+		}
+		#endif /* ipconfigSELECT_USES_READY_LIST */
+
 		if( ( pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_ALL ) ) != ( EventBits_t ) 0U )
 		{
 			pxSocket->pxSocketSet = ( SocketSelect_t *)xSocketSet;
@@ -481,6 +693,12 @@ Socket_t xReturn;
 		else
 		{
 			/* disconnect it from the socket set */
+			#if( ipconfigSELECT_USES_READY_LIST != 0 )
+			{
+				vSocketSetMember( pxSocket, NULL );
+			}
+			#endif /* ipconfigSELECT_USES_READY_LIST */
+
 			pxSocket->pxSocketSet = NULL;
 		}
 	}
@@ -1071,6 +1289,9 @@ struct freertos_sockaddr * pxAddress = pxBindAddress;
 	if( pxAddress != NULL )
 	#endif
 	{
+		/* The TCP worker tasks also look up and bind sockets. */
+		ipTCP_SOCKETS_LOCK();
+
 		/* Add a do-while loop to facilitate use of 'break' statements. */
 		do
 		{
@@ -1091,7 +1312,7 @@ struct freertos_sockaddr * pxAddress = pxBindAddress;
 			/* Check to ensure the port is not already in use.  If the bind is
 			called internally, a port MAY be used by more than one socket. */
 			if( ( ( xInternal == pdFALSE ) || ( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP ) ) &&
-				( pxListFindListItemWithValue( pxSocketList, ( TickType_t ) pxAddress->sin_port ) != NULL ) )
+				( pxListFindListItemWithValue( pxSocketListForPort( ( BaseType_t ) pxSocket->ucProtocol, ( TickType_t ) pxAddress->sin_port ), ( TickType_t ) pxAddress->sin_port ) != NULL ) )
 			{
 				FreeRTOS_debug_printf( ( "vSocketBind: %sP port %d in use\n",
 					( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP ) ? "TC" : "UD",
@@ -1122,6 +1343,15 @@ struct freertos_sockaddr * pxAddress = pxBindAddress;
 					/* Add the socket to 'xBoundUDPSocketsList' or 'xBoundTCPSocketsList' */
 					vListInsertEnd( pxSocketList, &( pxSocket->xBoundSocketListItem ) );
 
+					#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+					{
+						/* And to the bucket of its port number. */
+						listSET_LIST_ITEM_VALUE( &( pxSocket->xPortHashListItem ), ( TickType_t ) pxAddress->sin_port );
+						vListInsertEnd( pxSocketListForPort( ( BaseType_t ) pxSocket->ucProtocol, ( TickType_t ) pxAddress->sin_port ),
+										&( pxSocket->xPortHashListItem ) );
+					}
+					#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 					#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 					{
 						( void ) xTaskResumeAll();
@@ -1130,6 +1360,8 @@ struct freertos_sockaddr * pxAddress = pxBindAddress;
 				}
 			}
 		} while( ipFALSE_BOOL );
+
+		ipTCP_SOCKETS_UNLOCK();
 	}
 	#if( ipconfigALLOW_SOCKET_SEND_WITHOUT_BIND == 0 )
 	else
@@ -1209,6 +1441,28 @@ void *vSocketClose( FreeRTOS_Socket_t *pxSocket )
 {
 NetworkBufferDescriptor_t *pxNetworkBuffer;
 
+	#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
+	{
+	UBaseType_t uxIndex;
+
+		/* The socket will be deleted, it can not be woken up anymore. */
+		for( uxIndex = 0U; uxIndex < uxDeferredWakeUpCount; uxIndex++ )
+		{
+			if( pxDeferredWakeUps[ uxIndex ] == pxSocket )
+			{
+				pxDeferredWakeUps[ uxIndex ] = NULL;
+			}
+		}
+	}
+	#endif /* ipconfigIP_TASK_EVENT_BATCH */
+
+	#if( ipconfigSELECT_USES_READY_LIST != 0 )
+	{
+		/* Leave the socket set. */
+		vSocketSetMember( pxSocket, NULL );
+	}
+	#endif /* ipconfigSELECT_USES_READY_LIST */
+
 	#if( ipconfigUSE_TCP == 1 )
 	{
 		/* For TCP: clean up a little more. */
@@ -1238,9 +1492,30 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 				vPortFreeLarge( pxSocket->u.xTCP.txStream );
 			}
 
+			#if( ipconfigTCP_TIMER_QUEUE != 0 )
+			{
+				/* The timer lists belong to the task that is closing the socket. */
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xTimerListItem ) ) != NULL )
+				{
+					( void ) uxListRemove( &( pxSocket->u.xTCP.xTimerListItem ) );
+				}
+
+				taskENTER_CRITICAL();
+				{
+					if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xAttentionListItem ) ) != NULL )
+					{
+						( void ) uxListRemove( &( pxSocket->u.xTCP.xAttentionListItem ) );
+					}
+				}
+				taskEXIT_CRITICAL();
+			}
+			#endif /* ipconfigTCP_TIMER_QUEUE */
+
 			/* In case this is a child socket, make sure the child-count of the
 			parent socket is decreased. */
+			ipTCP_SOCKETS_LOCK();
 			prvTCPSetSocketCount( pxSocket );
+			ipTCP_SOCKETS_UNLOCK();
 		}
 	}
 	#endif  /* ipconfigUSE_TCP == 1 */
@@ -1249,6 +1524,8 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 	it. */
 	if( socketSOCKET_IS_BOUND( pxSocket ) )
 	{
+		ipTCP_SOCKETS_LOCK();
+
 		/* If the network driver can iterate through 'xBoundUDPSocketsList',
 		by calling xPortHasUDPSocket(), then the IP-task must temporarily
 		suspend the scheduler to keep the list in a consistent state. */
@@ -1260,11 +1537,28 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 
 		( void ) uxListRemove( &( pxSocket->xBoundSocketListItem ) );
 
+		#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+		{
+			( void ) uxListRemove( &( pxSocket->xPortHashListItem ) );
+
+			#if( ipconfigUSE_TCP == 1 )
+			{
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->xConnHashListItem ) ) != NULL )
+				{
+					( void ) uxListRemove( &( pxSocket->xConnHashListItem ) );
+				}
+			}
+			#endif /* ipconfigUSE_TCP == 1 */
+		}
+		#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 		#if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
 		{
 			( void ) xTaskResumeAll();
 		}
 		#endif /* ipconfigETHERNET_DRIVER_FILTERS_PACKETS */
+
+		ipTCP_SOCKETS_UNLOCK();
 	}
 
 	/* Now the socket is not bound the list of waiting packets can be
@@ -1317,7 +1611,8 @@ NetworkBufferDescriptor_t *pxNetworkBuffer;
 	static void prvTCPSetSocketCount( FreeRTOS_Socket_t const * pxSocketToDelete )
 	{
 	const ListItem_t *pxIterator;
-	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundTCPSocketsList ) );
+	const List_t *pxList = pxSocketListForPort( ( BaseType_t ) FREERTOS_IPPROTO_TCP, ( TickType_t ) FreeRTOS_htons( pxSocketToDelete->usLocalPort ) );
+	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxList ) );
 	FreeRTOS_Socket_t *pxOtherSocket;
 	uint16_t usLocalPort = pxSocketToDelete->usLocalPort;
 
@@ -1692,6 +1987,7 @@ FreeRTOS_Socket_t *pxSocket;
 						( FreeRTOS_outstanding( pxSocket ) != 0 ) )
 					{
 						pxSocket->u.xTCP.usTimeout = 1U; /* to set/clear bSendFullSize */
+						ipTCP_TIMER_REQUEST( pxSocket );
 						( void ) xSendEventToIPTask( eTCPTimerEvent );
 					}
 				}
@@ -1715,11 +2011,31 @@ FreeRTOS_Socket_t *pxSocket;
 
 					pxSocket->u.xTCP.bits.bWinChange = pdTRUE;
 					pxSocket->u.xTCP.usTimeout = 1U; /* to set/clear bRxStopped */
+					ipTCP_TIMER_REQUEST( pxSocket );
 					( void ) xSendEventToIPTask( eTCPTimerEvent );
 				}
 				xReturn = 0;
 				break;
 
+			#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+				case FREERTOS_SO_TCP_CONGESTION:	/* Select the congestion control algorithm */
+					{
+						if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+
+						/* Best done before connecting, a connection keeps its
+						congestion window when the algorithm changes. */
+						if( xTCPWindowSetCongestion( &( pxSocket->u.xTCP.xTCPWindow ), *( ipPOINTER_CAST( const BaseType_t *, pvOptionValue ) ) ) == pdFAIL )
+						{
+							break;	/* will return -pdFREERTOS_ERRNO_EINVAL */
+						}
+					}
+					xReturn = 0;
+					break;
+			#endif /* ipconfigTCP_CONGESTION_CONTROL */
+
 		#endif  /* ipconfigUSE_TCP == 1 */
 
 		default :
@@ -1741,21 +2057,6 @@ const uint16_t usEphemeralPortCount =
 uint16_t usIterations = usEphemeralPortCount;
 uint32_t ulRandomSeed = 0;
 uint16_t usResult = 0;
-const List_t *pxList;
-
-#if ipconfigUSE_TCP == 1
-	if( xProtocol == ( BaseType_t ) FREERTOS_IPPROTO_TCP )
-	{
-		pxList = &xBoundTCPSocketsList;
-	}
-	else
-#endif
-	{
-		pxList = &xBoundUDPSocketsList;
-	}
-
-	/* Avoid compiler warnings if ipconfigUSE_TCP is not defined. */
-	( void ) xProtocol;
 
 	/* Find the next available port using the random seed as a starting
 	point. */
@@ -1775,7 +2076,7 @@ const List_t *pxList;
 		/* Check if there's already an open socket with the same protocol
 		and port. */
 		if( NULL == pxListFindListItemWithValue(
-			pxList,
+			pxSocketListForPort( xProtocol, ( TickType_t )FreeRTOS_htons( usResult ) ),
 			( TickType_t )FreeRTOS_htons( usResult ) ) )
 		{
 			usResult = FreeRTOS_htons( usResult );
@@ -1821,6 +2122,66 @@ const ListItem_t * pxResult = NULL;
 
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+
+	static UBaseType_t prvSocketHashIndex( uint32_t ulValue )
+	{
+	uint32_t ulHash = ulValue ^ ( ulValue >> 16 );
+
+		/* Multiplicative (Fibonacci) hashing: the middle bits of the product
+		depend on all bits of the folded value. */
+		ulHash *= 0x9E3779B1UL;
+
+		return ( UBaseType_t ) ( ulHash >> 16 ) & ( ( UBaseType_t ) ipconfigSOCKET_HASH_BUCKETS - 1U );
+	}
+
+#endif /* ipconfigSOCKET_HASH_BUCKETS */
+/*-----------------------------------------------------------*/
+
+List_t *pxSocketListForPort( BaseType_t xProtocol, TickType_t xPort )
+{
+List_t *pxList;
+
+	#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+	{
+	UBaseType_t uxIndex = prvSocketHashIndex( ( uint32_t ) xPort );
+
+		#if( ipconfigUSE_TCP == 1 )
+		if( xProtocol == ( BaseType_t ) FREERTOS_IPPROTO_TCP )
+		{
+			pxList = &( xTCPPortHashTable[ uxIndex ] );
+		}
+		else
+		#endif /* ipconfigUSE_TCP == 1 */
+		{
+			pxList = &( xUDPPortHashTable[ uxIndex ] );
+		}
+	}
+	#else
+	{
+		/* Without hashing, all sockets of a protocol share a single list. */
+		( void ) xPort;
+
+		#if( ipconfigUSE_TCP == 1 )
+		if( xProtocol == ( BaseType_t ) FREERTOS_IPPROTO_TCP )
+		{
+			pxList = &xBoundTCPSocketsList;
+		}
+		else
+		#endif /* ipconfigUSE_TCP == 1 */
+		{
+			pxList = &xBoundUDPSocketsList;
+		}
+	}
+	#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
+	/* Avoid compiler warnings if ipconfigUSE_TCP is not defined. */
+	( void ) xProtocol;
+
+	return pxList;
+}
+/*-----------------------------------------------------------*/
+
 FreeRTOS_Socket_t *pxUDPSocketLookup( UBaseType_t uxLocalPort )
 {
 const ListItem_t *pxListItem;
@@ -1829,8 +2190,8 @@ FreeRTOS_Socket_t *pxSocket = NULL;
 	/* Looking up a socket is quite simple, find a match with the local port.
 
 	See if there is a list item associated with the port number on the
-	list of bound sockets. */
-	pxListItem = pxListFindListItemWithValue( &xBoundUDPSocketsList, ( TickType_t ) uxLocalPort );
+	list of bound sockets, or in the hash bucket of the port. */
+	pxListItem = pxListFindListItemWithValue( pxSocketListForPort( ( BaseType_t ) FREERTOS_IPPROTO_UDP, ( TickType_t ) uxLocalPort ), ( TickType_t ) uxLocalPort );
 
 	if( pxListItem != NULL )
 	{
@@ -2118,8 +2479,16 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			EventBits_t xSelectBits = ( pxSocket->xEventBits >> SOCKET_EVENT_BIT_COUNT ) & ( ( EventBits_t ) eSELECT_ALL );
 			if( xSelectBits != 0UL )
 			{
-				pxSocket->xSocketBits |= xSelectBits;
-				( void ) xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, xSelectBits );
+				#if( ipconfigSELECT_USES_READY_LIST != 0 )
+				{
+					vSocketSetReady( pxSocket, xSelectBits );
+				}
+				#else
+				{
+					pxSocket->xSocketBits |= xSelectBits;
+					( void ) xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, xSelectBits );
+				}
+				#endif /* ipconfigSELECT_USES_READY_LIST */
 			}
 		}
 
@@ -2134,7 +2503,61 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 	pxSocket->xEventBits = 0UL;
 }
+/*-----------------------------------------------------------*/
+
+#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
+
+	void vSocketWakeUpLater( FreeRTOS_Socket_t *pxSocket )
+	{
+	UBaseType_t uxIndex;
+	BaseType_t xFound = pdFALSE;
+
+		for( uxIndex = 0U; uxIndex < uxDeferredWakeUpCount; uxIndex++ )
+		{
+			if( pxDeferredWakeUps[ uxIndex ] == pxSocket )
+			{
+				xFound = pdTRUE;
+				break;
+			}
+		}
+
+		if( xFound == pdFALSE )
+		{
+			if( uxDeferredWakeUpCount < ( UBaseType_t ) ipconfigIP_TASK_EVENT_BATCH )
+			{
+				pxDeferredWakeUps[ uxDeferredWakeUpCount ] = pxSocket;
+				uxDeferredWakeUpCount++;
+			}
+			else
+			{
+				/* No more space, wake up the owner immediately. */
+				vSocketWakeUpUser( pxSocket );
+			}
+		}
+	}
+
+#endif /* ipconfigIP_TASK_EVENT_BATCH */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
+
+	void vSocketWakeUpDeferred( void )
+	{
+	UBaseType_t uxIndex;
+
+		for( uxIndex = 0U; uxIndex < uxDeferredWakeUpCount; uxIndex++ )
+		{
+			/* An entry is NULL when its socket was closed in the mean time. */
+			if( pxDeferredWakeUps[ uxIndex ] != NULL )
+			{
+				vSocketWakeUpUser( pxDeferredWakeUps[ uxIndex ] );
+			}
+		}
+
+		uxDeferredWakeUpCount = 0U;
+	}
 
+#endif /* ipconfigIP_TASK_EVENT_BATCH */
 /*-----------------------------------------------------------*/
 
 #if( ipconfigETHERNET_DRIVER_FILTERS_PACKETS == 1 )
@@ -2253,11 +2676,21 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 				/* IP address of remote machine. */
 				pxSocket->u.xTCP.ulRemoteIP = FreeRTOS_ntohl( pxAddress->sin_addr );
 
+				#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+				{
+					/* The worker that will receive the replies of the peer. */
+					pxSocket->u.xTCP.ucWorker = ( uint8_t ) uxTCPWorkerForConnection( pxSocket->usLocalPort,
+																					   pxSocket->u.xTCP.ulRemoteIP,
+																					   pxSocket->u.xTCP.usRemotePort );
+				}
+				#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 				/* (client) internal state: socket wants to send a connect. */
 				vTCPStateChange( pxSocket, eCONNECT_SYN );
 
 				/* To start an active connect. */
 				pxSocket->u.xTCP.usTimeout = 1U;
+				ipTCP_TIMER_REQUEST( pxSocket );
 
 				if( xSendEventToIPTask( eTCPTimerEvent ) != pdPASS )
 				{
@@ -2379,8 +2812,14 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 			/* Loop will stop with breaks. */
 			for( ; ; )
 			{
-				/* Is there a new client? */
-				vTaskSuspendAll();
+				/* Is there a new client?  A TCP worker task may have been
+				preempted while it was updating these fields, so it is held off
+				by the lock rather than by suspending the scheduler. */
+				#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+					vTCPWorkerLock();
+				#else
+					vTaskSuspendAll();
+				#endif
 				{
 					if( pxSocket->u.xTCP.bits.bReuseSocket == pdFALSE_UNSIGNED )
 					{
@@ -2405,7 +2844,11 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 						}
 					}
 				}
-				( void ) xTaskResumeAll();
+				#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+					vTCPWorkerUnlock();
+				#else
+					( void ) xTaskResumeAll();
+				#endif
 
 				if( pxClientSocket != NULL )
 				{
@@ -2647,6 +3090,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 							pxSocket->u.xTCP.bits.bLowWater = pdFALSE;
 							pxSocket->u.xTCP.bits.bWinChange = pdTRUE;
 							pxSocket->u.xTCP.usTimeout = 1U; /* because bLowWater is cleared. */
+							ipTCP_TIMER_REQUEST( pxSocket );
 							( void ) xSendEventToIPTask( eTCPTimerEvent );
 						}
 					}
@@ -2841,6 +3285,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 					/* Send a message to the IP-task so it can work on this
 					socket.  Data is sent, let the IP-task work on it. */
 					pxSocket->u.xTCP.usTimeout = 1U;
+					ipTCP_TIMER_REQUEST( pxSocket );
 
 					if( xIsCallingFromIPTask() == pdFALSE )
 					{
@@ -3030,6 +3475,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 			/* Let the IP-task perform the shutdown of the connection. */
 			pxSocket->u.xTCP.usTimeout = 1U;
+			ipTCP_TIMER_REQUEST( pxSocket );
 			( void ) xSendEventToIPTask( eTCPTimerEvent );
 			xResult = 0;
 		}
@@ -3041,53 +3487,365 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP == 1 )
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
 
 	/*
-	 * A TCP timer has expired, now check all TCP sockets for:
-	 * - Active connect
-	 * - Send a delayed ACK
-	 * - Send new data
-	 * - Send a keep-alive packet
-	 * - Check for timeout (in non-connected states only)
+	 * Ask the task that handles 'pxSocket' to look at its 'usTimeout' during
+	 * the next call to xTCPTimerCheck().  May be called from any task.
 	 */
-	TickType_t xTCPTimerCheck( BaseType_t xWillSleep )
+	void vTCPTimerRequest( FreeRTOS_Socket_t *pxSocket )
 	{
-	FreeRTOS_Socket_t *pxSocket;
-	TickType_t xShortest = pdMS_TO_TICKS( ( TickType_t ) ipTCP_TIMER_PERIOD_MS );
-	TickType_t xNow = xTaskGetTickCount();
-	static TickType_t xLastTime = 0U;
-	TickType_t xDelta = xNow - xLastTime;
-	const ListItem_t* pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundTCPSocketsList ) );
-	const ListItem_t *pxIterator = ( const ListItem_t * ) listGET_HEAD_ENTRY( &xBoundTCPSocketsList );
-
-		xLastTime = xNow;
-
-		if( xDelta == 0U )
+		taskENTER_CRITICAL();
 		{
-			xDelta = 1U;
+			if( listLIST_ITEM_CONTAINER( &( pxSocket->u.xTCP.xAttentionListItem ) ) == NULL )
+			{
+				vListInsertEnd( &( xTCPTimerLists[ socketTCP_TIMER_INDEX( pxSocket ) ].xAttentionList ), &( pxSocket->u.xTCP.xAttentionListItem ) );
+			}
 		}
+		taskEXIT_CRITICAL();
+	}
 
-		while( pxIterator != pxEnd )
-		{
-			pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
-			pxIterator = ( ListItem_t * ) listGET_NEXT( pxIterator );
+#endif /* ipconfigTCP_TIMER_QUEUE */
+/*-----------------------------------------------------------*/
 
-			/* Sockets with 'tmout == 0' do not need any regular attention. */
-			if( pxSocket->u.xTCP.usTimeout == 0U )
-			{
-				continue;
-			}
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
 
-			if( xDelta < ( TickType_t ) pxSocket->u.xTCP.usTimeout )
+	static void prvTCPTimerSchedule( TCPTimerLists_t *pxLists, FreeRTOS_Socket_t *pxSocket, TickType_t xNow )
+	{
+	ListItem_t *pxItem = &( pxSocket->u.xTCP.xTimerListItem );
+	TickType_t xTimeout = ( TickType_t ) pxSocket->u.xTCP.usTimeout;
+	TickType_t xDeadline;
+
+		/* Sockets with 'tmout == 0' do not need any regular attention.  When
+		such a socket is still in a list, it will be ignored when it expires. */
+		if( xTimeout != 0U )
+		{
+			if( listLIST_ITEM_CONTAINER( pxItem ) != NULL )
+			{
+				if( xTimeout >= ( listGET_LIST_ITEM_VALUE( pxItem ) - xNow ) )
+				{
+					/* The socket will already be checked in time. */
+					xTimeout = 0U;
+				}
+				else
+				{
+					( void ) uxListRemove( pxItem );
+				}
+			}
+
+			if( xTimeout != 0U )
+			{
+				xDeadline = xNow + xTimeout;
+				listSET_LIST_ITEM_VALUE( pxItem, xDeadline );
+
+				if( xDeadline < xNow )
+				{
+					/* The deadline lies beyond an overflow of the tick count. */
+					vListInsert( pxLists->pxOverflowList, pxItem );
+				}
+				else
+				{
+					vListInsert( pxLists->pxCurrentList, pxItem );
+				}
+			}
+		}
+	}
+
+#endif /* ipconfigTCP_TIMER_QUEUE */
+/*-----------------------------------------------------------*/
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE != 0 ) )
+
+	/*
+	 * A TCP timer has expired, now check the TCP sockets whose deadline has
+	 * passed, and the sockets that asked for attention through
+	 * vTCPTimerRequest().  Here 'usTimeout' is not decremented: it is the
+	 * timeout that was asked for, the deadline is kept in the list item.
+	 */
+	TickType_t xTCPTimerCheck( BaseType_t xWillSleep )
+	{
+	FreeRTOS_Socket_t *pxSocket;
+	TickType_t xShortest = pdMS_TO_TICKS( ( TickType_t ) ipTCP_TIMER_PERIOD_MS );
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xDelta;
+	TCPTimerLists_t *pxLists;
+	List_t *pxExpiredList = NULL;
+	List_t *pxList;
+	UBaseType_t uxCount;
+	BaseType_t xRc;
+	#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		const BaseType_t xWorker = xTCPWorkerCurrent();
+
+		configASSERT( xWorker >= 0 );
+		pxLists = &( xTCPTimerLists[ xWorker ] );
+	#else
+		pxLists = &( xTCPTimerLists[ 0 ] );
+	#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+		if( xNow < pxLists->xLastTime )
+		{
+			/* The tick count has overflowed: all deadlines in the current list
+			have passed, and the overflow list becomes the current list. */
+			pxExpiredList = pxLists->pxCurrentList;
+			pxLists->pxCurrentList = pxLists->pxOverflowList;
+			pxLists->pxOverflowList = pxExpiredList;
+		}
+		pxLists->xLastTime = xNow;
+
+		for( ;; )
+		{
+			if( ( pxExpiredList != NULL ) && ( listLIST_IS_EMPTY( pxExpiredList ) == pdFALSE ) )
+			{
+				pxList = pxExpiredList;
+			}
+			else if( ( listLIST_IS_EMPTY( pxLists->pxCurrentList ) == pdFALSE ) &&
+					 ( listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxLists->pxCurrentList ) <= xNow ) )
+			{
+				pxList = pxLists->pxCurrentList;
+			}
+			else
+			{
+				break;
+			}
+
+			pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_OWNER_OF_HEAD_ENTRY( pxList ) );
+			( void ) uxListRemove( &( pxSocket->u.xTCP.xTimerListItem ) );
+
+			#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+			{
+				if( socketTCP_TIMER_INDEX( pxSocket ) != ( UBaseType_t ) xWorker )
+				{
+					/* The socket has been handed over to another worker. */
+					vTCPTimerRequest( pxSocket );
+					continue;
+				}
+			}
+			#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+			/* When the timeout has been cancelled in the mean time, the socket
+			is not checked, but pending events are still delivered. */
+			if( pxSocket->u.xTCP.usTimeout != 0U )
+			{
+				pxSocket->u.xTCP.usTimeout = 0U;
+				xRc = xTCPSocketCheck( pxSocket );
+
+				/* Within this function, the socket might want to send a delayed
+				ack or send out data or whatever it needs to do. */
+				if( xRc < 0 )
+				{
+					/* Continue because the socket was deleted. */
+					continue;
+				}
+			}
+
+			/* In xEventBits the driver may indicate that the socket has
+			important events for the user.  These are only done just before the
+			IP-task goes to sleep. */
+			if( pxSocket->xEventBits != 0U )
+			{
+				if( xWillSleep != pdFALSE )
+				{
+					vSocketWakeUpUser( pxSocket );
+				}
+				else
+				{
+					/* Make sure this socket will be visited again. */
+					vTCPTimerRequest( pxSocket );
+				}
+			}
+
+			prvTCPTimerSchedule( pxLists, pxSocket, xNow );
+		}
+
+		/* Only look at the sockets that were waiting for attention when the
+		loop starts, the sockets that are added while looping will be seen by
+		the next call. */
+		taskENTER_CRITICAL();
+		{
+			uxCount = listCURRENT_LIST_LENGTH( &( pxLists->xAttentionList ) );
+		}
+		taskEXIT_CRITICAL();
+
+		while( uxCount > 0U )
+		{
+			uxCount--;
+
+			taskENTER_CRITICAL();
+			{
+				if( listLIST_IS_EMPTY( &( pxLists->xAttentionList ) ) == pdFALSE )
+				{
+					pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_OWNER_OF_HEAD_ENTRY( &( pxLists->xAttentionList ) ) );
+					( void ) uxListRemove( &( pxSocket->u.xTCP.xAttentionListItem ) );
+				}
+				else
+				{
+					/* A socket has been closed in the mean time. */
+					pxSocket = NULL;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( pxSocket == NULL )
+			{
+				break;
+			}
+
+			#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+			{
+				if( socketTCP_TIMER_INDEX( pxSocket ) != ( UBaseType_t ) xWorker )
+				{
+					vTCPTimerRequest( pxSocket );
+					continue;
+				}
+			}
+			#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+			if( pxSocket->xEventBits != 0U )
+			{
+				if( xWillSleep != pdFALSE )
+				{
+					vSocketWakeUpUser( pxSocket );
+				}
+				else
+				{
+					vTCPTimerRequest( pxSocket );
+					xShortest = ( TickType_t ) 0;
+				}
+			}
+
+			prvTCPTimerSchedule( pxLists, pxSocket, xNow );
+		}
+
+		/* The time until the first deadline. */
+		if( listLIST_IS_EMPTY( pxLists->pxCurrentList ) == pdFALSE )
+		{
+			xDelta = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxLists->pxCurrentList ) - xNow;
+		}
+		else if( listLIST_IS_EMPTY( pxLists->pxOverflowList ) == pdFALSE )
+		{
+			xDelta = listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxLists->pxOverflowList ) - xNow;
+		}
+		else
+		{
+			xDelta = xShortest;
+		}
+
+		if( xShortest > xDelta )
+		{
+			xShortest = xDelta;
+		}
+
+		return xShortest;
+	}
+
+#endif /* ipconfigTCP_TIMER_QUEUE */
+/*-----------------------------------------------------------*/
+
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigTCP_TIMER_QUEUE == 0 ) )
+
+	/*
+	 * A TCP timer has expired, now check all TCP sockets for:
+	 * - Active connect
+	 * - Send a delayed ACK
+	 * - Send new data
+	 * - Send a keep-alive packet
+	 * - Check for timeout (in non-connected states only)
+	 */
+	TickType_t xTCPTimerCheck( BaseType_t xWillSleep )
+	{
+	FreeRTOS_Socket_t *pxSocket;
+	TickType_t xShortest = pdMS_TO_TICKS( ( TickType_t ) ipTCP_TIMER_PERIOD_MS );
+	TickType_t xNow = xTaskGetTickCount();
+	TickType_t xDelta;
+	const ListItem_t* pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundTCPSocketsList ) );
+	const ListItem_t *pxIterator;
+	FreeRTOS_Socket_t *pxDue = NULL;
+	#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		/* Every worker task only checks its own sockets, and keeps its own time. */
+		static TickType_t xLastTimes[ ipconfigIP_TCP_WORKER_TASKS ];
+		const BaseType_t xWorker = xTCPWorkerCurrent();
+		TickType_t *pxLastTime;
+
+		configASSERT( xWorker >= 0 );
+		pxLastTime = &( xLastTimes[ xWorker ] );
+	#else
+		static TickType_t xLastTime = 0U;
+		TickType_t *pxLastTime = &xLastTime;
+	#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+		xDelta = xNow - *pxLastTime;
+		*pxLastTime = xNow;
+
+		if( xDelta == 0U )
+		{
+			xDelta = 1U;
+		}
+
+		/* Other tasks may bind or close sockets while the list is walked, so
+		the lock is only held to collect the sockets that need attention.
+		They are checked after the lock is released: a socket is only closed
+		by the task that checks it. */
+		ipTCP_SOCKETS_LOCK();
+
+		pxIterator = ( const ListItem_t * ) listGET_HEAD_ENTRY( &xBoundTCPSocketsList );
+
+		while( pxIterator != pxEnd )
+		{
+			pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+			pxIterator = ( ListItem_t * ) listGET_NEXT( pxIterator );
+
+			/* Sockets with 'tmout == 0' do not need any regular attention. */
+			if( pxSocket->u.xTCP.usTimeout == 0U )
+			{
+				continue;
+			}
+
+			#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+			{
+				if( pxSocket->u.xTCP.ucWorker != ( uint8_t ) xWorker )
+				{
+					/* This socket is handled by another worker. */
+					continue;
+				}
+			}
+			#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+			if( xDelta < ( TickType_t ) pxSocket->u.xTCP.usTimeout )
 			{
 				pxSocket->u.xTCP.usTimeout = ( uint16_t ) ( ( ( TickType_t ) pxSocket->u.xTCP.usTimeout ) - xDelta );
 			}
 			else
+			{
+				/* Mark the socket as expired. */
+				pxSocket->u.xTCP.usTimeout = 0U;
+			}
+
+			if( ( pxSocket->u.xTCP.usTimeout == 0U ) || ( pxSocket->xEventBits != 0U ) )
+			{
+				pxSocket->u.xTCP.pxNextDue = pxDue;
+				pxDue = pxSocket;
+			}
+			else if( xShortest > ( TickType_t ) pxSocket->u.xTCP.usTimeout )
+			{
+				xShortest = ( TickType_t ) pxSocket->u.xTCP.usTimeout;
+			}
+			else
+			{
+				/* The socket is not due yet. */
+			}
+		}
+
+		ipTCP_SOCKETS_UNLOCK();
+
+		while( pxDue != NULL )
+		{
+			pxSocket = pxDue;
+			pxDue = pxSocket->u.xTCP.pxNextDue;
+
+			if( pxSocket->u.xTCP.usTimeout == 0U )
 			{
 			BaseType_t xRc;
 
-				pxSocket->u.xTCP.usTimeout = 0U;
 				xRc = xTCPSocketCheck( pxSocket );
 
 				/* Within this function, the socket might want to send a delayed
@@ -3130,7 +3888,94 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP == 1 )
+#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigSOCKET_HASH_BUCKETS > 0 ) )
+
+	/*
+	 * TCP: as multiple sockets may be bound to the same local port number
+	 * looking up a socket is a little more complex:
+	 * Both a local port, and a remote port and IP address are being used
+	 * For a socket in listening mode, the remote port and IP address are both 0
+	 */
+	FreeRTOS_Socket_t *pxTCPSocketLookup( uint32_t ulLocalIP, UBaseType_t uxLocalPort, uint32_t ulRemoteIP, UBaseType_t uxRemotePort )
+	{
+	const ListItem_t *pxIterator;
+	const ListItem_t *pxEnd;
+	const List_t *pxList;
+	FreeRTOS_Socket_t *pxResult = NULL;
+	TickType_t xPort = ( TickType_t ) FreeRTOS_htons( ( uint16_t ) uxLocalPort );
+
+		/* Parameter not yet supported. */
+		( void ) ulLocalIP;
+
+		/* A connected socket is found in the bucket of its 4-tuple. */
+		pxList = &( xTCPConnHashTable[ prvSocketHashIndex( socketTCP_CONNECTION_KEY( uxLocalPort, ulRemoteIP, uxRemotePort ) ) ] );
+		pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxList ) );
+
+		for( pxIterator  = listGET_NEXT( pxEnd );
+			 pxIterator != pxEnd;
+			 pxIterator  = listGET_NEXT( pxIterator ) )
+		{
+			FreeRTOS_Socket_t *pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+			if( ( pxSocket->usLocalPort == ( uint16_t ) uxLocalPort ) &&
+				( pxSocket->u.xTCP.ucTCPState != ( uint8_t ) eTCP_LISTEN ) &&
+				( pxSocket->u.xTCP.usRemotePort == ( uint16_t ) uxRemotePort ) &&
+				( pxSocket->u.xTCP.ulRemoteIP == ulRemoteIP ) )
+			{
+				pxResult = pxSocket;
+				break;
+			}
+		}
+
+		if( pxResult == NULL )
+		{
+			/* An exact match was not found, look for a socket listening to
+			uxLocalPort.  It was bound before its child sockets, so it comes
+			first in the bucket of the port. */
+			pxList = pxSocketListForPort( ( BaseType_t ) FREERTOS_IPPROTO_TCP, xPort );
+			pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxList ) );
+
+			for( pxIterator  = listGET_NEXT( pxEnd );
+				 pxIterator != pxEnd;
+				 pxIterator  = listGET_NEXT( pxIterator ) )
+			{
+				FreeRTOS_Socket_t *pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+				if( ( listGET_LIST_ITEM_VALUE( pxIterator ) == xPort ) &&
+					( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eTCP_LISTEN ) )
+				{
+					pxResult = pxSocket;
+					break;
+				}
+			}
+		}
+
+		return pxResult;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPSocketHashConnection( FreeRTOS_Socket_t *pxSocket )
+	{
+	UBaseType_t uxIndex = prvSocketHashIndex( socketTCP_CONNECTION_KEY( pxSocket->usLocalPort, pxSocket->u.xTCP.ulRemoteIP, pxSocket->u.xTCP.usRemotePort ) );
+
+		ipTCP_SOCKETS_LOCK();
+
+		/* The socket may have been filed under an earlier peer. */
+		if( listLIST_ITEM_CONTAINER( &( pxSocket->xConnHashListItem ) ) != NULL )
+		{
+			( void ) uxListRemove( &( pxSocket->xConnHashListItem ) );
+		}
+
+		/* vSocketClose() only removes bound sockets from the table. */
+		if( socketSOCKET_IS_BOUND( pxSocket ) )
+		{
+			vListInsertEnd( &( xTCPConnHashTable[ uxIndex ] ), &( pxSocket->xConnHashListItem ) );
+		}
+
+		ipTCP_SOCKETS_UNLOCK();
+	}
+
+#else
 
 	/*
 	 * TCP: as multiple sockets may be bound to the same local port number
@@ -3388,6 +4233,7 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 
 							/* bLowWater was reached, send the changed window size. */
 							pxSocket->u.xTCP.usTimeout = 1U;
+							ipTCP_TIMER_REQUEST( pxSocket );
 							( void ) xSendEventToIPTask( eTCPTimerEvent );
 						}
 					}
@@ -3597,9 +4443,39 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
-#if( ipconfigUSE_TCP == 1 )
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
 
-	/* For internal use only: return the connection status. */
+	BaseType_t FreeRTOS_GetCongestionInfo( ConstSocket_t xSocket, TCPCongestionInfo_t *pxInfo )
+	{
+	const FreeRTOS_Socket_t *pxSocket = ( const FreeRTOS_Socket_t * ) xSocket;
+	const TCPCongestion_t *pxCongestion;
+	BaseType_t xReturn;
+
+		if( pxSocket->ucProtocol != ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			xReturn = -pdFREERTOS_ERRNO_EINVAL;
+		}
+		else
+		{
+			/* The fields are updated by the IP-task, read them as a snapshot. */
+			pxCongestion = &( pxSocket->u.xTCP.xTCPWindow.xCongestion );
+			pxInfo->xAlgorithm = pxCongestion->xAlgorithm;
+			pxInfo->ulCWnd = pxCongestion->ulCWnd;
+			pxInfo->ulSSThresh = pxCongestion->ulSSThresh;
+			pxInfo->ulFastRecoveries = pxCongestion->ulFastRecoveries;
+			pxInfo->ulTimeouts = pxCongestion->ulTimeouts;
+			xReturn = 0;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP == 1 )
+
+	/* For internal use only: return the connection status. */
 	BaseType_t FreeRTOS_connstatus( ConstSocket_t xSocket )
 	{
 	const FreeRTOS_Socket_t *pxSocket = ( const FreeRTOS_Socket_t * ) xSocket;
@@ -3703,6 +4579,9 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 		{
 		const ListItem_t *pxEndTCP = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundTCPSocketsList ) );
 		const ListItem_t *pxEndUDP = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundUDPSocketsList ) );
+
+			ipTCP_SOCKETS_LOCK();
+
 			FreeRTOS_printf( ( "Prot Port IP-Remote       : Port  R/T Status       Alive  tmout Child\n" ) );
 			for( pxIterator  = listGET_HEAD_ENTRY( &xBoundTCPSocketsList );
 				 pxIterator != pxEndTCP;
@@ -3750,6 +4629,8 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 				count++;
 			}
 
+			ipTCP_SOCKETS_UNLOCK();
+
 			FreeRTOS_printf( ( "FreeRTOS_netstat: %lu sockets %lu < %lu < %ld buffers free\n",
 				( UBaseType_t ) count,
 				( UBaseType_t ) uxMinimum,
@@ -3761,21 +4642,175 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 #endif /* ( ( ipconfigHAS_PRINTF != 0 ) && ( ipconfigUSE_TCP == 1 ) ) */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
+
+	static EventBits_t prvSocketSelectBits( FreeRTOS_Socket_t *pxSocket )
+	{
+	EventBits_t xSocketBits = 0;
+
+	#if( ipconfigUSE_TCP == 1 )
+		if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
+		{
+			/* Check if the socket has already been accepted by the
+			owner.  If not, it is useless to return it from a
+			select(). */
+			BaseType_t bAccepted = pdFALSE;
+
+			if( pxSocket->u.xTCP.bits.bPassQueued == pdFALSE_UNSIGNED )
+			{
+				if( pxSocket->u.xTCP.bits.bPassAccept == pdFALSE_UNSIGNED )
+				{
+					bAccepted = pdTRUE;
+				}
+			}
+
+			/* Is the set owner interested in READ events? */
+			if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != ( EventBits_t ) 0U )
+			{
+				if( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eTCP_LISTEN )
+				{
+					if( ( pxSocket->u.xTCP.pxPeerSocket != NULL ) && ( pxSocket->u.xTCP.pxPeerSocket->u.xTCP.bits.bPassAccept != pdFALSE_UNSIGNED ) )
+					{
+						xSocketBits |= ( EventBits_t ) eSELECT_READ;
+					}
+				}
+				else if( ( pxSocket->u.xTCP.bits.bReuseSocket != pdFALSE_UNSIGNED ) && ( pxSocket->u.xTCP.bits.bPassAccept != pdFALSE_UNSIGNED ) )
+				{
+					/* This socket has the re-use flag. After connecting it turns into
+					aconnected socket. Set the READ event, so that accept() will be called. */
+					xSocketBits |= ( EventBits_t ) eSELECT_READ;
+				}
+				else if( ( bAccepted != 0 ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
+				{
+					xSocketBits |= ( EventBits_t ) eSELECT_READ;
+				}
+				else
+				{
+					/* Nothing. */
+				}
+			}
+			/* Is the set owner interested in EXCEPTION events? */
+			if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_EXCEPT ) != 0U )
+			{
+				if( ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eCLOSE_WAIT ) || ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eCLOSED ) )
+				{
+					xSocketBits |= ( EventBits_t ) eSELECT_EXCEPT;
+				}
+			}
+
+			/* Is the set owner interested in WRITE events? */
+			if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_WRITE ) != 0U )
+			{
+				BaseType_t bMatch = pdFALSE;
+
+				if( bAccepted != 0 )
+				{
+					if( FreeRTOS_tx_space( pxSocket ) > 0 )
+					{
+						bMatch = pdTRUE;
+					}
+				}
+
+				if( bMatch == pdFALSE )
+				{
+					if( ( pxSocket->u.xTCP.bits.bConnPrepared != pdFALSE_UNSIGNED ) &&
+						( pxSocket->u.xTCP.ucTCPState >= ( uint8_t ) eESTABLISHED ) &&
+						( pxSocket->u.xTCP.bits.bConnPassed == pdFALSE_UNSIGNED ) )
+					{
+						pxSocket->u.xTCP.bits.bConnPassed = pdTRUE;
+						bMatch = pdTRUE;
+					}
+				}
+
+				if( bMatch != pdFALSE )
+				{
+					xSocketBits |= ( EventBits_t ) eSELECT_WRITE;
+				}
+			}
+		}
+		else
+	#endif /* ipconfigUSE_TCP == 1 */
+		{
+			/* Select events for UDP are simpler. */
+			if( ( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != 0U ) &&
+				( listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) > 0U ) )
+			{
+				xSocketBits |= ( EventBits_t ) eSELECT_READ;
+			}
+			/* The WRITE and EXCEPT bits are not used for UDP */
+		}	/* if( pxSocket->ucProtocol == FREERTOS_IPPROTO_TCP ) */
+
+		return xSocketBits;
+	}
+
+#endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 
 	void vSocketSelect( SocketSelect_t *pxSocketSet )
 	{
-	BaseType_t xRound;
 	EventBits_t xSocketBits, xBitsToClear;
-	#if ipconfigUSE_TCP == 1
-		BaseType_t xLastRound = 1;
-	#else
-		BaseType_t xLastRound = 0;
-	#endif
+	#if( ipconfigSELECT_USES_READY_LIST == 0 )
+		BaseType_t xRound;
+		#if ipconfigUSE_TCP == 1
+			BaseType_t xLastRound = 1;
+		#else
+			BaseType_t xLastRound = 0;
+		#endif
+	#endif /* ipconfigSELECT_USES_READY_LIST */
 
 		/* These flags will be switched on after checking the socket status. */
 		EventBits_t xGroupBits = 0;
 
+		ipTCP_SOCKETS_LOCK();
+
+		#if( ipconfigSELECT_USES_READY_LIST != 0 )
+		{
+		const ListItem_t *pxIterator;
+		const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &( pxSocketSet->xMemberList ) ) );
+		FreeRTOS_Socket_t *pxSocket;
+
+			/* Only the members of the set are visited.  Other tasks can not add
+			or remove members while the list is walked. */
+			vTaskSuspendAll();
+
+			for( pxIterator = listGET_NEXT( pxEnd );
+				 pxIterator != pxEnd;
+				 pxIterator = listGET_NEXT( pxIterator ) )
+			{
+				pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+				if( socketSOCKET_IS_BOUND( pxSocket ) )
+				{
+					xSocketBits = prvSocketSelectBits( pxSocket );
+				}
+				else
+				{
+					xSocketBits = 0;
+				}
+
+				/* A level-triggered socket is ready as long as it has events,
+				an edge-triggered socket only when new events are found. */
+				if( ( xSocketBits != 0U ) &&
+					( ( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_EDGE ) == 0U ) ||
+					  ( ( xSocketBits & ~( pxSocket->xSocketBits ) ) != 0U ) ) )
+				{
+					prvSocketSetInsertReady( pxSocket );
+				}
+
+				pxSocket->xSocketBits = xSocketBits;
+				xGroupBits |= xSocketBits;
+			}
+
+			( void ) xTaskResumeAll();
+
+			if( listLIST_IS_EMPTY( &( pxSocketSet->xReadyList ) ) == pdFALSE )
+			{
+				xGroupBits |= socketSELECT_READY_BIT;
+			}
+		}
+		#else
 		for( xRound = 0; xRound <= xLastRound; xRound++ )
 		{
 			const ListItem_t *pxIterator;
@@ -3800,99 +4835,7 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 					/* Socket does not belong to this select group. */
 					continue;
 				}
-				xSocketBits = 0;
-
-			#if( ipconfigUSE_TCP == 1 )
-				if( pxSocket->ucProtocol == ( uint8_t ) FREERTOS_IPPROTO_TCP )
-				{
-					/* Check if the socket has already been accepted by the
-					owner.  If not, it is useless to return it from a
-					select(). */
-					BaseType_t bAccepted = pdFALSE;
-
-					if( pxSocket->u.xTCP.bits.bPassQueued == pdFALSE_UNSIGNED )
-					{
-						if( pxSocket->u.xTCP.bits.bPassAccept == pdFALSE_UNSIGNED )
-						{
-							bAccepted = pdTRUE;
-						}
-					}
-
-					/* Is the set owner interested in READ events? */
-					if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != ( EventBits_t ) 0U )
-					{
-						if( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eTCP_LISTEN )
-						{
-							if( ( pxSocket->u.xTCP.pxPeerSocket != NULL ) && ( pxSocket->u.xTCP.pxPeerSocket->u.xTCP.bits.bPassAccept != pdFALSE_UNSIGNED ) )
-							{
-								xSocketBits |= ( EventBits_t ) eSELECT_READ;
-							}
-						}
-						else if( ( pxSocket->u.xTCP.bits.bReuseSocket != pdFALSE_UNSIGNED ) && ( pxSocket->u.xTCP.bits.bPassAccept != pdFALSE_UNSIGNED ) )
-						{
-							/* This socket has the re-use flag. After connecting it turns into
-							aconnected socket. Set the READ event, so that accept() will be called. */
-							xSocketBits |= ( EventBits_t ) eSELECT_READ;
-						}
-						else if( ( bAccepted != 0 ) && ( FreeRTOS_recvcount( pxSocket ) > 0 ) )
-						{
-							xSocketBits |= ( EventBits_t ) eSELECT_READ;
-						}
-						else
-						{
-							/* Nothing. */
-						}
-					}
-					/* Is the set owner interested in EXCEPTION events? */
-					if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_EXCEPT ) != 0U )
-					{
-						if( ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eCLOSE_WAIT ) || ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eCLOSED ) )
-						{
-							xSocketBits |= ( EventBits_t ) eSELECT_EXCEPT;
-						}
-					}
-
-					/* Is the set owner interested in WRITE events? */
-					if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_WRITE ) != 0U )
-					{
-						BaseType_t bMatch = pdFALSE;
-
-						if( bAccepted != 0 )
-						{
-							if( FreeRTOS_tx_space( pxSocket ) > 0 )
-							{
-								bMatch = pdTRUE;
-							}
-						}
-
-						if( bMatch == pdFALSE )
-						{
-							if( ( pxSocket->u.xTCP.bits.bConnPrepared != pdFALSE_UNSIGNED ) &&
-								( pxSocket->u.xTCP.ucTCPState >= ( uint8_t ) eESTABLISHED ) &&
-								( pxSocket->u.xTCP.bits.bConnPassed == pdFALSE_UNSIGNED ) )
-							{
-								pxSocket->u.xTCP.bits.bConnPassed = pdTRUE;
-								bMatch = pdTRUE;
-							}
-						}
-
-						if( bMatch != pdFALSE )
-						{
-							xSocketBits |= ( EventBits_t ) eSELECT_WRITE;
-						}
-					}
-				}
-				else
-			#endif /* ipconfigUSE_TCP == 1 */
-				{
-					/* Select events for UDP are simpler. */
-					if( ( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_READ ) != 0U ) &&
-						( listCURRENT_LIST_LENGTH( &( pxSocket->u.xUDP.xWaitingPacketsList ) ) > 0U ) )
-					{
-						xSocketBits |= ( EventBits_t ) eSELECT_READ;
-					}
-					/* The WRITE and EXCEPT bits are not used for UDP */
-				}	/* if( pxSocket->ucProtocol == FREERTOS_IPPROTO_TCP ) */
+				xSocketBits = prvSocketSelectBits( pxSocket );
 
 				/* Each socket keeps its own event flags, which are looked-up
 				by FreeRTOS_FD_ISSSET() */
@@ -3904,6 +4847,9 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 
 			}	/* for( pxIterator ... ) */
 		}	/* for( xRound = 0; xRound <= xLastRound; xRound++ ) */
+		#endif /* ipconfigSELECT_USES_READY_LIST */
+
+		ipTCP_SOCKETS_UNLOCK();
 
 		xBitsToClear = xEventGroupGetBits( pxSocketSet->xSelectGroup );
 
@@ -3931,6 +4877,170 @@ BaseType_t FreeRTOS_udp_rx_size( Socket_t xSocket )
 #endif /* ipconfigSUPPORT_SELECT_FUNCTION == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+
+	void vSocketSetMember( FreeRTOS_Socket_t *pxSocket, SocketSelect_t *pxSocketSet )
+	{
+	const List_t *pxContainer;
+
+		taskENTER_CRITICAL();
+		{
+			pxContainer = listLIST_ITEM_CONTAINER( &( pxSocket->xSelectMemberItem ) );
+
+			if( ( pxContainer != NULL ) &&
+				( ( pxSocketSet == NULL ) || ( pxContainer != &( pxSocketSet->xMemberList ) ) ) )
+			{
+				/* Leave the current set. */
+				( void ) uxListRemove( &( pxSocket->xSelectMemberItem ) );
+
+				if( listLIST_ITEM_CONTAINER( &( pxSocket->xSelectReadyItem ) ) != NULL )
+				{
+					( void ) uxListRemove( &( pxSocket->xSelectReadyItem ) );
+				}
+
+				pxContainer = NULL;
+			}
+
+			if( ( pxSocketSet != NULL ) && ( pxContainer == NULL ) )
+			{
+				vListInsertEnd( &( pxSocketSet->xMemberList ), &( pxSocket->xSelectMemberItem ) );
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* ipconfigSELECT_USES_READY_LIST */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+
+	static void prvSocketSetInsertReady( FreeRTOS_Socket_t *pxSocket )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ( listLIST_ITEM_CONTAINER( &( pxSocket->xSelectMemberItem ) ) != NULL ) &&
+				( listLIST_ITEM_CONTAINER( &( pxSocket->xSelectReadyItem ) ) == NULL ) )
+			{
+				vListInsertEnd( &( pxSocket->pxSocketSet->xReadyList ), &( pxSocket->xSelectReadyItem ) );
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* ipconfigSELECT_USES_READY_LIST */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+
+	void vSocketSetReady( FreeRTOS_Socket_t *pxSocket, EventBits_t xBits )
+	{
+	SocketSelect_t *pxSocketSet = pxSocket->pxSocketSet;
+
+		if( pxSocketSet != NULL )
+		{
+			pxSocket->xSocketBits |= xBits;
+			prvSocketSetInsertReady( pxSocket );
+			( void ) xEventGroupSetBits( pxSocketSet->xSelectGroup, xBits | socketSELECT_READY_BIT );
+		}
+	}
+
+#endif /* ipconfigSELECT_USES_READY_LIST */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigSELECT_USES_READY_LIST != 0 )
+
+	/* Wait until one or more members of a socket set become ready, and return
+	at most 'xMaxCount' of them in 'pxReady'.  Sockets put themselves on the
+	ready list of their set, so no sockets are scanned while waiting.  Returns
+	the number of sockets found, or -pdFREERTOS_ERRNO_EINTR when the set was
+	signalled. */
+	BaseType_t FreeRTOS_select_ready( SocketSet_t xSocketSet, SocketReady_t *pxReady, BaseType_t xMaxCount, TickType_t xBlockTimeTicks )
+	{
+	TimeOut_t xTimeOut;
+	TickType_t xRemainingTime = xBlockTimeTicks;
+	SocketSelect_t *pxSocketSet = ( SocketSelect_t * ) xSocketSet;
+	FreeRTOS_Socket_t *pxSocket;
+	EventBits_t xEvents;
+	EventBits_t uxResult;
+	BaseType_t xCount = 0;
+
+		configASSERT( xSocketSet != NULL );
+		configASSERT( pxReady != NULL );
+
+		if( pxSocketSet->xLevelReported != pdFALSE )
+		{
+			/* Level-triggered sockets stay ready as long as their events
+			persist.  Have the IP-task look at the members again. */
+			pxSocketSet->xLevelReported = pdFALSE;
+			prvFindSelectedSocket( pxSocketSet );
+		}
+
+		vTaskSetTimeOutState( &xTimeOut );
+
+		for( ;; )
+		{
+			taskENTER_CRITICAL();
+			{
+				while( ( xCount < xMaxCount ) && ( listLIST_IS_EMPTY( &( pxSocketSet->xReadyList ) ) == pdFALSE ) )
+				{
+					pxSocket = ipPOINTER_CAST( FreeRTOS_Socket_t *, listGET_OWNER_OF_HEAD_ENTRY( &( pxSocketSet->xReadyList ) ) );
+					( void ) uxListRemove( &( pxSocket->xSelectReadyItem ) );
+
+					xEvents = pxSocket->xSocketBits & pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_ALL );
+
+					if( xEvents != 0U )
+					{
+						pxReady[ xCount ].xSocket = ( Socket_t ) pxSocket;
+						pxReady[ xCount ].xEvents = xEvents;
+						xCount++;
+
+						if( ( pxSocket->xSelectBits & ( EventBits_t ) eSELECT_EDGE ) == 0U )
+						{
+							pxSocketSet->xLevelReported = pdTRUE;
+						}
+					}
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( xCount > 0 )
+			{
+				break;
+			}
+
+			/* The ready bit is cleared before the ready list is inspected again,
+			so no wake-up can get lost. */
+			uxResult = xEventGroupWaitBits( pxSocketSet->xSelectGroup, socketSELECT_READY_BIT | ( EventBits_t ) eSELECT_INTR, pdFALSE, pdFALSE, xRemainingTime );
+			( void ) xEventGroupClearBits( pxSocketSet->xSelectGroup, socketSELECT_READY_BIT );
+
+			#if( ipconfigSUPPORT_SIGNALS != 0 )
+			{
+				if( ( uxResult & ( ( EventBits_t ) eSELECT_INTR ) ) != 0U )
+				{
+					( void ) xEventGroupClearBits( pxSocketSet->xSelectGroup, ( EventBits_t ) eSELECT_INTR );
+					FreeRTOS_debug_printf( ( "FreeRTOS_select_ready: interrupted\n" ) );
+					xCount = -pdFREERTOS_ERRNO_EINTR;
+					break;
+				}
+			}
+			#else
+			{
+				( void ) uxResult;
+			}
+			#endif /* ipconfigSUPPORT_SIGNALS */
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xRemainingTime ) != pdFALSE )
+			{
+				break;
+			}
+		}
+
+		return xCount;
+	}
+
+#endif /* ipconfigSELECT_USES_READY_LIST */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigSUPPORT_SIGNALS != 0 )
 
 	/* Send a signal to the task which reads from this socket. */
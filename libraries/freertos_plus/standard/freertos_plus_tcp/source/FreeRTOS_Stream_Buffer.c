@@ -198,3 +198,80 @@ size_t uxSize, uxCount, uxFirst, uxNextTail;
 	return uxCount;
 }
 
+#if( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 )
+
+	size_t uxStreamBufferPlaceChecksum( StreamBuffer_t *pxBuffer, const uint8_t *pucData, size_t uxByteCount, uint16_t *pusChecksum )
+	{
+	size_t uxCount, uxFirst;
+	size_t uxHead = pxBuffer->uxHead;
+	uint16_t usChecksum;
+
+		uxCount = FreeRTOS_min_uint32( uxStreamBufferGetSpace( pxBuffer ), uxByteCount );
+
+		/* The data may wrap around to the start of the buffer. */
+		uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxHead, uxCount );
+		usChecksum = usGenerateChecksumCopy( 0U, &( pxBuffer->ucArray[ uxHead ] ), pucData, uxFirst );
+
+		if( uxCount > uxFirst )
+		{
+			usChecksum = usChecksumCombine( usChecksum,
+				usGenerateChecksumCopy( 0U, pxBuffer->ucArray, &( pucData[ uxFirst ] ), uxCount - uxFirst ),
+				uxFirst );
+		}
+
+		*( pusChecksum ) = usChecksum;
+
+		return uxCount;
+	}
+
+#endif /* ipconfigTCP_CHECKSUM_WHILE_COPYING */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CHECKSUM_WHILE_COPYING != 0 )
+
+	size_t uxStreamBufferPeekChecksum( const StreamBuffer_t *pxBuffer, size_t uxOffset, uint8_t *pucData, size_t uxMaxCount, uint16_t *pusChecksum )
+	{
+	size_t uxSize, uxCount, uxFirst, uxNextTail;
+	uint16_t usChecksum = 0U;
+
+		/* How much data is available? */
+		uxSize = uxStreamBufferGetSize( pxBuffer );
+
+		if( uxSize > uxOffset )
+		{
+			uxSize -= uxOffset;
+		}
+		else
+		{
+			uxSize = 0U;
+		}
+
+		uxCount = FreeRTOS_min_uint32( uxSize, uxMaxCount );
+
+		if( uxCount > 0U )
+		{
+			uxNextTail = pxBuffer->uxTail + uxOffset;
+			if( uxNextTail >= pxBuffer->LENGTH )
+			{
+				uxNextTail -= pxBuffer->LENGTH;
+			}
+
+			/* The data may wrap around to the start of the buffer. */
+			uxFirst = FreeRTOS_min_uint32( pxBuffer->LENGTH - uxNextTail, uxCount );
+			usChecksum = usGenerateChecksumCopy( 0U, pucData, &( pxBuffer->ucArray[ uxNextTail ] ), uxFirst );
+
+			if( uxCount > uxFirst )
+			{
+				usChecksum = usChecksumCombine( usChecksum,
+					usGenerateChecksumCopy( 0U, &( pucData[ uxFirst ] ), pxBuffer->ucArray, uxCount - uxFirst ),
+					uxFirst );
+			}
+		}
+
+		*( pusChecksum ) = usChecksum;
+
+		return uxCount;
+	}
+
+#endif /* ipconfigTCP_CHECKSUM_WHILE_COPYING */
+/*-----------------------------------------------------------*/
@@ -158,6 +158,43 @@
 #define xIPHeaderSize( pxNetworkBuffer )	( ipSIZE_OF_IPv4_HEADER )
 #define uxIPHeaderSizeSocket( pxSocket )	( ipSIZE_OF_IPv4_HEADER )
 
+#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+	/* The payload of the last received packet, which was already copied to
+	the head of the socket's RX stream while its checksum was verified. */
+	static struct xTCP_PLACED_DATA
+	{
+		const FreeRTOS_Socket_t *pxSocket;
+		const uint8_t *pucData;
+		uint32_t ulLength;
+	} xRxPlaced;
+#endif /* ipTCP_RX_CHECKSUM_WHILE_COPYING */
+
+#if( ipTCP_TX_CHECKSUM_WHILE_COPYING )
+	/* The checksum of the payload that prvTCPPrepareSend() has copied from
+	the TX stream, to be used by prvTCPReturnPacket(). */
+	static struct xTCP_SUMMED_DATA
+	{
+		const uint8_t *pucEthernetBuffer;
+		uint32_t ulLength;
+		uint16_t usChecksum;
+	} xTxSummed;
+#endif /* ipTCP_TX_CHECKSUM_WHILE_COPYING */
+
+#if( ipconfigTCP_RX_COALESCING != 0 )
+	/* A received packet that is followed, in the same chain of linked
+	messages, by the next in-order segment of the same connection.  Set by
+	vTCPCheckCoalescing(). */
+	static const NetworkBufferDescriptor_t *pxCoalescedBuffer = NULL;
+#endif /* ipconfigTCP_RX_COALESCING */
+
+#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+	/* A TCP worker task passes its packets to the IP-task, which is the only
+	task that calls the network interface. */
+	#define tcpNETWORK_INTERFACE_OUTPUT( pxBuffer, xRelease )	xTCPWorkerOutput( ( pxBuffer ), ( xRelease ) )
+#else
+	#define tcpNETWORK_INTERFACE_OUTPUT( pxBuffer, xRelease )	xNetworkInterfaceOutput( ( pxBuffer ), ( xRelease ) )
+#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
 /*
  * Returns true if the socket must be checked.  Non-active sockets are waiting
  * for user action, either connect() or close().
@@ -272,6 +309,24 @@ static BaseType_t prvCheckRxData( const NetworkBufferDescriptor_t *pxNetworkBuff
 static BaseType_t prvStoreRxData( FreeRTOS_Socket_t *pxSocket, const uint8_t *pucRecvData,
 	NetworkBufferDescriptor_t *pxNetworkBuffer, uint32_t ulReceiveLength );
 
+/*
+ * Called from xProcessReceivedTCPPacket().  Verify the TCP checksum of a
+ * received packet.  In-order data for an established connection is copied to
+ * the socket's RX stream at the same time.
+ */
+#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+	static BaseType_t prvTCPCheckChecksum( const FreeRTOS_Socket_t *pxSocket, const NetworkBufferDescriptor_t *pxNetworkBuffer );
+#endif
+
+/*
+ * Called from xProcessReceivedTCPPacket() for a packet that is followed by
+ * the next segment of the same connection.  Only store its payload, the
+ * acknowledgement will be sent when the last segment of the train is handled.
+ */
+#if( ipconfigTCP_RX_COALESCING != 0 )
+	static BaseType_t prvTCPStoreCoalesced( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer );
+#endif
+
 /*
  * Set the TCP options (if any) for the outgoing packet.
  */
@@ -352,6 +407,33 @@ static BaseType_t prvTCPSocketCopy( FreeRTOS_Socket_t *pxNewSocket, FreeRTOS_Soc
 static NetworkBufferDescriptor_t *prvTCPBufferResize( const FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
 	int32_t lDataLen, UBaseType_t uxOptionsLength );
 
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+	/*
+	 * Called from prvTCPPrepareSend().  Fetch more segments that follow the
+	 * first one, and get a network buffer that is big enough for all of them.
+	 * *plDataLen is updated with the total length.
+	 */
+	static NetworkBufferDescriptor_t *prvTCPGatherSegments( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
+		int32_t lStreamPos, int32_t *plDataLen, UBaseType_t uxOptionsLength );
+
+	/*
+	 * Called from prvTCPSendSegments().  Split a packet that holds more than
+	 * one segment into packets of at most uxSegmentSize bytes of payload.  The
+	 * first part stays in pxNetworkBuffer, the others are stored in
+	 * pxSegments[], their number is returned.  Only the last part keeps the PSH
+	 * and FIN flags.
+	 */
+	static UBaseType_t prvTCPSplitSegments( NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxSegmentSize,
+		NetworkBufferDescriptor_t *pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ] );
+
+	/*
+	 * Called from prvTCPReturnPacket().  Split a packet that holds more than one
+	 * segment into packets of at most uxSegmentSize bytes of payload, and pass
+	 * them to the network interface.
+	 */
+	static void prvTCPSendSegments( NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxSegmentSize, BaseType_t xReleaseAfterSend );
+#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
+
 #if( ipconfigUSE_TCP_WIN != 0 )
 	static uint8_t prvWinScaleFactor( const FreeRTOS_Socket_t *pxSocket );
 #endif
@@ -709,6 +791,25 @@ const TCPWindow_t *pxTCPWindow;
 NetworkBufferDescriptor_t *pxNetworkBuffer = pxDescriptor;
 NetworkBufferDescriptor_t xTempBuffer;
 /* For sending, a pseudo network buffer will be used, as explained above. */
+#if( ipTCP_TX_CHECKSUM_WHILE_COPYING )
+	BaseType_t xPayloadSummed = pdFALSE;
+#endif
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+	size_t uxSegmentSize = 0U;
+#endif
+
+	#if( ipTCP_TX_CHECKSUM_WHILE_COPYING )
+	{
+		/* See if prvTCPPrepareSend() has summed the payload of this packet.
+		The descriptor may still be duplicated here below, the payload stays
+		the same. */
+		if( ( pxNetworkBuffer != NULL ) && ( xTxSummed.pucEthernetBuffer == pxNetworkBuffer->pucEthernetBuffer ) )
+		{
+			xPayloadSummed = pdTRUE;
+		}
+		xTxSummed.pucEthernetBuffer = NULL;
+	}
+	#endif /* ipTCP_TX_CHECKSUM_WHILE_COPYING */
 
 	if( pxNetworkBuffer == NULL )
 	{
@@ -881,7 +982,22 @@ NetworkBufferDescriptor_t xTempBuffer;
 		/* Important: tell NIC driver how many bytes must be sent. */
 		pxNetworkBuffer->xDataLength = ulLen + ipSIZE_OF_ETH_HEADER;
 
+		#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+		{
+			/* A packet that holds more than one segment will be split, the
+			checksums will be calculated for each part. */
+			if( ( pxSocket != NULL ) &&
+				( ( ulLen - ( ipSIZE_OF_IPv4_HEADER + ( ( uint32_t ) ( pxTCPPacket->xTCPHeader.ucTCPOffset & tcpVALID_BITS_IN_TCP_OFFSET_BYTE ) >> 2 ) ) ) > ( uint32_t ) pxSocket->u.xTCP.xTCPWindow.usMSS ) )
+			{
+				uxSegmentSize = ( size_t ) pxSocket->u.xTCP.xTCPWindow.usMSS;
+			}
+		}
+		#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
+
 		#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+		#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+		if( uxSegmentSize == 0U )
+		#endif
 		{
 			/* calculate the IP header checksum, in case the driver won't do that. */
 			pxIPHeader->usHeaderChecksum = 0x00U;
@@ -889,7 +1005,34 @@ NetworkBufferDescriptor_t xTempBuffer;
 			pxIPHeader->usHeaderChecksum = ~FreeRTOS_htons( pxIPHeader->usHeaderChecksum );
 
 			/* calculate the TCP checksum for an outgoing packet. */
-			( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxTCPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+			#if( ipTCP_TX_CHECKSUM_WHILE_COPYING )
+			{
+			size_t uxTCPLength = ( size_t ) ulLen - ipSIZE_OF_IPv4_HEADER;
+			size_t uxHeaderLength = ( size_t ) ( ( pxTCPPacket->xTCPHeader.ucTCPOffset & tcpVALID_BITS_IN_TCP_OFFSET_BYTE ) >> 2 );
+			uint16_t usChecksum;
+
+				if( ( xPayloadSummed != pdFALSE ) && ( ( ( size_t ) xTxSummed.ulLength + uxHeaderLength ) == uxTCPLength ) )
+				{
+					/* Only the pseudo header and the TCP header have to be
+					added to the sum of the payload. */
+					pxTCPPacket->xTCPHeader.usChecksum = 0U;
+					usChecksum = ( uint16_t ) ( uxTCPLength + ( size_t ) ipPROTOCOL_TCP );
+					usChecksum = usGenerateChecksum( usChecksum,
+						ipPOINTER_CAST( const uint8_t *, &( pxIPHeader->ulSourceIPAddress ) ),
+						( 2U * ipSIZE_OF_IPv4_ADDRESS ) + uxHeaderLength );
+					usChecksum = ( uint16_t ) ~usChecksumCombine( usChecksum, xTxSummed.usChecksum, uxHeaderLength );
+					pxTCPPacket->xTCPHeader.usChecksum = FreeRTOS_htons( usChecksum );
+				}
+				else
+				{
+					( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxTCPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+				}
+			}
+			#else
+			{
+				( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxTCPPacket, pxNetworkBuffer->xDataLength, pdTRUE );
+			}
+			#endif /* ipTCP_TX_CHECKSUM_WHILE_COPYING */
 
 			/* A calculated checksum of 0 must be inverted as 0 means the checksum
 			is disabled. */
@@ -930,7 +1073,16 @@ NetworkBufferDescriptor_t xTempBuffer;
 		#endif
 
 		/* Send! */
-		( void ) xNetworkInterfaceOutput( pxNetworkBuffer, xDoRelease );
+		#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+		if( uxSegmentSize != 0U )
+		{
+			prvTCPSendSegments( pxNetworkBuffer, uxSegmentSize, xDoRelease );
+		}
+		else
+		#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
+		{
+			( void ) tcpNETWORK_INTERFACE_OUTPUT( pxNetworkBuffer, xDoRelease );
+		}
 
 		if( xDoRelease == pdFALSE )
 		{
@@ -948,6 +1100,137 @@ NetworkBufferDescriptor_t xTempBuffer;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+
+	static UBaseType_t prvTCPSplitSegments( NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxSegmentSize,
+		NetworkBufferDescriptor_t *pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ] )
+	{
+	NetworkBufferDescriptor_t *pxSegment;
+	TCPPacket_t *pxTCPPacket;
+	size_t uxHeaderLength, uxPayloadLength, uxOffset, uxLength;
+	UBaseType_t uxCount = 0U;
+	uint32_t ulSequenceNumber;
+	uint8_t ucTCPFlags;
+
+		pxTCPPacket = ipPOINTER_CAST( TCPPacket_t *, pxNetworkBuffer->pucEthernetBuffer );
+		ulSequenceNumber = FreeRTOS_ntohl( pxTCPPacket->xTCPHeader.ulSequenceNumber );
+		ucTCPFlags = pxTCPPacket->xTCPHeader.ucTCPFlags;
+
+		/* The length of the Ethernet, IP and TCP headers, the latter
+		including its options. */
+		uxHeaderLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER +
+			( size_t ) ( ( pxTCPPacket->xTCPHeader.ucTCPOffset & tcpVALID_BITS_IN_TCP_OFFSET_BYTE ) >> 2 );
+		uxPayloadLength = pxNetworkBuffer->xDataLength - uxHeaderLength;
+
+		/* The first part stays in the large buffer, the others must be copied
+		to their own buffers before the large buffer is passed on. */
+		for( uxOffset = 0U; ( uxOffset < uxPayloadLength ) && ( uxCount < ( UBaseType_t ) ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ); uxOffset += uxSegmentSize )
+		{
+			uxLength = FreeRTOS_min_uint32( uxSegmentSize, uxPayloadLength - uxOffset );
+
+			if( uxOffset == 0U )
+			{
+				pxSegment = pxNetworkBuffer;
+			}
+			else
+			{
+				pxSegment = pxGetNetworkBufferWithDescriptor( uxHeaderLength + uxLength, 0U );
+
+				if( pxSegment == NULL )
+				{
+					/* The remaining segments will be retransmitted as if they
+					got lost. */
+					FreeRTOS_debug_printf( ( "prvTCPSendSegments: no buffer for %u bytes\n", ( unsigned ) uxLength ) );
+					break;
+				}
+
+				( void ) memcpy( pxSegment->pucEthernetBuffer, pxNetworkBuffer->pucEthernetBuffer, uxHeaderLength );
+				( void ) memcpy( &( pxSegment->pucEthernetBuffer[ uxHeaderLength ] ),
+								 &( pxNetworkBuffer->pucEthernetBuffer[ uxHeaderLength + uxOffset ] ),
+								 uxLength );
+			}
+
+			pxSegment->xDataLength = uxHeaderLength + uxLength;
+
+			pxTCPPacket = ipPOINTER_CAST( TCPPacket_t *, pxSegment->pucEthernetBuffer );
+			pxTCPPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( pxSegment->xDataLength - ipSIZE_OF_ETH_HEADER ) );
+			pxTCPPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber + ( uint32_t ) uxOffset );
+
+			/* Data must be pushed, and the connection closed, only after the
+			last part. */
+			if( ( uxOffset + uxLength ) < uxPayloadLength )
+			{
+				pxTCPPacket->xTCPHeader.ucTCPFlags = ucTCPFlags & ( ( uint8_t ) ~( tcpTCP_FLAG_PSH | tcpTCP_FLAG_FIN ) );
+			}
+			else
+			{
+				pxTCPPacket->xTCPHeader.ucTCPFlags = ucTCPFlags;
+			}
+
+			if( uxOffset != 0U )
+			{
+				pxTCPPacket->xIPHeader.usIdentification = FreeRTOS_htons( usPacketIdentifier );
+				usPacketIdentifier++;
+			}
+
+			#if( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+			{
+				pxTCPPacket->xIPHeader.usHeaderChecksum = 0x00U;
+				pxTCPPacket->xIPHeader.usHeaderChecksum = usGenerateChecksum( 0U, ( uint8_t * ) &( pxTCPPacket->xIPHeader.ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+				pxTCPPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( pxTCPPacket->xIPHeader.usHeaderChecksum );
+
+				( void ) usGenerateProtocolChecksum( ( uint8_t * ) pxTCPPacket, pxSegment->xDataLength, pdTRUE );
+
+				/* A calculated checksum of 0 must be inverted as 0 means the
+				checksum is disabled. */
+				if( pxTCPPacket->xTCPHeader.usChecksum == 0U )
+				{
+					pxTCPPacket->xTCPHeader.usChecksum = 0xffffU;
+				}
+			}
+			#endif
+
+			#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+			{
+				if( pxSegment->xDataLength < ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+				{
+					( void ) memset( &( pxSegment->pucEthernetBuffer[ pxSegment->xDataLength ] ), 0,
+									 ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES - pxSegment->xDataLength );
+					pxSegment->xDataLength = ( size_t ) ipconfigETHERNET_MINIMUM_PACKET_BYTES;
+				}
+			}
+			#endif
+
+			if( uxOffset != 0U )
+			{
+				pxSegments[ uxCount ] = pxSegment;
+				uxCount++;
+			}
+		}
+
+		return uxCount;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvTCPSendSegments( NetworkBufferDescriptor_t *pxNetworkBuffer, size_t uxSegmentSize, BaseType_t xReleaseAfterSend )
+	{
+	NetworkBufferDescriptor_t *pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ];
+	UBaseType_t uxCount, uxIndex;
+
+		uxCount = prvTCPSplitSegments( pxNetworkBuffer, uxSegmentSize, pxSegments );
+
+		/* Now send the parts in the order of their sequence numbers. */
+		( void ) tcpNETWORK_INTERFACE_OUTPUT( pxNetworkBuffer, xReleaseAfterSend );
+
+		for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+		{
+			( void ) tcpNETWORK_INTERFACE_OUTPUT( pxSegments[ uxIndex ], pdTRUE );
+		}
+	}
+
+#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
+/*-----------------------------------------------------------*/
+
 /*
  * The SYN event is very important: the sequence numbers, which have a kind of
  * random starting value, are being synchronised.  The sliding window manager
@@ -1060,6 +1343,15 @@ uint32_t ulInitialSequenceNumber = 0;
 		/* And remember that the connect/SYN data are prepared. */
 		pxSocket->u.xTCP.bits.bConnPrepared = pdTRUE_UNSIGNED;
 
+		#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+		{
+			/* The remote address was set by FreeRTOS_connect() in the user's
+			task.  Now that the IP-task is about to send the SYN, file the socket
+			under its 4-tuple so that the reply will find it. */
+			vTCPSocketHashConnection( pxSocket );
+		}
+		#endif /* ipconfigSOCKET_HASH_BUCKETS */
+
 		/* Now that the Ethernet address is known, the initial packet can be
 		prepared. */
 		( void ) memset( pxSocket->u.xTCP.xPacket.u.ucLastPacket, 0, sizeof( pxSocket->u.xTCP.xPacket.u.ucLastPacket ) );
@@ -1530,6 +1822,9 @@ BaseType_t bAfter  = ipNUMERIC_CAST( BaseType_t, tcpNOW_CONNECTED( ( BaseType_t
 			/* if bPassQueued is true, this socket is an orphan until it gets connected. */
 			if( pxSocket->u.xTCP.bits.bPassQueued != pdFALSE_UNSIGNED )
 			{
+				/* The parent may be handled by another task. */
+				ipTCP_SOCKETS_LOCK();
+
 				/* Now that it is connected, find it's parent. */
 				if( pxSocket->u.xTCP.bits.bReuseSocket != pdFALSE_UNSIGNED )
 				{
@@ -1581,6 +1876,8 @@ BaseType_t bAfter  = ipNUMERIC_CAST( BaseType_t, tcpNOW_CONNECTED( ( BaseType_t
 
 				/* When true, this socket may be returned in a call to accept(). */
 				pxSocket->u.xTCP.bits.bPassAccept = pdTRUE_UNSIGNED;
+
+				ipTCP_SOCKETS_UNLOCK();
 			}
 			else
 			{
@@ -1628,6 +1925,16 @@ BaseType_t bAfter  = ipNUMERIC_CAST( BaseType_t, tcpNOW_CONNECTED( ( BaseType_t
 			timer events. */
 			pxSocket->u.xTCP.usTimeout = 0U;
 		}
+
+		/* The events set above are delivered by xTCPTimerCheck(), make sure it
+		will look at the sockets, also when the packet that caused the change
+		is not handled any further. */
+		ipTCP_TIMER_REQUEST( pxSocket );
+
+		if( ( xParent != NULL ) && ( xParent != pxSocket ) )
+		{
+			ipTCP_TIMER_REQUEST( xParent );
+		}
 	}
 	else
 	{
@@ -1678,7 +1985,9 @@ BaseType_t bAfter  = ipNUMERIC_CAST( BaseType_t, tcpNOW_CONNECTED( ( BaseType_t
 	#endif
 	if( xParent != NULL )
 	{
+		ipTCP_SOCKETS_LOCK();
 		vSocketWakeUpUser( xParent );
+		ipTCP_SOCKETS_UNLOCK();
 	}
 }
 /*-----------------------------------------------------------*/
@@ -1772,6 +2081,80 @@ BaseType_t xResize;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+
+	static NetworkBufferDescriptor_t *prvTCPGatherSegments( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer,
+		int32_t lStreamPos, int32_t *plDataLen, UBaseType_t uxOptionsLength )
+	{
+	NetworkBufferDescriptor_t *pxReturn = NULL;
+	TCPWindow_t *pxTCPWindow = &( pxSocket->u.xTCP.xTCPWindow );
+	const int32_t lSegmentSize = ( int32_t ) pxTCPWindow->usMSS;
+	const int32_t lStreamLength = ( int32_t ) pxSocket->u.xTCP.txStream->LENGTH;
+	int32_t lDataLen = *plDataLen;
+	int32_t lNextPos;
+	uint32_t ulNextLength;
+	UBaseType_t uxCount;
+
+		lNextPos = lStreamPos + lDataLen;
+		if( lNextPos >= lStreamLength )
+		{
+			lNextPos -= lStreamLength;
+		}
+
+		/* Only full-size segments are combined, and not when a FIN might be
+		sent, so that the FIN flag never needs to be split off. */
+		if( ( xBufferAllocFixedSize == pdFALSE ) &&
+			( lDataLen == lSegmentSize ) &&
+			( pxSocket->u.xTCP.bits.bCloseRequested == pdFALSE_UNSIGNED ) &&
+			( pxSocket->u.xTCP.bits.bUserShutdown == pdFALSE_UNSIGNED ) &&
+			( ulTCPWindowTxGetNext( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, lNextPos, pdTRUE ) != 0U ) )
+		{
+			/* At least two segments can be sent.  Only fetch them when a
+			buffer for the maximum size can be obtained. */
+			pxReturn = prvTCPBufferResize( pxSocket, pxNetworkBuffer,
+				lSegmentSize * ( int32_t ) ipconfigTCP_SEGMENTATION_MAX_SEGMENTS, uxOptionsLength );
+
+			if( pxReturn != NULL )
+			{
+				for( uxCount = 1U; uxCount < ( UBaseType_t ) ipconfigTCP_SEGMENTATION_MAX_SEGMENTS; uxCount++ )
+				{
+					ulNextLength = ulTCPWindowTxGetNext( pxTCPWindow, pxSocket->u.xTCP.ulWindowSize, lNextPos, pdFALSE );
+
+					if( ulNextLength == 0U )
+					{
+						break;
+					}
+
+					lDataLen += ( int32_t ) ulNextLength;
+					lNextPos += ( int32_t ) ulNextLength;
+					if( lNextPos >= lStreamLength )
+					{
+						lNextPos -= lStreamLength;
+					}
+
+					if( ( int32_t ) ulNextLength < lSegmentSize )
+					{
+						/* A short segment can only be the last one. */
+						break;
+					}
+				}
+
+				pxReturn->xDataLength = ( size_t ) ( ipSIZE_OF_ETH_HEADER + uxIPHeaderSizeSocket( pxSocket ) + ipSIZE_OF_TCP_HEADER + uxOptionsLength ) + ( size_t ) lDataLen;
+				*plDataLen = lDataLen;
+			}
+		}
+
+		if( pxReturn == NULL )
+		{
+			pxReturn = prvTCPBufferResize( pxSocket, pxNetworkBuffer, lDataLen, uxOptionsLength );
+		}
+
+		return pxReturn;
+	}
+
+#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
+/*-----------------------------------------------------------*/
+
 /*
  * Prepare an outgoing message, in case anything has to be sent.
  */
@@ -1819,7 +2202,16 @@ int32_t lStreamPos;
 		{
 			/* Check if the current network buffer is big enough, if not,
 			resize it. */
-			pxNewBuffer = prvTCPBufferResize( pxSocket, *ppxNetworkBuffer, lDataLen, uxOptionsLength );
+			#if( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+			{
+				/* More segments might be sent along in one large packet. */
+				pxNewBuffer = prvTCPGatherSegments( pxSocket, *ppxNetworkBuffer, lStreamPos, &( lDataLen ), uxOptionsLength );
+			}
+			#else
+			{
+				pxNewBuffer = prvTCPBufferResize( pxSocket, *ppxNetworkBuffer, lDataLen, uxOptionsLength );
+			}
+			#endif /* ipconfigTCP_SEGMENTATION_OFFLOAD */
 
 			if( pxNewBuffer != NULL )
 			{
@@ -1838,7 +2230,19 @@ int32_t lStreamPos;
 
 				/* Here data is copied from the txStream in 'peek' mode.  Only
 				when the packets are acked, the tail marker will be updated. */
-				ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
+				#if( ipTCP_TX_CHECKSUM_WHILE_COPYING )
+				{
+					/* Sum the payload while copying it, prvTCPReturnPacket()
+					will only have to add the headers. */
+					ulDataGot = ( uint32_t ) uxStreamBufferPeekChecksum( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, &( xTxSummed.usChecksum ) );
+					xTxSummed.pucEthernetBuffer = pucEthernetBuffer;
+					xTxSummed.ulLength = ulDataGot;
+				}
+				#else
+				{
+					ulDataGot = ( uint32_t ) uxStreamBufferGet( pxSocket->u.xTCP.txStream, uxOffset, pucSendData, ( size_t ) lDataLen, pdTRUE );
+				}
+				#endif /* ipTCP_TX_CHECKSUM_WHILE_COPYING */
 
 				#if( ipconfigHAS_DEBUG_PRINTF != 0 )
 				{
@@ -2025,6 +2429,8 @@ TickType_t ulDelayMs = ( TickType_t ) tcpMAXIMUM_TCP_WAKEUP_TIME_MS;
 		keep-alive/delayed-ACK mechanism). */
 	}
 
+	ipTCP_TIMER_REQUEST( pxSocket );
+
 	/* Return the number of clock ticks before the timer expires. */
 	return ( TickType_t ) pxSocket->u.xTCP.usTimeout;
 }
@@ -2282,7 +2688,18 @@ BaseType_t xResult = 0;
 			if the head marker in rxStream may be advanced,	only if lOffset == 0.
 			In case the low-water mark is reached, bLowWater will be set
 			"low-water" here stands for "little space". */
-			lStored = lTCPAddRxdata( pxSocket, ( uint32_t ) lOffset, pucRecvData, ulReceiveLength );
+			#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+			if( ( lOffset == 0 ) && ( xRxPlaced.pxSocket == pxSocket ) && ( xRxPlaced.pucData == pucRecvData ) && ( xRxPlaced.ulLength == ulReceiveLength ) )
+			{
+				/* The data was already copied to the head of rxStream while
+				its checksum was verified, only advance the head marker. */
+				lStored = lTCPAddRxdata( pxSocket, 0U, NULL, ulReceiveLength );
+			}
+			else
+			#endif /* ipTCP_RX_CHECKSUM_WHILE_COPYING */
+			{
+				lStored = lTCPAddRxdata( pxSocket, ( uint32_t ) lOffset, pucRecvData, ulReceiveLength );
+			}
 
 			if( lStored != ( int32_t ) ulReceiveLength )
 			{
@@ -2316,6 +2733,12 @@ BaseType_t xResult = 0;
 		pxTCPWindow->ucOptionLength = 0U;
 	}
 
+	#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+	{
+		xRxPlaced.pxSocket = NULL;
+	}
+	#endif
+
 	return xResult;
 }
 /*-----------------------------------------------------------*/
@@ -2730,6 +3153,7 @@ BaseType_t xSendLength = xByteCount;
 				for full-size message. */
 				pxSocket->u.xTCP.usTimeout = ( uint16_t ) ipMS_TO_MIN_TICKS( tcpDELAYED_ACK_LONGER_DELAY_MS );
 			}
+			ipTCP_TIMER_REQUEST( pxSocket );
 
 			if( ( xTCPWindowLoggingLevel > 1 ) && ( ipconfigTCP_MAY_LOG_PORT( pxSocket->usLocalPort ) ) )
 			{
@@ -3048,6 +3472,186 @@ uint32_t ulMSS = ipconfigTCP_MSS;
 }
 /*-----------------------------------------------------------*/
 
+#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+
+	static BaseType_t prvTCPCheckChecksum( const FreeRTOS_Socket_t *pxSocket, const NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	/* Map the buffer onto the IPHeader_t and ProtocolHeaders_t structs for easy access to the fields. */
+	const IPHeader_t *pxIPHeader = ipPOINTER_CAST( const IPHeader_t *, &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER ] ) );
+	const ProtocolHeaders_t *pxProtocolHeaders = ipPOINTER_CAST( const ProtocolHeaders_t *,
+		&( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( pxNetworkBuffer ) ] ) );
+	const TCPHeader_t *pxTCPHeader = &( pxProtocolHeaders->xTCPHeader );
+	const uint8_t *pucPayload;
+	size_t uxTCPLength, uxHeaderLength, uxPayloadLength;
+	uint16_t usHeaderSum, usPayloadSum, usSum;
+	BaseType_t xResult = pdFAIL;
+
+		xRxPlaced.pxSocket = NULL;
+
+		uxTCPLength = ( size_t ) FreeRTOS_ntohs( pxIPHeader->usLength );
+		uxHeaderLength = ( size_t ) ( ( pxTCPHeader->ucTCPOffset & tcpVALID_BITS_IN_TCP_OFFSET_BYTE ) >> 2 );
+
+		/* The length fields have been checked by xCheckSizeFields(), except
+		for the TCP header length. */
+		if( ( uxHeaderLength >= ipSIZE_OF_TCP_HEADER ) && ( uxTCPLength >= ( xIPHeaderSize( pxNetworkBuffer ) + uxHeaderLength ) ) )
+		{
+			uxTCPLength -= xIPHeaderSize( pxNetworkBuffer );
+			uxPayloadLength = uxTCPLength - uxHeaderLength;
+			pucPayload = &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( pxNetworkBuffer ) + uxHeaderLength ] );
+
+			/* Sum the pseudo header, i.e. protocol + length, the IP-addresses,
+			and the TCP header including its options. */
+			usHeaderSum = ( uint16_t ) ( uxTCPLength + ( size_t ) ipPROTOCOL_TCP );
+			usHeaderSum = usGenerateChecksum( usHeaderSum,
+				ipPOINTER_CAST( const uint8_t *, &( pxIPHeader->ulSourceIPAddress ) ),
+				( 2U * ipSIZE_OF_IPv4_ADDRESS ) + uxHeaderLength );
+
+			if( ( pxSocket != NULL ) &&
+				( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eESTABLISHED ) &&
+				( pxSocket->u.xTCP.rxStream != NULL ) &&
+				( pxSocket->u.xTCP.rxStream->uxFront == pxSocket->u.xTCP.rxStream->uxHead ) &&
+				( ( pxTCPHeader->ucTCPFlags & ( tcpTCP_FLAG_SYN | tcpTCP_FLAG_RST | tcpTCP_FLAG_URG ) ) == 0U ) &&
+				( FreeRTOS_ntohl( pxTCPHeader->ulSequenceNumber ) == pxSocket->u.xTCP.xTCPWindow.rx.ulCurrentSequenceNumber ) &&
+				( uxPayloadLength > 0U ) &&
+				( uxPayloadLength <= uxStreamBufferGetSpace( pxSocket->u.xTCP.rxStream ) ) )
+			{
+				/* In-order data for an established connection: copy it to
+				the free space at the head of the RX stream while summing it.
+				If the data gets accepted, prvStoreRxData() will only have to
+				advance the head marker. */
+				( void ) uxStreamBufferPlaceChecksum( pxSocket->u.xTCP.rxStream, pucPayload, uxPayloadLength, &( usPayloadSum ) );
+				xRxPlaced.pxSocket = pxSocket;
+				xRxPlaced.pucData = pucPayload;
+				xRxPlaced.ulLength = ( uint32_t ) uxPayloadLength;
+			}
+			else
+			{
+				usPayloadSum = usGenerateChecksum( 0U, pucPayload, uxPayloadLength );
+			}
+
+			/* Including the checksum field, a correct sum is 0xffff. */
+			usSum = usChecksumCombine( usHeaderSum, usPayloadSum, uxHeaderLength );
+
+			if( ( usSum == 0xffffU ) || ( usSum == 0U ) )
+			{
+				xResult = pdPASS;
+			}
+			else
+			{
+				FreeRTOS_debug_printf( ( "prvTCPCheckChecksum: from %lxip bad crc: %04X\n",
+					FreeRTOS_ntohl( pxIPHeader->ulSourceIPAddress ), usSum ) );
+				xRxPlaced.pxSocket = NULL;
+			}
+		}
+
+		return xResult;
+	}
+
+#endif /* ipTCP_RX_CHECKSUM_WHILE_COPYING */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_RX_COALESCING != 0 )
+
+	void vTCPCheckCoalescing( const NetworkBufferDescriptor_t *pxBuffer, const NetworkBufferDescriptor_t *pxNextBuffer )
+	{
+	const TCPPacket_t *pxPacket;
+	const TCPPacket_t *pxNextPacket;
+	uint32_t ulPayloadLength;
+	BaseType_t xCoalesce = pdFALSE;
+
+		if( ( pxNextBuffer != NULL ) &&
+			( pxBuffer->xDataLength >= sizeof( TCPPacket_t ) ) &&
+			( pxNextBuffer->xDataLength >= sizeof( TCPPacket_t ) ) )
+		{
+			pxPacket = ipPOINTER_CAST( const TCPPacket_t *, pxBuffer->pucEthernetBuffer );
+			pxNextPacket = ipPOINTER_CAST( const TCPPacket_t *, pxNextBuffer->pucEthernetBuffer );
+
+			/* Both must be IPv4 TCP packets without IP options, exchanged
+			between the same two end-points. */
+			if( ( pxPacket->xEthernetHeader.usFrameType == ipIPv4_FRAME_TYPE ) &&
+				( pxNextPacket->xEthernetHeader.usFrameType == ipIPv4_FRAME_TYPE ) &&
+				( pxPacket->xIPHeader.ucVersionHeaderLength == 0x45U ) &&
+				( pxNextPacket->xIPHeader.ucVersionHeaderLength == 0x45U ) &&
+				( pxPacket->xIPHeader.ucProtocol == ( uint8_t ) ipPROTOCOL_TCP ) &&
+				( pxNextPacket->xIPHeader.ucProtocol == ( uint8_t ) ipPROTOCOL_TCP ) &&
+				( pxPacket->xIPHeader.ulSourceIPAddress == pxNextPacket->xIPHeader.ulSourceIPAddress ) &&
+				( pxPacket->xIPHeader.ulDestinationIPAddress == pxNextPacket->xIPHeader.ulDestinationIPAddress ) &&
+				( pxPacket->xTCPHeader.usSourcePort == pxNextPacket->xTCPHeader.usSourcePort ) &&
+				( pxPacket->xTCPHeader.usDestinationPort == pxNextPacket->xTCPHeader.usDestinationPort ) )
+			{
+				/* Only plain data segments, without TCP options and without
+				control flags other than ACK and PSH, will be coalesced. */
+				if( ( ( pxPacket->xTCPHeader.ucTCPOffset & tcpTCP_OFFSET_LENGTH_BITS ) == tcpTCP_OFFSET_STANDARD_LENGTH ) &&
+					( ( pxPacket->xTCPHeader.ucTCPFlags & ~( ( uint8_t ) tcpTCP_FLAG_PSH ) ) == ( uint8_t ) tcpTCP_FLAG_ACK ) &&
+					( FreeRTOS_ntohs( pxPacket->xIPHeader.usLength ) > ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER ) ) )
+				{
+					ulPayloadLength = ( uint32_t ) FreeRTOS_ntohs( pxPacket->xIPHeader.usLength ) - ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER );
+
+					if( FreeRTOS_ntohl( pxNextPacket->xTCPHeader.ulSequenceNumber ) ==
+						( FreeRTOS_ntohl( pxPacket->xTCPHeader.ulSequenceNumber ) + ulPayloadLength ) )
+					{
+						xCoalesce = pdTRUE;
+					}
+				}
+			}
+		}
+
+		if( xCoalesce != pdFALSE )
+		{
+			pxCoalescedBuffer = pxBuffer;
+		}
+		else
+		{
+			pxCoalescedBuffer = NULL;
+		}
+	}
+
+#endif /* ipconfigTCP_RX_COALESCING */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_RX_COALESCING != 0 )
+
+	static BaseType_t prvTCPStoreCoalesced( FreeRTOS_Socket_t *pxSocket, NetworkBufferDescriptor_t *pxNetworkBuffer )
+	{
+	const ProtocolHeaders_t *pxProtocolHeaders = ipPOINTER_CAST( const ProtocolHeaders_t *,
+		&( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + xIPHeaderSize( pxNetworkBuffer ) ] ) );
+	TCPWindow_t *pxTCPWindow = &( pxSocket->u.xTCP.xTCPWindow );
+	uint32_t ulSequenceNumber = FreeRTOS_ntohl( pxProtocolHeaders->xTCPHeader.ulSequenceNumber );
+	uint32_t ulReceiveLength;
+	uint8_t *pucRecvData;
+	BaseType_t xResult = pdFALSE;
+
+		pxCoalescedBuffer = NULL;
+
+		/* Only the next expected segment of an established connection can
+		be stored without further processing.  Anything else goes through
+		prvTCPHandleState(). */
+		if( ( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eESTABLISHED ) &&
+			( pxSocket->u.xTCP.bits.bFinRecv == pdFALSE_UNSIGNED ) &&
+			( ulSequenceNumber == pxTCPWindow->rx.ulCurrentSequenceNumber ) )
+		{
+			prvTCPTouchSocket( pxSocket );
+
+			ulReceiveLength = ( uint32_t ) prvCheckRxData( pxNetworkBuffer, &pucRecvData );
+
+			if( ( ipNUMERIC_CAST( int32_t, ulSequenceNumber + ulReceiveLength - pxTCPWindow->rx.ulHighestSequenceNumber ) ) > 0L )
+			{
+				pxTCPWindow->rx.ulHighestSequenceNumber = ulSequenceNumber + ulReceiveLength;
+			}
+
+			/* The ACK number and the window size of this segment will be
+			repeated by the next segment.  Should the next segment be dropped
+			after all, the peer will retransmit and get its ACK then. */
+			( void ) prvStoreRxData( pxSocket, pucRecvData, pxNetworkBuffer, ulReceiveLength );
+			xResult = pdTRUE;
+		}
+
+		return xResult;
+	}
+
+#endif /* ipconfigTCP_RX_COALESCING */
+/*-----------------------------------------------------------*/
+
 /*
  *	FreeRTOS_TCP_IP has only 2 public functions, this is the second one:
  *	xProcessReceivedTCPPacket()
@@ -3092,10 +3696,22 @@ const IPHeader_t *pxIPHeader;
 		ulLocalIP = FreeRTOS_htonl( pxIPHeader->ulDestinationIPAddress );
 		ulRemoteIP = FreeRTOS_htonl( pxIPHeader->ulSourceIPAddress );
 
+		/* The lookup, a listening socket and the creation of a child socket
+		need the lock when there are TCP worker tasks. */
+		ipTCP_SOCKETS_LOCK();
+
 		/* Find the destination socket, and if not found: return a socket listing to
 		the destination PORT. */
 		pxSocket = ( FreeRTOS_Socket_t * ) pxTCPSocketLookup( ulLocalIP, xLocalPort, ulRemoteIP, xRemotePort );
 
+		#if( ipTCP_RX_CHECKSUM_WHILE_COPYING )
+		if( prvTCPCheckChecksum( pxSocket, pxNetworkBuffer ) == pdFAIL )
+		{
+			/* The packet will be dropped silently. */
+			xResult = pdFAIL;
+		}
+		else
+		#endif /* ipTCP_RX_CHECKSUM_WHILE_COPYING */
 		if( ( pxSocket == NULL ) || ( prvTCPSocketIsActive( ipNUMERIC_CAST( eIPTCPState_t, pxSocket->u.xTCP.ucTCPState ) ) == pdFALSE ) )
 		{
 			/* A TCP messages is received but either there is no socket with the
@@ -3222,6 +3838,22 @@ const IPHeader_t *pxIPHeader;
 			}
 		}
 
+		/* From here on, the socket is only accessed by the task that handles
+		its connection. */
+		ipTCP_SOCKETS_UNLOCK();
+
+		#if( ipconfigTCP_RX_COALESCING != 0 )
+		if( ( xResult != pdFAIL ) &&
+			( pxCoalescedBuffer == pxNetworkBuffer ) &&
+			( prvTCPStoreCoalesced( pxSocket, pxNetworkBuffer ) != pdFALSE ) )
+		{
+			/* The payload has been stored, the next segment in the chain
+			will be acknowledged for both. */
+			vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+			xResult = pdPASS;
+		}
+		else
+		#endif /* ipconfigTCP_RX_COALESCING */
 		if( xResult != pdFAIL )
 		{
 		uint16_t usWindow;
@@ -3368,6 +4000,23 @@ uint32_t ulInitialSequenceNumber;
 
 		pxReturn->u.xTCP.usRemotePort = FreeRTOS_htons( pxTCPPacket->xTCPHeader.usSourcePort );
 		pxReturn->u.xTCP.ulRemoteIP = FreeRTOS_htonl( pxTCPPacket->xIPHeader.ulSourceIPAddress );
+
+		#if( ipconfigIP_TCP_WORKER_TASKS > 0 )
+		{
+			/* The connection is handled by the worker that received the SYN. */
+			pxReturn->u.xTCP.ucWorker = ( uint8_t ) uxTCPWorkerForConnection( pxReturn->usLocalPort,
+																			   pxReturn->u.xTCP.ulRemoteIP,
+																			   pxReturn->u.xTCP.usRemotePort );
+		}
+		#endif /* ipconfigIP_TCP_WORKER_TASKS */
+
+		#if( ipconfigSOCKET_HASH_BUCKETS > 0 )
+		{
+			/* The peer is known now, make sure that the next packets will find
+			this socket through its 4-tuple. */
+			vTCPSocketHashConnection( pxReturn );
+		}
+		#endif /* ipconfigSOCKET_HASH_BUCKETS */
 		pxReturn->u.xTCP.xTCPWindow.ulOurSequenceNumber = ulInitialSequenceNumber;
 
 		/* Here is the SYN action. */
@@ -3419,6 +4068,14 @@ BaseType_t xResult;
 	}
 	#endif /* ipconfigUSE_CALLBACKS */
 
+	#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	{
+		/* The child uses the same congestion control as its parent. */
+		pxNewSocket->u.xTCP.xTCPWindow.xCongestion.pxOps = pxSocket->u.xTCP.xTCPWindow.xCongestion.pxOps;
+		pxNewSocket->u.xTCP.xTCPWindow.xCongestion.xAlgorithm = pxSocket->u.xTCP.xTCPWindow.xCongestion.xAlgorithm;
+	}
+	#endif /* ipconfigTCP_CONGESTION_CONTROL */
+
 	#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 	{
 		/* Child socket of listening sockets will inherit the Socket Set
@@ -3427,6 +4084,12 @@ BaseType_t xResult;
 		{
 			pxNewSocket->pxSocketSet = pxSocket->pxSocketSet;
 			pxNewSocket->xSelectBits = pxSocket->xSelectBits | ( ( EventBits_t ) eSELECT_READ ) | ( ( EventBits_t ) eSELECT_EXCEPT );
+
+			#if( ipconfigSELECT_USES_READY_LIST != 0 )
+			{
+				vSocketSetMember( pxNewSocket, pxNewSocket->pxSocketSet );
+			}
+			#endif /* ipconfigSELECT_USES_READY_LIST */
 		}
 	}
 	#endif /* ipconfigSUPPORT_SELECT_FUNCTION */
@@ -3529,11 +4192,15 @@ TickType_t uxLocalPort = ( TickType_t ) FreeRTOS_htons( pxSocket->usLocalPort );
 const ListItem_t *pxIterator;
 FreeRTOS_Socket_t *pxFound;
 BaseType_t xResult = pdFALSE;
-const ListItem_t *pxEndTCP = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &xBoundTCPSocketsList ) );
+const List_t *pxList = pxSocketListForPort( ( BaseType_t ) FREERTOS_IPPROTO_TCP, uxLocalPort );
+const ListItem_t *pxEndTCP = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( pxList ) );
+
+	/* Here the bound socket lists can be accessed safely IP-task is the only
+	one who has access, or the TCP worker tasks when they hold the lock.  Only
+	the sockets that may use the same port are visited. */
+	ipTCP_SOCKETS_LOCK();
 
-	/* Here xBoundTCPSocketsList can be accessed safely IP-task is the only one
-	who has access. */
-	for( pxIterator = ( const ListItem_t * ) listGET_HEAD_ENTRY( &xBoundTCPSocketsList );
+	for( pxIterator = ( const ListItem_t * ) listGET_HEAD_ENTRY( pxList );
 		pxIterator != pxEndTCP;
 		pxIterator = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
 	{
@@ -3549,6 +4216,9 @@ const ListItem_t *pxEndTCP = ipPOINTER_CAST( const ListItem_t *, listGET_END_MAR
 			}
 		}
 	}
+
+	ipTCP_SOCKETS_UNLOCK();
+
 	return xResult;
 }
 /*-----------------------------------------------------------*/
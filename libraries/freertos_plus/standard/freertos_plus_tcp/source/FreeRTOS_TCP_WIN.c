@@ -61,21 +61,18 @@
 
 	#define xTCPWindowTxNew( pxWindow, ulSequenceNumber, lCount ) xTCPWindowNew( pxWindow, ulSequenceNumber, lCount, pdFALSE )
 
-	/* The code to send a single Selective ACK (SACK):
-	 * NOP (0x01), NOP (0x01), SACK (0x05), LEN (0x0a),
-	 * followed by a lower and a higher sequence number,
-	 * where LEN is 2 + 2*4 = 10 bytes. */
-	#if( ipconfigBYTE_ORDER == pdFREERTOS_BIG_ENDIAN )
-		#define OPTION_CODE_SINGLE_SACK		( 0x0101050aUL )
-	#else
-		#define OPTION_CODE_SINGLE_SACK		( 0x0a050101UL )
-	#endif
+	/* The code to send Selective ACK's (SACK):
+	 * NOP (0x01), NOP (0x01), SACK (0x05), LEN,
+	 * followed by pairs of a lower and a higher sequence number,
+	 * where LEN is 2 + 8 bytes for every pair (block). */
+	#define OPTION_CODE_SACK				( 0x01010500UL )
+	#define OPTION_SACK_LENGTH( xBlocks )	( 2UL + ( 8UL * ( uint32_t ) ( xBlocks ) ) )
 
 	/* Normal retransmission:
 	 * A packet will be retransmitted after a Retransmit Time-Out (RTO).
 	 * Fast retransmission:
-	 * When 3 packets with a higher sequence number have been acknowledged
-	 * by the peer, it is very unlikely a current packet will ever arrive.
+	 * When 3 packets with a higher sequence number have been selectively
+	 * acknowledged by the peer, it is very unlikely a current packet will ever arrive.
 	 * It will be retransmitted far before the RTO.
 	 */
 	#define	DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT		( 3U )
@@ -86,6 +83,46 @@
 	#define MAX_TRANSMIT_COUNT_USING_LARGE_WINDOW		( 4U )
 
 #endif /* configUSE_TCP_WIN */
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	/* Recovery states of the congestion control. */
+	#define winCC_RECOVERY_NONE			( 0U )	/* Not recovering from a loss. */
+	#define winCC_RECOVERY_FAST			( 1U )	/* Fast recovery after a fast retransmission. */
+	#define winCC_RECOVERY_TIMEOUT		( 2U )	/* Slow start after a retransmission time-out. */
+
+	/* The initial window of RFC 3390: min( 4 * MSS, max( 2 * MSS, 4380 ) ). */
+	#define winCC_INITIAL_WINDOW_BYTES	( 4380UL )
+
+	/* Upper limit of the congestion window, well clear of overflows.  It is
+	also the initial slow start threshold, which should be arbitrarily high. */
+	#define winCC_MAX_WINDOW			( 0x40000000UL )
+
+	/* In slow start, the window grows by at most 2 * MSS per ACK (RFC 3465). */
+	#define winCC_SLOW_START_SEGMENTS	( 2UL )
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+
+	/* CUBIC: the multiplicative decrease beta is 0.7 and the Reno friendly
+	increase alpha = 3 * ( 1 - beta ) / ( 1 + beta ) is 0.53, both scaled by
+	1024. */
+	#define winCUBIC_BETA				( 717ULL )
+	#define winCUBIC_ALPHA				( 542ULL )
+	#define winCUBIC_SCALE				( 1024ULL )
+
+	/* The window follows C * t^3 segments with C = 0.4 and t in seconds.  With
+	t in ms, that is t^3 / 2.5e9 segments. */
+	#define winCUBIC_INV_C_MS3			( 2500000000ULL )
+
+	/* Distance in ms from the plateau beyond which the curve is not followed. */
+	#define winCUBIC_MAX_T_MS			( 100000UL )
+
+	/* Below the curve, the window grows 1 MSS once 100 windows were ACK'd. */
+	#define winCUBIC_SLOW_GROWTH		( 100UL )
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
 /*-----------------------------------------------------------*/
 
 static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewListItem, MiniListItem_t * const pxWhere );
@@ -142,15 +179,31 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
 /*
- * A segment has been received with sequence number 'ulSequenceNumber', where
- * 'ulCurrentSequenceNumber == ulSequenceNumber', which means that exactly this
- * segment was expected.  xTCPWindowRxConfirm() will check if there is already
- * another segment with a sequence number between (ulSequenceNumber) and
- * (ulSequenceNumber+xLength).  Normally none will be found, because the next Rx
- * segment should have a sequence number equal to '(ulSequenceNumber+xLength)'.
+ * Store a new Rx segment in 'xRxSegments'.  The list is kept sorted on sequence
+ * number, so that the data received out-of-order can be handled as a series of
+ * ranges, and searches can stop early.
  */
 #if( ipconfigUSE_TCP_WIN == 1 )
-	static TCPSegment_t *xTCPWindowRxConfirm( const TCPWindow_t *pxWindow, uint32_t ulSequenceNumber, uint32_t ulLength );
+	static void prvTCPWindowRxInsert( TCPWindow_t *pxWindow, ListItem_t *pxItem, uint32_t ulSequenceNumber );
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+
+/*
+ * The data up to 'ulSequenceNumber' has been received in-order.  Release all
+ * stored segments which are now covered by it, and return the sequence number
+ * up to which data is available contiguously.  The stored segments may overlap
+ * when the peer has retransmitted a series of packets as one.
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static uint32_t prvTCPWindowRxConsume( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+
+/*
+ * Prepare a SACK option with up to ipconfigTCP_SACK_BLOCKS ranges of stored
+ * data.  The first block contains 'ulSequenceNumber', the data just received,
+ * the other blocks are the ranges that were most recently updated (RFC 2018).
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static void prvTCPWindowRxSetSack( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
 /*
@@ -174,17 +227,56 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
  * from the transmission queue(s).
  */
 #if( ipconfigUSE_TCP_WIN == 1 )
-	static uint32_t prvTCPWindowTxCheckAck( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast );
+	static uint32_t prvTCPWindowTxCheckAck( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast, uint32_t *pulSacked );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
 /*
- * A higher Tx block has been acknowledged.  Now iterate through the xWaitQueue
- * to find a possible condition for a FAST retransmission.
+ * A higher Tx block has been acknowledged.  Now use the SACK scoreboard to find
+ * the segments which must have been lost, and schedule a FAST retransmission.
  */
 #if( ipconfigUSE_TCP_WIN == 1 )
-	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst );
+	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow );
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 
+/*
+ * The number of bytes that have been sent but not yet acknowledged.
+ */
+#if( ipconfigUSE_TCP_WIN == 1 )
+	static uint32_t prvTCPWindowTxFlightSize( const TCPWindow_t *pxWindow );
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+
+/*
+ * Congestion control: the window reacts to ACK's, SACK's, fast
+ * retransmissions and time-outs, and limits the data outstanding to the
+ * congestion window.  The algorithm (NewReno or CUBIC) decides how much the
+ * window shrinks after a loss and how it grows above the slow start threshold.
+ */
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	static void prvCongestionInit( TCPWindow_t *pxWindow );
+
+	static uint32_t prvCongestionWindow( const TCPWindow_t *pxWindow );
+
+	static void prvCongestionOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked, uint32_t ulFlightSize );
+
+	static void prvCongestionOnSack( TCPWindow_t *pxWindow, uint32_t ulSacked, uint32_t ulFlightSize, uint32_t ulRetransmits );
+
+	static void prvCongestionOnTimeout( TCPWindow_t *pxWindow, BaseType_t xRepeated );
+
+	static void prvTCPWindowTxRetransmitFirst( TCPWindow_t *pxWindow );
+
+	static void prvNewRenoOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize, BaseType_t xTimeout );
+
+	static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked );
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+	static uint32_t ulCubicRoot( uint64_t ullValue );
+
+	static void prvCubicOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize, BaseType_t xTimeout );
+
+	static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked );
+#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+
 /*-----------------------------------------------------------*/
 
 /* TCP segment pool. */
@@ -200,6 +292,15 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 /* Logging verbosity level. */
 BaseType_t xTCPWindowLoggingLevel = 0;
 
+/* The congestion control algorithms. */
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	static const TCPCongestionOps_t xNewRenoOps = { prvNewRenoOnLoss, prvNewRenoOnAck };
+#endif
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+	static const TCPCongestionOps_t xCubicOps = { prvCubicOnLoss, prvCubicOnAck };
+#endif
+
 #if( ipconfigUSE_TCP_WIN == 1 )
 	/* Some 32-bit arithmetic: comparing sequence numbers */
 	static portINLINE BaseType_t xSequenceLessThanOrEqual( uint32_t a, uint32_t b );
@@ -387,6 +488,12 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 				pxReturn = pxSegment;
 				break;
 			}
+
+			if( xSequenceGreaterThan( pxSegment->ulSequenceNumber, ulSequenceNumber ) != pdFALSE )
+			{
+				/* The list is sorted, the segment is not stored. */
+				break;
+			}
 		}
 
 		return pxReturn;
@@ -403,18 +510,23 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 	ListItem_t * pxItem;
 
 		/* Allocate a new segment.  The socket will borrow all segments from a
-		common pool: 'xSegmentList', which is a list of 'TCPSegment_t' */
+		common pool: 'xSegmentList', which is a list of 'TCPSegment_t'.  The
+		pool is shared with the other TCP worker tasks, if any. */
+		ipTCP_SOCKETS_LOCK();
+
 		if( listLIST_IS_EMPTY( &xSegmentList ) != pdFALSE )
 		{
 			/* If the TCP-stack runs out of segments, you might consider
 			increasing 'ipconfigTCP_WIN_SEG_COUNT'. */
+			ipTCP_SOCKETS_UNLOCK();
+
 			FreeRTOS_debug_printf( ( "xTCPWindow%cxNew: Error: all segments occupied\n", ( xIsForRx != 0 ) ? 'R' : 'T' ) );
 			pxSegment = NULL;
 		}
 		else
 		{
 			/* Pop the item at the head of the list.  Semaphore protection is
-			not required as only the IP task will call these functions.  */
+			not required when only the IP task calls these functions.  */
 			pxItem = ( ListItem_t * ) listGET_HEAD_ENTRY( &xSegmentList );
 			pxSegment = ipPOINTER_CAST( TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxItem ) );
 
@@ -424,10 +536,12 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 			/* Remove the item from xSegmentList. */
 			( void ) uxListRemove( pxItem );
 
+			ipTCP_SOCKETS_UNLOCK();
+
 			/* Add it to either the connections' Rx or Tx queue. */
 			if( xIsForRx != 0 )
 			{
-				vListInsertFifo( &pxWindow->xRxSegments, pxItem );
+				prvTCPWindowRxInsert( pxWindow, pxItem, ulSequenceNumber );
 			}
 			else
 			{
@@ -571,7 +685,9 @@ static void vListInsertGeneric( List_t * const pxList, ListItem_t * const pxNewL
 		}
 
 		/* Return it to xSegmentList */
+		ipTCP_SOCKETS_LOCK();
 		vListInsertFifo( &xSegmentList, &( pxSegment->xSegmentItem ) );
+		ipTCP_SOCKETS_UNLOCK();
 	}
 
 #endif /* ipconfigUSE_TCP_WIN == 1 */
@@ -621,11 +737,15 @@ void vTCPWindowCreate( TCPWindow_t *pxWindow, uint32_t ulRxWindowLength,
 
 	#if( ipconfigUSE_TCP_WIN == 1 )
 	{
+		ipTCP_SOCKETS_LOCK();
+
 		if( xTCPSegments == NULL )
 		{
 			( void ) prvCreateSectors();
 		}
 
+		ipTCP_SOCKETS_UNLOCK();
+
 		vListInitialise( &( pxWindow->xTxSegments ) );
 		vListInitialise( &( pxWindow->xRxSegments ) );
 
@@ -699,6 +819,13 @@ const int32_t l500ms = 500;
 	/* The right-hand side of the transmit window. */
 	pxWindow->tx.ulHighestSequenceNumber = ulSequenceNumber;
 	pxWindow->ulOurSequenceNumber = ulSequenceNumber;
+
+	#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+	{
+		/* Start in slow start with the initial window. */
+		prvCongestionInit( pxWindow );
+	}
+	#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
 }
 /*-----------------------------------------------------------*/
 
@@ -736,59 +863,213 @@ const int32_t l500ms = 500;
 
 #if( ipconfigUSE_TCP_WIN == 1 )
 
-	static TCPSegment_t *xTCPWindowRxConfirm( const TCPWindow_t *pxWindow, uint32_t ulSequenceNumber, uint32_t ulLength )
+	static void prvTCPWindowRxInsert( TCPWindow_t *pxWindow, ListItem_t *pxItem, uint32_t ulSequenceNumber )
+	{
+	const ListItem_t *pxIterator;
+	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &pxWindow->xRxSegments ) );
+	const TCPSegment_t *pxSegment;
+
+		/* Out-of-order data usually comes in with increasing sequence numbers,
+		so look for the insertion point starting from the end of the list. */
+		pxIterator = pxEnd->pxPrevious;
+
+		while( pxIterator != pxEnd )
+		{
+			pxSegment = ipPOINTER_CAST( const TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+			if( xSequenceLessThanOrEqual( pxSegment->ulSequenceNumber, ulSequenceNumber ) != pdFALSE )
+			{
+				break;
+			}
+
+			pxIterator = pxIterator->pxPrevious;
+		}
+
+		/* Insert it after 'pxIterator', i.e. before its successor. */
+		vListInsertGeneric( &pxWindow->xRxSegments, pxItem, ipPOINTER_CAST( MiniListItem_t *, listGET_NEXT( pxIterator ) ) );
+	}
+
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static uint32_t prvTCPWindowRxConsume( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
 	{
-	TCPSegment_t *pxBest = NULL;
 	const ListItem_t *pxIterator;
-	uint32_t ulNextSequenceNumber = ulSequenceNumber + ulLength;
-	const ListItem_t * pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &pxWindow->xRxSegments ) );
+	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &pxWindow->xRxSegments ) );
 	TCPSegment_t *pxSegment;
+	uint32_t ulCurrentSequenceNumber = ulSequenceNumber;
+	uint32_t ulLast;
 
-		/* A segment has been received with sequence number 'ulSequenceNumber',
-		where 'ulCurrentSequenceNumber == ulSequenceNumber', which means that
-		exactly this segment was expected.  xTCPWindowRxConfirm() will check if
-		there is already another segment with a sequence number between (ulSequenceNumber)
-		and (ulSequenceNumber+ulLength).  Normally none will be found, because
-		the next RX segment should have a sequence number equal to
-		'(ulSequenceNumber+ulLength)'. */
+		pxIterator = listGET_NEXT( pxEnd );
 
-		/* Iterate through all RX segments that are stored: */
-		for( pxIterator  = listGET_NEXT( pxEnd );
-			 pxIterator != pxEnd;
-			 pxIterator  = listGET_NEXT( pxIterator ) )
+		while( pxIterator != pxEnd )
 		{
 			pxSegment = ipPOINTER_CAST( TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
-			/* And see if there is a segment for which:
-			'ulSequenceNumber' <= 'pxSegment->ulSequenceNumber' < 'ulNextSequenceNumber'
-			If there are more matching segments, the one with the lowest sequence number
-			shall be taken */
-			if( ( xSequenceGreaterThanOrEqual( pxSegment->ulSequenceNumber, ulSequenceNumber ) != 0 ) &&
-				( xSequenceLessThan( pxSegment->ulSequenceNumber, ulNextSequenceNumber ) != 0 ) )
-			{
-				if( ( pxBest == NULL ) || ( xSequenceLessThan( pxSegment->ulSequenceNumber, pxBest->ulSequenceNumber ) != 0 ) )
+
+			/* Hop to the next item before the current gets unlinked. */
+			pxIterator = listGET_NEXT( pxIterator );
+
+			if( xSequenceGreaterThan( pxSegment->ulSequenceNumber, ulCurrentSequenceNumber ) != pdFALSE )
+			{
+				/* There is a gap: all remaining segments lie beyond it. */
+				break;
+			}
+
+			/* The data of this segment is either a duplicate, or it follows the
+			data received and was stored in the stream already. */
+			ulLast = pxSegment->ulSequenceNumber + ( uint32_t ) pxSegment->lDataLength;
+
+			if( xSequenceGreaterThan( ulLast, ulCurrentSequenceNumber ) != pdFALSE )
+			{
+				ulCurrentSequenceNumber = ulLast;
+			}
+
+			/* As all data up to here will be passed to the user, the segment
+			can be discarded. */
+			vTCPWindowFree( pxSegment );
+		}
+
+		return ulCurrentSequenceNumber;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static void prvTCPWindowRxSetSack( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
+	{
+	const ListItem_t *pxIterator;
+	const ListItem_t *pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &pxWindow->xRxSegments ) );
+	const TCPSegment_t *pxSegment;
+	uint32_t ulFirst[ ipconfigTCP_SACK_BLOCKS ];
+	uint32_t ulLast[ ipconfigTCP_SACK_BLOCKS ];
+	uint32_t ulAge[ ipconfigTCP_SACK_BLOCKS ];
+	uint32_t ulRangeFirst = 0U, ulRangeLast = 0U, ulRangeAge = 0U;
+	uint32_t ulSegmentLast, ulSegmentAge;
+	BaseType_t xRangeOpen = pdFALSE;
+	BaseType_t xHasFirst = pdFALSE;
+	BaseType_t xCount = 1;
+	BaseType_t xIndex;
+
+		/* Walk through the stored segments, which are sorted on sequence
+		number, and merge the adjacent and overlapping ones into ranges. */
+		pxIterator = listGET_NEXT( pxEnd );
+
+		while( pxIterator != pxEnd )
+		{
+			pxSegment = ipPOINTER_CAST( const TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+			pxIterator = listGET_NEXT( pxIterator );
+
+			ulSegmentLast = pxSegment->ulSequenceNumber + ( uint32_t ) pxSegment->lDataLength;
+			/* The Rx timer of a segment was set when it was stored. */
+			ulSegmentAge = ulTimerGetAge( &( pxSegment->xTransmitTimer ) );
+
+			if( xRangeOpen == pdFALSE )
+			{
+				ulRangeFirst = pxSegment->ulSequenceNumber;
+				ulRangeLast = ulSegmentLast;
+				ulRangeAge = ulSegmentAge;
+				xRangeOpen = pdTRUE;
+			}
+			else
+			{
+				if( xSequenceGreaterThan( ulSegmentLast, ulRangeLast ) != pdFALSE )
 				{
-					pxBest = pxSegment;
+					ulRangeLast = ulSegmentLast;
+				}
+
+				ulRangeAge = FreeRTOS_min_uint32( ulRangeAge, ulSegmentAge );
+			}
+
+			/* The range ends when the next segment does not connect to it. */
+			if( pxIterator != pxEnd )
+			{
+				pxSegment = ipPOINTER_CAST( const TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
+
+				if( xSequenceLessThanOrEqual( pxSegment->ulSequenceNumber, ulRangeLast ) != pdFALSE )
+				{
+					continue;
+				}
+			}
+
+			xRangeOpen = pdFALSE;
+
+			if( ( xSequenceLessThanOrEqual( ulRangeFirst, ulSequenceNumber ) != pdFALSE ) &&
+				( xSequenceLessThan( ulSequenceNumber, ulRangeLast ) != pdFALSE ) )
+			{
+				/* The range that contains the new data must be reported first. */
+				ulFirst[ 0 ] = ulRangeFirst;
+				ulLast[ 0 ] = ulRangeLast;
+				xHasFirst = pdTRUE;
+			}
+			else
+			{
+				/* Keep the other ranges sorted on age, the youngest first, and
+				drop the oldest when there is no more space. */
+				xIndex = xCount;
+
+				while( ( xIndex > 1 ) && ( ulAge[ xIndex - 1 ] > ulRangeAge ) )
+				{
+					if( xIndex < ( BaseType_t ) ipconfigTCP_SACK_BLOCKS )
+					{
+						ulFirst[ xIndex ] = ulFirst[ xIndex - 1 ];
+						ulLast[ xIndex ] = ulLast[ xIndex - 1 ];
+						ulAge[ xIndex ] = ulAge[ xIndex - 1 ];
+					}
+
+					xIndex--;
+				}
+
+				if( xIndex < ( BaseType_t ) ipconfigTCP_SACK_BLOCKS )
+				{
+					ulFirst[ xIndex ] = ulRangeFirst;
+					ulLast[ xIndex ] = ulRangeLast;
+					ulAge[ xIndex ] = ulRangeAge;
+
+					if( xCount < ( BaseType_t ) ipconfigTCP_SACK_BLOCKS )
+					{
+						xCount++;
+					}
 				}
 			}
 		}
 
-		if( ( pxBest != NULL ) &&
-			( ( pxBest->ulSequenceNumber != ulSequenceNumber ) || ( pxBest->lDataLength != ( int32_t ) ulLength ) ) )
+		if( xHasFirst == pdFALSE )
 		{
-			FreeRTOS_debug_printf( ( "xTCPWindowRxConfirm[%u]: search %lu (+%ld=%lu) found %lu (+%ld=%lu)\n",
-				pxWindow->usPeerPortNumber,
-				ulSequenceNumber - pxWindow->rx.ulFirstSequenceNumber,
-				ulLength,
-				ulSequenceNumber + ulLength - pxWindow->rx.ulFirstSequenceNumber,
-				pxBest->ulSequenceNumber - pxWindow->rx.ulFirstSequenceNumber,
-				pxBest->lDataLength,
-				pxBest->ulSequenceNumber + ( ( uint32_t ) pxBest->lDataLength ) - pxWindow->rx.ulFirstSequenceNumber ) );
+			/* The data was not stored, a SACK can not be sent. */
+			pxWindow->ucOptionLength = 0U;
 		}
+		else
+		{
+			/* Code OPTION_CODE_SACK is followed by the length of the option. */
+			pxWindow->ulOptionsData[ 0 ] = FreeRTOS_htonl( OPTION_CODE_SACK | OPTION_SACK_LENGTH( xCount ) );
+
+			for( xIndex = 0; xIndex < xCount; xIndex++ )
+			{
+				/* First sequence number received, and last + 1. */
+				pxWindow->ulOptionsData[ ( 2 * xIndex ) + 1 ] = FreeRTOS_htonl( ulFirst[ xIndex ] );
+				pxWindow->ulOptionsData[ ( 2 * xIndex ) + 2 ] = FreeRTOS_htonl( ulLast[ xIndex ] );
+			}
 
-		return pxBest;
+			/* Which makes 4 + 8 bytes per block. */
+			pxWindow->ucOptionLength = ( uint8_t ) ( ( 1U + ( 2U * ( uint32_t ) xCount ) ) * sizeof( pxWindow->ulOptionsData[ 0 ] ) );
+
+			if( xTCPWindowLoggingLevel >= 1 )
+			{
+				FreeRTOS_debug_printf( ( "prvTCPWindowRxSetSack[%d,%d]: %d blocks, first %u - %u\n",
+					( int ) pxWindow->usPeerPortNumber,
+					( int ) pxWindow->usOurPortNumber,
+					( int ) xCount,
+					( unsigned ) ( ulFirst[ 0 ] - pxWindow->rx.ulFirstSequenceNumber ),
+					( unsigned ) ( ulLast[ 0 ] - pxWindow->rx.ulFirstSequenceNumber ) ) );
+			}
+		}
 	}
 
-#endif /* ipconfgiUSE_TCP_WIN == 1 */
+#endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
 #if( ipconfigUSE_TCP_WIN == 1 )
@@ -833,36 +1114,13 @@ const int32_t l500ms = 500;
 				{
 					ulSavedSequenceNumber = ulCurrentSequenceNumber;
 
-                    /* Clean up all sequence received between ulSequenceNumber and ulSequenceNumber + ulLength since they are duplicated.
-                    If the server is forced to retransmit packets several time in a row it might send a batch of concatenated packet for speed.
-                    So we cannot rely on the packets between ulSequenceNumber and ulSequenceNumber + ulLength to be sequential and it is better to just
-                    clean them out. */
-                    do
-                    {
-                        pxFound = xTCPWindowRxConfirm( pxWindow, ulSequenceNumber, ulLength );
-
-                        if ( pxFound != NULL )
-                        {
-                            /* Remove it because it will be passed to user directly. */
-                            vTCPWindowFree( pxFound );
-                        }
-                    } while ( pxFound != NULL );
-
-					/*  Check for following segments that are already in the
-					queue and increment ulCurrentSequenceNumber. */
-					for( ;; )
-					{
-						pxFound = xTCPWindowRxFind( pxWindow, ulCurrentSequenceNumber );
-						if( pxFound == NULL )
-						{
-							break;
-						}
-						ulCurrentSequenceNumber += ( uint32_t ) pxFound->lDataLength;
-
-						/* As all packet below this one have been passed to the
-						user it can be discarded. */
-						vTCPWindowFree( pxFound );
-					}
+					/* Release the segments that were received earlier and which
+					are duplicates of this one, and see if stored segments follow,
+					which increment ulCurrentSequenceNumber.  If the peer is forced
+					to retransmit packets several time in a row it might send a
+					batch of concatenated packets, so the stored segments may
+					overlap with this one. */
+					ulCurrentSequenceNumber = prvTCPWindowRxConsume( pxWindow, ulCurrentSequenceNumber );
 
 					if( ulSavedSequenceNumber != ulCurrentSequenceNumber )
 					{
@@ -923,47 +1181,20 @@ const int32_t l500ms = 500;
 			}
 			else
 			{
-				/* See if there is more data in a contiguous block to make the
-				SACK describe a longer range of data. */
-
 				/* TODO: SACK's may also be delayed for a short period
 				 * This is useful because subsequent packets will be SACK'd with
 				 * single one message
 				 */
-				for( ;; )
-				{
-					pxFound = xTCPWindowRxFind( pxWindow, ulLast );
-					if( pxFound == NULL )
-					{
-						break;
-					}
-					ulLast += ( uint32_t ) pxFound->lDataLength;
-				}
-
 				if( xTCPWindowLoggingLevel >= 1 )
 				{
-					FreeRTOS_debug_printf( ( "lTCPWindowRxCheck[%d,%d]: seqnr %u exp %u (dist %d) SACK to %u\n",
+					FreeRTOS_debug_printf( ( "lTCPWindowRxCheck[%d,%d]: seqnr %u exp %u (dist %d)\n",
 						( int ) pxWindow->usPeerPortNumber,
 						( int ) pxWindow->usOurPortNumber,
 						( unsigned ) ulSequenceNumber - pxWindow->rx.ulFirstSequenceNumber,
 						( unsigned ) ulCurrentSequenceNumber - pxWindow->rx.ulFirstSequenceNumber,
-						( unsigned ) ( ulSequenceNumber - ulCurrentSequenceNumber ),	/* want this signed */
-						( unsigned ) ( ulLast - pxWindow->rx.ulFirstSequenceNumber ) ) );
+						( unsigned ) ( ulSequenceNumber - ulCurrentSequenceNumber ) ) );	/* want this signed */
 				}
 
-				/* Now prepare the SACK message.
-				Code OPTION_CODE_SINGLE_SACK already in network byte order. */
-				pxWindow->ulOptionsData[0] = OPTION_CODE_SINGLE_SACK;
-
-				/* First sequence number that we received. */
-				pxWindow->ulOptionsData[1] = FreeRTOS_htonl( ulSequenceNumber );
-
-				/* Last + 1 */
-				pxWindow->ulOptionsData[2] = FreeRTOS_htonl( ulLast );
-
-				/* Which make 12 (3*4) option bytes. */
-				pxWindow->ucOptionLength = ( uint8_t ) ( 3U * sizeof( pxWindow->ulOptionsData[ 0 ] ) );
-
 				pxFound = xTCPWindowRxFind( pxWindow, ulSequenceNumber );
 
 				if( pxFound != NULL )
@@ -980,10 +1211,7 @@ const int32_t l500ms = 500;
 					if( pxFound == NULL )
 					{
 						/* Can not send a SACK, because the segment cannot be
-						stored. */
-						pxWindow->ucOptionLength = 0U;
-
-						/* Needs to be stored but there is no segment
+						stored.  Needs to be stored but there is no segment
 						available. */
 						lReturn = -1;
 					}
@@ -1002,6 +1230,12 @@ const int32_t l500ms = 500;
 						lReturn = ipNUMERIC_CAST( int32_t, ulSequenceNumber - ulCurrentSequenceNumber );
 					}
 				}
+
+				if( pxFound != NULL )
+				{
+					/* Now prepare the SACK message. */
+					prvTCPWindowRxSetSack( pxWindow, ulSequenceNumber );
+				}
 			}
 		}
 
@@ -1188,6 +1422,7 @@ const int32_t l500ms = 500;
 	BaseType_t xHasSpace;
 	const TCPSegment_t *pxSegment;
 	uint32_t ulNettSize;
+	uint32_t ulSendWindow = ulWindowSize;
 
 		/* This function will look if there is new transmission data.  It will
 		return true if there is data to be sent. */
@@ -1202,17 +1437,17 @@ const int32_t l500ms = 500;
 		{
 			/* How much data is outstanding, i.e. how much data has been sent
 			but not yet acknowledged ? */
-			if( pxWindow->tx.ulHighestSequenceNumber >= pxWindow->tx.ulCurrentSequenceNumber )
-			{
-				ulTxOutstanding = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
-			}
-			else
+			ulTxOutstanding = prvTCPWindowTxFlightSize( pxWindow );
+
+			#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
 			{
-				ulTxOutstanding = 0UL;
+				/* Don't send more than the network is believed to take. */
+				ulSendWindow = FreeRTOS_min_uint32( ulSendWindow, prvCongestionWindow( pxWindow ) );
 			}
+			#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
 
 			/* Subtract this from the peer's space. */
-			ulNettSize = ulWindowSize - FreeRTOS_min_uint32( ulWindowSize, ulTxOutstanding );
+			ulNettSize = ulSendWindow - FreeRTOS_min_uint32( ulSendWindow, ulTxOutstanding );
 
 			/* See if the next segment may be sent. */
 			if( ulNettSize >= ( uint32_t ) pxSegment->lDataLength )
@@ -1351,6 +1586,13 @@ const int32_t l500ms = 500;
 					pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
 					pxSegment->u.bits.ucDupAckCount = ( uint8_t ) pdFALSE_UNSIGNED;
 
+					#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+					{
+						/* A time-out is taken as a sign of heavy congestion. */
+						prvCongestionOnTimeout( pxWindow, ( pxSegment->u.bits.ucTransmitCount > 1U ) ? pdTRUE : pdFALSE );
+					}
+					#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+
 					/* Some detailed logging. */
 					if( ( xTCPWindowLoggingLevel != 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
 					{
@@ -1488,9 +1730,60 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 ) )
+
+	uint32_t ulTCPWindowTxGetNext( TCPWindow_t *pxWindow, uint32_t ulWindowSize, int32_t lPosition, BaseType_t xPeek )
+	{
+	TCPSegment_t *pxSegment;
+	const TCPSegment_t *pxWaiting;
+	uint32_t ulReturn = 0UL;
+
+		/* Only new data that directly follows the segment(s) fetched by
+		ulTCPWindowTxGet() may be added, and only when there is nothing that
+		must be retransmitted first. */
+		pxSegment = xTCPWindowPeekHead( &( pxWindow->xTxQueue ) );
+		pxWaiting = xTCPWindowPeekHead( &( pxWindow->xWaitQueue ) );
+
+		if( ( pxSegment != NULL ) &&
+			( pxSegment->lStreamPos == lPosition ) &&
+			( listLIST_IS_EMPTY( &( pxWindow->xPriorityQueue ) ) != pdFALSE ) &&
+			( ( pxWaiting == NULL ) ||
+			  ( ulTimerGetAge( &( pxWaiting->xTransmitTimer ) ) <= ( ( 1UL << pxWaiting->u.bits.ucTransmitCount ) * ( ( uint32_t ) pxWindow->lSRTT ) ) ) ) &&
+			( ( pxWindow->u.bits.bSendFullSize == pdFALSE_UNSIGNED ) || ( pxSegment->lDataLength >= pxSegment->lMaxLength ) ) &&
+			( prvTCPWindowTxHasSpace( pxWindow, ulWindowSize ) != pdFALSE ) )
+		{
+			ulReturn = ( uint32_t ) pxSegment->lDataLength;
+
+			if( xPeek == pdFALSE )
+			{
+				/* Move it from the Tx queue to the waiting queue, like
+				ulTCPWindowTxGet() does.  pxWindow->ulOurSequenceNumber keeps
+				pointing to the first segment of the packet. */
+				pxSegment = xTCPWindowGetHead( &( pxWindow->xTxQueue ) );
+
+				if( pxWindow->pxHeadSegment == pxSegment )
+				{
+					pxWindow->pxHeadSegment = NULL;
+				}
+
+				pxWindow->tx.ulHighestSequenceNumber = pxSegment->ulSequenceNumber + ( ( uint32_t ) pxSegment->lDataLength );
+
+				vListInsertFifo( &pxWindow->xWaitQueue, &pxSegment->xQueueItem );
+				pxSegment->u.bits.bOutstanding = pdTRUE_UNSIGNED;
+				( pxSegment->u.bits.ucTransmitCount )++;
+				vTCPTimerSet( &( pxSegment->xTransmitTimer ) );
+			}
+		}
+
+		return ulReturn;
+	}
+
+#endif /* ( ipconfigUSE_TCP_WIN == 1 ) && ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 ) */
+/*-----------------------------------------------------------*/
+
 #if( ipconfigUSE_TCP_WIN == 1 )
 
-	static uint32_t prvTCPWindowTxCheckAck( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast )
+	static uint32_t prvTCPWindowTxCheckAck( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast, uint32_t *pulSacked )
 	{
 	uint32_t ulBytesConfirmed = 0U;
 	uint32_t ulSequenceNumber = ulFirst, ulDataLength;
@@ -1503,7 +1796,9 @@ const int32_t l500ms = 500;
 		All TX segments for which
 		( ( ulSequenceNumber >= ulFirst ) && ( ulSequenceNumber < ulLast ) in a
 		contiguous block.  Note that the segments are stored in xTxSegments in a
-		strict sequential order. */
+		strict sequential order.  '*pulSacked' is set to the number of bytes that
+		became acknowledged but can not be freed yet, because they are preceded
+		by missing data. */
 
 		/* SRTT[i] = (1-a) * SRTT[i-1] + a * RTT
 
@@ -1519,6 +1814,8 @@ const int32_t l500ms = 500;
 		 A Smoothed RTT will increase quickly, but it is conservative when
 		 becoming smaller. */
 
+		*pulSacked = 0U;
+
 		pxIterator  = listGET_NEXT( pxEnd );
 		while( ( pxIterator != pxEnd ) && ( xSequenceLessThan( ulSequenceNumber, ulLast ) != 0 ) )
 		{
@@ -1624,6 +1921,12 @@ const int32_t l500ms = 500;
 				xDoUnlink = pdFALSE;
 			}
 
+			if( xDoUnlink != pdFALSE )
+			{
+				/* Acknowledged for the first time, but not freed. */
+				*pulSacked += ulDataLength;
+			}
+
 			if( ( xDoUnlink != pdFALSE ) && ( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) != NULL ) )
 			{
 				/* Remove item from its queues. */
@@ -1640,21 +1943,41 @@ const int32_t l500ms = 500;
 
 #if( ipconfigUSE_TCP_WIN == 1 )
 
-	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow, uint32_t ulFirst )
+	static uint32_t prvTCPWindowFastRetransmit( TCPWindow_t *pxWindow )
 	{
 	const ListItem_t * pxIterator;
 	const ListItem_t * pxEnd;
 	TCPSegment_t *pxSegment;
 	uint32_t ulCount = 0UL;
+	uint32_t ulSackedAbove = 0UL;
 
-		/* A higher Tx block has been acknowledged.  Now iterate through the
-		 xWaitQueue to find a possible condition for a FAST retransmission. */
+		/* A higher Tx block has been acknowledged.  The segments in xTxSegments
+		form the scoreboard: they are sorted on sequence number, and bAcked is
+		set for the ones that were selectively acknowledged.  An outstanding
+		segment is considered lost when at least 3 segments with a higher
+		sequence number have been acknowledged (RFC 6675).  Only these holes
+		are retransmitted. */
+
+		pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &( pxWindow->xTxSegments ) ) );
+
+		/* First count all segments that have been selectively acknowledged. */
+		for( pxIterator  = listGET_NEXT( pxEnd );
+			 pxIterator != pxEnd;
+			 pxIterator  = listGET_NEXT( pxIterator ) )
+		{
+			pxSegment = ipPOINTER_CAST( TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
 
-		pxEnd = ipPOINTER_CAST( const ListItem_t *, listGET_END_MARKER( &( pxWindow->xWaitQueue ) ) );
+			if( pxSegment->u.bits.bAcked != pdFALSE_UNSIGNED )
+			{
+				ulSackedAbove++;
+			}
+		}
 
 		pxIterator  = listGET_NEXT( pxEnd );
 
-		while( pxIterator != pxEnd )
+		/* Once fewer than 3 acknowledged segments are left above the current
+		one, no more losses can be detected. */
+		while( ( pxIterator != pxEnd ) && ( ulSackedAbove >= DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT ) )
 		{
 			/* Get the owner, which is a TCP segment. */
 			pxSegment = ipPOINTER_CAST( TCPSegment_t *, listGET_LIST_ITEM_OWNER( pxIterator ) );
@@ -1662,37 +1985,38 @@ const int32_t l500ms = 500;
 			/* Hop to the next item before the current gets unlinked. */
 			pxIterator  = listGET_NEXT( pxIterator );
 
-			/* Fast retransmission:
-			When 3 packets with a higher sequence number have been acknowledged
-			by the peer, it is very unlikely a current packet will ever arrive.
-			It will be retransmitted far before the RTO. */
-			if( pxSegment->u.bits.bAcked == pdFALSE_UNSIGNED )
+			if( pxSegment->u.bits.bAcked != pdFALSE_UNSIGNED )
+			{
+				ulSackedAbove--;
+			}
+			else if( ( pxSegment->u.bits.ucDupAckCount < DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT ) &&
+					 ( listLIST_ITEM_CONTAINER( &( pxSegment->xQueueItem ) ) == &( pxWindow->xWaitQueue ) ) )
 			{
-				if( xSequenceLessThan( pxSegment->ulSequenceNumber, ulFirst ) != pdFALSE )
+				/* Fast retransmission: the segment was sent and is waiting for
+				an ACK, it will be retransmitted far before the RTO.  Setting
+				'ucDupAckCount' makes sure that it is retransmitted only once,
+				until the RTO clears it. */
+				pxSegment->u.bits.ucDupAckCount = ( uint8_t ) DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT;
+				pxSegment->u.bits.ucTransmitCount = ( uint8_t ) pdFALSE;
+
+				if( ( xTCPWindowLoggingLevel >= 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
 				{
-					pxSegment->u.bits.ucDupAckCount++;
-					if( pxSegment->u.bits.ucDupAckCount == DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT )
-					{
-						pxSegment->u.bits.ucTransmitCount = ( uint8_t ) pdFALSE;
-
-						/* Not clearing 'ucDupAckCount' yet as more SACK's might come in
-						which might lead to a second fast rexmit. */
-						if( ( xTCPWindowLoggingLevel >= 0 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
-						{
-							FreeRTOS_debug_printf( ( "prvTCPWindowFastRetransmit: Requeue sequence number %lu < %lu\n",
-								pxSegment->ulSequenceNumber - pxWindow->tx.ulFirstSequenceNumber,
-								ulFirst - pxWindow->tx.ulFirstSequenceNumber ) );
-							FreeRTOS_flush_logging( );
-						}
-
-						/* Remove it from xWaitQueue. */
-						( void ) uxListRemove( &pxSegment->xQueueItem );
-						/* Add this segment to the priority queue so it gets
-						retransmitted immediately. */
-						vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
-						ulCount++;
-					}
+					FreeRTOS_debug_printf( ( "prvTCPWindowFastRetransmit: Requeue sequence number %lu (%lu SACK'd above)\n",
+						pxSegment->ulSequenceNumber - pxWindow->tx.ulFirstSequenceNumber,
+						ulSackedAbove ) );
+					FreeRTOS_flush_logging( );
 				}
+
+				/* Remove it from xWaitQueue. */
+				( void ) uxListRemove( &pxSegment->xQueueItem );
+				/* Add this segment to the priority queue so it gets
+				retransmitted immediately. */
+				vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+				ulCount++;
+			}
+			else
+			{
+				/* Not sent yet, or already being retransmitted. */
 			}
 		}
 
@@ -1705,7 +2029,8 @@ const int32_t l500ms = 500;
 
 	uint32_t ulTCPWindowTxAck( TCPWindow_t *pxWindow, uint32_t ulSequenceNumber )
 	{
-	uint32_t ulFirstSequence, ulReturn;
+	uint32_t ulFirstSequence, ulReturn, ulSacked;
+	uint32_t ulFlightSize = prvTCPWindowTxFlightSize( pxWindow );
 
 		/* Receive a normal ACK. */
 
@@ -1717,7 +2042,17 @@ const int32_t l500ms = 500;
 		}
 		else
 		{
-			ulReturn = prvTCPWindowTxCheckAck( pxWindow, ulFirstSequence, ulSequenceNumber );
+			ulReturn = prvTCPWindowTxCheckAck( pxWindow, ulFirstSequence, ulSequenceNumber, &ulSacked );
+
+			#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+			{
+				prvCongestionOnAck( pxWindow, ulReturn, ulFlightSize );
+			}
+			#else
+			{
+				( void ) ulFlightSize;
+			}
+			#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
 		}
 
 		return ulReturn;
@@ -1730,12 +2065,29 @@ const int32_t l500ms = 500;
 
 	uint32_t ulTCPWindowTxSack( TCPWindow_t *pxWindow, uint32_t ulFirst, uint32_t ulLast )
 	{
-	uint32_t ulAckCount;
+	uint32_t ulAckCount, ulSacked, ulRetransmits;
 	uint32_t ulCurrentSequenceNumber = pxWindow->tx.ulCurrentSequenceNumber;
+	uint32_t ulFlightSize = prvTCPWindowTxFlightSize( pxWindow );
 
 		/* Receive a SACK option. */
-		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast );
-		( void ) prvTCPWindowFastRetransmit( pxWindow, ulFirst );
+		ulAckCount = prvTCPWindowTxCheckAck( pxWindow, ulFirst, ulLast, &ulSacked );
+		ulRetransmits = prvTCPWindowFastRetransmit( pxWindow );
+
+		#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+		{
+			if( ulAckCount != 0U )
+			{
+				prvCongestionOnAck( pxWindow, ulAckCount, ulFlightSize );
+			}
+
+			prvCongestionOnSack( pxWindow, ulSacked, ulFlightSize, ulRetransmits );
+		}
+		#else
+		{
+			( void ) ulFlightSize;
+			( void ) ulRetransmits;
+		}
+		#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
 
 		if( ( xTCPWindowLoggingLevel >= 1 ) && ( xSequenceGreaterThan( ulFirst, ulCurrentSequenceNumber ) != pdFALSE ) )
 		{
@@ -1754,6 +2106,459 @@ const int32_t l500ms = 500;
 #endif /* ipconfigUSE_TCP_WIN == 1 */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP_WIN == 1 )
+
+	static uint32_t prvTCPWindowTxFlightSize( const TCPWindow_t *pxWindow )
+	{
+	uint32_t ulFlightSize;
+
+		if( xSequenceGreaterThanOrEqual( pxWindow->tx.ulHighestSequenceNumber, pxWindow->tx.ulCurrentSequenceNumber ) != pdFALSE )
+		{
+			ulFlightSize = pxWindow->tx.ulHighestSequenceNumber - pxWindow->tx.ulCurrentSequenceNumber;
+		}
+		else
+		{
+			ulFlightSize = 0UL;
+		}
+
+		return ulFlightSize;
+	}
+
+#endif /* ipconfigUSE_TCP_WIN == 1 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	BaseType_t xTCPWindowSetCongestion( TCPWindow_t *pxWindow, BaseType_t xAlgorithm )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	BaseType_t xReturn = pdPASS;
+
+		switch( xAlgorithm )
+		{
+			case FREERTOS_TCP_CC_NEWRENO:
+				pxCongestion->pxOps = &xNewRenoOps;
+				break;
+
+		#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+			case FREERTOS_TCP_CC_CUBIC:
+				pxCongestion->pxOps = &xCubicOps;
+				/* Start a new curve at the next ACK. */
+				pxCongestion->xEpochStarted = pdFALSE;
+				break;
+		#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+
+			default:
+				xReturn = pdFAIL;
+				break;
+		}
+
+		if( xReturn != pdFAIL )
+		{
+			pxCongestion->xAlgorithm = xAlgorithm;
+		}
+
+		return xReturn;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvCongestionInit( TCPWindow_t *pxWindow )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		if( ulMSS == 0U )
+		{
+			ulMSS = ( uint32_t ) ipconfigTCP_MSS;
+		}
+
+		/* A socket option may have chosen the algorithm already.  The values of
+		ipconfigTCP_CONGESTION_CONTROL are those of FREERTOS_TCP_CC_xxx. */
+		if( pxCongestion->pxOps == NULL )
+		{
+			( void ) xTCPWindowSetCongestion( pxWindow, ( BaseType_t ) ipconfigTCP_CONGESTION_CONTROL );
+		}
+
+		pxCongestion->ulCWnd = FreeRTOS_min_uint32( 4U * ulMSS, FreeRTOS_max_uint32( 2U * ulMSS, winCC_INITIAL_WINDOW_BYTES ) );
+		pxCongestion->ulSSThresh = winCC_MAX_WINDOW;
+		pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+		pxCongestion->ulAckedBytes = 0U;
+		pxCongestion->ulFastRecoveries = 0U;
+		pxCongestion->ulTimeouts = 0U;
+		pxCongestion->ucRecovery = ( uint8_t ) winCC_RECOVERY_NONE;
+
+		#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+		{
+			pxCongestion->xEpochStarted = pdFALSE;
+			pxCongestion->ulWMax = 0U;
+		}
+		#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static uint32_t prvCongestionWindow( const TCPWindow_t *pxWindow )
+	{
+		/* One segment may always be outstanding. */
+		return FreeRTOS_max_uint32( pxWindow->xCongestion.ulCWnd, ( uint32_t ) pxWindow->usMSS );
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvCongestionOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked, uint32_t ulFlightSize )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		/* 'ulAcked' bytes at the head of the transmission window were
+		acknowledged, while 'ulFlightSize' bytes were outstanding. */
+		if( ulAcked == 0U )
+		{
+			/* Nothing new was acknowledged. */
+		}
+		else if( ( pxCongestion->ucRecovery != ( uint8_t ) winCC_RECOVERY_NONE ) &&
+				 ( xSequenceGreaterThanOrEqual( pxWindow->tx.ulCurrentSequenceNumber, pxCongestion->ulRecover ) != pdFALSE ) )
+		{
+			/* All data that was outstanding when the loss was detected has now
+			been acknowledged. */
+			if( pxCongestion->ucRecovery == ( uint8_t ) winCC_RECOVERY_FAST )
+			{
+				/* Deflate the window that was inflated during fast recovery. */
+				pxCongestion->ulCWnd = pxCongestion->ulSSThresh;
+			}
+
+			pxCongestion->ucRecovery = ( uint8_t ) winCC_RECOVERY_NONE;
+			pxCongestion->ulAckedBytes = 0U;
+		}
+		else if( pxCongestion->ucRecovery == ( uint8_t ) winCC_RECOVERY_FAST )
+		{
+			/* A partial ACK (RFC 6582): deflate the window by the amount of new
+			data acknowledged, add back one MSS, and retransmit the first
+			unacknowledged segment, which must have been lost as well. */
+			pxCongestion->ulCWnd -= FreeRTOS_min_uint32( pxCongestion->ulCWnd, ulAcked );
+			if( ulAcked >= ulMSS )
+			{
+				pxCongestion->ulCWnd += ulMSS;
+			}
+
+			prvTCPWindowTxRetransmitFirst( pxWindow );
+		}
+		else if( ( 2U * ulFlightSize ) < pxCongestion->ulCWnd )
+		{
+			/* Less than half of the window was in use, the application is the
+			limit.  Growing it would not be validated by the network (RFC 7661). */
+		}
+		else if( pxCongestion->ulCWnd < pxCongestion->ulSSThresh )
+		{
+			/* Slow start, with appropriate byte counting (RFC 3465). */
+			pxCongestion->ulCWnd += FreeRTOS_min_uint32( ulAcked, winCC_SLOW_START_SEGMENTS * ulMSS );
+		}
+		else
+		{
+			/* Congestion avoidance. */
+			pxCongestion->pxOps->fnOnAck( pxWindow, ulAcked );
+		}
+
+		pxCongestion->ulCWnd = FreeRTOS_max_uint32( pxCongestion->ulCWnd, ulMSS );
+		pxCongestion->ulCWnd = FreeRTOS_min_uint32( pxCongestion->ulCWnd, winCC_MAX_WINDOW );
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvCongestionOnSack( TCPWindow_t *pxWindow, uint32_t ulSacked, uint32_t ulFlightSize, uint32_t ulRetransmits )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+
+		if( ( ulRetransmits != 0U ) && ( pxCongestion->ucRecovery == ( uint8_t ) winCC_RECOVERY_NONE ) )
+		{
+			/* A fast retransmission: enter fast recovery.  The segments that
+			left the network while the loss was detected are added to the
+			reduced window. */
+			pxCongestion->pxOps->fnOnLoss( pxWindow, ulFlightSize, pdFALSE );
+			pxCongestion->ulCWnd = pxCongestion->ulSSThresh + ( ( uint32_t ) DUPLICATE_ACKS_BEFORE_FAST_RETRANSMIT * ulMSS );
+			pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+			pxCongestion->ulAckedBytes = 0U;
+			pxCongestion->ucRecovery = ( uint8_t ) winCC_RECOVERY_FAST;
+			pxCongestion->ulFastRecoveries++;
+
+			if( ( xTCPWindowLoggingLevel >= 1 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
+			{
+				FreeRTOS_debug_printf( ( "prvCongestionOnSack[%u]: fast recovery, cwnd %lu ssthresh %lu\n",
+					pxWindow->usPeerPortNumber,
+					pxCongestion->ulCWnd,
+					pxCongestion->ulSSThresh ) );
+			}
+		}
+		else if( pxCongestion->ucRecovery == ( uint8_t ) winCC_RECOVERY_FAST )
+		{
+			/* Data selectively acknowledged has left the network: inflate the
+			window so that new data can be sent. */
+			pxCongestion->ulCWnd = FreeRTOS_min_uint32( pxCongestion->ulCWnd + ulSacked, winCC_MAX_WINDOW );
+		}
+		else
+		{
+			/* Nothing to do. */
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvCongestionOnTimeout( TCPWindow_t *pxWindow, BaseType_t xRepeated )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		/* 'xRepeated' is true when the segment had been retransmitted before. */
+		if( pxCongestion->ucRecovery != ( uint8_t ) winCC_RECOVERY_TIMEOUT )
+		{
+			if( pxCongestion->ucRecovery == ( uint8_t ) winCC_RECOVERY_NONE )
+			{
+				pxCongestion->pxOps->fnOnLoss( pxWindow, prvTCPWindowTxFlightSize( pxWindow ), pdTRUE );
+			}
+
+			/* Slow start from one segment, until all data that is outstanding
+			now has been acknowledged. */
+			pxCongestion->ulCWnd = ( uint32_t ) pxWindow->usMSS;
+			pxCongestion->ulRecover = pxWindow->tx.ulHighestSequenceNumber;
+			pxCongestion->ulAckedBytes = 0U;
+			pxCongestion->ucRecovery = ( uint8_t ) winCC_RECOVERY_TIMEOUT;
+			pxCongestion->ulTimeouts++;
+
+			if( ( xTCPWindowLoggingLevel >= 1 ) && ( ipconfigTCP_MAY_LOG_PORT( pxWindow->usOurPortNumber ) ) )
+			{
+				FreeRTOS_debug_printf( ( "prvCongestionOnTimeout[%u]: slow start, ssthresh %lu\n",
+					pxWindow->usPeerPortNumber,
+					pxCongestion->ulSSThresh ) );
+			}
+		}
+		else if( xRepeated != pdFALSE )
+		{
+			/* The retransmission got lost as well. */
+			pxCongestion->ulCWnd = ( uint32_t ) pxWindow->usMSS;
+		}
+		else
+		{
+			/* Other segments from the same window timing out. */
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvTCPWindowTxRetransmitFirst( TCPWindow_t *pxWindow )
+	{
+	TCPSegment_t *pxSegment;
+
+		/* Move the oldest outstanding segment to the priority queue. */
+		pxSegment = xTCPWindowGetHead( &( pxWindow->xWaitQueue ) );
+
+		if( ( pxSegment != NULL ) && ( pxSegment->ulSequenceNumber == pxWindow->tx.ulCurrentSequenceNumber ) )
+		{
+			pxSegment->u.bits.ucTransmitCount = ( uint8_t ) pdFALSE;
+			( void ) uxListRemove( &pxSegment->xQueueItem );
+			vListInsertFifo( &( pxWindow->xPriorityQueue ), &( pxSegment->xQueueItem ) );
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvNewRenoOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize, BaseType_t xTimeout )
+	{
+		( void ) xTimeout;
+
+		/* Half of the data in flight, but at least 2 segments (RFC 5681). */
+		pxWindow->xCongestion.ulSSThresh = FreeRTOS_max_uint32( ulFlightSize / 2U, 2U * ( uint32_t ) pxWindow->usMSS );
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL != 0 )
+
+	static void prvNewRenoOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+
+		/* Grow by one MSS per window of data acknowledged. */
+		pxCongestion->ulAckedBytes += ulAcked;
+
+		if( pxCongestion->ulAckedBytes >= pxCongestion->ulCWnd )
+		{
+			pxCongestion->ulAckedBytes -= pxCongestion->ulCWnd;
+			pxCongestion->ulCWnd += ( uint32_t ) pxWindow->usMSS;
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL != 0 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+
+	static uint32_t ulCubicRoot( uint64_t ullValue )
+	{
+	uint64_t ullRemainder = ullValue;
+	uint64_t ullRoot = 0U;
+	uint64_t ullTerm;
+	int32_t lShift;
+
+		/* Integer cube root, one bit at a time.  The comparison is done after
+		shifting the remainder, so the shifted term can not overflow. */
+		for( lShift = 63; lShift >= 0; lShift -= 3 )
+		{
+			ullRoot <<= 1U;
+			ullTerm = ( 3U * ullRoot * ( ullRoot + 1U ) ) + 1U;
+			if( ( ullRemainder >> lShift ) >= ullTerm )
+			{
+				ullRemainder -= ullTerm << lShift;
+				ullRoot++;
+			}
+		}
+
+		return ( uint32_t ) ullRoot;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+
+	static void prvCubicOnLoss( TCPWindow_t *pxWindow, uint32_t ulFlightSize, BaseType_t xTimeout )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulCWnd = pxCongestion->ulCWnd;
+
+		( void ) ulFlightSize;
+		( void ) xTimeout;
+
+		/* Fast convergence: when the window did not reach its previous maximum,
+		bandwidth is being shared with new flows, so give some up. */
+		if( ulCWnd < pxCongestion->ulWMax )
+		{
+			pxCongestion->ulWMax = ( uint32_t ) ( ( ( uint64_t ) ulCWnd * ( winCUBIC_SCALE + winCUBIC_BETA ) ) / ( 2U * winCUBIC_SCALE ) );
+		}
+		else
+		{
+			pxCongestion->ulWMax = ulCWnd;
+		}
+
+		pxCongestion->ulSSThresh = FreeRTOS_max_uint32( ( uint32_t ) ( ( ( uint64_t ) ulCWnd * winCUBIC_BETA ) / winCUBIC_SCALE ),
+														2U * ( uint32_t ) pxWindow->usMSS );
+		pxCongestion->xEpochStarted = pdFALSE;
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+/*-----------------------------------------------------------*/
+
+#if( ipconfigTCP_CONGESTION_CONTROL == 2 )
+
+	static void prvCubicOnAck( TCPWindow_t *pxWindow, uint32_t ulAcked )
+	{
+	TCPCongestion_t *pxCongestion = &( pxWindow->xCongestion );
+	uint32_t ulMSS = ( uint32_t ) pxWindow->usMSS;
+	uint32_t ulNow = ( uint32_t ) ( xTaskGetTickCount() * portTICK_PERIOD_MS );
+	uint32_t ulTime, ulDistance, ulTarget;
+	uint64_t ullDelta;
+
+		if( pxCongestion->xEpochStarted == pdFALSE )
+		{
+			/* The first ACK in congestion avoidance after a loss: start the
+			curve that reaches ulWMax after ulK ms. */
+			pxCongestion->xEpochStarted = pdTRUE;
+			pxCongestion->ulEpochStart = ulNow;
+			pxCongestion->ulAckedBytes = 0U;
+			pxCongestion->ulWEst = pxCongestion->ulCWnd;
+
+			if( pxCongestion->ulCWnd < pxCongestion->ulWMax )
+			{
+				pxCongestion->ulK = ulCubicRoot( ( ( uint64_t ) ( pxCongestion->ulWMax - pxCongestion->ulCWnd ) * winCUBIC_INV_C_MS3 ) / ulMSS );
+				pxCongestion->ulOrigin = pxCongestion->ulWMax;
+			}
+			else
+			{
+				pxCongestion->ulK = 0U;
+				pxCongestion->ulOrigin = pxCongestion->ulCWnd;
+			}
+		}
+
+		/* Aim at the value the curve will have one round-trip from now. */
+		ulTime = ( ulNow - pxCongestion->ulEpochStart ) + ( uint32_t ) pxWindow->lSRTT;
+
+		if( ulTime < pxCongestion->ulK )
+		{
+			ulDistance = pxCongestion->ulK - ulTime;
+		}
+		else
+		{
+			ulDistance = ulTime - pxCongestion->ulK;
+		}
+
+		ulDistance = FreeRTOS_min_uint32( ulDistance, winCUBIC_MAX_T_MS );
+
+		/* MSS * t^3 / 2.5e9, divided in two steps to stay within 64 bits. */
+		ullDelta = ( ( uint64_t ) ulDistance * ulDistance * ulDistance ) / 1000U;
+		ullDelta = ( ullDelta * ulMSS ) / ( winCUBIC_INV_C_MS3 / 1000U );
+		ullDelta = ( ullDelta < ( uint64_t ) winCC_MAX_WINDOW ) ? ullDelta : ( uint64_t ) winCC_MAX_WINDOW;
+
+		if( ulTime < pxCongestion->ulK )
+		{
+			ulTarget = pxCongestion->ulOrigin - FreeRTOS_min_uint32( ( uint32_t ) ullDelta, pxCongestion->ulOrigin );
+		}
+		else
+		{
+			ulTarget = FreeRTOS_min_uint32( pxCongestion->ulOrigin + ( uint32_t ) ullDelta, winCC_MAX_WINDOW );
+		}
+
+		if( ulTarget > pxCongestion->ulCWnd )
+		{
+			/* Move towards the target, but at most by half a window per RTT. */
+			ulTarget = FreeRTOS_min_uint32( ulTarget, pxCongestion->ulCWnd + ( pxCongestion->ulCWnd / 2U ) );
+			pxCongestion->ulCWnd += ( uint32_t ) ( ( ( uint64_t ) ( ulTarget - pxCongestion->ulCWnd ) * ulAcked ) / pxCongestion->ulCWnd );
+		}
+		else
+		{
+			/* Close to the plateau: grow very slowly. */
+			pxCongestion->ulAckedBytes += ulAcked;
+
+			if( ( pxCongestion->ulAckedBytes / winCUBIC_SLOW_GROWTH ) >= pxCongestion->ulCWnd )
+			{
+				pxCongestion->ulAckedBytes = 0U;
+				pxCongestion->ulCWnd += ulMSS;
+			}
+		}
+
+		/* The TCP friendly region: never be slower than Reno would be. */
+		pxCongestion->ulWEst += ( uint32_t ) ( ( winCUBIC_ALPHA * ulMSS * ulAcked ) / ( winCUBIC_SCALE * pxCongestion->ulCWnd ) );
+
+		if( pxCongestion->ulWEst > pxCongestion->ulCWnd )
+		{
+			pxCongestion->ulCWnd = pxCongestion->ulWEst;
+		}
+	}
+
+#endif /* ipconfigTCP_CONGESTION_CONTROL == 2 */
+/*-----------------------------------------------------------*/
+
 /*
 #####   #                      #####   ####  ######
 # # #   #                      # # #  #    #  #    #
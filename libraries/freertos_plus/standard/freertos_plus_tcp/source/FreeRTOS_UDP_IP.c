@@ -263,6 +263,17 @@ const UDPPacket_t *pxUDPPacket = ipPOINTER_CAST( const UDPPacket_t *, pxNetworkB
 	/* Caller must check for minimum packet size. */
 	pxSocket = pxUDPSocketLookup( usPort );
 
+	#if( ipconfigDNS_ASYNC_RESOLVER != 0 )
+	{
+		if( ( pxSocket != NULL ) && ( xIsDNSResolverSocket( ( Socket_t ) pxSocket ) != pdFALSE ) )
+		{
+			/* Nobody reads from the shared DNS socket: its replies are parsed
+			below, in the same way as replies to a socket that was closed. */
+			pxSocket = NULL;
+		}
+	}
+	#endif /* ipconfigDNS_ASYNC_RESOLVER */
+
 	if( pxSocket != NULL )
 	{
 
@@ -330,29 +341,59 @@ const UDPPacket_t *pxUDPPacket = ipPOINTER_CAST( const UDPPacket_t *, pxNetworkB
 			}
 			( void ) xTaskResumeAll();
 
-			/* Set the socket's receive event */
-			if( pxSocket->xEventGroup != NULL )
+			#if( ipconfigIP_TASK_EVENT_BATCH > 1 )
 			{
-				( void ) xEventGroupSetBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_RECEIVE );
-			}
+				/* Collect the events, the owner of the socket will be woken up
+				once, after the IP-task has handled its current batch of
+				events. */
+				pxSocket->xEventBits |= ( EventBits_t ) eSOCKET_RECEIVE;
 
-			#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
-			{
-				if( ( pxSocket->pxSocketSet != NULL ) && ( ( pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_READ ) ) != 0U ) )
+				#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 				{
-					( void ) xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, ( EventBits_t ) eSELECT_READ );
+					if( ( pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_READ ) ) != 0U )
+					{
+						pxSocket->xEventBits |= ( ( EventBits_t ) eSELECT_READ ) << SOCKET_EVENT_BIT_COUNT;
+					}
 				}
-			}
-			#endif
+				#endif
 
-			#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
+				vSocketWakeUpLater( pxSocket );
+			}
+			#else
 			{
-				if( pxSocket->pxUserSemaphore != NULL )
+				/* Set the socket's receive event */
+				if( pxSocket->xEventGroup != NULL )
+				{
+					( void ) xEventGroupSetBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_RECEIVE );
+				}
+
+				#if( ipconfigSUPPORT_SELECT_FUNCTION == 1 )
 				{
-					( void ) xSemaphoreGive( pxSocket->pxUserSemaphore );
+					if( ( pxSocket->pxSocketSet != NULL ) && ( ( pxSocket->xSelectBits & ( ( EventBits_t ) eSELECT_READ ) ) != 0U ) )
+					{
+						#if( ipconfigSELECT_USES_READY_LIST != 0 )
+						{
+							vSocketSetReady( pxSocket, ( EventBits_t ) eSELECT_READ );
+						}
+						#else
+						{
+							( void ) xEventGroupSetBits( pxSocket->pxSocketSet->xSelectGroup, ( EventBits_t ) eSELECT_READ );
+						}
+						#endif /* ipconfigSELECT_USES_READY_LIST */
+					}
 				}
+				#endif
+
+				#if( ipconfigSOCKET_HAS_USER_SEMAPHORE == 1 )
+				{
+					if( pxSocket->pxUserSemaphore != NULL )
+					{
+						( void ) xSemaphoreGive( pxSocket->pxUserSemaphore );
+					}
+				}
+				#endif
 			}
-			#endif
+			#endif /* ipconfigIP_TASK_EVENT_BATCH */
 
 			#if( ipconfigUSE_DHCP == 1 )
 			{
@@ -0,0 +1,763 @@
+/*
+ * FreeRTOS+TCP V2.3.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/******************************************************************************
+ *
+ * See the following web page for essential buffer allocation scheme usage and
+ * configuration details:
+ * http://www.FreeRTOS.org/FreeRTOS-Plus/FreeRTOS_Plus_TCP/Embedded_Ethernet_Buffer_Management.html
+ *
+ ******************************************************************************/
+
+/* This scheme sits between BufferAllocation_1.c and BufferAllocation_2.c.  The
+storage of the network buffers is allocated statically, like in scheme 1, but in
+three pools of different sizes: a small one for ACK's, ARP and other short
+packets, a medium one, and a large one that can hold a complete Ethernet frame.
+A network buffer gets a block from the smallest pool that can hold the requested
+size, or from a bigger pool when that one is exhausted.  Like in scheme 2, the
+size of a network buffer may be increased with
+pxResizeNetworkBufferWithDescriptor().  pvPortMalloc() is never called, so the
+heap can not get fragmented, and the pools can be accessed from an ISR. */
+
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_UDP_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* The obtained network buffer must be large enough to hold a packet that might
+replace the packet that was requested to be sent. */
+#if ipconfigUSE_TCP == 1
+	#define baMINIMAL_BUFFER_SIZE		sizeof( TCPPacket_t )
+#else
+	#define baMINIMAL_BUFFER_SIZE		sizeof( ARPPacket_t )
+#endif /* ipconfigUSE_TCP == 1 */
+
+/* For an Ethernet interrupt to be able to obtain a network buffer there must
+be at least this number of buffers available. */
+#define baINTERRUPT_BUFFER_GET_THRESHOLD	( 3 )
+
+/* The sizes and the number of blocks of the pools, which may be overridden in
+FreeRTOSIPConfig.h.  A size is the number of bytes available to the Ethernet
+frame.  The large pool always holds complete Ethernet frames.  A pool may have
+zero blocks, but the large pool must have at least one. */
+#ifndef ipconfigBUFFER_POOL_SMALL_SIZE
+	#define ipconfigBUFFER_POOL_SMALL_SIZE		( 128U )
+#endif
+
+#ifndef ipconfigBUFFER_POOL_SMALL_COUNT
+	#define ipconfigBUFFER_POOL_SMALL_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+#ifndef ipconfigBUFFER_POOL_MEDIUM_SIZE
+	#define ipconfigBUFFER_POOL_MEDIUM_SIZE		( 512U )
+#endif
+
+#ifndef ipconfigBUFFER_POOL_MEDIUM_COUNT
+	#define ipconfigBUFFER_POOL_MEDIUM_COUNT	( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#endif
+
+#ifndef ipconfigBUFFER_POOL_LARGE_COUNT
+	#define ipconfigBUFFER_POOL_LARGE_COUNT		( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#endif
+
+#if( ipconfigBUFFER_POOL_LARGE_COUNT < 1 )
+	#error ipconfigBUFFER_POOL_LARGE_COUNT must be at least 1
+#endif
+
+/* Round up to a multiple of 8 bytes, so that all blocks are well aligned. */
+#define baROUND_UP( xSize )				( ( ( size_t ) ( xSize ) + 7U ) & ~( ( size_t ) 7U ) )
+
+/* The size of a large block: a complete Ethernet frame, plus the 2 bytes that
+are added to every request (see prvNormalisedSize()). */
+#define baLARGE_BUFFER_SIZE				baROUND_UP( ipTOTAL_ETHERNET_FRAME_SIZE + 2U )
+
+/* Each block starts with ipBUFFER_PADDING bytes, which hold a pointer to the
+network buffer descriptor that owns the block.  While a block is free, it holds
+a pointer to the next free block of the pool. */
+#define baBLOCK_SIZE( xBufferSize )		baROUND_UP( ipBUFFER_PADDING + ( xBufferSize ) )
+
+#define baPOOL_BYTES( xBufferSize, xCount ) ( baBLOCK_SIZE( xBufferSize ) * ( size_t ) ( xCount ) )
+
+#define baTOTAL_POOL_BYTES				( baPOOL_BYTES( ipconfigBUFFER_POOL_SMALL_SIZE, ipconfigBUFFER_POOL_SMALL_COUNT ) + \
+										  baPOOL_BYTES( ipconfigBUFFER_POOL_MEDIUM_SIZE, ipconfigBUFFER_POOL_MEDIUM_COUNT ) + \
+										  baPOOL_BYTES( baLARGE_BUFFER_SIZE, ipconfigBUFFER_POOL_LARGE_COUNT ) )
+
+/* The number of pools: small, medium and large. */
+#define baNUM_POOLS						( 3 )
+
+/*_RB_ This is too complex not to have an explanation. */
+#define ASSERT_CONCAT_(a, b) a##b
+#define ASSERT_CONCAT(a, b) ASSERT_CONCAT_(a, b)
+#define STATIC_ASSERT(e) \
+	;enum { ASSERT_CONCAT(assert_line_, __LINE__) = 1/(!!(e)) }
+
+/* A pointer to the next free block is stored in the padding area. */
+STATIC_ASSERT( ipBUFFER_PADDING >= sizeof( void * ) );
+/* The pools must be given in increasing size. */
+STATIC_ASSERT( ipconfigBUFFER_POOL_SMALL_SIZE <= ipconfigBUFFER_POOL_MEDIUM_SIZE );
+STATIC_ASSERT( ipconfigBUFFER_POOL_MEDIUM_SIZE <= baLARGE_BUFFER_SIZE );
+
+#if defined( ipconfigETHERNET_MINIMUM_PACKET_BYTES )
+	STATIC_ASSERT( ipconfigETHERNET_MINIMUM_PACKET_BYTES <= baMINIMAL_BUFFER_SIZE );
+#endif
+
+typedef struct xBUFFER_POOL
+{
+	uint8_t *pucFirstFree;			/* The first free block, or NULL when the pool is exhausted. */
+	const uint8_t *pucFirstBlock;	/* The pool occupies the memory from pucFirstBlock up to, but not */
+	const uint8_t *pucBeyondBlocks;	/* including, pucBeyondBlocks. */
+	size_t uxBufferSize;			/* The number of bytes in a block available to the Ethernet frame. */
+	size_t uxBlockSize;				/* The distance between two blocks. */
+	UBaseType_t uxFreeCount;		/* The number of blocks in the free list. */
+} BufferPool_t;
+
+/* A list of free (available) NetworkBufferDescriptor_t structures. */
+static List_t xFreeBuffersList;
+
+/* Some statistics about the use of buffers. */
+static UBaseType_t uxMinimumFreeNetworkBuffers = 0U;
+
+/* Declares the pool of NetworkBufferDescriptor_t structures that are available
+to the system.  All the network buffers referenced from xFreeBuffersList exist
+in this array.  The array is not accessed directly except during initialisation,
+when the xFreeBuffersList is filled (as all the buffers are free when the system
+is booted). */
+static NetworkBufferDescriptor_t xNetworkBufferDescriptors[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ];
+
+/* The storage of all blocks.  Declared as an array of 64-bit words to have it
+aligned on an 8-byte boundary. */
+static uint64_t ullPoolStorage[ baTOTAL_POOL_BYTES / sizeof( uint64_t ) ];
+
+/* The pools, ordered from small to large. */
+static BufferPool_t xBufferPools[ baNUM_POOLS ];
+
+/* This constant is defined as false to let FreeRTOS_TCP_IP.c know that the
+network buffers have a variable size: resizing may be necessary */
+const BaseType_t xBufferAllocFixedSize = pdFALSE;
+
+/* The semaphore used to obtain network buffers. */
+static SemaphoreHandle_t xNetworkBufferSemaphore = NULL;
+
+/* The user can define their own ipconfigBUFFER_ALLOC_LOCK() and
+ipconfigBUFFER_ALLOC_UNLOCK() macros, especially for use form an ISR.  If these
+are not defined then default them to call the normal enter/exit critical
+section macros. */
+#if !defined( ipconfigBUFFER_ALLOC_LOCK )
+
+	#define ipconfigBUFFER_ALLOC_INIT( ) do {} while ( ipFALSE_BOOL )
+	#define ipconfigBUFFER_ALLOC_LOCK_FROM_ISR()		\
+		UBaseType_t uxSavedInterruptStatus = ( UBaseType_t ) portSET_INTERRUPT_MASK_FROM_ISR(); \
+		{
+
+	#define ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR()		\
+			portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus ); \
+		}
+
+	#define ipconfigBUFFER_ALLOC_LOCK()					taskENTER_CRITICAL()
+	#define ipconfigBUFFER_ALLOC_UNLOCK()				taskEXIT_CRITICAL()
+
+#endif /* ipconfigBUFFER_ALLOC_LOCK */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Apply the minimum size and the rounding to a requested number of bytes.
+ * A request of zero bytes remains zero.
+ */
+static size_t prvNormalisedSize( size_t xRequestedSizeBytes );
+
+/*
+ * Take a block of at least uxSize bytes from the smallest pool that has one
+ * available.  Returns the start of the block, or NULL.  Must be called with
+ * the buffer allocation lock taken.
+ */
+static uint8_t *prvPoolTake( size_t uxSize );
+
+/*
+ * Return a block to its pool.  Must be called with the buffer allocation lock
+ * taken.
+ */
+static void prvPoolGive( uint8_t *pucBlock );
+
+/*
+ * Find the pool to which a block belongs.
+ */
+static BufferPool_t *prvPoolOf( const uint8_t *pucBlock );
+
+/*
+ * Latch the lowest number of buffers that could be obtained since booting.
+ */
+static void prvUpdateMinimumFree( void );
+
+/*-----------------------------------------------------------*/
+
+static size_t prvNormalisedSize( size_t xRequestedSizeBytes )
+{
+size_t xSize = xRequestedSizeBytes;
+
+	if( xSize != 0U )
+	{
+		if( xSize < ( size_t ) baMINIMAL_BUFFER_SIZE )
+		{
+			/* ARP packets can replace application packets, so the storage must be
+			at least large enough to hold an ARP. */
+			xSize = baMINIMAL_BUFFER_SIZE;
+		}
+
+		/* Add 2 bytes to xSize and round it up to the nearest multiple of N
+		bytes, where N equals 'sizeof( size_t )', like BufferAllocation_2.c
+		does. */
+		xSize += 2U;
+		if( ( xSize & ( sizeof( size_t ) - 1U ) ) != 0U )
+		{
+			xSize = ( xSize | ( sizeof( size_t ) - 1U ) ) + 1U;
+		}
+	}
+
+	return xSize;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t *prvPoolTake( size_t uxSize )
+{
+uint8_t *pucBlock = NULL;
+BaseType_t xIndex;
+
+	for( xIndex = 0; xIndex < baNUM_POOLS; xIndex++ )
+	{
+	BufferPool_t *pxPool = &( xBufferPools[ xIndex ] );
+
+		if( ( pxPool->uxBufferSize >= uxSize ) && ( pxPool->pucFirstFree != NULL ) )
+		{
+			pucBlock = pxPool->pucFirstFree;
+			pxPool->pucFirstFree = *( ( uint8_t ** ) pucBlock );
+			pxPool->uxFreeCount--;
+			break;
+		}
+	}
+
+	return pucBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolGive( uint8_t *pucBlock )
+{
+BufferPool_t *pxPool = prvPoolOf( pucBlock );
+
+	configASSERT( pxPool != NULL );
+
+	if( pxPool != NULL )
+	{
+		*( ( uint8_t ** ) pucBlock ) = pxPool->pucFirstFree;
+		pxPool->pucFirstFree = pucBlock;
+		pxPool->uxFreeCount++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BufferPool_t *prvPoolOf( const uint8_t *pucBlock )
+{
+BufferPool_t *pxResult = NULL;
+BaseType_t xIndex;
+
+	for( xIndex = 0; xIndex < baNUM_POOLS; xIndex++ )
+	{
+	BufferPool_t *pxPool = &( xBufferPools[ xIndex ] );
+
+		if( ( pucBlock >= pxPool->pucFirstBlock ) && ( pucBlock < pxPool->pucBeyondBlocks ) )
+		{
+			pxResult = pxPool;
+			break;
+		}
+	}
+
+	return pxResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateMinimumFree( void )
+{
+UBaseType_t uxCount = uxGetNumberOfFreeNetworkBuffers();
+
+	if( uxMinimumFreeNetworkBuffers > uxCount )
+	{
+		uxMinimumFreeNetworkBuffers = uxCount;
+	}
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkBuffersInitialise( void )
+{
+BaseType_t xReturn, x;
+
+	/* Only initialise the buffers and their associated kernel objects if they
+	have not been initialised before. */
+	if( xNetworkBufferSemaphore == NULL )
+	{
+		/* In case alternative locking is used, the mutexes can be initialised
+		here */
+		ipconfigBUFFER_ALLOC_INIT();
+
+		xNetworkBufferSemaphore = xSemaphoreCreateCounting( ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, ( UBaseType_t ) ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS );
+		configASSERT( xNetworkBufferSemaphore != NULL );
+
+		if( xNetworkBufferSemaphore != NULL )
+		{
+		const size_t uxBufferSizes[ baNUM_POOLS ] =
+		{
+			baROUND_UP( ipconfigBUFFER_POOL_SMALL_SIZE ),
+			baROUND_UP( ipconfigBUFFER_POOL_MEDIUM_SIZE ),
+			baLARGE_BUFFER_SIZE
+		};
+		const UBaseType_t uxBlockCounts[ baNUM_POOLS ] =
+		{
+			( UBaseType_t ) ipconfigBUFFER_POOL_SMALL_COUNT,
+			( UBaseType_t ) ipconfigBUFFER_POOL_MEDIUM_COUNT,
+			( UBaseType_t ) ipconfigBUFFER_POOL_LARGE_COUNT
+		};
+		uint8_t *pucBlock = ( uint8_t * ) ullPoolStorage;
+		UBaseType_t uxBlock;
+
+			#if ( configQUEUE_REGISTRY_SIZE > 0 )
+			{
+				vQueueAddToRegistry( xNetworkBufferSemaphore, "NetBufSem" );
+			}
+			#endif /* configQUEUE_REGISTRY_SIZE */
+
+			/* If the trace recorder code is included name the semaphore for viewing
+			in FreeRTOS+Trace.  */
+			#if( ipconfigINCLUDE_EXAMPLE_FREERTOS_PLUS_TRACE_CALLS == 1 )
+			{
+				extern QueueHandle_t xNetworkEventQueue;
+				vTraceSetQueueName( xNetworkEventQueue, "IPStackEvent" );
+				vTraceSetQueueName( xNetworkBufferSemaphore, "NetworkBufferCount" );
+			}
+			#endif /*  ipconfigINCLUDE_EXAMPLE_FREERTOS_PLUS_TRACE_CALLS == 1 */
+
+			vListInitialise( &xFreeBuffersList );
+
+			/* Initialise all the network buffers.  Storage is only assigned
+			to the buffers when they are obtained. */
+			for( x = 0; x < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS; x++ )
+			{
+				/* Initialise and set the owner of the buffer list items. */
+				xNetworkBufferDescriptors[ x ].pucEthernetBuffer = NULL;
+				vListInitialiseItem( &( xNetworkBufferDescriptors[ x ].xBufferListItem ) );
+				listSET_LIST_ITEM_OWNER( &( xNetworkBufferDescriptors[ x ].xBufferListItem ), &xNetworkBufferDescriptors[ x ] );
+
+				/* Currently, all buffers are available for use. */
+				vListInsert( &xFreeBuffersList, &( xNetworkBufferDescriptors[ x ].xBufferListItem ) );
+			}
+
+			/* Carve the storage into blocks, and put all blocks in the free
+			list of their pool. */
+			for( x = 0; x < baNUM_POOLS; x++ )
+			{
+			BufferPool_t *pxPool = &( xBufferPools[ x ] );
+
+				pxPool->uxBufferSize = uxBufferSizes[ x ];
+				pxPool->uxBlockSize = baBLOCK_SIZE( uxBufferSizes[ x ] );
+				pxPool->pucFirstFree = NULL;
+				pxPool->uxFreeCount = 0U;
+				pxPool->pucFirstBlock = pucBlock;
+				pxPool->pucBeyondBlocks = pucBlock + ( pxPool->uxBlockSize * uxBlockCounts[ x ] );
+
+				for( uxBlock = 0U; uxBlock < uxBlockCounts[ x ]; uxBlock++ )
+				{
+					prvPoolGive( pucBlock );
+					pucBlock += pxPool->uxBlockSize;
+				}
+			}
+
+			uxMinimumFreeNetworkBuffers = uxGetNumberOfFreeNetworkBuffers();
+		}
+	}
+
+	if( xNetworkBufferSemaphore == NULL )
+	{
+		xReturn = pdFAIL;
+	}
+	else
+	{
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t *pucGetNetworkBuffer( size_t *pxRequestedSizeBytes )
+{
+uint8_t *pucEthernetBuffer;
+size_t xSize = prvNormalisedSize( *pxRequestedSizeBytes );
+
+	ipconfigBUFFER_ALLOC_LOCK();
+	{
+		pucEthernetBuffer = prvPoolTake( xSize );
+	}
+	ipconfigBUFFER_ALLOC_UNLOCK();
+
+	if( pucEthernetBuffer != NULL )
+	{
+		/* The whole block may be used. */
+		*pxRequestedSizeBytes = prvPoolOf( pucEthernetBuffer )->uxBufferSize;
+
+		/* Enough space is left at the start of the buffer to place a pointer to
+		the network buffer structure that references this Ethernet buffer.
+		Return a pointer to the start of the Ethernet buffer itself. */
+		pucEthernetBuffer += ipBUFFER_PADDING;
+	}
+
+	return pucEthernetBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBuffer( uint8_t *pucEthernetBuffer )
+{
+	/* There is space before the Ethernet buffer in which a pointer to the
+	network buffer that references this Ethernet buffer is stored.  Remove the
+	space before returning the block. */
+	if( pucEthernetBuffer != NULL )
+	{
+		ipconfigBUFFER_ALLOC_LOCK();
+		{
+			prvPoolGive( pucEthernetBuffer - ipBUFFER_PADDING );
+		}
+		ipconfigBUFFER_ALLOC_UNLOCK();
+	}
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxGetNetworkBufferWithDescriptor( size_t xRequestedSizeBytes, TickType_t xBlockTimeTicks )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+size_t xSize = prvNormalisedSize( xRequestedSizeBytes );
+uint8_t *pucBlock = NULL;
+
+	if( xNetworkBufferSemaphore != NULL )
+	{
+		/* If there is a semaphore available, there is a network buffer available. */
+		if( xSemaphoreTake( xNetworkBufferSemaphore, xBlockTimeTicks ) == pdPASS )
+		{
+			/* Protect the structure as it is accessed from tasks and interrupts. */
+			ipconfigBUFFER_ALLOC_LOCK();
+			{
+				pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
+				( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+
+				if( xSize != 0U )
+				{
+					pucBlock = prvPoolTake( xSize );
+				}
+			}
+			ipconfigBUFFER_ALLOC_UNLOCK();
+
+			configASSERT( pxReturn->pucEthernetBuffer == NULL );
+
+			if( ( xSize != 0U ) && ( pucBlock == NULL ) )
+			{
+				/* None of the pools that can hold the requested size has a free
+				block, so the network buffer structure cannot be used and must be
+				released. */
+				vReleaseNetworkBufferAndDescriptor( pxReturn );
+				pxReturn = NULL;
+			}
+			else
+			{
+				prvUpdateMinimumFree();
+
+				if( pucBlock != NULL )
+				{
+					/* Store a pointer to the network buffer structure in the
+					buffer storage area, then move the buffer pointer on past the
+					stored pointer so the pointer value is not overwritten by the
+					application when the buffer is used. */
+					*( ( NetworkBufferDescriptor_t ** ) pucBlock ) = pxReturn;
+					pxReturn->pucEthernetBuffer = pucBlock + ipBUFFER_PADDING;
+				}
+				else
+				{
+					/* A descriptor is being returned without an associated buffer
+					being allocated. */
+				}
+
+				/* Store the rounded size, which may be greater than the original
+				requested size. */
+				pxReturn->xDataLength = xSize;
+
+				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+				{
+					/* make sure the buffer is not linked */
+					pxReturn->pxNextBuffer = NULL;
+				}
+				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+			}
+		}
+	}
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER();
+	}
+	else
+	{
+		/* No action. */
+		iptraceNETWORK_BUFFER_OBTAINED( pxReturn );
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxNetworkBufferGetFromISR( size_t xRequestedSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn = NULL;
+size_t xSize = prvNormalisedSize( xRequestedSizeBytes );
+
+	/* If there is a semaphore available then there is a buffer available, but,
+	as this is called from an interrupt, only take a buffer if there are at
+	least baINTERRUPT_BUFFER_GET_THRESHOLD buffers remaining.  This prevents,
+	to a certain degree at least, a rapidly executing interrupt exhausting
+	buffer and in so doing preventing tasks from continuing. */
+	if( uxQueueMessagesWaitingFromISR( ( QueueHandle_t ) xNetworkBufferSemaphore ) > ( UBaseType_t ) baINTERRUPT_BUFFER_GET_THRESHOLD )
+	{
+		if( xSemaphoreTakeFromISR( xNetworkBufferSemaphore, NULL ) == pdPASS )
+		{
+		uint8_t *pucBlock = NULL;
+
+			/* Protect the structure as it is accessed from tasks and interrupts. */
+			ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+			{
+				if( xSize != 0U )
+				{
+					pucBlock = prvPoolTake( xSize );
+				}
+
+				if( ( xSize == 0U ) || ( pucBlock != NULL ) )
+				{
+					pxReturn = ( NetworkBufferDescriptor_t * ) listGET_OWNER_OF_HEAD_ENTRY( &xFreeBuffersList );
+					( void ) uxListRemove( &( pxReturn->xBufferListItem ) );
+				}
+			}
+			ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+			if( pxReturn == NULL )
+			{
+				/* No block available: give back the descriptor. */
+				( void ) xSemaphoreGiveFromISR( xNetworkBufferSemaphore, NULL );
+			}
+			else
+			{
+				if( pucBlock != NULL )
+				{
+					*( ( NetworkBufferDescriptor_t ** ) pucBlock ) = pxReturn;
+					pxReturn->pucEthernetBuffer = pucBlock + ipBUFFER_PADDING;
+				}
+
+				pxReturn->xDataLength = xSize;
+
+				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+				{
+					pxReturn->pxNextBuffer = NULL;
+				}
+				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+				iptraceNETWORK_BUFFER_OBTAINED_FROM_ISR( pxReturn );
+			}
+		}
+	}
+
+	if( pxReturn == NULL )
+	{
+		iptraceFAILED_TO_OBTAIN_NETWORK_BUFFER_FROM_ISR();
+	}
+
+	return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t vNetworkBufferReleaseFromISR( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* Ensure the buffer is returned to the list of free buffers before the
+	counting semaphore is 'given' to say a buffer is available. */
+	ipconfigBUFFER_ALLOC_LOCK_FROM_ISR();
+	{
+		if( pxNetworkBuffer->pucEthernetBuffer != NULL )
+		{
+			prvPoolGive( pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING );
+			pxNetworkBuffer->pucEthernetBuffer = NULL;
+		}
+		vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+	}
+	ipconfigBUFFER_ALLOC_UNLOCK_FROM_ISR();
+
+	( void ) xSemaphoreGiveFromISR( xNetworkBufferSemaphore, &xHigherPriorityTaskWoken );
+	iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+void vReleaseNetworkBufferAndDescriptor( NetworkBufferDescriptor_t * const pxNetworkBuffer )
+{
+BaseType_t xListItemAlreadyInFreeList;
+
+	/* Ensure the buffer is returned to the list of free buffers before the
+	counting semaphore is 'given' to say a buffer is available.  The block
+	goes back to its pool. */
+	ipconfigBUFFER_ALLOC_LOCK();
+	{
+		xListItemAlreadyInFreeList = listIS_CONTAINED_WITHIN( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+
+		if( xListItemAlreadyInFreeList == pdFALSE )
+		{
+			if( pxNetworkBuffer->pucEthernetBuffer != NULL )
+			{
+				prvPoolGive( pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING );
+				pxNetworkBuffer->pucEthernetBuffer = NULL;
+			}
+			vListInsertEnd( &xFreeBuffersList, &( pxNetworkBuffer->xBufferListItem ) );
+		}
+	}
+	ipconfigBUFFER_ALLOC_UNLOCK();
+
+	/*
+	 * Update the network state machine, unless the program fails to release its 'xNetworkBufferSemaphore'.
+	 * The program should only try to release its semaphore if 'xListItemAlreadyInFreeList' is false.
+	 */
+	if( xListItemAlreadyInFreeList == pdFALSE )
+	{
+		if ( xSemaphoreGive( xNetworkBufferSemaphore ) == pdTRUE )
+		{
+			iptraceNETWORK_BUFFER_RELEASED( pxNetworkBuffer );
+		}
+	}
+	else
+	{
+		FreeRTOS_debug_printf( ( "vReleaseNetworkBufferAndDescriptor: %p ALREADY RELEASED (now %lu)\n",
+			pxNetworkBuffer, uxGetNumberOfFreeNetworkBuffers( ) ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns the number of network buffers that can still be obtained: the number
+ * of free descriptors, or the number of free blocks if that is lower.
+ */
+UBaseType_t uxGetNumberOfFreeNetworkBuffers( void )
+{
+UBaseType_t uxCount = listCURRENT_LIST_LENGTH( &xFreeBuffersList );
+UBaseType_t uxBlocks = xBufferPools[ 0 ].uxFreeCount + xBufferPools[ 1 ].uxFreeCount + xBufferPools[ 2 ].uxFreeCount;
+
+	if( uxCount > uxBlocks )
+	{
+		uxCount = uxBlocks;
+	}
+
+	return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxGetMinimumFreeNetworkBuffers( void )
+{
+	return uxMinimumFreeNetworkBuffers;
+}
+/*-----------------------------------------------------------*/
+
+NetworkBufferDescriptor_t *pxResizeNetworkBufferWithDescriptor( NetworkBufferDescriptor_t * pxNetworkBuffer, size_t xNewSizeBytes )
+{
+NetworkBufferDescriptor_t *pxReturn = pxNetworkBuffer;
+size_t xSize = prvNormalisedSize( xNewSizeBytes );
+uint8_t *pucOldBlock = NULL;
+uint8_t *pucNewBlock = NULL;
+size_t uxCapacity = 0U;
+
+	if( pxNetworkBuffer->pucEthernetBuffer != NULL )
+	{
+		pucOldBlock = pxNetworkBuffer->pucEthernetBuffer - ipBUFFER_PADDING;
+		uxCapacity = prvPoolOf( pucOldBlock )->uxBufferSize;
+	}
+
+	if( xSize > uxCapacity )
+	{
+		/* The block is too small, move the contents to a block from a bigger
+		pool. */
+		ipconfigBUFFER_ALLOC_LOCK();
+		{
+			pucNewBlock = prvPoolTake( xSize );
+		}
+		ipconfigBUFFER_ALLOC_UNLOCK();
+
+		if( pucNewBlock == NULL )
+		{
+			/* In case the allocation fails, return NULL.  The original network
+			buffer is left untouched. */
+			pxReturn = NULL;
+		}
+		else
+		{
+			if( pucOldBlock != NULL )
+			{
+				( void ) memcpy( pucNewBlock + ipBUFFER_PADDING, pxNetworkBuffer->pucEthernetBuffer, uxCapacity );
+				vReleaseNetworkBuffer( pxNetworkBuffer->pucEthernetBuffer );
+			}
+
+			*( ( NetworkBufferDescriptor_t ** ) pucNewBlock ) = pxNetworkBuffer;
+			pxNetworkBuffer->pucEthernetBuffer = pucNewBlock + ipBUFFER_PADDING;
+			prvUpdateMinimumFree();
+		}
+	}
+
+	if( pxReturn != NULL )
+	{
+		pxReturn->xDataLength = xSize;
+	}
+
+	return pxReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+	#include "iot_freertos_tcp_test_access_buffer_define.h"
+#endif
@@ -0,0 +1,935 @@
+/*
+FreeRTOS+TCP V2.3.0
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/*
+ * A network interface for the Linux (POSIX) port of FreeRTOS.  It either
+ * attaches to a TAP device, or it opens an AF_PACKET socket on an existing
+ * Ethernet interface.
+ *
+ * Like the WinPCap driver, the host I/O is done by two threads that are not
+ * under the control of the FreeRTOS scheduler.  They exchange frames with the
+ * FreeRTOS side through single-producer/single-consumer rings, and they move
+ * frames in batches: recvmmsg() and sendmmsg() on an AF_PACKET socket, a loop
+ * of non-blocking read() and write() calls on a TAP device.
+ *
+ * When ipconfigZERO_COPY_RX_DRIVER is set, the receive thread writes the
+ * frames straight into network buffers that were handed to it in advance.
+ * Otherwise it uses frame buffers of its own, which are copied into network
+ * buffers by the FreeRTOS task that simulates the Ethernet interrupt.
+ */
+
+/* Linux includes. */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <linux/if_tun.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+
+/* The name of the host interface: a TAP device that will be created when it
+does not exist yet, or an existing Ethernet interface. */
+#ifndef configLINUX_NETWORK_INTERFACE
+	#define configLINUX_NETWORK_INTERFACE			"tap0"
+#endif
+
+/* 1: attach to the TAP device configLINUX_NETWORK_INTERFACE.
+0: open an AF_PACKET socket on the interface configLINUX_NETWORK_INTERFACE, in
+promiscuous mode because the MAC-address is simulated. */
+#ifndef configLINUX_USE_TAP
+	#define configLINUX_USE_TAP						1
+#endif
+
+/* The priority of the task that simulates the Ethernet interrupt, and the time
+it sleeps when no frames are waiting. */
+#ifndef configMAC_ISR_SIMULATOR_PRIORITY
+	#define configMAC_ISR_SIMULATOR_PRIORITY		( configMAX_PRIORITIES - 1 )
+#endif
+
+#ifndef configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY
+	#define configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY	( pdMS_TO_TICKS( 1U ) )
+#endif
+
+/* The maximum number of frames moved in one system call. */
+#define niBATCH_SIZE			32U
+
+/* The number of entries in each ring, must be a power of two. */
+#define niRING_SIZE				256U
+
+/* With ipconfigZERO_COPY_RX_DRIVER, the number of network buffers that are
+lent to the receive thread in advance.  They are taken from the pool of
+ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS, so a larger value leaves fewer buffers
+for the rest of the stack. */
+#ifndef configLINUX_RX_POSTED_BUFFERS
+	#define configLINUX_RX_POSTED_BUFFERS			niBATCH_SIZE
+#endif
+
+#if( configLINUX_RX_POSTED_BUFFERS >= niRING_SIZE )
+	#error configLINUX_RX_POSTED_BUFFERS must be smaller than niRING_SIZE
+#endif
+
+/* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
+driver will filter incoming packets and only pass the stack those packets it
+considers need processing. */
+#if( ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES == 0 )
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eProcessBuffer
+#else
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eConsiderFrameForProcessing( ( pucEthernetBuffer ) )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* A frame in a ring.  pucData points to the storage, which is the Ethernet
+buffer of pxBuffer when zero-copy receive is used. */
+typedef struct xFRAME
+{
+	uint8_t *pucData;
+	size_t uxLength;
+	NetworkBufferDescriptor_t *pxBuffer;
+} Frame_t;
+
+/* A ring with a single producer and a single consumer, which may run in a
+Linux thread and a FreeRTOS task.  Only the producer writes uxHead, only the
+consumer writes uxTail. */
+typedef struct xFRAME_RING
+{
+	Frame_t xFrames[ niRING_SIZE ];
+	atomic_size_t uxHead;
+	atomic_size_t uxTail;
+} FrameRing_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Open the TAP device or the AF_PACKET socket.
+ */
+static int prvOpenInterface( void );
+
+/*
+ * Linux threads that are outside of the control of the FreeRTOS scheduler,
+ * they do the host I/O.
+ */
+static void *prvLinuxRecvThread( void *pvParam );
+static void *prvLinuxSendThread( void *pvParam );
+
+/*
+ * Create the two Linux threads.  Returns 0 on success.
+ */
+static int prvStartHostThreads( void );
+
+/*
+ * A FreeRTOS task that simulates Ethernet interrupts by polling the ring of
+ * received frames.
+ */
+static void prvInterruptSimulatorTask( void *pvParameters );
+
+/*
+ * Give the receive thread storage for frames to come.
+ */
+static void prvPostRxBuffers( void );
+
+/*
+ * Ring access.  The Peek functions return NULL when the ring is full (for the
+ * producer) or empty (for the consumer).
+ */
+static Frame_t *prvRingPeekFree( FrameRing_t *pxRing );
+static void prvRingPush( FrameRing_t *pxRing );
+static Frame_t *prvRingPeekUsed( FrameRing_t *pxRing );
+static void prvRingPop( FrameRing_t *pxRing );
+
+static BaseType_t xPacketBouncedBack( const uint8_t *pucBuffer );
+
+/*-----------------------------------------------------------*/
+
+/* The file descriptor of the TAP device or the packet socket. */
+static int iInterfaceFD = -1;
+
+/* Used to wake up the send thread. */
+static int iSendEventFD = -1;
+
+/* Storage for frames, handed to the receive thread (xEmptyRxRing), filled by
+it (xFilledRxRing).  Frames to be sent go through xTxRing. */
+static FrameRing_t xEmptyRxRing;
+static FrameRing_t xFilledRxRing;
+static FrameRing_t xTxRing;
+
+#if( ipconfigZERO_COPY_RX_DRIVER == 0 )
+	/* The storage used by the receive thread when frames are copied. */
+	static uint8_t ucRxFrames[ niRING_SIZE ][ ipTOTAL_ETHERNET_FRAME_SIZE ];
+#endif
+
+static uint8_t ucTxFrames[ niRING_SIZE ][ ipTOTAL_ETHERNET_FRAME_SIZE ];
+
+/* The MAC address initially set to the constants defined in FreeRTOSConfig.h. */
+extern uint8_t ucMACAddress[ 6 ];
+
+/* Some statistics, for viewing in the debugger only. */
+static volatile uint32_t ulLinuxSendFailures = 0;
+static volatile uint32_t ulLinuxTxRingFull = 0;
+static volatile uint32_t ulLinuxRxNoStorage = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+BaseType_t xReturn = pdFAIL;
+size_t uxIndex;
+
+	if( iInterfaceFD >= 0 )
+	{
+		/* Already initialised, the link is always up. */
+		xReturn = pdPASS;
+	}
+	else if( prvOpenInterface() == 0 )
+	{
+		iSendEventFD = eventfd( 0, EFD_NONBLOCK );
+		configASSERT( iSendEventFD >= 0 );
+
+		#if( ipconfigZERO_COPY_RX_DRIVER == 0 )
+		{
+			/* Lend all frame buffers to the receive thread. */
+			for( uxIndex = 0U; uxIndex < ( niRING_SIZE - 1U ); uxIndex++ )
+			{
+				Frame_t *pxFrame = prvRingPeekFree( &xEmptyRxRing );
+
+				pxFrame->pucData = ucRxFrames[ uxIndex ];
+				pxFrame->pxBuffer = NULL;
+				prvRingPush( &xEmptyRxRing );
+			}
+		}
+		#else
+		{
+			/* Network buffers will be posted by prvInterruptSimulatorTask(). */
+			( void ) uxIndex;
+		}
+		#endif /* ipconfigZERO_COPY_RX_DRIVER */
+
+		if( prvStartHostThreads() == 0 )
+		{
+			/* Create a task that simulates an interrupt in a real system.  This will
+			block waiting for packets, then send a message to the IP task when data
+			is available. */
+			xTaskCreate( prvInterruptSimulatorTask, "MAC_ISR", configMINIMAL_STACK_SIZE, NULL, configMAC_ISR_SIMULATOR_PRIORITY, NULL );
+
+			xReturn = pdPASS;
+		}
+		else
+		{
+			/* Without the threads no frame would move, so leave the interface
+			closed and let the IP-task try again later. */
+			( void ) close( iSendEventFD );
+			iSendEventFD = -1;
+			( void ) close( iInterfaceFD );
+			iInterfaceFD = -1;
+
+			atomic_store( &( xEmptyRxRing.uxHead ), 0U );
+			atomic_store( &( xEmptyRxRing.uxTail ), 0U );
+		}
+	}
+	else
+	{
+		/* The interface could not be opened. */
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int prvOpenInterface( void )
+{
+struct ifreq xRequest;
+int iResult = -1;
+
+	( void ) memset( &xRequest, 0, sizeof( xRequest ) );
+	( void ) strncpy( xRequest.ifr_name, configLINUX_NETWORK_INTERFACE, sizeof( xRequest.ifr_name ) - 1U );
+
+	#if( configLINUX_USE_TAP == 1 )
+	{
+		iInterfaceFD = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+		if( iInterfaceFD < 0 )
+		{
+			printf( "prvOpenInterface: can not open /dev/net/tun: %s\n", strerror( errno ) );
+		}
+		else
+		{
+			/* A TAP device carries Ethernet frames, without the extra packet
+			information header. */
+			xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+
+			if( ioctl( iInterfaceFD, TUNSETIFF, &xRequest ) < 0 )
+			{
+				printf( "prvOpenInterface: can not attach to %s: %s\n", configLINUX_NETWORK_INTERFACE, strerror( errno ) );
+			}
+			else
+			{
+				iResult = 0;
+			}
+		}
+	}
+	#else
+	{
+		iInterfaceFD = socket( AF_PACKET, SOCK_RAW | SOCK_NONBLOCK, htons( ETH_P_ALL ) );
+
+		if( iInterfaceFD < 0 )
+		{
+			printf( "prvOpenInterface: can not open a packet socket: %s\n", strerror( errno ) );
+		}
+		else if( ioctl( iInterfaceFD, SIOCGIFINDEX, &xRequest ) < 0 )
+		{
+			printf( "prvOpenInterface: unknown interface %s: %s\n", configLINUX_NETWORK_INTERFACE, strerror( errno ) );
+		}
+		else
+		{
+		struct sockaddr_ll xAddress;
+		struct packet_mreq xMembership;
+
+			( void ) memset( &xAddress, 0, sizeof( xAddress ) );
+			xAddress.sll_family = AF_PACKET;
+			xAddress.sll_protocol = htons( ETH_P_ALL );
+			xAddress.sll_ifindex = xRequest.ifr_ifindex;
+
+			/* The MAC-address is simulated, so the interface must pass all
+			frames. */
+			( void ) memset( &xMembership, 0, sizeof( xMembership ) );
+			xMembership.mr_ifindex = xRequest.ifr_ifindex;
+			xMembership.mr_type = PACKET_MR_PROMISC;
+
+			if( bind( iInterfaceFD, ( struct sockaddr * ) &xAddress, sizeof( xAddress ) ) < 0 )
+			{
+				printf( "prvOpenInterface: can not bind to %s: %s\n", configLINUX_NETWORK_INTERFACE, strerror( errno ) );
+			}
+			else if( setsockopt( iInterfaceFD, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &xMembership, sizeof( xMembership ) ) < 0 )
+			{
+				printf( "prvOpenInterface: can not set %s in promiscuous mode: %s\n", configLINUX_NETWORK_INTERFACE, strerror( errno ) );
+			}
+			else
+			{
+				iResult = 0;
+			}
+		}
+	}
+	#endif /* configLINUX_USE_TAP */
+
+	if( ( iResult != 0 ) && ( iInterfaceFD >= 0 ) )
+	{
+		( void ) close( iInterfaceFD );
+		iInterfaceFD = -1;
+	}
+
+	return iResult;
+}
+/*-----------------------------------------------------------*/
+
+static int prvStartHostThreads( void )
+{
+pthread_t xRecvThread;
+pthread_t xSendThread;
+sigset_t xAllSignals;
+sigset_t xOldSignals;
+int iResult;
+
+	/* The POSIX port of FreeRTOS uses signals for its tick and to switch
+	tasks.  Threads that are not FreeRTOS tasks must never receive them, so
+	they are created with all signals blocked, and inherit that mask. */
+	( void ) sigfillset( &xAllSignals );
+	( void ) pthread_sigmask( SIG_BLOCK, &xAllSignals, &xOldSignals );
+
+	iResult = pthread_create( &xRecvThread, NULL, prvLinuxRecvThread, NULL );
+
+	if( iResult != 0 )
+	{
+		printf( "prvStartHostThreads: can not create the receive thread: %s\n", strerror( iResult ) );
+	}
+	else
+	{
+		iResult = pthread_create( &xSendThread, NULL, prvLinuxSendThread, NULL );
+
+		if( iResult != 0 )
+		{
+			printf( "prvStartHostThreads: can not create the send thread: %s\n", strerror( iResult ) );
+
+			/* The receive thread waits in poll(), which is a cancellation
+			point. */
+			( void ) pthread_cancel( xRecvThread );
+			( void ) pthread_join( xRecvThread, NULL );
+		}
+		else
+		{
+			( void ) pthread_detach( xRecvThread );
+			( void ) pthread_detach( xSendThread );
+		}
+	}
+
+	( void ) pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+
+	return iResult;
+}
+/*-----------------------------------------------------------*/
+
+static Frame_t *prvRingPeekFree( FrameRing_t *pxRing )
+{
+size_t uxHead = atomic_load_explicit( &( pxRing->uxHead ), memory_order_relaxed );
+size_t uxTail = atomic_load_explicit( &( pxRing->uxTail ), memory_order_acquire );
+Frame_t *pxFrame = NULL;
+
+	/* One entry is kept unused to tell a full ring from an empty one. */
+	if( ( ( uxHead + 1U ) & ( niRING_SIZE - 1U ) ) != uxTail )
+	{
+		pxFrame = &( pxRing->xFrames[ uxHead ] );
+	}
+
+	return pxFrame;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingPush( FrameRing_t *pxRing )
+{
+size_t uxHead = atomic_load_explicit( &( pxRing->uxHead ), memory_order_relaxed );
+
+	/* The release makes the contents of the frame visible to the consumer. */
+	atomic_store_explicit( &( pxRing->uxHead ), ( uxHead + 1U ) & ( niRING_SIZE - 1U ), memory_order_release );
+}
+/*-----------------------------------------------------------*/
+
+static Frame_t *prvRingPeekUsed( FrameRing_t *pxRing )
+{
+size_t uxTail = atomic_load_explicit( &( pxRing->uxTail ), memory_order_relaxed );
+size_t uxHead = atomic_load_explicit( &( pxRing->uxHead ), memory_order_acquire );
+Frame_t *pxFrame = NULL;
+
+	if( uxHead != uxTail )
+	{
+		pxFrame = &( pxRing->xFrames[ uxTail ] );
+	}
+
+	return pxFrame;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRingPop( FrameRing_t *pxRing )
+{
+size_t uxTail = atomic_load_explicit( &( pxRing->uxTail ), memory_order_relaxed );
+
+	atomic_store_explicit( &( pxRing->uxTail ), ( uxTail + 1U ) & ( niRING_SIZE - 1U ), memory_order_release );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t bReleaseAfterSend )
+{
+Frame_t *pxFrame;
+uint64_t ullOne = 1U;
+
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+	configASSERT( xIsCallingFromIPTask() == pdTRUE );
+
+	/* The IP-task is the only producer of xTxRing.  Drop the packet if the
+	ring is full. */
+	pxFrame = prvRingPeekFree( &xTxRing );
+
+	if( ( pxFrame != NULL ) && ( pxNetworkBuffer->xDataLength <= ipTOTAL_ETHERNET_FRAME_SIZE ) )
+	{
+		pxFrame->pucData = ucTxFrames[ &( pxFrame[ 0 ] ) - &( xTxRing.xFrames[ 0 ] ) ];
+		pxFrame->uxLength = pxNetworkBuffer->xDataLength;
+		( void ) memcpy( pxFrame->pucData, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+		prvRingPush( &xTxRing );
+
+		/* Kick the send thread. */
+		( void ) write( iSendEventFD, &ullOne, sizeof( ullOne ) );
+	}
+	else
+	{
+		ulLinuxTxRingFull++;
+		FreeRTOS_debug_printf( ( "xNetworkInterfaceOutput: can not store %lu bytes\n", pxNetworkBuffer->xDataLength ) );
+	}
+
+	/* The buffer has been sent so can be released. */
+	if( bReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvLinuxRecvThread( void *pvParam )
+{
+Frame_t *pxFrames[ niBATCH_SIZE ];
+size_t uxCount;
+size_t uxIndex;
+struct pollfd xPoll;
+#if( configLINUX_USE_TAP == 0 )
+	struct mmsghdr xMessages[ niBATCH_SIZE ];
+	struct iovec xVectors[ niBATCH_SIZE ];
+	struct sockaddr_ll xAddresses[ niBATCH_SIZE ];
+	int iReceived;
+#endif
+
+	/* THIS IS A LINUX THREAD - DO NOT ATTEMPT ANY FREERTOS CALLS OR TO PRINT
+	OUT MESSAGES HERE. */
+	( void ) pvParam;
+
+	xPoll.fd = iInterfaceFD;
+	xPoll.events = POLLIN;
+
+	for( ;; )
+	{
+		( void ) poll( &xPoll, 1, 100 );
+
+		/* Collect as much empty storage as a batch can use.  The frames are
+		only taken from the ring when they have been filled. */
+		uxCount = 0U;
+		{
+		size_t uxTail = atomic_load_explicit( &( xEmptyRxRing.uxTail ), memory_order_relaxed );
+		size_t uxHead = atomic_load_explicit( &( xEmptyRxRing.uxHead ), memory_order_acquire );
+		size_t uxFilledHead = atomic_load_explicit( &( xFilledRxRing.uxHead ), memory_order_relaxed );
+		size_t uxFilledTail = atomic_load_explicit( &( xFilledRxRing.uxTail ), memory_order_acquire );
+		size_t uxRoom = ( niRING_SIZE - 1U ) - ( ( uxFilledHead - uxFilledTail ) & ( niRING_SIZE - 1U ) );
+
+			while( ( uxTail != uxHead ) && ( uxCount < niBATCH_SIZE ) && ( uxCount < uxRoom ) )
+			{
+				pxFrames[ uxCount ] = &( xEmptyRxRing.xFrames[ uxTail ] );
+				uxCount++;
+				uxTail = ( uxTail + 1U ) & ( niRING_SIZE - 1U );
+			}
+		}
+
+		if( uxCount == 0U )
+		{
+			/* No storage available, leave the frames in the kernel for now. */
+			ulLinuxRxNoStorage++;
+			( void ) usleep( 1000 );
+			continue;
+		}
+
+		#if( configLINUX_USE_TAP == 1 )
+		{
+			/* A TAP device returns one frame per read(). */
+			for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+			{
+			ssize_t xLength = read( iInterfaceFD, pxFrames[ uxIndex ]->pucData, ipTOTAL_ETHERNET_FRAME_SIZE );
+
+				if( xLength <= 0 )
+				{
+					break;
+				}
+				pxFrames[ uxIndex ]->uxLength = ( size_t ) xLength;
+			}
+			uxCount = uxIndex;
+		}
+		#else
+		{
+			( void ) memset( xMessages, 0, sizeof( xMessages[ 0 ] ) * uxCount );
+			for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+			{
+				xVectors[ uxIndex ].iov_base = pxFrames[ uxIndex ]->pucData;
+				xVectors[ uxIndex ].iov_len = ipTOTAL_ETHERNET_FRAME_SIZE;
+				xMessages[ uxIndex ].msg_hdr.msg_iov = &( xVectors[ uxIndex ] );
+				xMessages[ uxIndex ].msg_hdr.msg_iovlen = 1;
+				xMessages[ uxIndex ].msg_hdr.msg_name = &( xAddresses[ uxIndex ] );
+				xMessages[ uxIndex ].msg_hdr.msg_namelen = sizeof( xAddresses[ uxIndex ] );
+			}
+
+			iReceived = recvmmsg( iInterfaceFD, xMessages, ( unsigned int ) uxCount, MSG_DONTWAIT, NULL );
+			uxCount = ( iReceived > 0 ) ? ( size_t ) iReceived : 0U;
+
+			for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+			{
+				/* Frames that were sent by this host come back on a packet
+				socket: give them a length of zero so they will be skipped. */
+				if( ( xAddresses[ uxIndex ].sll_pkttype == PACKET_OUTGOING ) ||
+					( ( xMessages[ uxIndex ].msg_hdr.msg_flags & MSG_TRUNC ) != 0 ) )
+				{
+					pxFrames[ uxIndex ]->uxLength = 0U;
+				}
+				else
+				{
+					pxFrames[ uxIndex ]->uxLength = ( size_t ) xMessages[ uxIndex ].msg_len;
+				}
+			}
+		}
+		#endif /* configLINUX_USE_TAP */
+
+		/* Move the filled frames from one ring to the other. */
+		for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+		{
+		Frame_t *pxFilled = prvRingPeekFree( &xFilledRxRing );
+
+			*pxFilled = *( pxFrames[ uxIndex ] );
+			prvRingPop( &xEmptyRxRing );
+			prvRingPush( &xFilledRxRing );
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvLinuxSendThread( void *pvParam )
+{
+Frame_t *pxFrame;
+uint64_t ullEvents;
+size_t uxCount;
+size_t uxIndex;
+struct pollfd xPoll;
+#if( configLINUX_USE_TAP == 0 )
+	struct mmsghdr xMessages[ niBATCH_SIZE ];
+	struct iovec xVectors[ niBATCH_SIZE ];
+	int iSent;
+#endif
+
+	/* THIS IS A LINUX THREAD - DO NOT ATTEMPT ANY FREERTOS CALLS OR TO PRINT
+	OUT MESSAGES HERE. */
+	( void ) pvParam;
+
+	xPoll.fd = iSendEventFD;
+	xPoll.events = POLLIN;
+
+	for( ;; )
+	{
+		/* Wait until notified of something to send. */
+		( void ) poll( &xPoll, 1, 1000 );
+		( void ) read( iSendEventFD, &ullEvents, sizeof( ullEvents ) );
+
+		for( ;; )
+		{
+		size_t uxTail = atomic_load_explicit( &( xTxRing.uxTail ), memory_order_relaxed );
+		size_t uxHead = atomic_load_explicit( &( xTxRing.uxHead ), memory_order_acquire );
+
+			/* Send all frames that are waiting, in batches. */
+			uxCount = 0U;
+			#if( configLINUX_USE_TAP == 0 )
+			{
+				( void ) memset( xMessages, 0, sizeof( xMessages ) );
+			}
+			#endif
+			while( ( uxTail != uxHead ) && ( uxCount < niBATCH_SIZE ) )
+			{
+				pxFrame = &( xTxRing.xFrames[ uxTail ] );
+
+				/* The packets sent will be written to a C source file,
+				only if 'ipconfigUSE_DUMP_PACKETS' is defined.
+				Otherwise, there is no action. */
+				iptraceDUMP_PACKET( pxFrame->pucData, pxFrame->uxLength, pdFALSE );
+
+				#if( configLINUX_USE_TAP == 1 )
+				{
+					if( write( iInterfaceFD, pxFrame->pucData, pxFrame->uxLength ) < 0 )
+					{
+						ulLinuxSendFailures++;
+					}
+				}
+				#else
+				{
+					xVectors[ uxCount ].iov_base = pxFrame->pucData;
+					xVectors[ uxCount ].iov_len = pxFrame->uxLength;
+					xMessages[ uxCount ].msg_hdr.msg_iov = &( xVectors[ uxCount ] );
+					xMessages[ uxCount ].msg_hdr.msg_iovlen = 1;
+				}
+				#endif /* configLINUX_USE_TAP */
+
+				uxCount++;
+				uxTail = ( uxTail + 1U ) & ( niRING_SIZE - 1U );
+			}
+
+			if( uxCount == 0U )
+			{
+				break;
+			}
+
+			#if( configLINUX_USE_TAP == 0 )
+			{
+				for( uxIndex = 0U; uxIndex < uxCount; uxIndex += ( size_t ) iSent )
+				{
+					iSent = sendmmsg( iInterfaceFD, &( xMessages[ uxIndex ] ), ( unsigned int ) ( uxCount - uxIndex ), 0 );
+
+					if( iSent <= 0 )
+					{
+						/* Drop the rest of the batch. */
+						ulLinuxSendFailures += ( uint32_t ) ( uxCount - uxIndex );
+						break;
+					}
+				}
+			}
+			#endif /* configLINUX_USE_TAP */
+
+			/* Give the frames back to the IP-task. */
+			for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+			{
+				prvRingPop( &xTxRing );
+			}
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPostRxBuffers( void )
+{
+	#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+	{
+	Frame_t *pxFrame;
+	NetworkBufferDescriptor_t *pxBuffer;
+	size_t uxPosted;
+
+		/* The number of buffers that the receive thread has not used yet.  Only
+		this task writes uxHead, the receive thread may still advance uxTail,
+		which can only make the count smaller. */
+		uxPosted = ( atomic_load_explicit( &( xEmptyRxRing.uxHead ), memory_order_relaxed ) -
+			atomic_load_explicit( &( xEmptyRxRing.uxTail ), memory_order_acquire ) ) & ( niRING_SIZE - 1U );
+
+		/* Keep the receive thread supplied with network buffers, into which
+		it will receive the frames directly, but do not lend it more than
+		configLINUX_RX_POSTED_BUFFERS of them. */
+		while( uxPosted < ( size_t ) configLINUX_RX_POSTED_BUFFERS )
+		{
+			pxFrame = prvRingPeekFree( &xEmptyRxRing );
+
+			if( pxFrame == NULL )
+			{
+				break;
+			}
+			pxBuffer = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0 );
+
+			if( pxBuffer == NULL )
+			{
+				break;
+			}
+			pxFrame->pucData = pxBuffer->pucEthernetBuffer;
+			pxFrame->pxBuffer = pxBuffer;
+			prvRingPush( &xEmptyRxRing );
+			uxPosted++;
+		}
+	}
+	#endif /* ipconfigZERO_COPY_RX_DRIVER */
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t xPacketBouncedBack( const uint8_t *pucBuffer )
+{
+const EthernetHeader_t *pxEtherHeader = ( const EthernetHeader_t * ) pucBuffer;
+BaseType_t xResult;
+
+	if( memcmp( ucMACAddress, pxEtherHeader->xSourceAddress.ucBytes, ipMAC_ADDRESS_LENGTH_BYTES ) == 0 )
+	{
+		xResult = pdTRUE;
+	}
+	else
+	{
+		xResult = pdFALSE;
+	}
+	return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSimulatorTask( void *pvParameters )
+{
+Frame_t *pxFrame;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+	NetworkBufferDescriptor_t *pxFirstBuffer;
+	NetworkBufferDescriptor_t *pxLastBuffer;
+#endif
+size_t uxCount;
+
+	/* Remove compiler warnings about unused parameters. */
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		prvPostRxBuffers();
+
+		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		{
+			pxFirstBuffer = NULL;
+			pxLastBuffer = NULL;
+		}
+		#endif
+
+		/* Handle the frames that have been received, a batch at a time. */
+		for( uxCount = 0U; uxCount < niBATCH_SIZE; uxCount++ )
+		{
+			pxFrame = prvRingPeekUsed( &xFilledRxRing );
+
+			if( pxFrame == NULL )
+			{
+				break;
+			}
+
+			iptraceNETWORK_INTERFACE_RECEIVE();
+
+			pxNetworkBuffer = NULL;
+
+			/* Check for minimal size and whether the frame is of interest. */
+			if( ( pxFrame->uxLength >= sizeof( EthernetHeader_t ) ) &&
+				( ipCONSIDER_FRAME_FOR_PROCESSING( pxFrame->pucData ) == eProcessBuffer ) &&
+				( xPacketBouncedBack( pxFrame->pucData ) == pdFALSE ) )
+			{
+				iptraceDUMP_PACKET( pxFrame->pucData, pxFrame->uxLength, pdTRUE );
+
+				#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+				{
+					/* The frame was received in the network buffer. */
+					pxNetworkBuffer = pxFrame->pxBuffer;
+					pxFrame->pxBuffer = NULL;
+				}
+				#else
+				{
+					pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( pxFrame->uxLength, 0 );
+
+					if( pxNetworkBuffer != NULL )
+					{
+						( void ) memcpy( pxNetworkBuffer->pucEthernetBuffer, pxFrame->pucData, pxFrame->uxLength );
+					}
+					else
+					{
+						iptraceETHERNET_RX_EVENT_LOST();
+					}
+				}
+				#endif /* ipconfigZERO_COPY_RX_DRIVER */
+			}
+
+			if( pxNetworkBuffer != NULL )
+			{
+				pxNetworkBuffer->xDataLength = pxFrame->uxLength;
+			}
+
+			#if( ipconfigZERO_COPY_RX_DRIVER != 0 )
+			{
+				/* A frame that is dropped still owns its network buffer. */
+				if( pxFrame->pxBuffer != NULL )
+				{
+					vReleaseNetworkBufferAndDescriptor( pxFrame->pxBuffer );
+				}
+			}
+			#else
+			{
+				/* Give the frame storage back to the receive thread.  Only this
+				task produces for xEmptyRxRing, and it always has room for the
+				frame that it takes here. */
+				Frame_t *pxEmpty = prvRingPeekFree( &xEmptyRxRing );
+
+				configASSERT( pxEmpty != NULL );
+				pxEmpty->pucData = pxFrame->pucData;
+				pxEmpty->pxBuffer = NULL;
+				prvRingPush( &xEmptyRxRing );
+			}
+			#endif /* ipconfigZERO_COPY_RX_DRIVER */
+
+			prvRingPop( &xFilledRxRing );
+
+			if( pxNetworkBuffer != NULL )
+			{
+				#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+				{
+					/* Chain the frames, the IP-task will get them with a single
+					event. */
+					pxNetworkBuffer->pxNextBuffer = NULL;
+					if( pxFirstBuffer == NULL )
+					{
+						pxFirstBuffer = pxNetworkBuffer;
+					}
+					else
+					{
+						pxLastBuffer->pxNextBuffer = pxNetworkBuffer;
+					}
+					pxLastBuffer = pxNetworkBuffer;
+				}
+				#else
+				{
+					xRxEvent.pvData = ( void * ) pxNetworkBuffer;
+
+					/* Data was received and stored.  Send a message to the IP
+					task to let it know. */
+					if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 0 ) == pdFAIL )
+					{
+						vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						iptraceETHERNET_RX_EVENT_LOST();
+					}
+				}
+				#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+			}
+		}
+
+		#if( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
+		{
+			if( pxFirstBuffer != NULL )
+			{
+				xRxEvent.pvData = ( void * ) pxFirstBuffer;
+
+				if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 0 ) == pdFAIL )
+				{
+					while( pxFirstBuffer != NULL )
+					{
+						pxNetworkBuffer = pxFirstBuffer;
+						pxFirstBuffer = pxFirstBuffer->pxNextBuffer;
+						vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						iptraceETHERNET_RX_EVENT_LOST();
+					}
+				}
+			}
+		}
+		#endif /* ipconfigUSE_LINKED_RX_MESSAGES */
+
+		if( uxCount == 0U )
+		{
+			/* There is no real way of simulating an interrupt.  Make sure
+			other tasks can run. */
+			vTaskDelay( configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+	#include "iot_freertos_tcp_test_access_linux_define.h"
+#endif
@@ -30,9 +30,42 @@ uint32_t TEST_FreeRTOS_TCP_prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
                                              size_t xBufferLength,
                                              TickType_t xIdentifier );
 
+#if ( ipconfigDNS_ASYNC_RESOLVER != 0 )
+    BaseType_t TEST_FreeRTOS_TCP_xDNSFindPending( const char * pcHostName,
+                                                  TickType_t * puxIdentifier );
+#endif
+
 void TEST_FreeRTOS_TCP_prvCheckOptions( FreeRTOS_Socket_t * pxSocket,
                                         NetworkBufferDescriptor_t * pxNetworkBuffer );
 
 void TEST_FreeRTOS_TCP_prvTCPCreateWindow( FreeRTOS_Socket_t * pxSocket );
 
+#if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+    NetworkBufferDescriptor_t * TEST_FreeRTOS_TCP_prvTCPGatherSegments( FreeRTOS_Socket_t * pxSocket,
+                                                                       NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                                                       int32_t lStreamPos,
+                                                                       int32_t * plDataLen,
+                                                                       UBaseType_t uxOptionsLength );
+
+    UBaseType_t TEST_FreeRTOS_TCP_prvTCPSplitSegments( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                                       size_t uxSegmentSize,
+                                                       NetworkBufferDescriptor_t * pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ] );
+#endif
+
+#if ( ipconfigTCP_RX_COALESCING != 0 )
+    const NetworkBufferDescriptor_t * TEST_FreeRTOS_TCP_pxCoalescedBuffer( void );
+#endif
+
+#if ( ipconfigIP_TCP_WORKER_TASKS > 0 )
+    UBaseType_t TEST_FreeRTOS_TCP_prvTCPWorkerForPacket( const NetworkBufferDescriptor_t * pxNetworkBuffer );
+#endif
+
+void TEST_FreeRTOS_TCP_prvPostRxBuffers( void );
+
+#if defined( ipconfigBUFFER_POOL_SMALL_SIZE )
+    BaseType_t TEST_FreeRTOS_TCP_xBufferPoolOf( const uint8_t * pucEthernetBuffer );
+
+    size_t TEST_FreeRTOS_TCP_uxBufferPoolSize( BaseType_t xPool );
+#endif
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_DECLARE_H_ */
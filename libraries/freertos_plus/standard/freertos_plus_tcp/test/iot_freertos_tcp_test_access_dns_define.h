@@ -45,4 +45,13 @@ uint32_t TEST_FreeRTOS_TCP_prvParseDNSReply( uint8_t * pucUDPPayloadBuffer,
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigDNS_ASYNC_RESOLVER != 0 )
+    BaseType_t TEST_FreeRTOS_TCP_xDNSFindPending( const char * pcHostName,
+                                                  TickType_t * puxIdentifier )
+    {
+        return xDNSFindPending( pcHostName, puxIdentifier );
+    }
+#endif
+/*-----------------------------------------------------------*/
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_DNS_DEFINE_H_ */
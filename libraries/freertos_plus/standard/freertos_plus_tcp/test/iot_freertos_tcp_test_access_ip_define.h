@@ -0,0 +1,49 @@
+/*
+ * FreeRTOS+TCP V2.3.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file iot_freertos_tcp_test_access_ip_define.h
+ * @brief Function wrappers that access private methods in FreeRTOS_IP.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_IP_DEFINE_H_
+#define _AWS_FREERTOS_TCP_TEST_ACCESS_IP_DEFINE_H_
+
+#include "iot_freertos_tcp_test_access_declare.h"
+
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigIP_TCP_WORKER_TASKS > 0 )
+    UBaseType_t TEST_FreeRTOS_TCP_prvTCPWorkerForPacket( const NetworkBufferDescriptor_t * pxNetworkBuffer )
+    {
+        return prvTCPWorkerForPacket( pxNetworkBuffer );
+    }
+#endif
+/*-----------------------------------------------------------*/
+
+#endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_IP_DEFINE_H_ */
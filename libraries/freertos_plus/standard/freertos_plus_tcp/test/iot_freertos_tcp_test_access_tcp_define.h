@@ -50,4 +50,32 @@ void TEST_FreeRTOS_TCP_prvTCPCreateWindow( FreeRTOS_Socket_t * pxSocket )
 }
 /*-----------------------------------------------------------*/
 
+#if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+    NetworkBufferDescriptor_t * TEST_FreeRTOS_TCP_prvTCPGatherSegments( FreeRTOS_Socket_t * pxSocket,
+                                                                       NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                                                       int32_t lStreamPos,
+                                                                       int32_t * plDataLen,
+                                                                       UBaseType_t uxOptionsLength )
+    {
+        return prvTCPGatherSegments( pxSocket, pxNetworkBuffer, lStreamPos, plDataLen, uxOptionsLength );
+    }
+/*-----------------------------------------------------------*/
+
+    UBaseType_t TEST_FreeRTOS_TCP_prvTCPSplitSegments( NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                                       size_t uxSegmentSize,
+                                                       NetworkBufferDescriptor_t * pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ] )
+    {
+        return prvTCPSplitSegments( pxNetworkBuffer, uxSegmentSize, pxSegments );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 ) */
+
+#if ( ipconfigTCP_RX_COALESCING != 0 )
+    const NetworkBufferDescriptor_t * TEST_FreeRTOS_TCP_pxCoalescedBuffer( void )
+    {
+        return pxCoalescedBuffer;
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( ipconfigTCP_RX_COALESCING != 0 ) */
+
 #endif /* ifndef _AWS_FREERTOS_TCP_TEST_ACCESS_TCP_DEFINE_H_ */
@@ -34,6 +34,8 @@
 #include "FreeRTOS_IP.h"
 #include "FreeRTOS_IP_Private.h"
 #include "FreeRTOS_DNS.h"
+#include "FreeRTOS_ARP.h"
+#include "NetworkBufferManagement.h"
 
 /* Test includes. */
 #include "unity_fixture.h"
@@ -63,11 +65,98 @@ TEST_GROUP_RUNNER( Full_FREERTOS_TCP )
     RUN_TEST_CASE( Full_FREERTOS_TCP, prvParseDnsResponse );
     RUN_TEST_CASE( Full_FREERTOS_TCP, ulDNSHandlePacket );
 
+    #if ( ipconfigDNS_ASYNC_RESOLVER != 0 )
+        /* Shared asynchronous look-ups and the DNS cache. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, DNSAsyncResolver );
+    #endif
+
     /* prvCheckOptions test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, prvCheckOptions );
 
     /* xProcessReceivedUDPPacket test. */
     RUN_TEST_CASE( Full_FREERTOS_TCP, UDPPacketLength );
+
+    /* usGenerateChecksum() against a plain implementation. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP, ChecksumCrossCheck );
+    RUN_TEST_CASE( Full_FREERTOS_TCP, ChecksumCopy );
+
+    #if ( ipconfigUSE_TCP_WIN == 1 )
+        /* SACK options and the retransmission of the holes they report. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPWindowSack );
+    #endif
+
+    #if ( ipconfigTCP_CONGESTION_CONTROL != 0 )
+        /* Congestion control of the TCP transmission window. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPWindowCongestion );
+    #endif
+
+    #if ( ipconfigIP_TCP_WORKER_TASKS > 1 )
+        /* Received TCP packets go to the worker that owns their connection. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPWorkerBareAck );
+    #endif
+
+    #if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) && ( ipconfigSELECT_USES_READY_LIST != 0 )
+        /* Sockets reported by FreeRTOS_select_ready(). */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SelectReady );
+    #endif
+
+    #if ( ipconfigTCP_TIMER_QUEUE != 0 )
+        /* Events of a packet that is not handled any further still reach the user. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPTimerResetEvent );
+    #endif
+
+    #if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+        /* Full-size segments sent as one packet, and split before output. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPGatherSegments );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPSplitSegments );
+    #endif
+
+    #if ( ipconfigTCP_RX_COALESCING != 0 )
+        /* Consecutive received segments that are handled as one. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, TCPCheckCoalescing );
+    #endif
+
+    #if ( ipconfigSOCKET_HASH_BUCKETS > 0 )
+        /* Sockets found through the hash tables of ports and connections. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, SocketHashLookup );
+    #endif
+
+    #if defined( ipconfigBUFFER_POOL_SMALL_SIZE )
+        /* The pools of BufferAllocation_3.c. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, BufferPoolSizeClasses );
+    #endif
+
+    #if ( ipconfigIP_TASK_EVENT_BATCH > 1 ) && ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+        /* A UDP socket is woken up once per batch of events. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, IPTaskEventBatch );
+    #endif
+
+    #if ( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+        /* The hashed ARP cache, its replacement of rows and its aging. */
+        RUN_TEST_CASE( Full_FREERTOS_TCP, ARPCacheHashing );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, ARPCacheLRUEviction );
+        RUN_TEST_CASE( Full_FREERTOS_TCP, ARPCacheAging );
+    #endif
+}
+
+/*
+ * @brief Speed of the checksum backend, only run when
+ * testrunnerFULL_FREERTOS_TCP_BENCHMARK_ENABLED is 1.
+ */
+TEST_GROUP( Full_FREERTOS_TCP_BENCHMARK );
+
+TEST_SETUP( Full_FREERTOS_TCP_BENCHMARK )
+{
+}
+
+TEST_TEAR_DOWN( Full_FREERTOS_TCP_BENCHMARK )
+{
+}
+
+TEST_GROUP_RUNNER( Full_FREERTOS_TCP_BENCHMARK )
+{
+    /* usGenerateChecksum() against a plain implementation, timed. */
+    RUN_TEST_CASE( Full_FREERTOS_TCP_BENCHMARK, ChecksumBenchmark );
 }
 
 TEST( Full_FREERTOS_TCP, prvParseDnsResponse )
@@ -302,6 +391,88 @@ TEST( Full_FREERTOS_TCP, ulDNSHandlePacket )
     TEST_ASSERT_EQUAL_UINT32( 0, ulResult );
 }
 
+#if ( ipconfigDNS_ASYNC_RESOLVER != 0 )
+
+/* The number of call-backs of asynchronous look-ups, and the addresses that
+ * they got, indexed by their search ID. */
+    static volatile UBaseType_t uxDNSCallbacks = 0U;
+    static volatile uint32_t ulDNSAddresses[ 4 ];
+
+/*
+ * Called when an asynchronous look-up is answered or has timed out.
+ */
+    static void prvDNSFound( const char * pcName,
+                             void * pvSearchID,
+                             uint32_t ulIPAddress )
+    {
+        ( void ) pcName;
+        ulDNSAddresses[ ( ( size_t ) pvSearchID ) & 3U ] = ulIPAddress;
+        uxDNSCallbacks++;
+    }
+/*-----------------------------------------------------------*/
+
+/* Two look-ups of the same name share one request, so one reply answers both
+ * of them and is stored in the cache. A third look-up is answered from the
+ * cache right away. The reply is handled as the IP-task would handle it. The
+ * name does not exist, so a real DNS server will not answer it. */
+    TEST( Full_FREERTOS_TCP, DNSAsyncResolver )
+    {
+        const char * pcName = "dnsasync.invalid";
+        const uint32_t ulExpectedAddress = FreeRTOS_inet_addr_quick( 192, 0, 2, 1 );
+        uint8_t ucReply[] =
+        {
+            0x00, 0x00, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, /* Header. */
+            0x08, 'd',  'n',  's',  'a',  's',  'y',  'n',  'c',                    /* Question. */
+            0x07, 'i',  'n',  'v',  'a',  'l',  'i',  'd',  0x00, 0x00, 0x01, 0x00, 0x01,
+            0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x04, /* Answer. */
+            192,  0,    2,    1
+        };
+        uint8_t ucPacket[ sizeof( UDPPacket_t ) + sizeof( ucReply ) ];
+        NetworkBufferDescriptor_t xNetworkBuffer = { 0 };
+        TickType_t uxIdentifier = 0U;
+        uint16_t usIdentifier;
+
+        FreeRTOS_dnsclear();
+        uxDNSCallbacks = 0U;
+        ( void ) memset( ( void * ) ulDNSAddresses, 0, sizeof( ulDNSAddresses ) );
+
+        if( TEST_PROTECT() )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 0UL, FreeRTOS_gethostbyname_a( pcName, prvDNSFound, ( void * ) 1, 5000U ) );
+            TEST_ASSERT_EQUAL_UINT32( 0UL, FreeRTOS_gethostbyname_a( pcName, prvDNSFound, ( void * ) 2, 5000U ) );
+            TEST_ASSERT_EQUAL( 0U, uxDNSCallbacks );
+            TEST_ASSERT_EQUAL( pdTRUE, TEST_FreeRTOS_TCP_xDNSFindPending( pcName, &uxIdentifier ) );
+
+            /* The reply to the shared request. */
+            usIdentifier = ( uint16_t ) uxIdentifier;
+            ( void ) memcpy( ucReply, &usIdentifier, sizeof( usIdentifier ) );
+            ( void ) memset( ucPacket, 0, sizeof( UDPPacket_t ) );
+            ( void ) memcpy( &( ucPacket[ sizeof( UDPPacket_t ) ] ), ucReply, sizeof( ucReply ) );
+            xNetworkBuffer.pucEthernetBuffer = ucPacket;
+            xNetworkBuffer.xDataLength = sizeof( ucPacket );
+            ( void ) ulDNSHandlePacket( &xNetworkBuffer );
+
+            TEST_ASSERT_EQUAL( 2U, uxDNSCallbacks );
+            TEST_ASSERT_EQUAL_UINT32( ulExpectedAddress, ulDNSAddresses[ 1 ] );
+            TEST_ASSERT_EQUAL_UINT32( ulExpectedAddress, ulDNSAddresses[ 2 ] );
+            TEST_ASSERT_EQUAL( pdFALSE, TEST_FreeRTOS_TCP_xDNSFindPending( pcName, &uxIdentifier ) );
+
+            /* The answer was stored in the cache. */
+            TEST_ASSERT_EQUAL_UINT32( ulExpectedAddress, FreeRTOS_dnslookup( pcName ) );
+            TEST_ASSERT_EQUAL_UINT32( ulExpectedAddress, FreeRTOS_gethostbyname_a( pcName, prvDNSFound, ( void * ) 3, 5000U ) );
+            TEST_ASSERT_EQUAL( 3U, uxDNSCallbacks );
+            TEST_ASSERT_EQUAL_UINT32( ulExpectedAddress, ulDNSAddresses[ 3 ] );
+
+            FreeRTOS_dnsclear();
+            TEST_ASSERT_EQUAL_UINT32( 0UL, FreeRTOS_dnslookup( pcName ) );
+        }
+
+        /* Nothing is left waiting for a reply. */
+        FreeRTOS_gethostbyname_cancel( ( void * ) 1 );
+        FreeRTOS_gethostbyname_cancel( ( void * ) 2 );
+    }
+#endif /* if ( ipconfigDNS_ASYNC_RESOLVER != 0 ) */
+
 TEST( Full_FREERTOS_TCP, prvCheckOptions )
 {
     uint8_t ucDivideByZero[] =
@@ -360,3 +531,1470 @@ TEST( Full_FREERTOS_TCP, UDPPacketLength )
     xReturn = xProcessReceivedUDPPacket( &xNetworkBuffer, usPort );
     TEST_ASSERT_EQUAL_UINT32( pdFAIL, xReturn );
 }
+
+/* A plain implementation of the Internet checksum of RFC 1071, with the
+ * conventions of usGenerateChecksum(): the sums are in host order, and when the
+ * data starts at an odd address the initial sum ends up byte-swapped. */
+static uint16_t prvReferenceChecksum( uint16_t usSum,
+                                      const uint8_t * pucData,
+                                      size_t uxLength )
+{
+    uint32_t ulSum = usSum;
+    size_t uxIndex;
+
+    if( ( ( ( uintptr_t ) pucData ) & 1U ) != 0U )
+    {
+        ulSum = ( uint32_t ) ( ( ( usSum & 0xFFU ) << 8 ) | ( usSum >> 8 ) );
+    }
+
+    for( uxIndex = 0U; ( uxIndex + 1U ) < uxLength; uxIndex += 2U )
+    {
+        ulSum += ( ( uint32_t ) pucData[ uxIndex ] << 8 ) | pucData[ uxIndex + 1U ];
+    }
+
+    if( ( uxLength & 1U ) != 0U )
+    {
+        ulSum += ( uint32_t ) pucData[ uxLength - 1U ] << 8;
+    }
+
+    while( ( ulSum >> 16 ) != 0U )
+    {
+        ulSum = ( ulSum & 0xFFFFU ) + ( ulSum >> 16 );
+    }
+
+    return ( uint16_t ) ulSum;
+}
+
+TEST( Full_FREERTOS_TCP, ChecksumCrossCheck )
+{
+    static uint8_t ucData[ 2048 + 64 ];
+    const uint16_t usSeeds[] = { 0x0000U, 0x1234U, 0xFFFFU };
+    uint32_t ulRandom = 0x12345678UL;
+    size_t uxOffset, uxLength, uxSeed, uxIndex;
+
+    for( uxIndex = 0U; uxIndex < sizeof( ucData ); uxIndex++ )
+    {
+        ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+        ucData[ uxIndex ] = ( uint8_t ) ( ulRandom >> 16 );
+    }
+
+    /* All alignments, and lengths around the sizes of the blocks that the
+     * implementations handle at once. */
+    for( uxOffset = 0U; uxOffset < 64U; uxOffset++ )
+    {
+        for( uxLength = 0U; uxLength < 300U; uxLength++ )
+        {
+            for( uxSeed = 0U; uxSeed < ( sizeof( usSeeds ) / sizeof( usSeeds[ 0 ] ) ); uxSeed++ )
+            {
+                TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( usSeeds[ uxSeed ], &( ucData[ uxOffset ] ), uxLength ),
+                                         usGenerateChecksum( usSeeds[ uxSeed ], &( ucData[ uxOffset ] ), uxLength ) );
+            }
+        }
+
+        TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, &( ucData[ uxOffset ] ), 2048U ),
+                                 usGenerateChecksum( 0U, &( ucData[ uxOffset ] ), 2048U ) );
+    }
+
+    /* Many carries. */
+    memset( ucData, 0xFF, sizeof( ucData ) );
+    TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0xFFFFU, &( ucData[ 1 ] ), 2047U ),
+                             usGenerateChecksum( 0xFFFFU, &( ucData[ 1 ] ), 2047U ) );
+}
+
+TEST( Full_FREERTOS_TCP, ChecksumCopy )
+{
+    static uint8_t ucSource[ 600 ];
+    static uint8_t ucDestination[ 600 ];
+    uint32_t ulRandom = 0x87654321UL;
+    size_t uxSourceOffset, uxDestinationOffset, uxLength, uxSplit, uxIndex;
+    uint16_t usFirst, usSecond;
+
+    for( uxIndex = 0U; uxIndex < sizeof( ucSource ); uxIndex++ )
+    {
+        ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+        ucSource[ uxIndex ] = ( uint8_t ) ( ulRandom >> 16 );
+    }
+
+    /* The source and the destination may have a different alignment. */
+    for( uxSourceOffset = 0U; uxSourceOffset < 16U; uxSourceOffset++ )
+    {
+        for( uxDestinationOffset = 0U; uxDestinationOffset < 16U; uxDestinationOffset++ )
+        {
+            for( uxLength = 0U; uxLength < 300U; uxLength += 7U )
+            {
+                memset( ucDestination, 0, sizeof( ucDestination ) );
+                TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, &( ucSource[ uxSourceOffset ] ), uxLength ),
+                                         usGenerateChecksumCopy( 0U, &( ucDestination[ uxDestinationOffset ] ), &( ucSource[ uxSourceOffset ] ), uxLength ) );
+                TEST_ASSERT_EQUAL_MEMORY( &( ucSource[ uxSourceOffset ] ), &( ucDestination[ uxDestinationOffset ] ), uxLength );
+            }
+        }
+    }
+
+    /* Sums of two parts, as used when a stream buffer wraps around. */
+    for( uxSplit = 0U; uxSplit < 64U; uxSplit++ )
+    {
+        usFirst = usGenerateChecksum( 0U, ucSource, uxSplit );
+        usSecond = usGenerateChecksum( 0U, &( ucSource[ uxSplit ] ), 500U - uxSplit );
+        TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, ucSource, 500U ),
+                                 usChecksumCombine( usFirst, usSecond, uxSplit ) );
+    }
+}
+
+TEST( Full_FREERTOS_TCP_BENCHMARK, ChecksumBenchmark )
+{
+    static uint8_t ucPacket[ 1460 ];
+    const uint32_t ulCount = 20000UL;
+    volatile uint16_t usResult = 0U;
+    uint16_t usExpected = 0U;
+    TickType_t xStart, xTicks, xReferenceTicks;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0U; ulIndex < sizeof( ucPacket ); ulIndex++ )
+    {
+        ucPacket[ ulIndex ] = ( uint8_t ) ulIndex;
+    }
+
+    xStart = xTaskGetTickCount();
+
+    for( ulIndex = 0U; ulIndex < ulCount; ulIndex++ )
+    {
+        usResult = usGenerateChecksum( usResult, ucPacket, sizeof( ucPacket ) );
+    }
+
+    xTicks = xTaskGetTickCount() - xStart;
+
+    /* The same sums with the plain implementation, which also shows what the
+     * selected backend gains. */
+    xStart = xTaskGetTickCount();
+
+    for( ulIndex = 0U; ulIndex < ulCount; ulIndex++ )
+    {
+        usExpected = prvReferenceChecksum( usExpected, ucPacket, sizeof( ucPacket ) );
+    }
+
+    xReferenceTicks = xTaskGetTickCount() - xStart;
+
+    configPRINTF( ( "usGenerateChecksum: backend %d, %u x %u bytes in %u ms, reference %u ms\r\n",
+                    ( int ) ipconfigCHECKSUM_BACKEND,
+                    ( unsigned ) ulCount,
+                    ( unsigned ) sizeof( ucPacket ),
+                    ( unsigned ) ( xTicks * portTICK_PERIOD_MS ),
+                    ( unsigned ) ( xReferenceTicks * portTICK_PERIOD_MS ) ) );
+
+    TEST_ASSERT_EQUAL_HEX16( usExpected, usResult );
+}
+
+#if ( ipconfigUSE_TCP_WIN == 1 )
+    TEST( Full_FREERTOS_TCP, TCPWindowSack )
+    {
+        const uint32_t ulMSS = 1000U;
+        const uint32_t ulFirstSequence = 1000U;
+        static TCPWindow_t xWindow;
+        uint32_t ulExpectedBlocks;
+        uint32_t ulLength;
+        int32_t lPosition;
+        uint32_t ulIndex;
+
+        /* The receiving side: store three ranges out-of-order. */
+        memset( &xWindow, 0, sizeof( xWindow ) );
+        vTCPWindowCreate( &xWindow, 100000U, 100000U, ulFirstSequence, 0U, ulMSS );
+        vTCPWindowInit( &xWindow, ulFirstSequence, 0U, ulMSS );
+
+        TEST_ASSERT_EQUAL_INT32( 1000, lTCPWindowRxCheck( &xWindow, ulFirstSequence + 1000U, ulMSS, 100000U ) );
+        TEST_ASSERT_EQUAL_INT32( 3000, lTCPWindowRxCheck( &xWindow, ulFirstSequence + 3000U, ulMSS, 100000U ) );
+        TEST_ASSERT_EQUAL_INT32( 5000, lTCPWindowRxCheck( &xWindow, ulFirstSequence + 5000U, ulMSS, 100000U ) );
+
+        /* Filling the gap between the first two ranges merges them.  The first
+         * SACK block reports the new data, the next blocks the other range. */
+        TEST_ASSERT_EQUAL_INT32( 2000, lTCPWindowRxCheck( &xWindow, ulFirstSequence + 2000U, ulMSS, 100000U ) );
+        ulExpectedBlocks = ( ipconfigTCP_SACK_BLOCKS < 2 ) ? 1U : 2U;
+        TEST_ASSERT_EQUAL_UINT32( 4U + ( 8U * ulExpectedBlocks ), xWindow.ucOptionLength );
+        TEST_ASSERT_EQUAL_UINT32( ulFirstSequence + 1000U, FreeRTOS_ntohl( xWindow.ulOptionsData[ 1 ] ) );
+        TEST_ASSERT_EQUAL_UINT32( ulFirstSequence + 4000U, FreeRTOS_ntohl( xWindow.ulOptionsData[ 2 ] ) );
+
+        /* The missing data comes in: the merged range becomes available. */
+        TEST_ASSERT_EQUAL_INT32( 0, lTCPWindowRxCheck( &xWindow, ulFirstSequence, ulMSS, 100000U ) );
+        TEST_ASSERT_EQUAL_UINT32( 3000U, xWindow.ulUserDataLength );
+        TEST_ASSERT_EQUAL_UINT32( 0U, xWindow.ucOptionLength );
+        vTCPWindowDestroy( &xWindow );
+
+        /* The sending side: 8 segments are sent, the 1st and the 3rd get lost. */
+        memset( &xWindow, 0, sizeof( xWindow ) );
+        vTCPWindowCreate( &xWindow, 100000U, 100000U, 0U, ulFirstSequence, ulMSS );
+        vTCPWindowInit( &xWindow, 0U, ulFirstSequence, ulMSS );
+        #if ( ipconfigTCP_CONGESTION_CONTROL != 0 )
+            xWindow.xCongestion.ulCWnd = 8U * ulMSS;
+        #endif
+
+        ( void ) lTCPWindowTxAdd( &xWindow, 8U * ulMSS, 0, 80000 );
+
+        for( ulIndex = 0U; ulIndex < 8U; ulIndex++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( ulMSS, ulTCPWindowTxGet( &xWindow, 100000U, &lPosition ) );
+        }
+
+        ( void ) ulTCPWindowTxSack( &xWindow, ulFirstSequence + 1000U, ulFirstSequence + 2000U );
+        ( void ) ulTCPWindowTxSack( &xWindow, ulFirstSequence + 3000U, ulFirstSequence + 8000U );
+
+        /* Only the two holes are retransmitted, in order. */
+        ulLength = ulTCPWindowTxGet( &xWindow, 100000U, &lPosition );
+        TEST_ASSERT_EQUAL_UINT32( ulMSS, ulLength );
+        TEST_ASSERT_EQUAL_INT32( 0, lPosition );
+        ulLength = ulTCPWindowTxGet( &xWindow, 100000U, &lPosition );
+        TEST_ASSERT_EQUAL_UINT32( ulMSS, ulLength );
+        TEST_ASSERT_EQUAL_INT32( 2000, lPosition );
+        TEST_ASSERT_EQUAL_UINT32( 0U, ulTCPWindowTxGet( &xWindow, 100000U, &lPosition ) );
+
+        /* More SACK's do not lead to a second retransmission. */
+        ( void ) ulTCPWindowTxSack( &xWindow, ulFirstSequence + 3000U, ulFirstSequence + 8000U );
+        TEST_ASSERT_EQUAL_UINT32( 0U, ulTCPWindowTxGet( &xWindow, 100000U, &lPosition ) );
+
+        vTCPWindowDestroy( &xWindow );
+    }
+#endif /* if ( ipconfigUSE_TCP_WIN == 1 ) */
+
+#if ( ipconfigTCP_CONGESTION_CONTROL != 0 )
+    TEST( Full_FREERTOS_TCP, TCPWindowCongestion )
+    {
+        const uint32_t ulMSS = 1000U;
+        const uint32_t ulFirstSequence = 1000U;
+        static TCPWindow_t xWindow;
+        uint32_t ulAck = ulFirstSequence;
+        uint32_t ulSent, ulLength, ulFlight;
+        int32_t lPosition;
+        uint32_t ulIndex;
+
+        memset( &xWindow, 0, sizeof( xWindow ) );
+        TEST_ASSERT_EQUAL( pdPASS, xTCPWindowSetCongestion( &xWindow, FREERTOS_TCP_CC_NEWRENO ) );
+        TEST_ASSERT_EQUAL( pdFAIL, xTCPWindowSetCongestion( &xWindow, 0 ) );
+
+        vTCPWindowCreate( &xWindow, 100000U, 100000U, 0U, ulFirstSequence, ulMSS );
+        vTCPWindowInit( &xWindow, 0U, ulFirstSequence, ulMSS );
+
+        /* The initial window of RFC 3390 is 4 segments for this MSS, and the
+         * algorithm chosen before the connection was set up is kept. */
+        TEST_ASSERT_EQUAL( FREERTOS_TCP_CC_NEWRENO, xWindow.xCongestion.xAlgorithm );
+        TEST_ASSERT_EQUAL_UINT32( 4U * ulMSS, xWindow.xCongestion.ulCWnd );
+
+        ( void ) lTCPWindowTxAdd( &xWindow, 40000U, 0, 80000 );
+
+        /* Only the congestion window may be sent, although the peer has space
+         * for much more. */
+        ulSent = 0U;
+
+        while( ( ulLength = ulTCPWindowTxGet( &xWindow, 100000U, &lPosition ) ) > 0U )
+        {
+            ulSent += ulLength;
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 4U * ulMSS, ulSent );
+
+        /* Slow start: every segment acknowledged grows the window by one MSS,
+         * and makes space for two new segments. */
+        for( ulIndex = 0U; ulIndex < 4U; ulIndex++ )
+        {
+            ulAck += ulMSS;
+            ( void ) ulTCPWindowTxAck( &xWindow, ulAck );
+
+            while( ulTCPWindowTxGet( &xWindow, 100000U, &lPosition ) > 0U )
+            {
+            }
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 8U * ulMSS, xWindow.xCongestion.ulCWnd );
+
+        /* The window is full.  Lose the first segment: the peer reports the
+         * others with SACK's, the third one triggers fast recovery. */
+        ulFlight = xWindow.tx.ulHighestSequenceNumber - ulAck;
+        TEST_ASSERT_EQUAL_UINT32( 8U * ulMSS, ulFlight );
+
+        for( ulIndex = 1U; ulIndex <= 3U; ulIndex++ )
+        {
+            ( void ) ulTCPWindowTxSack( &xWindow, ulAck + ulMSS, ulAck + ( ( ulIndex + 1U ) * ulMSS ) );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( 1U, xWindow.xCongestion.ulFastRecoveries );
+        TEST_ASSERT_EQUAL_UINT32( ulFlight / 2U, xWindow.xCongestion.ulSSThresh );
+
+        /* The lost segment is retransmitted first. */
+        ulLength = ulTCPWindowTxGet( &xWindow, 100000U, &lPosition );
+        TEST_ASSERT_EQUAL_UINT32( ulMSS, ulLength );
+        TEST_ASSERT_EQUAL_INT32( ( int32_t ) ( ulAck - ulFirstSequence ), lPosition );
+
+        /* Acknowledging all data ends the recovery with a halved window. */
+        ( void ) ulTCPWindowTxAck( &xWindow, xWindow.tx.ulHighestSequenceNumber );
+        TEST_ASSERT_EQUAL_UINT32( ulFlight / 2U, xWindow.xCongestion.ulCWnd );
+
+        vTCPWindowDestroy( &xWindow );
+    }
+#endif /* if ( ipconfigTCP_CONGESTION_CONTROL != 0 ) */
+
+#if ( ipconfigIP_TCP_WORKER_TASKS > 1 )
+
+/* A bare ACK carries no TCP options, so it is shorter than TCPPacket_t. It
+ * must still be routed to the worker of its connection, which may not be
+ * worker 0. */
+    TEST( Full_FREERTOS_TCP, TCPWorkerBareAck )
+    {
+        const size_t uxBareLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER;
+        const uint16_t usLocalPort = 8883U;
+        const uint32_t ulRemoteIP = 0xC0A80002UL;
+        TCPPacket_t xPacket;
+        NetworkBufferDescriptor_t xNetworkBuffer;
+        UBaseType_t uxWorker = 0U;
+        uint16_t usRemotePort;
+
+        /* Find a connection that is not owned by worker 0. */
+        for( usRemotePort = 49152U; usRemotePort < 65535U; usRemotePort++ )
+        {
+            uxWorker = uxTCPWorkerForConnection( usLocalPort, ulRemoteIP, usRemotePort );
+
+            if( uxWorker != 0U )
+            {
+                break;
+            }
+        }
+
+        TEST_ASSERT_NOT_EQUAL( 0U, uxWorker );
+
+        ( void ) memset( &xPacket, 0, sizeof( xPacket ) );
+        xPacket.xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+        xPacket.xIPHeader.ucVersionHeaderLength = 0x45U;
+        xPacket.xIPHeader.ucProtocol = ipPROTOCOL_TCP;
+        xPacket.xIPHeader.ulSourceIPAddress = FreeRTOS_htonl( ulRemoteIP );
+        xPacket.xTCPHeader.usSourcePort = FreeRTOS_htons( usRemotePort );
+        xPacket.xTCPHeader.usDestinationPort = FreeRTOS_htons( usLocalPort );
+        xPacket.xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER >> 2 ) << 4 );
+        xPacket.xTCPHeader.ucTCPFlags = 0x10U; /* ACK */
+
+        xNetworkBuffer.pucEthernetBuffer = ( uint8_t * ) &xPacket;
+
+        /* The bare ACK, and the same segment with options. */
+        xNetworkBuffer.xDataLength = uxBareLength;
+        TEST_ASSERT_EQUAL_UINT32( uxWorker, TEST_FreeRTOS_TCP_prvTCPWorkerForPacket( &xNetworkBuffer ) );
+
+        xNetworkBuffer.xDataLength = sizeof( xPacket );
+        TEST_ASSERT_EQUAL_UINT32( uxWorker, TEST_FreeRTOS_TCP_prvTCPWorkerForPacket( &xNetworkBuffer ) );
+
+        /* Too short for a TCP header: worker 0 drops it without looking at a
+         * socket. */
+        xNetworkBuffer.xDataLength = uxBareLength - 1U;
+        TEST_ASSERT_EQUAL_UINT32( 0U, TEST_FreeRTOS_TCP_prvTCPWorkerForPacket( &xNetworkBuffer ) );
+    }
+#endif /* if ( ipconfigIP_TCP_WORKER_TASKS > 1 ) */
+
+#if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) && ( ipconfigSELECT_USES_READY_LIST != 0 )
+
+/* Do what xProcessReceivedUDPPacket() does when a packet arrives for a member
+ * of a socket set, without the need for a peer. */
+    static void prvQueueUDPPacket( Socket_t xSocket )
+    {
+        FreeRTOS_Socket_t * pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ipUDP_PAYLOAD_OFFSET_IPv4 + 1U, 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+
+        vTaskSuspendAll();
+        {
+            taskENTER_CRITICAL();
+            {
+                vListInsertEnd( &( pxSocket->u.xUDP.xWaitingPacketsList ), &( pxNetworkBuffer->xBufferListItem ) );
+            }
+            taskEXIT_CRITICAL();
+        }
+        ( void ) xTaskResumeAll();
+
+        vSocketSetReady( pxSocket, ( EventBits_t ) eSELECT_READ );
+    }
+
+    static BaseType_t prvIsReported( const SocketReady_t * pxReady,
+                                     BaseType_t xCount,
+                                     Socket_t xSocket )
+    {
+        BaseType_t xIndex;
+        BaseType_t xReturn = pdFALSE;
+
+        for( xIndex = 0; xIndex < xCount; xIndex++ )
+        {
+            if( pxReady[ xIndex ].xSocket == xSocket )
+            {
+                TEST_ASSERT_EQUAL_UINT32( eSELECT_READ, pxReady[ xIndex ].xEvents );
+                xReturn = pdTRUE;
+            }
+        }
+
+        return xReturn;
+    }
+
+/* A level-triggered socket is reported as long as it has data, an
+ * edge-triggered one once for every packet. A socket leaves the ready list
+ * when it leaves the set, or when it is closed. */
+    TEST( Full_FREERTOS_TCP, SelectReady )
+    {
+        SocketSet_t xSocketSet;
+        Socket_t xLevelSocket, xEdgeSocket;
+        SocketReady_t xReady[ 2 ];
+        BaseType_t xCount;
+
+        xSocketSet = FreeRTOS_CreateSocketSet();
+        TEST_ASSERT_NOT_NULL( xSocketSet );
+
+        xLevelSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xLevelSocket );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xLevelSocket, NULL, 0U ) );
+
+        xEdgeSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xEdgeSocket );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xEdgeSocket, NULL, 0U ) );
+
+        FreeRTOS_FD_SET( xLevelSocket, xSocketSet, eSELECT_READ );
+        FreeRTOS_FD_SET( xEdgeSocket, xSocketSet, eSELECT_READ | eSELECT_EDGE );
+
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U ) );
+
+        /* Both sockets receive a packet, which is never read. */
+        prvQueueUDPPacket( xLevelSocket );
+        prvQueueUDPPacket( xEdgeSocket );
+
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 2, xCount );
+        TEST_ASSERT_TRUE( prvIsReported( xReady, xCount, xLevelSocket ) );
+        TEST_ASSERT_TRUE( prvIsReported( xReady, xCount, xEdgeSocket ) );
+
+        /* Having reported a level-triggered socket, the next call asks the
+         * IP-task to look at the members again: only the level-triggered one
+         * is still ready. */
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 1, xCount );
+        TEST_ASSERT_TRUE( prvIsReported( xReady, xCount, xLevelSocket ) );
+
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 1, xCount );
+        TEST_ASSERT_TRUE( prvIsReported( xReady, xCount, xLevelSocket ) );
+
+        /* A new packet makes the edge-triggered socket ready once more. */
+        prvQueueUDPPacket( xEdgeSocket );
+
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 2, xCount );
+        TEST_ASSERT_TRUE( prvIsReported( xReady, xCount, xEdgeSocket ) );
+
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 1, xCount );
+        TEST_ASSERT_FALSE( prvIsReported( xReady, xCount, xEdgeSocket ) );
+
+        /* Close the edge-triggered socket while it is on the ready list. The
+         * IP-task closes it, FreeRTOS_FD_SET() waits for the IP-task, which
+         * handles its events in order. */
+        prvQueueUDPPacket( xEdgeSocket );
+        TEST_ASSERT_EQUAL( 1, FreeRTOS_closesocket( xEdgeSocket ) );
+        FreeRTOS_FD_SET( xLevelSocket, xSocketSet, eSELECT_READ );
+
+        xCount = FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U );
+        TEST_ASSERT_EQUAL( 1, xCount );
+        TEST_ASSERT_EQUAL_PTR( xLevelSocket, xReady[ 0 ].xSocket );
+
+        /* FreeRTOS_FD_SET() has put the level-triggered socket on the ready
+         * list again. Clearing its bits removes it from the set and from the
+         * ready list. */
+        FreeRTOS_FD_SET( xLevelSocket, xSocketSet, eSELECT_READ );
+        TEST_ASSERT_NOT_NULL( listLIST_ITEM_CONTAINER( &( ( ( FreeRTOS_Socket_t * ) xLevelSocket )->xSelectReadyItem ) ) );
+
+        FreeRTOS_FD_CLR( xLevelSocket, xSocketSet, eSELECT_READ );
+        TEST_ASSERT_NULL( listLIST_ITEM_CONTAINER( &( ( ( FreeRTOS_Socket_t * ) xLevelSocket )->xSelectReadyItem ) ) );
+        TEST_ASSERT_NULL( listLIST_ITEM_CONTAINER( &( ( ( FreeRTOS_Socket_t * ) xLevelSocket )->xSelectMemberItem ) ) );
+        TEST_ASSERT_EQUAL( 0, FreeRTOS_select_ready( xSocketSet, xReady, 2, 0U ) );
+
+        TEST_ASSERT_EQUAL( 1, FreeRTOS_closesocket( xLevelSocket ) );
+        FreeRTOS_DeleteSocketSet( xSocketSet );
+    }
+#endif /* if ( ipconfigSUPPORT_SELECT_FUNCTION == 1 ) && ( ipconfigSELECT_USES_READY_LIST != 0 ) */
+
+#if ( ipconfigTCP_TIMER_QUEUE != 0 )
+
+/* Pass a TCP segment without payload from the peer of pxSocket to the
+ * IP-task, as if the network interface had received it. pxTemplate holds the
+ * headers that the socket prepared for its connection, which are stored as
+ * sent by the peer. */
+    static void prvInjectTCPSegment( const TCPPacket_t * pxTemplate,
+                                     uint8_t ucFlags,
+                                     uint32_t ulSequenceNumber,
+                                     uint32_t ulAckNumber )
+    {
+        const size_t uxLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        TCPPacket_t * pxPacket;
+        IPStackEvent_t xRxEvent;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( sizeof( TCPPacket_t ), 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+
+        pxPacket = ( TCPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+        ( void ) memcpy( pxPacket, pxTemplate, sizeof( TCPPacket_t ) );
+        ( void ) memcpy( &( pxPacket->xEthernetHeader.xDestinationAddress ), FreeRTOS_GetMACAddress(), ipMAC_ADDRESS_LENGTH_BYTES );
+
+        pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER >> 2 ) << 4 );
+        pxPacket->xTCPHeader.ucTCPFlags = ucFlags;
+        pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber );
+        pxPacket->xTCPHeader.ulAckNr = FreeRTOS_htonl( ulAckNumber );
+        pxPacket->xTCPHeader.usWindow = FreeRTOS_htons( 1460U );
+
+        pxPacket->xIPHeader.usLength = FreeRTOS_htons( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER );
+        pxPacket->xIPHeader.usHeaderChecksum = 0U;
+        pxPacket->xIPHeader.usHeaderChecksum = usGenerateChecksum( 0U, ( uint8_t * ) &( pxPacket->xIPHeader.ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+        pxPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( pxPacket->xIPHeader.usHeaderChecksum );
+
+        pxNetworkBuffer->xDataLength = uxLength;
+        ( void ) usGenerateProtocolChecksum( pxNetworkBuffer->pucEthernetBuffer, uxLength, pdTRUE );
+
+        xRxEvent.eEventType = eNetworkRxEvent;
+        xRxEvent.pvData = ( void * ) pxNetworkBuffer;
+
+        if( xSendEventStructToIPTask( &xRxEvent, pdMS_TO_TICKS( 1000U ) ) != pdPASS )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+            TEST_FAIL_MESSAGE( "The IP-task did not accept the segment." );
+        }
+    }
+
+/* A RST closes a connection in the IP-task without any further handling of
+ * the packet. The eSOCKET_CLOSED event must reach the owner of the socket
+ * right away, not only when the socket would be visited for its timeout,
+ * which a closed socket no longer has. */
+    TEST( Full_FREERTOS_TCP, TCPTimerResetEvent )
+    {
+        /* A locally administered MAC-address for a peer that does not exist. */
+        const MACAddress_t xPeerMAC = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 } };
+        const TickType_t xNoBlock = 0U;
+        const uint32_t ulPeerSequenceNumber = 0x1000UL;
+        struct freertos_sockaddr xAddress;
+        Socket_t xSocket;
+        FreeRTOS_Socket_t * pxSocket;
+        TCPPacket_t xTemplate;
+        uint32_t ulNetMask;
+        uint32_t ulOurSequenceNumber;
+        EventBits_t xBits;
+        BaseType_t xTry;
+
+        /* A peer on the local network, whose MAC-address is known, so that the
+         * SYN is prepared without waiting for ARP. */
+        ulNetMask = FreeRTOS_GetNetmask();
+        xAddress.sin_addr = ( FreeRTOS_GetIPAddress() & ulNetMask ) | ( FreeRTOS_htonl( 0xFEUL ) & ~ulNetMask );
+        xAddress.sin_port = FreeRTOS_htons( 7U );
+        vARPRefreshCacheEntry( &xPeerMAC, xAddress.sin_addr );
+
+        xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+        pxSocket = ( FreeRTOS_Socket_t * ) xSocket;
+
+        if( TEST_PROTECT() )
+        {
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoBlock, sizeof( xNoBlock ) ) );
+            TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_EWOULDBLOCK, FreeRTOS_connect( xSocket, &xAddress, sizeof( xAddress ) ) );
+
+            for( xTry = 0; ( xTry < 100 ) && ( pxSocket->u.xTCP.bits.bConnPrepared == pdFALSE_UNSIGNED ); xTry++ )
+            {
+                vTaskDelay( pdMS_TO_TICKS( 10U ) );
+            }
+
+            TEST_ASSERT_EQUAL( pdTRUE_UNSIGNED, pxSocket->u.xTCP.bits.bConnPrepared );
+            ( void ) memcpy( &xTemplate, pxSocket->u.xTCP.xPacket.u.ucLastPacket, sizeof( xTemplate ) );
+            ulOurSequenceNumber = pxSocket->u.xTCP.xTCPWindow.ulOurSequenceNumber;
+
+            /* The peer accepts the connection. */
+            prvInjectTCPSegment( &xTemplate, 0x12U /* SYN | ACK */, ulPeerSequenceNumber, ulOurSequenceNumber + 1UL );
+
+            xBits = xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_CONNECT, pdTRUE, pdFALSE, pdMS_TO_TICKS( 1000U ) );
+            TEST_ASSERT_EQUAL( eSOCKET_CONNECT, xBits & ( EventBits_t ) eSOCKET_CONNECT );
+            TEST_ASSERT_GREATER_THAN( 0, FreeRTOS_issocketconnected( xSocket ) );
+
+            /* The peer resets it. */
+            prvInjectTCPSegment( &xTemplate, 0x04U /* RST */, ulPeerSequenceNumber + 1UL, 0UL );
+
+            xBits = xEventGroupWaitBits( pxSocket->xEventGroup, ( EventBits_t ) eSOCKET_CLOSED, pdTRUE, pdFALSE, pdMS_TO_TICKS( 200U ) );
+            TEST_ASSERT_EQUAL( eSOCKET_CLOSED, xBits & ( EventBits_t ) eSOCKET_CLOSED );
+            TEST_ASSERT_EQUAL( eCLOSED, pxSocket->u.xTCP.ucTCPState );
+        }
+
+        TEST_ASSERT_EQUAL( 1, FreeRTOS_closesocket( xSocket ) );
+    }
+#endif /* if ( ipconfigTCP_TIMER_QUEUE != 0 ) */
+
+#if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 )
+
+/* A socket that is not bound, so that the IP-task does not know about it,
+ * with ulLength bytes of data queued in its transmission window. The stream
+ * only provides its length, no data is copied from it. */
+    static void prvGatherSetUp( FreeRTOS_Socket_t * pxSocket,
+                                StreamBuffer_t * pxStream,
+                                uint32_t ulMSS,
+                                uint32_t ulLength )
+    {
+        ( void ) memset( pxSocket, 0, sizeof( *pxSocket ) );
+        ( void ) memset( pxStream, 0, sizeof( *pxStream ) );
+        pxStream->LENGTH = 100000U;
+        pxSocket->u.xTCP.txStream = pxStream;
+        pxSocket->u.xTCP.ulWindowSize = 100000U;
+
+        vTCPWindowCreate( &( pxSocket->u.xTCP.xTCPWindow ), 100000U, 100000U, 0U, 1000U, ulMSS );
+        vTCPWindowInit( &( pxSocket->u.xTCP.xTCPWindow ), 0U, 1000U, ulMSS );
+        #if ( ipconfigTCP_CONGESTION_CONTROL != 0 )
+            pxSocket->u.xTCP.xTCPWindow.xCongestion.ulCWnd = 100000U;
+        #endif
+
+        ( void ) lTCPWindowTxAdd( &( pxSocket->u.xTCP.xTCPWindow ), ulLength, 0, ( int32_t ) pxStream->LENGTH );
+    }
+/*-----------------------------------------------------------*/
+
+/* Fetch the first segment as prvTCPPrepareSend() does, gather the segments
+ * that follow it into a buffer large enough for all of them, and return the
+ * total length. */
+    static int32_t prvGatherSegments( FreeRTOS_Socket_t * pxSocket,
+                                      int32_t * plFirstLength )
+    {
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        int32_t lStreamPos = 0;
+        int32_t lDataLen;
+
+        lDataLen = ( int32_t ) ulTCPWindowTxGet( &( pxSocket->u.xTCP.xTCPWindow ), pxSocket->u.xTCP.ulWindowSize, &lStreamPos );
+        *plFirstLength = lDataLen;
+
+        pxNetworkBuffer = TEST_FreeRTOS_TCP_prvTCPGatherSegments( pxSocket, NULL, lStreamPos, &lDataLen, 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+        TEST_ASSERT_GREATER_OR_EQUAL( ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + ( size_t ) lDataLen, pxNetworkBuffer->xDataLength );
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+
+        return lDataLen;
+    }
+/*-----------------------------------------------------------*/
+
+/* Only full-size segments are gathered, at most
+ * ipconfigTCP_SEGMENTATION_MAX_SEGMENTS of them, and a short segment can only
+ * be the last one. Nothing is gathered when a FIN may have to be sent. */
+    TEST( Full_FREERTOS_TCP, TCPGatherSegments )
+    {
+        const uint32_t ulMSS = 1000U;
+        static FreeRTOS_Socket_t xSocket;
+        static StreamBuffer_t xStream;
+        TCPWindow_t * pxWindow = &( xSocket.u.xTCP.xTCPWindow );
+        int32_t lFirstLength;
+        int32_t lStreamPos;
+
+        if( xBufferAllocFixedSize != pdFALSE )
+        {
+            TEST_IGNORE_MESSAGE( "Segments are only gathered with network buffers of a variable size." );
+        }
+
+        /* Three full segments and a short one go out as one packet. */
+        prvGatherSetUp( &xSocket, &xStream, ulMSS, ( 3U * ulMSS ) + ( ulMSS / 2U ) );
+        TEST_ASSERT_EQUAL_INT32( ( 3 * ( int32_t ) ulMSS ) + ( ( int32_t ) ulMSS / 2 ), prvGatherSegments( &xSocket, &lFirstLength ) );
+        TEST_ASSERT_EQUAL_INT32( ulMSS, lFirstLength );
+        TEST_ASSERT_EQUAL_UINT32( 0U, ulTCPWindowTxGet( pxWindow, xSocket.u.xTCP.ulWindowSize, &lStreamPos ) );
+        vTCPWindowDestroy( pxWindow );
+
+        /* No more segments than a packet may hold, the next packet starts
+         * with the segment that follows them. */
+        prvGatherSetUp( &xSocket, &xStream, ulMSS, ( ipconfigTCP_SEGMENTATION_MAX_SEGMENTS + 2U ) * ulMSS );
+        TEST_ASSERT_EQUAL_INT32( ipconfigTCP_SEGMENTATION_MAX_SEGMENTS * ( int32_t ) ulMSS, prvGatherSegments( &xSocket, &lFirstLength ) );
+        TEST_ASSERT_EQUAL_UINT32( ulMSS, ulTCPWindowTxGet( pxWindow, xSocket.u.xTCP.ulWindowSize, &lStreamPos ) );
+        TEST_ASSERT_EQUAL_INT32( ipconfigTCP_SEGMENTATION_MAX_SEGMENTS * ( int32_t ) ulMSS, lStreamPos );
+        vTCPWindowDestroy( pxWindow );
+
+        /* A short first segment is sent on its own. */
+        prvGatherSetUp( &xSocket, &xStream, ulMSS, ulMSS / 2U );
+        TEST_ASSERT_EQUAL_INT32( ulMSS / 2U, prvGatherSegments( &xSocket, &lFirstLength ) );
+        vTCPWindowDestroy( pxWindow );
+
+        /* The FIN must not be split off a gathered packet. */
+        prvGatherSetUp( &xSocket, &xStream, ulMSS, 4U * ulMSS );
+        xSocket.u.xTCP.bits.bCloseRequested = pdTRUE_UNSIGNED;
+        TEST_ASSERT_EQUAL_INT32( ulMSS, prvGatherSegments( &xSocket, &lFirstLength ) );
+        vTCPWindowDestroy( pxWindow );
+    }
+/*-----------------------------------------------------------*/
+
+/* A packet of two full segments and a short one is split into three packets
+ * with consecutive sequence numbers, each with its own headers and
+ * checksums. Only the last one pushes the data and closes the connection. */
+    TEST( Full_FREERTOS_TCP, TCPSplitSegments )
+    {
+        const size_t uxMSS = 500U;
+        const size_t uxHeaderLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER;
+        const size_t uxPayloadLength = ( 2U * uxMSS ) + 100U;
+        const uint32_t ulSequenceNumber = 0xFFFFFF00UL;
+        const uint8_t ucFlags = 0x19U; /* ACK | PSH | FIN */
+        NetworkBufferDescriptor_t * pxSegments[ ipconfigTCP_SEGMENTATION_MAX_SEGMENTS ];
+        NetworkBufferDescriptor_t * pxPart;
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        TCPPacket_t * pxPacket;
+        UBaseType_t uxCount = 0U;
+        UBaseType_t uxIndex;
+        size_t uxOffset;
+        size_t uxLength;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxHeaderLength + uxPayloadLength, 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+
+        if( TEST_PROTECT() )
+        {
+            pxNetworkBuffer->xDataLength = uxHeaderLength + uxPayloadLength;
+            ( void ) memset( pxNetworkBuffer->pucEthernetBuffer, 0, uxHeaderLength );
+
+            for( uxOffset = 0U; uxOffset < uxPayloadLength; uxOffset++ )
+            {
+                pxNetworkBuffer->pucEthernetBuffer[ uxHeaderLength + uxOffset ] = ( uint8_t ) uxOffset;
+            }
+
+            pxPacket = ( TCPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+            pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+            pxPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+            pxPacket->xIPHeader.ucTimeToLive = ipconfigTCP_TIME_TO_LIVE;
+            pxPacket->xIPHeader.ucProtocol = ipPROTOCOL_TCP;
+            pxPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( pxNetworkBuffer->xDataLength - ipSIZE_OF_ETH_HEADER ) );
+            pxPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_GetIPAddress();
+            pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_htonl( 0xC0A80002UL );
+            pxPacket->xTCPHeader.usSourcePort = FreeRTOS_htons( 49152U );
+            pxPacket->xTCPHeader.usDestinationPort = FreeRTOS_htons( 8883U );
+            pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber );
+            pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER >> 2 ) << 4 );
+            pxPacket->xTCPHeader.ucTCPFlags = ucFlags;
+
+            uxCount = TEST_FreeRTOS_TCP_prvTCPSplitSegments( pxNetworkBuffer, uxMSS, pxSegments );
+            TEST_ASSERT_EQUAL( 2U, uxCount );
+
+            for( uxIndex = 0U; uxIndex <= uxCount; uxIndex++ )
+            {
+                pxPart = ( uxIndex == 0U ) ? pxNetworkBuffer : pxSegments[ uxIndex - 1U ];
+                pxPacket = ( TCPPacket_t * ) pxPart->pucEthernetBuffer;
+                uxOffset = uxIndex * uxMSS;
+                uxLength = ( uxIndex < uxCount ) ? uxMSS : ( uxPayloadLength - uxOffset );
+
+                TEST_ASSERT_GREATER_OR_EQUAL( uxHeaderLength + uxLength, pxPart->xDataLength );
+                TEST_ASSERT_EQUAL_UINT16( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + uxLength, FreeRTOS_ntohs( pxPacket->xIPHeader.usLength ) );
+                TEST_ASSERT_EQUAL_HEX32( ulSequenceNumber + ( uint32_t ) uxOffset, FreeRTOS_ntohl( pxPacket->xTCPHeader.ulSequenceNumber ) );
+                TEST_ASSERT_EQUAL_HEX8( ( uxIndex < uxCount ) ? 0x10U /* ACK */ : ucFlags, pxPacket->xTCPHeader.ucTCPFlags );
+                TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) uxOffset, pxPart->pucEthernetBuffer[ uxHeaderLength ] );
+                TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) ( uxOffset + uxLength - 1U ), pxPart->pucEthernetBuffer[ uxHeaderLength + uxLength - 1U ] );
+
+                #if ( ipconfigDRIVER_INCLUDED_TX_IP_CHECKSUM == 0 )
+                    TEST_ASSERT_EQUAL_HEX16( 0xFFFFU /* ipCORRECT_CRC */, usGenerateProtocolChecksum( pxPart->pucEthernetBuffer, uxHeaderLength + uxLength, pdFALSE ) );
+                #endif
+            }
+        }
+
+        for( uxIndex = 0U; uxIndex < uxCount; uxIndex++ )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxSegments[ uxIndex ] );
+        }
+
+        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+    }
+#endif /* if ( ipconfigTCP_SEGMENTATION_OFFLOAD != 0 ) */
+
+#if ( ipconfigTCP_RX_COALESCING != 0 )
+
+/* A data segment of a connection, with ulLength bytes of payload. */
+    static void prvCoalescingPacket( TCPPacket_t * pxPacket,
+                                     NetworkBufferDescriptor_t * pxNetworkBuffer,
+                                     uint32_t ulSequenceNumber,
+                                     uint16_t usLength )
+    {
+        ( void ) memset( pxPacket, 0, sizeof( *pxPacket ) );
+        pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+        pxPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+        pxPacket->xIPHeader.ucProtocol = ipPROTOCOL_TCP;
+        pxPacket->xIPHeader.usLength = FreeRTOS_htons( ( uint16_t ) ( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER + usLength ) );
+        pxPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_htonl( 0xC0A80002UL );
+        pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_GetIPAddress();
+        pxPacket->xTCPHeader.usSourcePort = FreeRTOS_htons( 8883U );
+        pxPacket->xTCPHeader.usDestinationPort = FreeRTOS_htons( 49152U );
+        pxPacket->xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber );
+        pxPacket->xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ipSIZE_OF_TCP_HEADER >> 2 ) << 4 );
+        pxPacket->xTCPHeader.ucTCPFlags = 0x10U; /* ACK */
+
+        ( void ) memset( pxNetworkBuffer, 0, sizeof( *pxNetworkBuffer ) );
+        pxNetworkBuffer->pucEthernetBuffer = ( uint8_t * ) pxPacket;
+        pxNetworkBuffer->xDataLength = sizeof( *pxPacket );
+    }
+/*-----------------------------------------------------------*/
+
+/* A segment is only stored directly when the next packet in the chain is the
+ * next in-order data segment of the same connection. Any other packet, or the
+ * end of the chain, lets the segment go through the state machine, which
+ * flushes the train. The IP-task is kept from checking its own chains while
+ * the results are collected, they are asserted afterwards. */
+    TEST( Full_FREERTOS_TCP, TCPCheckCoalescing )
+    {
+        enum
+        {
+            eInOrder, ePush, eEndOfChain, eGap, eOtherPort, eSyn, eFin, eOptions, eNoPayload, eShort, eCount
+        };
+        const uint32_t ulSequenceNumber = 0xFFFFFF00UL;
+        const uint16_t usLength = 536U;
+        static TCPPacket_t xPacket, xNextPacket;
+        NetworkBufferDescriptor_t xBuffer, xNextBuffer;
+        BaseType_t xCoalesced[ eCount ];
+        BaseType_t xCase;
+
+        vTaskSuspendAll();
+        {
+            for( xCase = 0; xCase < ( BaseType_t ) eCount; xCase++ )
+            {
+                prvCoalescingPacket( &xPacket, &xBuffer, ulSequenceNumber, usLength );
+                prvCoalescingPacket( &xNextPacket, &xNextBuffer, ulSequenceNumber + usLength, usLength );
+
+                switch( xCase )
+                {
+                    case ePush:
+                        xPacket.xTCPHeader.ucTCPFlags |= 0x08U; /* PSH */
+                        break;
+
+                    case eGap:
+                        xNextPacket.xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber + usLength + 1U );
+                        break;
+
+                    case eOtherPort:
+                        xNextPacket.xTCPHeader.usSourcePort = FreeRTOS_htons( 8884U );
+                        break;
+
+                    case eSyn:
+                        xPacket.xTCPHeader.ucTCPFlags |= 0x02U; /* SYN */
+                        break;
+
+                    case eFin:
+                        xPacket.xTCPHeader.ucTCPFlags |= 0x01U; /* FIN */
+                        break;
+
+                    case eOptions:
+                        xPacket.xTCPHeader.ucTCPOffset = ( uint8_t ) ( ( ( ipSIZE_OF_TCP_HEADER + 12U ) >> 2 ) << 4 );
+                        break;
+
+                    case eNoPayload:
+                        xPacket.xIPHeader.usLength = FreeRTOS_htons( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER );
+                        xNextPacket.xTCPHeader.ulSequenceNumber = FreeRTOS_htonl( ulSequenceNumber );
+                        break;
+
+                    case eShort:
+                        xNextBuffer.xDataLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_TCP_HEADER - 1U;
+                        break;
+
+                    default:
+                        /* The packets as they are. */
+                        break;
+                }
+
+                vTCPCheckCoalescing( &xBuffer, ( xCase == ( BaseType_t ) eEndOfChain ) ? NULL : &xNextBuffer );
+                xCoalesced[ xCase ] = ( TEST_FreeRTOS_TCP_pxCoalescedBuffer() == &xBuffer ) ? pdTRUE : pdFALSE;
+            }
+
+            /* Leave nothing marked for the IP-task. */
+            vTCPCheckCoalescing( &xBuffer, NULL );
+        }
+        ( void ) xTaskResumeAll();
+
+        TEST_ASSERT_EQUAL_MESSAGE( pdTRUE, xCoalesced[ eInOrder ], "In-order segment" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdTRUE, xCoalesced[ ePush ], "PSH segment" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eEndOfChain ], "End of chain" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eGap ], "Sequence gap" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eOtherPort ], "Other connection" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eSyn ], "SYN segment" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eFin ], "FIN segment" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eOptions ], "TCP options" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eNoPayload ], "No payload" );
+        TEST_ASSERT_EQUAL_MESSAGE( pdFALSE, xCoalesced[ eShort ], "Truncated next packet" );
+    }
+#endif /* if ( ipconfigTCP_RX_COALESCING != 0 ) */
+
+#if ( ipconfigSOCKET_HASH_BUCKETS > 0 )
+
+/* A received segment goes to the connection with the same 4-tuple, or else to
+ * the socket that listens to the port, and a datagram to the UDP socket bound
+ * to the port. The connections are filed under their 4-tuple by the IP-task
+ * when it prepares their SYN, and removed when they are closed. Lookups are
+ * done while the IP-task can not change the tables. */
+    TEST( Full_FREERTOS_TCP, SocketHashLookup )
+    {
+        /* A locally administered MAC-address for a peer that does not exist. */
+        const MACAddress_t xPeerMAC = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 } };
+        const TickType_t xNoBlock = 0U;
+        struct freertos_sockaddr xAddress;
+        Socket_t xListenSocket = FREERTOS_INVALID_SOCKET;
+        Socket_t xUDPSocket = FREERTOS_INVALID_SOCKET;
+        Socket_t xClientSockets[ 2 ] = { FREERTOS_INVALID_SOCKET, FREERTOS_INVALID_SOCKET };
+        FreeRTOS_Socket_t * pxClient;
+        FreeRTOS_Socket_t * pxFound[ 6 ];
+        uint16_t usListenPort;
+        uint16_t usClientPort;
+        uint32_t ulPeerIP;
+        uint32_t ulNetMask;
+        BaseType_t xIndex;
+        BaseType_t xTry;
+
+        /* A peer on the local network, whose MAC-address is known, so that the
+         * SYNs are prepared without waiting for ARP. */
+        ulNetMask = FreeRTOS_GetNetmask();
+        xAddress.sin_addr = ( FreeRTOS_GetIPAddress() & ulNetMask ) | ( FreeRTOS_htonl( 0xFDUL ) & ~ulNetMask );
+        vARPRefreshCacheEntry( &xPeerMAC, xAddress.sin_addr );
+        ulPeerIP = FreeRTOS_ntohl( xAddress.sin_addr );
+
+        if( TEST_PROTECT() )
+        {
+            xListenSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+            TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xListenSocket );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xListenSocket, NULL, 0U ) );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_listen( xListenSocket, 2 ) );
+            usListenPort = ( ( FreeRTOS_Socket_t * ) xListenSocket )->usLocalPort;
+
+            /* A UDP socket bound to the same port number. */
+            xUDPSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+            TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xUDPSocket );
+            xAddress.sin_port = FreeRTOS_htons( usListenPort );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xUDPSocket, &xAddress, sizeof( xAddress ) ) );
+
+            /* Two connections to different ports of the same peer. */
+            for( xIndex = 0; xIndex < 2; xIndex++ )
+            {
+                xClientSockets[ xIndex ] = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_STREAM, FREERTOS_IPPROTO_TCP );
+                TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xClientSockets[ xIndex ] );
+                TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xClientSockets[ xIndex ], 0, FREERTOS_SO_RCVTIMEO, &xNoBlock, sizeof( xNoBlock ) ) );
+
+                xAddress.sin_port = FreeRTOS_htons( ( uint16_t ) ( 7 + xIndex ) );
+                TEST_ASSERT_EQUAL( -pdFREERTOS_ERRNO_EWOULDBLOCK, FreeRTOS_connect( xClientSockets[ xIndex ], &xAddress, sizeof( xAddress ) ) );
+
+                pxClient = ( FreeRTOS_Socket_t * ) xClientSockets[ xIndex ];
+
+                for( xTry = 0; ( xTry < 100 ) && ( pxClient->u.xTCP.bits.bConnPrepared == pdFALSE_UNSIGNED ); xTry++ )
+                {
+                    vTaskDelay( pdMS_TO_TICKS( 10U ) );
+                }
+
+                TEST_ASSERT_EQUAL( pdTRUE_UNSIGNED, pxClient->u.xTCP.bits.bConnPrepared );
+            }
+
+            pxClient = ( FreeRTOS_Socket_t * ) xClientSockets[ 0 ];
+            usClientPort = pxClient->usLocalPort;
+
+            vTaskSuspendAll();
+            {
+                pxFound[ 0 ] = pxTCPSocketLookup( 0U, usClientPort, ulPeerIP, 7U );
+                pxFound[ 1 ] = pxTCPSocketLookup( 0U, ( ( FreeRTOS_Socket_t * ) xClientSockets[ 1 ] )->usLocalPort, ulPeerIP, 8U );
+                /* Another peer port of a socket that does not listen. */
+                pxFound[ 2 ] = pxTCPSocketLookup( 0U, usClientPort, ulPeerIP, 9U );
+                /* A new peer of the listening socket. */
+                pxFound[ 3 ] = pxTCPSocketLookup( 0U, usListenPort, ulPeerIP, 7U );
+                pxFound[ 4 ] = pxUDPSocketLookup( FreeRTOS_htons( usListenPort ) );
+                pxFound[ 5 ] = pxUDPSocketLookup( FreeRTOS_htons( usClientPort ) );
+            }
+            ( void ) xTaskResumeAll();
+
+            TEST_ASSERT_EQUAL_PTR( xClientSockets[ 0 ], pxFound[ 0 ] );
+            TEST_ASSERT_EQUAL_PTR( xClientSockets[ 1 ], pxFound[ 1 ] );
+            TEST_ASSERT_NULL( pxFound[ 2 ] );
+            TEST_ASSERT_EQUAL_PTR( xListenSocket, pxFound[ 3 ] );
+            TEST_ASSERT_EQUAL_PTR( xUDPSocket, pxFound[ 4 ] );
+            TEST_ASSERT_NULL( pxFound[ 5 ] );
+
+            /* A closed connection can no longer be found. */
+            TEST_ASSERT_EQUAL( 1, FreeRTOS_closesocket( xClientSockets[ 0 ] ) );
+            xClientSockets[ 0 ] = FREERTOS_INVALID_SOCKET;
+
+            for( xTry = 0; xTry < 100; xTry++ )
+            {
+                vTaskSuspendAll();
+                {
+                    pxFound[ 0 ] = pxTCPSocketLookup( 0U, usClientPort, ulPeerIP, 7U );
+                    pxFound[ 1 ] = pxTCPSocketLookup( 0U, ( ( FreeRTOS_Socket_t * ) xClientSockets[ 1 ] )->usLocalPort, ulPeerIP, 8U );
+                }
+                ( void ) xTaskResumeAll();
+
+                if( pxFound[ 0 ] == NULL )
+                {
+                    break;
+                }
+
+                vTaskDelay( pdMS_TO_TICKS( 10U ) );
+            }
+
+            TEST_ASSERT_NULL( pxFound[ 0 ] );
+            TEST_ASSERT_EQUAL_PTR( xClientSockets[ 1 ], pxFound[ 1 ] );
+        }
+
+        for( xIndex = 0; xIndex < 2; xIndex++ )
+        {
+            if( xClientSockets[ xIndex ] != FREERTOS_INVALID_SOCKET )
+            {
+                ( void ) FreeRTOS_closesocket( xClientSockets[ xIndex ] );
+            }
+        }
+
+        if( xUDPSocket != FREERTOS_INVALID_SOCKET )
+        {
+            ( void ) FreeRTOS_closesocket( xUDPSocket );
+        }
+
+        if( xListenSocket != FREERTOS_INVALID_SOCKET )
+        {
+            ( void ) FreeRTOS_closesocket( xListenSocket );
+        }
+    }
+#endif /* if ( ipconfigSOCKET_HASH_BUCKETS > 0 ) */
+
+#if defined( ipconfigBUFFER_POOL_SMALL_SIZE )
+
+/*
+ * The descriptor that is stored in front of an Ethernet buffer.
+ */
+    static NetworkBufferDescriptor_t * prvBufferOwner( const uint8_t * pucEthernetBuffer )
+    {
+        return *( ( NetworkBufferDescriptor_t * const * ) ( pucEthernetBuffer - ipBUFFER_PADDING ) );
+    }
+/*-----------------------------------------------------------*/
+
+/* A network buffer gets a block from the smallest pool that can hold it, or
+ * from a bigger pool when that one is exhausted. A resize keeps the block when
+ * it is big enough, and otherwise moves the data to a block of a bigger pool.
+ * The IP-task may take blocks at the same time, so only the pools of the
+ * buffers of this test are checked, not the number of free blocks. */
+    TEST( Full_FREERTOS_TCP, BufferPoolSizeClasses )
+    {
+        NetworkBufferDescriptor_t * pxBuffers[ ipconfigBUFFER_POOL_SMALL_COUNT + 1 ] = { NULL };
+        NetworkBufferDescriptor_t * pxLarge = NULL;
+        NetworkBufferDescriptor_t * pxResized;
+        uint8_t * pucEthernetBuffer;
+        BaseType_t xIndex;
+        BaseType_t xTaken = 0;
+        size_t uxByte;
+
+        if( TEST_PROTECT() )
+        {
+            /* One buffer of each size class. */
+            pxBuffers[ 0 ] = pxGetNetworkBufferWithDescriptor( 60U, 0U );
+            TEST_ASSERT_NOT_NULL( pxBuffers[ 0 ] );
+            xTaken = 1;
+            TEST_ASSERT_EQUAL( 0, TEST_FreeRTOS_TCP_xBufferPoolOf( pxBuffers[ 0 ]->pucEthernetBuffer ) );
+            TEST_ASSERT_EQUAL_PTR( pxBuffers[ 0 ], prvBufferOwner( pxBuffers[ 0 ]->pucEthernetBuffer ) );
+
+            pxBuffers[ 1 ] = pxGetNetworkBufferWithDescriptor( ipconfigBUFFER_POOL_SMALL_SIZE + 100U, 0U );
+            TEST_ASSERT_NOT_NULL( pxBuffers[ 1 ] );
+            xTaken = 2;
+            TEST_ASSERT_EQUAL( 1, TEST_FreeRTOS_TCP_xBufferPoolOf( pxBuffers[ 1 ]->pucEthernetBuffer ) );
+
+            pxLarge = pxGetNetworkBufferWithDescriptor( ipTOTAL_ETHERNET_FRAME_SIZE, 0U );
+            TEST_ASSERT_NOT_NULL( pxLarge );
+            TEST_ASSERT_EQUAL( 2, TEST_FreeRTOS_TCP_xBufferPoolOf( pxLarge->pucEthernetBuffer ) );
+            TEST_ASSERT_GREATER_OR_EQUAL( ipTOTAL_ETHERNET_FRAME_SIZE, TEST_FreeRTOS_TCP_uxBufferPoolSize( 2 ) );
+
+            /* Growing within the block keeps the block. */
+            pucEthernetBuffer = pxBuffers[ 0 ]->pucEthernetBuffer;
+
+            for( uxByte = 0U; uxByte < 60U; uxByte++ )
+            {
+                pucEthernetBuffer[ uxByte ] = ( uint8_t ) uxByte;
+            }
+
+            pxResized = pxResizeNetworkBufferWithDescriptor( pxBuffers[ 0 ], ipconfigBUFFER_POOL_SMALL_SIZE - 16U );
+            TEST_ASSERT_EQUAL_PTR( pxBuffers[ 0 ], pxResized );
+            TEST_ASSERT_EQUAL_PTR( pucEthernetBuffer, pxBuffers[ 0 ]->pucEthernetBuffer );
+
+            /* Growing beyond the block moves the data to a bigger pool. */
+            pxResized = pxResizeNetworkBufferWithDescriptor( pxBuffers[ 0 ], ipconfigBUFFER_POOL_SMALL_SIZE + 100U );
+            TEST_ASSERT_EQUAL_PTR( pxBuffers[ 0 ], pxResized );
+            TEST_ASSERT_TRUE( pucEthernetBuffer != pxBuffers[ 0 ]->pucEthernetBuffer );
+            TEST_ASSERT_EQUAL( 1, TEST_FreeRTOS_TCP_xBufferPoolOf( pxBuffers[ 0 ]->pucEthernetBuffer ) );
+            TEST_ASSERT_EQUAL_PTR( pxBuffers[ 0 ], prvBufferOwner( pxBuffers[ 0 ]->pucEthernetBuffer ) );
+
+            for( uxByte = 0U; uxByte < 60U; uxByte++ )
+            {
+                TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) uxByte, pxBuffers[ 0 ]->pucEthernetBuffer[ uxByte ] );
+            }
+
+            vReleaseNetworkBufferAndDescriptor( pxBuffers[ 1 ] );
+            vReleaseNetworkBufferAndDescriptor( pxBuffers[ 0 ] );
+            pxBuffers[ 1 ] = NULL;
+            pxBuffers[ 0 ] = NULL;
+            xTaken = 0;
+
+            /* Take small buffers until the small pool is exhausted: the next
+             * one comes from the medium pool. */
+            for( xIndex = 0; xIndex <= ( BaseType_t ) ipconfigBUFFER_POOL_SMALL_COUNT; xIndex++ )
+            {
+                pxBuffers[ xIndex ] = pxGetNetworkBufferWithDescriptor( 60U, 0U );
+                TEST_ASSERT_NOT_NULL( pxBuffers[ xIndex ] );
+                xTaken = xIndex + 1;
+
+                if( TEST_FreeRTOS_TCP_xBufferPoolOf( pxBuffers[ xIndex ]->pucEthernetBuffer ) != 0 )
+                {
+                    break;
+                }
+            }
+
+            TEST_ASSERT_LESS_OR_EQUAL( ( BaseType_t ) ipconfigBUFFER_POOL_SMALL_COUNT, xIndex );
+            TEST_ASSERT_EQUAL( 1, TEST_FreeRTOS_TCP_xBufferPoolOf( pxBuffers[ xIndex ]->pucEthernetBuffer ) );
+        }
+
+        for( xIndex = 0; xIndex < xTaken; xIndex++ )
+        {
+            if( pxBuffers[ xIndex ] != NULL )
+            {
+                vReleaseNetworkBufferAndDescriptor( pxBuffers[ xIndex ] );
+            }
+        }
+
+        if( pxLarge != NULL )
+        {
+            vReleaseNetworkBufferAndDescriptor( pxLarge );
+        }
+    }
+#endif /* if defined( ipconfigBUFFER_POOL_SMALL_SIZE ) */
+
+#if ( ipconfigIP_TASK_EVENT_BATCH > 1 ) && ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 )
+
+/* The number of datagrams that is passed to the IP-task in one go. */
+    #define tcptestBATCH_DATAGRAMS    4
+
+/* The number of times that the owner of the socket was woken up. */
+    static volatile UBaseType_t uxBatchWakeUps = 0U;
+
+/*
+ * Called by the IP-task when it wakes up the owner of the socket.
+ */
+    static void prvBatchWakeUp( FreeRTOS_Socket_t * pxSocket )
+    {
+        ( void ) pxSocket;
+        uxBatchWakeUps++;
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * Return a network buffer holding a UDP datagram from ulSourceIP to port
+ * usPort of this device, with ulValue as its payload.
+ */
+    static NetworkBufferDescriptor_t * prvCreateDatagram( uint32_t ulSourceIP,
+                                                          uint16_t usPort,
+                                                          uint32_t ulValue )
+    {
+        /* A locally administered MAC-address for a peer that does not exist. */
+        const MACAddress_t xPeerMAC = { { 0x02, 0x00, 0x00, 0x00, 0x00, 0x03 } };
+        const size_t uxLength = ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER + sizeof( ulValue );
+        NetworkBufferDescriptor_t * pxNetworkBuffer;
+        UDPPacket_t * pxPacket;
+
+        pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( uxLength, 0U );
+        TEST_ASSERT_NOT_NULL( pxNetworkBuffer );
+
+        ( void ) memset( pxNetworkBuffer->pucEthernetBuffer, 0, uxLength );
+        pxPacket = ( UDPPacket_t * ) pxNetworkBuffer->pucEthernetBuffer;
+        ( void ) memcpy( &( pxPacket->xEthernetHeader.xDestinationAddress ), FreeRTOS_GetMACAddress(), ipMAC_ADDRESS_LENGTH_BYTES );
+        ( void ) memcpy( &( pxPacket->xEthernetHeader.xSourceAddress ), &xPeerMAC, ipMAC_ADDRESS_LENGTH_BYTES );
+        pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+
+        pxPacket->xIPHeader.ucVersionHeaderLength = 0x45U;
+        pxPacket->xIPHeader.usLength = FreeRTOS_htons( ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER + sizeof( ulValue ) );
+        pxPacket->xIPHeader.ucTimeToLive = 128U;
+        pxPacket->xIPHeader.ucProtocol = ( uint8_t ) ipPROTOCOL_UDP;
+        pxPacket->xIPHeader.ulSourceIPAddress = ulSourceIP;
+        pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_GetIPAddress();
+        pxPacket->xIPHeader.usHeaderChecksum = usGenerateChecksum( 0U, ( uint8_t * ) &( pxPacket->xIPHeader.ucVersionHeaderLength ), ipSIZE_OF_IPv4_HEADER );
+        pxPacket->xIPHeader.usHeaderChecksum = ~FreeRTOS_htons( pxPacket->xIPHeader.usHeaderChecksum );
+
+        pxPacket->xUDPHeader.usSourcePort = FreeRTOS_htons( 7U );
+        pxPacket->xUDPHeader.usDestinationPort = usPort;
+        pxPacket->xUDPHeader.usLength = FreeRTOS_htons( ipSIZE_OF_UDP_HEADER + sizeof( ulValue ) );
+        ( void ) memcpy( &( pxNetworkBuffer->pucEthernetBuffer[ ipSIZE_OF_ETH_HEADER + ipSIZE_OF_IPv4_HEADER + ipSIZE_OF_UDP_HEADER ] ), &ulValue, sizeof( ulValue ) );
+
+        pxNetworkBuffer->xDataLength = uxLength;
+        ( void ) usGenerateProtocolChecksum( pxNetworkBuffer->pucEthernetBuffer, uxLength, pdTRUE );
+
+        return pxNetworkBuffer;
+    }
+/*-----------------------------------------------------------*/
+
+/* Datagrams that reach the IP-task together are handled in one batch: all of
+ * them are queued in the socket, but its owner is woken up once at the end of
+ * the batch rather than once per datagram. The datagrams are queued while the
+ * scheduler is suspended, so that they are consecutive in the queue of the
+ * IP-task; a batch that had already started may still end among them. */
+    TEST( Full_FREERTOS_TCP, IPTaskEventBatch )
+    {
+        NetworkBufferDescriptor_t * pxDatagrams[ tcptestBATCH_DATAGRAMS ] = { NULL };
+        const TickType_t xNoBlock = 0U;
+        struct freertos_sockaddr xAddress;
+        Socket_t xSocket = FREERTOS_INVALID_SOCKET;
+        IPStackEvent_t xRxEvent;
+        uint32_t ulNetMask;
+        uint32_t ulSourceIP;
+        uint32_t ulValue;
+        BaseType_t xIndex;
+        BaseType_t xQueued = 0;
+        BaseType_t xTry;
+        int32_t lReceived;
+
+        ulNetMask = FreeRTOS_GetNetmask();
+        ulSourceIP = ( FreeRTOS_GetIPAddress() & ulNetMask ) | ( FreeRTOS_htonl( 0xFCUL ) & ~ulNetMask );
+
+        if( TEST_PROTECT() )
+        {
+            xSocket = FreeRTOS_socket( FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP );
+            TEST_ASSERT_NOT_EQUAL( FREERTOS_INVALID_SOCKET, xSocket );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_bind( xSocket, NULL, 0U ) );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xNoBlock, sizeof( xNoBlock ) ) );
+            TEST_ASSERT_EQUAL( 0, FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_WAKEUP_CALLBACK, ( void * ) prvBatchWakeUp, sizeof( SocketWakeupCallback_t ) ) );
+            uxBatchWakeUps = 0U;
+
+            for( xIndex = 0; xIndex < tcptestBATCH_DATAGRAMS; xIndex++ )
+            {
+                pxDatagrams[ xIndex ] = prvCreateDatagram( ulSourceIP, FreeRTOS_htons( ( ( FreeRTOS_Socket_t * ) xSocket )->usLocalPort ), ( uint32_t ) xIndex );
+            }
+
+            vTaskSuspendAll();
+            {
+                for( xQueued = 0; xQueued < tcptestBATCH_DATAGRAMS; xQueued++ )
+                {
+                    xRxEvent.eEventType = eNetworkRxEvent;
+                    xRxEvent.pvData = ( void * ) pxDatagrams[ xQueued ];
+
+                    if( xSendEventStructToIPTask( &xRxEvent, 0U ) != pdPASS )
+                    {
+                        break;
+                    }
+
+                    /* The buffer is owned by the IP-task now. */
+                    pxDatagrams[ xQueued ] = NULL;
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            TEST_ASSERT_EQUAL( tcptestBATCH_DATAGRAMS, xQueued );
+
+            /* Receive the datagrams in the order in which they were sent. */
+            for( xIndex = 0; xIndex < tcptestBATCH_DATAGRAMS; xIndex++ )
+            {
+                lReceived = 0;
+
+                for( xTry = 0; ( xTry < 100 ) && ( lReceived <= 0 ); xTry++ )
+                {
+                    lReceived = FreeRTOS_recvfrom( xSocket, &ulValue, sizeof( ulValue ), 0, &xAddress, NULL );
+
+                    if( lReceived <= 0 )
+                    {
+                        vTaskDelay( pdMS_TO_TICKS( 10U ) );
+                    }
+                }
+
+                TEST_ASSERT_EQUAL( sizeof( ulValue ), lReceived );
+                TEST_ASSERT_EQUAL_UINT32( ( uint32_t ) xIndex, ulValue );
+                TEST_ASSERT_EQUAL_UINT32( ulSourceIP, xAddress.sin_addr );
+            }
+
+            TEST_ASSERT_GREATER_OR_EQUAL( 1U, uxBatchWakeUps );
+            TEST_ASSERT_LESS_OR_EQUAL( 2U, uxBatchWakeUps );
+        }
+
+        for( xIndex = 0; xIndex < tcptestBATCH_DATAGRAMS; xIndex++ )
+        {
+            if( pxDatagrams[ xIndex ] != NULL )
+            {
+                vReleaseNetworkBufferAndDescriptor( pxDatagrams[ xIndex ] );
+            }
+        }
+
+        if( xSocket != FREERTOS_INVALID_SOCKET )
+        {
+            ( void ) FreeRTOS_closesocket( xSocket );
+        }
+    }
+#endif /* if ( ipconfigIP_TASK_EVENT_BATCH > 1 ) && ( ipconfigSOCKET_HAS_USER_WAKE_CALLBACK == 1 ) */
+
+#if ( ipconfigARP_CACHE_HASH_BUCKETS > 0 )
+
+/* Addresses of peers that do not exist, on the local network so that they
+ * are stored in the ARP cache. */
+    static uint32_t prvARPTestAddress( BaseType_t xIndex )
+    {
+        uint32_t ulNetMask = FreeRTOS_GetNetmask();
+
+        return ( FreeRTOS_GetIPAddress() & ulNetMask ) | ( FreeRTOS_htonl( 0xE0UL + ( uint32_t ) xIndex ) & ~ulNetMask );
+    }
+/*-----------------------------------------------------------*/
+
+/* Locally administered MAC-addresses for those peers. */
+    static void prvARPTestMAC( BaseType_t xIndex,
+                               MACAddress_t * pxMACAddress )
+    {
+        const MACAddress_t xBase = { { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 } };
+
+        *pxMACAddress = xBase;
+        pxMACAddress->ucBytes[ 5 ] = ( uint8_t ) xIndex;
+    }
+/*-----------------------------------------------------------*/
+
+/* Look up an address and return whether it was found with the expected
+ * MAC-address. */
+    static BaseType_t prvARPTestLookup( uint32_t ulIPAddress,
+                                        const MACAddress_t * pxExpectedMAC )
+    {
+        MACAddress_t xMACAddress;
+        uint32_t ulAddress = ulIPAddress;
+        BaseType_t xResult = pdFALSE;
+
+        if( ( eARPGetCacheEntry( &ulAddress, &xMACAddress ) == eARPCacheHit ) &&
+            ( memcmp( xMACAddress.ucBytes, pxExpectedMAC->ucBytes, sizeof( xMACAddress.ucBytes ) ) == 0 ) )
+        {
+            xResult = pdTRUE;
+        }
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+/* Every address of a full cache is found in its hash bucket. A known address
+ * takes a new MAC-address, and a known MAC-address moves to a new address.
+ * The IP-task is kept from changing the cache while it is checked, and the
+ * results are only asserted after the scheduler is resumed. */
+    TEST( Full_FREERTOS_TCP, ARPCacheHashing )
+    {
+        BaseType_t xFound[ ipconfigARP_CACHE_ENTRIES ];
+        BaseType_t xNewMACFound;
+        BaseType_t xOldAddressFound;
+        BaseType_t xNewAddressFound;
+        MACAddress_t xMACAddress;
+        MACAddress_t xNewMAC;
+        BaseType_t x;
+
+        prvARPTestMAC( 0xFF, &xNewMAC );
+
+        vTaskSuspendAll();
+        {
+            FreeRTOS_ClearARP();
+
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                prvARPTestMAC( x, &xMACAddress );
+                vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( x ) );
+            }
+
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                prvARPTestMAC( x, &xMACAddress );
+                xFound[ x ] = prvARPTestLookup( prvARPTestAddress( x ), &xMACAddress );
+            }
+
+            /* The first peer changes its network interface. */
+            vARPRefreshCacheEntry( &xNewMAC, prvARPTestAddress( 0 ) );
+            xNewMACFound = prvARPTestLookup( prvARPTestAddress( 0 ), &xNewMAC );
+
+            /* The second peer gets another address. */
+            prvARPTestMAC( 1, &xMACAddress );
+            vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( ipconfigARP_CACHE_ENTRIES ) );
+            xOldAddressFound = prvARPTestLookup( prvARPTestAddress( 1 ), &xMACAddress );
+            xNewAddressFound = prvARPTestLookup( prvARPTestAddress( ipconfigARP_CACHE_ENTRIES ), &xMACAddress );
+
+            FreeRTOS_ClearARP();
+        }
+        ( void ) xTaskResumeAll();
+
+        for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xFound[ x ] );
+        }
+
+        TEST_ASSERT_EQUAL( pdTRUE, xNewMACFound );
+        TEST_ASSERT_EQUAL( pdFALSE, xOldAddressFound );
+        TEST_ASSERT_EQUAL( pdTRUE, xNewAddressFound );
+    }
+/*-----------------------------------------------------------*/
+
+/* When the cache is full, a new address replaces the least recently used
+ * row. A lookup counts as a use, so the oldest row that was looked up stays. */
+    TEST( Full_FREERTOS_TCP, ARPCacheLRUEviction )
+    {
+        BaseType_t xFound[ ipconfigARP_CACHE_ENTRIES + 1 ];
+        MACAddress_t xMACAddress;
+        BaseType_t x;
+
+        vTaskSuspendAll();
+        {
+            FreeRTOS_ClearARP();
+
+            for( x = 0; x < ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                prvARPTestMAC( x, &xMACAddress );
+                vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( x ) );
+            }
+
+            /* Row 0 becomes the most recently used, so row 1 is the least. */
+            prvARPTestMAC( 0, &xMACAddress );
+            ( void ) prvARPTestLookup( prvARPTestAddress( 0 ), &xMACAddress );
+
+            prvARPTestMAC( ipconfigARP_CACHE_ENTRIES, &xMACAddress );
+            vARPRefreshCacheEntry( &xMACAddress, prvARPTestAddress( ipconfigARP_CACHE_ENTRIES ) );
+
+            for( x = 0; x <= ipconfigARP_CACHE_ENTRIES; x++ )
+            {
+                prvARPTestMAC( x, &xMACAddress );
+                xFound[ x ] = prvARPTestLookup( prvARPTestAddress( x ), &xMACAddress );
+            }
+
+            FreeRTOS_ClearARP();
+        }
+        ( void ) xTaskResumeAll();
+
+        for( x = 0; x <= ipconfigARP_CACHE_ENTRIES; x++ )
+        {
+            TEST_ASSERT_EQUAL( ( x == 1 ) ? pdFALSE : pdTRUE, xFound[ x ] );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+/* vARPAgeCache() visits every row once in ipARP_AGE_PASSES calls. A resolved
+ * row expires after ipconfigMAX_ARP_AGE visits, a row that waits for an ARP
+ * reply after ipconfigMAX_ARP_RETRANSMISSIONS visits. The IP-task may age the
+ * cache as well, so a row is only expected to survive two visits less. Aging
+ * sends ARP requests, so the scheduler is not suspended. */
+    TEST( Full_FREERTOS_TCP, ARPCacheAging )
+    {
+        const uint32_t ulResolved = prvARPTestAddress( 0 );
+        const uint32_t ulPending = prvARPTestAddress( 1 );
+        MACAddress_t xMACAddress;
+        uint32_t ulAddress;
+        BaseType_t xVisit;
+        BaseType_t xPass;
+
+        prvARPTestMAC( 0, &xMACAddress );
+        FreeRTOS_ClearARP();
+        vARPRefreshCacheEntry( &xMACAddress, ulResolved );
+        vARPRefreshCacheEntry( NULL, ulPending );
+
+        if( TEST_PROTECT() )
+        {
+            ulAddress = ulPending;
+            TEST_ASSERT_EQUAL( eCantSendPacket, eARPGetCacheEntry( &ulAddress, &xMACAddress ) );
+            prvARPTestMAC( 0, &xMACAddress );
+
+            for( xVisit = 0; xVisit < ( BaseType_t ) ipconfigMAX_ARP_AGE; xVisit++ )
+            {
+                if( xVisit == ( BaseType_t ) ipconfigMAX_ARP_AGE - 2 )
+                {
+                    TEST_ASSERT_EQUAL( pdTRUE, prvARPTestLookup( ulResolved, &xMACAddress ) );
+                }
+
+                if( xVisit == ( BaseType_t ) ipconfigMAX_ARP_RETRANSMISSIONS )
+                {
+                    ulAddress = ulPending;
+                    TEST_ASSERT_EQUAL( eARPCacheMiss, eARPGetCacheEntry( &ulAddress, &xMACAddress ) );
+                    prvARPTestMAC( 0, &xMACAddress );
+                }
+
+                for( xPass = 0; xPass < ( BaseType_t ) ipARP_AGE_PASSES; xPass++ )
+                {
+                    vARPAgeCache();
+                }
+            }
+
+            TEST_ASSERT_EQUAL( pdFALSE, prvARPTestLookup( ulResolved, &xMACAddress ) );
+        }
+
+        FreeRTOS_ClearARP();
+    }
+#endif /* if ( ipconfigARP_CACHE_HASH_BUCKETS > 0 ) */
@@ -0,0 +1,52 @@
+/*
+FreeRTOS Kernel V10.2.0
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+
+/*****************************************************************************
+*
+* FreeRTOS+TCP configuration for the host unit tests.  Only the options that
+* the code under test depends on are set, the rest come from
+* FreeRTOSIPConfigDefaults.h.
+*
+*****************************************************************************/
+
+#ifndef FREERTOS_IP_CONFIG_H
+#define FREERTOS_IP_CONFIG_H
+
+#define ipconfigBYTE_ORDER                          pdFREERTOS_LITTLE_ENDIAN
+
+/* The Linux driver receives directly into network buffers, which exercises the
+ * limit on the number of buffers lent to its receive thread. */
+#define ipconfigZERO_COPY_RX_DRIVER                 1
+#define ipconfigZERO_COPY_TX_DRIVER                 1
+#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS      60
+#define configLINUX_RX_POSTED_BUFFERS               4U
+
+/* Open an AF_PACKET socket rather than a TAP device, on an interface that does
+ * not exist, so that no test depends on the privileges of the host. */
+#define configLINUX_USE_TAP                         0
+#define configLINUX_NETWORK_INTERFACE               "afr_utest0"
+
+#endif /* FREERTOS_IP_CONFIG_H */
@@ -0,0 +1,237 @@
+/*
+ * FreeRTOS+TCP V2.3.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* The same tests are built against FreeRTOS_IP.c compiled for each checksum
+ * backend, see CMakeLists.txt. */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "portableDefs.h"
+#include "FreeRTOS.h"
+
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_DHCP.h"
+
+/* Buffers for the tests, with room for the offsets. */
+static uint8_t ucData[ 2048 + 64 ];
+static uint8_t ucSource[ 600 ];
+static uint8_t ucDestination[ 600 ];
+
+/* ==========================   STUBS  ====================================== */
+
+/* FreeRTOS_IP.c refers to these, they are not used by the checksum tests. */
+void FreeRTOS_ClearARP( void )
+{
+}
+
+void vDHCPProcess( BaseType_t xReset )
+{
+    ( void ) xReset;
+}
+
+/* ==========================   HELPERS  ==================================== */
+
+/*
+ * A plain implementation of the Internet checksum of RFC 1071, with the
+ * conventions of usGenerateChecksum(): the sums are in host order, and when the
+ * data starts at an odd address the initial sum ends up byte-swapped.
+ */
+static uint16_t prvReferenceChecksum( uint16_t usSum,
+                                      const uint8_t * pucData,
+                                      size_t uxLength )
+{
+    uint32_t ulSum = usSum;
+    size_t uxIndex;
+
+    if( ( ( ( uintptr_t ) pucData ) & 1U ) != 0U )
+    {
+        ulSum = ( uint32_t ) ( ( ( usSum & 0xFFU ) << 8 ) | ( usSum >> 8 ) );
+    }
+
+    for( uxIndex = 0U; ( uxIndex + 1U ) < uxLength; uxIndex += 2U )
+    {
+        ulSum += ( ( uint32_t ) pucData[ uxIndex ] << 8 ) | pucData[ uxIndex + 1U ];
+    }
+
+    if( ( uxLength & 1U ) != 0U )
+    {
+        ulSum += ( uint32_t ) pucData[ uxLength - 1U ] << 8;
+    }
+
+    while( ( ulSum >> 16 ) != 0U )
+    {
+        ulSum = ( ulSum & 0xFFFFU ) + ( ulSum >> 16 );
+    }
+
+    return ( uint16_t ) ulSum;
+}
+
+/*
+ * Fill a buffer with pseudo-random bytes.
+ */
+static void prvFillRandom( uint8_t * pucBuffer,
+                           size_t uxLength,
+                           uint32_t ulSeed )
+{
+    uint32_t ulRandom = ulSeed;
+    size_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < uxLength; uxIndex++ )
+    {
+        ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+        pucBuffer[ uxIndex ] = ( uint8_t ) ( ulRandom >> 16 );
+    }
+}
+
+/* ============================   UNITY FIXTURES ============================ */
+void setUp( void )
+{
+    prvFillRandom( ucData, sizeof( ucData ), 0x12345678UL );
+    prvFillRandom( ucSource, sizeof( ucSource ), 0x87654321UL );
+    memset( ucDestination, 0, sizeof( ucDestination ) );
+}
+
+/* called after each testcase */
+void tearDown( void )
+{
+}
+
+/* called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/* called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return( numFailures > 0 );
+}
+
+/* ======================  TESTING usGenerateChecksum  ====================== */
+
+/*!
+ * @brief All alignments, and lengths around the sizes of the blocks that the
+ *        backends handle at once, give the checksum of the reference.
+ */
+void test_usGenerateChecksum_CrossCheck( void )
+{
+    const uint16_t usSeeds[] = { 0x0000U, 0x1234U, 0xFFFFU };
+    size_t uxOffset, uxLength, uxSeed;
+
+    for( uxOffset = 0U; uxOffset < 64U; uxOffset++ )
+    {
+        for( uxLength = 0U; uxLength < 300U; uxLength++ )
+        {
+            for( uxSeed = 0U; uxSeed < ( sizeof( usSeeds ) / sizeof( usSeeds[ 0 ] ) ); uxSeed++ )
+            {
+                TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( usSeeds[ uxSeed ], &( ucData[ uxOffset ] ), uxLength ),
+                                         usGenerateChecksum( usSeeds[ uxSeed ], &( ucData[ uxOffset ] ), uxLength ) );
+            }
+        }
+
+        TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, &( ucData[ uxOffset ] ), 2048U ),
+                                 usGenerateChecksum( 0U, &( ucData[ uxOffset ] ), 2048U ) );
+    }
+}
+
+/*!
+ * @brief Data of all ones produces a carry from every addition.
+ */
+void test_usGenerateChecksum_Carries( void )
+{
+    memset( ucData, 0xFF, sizeof( ucData ) );
+
+    TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0xFFFFU, &( ucData[ 1 ] ), 2047U ),
+                             usGenerateChecksum( 0xFFFFU, &( ucData[ 1 ] ), 2047U ) );
+    TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0xFFFFU, ucData, 2048U ),
+                             usGenerateChecksum( 0xFFFFU, ucData, 2048U ) );
+}
+
+/* ======================  TESTING usGenerateChecksumCopy  ================== */
+
+/*!
+ * @brief The source and the destination may have a different alignment, the
+ *        checksum is the one of the data and the data is copied.
+ */
+void test_usGenerateChecksumCopy_Alignments( void )
+{
+    size_t uxSourceOffset, uxDestinationOffset, uxLength;
+
+    for( uxSourceOffset = 0U; uxSourceOffset < 16U; uxSourceOffset++ )
+    {
+        for( uxDestinationOffset = 0U; uxDestinationOffset < 16U; uxDestinationOffset++ )
+        {
+            for( uxLength = 0U; uxLength < 300U; uxLength += 7U )
+            {
+                memset( ucDestination, 0, sizeof( ucDestination ) );
+                TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, &( ucSource[ uxSourceOffset ] ), uxLength ),
+                                         usGenerateChecksumCopy( 0U, &( ucDestination[ uxDestinationOffset ] ), &( ucSource[ uxSourceOffset ] ), uxLength ) );
+                TEST_ASSERT_EQUAL_MEMORY( &( ucSource[ uxSourceOffset ] ), &( ucDestination[ uxDestinationOffset ] ), uxLength );
+            }
+        }
+    }
+}
+
+/*!
+ * @brief Nothing is written beyond the bytes that are copied.
+ */
+void test_usGenerateChecksumCopy_NoOverrun( void )
+{
+    size_t uxLength;
+
+    for( uxLength = 0U; uxLength < 64U; uxLength++ )
+    {
+        memset( ucDestination, 0xA5, sizeof( ucDestination ) );
+        ( void ) usGenerateChecksumCopy( 0U, &( ucDestination[ 1 ] ), ucSource, uxLength );
+
+        TEST_ASSERT_EQUAL_HEX8( 0xA5U, ucDestination[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0xA5U, ucDestination[ uxLength + 1U ] );
+    }
+}
+
+/* ======================  TESTING usChecksumCombine  ======================= */
+
+/*!
+ * @brief Sums of two parts, as used when a stream buffer wraps around, give
+ *        the checksum of the whole.
+ */
+void test_usChecksumCombine_Split( void )
+{
+    size_t uxSplit;
+    uint16_t usFirst, usSecond;
+
+    for( uxSplit = 0U; uxSplit < 64U; uxSplit++ )
+    {
+        usFirst = usGenerateChecksum( 0U, ucSource, uxSplit );
+        usSecond = usGenerateChecksum( 0U, &( ucSource[ uxSplit ] ), 500U - uxSplit );
+
+        TEST_ASSERT_EQUAL_HEX16( prvReferenceChecksum( 0U, ucSource, 500U ),
+                                 usChecksumCombine( usFirst, usSecond, uxSplit ) );
+    }
+}
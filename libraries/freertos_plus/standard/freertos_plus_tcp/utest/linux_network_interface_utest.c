@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS+TCP V2.3.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#include <stdint.h>
+
+#include "unity.h"
+
+#include "portableDefs.h"
+#include "FreeRTOS.h"
+
+#include "mock_task.h"
+#include "mock_portable.h"
+#include "mock_NetworkBufferManagement.h"
+#include "mock_FreeRTOS_IP_Private.h"
+
+#include "FreeRTOS_IP.h"
+#include "NetworkInterface.h"
+
+#include "iot_freertos_tcp_test_access_declare.h"
+
+/* The MAC-address that the driver uses to recognise its own frames. */
+uint8_t ucMACAddress[ 6 ] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x41 };
+
+/* Network buffers handed out by the mocked pxGetNetworkBufferWithDescriptor(). */
+static NetworkBufferDescriptor_t xBuffers[ configLINUX_RX_POSTED_BUFFERS + 1U ];
+static uint8_t ucFrames[ configLINUX_RX_POSTED_BUFFERS + 1U ][ ipTOTAL_ETHERNET_FRAME_SIZE ];
+
+/* ============================   UNITY FIXTURES ============================ */
+void setUp( void )
+{
+    size_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < ( configLINUX_RX_POSTED_BUFFERS + 1U ); uxIndex++ )
+    {
+        xBuffers[ uxIndex ].pucEthernetBuffer = ucFrames[ uxIndex ];
+    }
+}
+
+/* called after each testcase */
+void tearDown( void )
+{
+}
+
+/* called at the beginning of the whole suite */
+void suiteSetUp()
+{
+}
+
+/* called at the end of the whole suite */
+int suiteTearDown( int numFailures )
+{
+    return( numFailures > 0 );
+}
+
+/* ======================  TESTING xNetworkInterfaceInitialise  ============= */
+
+/*!
+ * @brief The interface does not exist: initialisation fails without starting
+ *        the interrupt simulator task, so the IP-task can try again later.
+ */
+void test_xNetworkInterfaceInitialise_NoInterface( void )
+{
+    BaseType_t xResult;
+
+    xResult = xNetworkInterfaceInitialise();
+
+    TEST_ASSERT_EQUAL( pdFAIL, xResult );
+
+    /* A second attempt fails in the same way. */
+    xResult = xNetworkInterfaceInitialise();
+
+    TEST_ASSERT_EQUAL( pdFAIL, xResult );
+}
+
+/* ======================  TESTING prvPostRxBuffers  ======================== */
+
+/*!
+ * @brief The pool is empty: nothing is posted, and the next call asks again.
+ */
+void test_prvPostRxBuffers_PoolEmpty( void )
+{
+    pxGetNetworkBufferWithDescriptor_ExpectAndReturn( ipTOTAL_ETHERNET_FRAME_SIZE, 0, NULL );
+
+    TEST_FreeRTOS_TCP_prvPostRxBuffers();
+}
+
+/*!
+ * @brief No more than configLINUX_RX_POSTED_BUFFERS network buffers are lent to
+ *        the receive thread, however many entries the ring has.
+ */
+void test_prvPostRxBuffers_Capped( void )
+{
+    size_t uxIndex;
+
+    for( uxIndex = 0U; uxIndex < configLINUX_RX_POSTED_BUFFERS; uxIndex++ )
+    {
+        pxGetNetworkBufferWithDescriptor_ExpectAndReturn( ipTOTAL_ETHERNET_FRAME_SIZE, 0, &( xBuffers[ uxIndex ] ) );
+    }
+
+    TEST_FreeRTOS_TCP_prvPostRxBuffers();
+
+    /* The receive thread has not consumed any of them, so no more buffers
+     * are taken from the pool. */
+    TEST_FreeRTOS_TCP_prvPostRxBuffers();
+}
@@ -0,0 +1,46 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_benchmark_mbedtls_config.h
+ * @brief Additions to aws_mbedtls_config.h for the TLS benchmark, included
+ * through MBEDTLS_USER_CONFIG_FILE.
+ *
+ * Everything the client uses is left as configured in aws_mbedtls_config.h,
+ * so that the results apply to devices. Only the modules needed by the
+ * in-process server are added.
+ */
+
+#ifndef _IOT_TLS_BENCHMARK_MBEDTLS_CONFIG_H_
+#define _IOT_TLS_BENCHMARK_MBEDTLS_CONFIG_H_
+
+/* TLS server, with a session cache for session ID resumption. */
+#define MBEDTLS_SSL_SRV_C
+#define MBEDTLS_SSL_CACHE_C
+
+/* Creation and parsing of RFC 5077 session tickets by the server. */
+#define MBEDTLS_SSL_TICKET_C
+
+#endif /* _IOT_TLS_BENCHMARK_MBEDTLS_CONFIG_H_ */
@@ -0,0 +1,989 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_benchmark.c
+ * @brief Measures the TLS library on the host, against an in-process server.
+ *
+ * Reports the latency of full and resumed handshakes, how much of the time
+ * of the client goes to RSA, ECDSA and ECDHE, and how fast the client
+ * encrypts and decrypts application data with each cipher suite. The client
+ * uses the mbedTLS PKCS #11 module, with its objects stored in files.
+ *
+ * The public key operations are timed by wrapping the mbedTLS functions that
+ * perform them with the --wrap option of the GNU linker.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "iot_tls.h"
+#include "iot_crypto.h"
+#include "iot_pkcs11_config.h"
+#include "iot_pkcs11.h"
+#include "aws_dev_mode_key_provisioning.h"
+#include "iot_tls_benchmark.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/ssl.h"
+#include "mbedtls/rsa.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+
+/* C runtime includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#if ( tlsconfigCACHE_SESSIONS != 1 )
+    #error "The TLS benchmark needs tlsconfigCACHE_SESSIONS to measure resumed handshakes"
+#endif
+
+/**
+ * @brief Directory with the test certificates and keys.
+ */
+#ifndef benchmarkKEY_DIRECTORY
+    #define benchmarkKEY_DIRECTORY    "keys"
+#endif
+
+/**
+ * @brief Default number of handshakes measured for each row.
+ */
+#define benchmarkDEFAULT_HANDSHAKES    ( 20 )
+
+/**
+ * @brief Default number of KiB sent in each direction, for each cipher suite.
+ */
+#define benchmarkDEFAULT_BULK_KIB      ( 1024 )
+
+/**
+ * @brief Default number of bytes passed to each TLS_Send and TLS_Recv.
+ */
+#define benchmarkDEFAULT_CHUNK_SIZE    ( 4096 )
+
+/**
+ * @brief Port passed to TLS_Init, which only uses it to find sessions.
+ */
+#define benchmarkSERVER_PORT           ( 443 )
+
+/**
+ * @brief Public key operations that are timed.
+ */
+typedef enum BenchmarkOperation
+{
+    eOperationRsa = 0, /**< RSA signatures and verifications. */
+    eOperationEcdsa,   /**< ECDSA signatures and verifications. */
+    eOperationEcdhe,   /**< ECDH key generation and shared secret. */
+    eOperationCount
+} BenchmarkOperation_t;
+
+/**
+ * @brief Time spent in one kind of operation.
+ */
+typedef struct BenchmarkOperationStats
+{
+    uint64_t ullTime;
+    uint32_t ulCount;
+} BenchmarkOperationStats_t;
+
+/**
+ * @brief Kinds of handshakes that are measured.
+ */
+typedef enum BenchmarkHandshake
+{
+    eHandshakeFull = 0,  /**< No session is offered. */
+    eHandshakeSessionId, /**< The session is resumed from the cache of the server. */
+    eHandshakeTicket,    /**< The session is resumed from a ticket. */
+    eHandshakeCount
+} BenchmarkHandshake_t;
+
+/**
+ * @brief Sums over the measured handshakes of one kind.
+ */
+typedef struct BenchmarkHandshakeResult
+{
+    uint32_t ulCount;
+    uint64_t ullTime;       /**< TLS_Init and TLS_Connect, both ends. */
+    uint64_t ullServerTime; /**< Part of ullTime spent by the server. */
+    BenchmarkOperationStats_t xOperations[ eOperationCount ];
+} BenchmarkHandshakeResult_t;
+
+/**
+ * @brief A key exchange whose handshakes are measured.
+ */
+typedef struct BenchmarkProfile
+{
+    const char * pcName;
+    const char * pcCiphersuite;
+    const char * pcClientCertificate; /**< File name in benchmarkKEY_DIRECTORY. */
+    const char * pcClientKey;         /**< File name in benchmarkKEY_DIRECTORY. */
+} BenchmarkProfile_t;
+
+/*-----------------------------------------------------------*/
+
+static const BenchmarkProfile_t xProfiles[] =
+{
+    { "ECDHE-ECDSA", "TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256", "ec_client.crt",  "ec_client.key"  },
+    { "ECDHE-RSA",   "TLS-ECDHE-RSA-WITH-AES-128-GCM-SHA256",   "rsa_client.crt", "rsa_client.key" }
+};
+
+static const char * const pcHandshakeNames[ eHandshakeCount ] =
+{
+    "full",
+    "resumed, session ID",
+    "resumed, ticket"
+};
+
+/**
+ * @brief Cipher suites whose record throughput is measured. Suites that are
+ * not enabled in the mbedTLS configuration are reported as such.
+ */
+static const char * const pcBulkCiphersuites[] =
+{
+    "TLS-ECDHE-ECDSA-WITH-AES-128-GCM-SHA256",
+    "TLS-ECDHE-ECDSA-WITH-AES-256-GCM-SHA384",
+    "TLS-ECDHE-ECDSA-WITH-AES-128-CBC-SHA256",
+    "TLS-ECDHE-ECDSA-WITH-AES-128-CBC-SHA",
+    "TLS-ECDHE-ECDSA-WITH-AES-128-CCM",
+    "TLS-ECDHE-ECDSA-WITH-CHACHA20-POLY1305-SHA256",
+    "TLS-ECDHE-RSA-WITH-AES-128-GCM-SHA256",
+    "TLS-ECDHE-RSA-WITH-AES-256-GCM-SHA384",
+    "TLS-ECDHE-RSA-WITH-AES-128-CBC-SHA256",
+    "TLS-ECDHE-RSA-WITH-CHACHA20-POLY1305-SHA256",
+    NULL
+};
+
+/**
+ * @brief Time spent in public key operations, by the client [ 0 ] and by
+ * the server [ 1 ].
+ */
+static BenchmarkOperationStats_t xOperationStats[ 2 ][ eOperationCount ];
+
+/**
+ * @brief Root certificates of the client, which are also the CAs of the
+ * client certificates.
+ */
+static BenchmarkPem_t xCaChain;
+
+/**
+ * @brief Largest record that the server may send, passed to TLS_Init.
+ */
+static uint32_t ulMaxFragmentLength = 0;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Adds the time since ullStart to an operation of the side that runs.
+ */
+static void prvCountOperation( BenchmarkOperation_t xOperation,
+                               uint64_t ullStart )
+{
+    BenchmarkOperationStats_t * pxStats = NULL;
+
+    pxStats = &xOperationStats[ ( pdTRUE == xBenchmarkServerIsRunning() ) ? 1 : 0 ][ xOperation ];
+    pxStats->ullTime += ullBenchmarkTime() - ullStart;
+    pxStats->ulCount++;
+}
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Wrappers of the public key operations. The TLS protocol, the X.509 code and
+ * the PKCS #11 module reach them through the mbedTLS pk layer, which is in a
+ * different object file, so the linker sends those calls here.
+ */
+
+int __real_mbedtls_rsa_pkcs1_sign( mbedtls_rsa_context * pxContext,
+                                   int ( * pxRng )( void *, unsigned char *, size_t ),
+                                   void * pvRng,
+                                   int lMode,
+                                   mbedtls_md_type_t xMdAlg,
+                                   unsigned int ulHashLength,
+                                   const unsigned char * pucHash,
+                                   unsigned char * pucSignature );
+
+int __wrap_mbedtls_rsa_pkcs1_sign( mbedtls_rsa_context * pxContext,
+                                   int ( * pxRng )( void *, unsigned char *, size_t ),
+                                   void * pvRng,
+                                   int lMode,
+                                   mbedtls_md_type_t xMdAlg,
+                                   unsigned int ulHashLength,
+                                   const unsigned char * pucHash,
+                                   unsigned char * pucSignature )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_rsa_pkcs1_sign( pxContext, pxRng, pvRng, lMode, xMdAlg, ulHashLength, pucHash, pucSignature );
+
+    prvCountOperation( eOperationRsa, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * pxContext,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng,
+                                     int lMode,
+                                     mbedtls_md_type_t xMdAlg,
+                                     unsigned int ulHashLength,
+                                     const unsigned char * pucHash,
+                                     const unsigned char * pucSignature );
+
+int __wrap_mbedtls_rsa_pkcs1_verify( mbedtls_rsa_context * pxContext,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng,
+                                     int lMode,
+                                     mbedtls_md_type_t xMdAlg,
+                                     unsigned int ulHashLength,
+                                     const unsigned char * pucHash,
+                                     const unsigned char * pucSignature )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_rsa_pkcs1_verify( pxContext, pxRng, pvRng, lMode, xMdAlg, ulHashLength, pucHash, pucSignature );
+
+    prvCountOperation( eOperationRsa, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_ecdsa_write_signature( mbedtls_ecdsa_context * pxContext,
+                                          mbedtls_md_type_t xMdAlg,
+                                          const unsigned char * pucHash,
+                                          size_t xHashLength,
+                                          unsigned char * pucSignature,
+                                          size_t * pxSignatureLength,
+                                          int ( * pxRng )( void *, unsigned char *, size_t ),
+                                          void * pvRng );
+
+int __wrap_mbedtls_ecdsa_write_signature( mbedtls_ecdsa_context * pxContext,
+                                          mbedtls_md_type_t xMdAlg,
+                                          const unsigned char * pucHash,
+                                          size_t xHashLength,
+                                          unsigned char * pucSignature,
+                                          size_t * pxSignatureLength,
+                                          int ( * pxRng )( void *, unsigned char *, size_t ),
+                                          void * pvRng )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_ecdsa_write_signature( pxContext, xMdAlg, pucHash, xHashLength, pucSignature, pxSignatureLength, pxRng, pvRng );
+
+    prvCountOperation( eOperationEcdsa, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_ecdsa_read_signature( mbedtls_ecdsa_context * pxContext,
+                                         const unsigned char * pucHash,
+                                         size_t xHashLength,
+                                         const unsigned char * pucSignature,
+                                         size_t xSignatureLength );
+
+int __wrap_mbedtls_ecdsa_read_signature( mbedtls_ecdsa_context * pxContext,
+                                         const unsigned char * pucHash,
+                                         size_t xHashLength,
+                                         const unsigned char * pucSignature,
+                                         size_t xSignatureLength )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_ecdsa_read_signature( pxContext, pucHash, xHashLength, pucSignature, xSignatureLength );
+
+    prvCountOperation( eOperationEcdsa, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_ecdh_make_params( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng );
+
+int __wrap_mbedtls_ecdh_make_params( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_ecdh_make_params( pxContext, pxOutputLength, pucBuffer, xBufferLength, pxRng, pvRng );
+
+    prvCountOperation( eOperationEcdhe, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_ecdh_make_public( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng );
+
+int __wrap_mbedtls_ecdh_make_public( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_ecdh_make_public( pxContext, pxOutputLength, pucBuffer, xBufferLength, pxRng, pvRng );
+
+    prvCountOperation( eOperationEcdhe, ullStart );
+
+    return lResult;
+}
+
+int __real_mbedtls_ecdh_calc_secret( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng );
+
+int __wrap_mbedtls_ecdh_calc_secret( mbedtls_ecdh_context * pxContext,
+                                     size_t * pxOutputLength,
+                                     unsigned char * pucBuffer,
+                                     size_t xBufferLength,
+                                     int ( * pxRng )( void *, unsigned char *, size_t ),
+                                     void * pvRng )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    int lResult = __real_mbedtls_ecdh_calc_secret( pxContext, pxOutputLength, pucBuffer, xBufferLength, pxRng, pvRng );
+
+    prvCountOperation( eOperationEcdhe, ullStart );
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reads a PEM file from benchmarkKEY_DIRECTORY, and appends it to
+ * pxPem, which may be empty.
+ *
+ * @return pdPASS on success.
+ */
+static BaseType_t prvReadPem( const char * pcFileName,
+                              BenchmarkPem_t * pxPem )
+{
+    BaseType_t xResult = pdFAIL;
+    char cPath[ 512 ];
+    FILE * pxFile = NULL;
+    long lSize = -1;
+    size_t xOffset = ( pxPem->xLength > 0U ) ? ( pxPem->xLength - 1U ) : 0U;
+    unsigned char * pucData = NULL;
+
+    ( void ) snprintf( cPath, sizeof( cPath ), "%s/%s", benchmarkKEY_DIRECTORY, pcFileName );
+    pxFile = fopen( cPath, "rb" );
+
+    if( ( NULL != pxFile ) && ( 0 == fseek( pxFile, 0, SEEK_END ) ) )
+    {
+        lSize = ftell( pxFile );
+    }
+
+    if( ( lSize > 0 ) && ( 0 == fseek( pxFile, 0, SEEK_SET ) ) )
+    {
+        /* Make room for the file, and for the NUL that mbedTLS needs at the
+         * end of PEM data. */
+        pucData = realloc( pxPem->pucData, xOffset + ( size_t ) lSize + 1U );
+    }
+
+    if( NULL != pucData )
+    {
+        pxPem->pucData = pucData;
+
+        if( ( size_t ) lSize == fread( &pucData[ xOffset ], 1, ( size_t ) lSize, pxFile ) )
+        {
+            pucData[ xOffset + ( size_t ) lSize ] = '\0';
+            pxPem->xLength = xOffset + ( size_t ) lSize + 1U;
+            xResult = pdPASS;
+        }
+    }
+
+    if( NULL != pxFile )
+    {
+        ( void ) fclose( pxFile );
+    }
+
+    if( pdPASS != xResult )
+    {
+        printf( "ERROR: Could not read %s\n", cPath );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Frees the data read by prvReadPem.
+ */
+static void prvFreePem( BenchmarkPem_t * pxPem )
+{
+    free( pxPem->pucData );
+    pxPem->pucData = NULL;
+    pxPem->xLength = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Imports a client certificate and private key into the PKCS #11
+ * module.
+ *
+ * @return CKR_OK on success.
+ */
+static CK_RV prvProvisionClient( const BenchmarkProfile_t * pxProfile )
+{
+    CK_RV xResult = CKR_FUNCTION_FAILED;
+    ProvisioningParams_t xParams = { 0 };
+    BenchmarkPem_t xCertificate = { 0 };
+    BenchmarkPem_t xKey = { 0 };
+
+    if( ( pdPASS == prvReadPem( pxProfile->pcClientCertificate, &xCertificate ) ) &&
+        ( pdPASS == prvReadPem( pxProfile->pcClientKey, &xKey ) ) )
+    {
+        xParams.pucClientCertificate = xCertificate.pucData;
+        xParams.ulClientCertificateLength = ( uint32_t ) xCertificate.xLength;
+        xParams.pucClientPrivateKey = xKey.pucData;
+        xParams.ulClientPrivateKeyLength = ( uint32_t ) xKey.xLength;
+
+        xResult = vAlternateKeyProvisioning( &xParams );
+    }
+
+    prvFreePem( &xKey );
+    prvFreePem( &xCertificate );
+
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        TLS_FlushCredentialCache();
+    #endif
+
+    /* A resumed session would keep the old client identity. */
+    TLS_FlushSessionCache();
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Opens a connection to the server.
+ *
+ * @param[out] ppvTls Set to the TLS context, which must be passed to
+ * TLS_Cleanup even if the connection failed.
+ *
+ * @return 0 on success, or the error of TLS_Init or TLS_Connect.
+ */
+static BaseType_t prvConnect( void ** ppvTls )
+{
+    BaseType_t xResult = 0;
+    TLSParams_t xParams = { 0 };
+
+    *ppvTls = NULL;
+
+    xParams.ulSize = sizeof( xParams );
+    xParams.pcDestination = benchmarkSERVER_NAME;
+    xParams.pcServerCertificate = ( const char * ) xCaChain.pucData;
+    xParams.ulServerCertificateLength = ( uint32_t ) xCaChain.xLength;
+    xParams.pxNetworkRecv = xBenchmarkPipeRecv;
+    xParams.pxNetworkSend = xBenchmarkPipeSend;
+    xParams.pvCallerContext = NULL;
+    xParams.usDestinationPort = benchmarkSERVER_PORT;
+    xParams.ulMaxFragmentLength = ulMaxFragmentLength;
+
+    vBenchmarkServerAccept();
+
+    xResult = TLS_Init( ppvTls, &xParams );
+
+    if( 0 == xResult )
+    {
+        xResult = TLS_Connect( *ppvTls );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Lets the server finish what it was given, and checks that it did.
+ *
+ * @return 0 on success, or the error of the server.
+ */
+static int prvFinishServer( void )
+{
+    while( ( lBenchmarkServerStatus() > 0 ) && ( pdTRUE == xBenchmarkServerRun() ) )
+    {
+    }
+
+    return lBenchmarkServerStatus();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Measures handshakes of one kind, with the cipher suites that the
+ * server has been configured with.
+ *
+ * @return 0 on success.
+ */
+static BaseType_t prvMeasureHandshakes( BenchmarkHandshake_t xHandshake,
+                                        uint32_t ulCount,
+                                        BenchmarkHandshakeResult_t * pxResult )
+{
+    BaseType_t xResult = 0;
+    void * pvTls = NULL;
+    uint32_t ulIndex = 0;
+    uint32_t ulOperation = 0;
+    uint64_t ullStart = 0;
+    uint64_t ullServerStart = 0;
+    TLSHandshakeCounters_t xBefore = { 0 };
+    TLSHandshakeCounters_t xAfter = { 0 };
+
+    memset( pxResult, 0, sizeof( *pxResult ) );
+
+    /* Start without a session, and get one to resume if needed. */
+    TLS_FlushSessionCache();
+
+    if( eHandshakeFull != xHandshake )
+    {
+        xResult = prvConnect( &pvTls );
+        TLS_Cleanup( pvTls );
+    }
+
+    for( ulIndex = 0; ( 0 == xResult ) && ( ulIndex < ulCount ); ulIndex++ )
+    {
+        if( eHandshakeFull == xHandshake )
+        {
+            TLS_FlushSessionCache();
+        }
+
+        TLS_GetHandshakeCounters( &xBefore );
+        memset( xOperationStats, 0, sizeof( xOperationStats ) );
+        ullServerStart = ullBenchmarkServerTime();
+        ullStart = ullBenchmarkTime();
+
+        xResult = prvConnect( &pvTls );
+
+        pxResult->ullTime += ullBenchmarkTime() - ullStart;
+        pxResult->ullServerTime += ullBenchmarkServerTime() - ullServerStart;
+        TLS_GetHandshakeCounters( &xAfter );
+
+        /* In a resumed handshake the client sends the last message, which
+         * the server still has to check. */
+        if( 0 == xResult )
+        {
+            xResult = prvFinishServer();
+        }
+
+        if( ( 0 == xResult ) &&
+            ( ( eHandshakeFull == xHandshake ) !=
+              ( xAfter.ulFullHandshakes != xBefore.ulFullHandshakes ) ) )
+        {
+            printf( "ERROR: The server did not %s the session\n",
+                    ( eHandshakeFull == xHandshake ) ? "refuse" : "resume" );
+            xResult = -1;
+        }
+
+        for( ulOperation = 0; ulOperation < eOperationCount; ulOperation++ )
+        {
+            pxResult->xOperations[ ulOperation ].ullTime += xOperationStats[ 0 ][ ulOperation ].ullTime;
+            pxResult->xOperations[ ulOperation ].ulCount += xOperationStats[ 0 ][ ulOperation ].ulCount;
+        }
+
+        pxResult->ulCount++;
+        TLS_Cleanup( pvTls );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Prints the averages of prvMeasureHandshakes.
+ */
+static void prvPrintHandshakes( const char * pcProfile,
+                                BenchmarkHandshake_t xHandshake,
+                                const BenchmarkHandshakeResult_t * pxResult )
+{
+    char cName[ 64 ];
+    char cCell[ eOperationCount ][ 32 ];
+    double dCount = ( double ) pxResult->ulCount;
+    uint64_t ullClientTime = pxResult->ullTime - pxResult->ullServerTime;
+    uint64_t ullOther = ullClientTime;
+    uint32_t ulOperation = 0;
+
+    for( ulOperation = 0; ulOperation < eOperationCount; ulOperation++ )
+    {
+        ( void ) snprintf( cCell[ ulOperation ], sizeof( cCell[ ulOperation ] ), "%.1f (%.1f)",
+                           ( double ) pxResult->xOperations[ ulOperation ].ullTime / dCount / 1000.0,
+                           ( double ) pxResult->xOperations[ ulOperation ].ulCount / dCount );
+        ullOther -= pxResult->xOperations[ ulOperation ].ullTime;
+    }
+
+    ( void ) snprintf( cName, sizeof( cName ), "%s, %s", pcProfile, pcHandshakeNames[ xHandshake ] );
+    printf( "%-32s %10.1f %10.1f %10.1f %16s %16s %16s %10.1f\n",
+            cName,
+            ( double ) pxResult->ullTime / dCount / 1000.0,
+            ( double ) pxResult->ullServerTime / dCount / 1000.0,
+            ( double ) ullClientTime / dCount / 1000.0,
+            cCell[ eOperationRsa ],
+            cCell[ eOperationEcdsa ],
+            cCell[ eOperationEcdhe ],
+            ( double ) ullOther / dCount / 1000.0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sends and then receives xTotal bytes of application data over a new
+ * connection, with the cipher suites that the server has been configured with.
+ *
+ * @param[out] pullSendTime Time the client spent in TLS_Send.
+ * @param[out] pullRecvTime Time the client spent in TLS_Recv.
+ *
+ * @return 0 on success.
+ */
+static BaseType_t prvMeasureBulk( size_t xTotal,
+                                  size_t xChunkSize,
+                                  uint64_t * pullSendTime,
+                                  uint64_t * pullRecvTime )
+{
+    BaseType_t xResult = 0;
+    void * pvTls = NULL;
+    unsigned char * pucBuffer = NULL;
+    size_t xDone = 0;
+    size_t xLength = 0;
+    uint64_t ullStart = 0;
+    uint64_t ullServerStart = 0;
+
+    pucBuffer = malloc( xChunkSize );
+
+    if( NULL == pucBuffer )
+    {
+        xResult = -1;
+    }
+    else
+    {
+        memset( pucBuffer, 0x5A, xChunkSize );
+
+        /* Negotiate the configured suite, instead of resuming the last one. */
+        TLS_FlushSessionCache();
+        xResult = prvConnect( &pvTls );
+    }
+
+    if( 0 == xResult )
+    {
+        vBenchmarkServerSink( xTotal );
+        ullServerStart = ullBenchmarkServerTime();
+        ullStart = ullBenchmarkTime();
+
+        for( xDone = 0; ( 0 == xResult ) && ( xDone < xTotal ); )
+        {
+            xLength = ( ( xTotal - xDone ) < xChunkSize ) ? ( xTotal - xDone ) : xChunkSize;
+            xResult = TLS_Send( pvTls, pucBuffer, xLength );
+
+            if( xResult > 0 )
+            {
+                xDone += ( size_t ) xResult;
+                xResult = 0;
+            }
+            else if( 0 == xResult )
+            {
+                xResult = -1;
+            }
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = prvFinishServer();
+        }
+
+        *pullSendTime = ( ullBenchmarkTime() - ullStart ) - ( ullBenchmarkServerTime() - ullServerStart );
+    }
+
+    if( 0 == xResult )
+    {
+        vBenchmarkServerSource( xTotal );
+        ullServerStart = ullBenchmarkServerTime();
+        ullStart = ullBenchmarkTime();
+
+        for( xDone = 0; ( 0 == xResult ) && ( xDone < xTotal ); )
+        {
+            xLength = ( ( xTotal - xDone ) < xChunkSize ) ? ( xTotal - xDone ) : xChunkSize;
+            xResult = TLS_Recv( pvTls, pucBuffer, xLength );
+
+            if( xResult > 0 )
+            {
+                xDone += ( size_t ) xResult;
+                xResult = 0;
+            }
+            else if( 0 == xResult )
+            {
+                xResult = -1;
+            }
+        }
+
+        *pullRecvTime = ( ullBenchmarkTime() - ullStart ) - ( ullBenchmarkServerTime() - ullServerStart );
+    }
+
+    TLS_Cleanup( pvTls );
+    free( pucBuffer );
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Removes the PKCS #11 objects that the PAL stored in the working
+ * directory, and the directory itself.
+ */
+static void prvRemoveWorkingDirectory( const char * pcDirectory )
+{
+    DIR * pxDirectory = opendir( "." );
+    struct dirent * pxEntry = NULL;
+
+    if( NULL != pxDirectory )
+    {
+        while( NULL != ( pxEntry = readdir( pxDirectory ) ) )
+        {
+            if( ( 0 != strcmp( pxEntry->d_name, "." ) ) && ( 0 != strcmp( pxEntry->d_name, ".." ) ) )
+            {
+                ( void ) unlink( pxEntry->d_name );
+            }
+        }
+
+        ( void ) closedir( pxDirectory );
+    }
+
+    if( 0 == chdir( "/" ) )
+    {
+        ( void ) rmdir( pcDirectory );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvUsage( const char * pcProgram )
+{
+    printf( "Usage: %s [-n handshakes] [-b KiB] [-c chunk] [-f max_fragment_length]\n"
+            "  -n  handshakes measured for each row (default %d)\n"
+            "  -b  KiB sent and received for each cipher suite (default %d)\n"
+            "  -c  bytes passed to each TLS_Send and TLS_Recv (default %d)\n"
+            "  -f  max_fragment_length asked from the server: 512, 1024, 2048 or 4096\n"
+            "      (default tlsconfigMAX_FRAGMENT_LENGTH)\n",
+            pcProgram,
+            benchmarkDEFAULT_HANDSHAKES,
+            benchmarkDEFAULT_BULK_KIB,
+            benchmarkDEFAULT_CHUNK_SIZE );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    BaseType_t xResult = pdPASS;
+    int lOption = 0;
+    uint32_t ulHandshakes = benchmarkDEFAULT_HANDSHAKES;
+    size_t xBulkSize = benchmarkDEFAULT_BULK_KIB * 1024U;
+    size_t xChunkSize = benchmarkDEFAULT_CHUNK_SIZE;
+    char cWorkingDirectory[] = "/tmp/tls_benchmark_XXXXXX";
+    BenchmarkPem_t xServerPem[ 4 ] = { 0 };
+    const char * const pcServerFiles[ 4 ] = { "rsa_server.crt", "rsa_server.key", "ec_server.crt", "ec_server.key" };
+    int lSuites[ 2 ] = { 0 };
+    BenchmarkHandshakeResult_t xHandshakeResult = { 0 };
+    BenchmarkHandshake_t xHandshake = eHandshakeFull;
+    uint64_t ullSendTime = 0;
+    uint64_t ullRecvTime = 0;
+    size_t xIndex = 0;
+    int lServerResult = 0;
+
+    while( -1 != ( lOption = getopt( argc, argv, "n:b:c:f:h" ) ) )
+    {
+        switch( lOption )
+        {
+            case 'n':
+                ulHandshakes = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 'b':
+                xBulkSize = ( size_t ) strtoul( optarg, NULL, 10 ) * 1024U;
+                break;
+
+            case 'c':
+                xChunkSize = ( size_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            case 'f':
+                ulMaxFragmentLength = ( uint32_t ) strtoul( optarg, NULL, 10 );
+                break;
+
+            default:
+                xResult = pdFAIL;
+                break;
+        }
+    }
+
+    if( ( pdPASS != xResult ) || ( 0U == ulHandshakes ) || ( 0U == xChunkSize ) )
+    {
+        prvUsage( argv[ 0 ] );
+
+        return EXIT_FAILURE;
+    }
+
+    /* Read the files before leaving the current directory. */
+    xResult = prvReadPem( "rsa_ca.crt", &xCaChain );
+
+    if( pdPASS == xResult )
+    {
+        xResult = prvReadPem( "ec_ca.crt", &xCaChain );
+    }
+
+    for( xIndex = 0; ( pdPASS == xResult ) && ( xIndex < 4U ); xIndex++ )
+    {
+        xResult = prvReadPem( pcServerFiles[ xIndex ], &xServerPem[ xIndex ] );
+    }
+
+    /* The PKCS #11 PAL stores its objects in the working directory. */
+    if( ( pdPASS == xResult ) &&
+        ( ( NULL == mkdtemp( cWorkingDirectory ) ) || ( 0 != chdir( cWorkingDirectory ) ) ) )
+    {
+        printf( "ERROR: Could not create a working directory\n" );
+        xResult = pdFAIL;
+    }
+
+    if( pdPASS == xResult )
+    {
+        CRYPTO_Init();
+        lServerResult = lBenchmarkServerInit( &xCaChain, &xServerPem[ 0 ], &xServerPem[ 1 ], &xServerPem[ 2 ], &xServerPem[ 3 ] );
+
+        if( 0 != lServerResult )
+        {
+            printf( "ERROR: Could not set up the server: -0x%04X\n", ( unsigned int ) -lServerResult );
+            xResult = pdFAIL;
+        }
+    }
+
+    if( pdPASS == xResult )
+    {
+        printf( "Record sizes: in %d, out %d bytes; max_fragment_length %u; send buffer %d bytes; cached credentials %d\n",
+                MBEDTLS_SSL_IN_CONTENT_LEN,
+                MBEDTLS_SSL_OUT_CONTENT_LEN,
+                ( unsigned int ) ( ( 0U != ulMaxFragmentLength ) ? ulMaxFragmentLength : tlsconfigMAX_FRAGMENT_LENGTH ),
+                tlsconfigSEND_BUFFER_SIZE,
+                tlsconfigCACHE_CREDENTIALS );
+        printf( "\nHandshakes: microseconds per connection; (operations per connection)\n" );
+        printf( "%-32s %10s %10s %10s %16s %16s %16s %10s\n",
+                "", "latency", "server", "client", "client RSA", "client ECDSA", "client ECDHE", "other" );
+    }
+
+    for( xIndex = 0; ( pdPASS == xResult ) && ( xIndex < ( sizeof( xProfiles ) / sizeof( xProfiles[ 0 ] ) ) ); xIndex++ )
+    {
+        lSuites[ 0 ] = mbedtls_ssl_get_ciphersuite_id( xProfiles[ xIndex ].pcCiphersuite );
+
+        if( 0 == lSuites[ 0 ] )
+        {
+            printf( "%-32s %s is not enabled\n", xProfiles[ xIndex ].pcName, xProfiles[ xIndex ].pcCiphersuite );
+            continue;
+        }
+
+        if( CKR_OK != prvProvisionClient( &xProfiles[ xIndex ] ) )
+        {
+            printf( "ERROR: Could not provision %s\n", xProfiles[ xIndex ].pcClientKey );
+            xResult = pdFAIL;
+        }
+
+        for( xHandshake = eHandshakeFull; ( pdPASS == xResult ) && ( xHandshake < eHandshakeCount ); xHandshake++ )
+        {
+            vBenchmarkServerConfigure( lSuites,
+                                       ( eHandshakeTicket == xHandshake ) ? eBenchmarkResumeTicket : eBenchmarkResumeSessionId );
+
+            if( 0 == prvMeasureHandshakes( xHandshake, ulHandshakes, &xHandshakeResult ) )
+            {
+                prvPrintHandshakes( xProfiles[ xIndex ].pcName, xHandshake, &xHandshakeResult );
+            }
+            else
+            {
+                printf( "ERROR: %s, %s handshake failed; server: -0x%04X\n",
+                        xProfiles[ xIndex ].pcName,
+                        pcHandshakeNames[ xHandshake ],
+                        ( unsigned int ) -lBenchmarkServerStatus() );
+                xResult = pdFAIL;
+            }
+        }
+    }
+
+    if( ( pdPASS == xResult ) && ( xBulkSize > 0U ) )
+    {
+        printf( "\nRecords: MiB/s of application data, client only; %u bytes per call\n", ( unsigned int ) xChunkSize );
+        printf( "%-48s %10s %10s\n", "", "TLS_Send", "TLS_Recv" );
+    }
+
+    for( xIndex = 0; ( pdPASS == xResult ) && ( xBulkSize > 0U ) && ( NULL != pcBulkCiphersuites[ xIndex ] ); xIndex++ )
+    {
+        lSuites[ 0 ] = mbedtls_ssl_get_ciphersuite_id( pcBulkCiphersuites[ xIndex ] );
+
+        if( 0 == lSuites[ 0 ] )
+        {
+            printf( "%-48s not enabled\n", pcBulkCiphersuites[ xIndex ] );
+            continue;
+        }
+
+        vBenchmarkServerConfigure( lSuites, eBenchmarkResumeSessionId );
+
+        if( 0 == prvMeasureBulk( xBulkSize, xChunkSize, &ullSendTime, &ullRecvTime ) )
+        {
+            printf( "%-48s %10.1f %10.1f\n",
+                    pcBulkCiphersuites[ xIndex ],
+                    ( ( double ) xBulkSize / ( 1024.0 * 1024.0 ) ) / ( ( double ) ullSendTime / 1e9 ),
+                    ( ( double ) xBulkSize / ( 1024.0 * 1024.0 ) ) / ( ( double ) ullRecvTime / 1e9 ) );
+        }
+        else
+        {
+            printf( "ERROR: %s transfer failed; server: -0x%04X\n",
+                    pcBulkCiphersuites[ xIndex ],
+                    ( unsigned int ) -lBenchmarkServerStatus() );
+            xResult = pdFAIL;
+        }
+    }
+
+    vBenchmarkServerFree();
+    prvRemoveWorkingDirectory( cWorkingDirectory );
+
+    for( xIndex = 0; xIndex < 4U; xIndex++ )
+    {
+        prvFreePem( &xServerPem[ xIndex ] );
+    }
+
+    prvFreePem( &xCaChain );
+
+    return ( pdPASS == xResult ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,181 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_benchmark.h
+ * @brief In-process TLS server and memory pipe used by the TLS benchmark.
+ *
+ * The server runs on the thread of the client. It is driven from the network
+ * callbacks of the client whenever the client waits for data, or for room to
+ * write, so that a connection needs neither sockets nor tasks.
+ */
+
+#ifndef _IOT_TLS_BENCHMARK_H_
+#define _IOT_TLS_BENCHMARK_H_
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h must appear in source files before include iot_tls_benchmark.h"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Server name in the test certificates.
+ */
+#define benchmarkSERVER_NAME    "tls-benchmark.local"
+
+/**
+ * @brief A PEM encoded object, as read from a file.
+ *
+ * @param[in] pucData The PEM text, followed by a terminating NUL.
+ * @param[in] xLength Length of the text in bytes, including the NUL.
+ */
+typedef struct BenchmarkPem
+{
+    unsigned char * pucData;
+    size_t xLength;
+} BenchmarkPem_t;
+
+/**
+ * @brief How the server lets clients resume a session.
+ */
+typedef enum BenchmarkResumption
+{
+    eBenchmarkResumeSessionId = 0, /**< Sessions are kept in a server-side cache. */
+    eBenchmarkResumeTicket         /**< Sessions are handed to the client in RFC 5077 tickets. */
+} BenchmarkResumption_t;
+
+/**
+ * @brief Sets up the server.
+ *
+ * The server asks for a client certificate, and authenticates itself with the
+ * RSA or the ECDSA certificate, depending on the cipher suite.
+ *
+ * @param[in] pxCaChain CA certificates that client certificates must chain to.
+ * @param[in] pxRsaCertificate Server certificate with an RSA key.
+ * @param[in] pxRsaKey Private key of pxRsaCertificate.
+ * @param[in] pxEcCertificate Server certificate with an EC key.
+ * @param[in] pxEcKey Private key of pxEcCertificate.
+ *
+ * @return 0 on success, or an mbedTLS error code.
+ */
+int lBenchmarkServerInit( const BenchmarkPem_t * pxCaChain,
+                          const BenchmarkPem_t * pxRsaCertificate,
+                          const BenchmarkPem_t * pxRsaKey,
+                          const BenchmarkPem_t * pxEcCertificate,
+                          const BenchmarkPem_t * pxEcKey );
+
+/**
+ * @brief Frees the resources of the server.
+ */
+void vBenchmarkServerFree( void );
+
+/**
+ * @brief Chooses the cipher suites and the session resumption mechanism of
+ * the following connections.
+ *
+ * @param[in] plCiphersuites 0 terminated list of cipher suite IDs that the
+ * server accepts. Must stay valid while the server is used.
+ * @param[in] xResumption How sessions can be resumed.
+ */
+void vBenchmarkServerConfigure( const int * plCiphersuites,
+                                BenchmarkResumption_t xResumption );
+
+/**
+ * @brief Empties the pipe and waits for the ClientHello of a new connection.
+ */
+void vBenchmarkServerAccept( void );
+
+/**
+ * @brief Makes the server read and discard application data.
+ *
+ * @param[in] xLength Number of bytes to read.
+ */
+void vBenchmarkServerSink( size_t xLength );
+
+/**
+ * @brief Makes the server write application data.
+ *
+ * @param[in] xLength Number of bytes to write.
+ */
+void vBenchmarkServerSource( size_t xLength );
+
+/**
+ * @brief Runs the server until it has to wait for the client.
+ *
+ * @return pdTRUE if the server moved any data or finished a step, pdFALSE if
+ * it could not do anything.
+ */
+BaseType_t xBenchmarkServerRun( void );
+
+/**
+ * @brief Reads whether the server finished all the work it was given.
+ *
+ * @return 0 if the server is idle, a negative mbedTLS error code if it
+ * failed, and 1 if it still has work to do.
+ */
+int lBenchmarkServerStatus( void );
+
+/**
+ * @brief Reads whether the calling code is run by the server.
+ *
+ * @return pdTRUE while inside xBenchmarkServerRun.
+ */
+BaseType_t xBenchmarkServerIsRunning( void );
+
+/**
+ * @brief Reads the time that the server has spent running.
+ *
+ * @return Nanoseconds spent in xBenchmarkServerRun since the server was set up.
+ */
+uint64_t ullBenchmarkServerTime( void );
+
+/**
+ * @brief Reads a monotonic clock.
+ *
+ * @return Current time in nanoseconds.
+ */
+uint64_t ullBenchmarkTime( void );
+
+/**
+ * @brief Network send callback of the client, see NetworkSend_t.
+ *
+ * Runs the server when the pipe to the server is full.
+ */
+BaseType_t xBenchmarkPipeSend( void * pvCallerContext,
+                               const unsigned char * pucData,
+                               size_t xDataLength );
+
+/**
+ * @brief Network receive callback of the client, see NetworkRecv_t.
+ *
+ * Runs the server until it has written data for the client.
+ */
+BaseType_t xBenchmarkPipeRecv( void * pvCallerContext,
+                               unsigned char * pucReceiveBuffer,
+                               size_t xReceiveLength );
+
+#endif /* ifndef _IOT_TLS_BENCHMARK_H_ */
@@ -0,0 +1,206 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_benchmark_port.c
+ * @brief The FreeRTOS kernel functions used by the TLS, PKCS #11 and crypto
+ * libraries, implemented on the Linux host for the TLS benchmark.
+ *
+ * The benchmark runs in one thread without a scheduler, so mutexes never
+ * block and critical sections only need to nest.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* C runtime includes. */
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/random.h>
+
+/**
+ * @brief Host side of a FreeRTOS mutex.
+ */
+struct QueueDefinition
+{
+    BaseType_t xTaken; /**< pdTRUE while the mutex is held. */
+};
+
+/**
+ * @brief Depth of the critical sections that have been entered.
+ */
+static UBaseType_t uxCriticalNesting = 0;
+
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    return malloc( xWantedSize );
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    free( pv );
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+    uxCriticalNesting++;
+}
+
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+    configASSERT( uxCriticalNesting > 0U );
+    uxCriticalNesting--;
+}
+
+/*-----------------------------------------------------------*/
+
+QueueHandle_t xQueueCreateMutex( const uint8_t ucQueueType )
+{
+    ( void ) ucQueueType;
+
+    return ( QueueHandle_t ) calloc( 1, sizeof( struct QueueDefinition ) );
+}
+
+/*-----------------------------------------------------------*/
+
+QueueHandle_t xQueueCreateMutexStatic( const uint8_t ucQueueType,
+                                       StaticQueue_t * pxStaticQueue )
+{
+    ( void ) pxStaticQueue;
+
+    /* The buffer is not needed: vQueueDelete frees mutexes of either kind,
+     * and the mbedTLS PKCS #11 module never deletes its static ones. */
+    return xQueueCreateMutex( ucQueueType );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueSemaphoreTake( QueueHandle_t xQueue,
+                                TickType_t xTicksToWait )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    /* A mutex that is already held would only be released by another task,
+     * so waiting for it would never end. */
+    ( void ) xTicksToWait;
+
+    if( pdFALSE == xQueue->xTaken )
+    {
+        xQueue->xTaken = pdTRUE;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueGenericSend( QueueHandle_t xQueue,
+                              const void * const pvItemToQueue,
+                              TickType_t xTicksToWait,
+                              const BaseType_t xCopyPosition )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    /* Only used to give mutexes. */
+    ( void ) pvItemToQueue;
+    ( void ) xTicksToWait;
+    ( void ) xCopyPosition;
+
+    if( pdTRUE == xQueue->xTaken )
+    {
+        xQueue->xTaken = pdFALSE;
+        xReturn = pdPASS;
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+void vQueueDelete( QueueHandle_t xQueue )
+{
+    free( xQueue );
+}
+
+/*-----------------------------------------------------------*/
+
+TickType_t xTaskGetTickCount( void )
+{
+    struct timespec xNow = { 0 };
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( TickType_t ) ( ( ( uint64_t ) xNow.tv_sec * configTICK_RATE_HZ ) +
+                            ( ( uint64_t ) xNow.tv_nsec / ( 1000000000ULL / configTICK_RATE_HZ ) ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void vTaskDelay( const TickType_t xTicksToDelay )
+{
+    ( void ) usleep( ( useconds_t ) xTicksToDelay * portTICK_PERIOD_MS * 1000U );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Entropy source of mbedTLS, see MBEDTLS_ENTROPY_HARDWARE_ALT.
+ */
+int mbedtls_hardware_poll( void * data,
+                           unsigned char * output,
+                           size_t len,
+                           size_t * olen )
+{
+    ssize_t xRead = 0;
+    int lResult = 0;
+
+    ( void ) data;
+
+    xRead = getrandom( output, len, 0 );
+
+    if( xRead < 0 )
+    {
+        *olen = 0;
+        lResult = -1;
+    }
+    else
+    {
+        *olen = ( size_t ) xRead;
+    }
+
+    return lResult;
+}
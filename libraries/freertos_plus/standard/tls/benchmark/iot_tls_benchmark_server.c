@@ -0,0 +1,573 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_benchmark_server.c
+ * @brief mbedTLS server that the TLS benchmark connects to through memory.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "iot_tls_benchmark.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+
+/* C runtime includes. */
+#include <string.h>
+#include <time.h>
+
+#if !defined( MBEDTLS_SSL_SRV_C ) || !defined( MBEDTLS_SSL_CACHE_C ) || !defined( MBEDTLS_SSL_TICKET_C )
+    #error "The TLS benchmark needs MBEDTLS_SSL_SRV_C, MBEDTLS_SSL_CACHE_C and MBEDTLS_SSL_TICKET_C"
+#endif
+
+/**
+ * @brief Bytes that each direction of the pipe can hold.
+ *
+ * Large enough for a full handshake flight, so that the handshake does not
+ * depend on how the two sides are interleaved.
+ */
+#define benchmarkPIPE_SIZE             ( 64 * 1024 )
+
+/**
+ * @brief Bytes of application data that the server reads or writes at once.
+ */
+#define benchmarkSERVER_CHUNK_SIZE     ( 16 * 1024 )
+
+/**
+ * @brief Lifetime of the session tickets issued by the server, in seconds.
+ */
+#define benchmarkTICKET_LIFETIME       ( 24 * 60 * 60 )
+
+/**
+ * @brief One direction of the pipe between the client and the server.
+ */
+typedef struct BenchmarkRing
+{
+    unsigned char ucData[ benchmarkPIPE_SIZE ];
+    size_t xHead;   /**< Index of the oldest byte. */
+    size_t xLength; /**< Number of bytes queued. */
+} BenchmarkRing_t;
+
+/**
+ * @brief What the server does when it is run.
+ */
+typedef enum BenchmarkServerState
+{
+    eServerIdle = 0,
+    eServerHandshake,
+    eServerSink,
+    eServerSource,
+    eServerFailed
+} BenchmarkServerState_t;
+
+/*-----------------------------------------------------------*/
+
+static BenchmarkRing_t xToServer;
+static BenchmarkRing_t xToClient;
+
+static mbedtls_entropy_context xEntropy;
+static mbedtls_ctr_drbg_context xDrbg;
+static mbedtls_x509_crt xCaChain;
+static mbedtls_x509_crt xRsaCertificate;
+static mbedtls_x509_crt xEcCertificate;
+static mbedtls_pk_context xRsaKey;
+static mbedtls_pk_context xEcKey;
+static mbedtls_ssl_cache_context xCache;
+static mbedtls_ssl_ticket_context xTicket;
+static mbedtls_ssl_config xConfig;
+static mbedtls_ssl_context xSsl;
+
+static BenchmarkServerState_t xState = eServerIdle;
+static int lLastError = 0;
+static size_t xPending = 0;
+static BaseType_t xRunning = pdFALSE;
+static uint64_t ullServerTime = 0;
+static uint64_t ullServerIo = 0;
+
+/**
+ * @brief Application data that the server reads into, or writes from.
+ */
+static unsigned char ucScratch[ benchmarkSERVER_CHUNK_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Appends data to one direction of the pipe.
+ *
+ * @return Number of bytes that fit.
+ */
+static size_t prvRingWrite( BenchmarkRing_t * pxRing,
+                            const unsigned char * pucData,
+                            size_t xLength )
+{
+    size_t xWritten = 0;
+    size_t xTail = 0;
+    size_t xChunk = 0;
+
+    while( ( xWritten < xLength ) && ( pxRing->xLength < benchmarkPIPE_SIZE ) )
+    {
+        xTail = ( pxRing->xHead + pxRing->xLength ) % benchmarkPIPE_SIZE;
+
+        /* Write up to the end of the free space, or of the array. */
+        if( xTail >= pxRing->xHead )
+        {
+            xChunk = benchmarkPIPE_SIZE - xTail;
+        }
+        else
+        {
+            xChunk = pxRing->xHead - xTail;
+        }
+
+        if( xChunk > ( xLength - xWritten ) )
+        {
+            xChunk = xLength - xWritten;
+        }
+
+        memcpy( &pxRing->ucData[ xTail ], &pucData[ xWritten ], xChunk );
+        pxRing->xLength += xChunk;
+        xWritten += xChunk;
+    }
+
+    return xWritten;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Takes the oldest data out of one direction of the pipe.
+ *
+ * @return Number of bytes read.
+ */
+static size_t prvRingRead( BenchmarkRing_t * pxRing,
+                           unsigned char * pucData,
+                           size_t xLength )
+{
+    size_t xRead = 0;
+    size_t xChunk = 0;
+
+    while( ( xRead < xLength ) && ( pxRing->xLength > 0U ) )
+    {
+        /* Read up to the end of the data, or of the array. */
+        xChunk = benchmarkPIPE_SIZE - pxRing->xHead;
+
+        if( xChunk > pxRing->xLength )
+        {
+            xChunk = pxRing->xLength;
+        }
+
+        if( xChunk > ( xLength - xRead ) )
+        {
+            xChunk = xLength - xRead;
+        }
+
+        memcpy( &pucData[ xRead ], &pxRing->ucData[ pxRing->xHead ], xChunk );
+        pxRing->xHead = ( pxRing->xHead + xChunk ) % benchmarkPIPE_SIZE;
+        pxRing->xLength -= xChunk;
+        xRead += xChunk;
+    }
+
+    return xRead;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Network send callback of the server.
+ */
+static int prvServerSend( void * pvContext,
+                          const unsigned char * pucData,
+                          size_t xDataLength )
+{
+    size_t xWritten = 0;
+
+    ( void ) pvContext;
+
+    xWritten = prvRingWrite( &xToClient, pucData, xDataLength );
+    ullServerIo += xWritten;
+
+    return ( 0U == xWritten ) ? MBEDTLS_ERR_SSL_WANT_WRITE : ( int ) xWritten;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Network receive callback of the server.
+ */
+static int prvServerRecv( void * pvContext,
+                          unsigned char * pucReceiveBuffer,
+                          size_t xReceiveLength )
+{
+    size_t xRead = 0;
+
+    ( void ) pvContext;
+
+    xRead = prvRingRead( &xToServer, pucReceiveBuffer, xReceiveLength );
+    ullServerIo += xRead;
+
+    return ( 0U == xRead ) ? MBEDTLS_ERR_SSL_WANT_READ : ( int ) xRead;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t ullBenchmarkTime( void )
+{
+    struct timespec xNow = { 0 };
+
+    ( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+int lBenchmarkServerInit( const BenchmarkPem_t * pxCaChain,
+                          const BenchmarkPem_t * pxRsaCertificate,
+                          const BenchmarkPem_t * pxRsaKey,
+                          const BenchmarkPem_t * pxEcCertificate,
+                          const BenchmarkPem_t * pxEcKey )
+{
+    int lResult = 0;
+
+    mbedtls_entropy_init( &xEntropy );
+    mbedtls_ctr_drbg_init( &xDrbg );
+    mbedtls_x509_crt_init( &xCaChain );
+    mbedtls_x509_crt_init( &xRsaCertificate );
+    mbedtls_x509_crt_init( &xEcCertificate );
+    mbedtls_pk_init( &xRsaKey );
+    mbedtls_pk_init( &xEcKey );
+    mbedtls_ssl_cache_init( &xCache );
+    mbedtls_ssl_ticket_init( &xTicket );
+    mbedtls_ssl_config_init( &xConfig );
+    mbedtls_ssl_init( &xSsl );
+
+    lResult = mbedtls_ctr_drbg_seed( &xDrbg, mbedtls_entropy_func, &xEntropy, NULL, 0 );
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_x509_crt_parse( &xCaChain, pxCaChain->pucData, pxCaChain->xLength );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_x509_crt_parse( &xRsaCertificate, pxRsaCertificate->pucData, pxRsaCertificate->xLength );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_x509_crt_parse( &xEcCertificate, pxEcCertificate->pucData, pxEcCertificate->xLength );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_pk_parse_key( &xRsaKey, pxRsaKey->pucData, pxRsaKey->xLength, NULL, 0 );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_pk_parse_key( &xEcKey, pxEcKey->pucData, pxEcKey->xLength, NULL, 0 );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_ssl_ticket_setup( &xTicket,
+                                            mbedtls_ctr_drbg_random,
+                                            &xDrbg,
+                                            MBEDTLS_CIPHER_AES_128_GCM,
+                                            benchmarkTICKET_LIFETIME );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_ssl_config_defaults( &xConfig,
+                                               MBEDTLS_SSL_IS_SERVER,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM,
+                                               MBEDTLS_SSL_PRESET_DEFAULT );
+    }
+
+    if( 0 == lResult )
+    {
+        mbedtls_ssl_conf_rng( &xConfig, mbedtls_ctr_drbg_random, &xDrbg );
+
+        /* Make the client sign with its PKCS #11 key in every full handshake. */
+        mbedtls_ssl_conf_authmode( &xConfig, MBEDTLS_SSL_VERIFY_REQUIRED );
+        mbedtls_ssl_conf_ca_chain( &xConfig, &xCaChain, NULL );
+
+        /* mbedTLS picks the certificate that fits the cipher suite. */
+        lResult = mbedtls_ssl_conf_own_cert( &xConfig, &xRsaCertificate, &xRsaKey );
+    }
+
+    if( 0 == lResult )
+    {
+        lResult = mbedtls_ssl_conf_own_cert( &xConfig, &xEcCertificate, &xEcKey );
+    }
+
+    if( 0 == lResult )
+    {
+        vBenchmarkServerConfigure( mbedtls_ssl_list_ciphersuites(), eBenchmarkResumeSessionId );
+        lResult = mbedtls_ssl_setup( &xSsl, &xConfig );
+    }
+
+    if( 0 == lResult )
+    {
+        mbedtls_ssl_set_bio( &xSsl, NULL, prvServerSend, prvServerRecv, NULL );
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkServerFree( void )
+{
+    mbedtls_ssl_free( &xSsl );
+    mbedtls_ssl_config_free( &xConfig );
+    mbedtls_ssl_ticket_free( &xTicket );
+    mbedtls_ssl_cache_free( &xCache );
+    mbedtls_pk_free( &xEcKey );
+    mbedtls_pk_free( &xRsaKey );
+    mbedtls_x509_crt_free( &xEcCertificate );
+    mbedtls_x509_crt_free( &xRsaCertificate );
+    mbedtls_x509_crt_free( &xCaChain );
+    mbedtls_ctr_drbg_free( &xDrbg );
+    mbedtls_entropy_free( &xEntropy );
+}
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkServerConfigure( const int * plCiphersuites,
+                                BenchmarkResumption_t xResumption )
+{
+    mbedtls_ssl_conf_ciphersuites( &xConfig, plCiphersuites );
+
+    /* Offer only one way to resume, so that it is known which one is measured. */
+    if( eBenchmarkResumeTicket == xResumption )
+    {
+        mbedtls_ssl_conf_session_cache( &xConfig, NULL, NULL, NULL );
+        mbedtls_ssl_conf_session_tickets_cb( &xConfig,
+                                             mbedtls_ssl_ticket_write,
+                                             mbedtls_ssl_ticket_parse,
+                                             &xTicket );
+    }
+    else
+    {
+        mbedtls_ssl_conf_session_cache( &xConfig,
+                                        &xCache,
+                                        mbedtls_ssl_cache_get,
+                                        mbedtls_ssl_cache_set );
+        mbedtls_ssl_conf_session_tickets_cb( &xConfig, NULL, NULL, NULL );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkServerAccept( void )
+{
+    /* Drop whatever is left of the last connection, such as its close_notify. */
+    memset( &xToServer, 0, sizeof( xToServer ) );
+    memset( &xToClient, 0, sizeof( xToClient ) );
+
+    lLastError = mbedtls_ssl_session_reset( &xSsl );
+    xPending = 0;
+    xState = ( 0 == lLastError ) ? eServerHandshake : eServerFailed;
+}
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkServerSink( size_t xLength )
+{
+    if( eServerIdle == xState )
+    {
+        xPending = xLength;
+        xState = ( xLength > 0U ) ? eServerSink : eServerIdle;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vBenchmarkServerSource( size_t xLength )
+{
+    if( eServerIdle == xState )
+    {
+        xPending = xLength;
+        xState = ( xLength > 0U ) ? eServerSource : eServerIdle;
+
+        /* Any pattern will do; mbedTLS encrypts it anyway. */
+        memset( ucScratch, 0xA5, sizeof( ucScratch ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkServerRun( void )
+{
+    uint64_t ullStart = ullBenchmarkTime();
+    uint64_t ullIo = ullServerIo;
+    BenchmarkServerState_t xStartState = xState;
+    size_t xChunk = 0;
+    int lResult = 0;
+
+    xRunning = pdTRUE;
+
+    while( ( lResult >= 0 ) && ( eServerIdle != xState ) && ( eServerFailed != xState ) )
+    {
+        xChunk = ( xPending < sizeof( ucScratch ) ) ? xPending : sizeof( ucScratch );
+
+        switch( xState )
+        {
+            case eServerHandshake:
+                lResult = mbedtls_ssl_handshake( &xSsl );
+
+                if( 0 == lResult )
+                {
+                    xState = eServerIdle;
+                }
+
+                break;
+
+            case eServerSink:
+                lResult = mbedtls_ssl_read( &xSsl, ucScratch, xChunk );
+
+                if( 0 == lResult )
+                {
+                    /* The client closed the connection before all data arrived. */
+                    lResult = MBEDTLS_ERR_SSL_CONN_EOF;
+                }
+
+                break;
+
+            case eServerSource:
+                /* After MBEDTLS_ERR_SSL_WANT_WRITE this repeats the same
+                 * call, as mbedTLS requires. */
+                lResult = mbedtls_ssl_write( &xSsl, ucScratch, xChunk );
+                break;
+
+            default:
+                break;
+        }
+
+        if( ( lResult > 0 ) && ( eServerHandshake != xState ) )
+        {
+            xPending -= ( size_t ) lResult;
+
+            if( 0U == xPending )
+            {
+                xState = eServerIdle;
+            }
+        }
+    }
+
+    if( ( lResult < 0 ) &&
+        ( MBEDTLS_ERR_SSL_WANT_READ != lResult ) &&
+        ( MBEDTLS_ERR_SSL_WANT_WRITE != lResult ) )
+    {
+        lLastError = lResult;
+        xState = eServerFailed;
+    }
+
+    xRunning = pdFALSE;
+    ullServerTime += ullBenchmarkTime() - ullStart;
+
+    return ( ( ullIo != ullServerIo ) || ( xStartState != xState ) ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+int lBenchmarkServerStatus( void )
+{
+    int lStatus = 1;
+
+    if( eServerIdle == xState )
+    {
+        lStatus = 0;
+    }
+    else if( eServerFailed == xState )
+    {
+        lStatus = lLastError;
+    }
+
+    return lStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkServerIsRunning( void )
+{
+    return xRunning;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t ullBenchmarkServerTime( void )
+{
+    return ullServerTime;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkPipeSend( void * pvCallerContext,
+                               const unsigned char * pucData,
+                               size_t xDataLength )
+{
+    size_t xWritten = 0;
+
+    ( void ) pvCallerContext;
+
+    xWritten = prvRingWrite( &xToServer, pucData, xDataLength );
+
+    /* Let the server make room. */
+    while( ( 0U == xWritten ) && ( pdTRUE == xBenchmarkServerRun() ) )
+    {
+        xWritten = prvRingWrite( &xToServer, pucData, xDataLength );
+    }
+
+    return ( 0U == xWritten ) ? MBEDTLS_ERR_NET_SEND_FAILED : ( BaseType_t ) xWritten;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xBenchmarkPipeRecv( void * pvCallerContext,
+                               unsigned char * pucReceiveBuffer,
+                               size_t xReceiveLength )
+{
+    ( void ) pvCallerContext;
+
+    /* Run the server until it answers. If it stops without answering, the
+     * client would wait forever on a real network. */
+    while( ( 0U == xToClient.xLength ) && ( pdTRUE == xBenchmarkServerRun() ) )
+    {
+    }
+
+    return ( 0U == xToClient.xLength ) ?
+           MBEDTLS_ERR_NET_RECV_FAILED :
+           ( BaseType_t ) prvRingRead( &xToClient, pucReceiveBuffer, xReceiveLength );
+}
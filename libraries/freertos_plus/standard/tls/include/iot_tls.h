@@ -30,6 +30,8 @@
     #error "include FreeRTOS.h must appear in source files before include iot_tls.h"
 #endif
 
+#include "iot_tls_config_defaults.h"
+
 /**
  * @defgroup TlsErrors TLS Error Codes
  * @brief Error codes returned by the TLS API.
@@ -84,6 +86,10 @@ typedef BaseType_t ( * NetworkSend_t )( void * pvCallerContext,
  * @param[in] pxNetworkSend Caller-defined network send function pointer.
  * @param[in] pvCallerContext Caller-defined context handle to be used with callback
  * functions.
+ * @param[in] usDestinationPort Port of the TLS server, in network byte order,
+ * or 0 if not known. Used to look up sessions to resume.
+ * @param[in] ulMaxFragmentLength Largest record that the server may send: 512,
+ * 1024, 2048 or 4096. 0 to use tlsconfigMAX_FRAGMENT_LENGTH.
  */
 typedef struct xTLS_PARAMS
 {
@@ -97,8 +103,25 @@ typedef struct xTLS_PARAMS
     NetworkRecv_t pxNetworkRecv;
     NetworkSend_t pxNetworkSend;
     void * pvCallerContext;
+    uint16_t usDestinationPort;
+    uint32_t ulMaxFragmentLength;
 } TLSParams_t;
 
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+
+/**
+ * @brief Counts the handshakes done by TLS_Connect.
+ *
+ * @param[out] ulFullHandshakes Successful handshakes with a key exchange.
+ * @param[out] ulResumedHandshakes Successful handshakes that resumed a cached session.
+ */
+    typedef struct xTLS_HANDSHAKE_COUNTERS
+    {
+        uint32_t ulFullHandshakes;
+        uint32_t ulResumedHandshakes;
+    } TLSHandshakeCounters_t;
+#endif
+
 /**
  * @brief Initializes the TLS context.
  *
@@ -133,6 +156,33 @@ BaseType_t TLS_Recv( void * pvContext,
                      unsigned char * pucReadBuffer,
                      size_t xReadLength );
 
+/**
+ * @brief Gives access to the decrypted data of the current record, without
+ * copying it.
+ *
+ * Decrypts the next record if all data of the current one has been consumed.
+ * The data stays valid until it is consumed with TLS_Consume, or until the
+ * next call to TLS_Recv.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param ppucData Set to the first byte that has not been consumed yet.
+ *
+ * @return Number of bytes available at *ppucData. Error return codes have the
+ * high bit set.
+ */
+BaseType_t TLS_Peek( void * pvContext,
+                     const unsigned char ** ppucData );
+
+/**
+ * @brief Marks data returned by TLS_Peek as read.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param xLength Number of bytes to consume, at most the number returned by
+ * the last call to TLS_Peek.
+ */
+void TLS_Consume( void * pvContext,
+                  size_t xLength );
+
 /**
  * @brief Writes the requested number of bytes to the secure connection.
  *
@@ -146,6 +196,28 @@ BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength );
 
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+
+/**
+ * @brief Queues bytes to be sent together with the bytes of a later call.
+ *
+ * The bytes are collected until a full record can be written, or until the
+ * next call to TLS_Send, which sends them in front of its own bytes. A call to
+ * TLS_Send with a length of 0 only sends the collected bytes. When the socket
+ * has no room for them, they stay queued, and no bytes are accepted until a
+ * later call has sent them.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pucMsg Plaintext data to be sent.
+ * @param xMsgLength Length of the data.
+ *
+ * @return Number of bytes accepted. Error return codes have the high bit set.
+ */
+    BaseType_t TLS_SendMore( void * pvContext,
+                             const unsigned char * pucMsg,
+                             size_t xMsgLength );
+#endif
+
 /**
  * @brief Frees resources consumed by the TLS context.
  *
@@ -153,4 +225,44 @@ BaseType_t TLS_Send( void * pvContext,
  */
 void TLS_Cleanup( void * pvContext );
 
+#if ( tlsconfigCACHE_CREDENTIALS == 1 )
+
+/**
+ * @brief Drops the cached credentials, so that the next TLS_Connect reads
+ * them from the PKCS #11 module again.
+ *
+ * Must be called after the device certificate, the private key or the JITP
+ * certificate have been changed. Connections that are negotiating keep using
+ * the old credentials until they are done.
+ */
+    void TLS_FlushCredentialCache( void );
+
+/**
+ * @brief Reads the number of times that the credentials were read from the
+ * PKCS #11 module and parsed into a new cache.
+ *
+ * @return The number of cache loads.
+ */
+    uint32_t TLS_GetCredentialCacheLoads( void );
+#endif
+
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+
+/**
+ * @brief Forgets all cached sessions, so that the next TLS_Connect to each
+ * server does a full handshake.
+ *
+ * Should be called after the client credentials have been changed, because a
+ * resumed session keeps the identity that the client had when it was created.
+ */
+    void TLS_FlushSessionCache( void );
+
+/**
+ * @brief Reads the numbers of full and resumed handshakes.
+ *
+ * @param[out] pxCounters Filled with the counters.
+ */
+    void TLS_GetHandshakeCounters( TLSHandshakeCounters_t * pxCounters );
+#endif
+
 #endif /* ifndef __AWS__TLS__H__ */
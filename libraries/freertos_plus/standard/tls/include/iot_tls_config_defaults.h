@@ -0,0 +1,112 @@
+/*
+ * FreeRTOS TLS V1.2.0
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tls_config_defaults.h
+ * @brief Sets the optional TLS configuration options to sane values if the
+ * user does not supply them, e.g. in FreeRTOSConfig.h.
+ */
+
+#ifndef AWS_INC_TLS_CONFIG_DEFAULTS_H_
+#define AWS_INC_TLS_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Share the parsed credentials between TLS connections.
+ *
+ * When set to 1, the parsed root CA chain, the parsed client certificate chain
+ * and the PKCS #11 handle of the private key are kept in a reference-counted
+ * cache that is used by every TLS_Connect, in stead of being read and parsed
+ * for each connection. Code that changes the PKCS #11 objects must call
+ * TLS_FlushCredentialCache afterwards.
+ */
+#ifndef tlsconfigCACHE_CREDENTIALS
+    #define tlsconfigCACHE_CREDENTIALS    ( 0 )
+#endif
+
+/**
+ * @brief Resume earlier TLS sessions with the same server.
+ *
+ * When set to 1, the session of each successful handshake is saved in a
+ * client-side cache, keyed by the server name, the port and the trusted root
+ * CAs. The next TLS_Connect to that server with the same root CAs offers the
+ * session, either by its session ID or by the RFC 5077 ticket that the server
+ * has issued, and skips the key exchange and the certificate verification if
+ * the server accepts it. Tickets require MBEDTLS_SSL_SESSION_TICKETS, which a
+ * board enables in its own mbedTLS configuration.
+ */
+#ifndef tlsconfigCACHE_SESSIONS
+    #define tlsconfigCACHE_SESSIONS    ( 0 )
+#endif
+
+/**
+ * @brief The number of servers that sessions are kept for, when
+ * tlsconfigCACHE_SESSIONS is 1.
+ *
+ * When the cache is full, the least recently used session is replaced.
+ */
+#ifndef tlsconfigSESSION_CACHE_ENTRIES
+    #define tlsconfigSESSION_CACHE_ENTRIES    ( 4 )
+#endif
+
+#if ( tlsconfigCACHE_SESSIONS == 1 ) && ( tlsconfigSESSION_CACHE_ENTRIES < 1 )
+    #error "tlsconfigSESSION_CACHE_ENTRIES must be at least 1"
+#endif
+
+/**
+ * @brief The largest record that the server may send, in bytes.
+ *
+ * When not 0, the RFC 6066 max_fragment_length extension is included in the
+ * ClientHello of every connection that does not set its own value. Must be
+ * 512, 1024, 2048 or 4096, and requires MBEDTLS_SSL_MAX_FRAGMENT_LENGTH in the
+ * mbedTLS configuration. Builds that only talk to servers supporting the
+ * extension can then shrink MBEDTLS_SSL_IN_CONTENT_LEN and
+ * MBEDTLS_SSL_OUT_CONTENT_LEN to this value.
+ */
+#ifndef tlsconfigMAX_FRAGMENT_LENGTH
+    #define tlsconfigMAX_FRAGMENT_LENGTH    ( 0 )
+#endif
+
+#if ( tlsconfigMAX_FRAGMENT_LENGTH != 0 ) &&  \
+    ( tlsconfigMAX_FRAGMENT_LENGTH != 512 ) &&  \
+    ( tlsconfigMAX_FRAGMENT_LENGTH != 1024 ) && \
+    ( tlsconfigMAX_FRAGMENT_LENGTH != 2048 ) && \
+    ( tlsconfigMAX_FRAGMENT_LENGTH != 4096 )
+    #error "tlsconfigMAX_FRAGMENT_LENGTH must be 0, 512, 1024, 2048 or 4096"
+#endif
+
+/**
+ * @brief The most plaintext bytes that TLS_SendMore collects before it writes
+ * them as one record.
+ *
+ * When not 0, every connection allocates a buffer of this size after the
+ * handshake, capped at the largest record payload that was negotiated with the
+ * server. Small writes made with TLS_SendMore are appended to it, and are sent
+ * together with the next TLS_Send, in stead of one record each.
+ */
+#ifndef tlsconfigSEND_BUFFER_SIZE
+    #define tlsconfigSEND_BUFFER_SIZE    ( 0 )
+#endif
+
+#endif /* AWS_INC_TLS_CONFIG_DEFAULTS_H_ */
@@ -31,6 +31,7 @@
 #include "iot_pkcs11_config.h"
 #include "iot_pkcs11.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_clientcredential_keys.h"
 #include "iot_default_root_certificates.h"
 #include "iot_pki_utils.h"
@@ -44,6 +45,7 @@
 #include "mbedtls/pk.h"
 #include "mbedtls/pk_internal.h"
 #include "mbedtls/debug.h"
+#include "mbedtls/version.h"
 #ifdef MBEDTLS_DEBUG_C
     #define tlsDEBUG_VERBOSE    4
 #endif
@@ -104,6 +106,17 @@ static const char * pNoLowLevelMbedTlsCodeStr = "<No-Low-Level-Code>";
  * @param[out] pxP11FunctionList PKCS#11 function list structure.
  * @param[out] xP11Session PKCS#11 session context.
  * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[out] pxCredentials Shared credentials used while negotiating.
+ * @param[out] usDestinationPort Server port, to look up sessions to resume.
+ * @param[out] ucDestinationHash SHA-256 of the server name and trusted root CAs, to look up sessions to resume.
+ * @param[out] xSessionCacheable Non-zero if ucDestinationHash is valid.
+ * @param[out] xSessionOffered Non-zero if a cached session was offered to the server.
+ * @param[out] xServerCertificateVerified Non-zero if the server sent its certificate.
+ * @param[out] ulMaxFragmentLength Largest record that the server may send, or 0 for the default.
+ * @param[out] pucSendBuffer Plaintext queued by TLS_SendMore.
+ * @param[out] xSendBufferSize Size of pucSendBuffer, or 0 if it was not allocated.
+ * @param[out] xSendBufferLength Number of bytes queued in pucSendBuffer.
+ * @param[out] xSendBufferBlocked Non-zero if mbedTLS holds the record of pucSendBuffer that the socket had no room for.
  */
 typedef struct TLSContext
 {
@@ -132,6 +145,27 @@ typedef struct TLSContext
     CK_SESSION_HANDLE xP11Session;
     CK_OBJECT_HANDLE xP11PrivateKey;
     CK_KEY_TYPE xKeyType;
+
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        struct TLSCredentialCache * pxCredentials;
+    #endif
+
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        uint16_t usDestinationPort;
+        unsigned char ucDestinationHash[ 32 ];
+        BaseType_t xSessionCacheable;
+        BaseType_t xSessionOffered;
+        BaseType_t xServerCertificateVerified;
+    #endif
+
+    uint32_t ulMaxFragmentLength;
+
+    #if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+        unsigned char * pucSendBuffer;
+        size_t xSendBufferSize;
+        size_t xSendBufferLength;
+        BaseType_t xSendBufferBlocked;
+    #endif
 } TLSContext_t;
 
 #define TLS_HANDSHAKE_NOT_STARTED    ( 0 )      /* Must be 0 */
@@ -140,6 +174,92 @@ typedef struct TLSContext
 
 #define TLS_PRINT( X )    configPRINTF( X )
 
+#if ( tlsconfigMAX_FRAGMENT_LENGTH != 0 ) && !defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH )
+    #error "tlsconfigMAX_FRAGMENT_LENGTH requires MBEDTLS_SSL_MAX_FRAGMENT_LENGTH"
+#endif
+
+/* TLS_Peek and TLS_Consume access the record buffer of the SSL context in the
+ * same way as mbedtls_ssl_read() of mbedTLS 2.16. Check them again when
+ * mbedTLS is updated. */
+#if ( MBEDTLS_VERSION_MAJOR != 2 ) || ( MBEDTLS_VERSION_MINOR != 16 )
+    #error "TLS_Peek and TLS_Consume depend on the SSL context fields of mbedTLS 2.16"
+#endif
+
+#if ( tlsconfigCACHE_CREDENTIALS == 1 )
+
+/**
+ * @brief Credentials that are shared by all TLS connections.
+ *
+ * The cache is immutable once created. It is freed when it has been flushed
+ * and the last connection that uses it has released it.
+ *
+ * @param[out] ulReferenceCount Number of users, including pxCredentialCache.
+ * @param[out] xMbedX509CA Parsed root CA chain.
+ * @param[out] xMbedX509Cli Parsed client certificate chain.
+ * @param[out] xP11PrivateKey PKCS#11 private key handle.
+ * @param[out] xKeyType PKCS#11 private key type.
+ * @param[out] xDefaultServerCertificate Non-zero if xMbedX509CA holds the default root CAs.
+ * @param[out] ucServerCertificateHash SHA-256 of the PEM that xMbedX509CA was parsed from.
+ */
+    typedef struct TLSCredentialCache
+    {
+        uint32_t ulReferenceCount;
+        mbedtls_x509_crt xMbedX509CA;
+        mbedtls_x509_crt xMbedX509Cli;
+        CK_OBJECT_HANDLE xP11PrivateKey;
+        CK_KEY_TYPE xKeyType;
+        BaseType_t xDefaultServerCertificate;
+        unsigned char ucServerCertificateHash[ 32 ];
+    } TLSCredentialCache_t;
+
+/**
+ * @brief The credentials that will be used by the next TLS_Connect.
+ */
+    static TLSCredentialCache_t * pxCredentialCache = NULL;
+
+/**
+ * @brief The number of times that the credentials were read into a new cache.
+ */
+    static uint32_t ulCredentialCacheLoads = 0;
+#endif /* if ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+
+/**
+ * @brief A session that can be offered to a server to resume it.
+ *
+ * @param[out] xInUse Non-zero if xSession holds a session.
+ * @param[out] usDestinationPort Port of the server.
+ * @param[out] ucDestinationHash SHA-256 of the server name and trusted root CAs.
+ * @param[out] xLastUsed Time at which the session was last stored or offered.
+ * @param[out] xSession The session ID or ticket, with the master secret.
+ */
+    typedef struct TLSSessionCacheEntry
+    {
+        BaseType_t xInUse;
+        uint16_t usDestinationPort;
+        unsigned char ucDestinationHash[ 32 ];
+        TickType_t xLastUsed;
+        mbedtls_ssl_session xSession;
+    } TLSSessionCacheEntry_t;
+
+/**
+ * @brief The session cache, protected by xSessionCacheMutex.
+ */
+    static TLSSessionCacheEntry_t xSessionCache[ tlsconfigSESSION_CACHE_ENTRIES ];
+
+/**
+ * @brief Mutex that protects xSessionCache and xHandshakeCounters, created
+ * when first needed.
+ */
+    static SemaphoreHandle_t xSessionCacheMutex = NULL;
+
+/**
+ * @brief Numbers of full and resumed handshakes.
+ */
+    static TLSHandshakeCounters_t xHandshakeCounters = { 0 };
+#endif /* if ( tlsconfigCACHE_SESSIONS == 1 ) */
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -170,6 +290,19 @@ static void prvFreeContext( TLSContext_t * pxCtx )
             pxCtx->pxP11FunctionList->C_CloseSession( pxCtx->xP11Session ); /*lint !e534 This function always return CKR_OK. */
         }
 
+        #if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+            /* Queued bytes cannot be sent any more. */
+            if( NULL != pxCtx->pucSendBuffer )
+            {
+                vPortFree( pxCtx->pucSendBuffer );
+                pxCtx->pucSendBuffer = NULL;
+            }
+
+            pxCtx->xSendBufferSize = 0;
+            pxCtx->xSendBufferLength = 0;
+            pxCtx->xSendBufferBlocked = pdFALSE;
+        #endif
+
         pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_NOT_STARTED;
     }
 }
@@ -272,8 +405,19 @@ static int prvCheckCertificate( void * pvCtx,
     int lCompilationDay = 0;
     const char cMonths[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
 
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        {
+            /* The server certificate is only verified in a full handshake. */
+            ( ( TLSContext_t * ) pvCtx )->xServerCertificateVerified = pdTRUE; /*lint !e9087 !e9079 Allow casting void* to other types. */
+        }
+    #else
+        {
+            /* Unreferenced parameters. */
+            ( void ) ( pvCtx );
+        }
+    #endif
+
     /* Unreferenced parameters. */
-    ( void ) ( pvCtx );
     ( void ) ( lPathCount );
 
     /* Parse the date string fields. */
@@ -516,50 +660,32 @@ static int prvReadCertificateIntoContext( TLSContext_t * pxTlsContext,
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Helper for setting up potentially hardware-based cryptographic context
- * for the client TLS certificate and private key.
+ * @brief Helper for reading the handle and type of the private key and the
+ * client certificate chain out of storage.
  *
- * @param Caller context.
+ * @param[in] pxCtx Caller TLS context, holding a logged-in PKCS #11 session.
+ * @param[out] pxPrivateKey Handle of the private key.
+ * @param[out] pxKeyType Type of the private key.
+ * @param[out] pxClientCertificate Client certificate chain, must be initialized.
  *
  * @return Zero on success.
  */
-static int prvInitializeClientCredential( TLSContext_t * pxCtx )
+static int prvReadClientCredential( TLSContext_t * pxCtx,
+                                    CK_OBJECT_HANDLE * pxPrivateKey,
+                                    CK_KEY_TYPE * pxKeyType,
+                                    mbedtls_x509_crt * pxClientCertificate )
 {
     BaseType_t xResult = CKR_OK;
-    CK_ULONG xCount = 0;
     CK_ATTRIBUTE xTemplate[ 2 ];
-    mbedtls_pk_type_t xKeyAlgo = ( mbedtls_pk_type_t ) ~0;
     char * pcJitrCertificate = keyJITR_DEVICE_CERTIFICATE_AUTHORITY_PEM;
 
-    /* Initialize the mbed contexts. */
-    mbedtls_x509_crt_init( &pxCtx->xMbedX509Cli );
-
-    if( pxCtx->xP11Session == CK_INVALID_HANDLE )
-    {
-        xResult = CKR_SESSION_HANDLE_INVALID;
-        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
-    }
-
-    /* Put the module in authenticated mode. */
-    if( CKR_OK == xResult )
-    {
-        pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_STARTED;
-        xResult = ( BaseType_t ) pxCtx->pxP11FunctionList->C_Login( pxCtx->xP11Session,
-                                                                    CKU_USER,
-                                                                    ( CK_UTF8CHAR_PTR ) configPKCS11_DEFAULT_USER_PIN,
-                                                                    sizeof( configPKCS11_DEFAULT_USER_PIN ) - 1 );
-    }
-
-    if( CKR_OK == xResult )
-    {
-        /* Get the handle of the device private key. */
-        xResult = xFindObjectWithLabelAndClass( pxCtx->xP11Session,
-                                                pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
-                                                CKO_PRIVATE_KEY,
-                                                &pxCtx->xP11PrivateKey );
-    }
+    /* Get the handle of the device private key. */
+    xResult = xFindObjectWithLabelAndClass( pxCtx->xP11Session,
+                                            pkcs11configLABEL_DEVICE_PRIVATE_KEY_FOR_TLS,
+                                            CKO_PRIVATE_KEY,
+                                            pxPrivateKey );
 
-    if( ( CKR_OK == xResult ) && ( pxCtx->xP11PrivateKey == CK_INVALID_HANDLE ) )
+    if( ( CKR_OK == xResult ) && ( *pxPrivateKey == CK_INVALID_HANDLE ) )
     {
         xResult = TLS_ERROR_NO_PRIVATE_KEY;
         TLS_PRINT( ( "ERROR: Private key not found. " ) );
@@ -569,50 +695,21 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
     if( xResult == CKR_OK )
     {
         xTemplate[ 0 ].type = CKA_KEY_TYPE;
-        xTemplate[ 0 ].pValue = &pxCtx->xKeyType;
+        xTemplate[ 0 ].pValue = pxKeyType;
         xTemplate[ 0 ].ulValueLen = sizeof( CK_KEY_TYPE );
         xResult = pxCtx->pxP11FunctionList->C_GetAttributeValue( pxCtx->xP11Session,
-                                                                 pxCtx->xP11PrivateKey,
+                                                                 *pxPrivateKey,
                                                                  xTemplate,
                                                                  1 );
     }
 
-    /* Map the PKCS #11 key type to an mbedTLS algorithm. */
-    if( xResult == CKR_OK )
-    {
-        switch( pxCtx->xKeyType )
-        {
-            case CKK_RSA:
-                xKeyAlgo = MBEDTLS_PK_RSA;
-                break;
-
-            case CKK_EC:
-                xKeyAlgo = MBEDTLS_PK_ECKEY;
-                break;
-
-            default:
-                xResult = CKR_ATTRIBUTE_VALUE_INVALID;
-                break;
-        }
-    }
-
-    /* Map the mbedTLS algorithm to its internal metadata. */
-    if( xResult == CKR_OK )
-    {
-        memcpy( &pxCtx->xMbedPkInfo, mbedtls_pk_info_from_type( xKeyAlgo ), sizeof( mbedtls_pk_info_t ) );
-
-        pxCtx->xMbedPkInfo.sign_func = prvPrivateKeySigningCallback;
-        pxCtx->xMbedPkCtx.pk_info = &pxCtx->xMbedPkInfo;
-        pxCtx->xMbedPkCtx.pk_ctx = pxCtx;
-    }
-
     /* Get the handle of the device client certificate. */
     if( xResult == CKR_OK )
     {
         xResult = prvReadCertificateIntoContext( pxCtx,
                                                  pkcs11configLABEL_DEVICE_CERTIFICATE_FOR_TLS,
                                                  CKO_CERTIFICATE,
-                                                 &pxCtx->xMbedX509Cli );
+                                                 pxClientCertificate );
     }
 
     /* Add a Just-in-Time Registration (JITR) device issuer certificate, if
@@ -623,7 +720,7 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
         if( ( NULL != pcJitrCertificate ) &&
             ( 0 != strcmp( "", pcJitrCertificate ) ) )
         {
-            xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509Cli,
+            xResult = mbedtls_x509_crt_parse( pxClientCertificate,
                                               ( const unsigned char * ) pcJitrCertificate,
                                               1 + strlen( pcJitrCertificate ) );
         }
@@ -633,7 +730,7 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
             xResult = prvReadCertificateIntoContext( pxCtx,
                                                      pkcs11configLABEL_JITP_CERTIFICATE,
                                                      CKO_CERTIFICATE,
-                                                     &pxCtx->xMbedX509Cli );
+                                                     pxClientCertificate );
 
             /* It is optional to have a JITR certificate in storage. */
             if( CKR_OBJECT_HANDLE_INVALID == xResult )
@@ -643,169 +740,28 @@ static int prvInitializeClientCredential( TLSContext_t * pxCtx )
         }
     }
 
-    /* Attach the client certificate(s) and private key to the TLS configuration. */
-    if( 0 == xResult )
-    {
-        xResult = mbedtls_ssl_conf_own_cert( &pxCtx->xMbedSslConfig,
-                                             &pxCtx->xMbedX509Cli,
-                                             &pxCtx->xMbedPkCtx );
-    }
-
     return xResult;
 }
 
 /*-----------------------------------------------------------*/
 
 /**
- * @brief Helper to seed the entropy module used by the DRBG. Periodically this
- * this function will be called to get more random data from the TRNG.
+ * @brief Helper for parsing the root CA certificates: either the default or
+ * the override.
  *
- * @param[in] tlsContext The TLS context.
- * @param[out] outputBuffer The output buffer to return the generated random data.
- * @param[in] outputBufferLength Length of the output buffer.
+ * @param[in] pxCtx Caller TLS context.
+ * @param[out] pxRootCertificates Root CA chain, must be initialized.
  *
- * @return Zero on success, otherwise a negative error code telling the cause of the error.
- */
-static int prvEntropyCallback( void * tlsContext,
-                               unsigned char * outputBuffer,
-                               size_t outputBufferLength )
-{
-    int ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
-    CK_RV xResult = CKR_OK;
-    TLSContext_t * pxCtx = ( TLSContext_t * ) tlsContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    if( pxCtx->xP11Session != CK_INVALID_HANDLE )
-    {
-        xResult = C_GenerateRandom( pxCtx->xP11Session,
-                                    outputBuffer,
-                                    outputBufferLength );
-    }
-    else
-    {
-        xResult = CKR_SESSION_HANDLE_INVALID;
-        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
-    }
-
-    if( xResult == CKR_OK )
-    {
-        ret = 0;
-    }
-    else
-    {
-        TLS_PRINT( ( "Error: PKCS #11 C_GenerateRandom failed with error code:" \
-                     "%d\r\n", xResult ) );
-    }
-
-    return ret;
-}
-
-/*
- * Interface routines.
+ * @return Zero on success.
  */
-
-BaseType_t TLS_Init( void ** ppvContext,
-                     TLSParams_t * pxParams )
-{
-    BaseType_t xResult = CKR_OK;
-    int mbedTLSResult = 0;
-    TLSContext_t * pxCtx = NULL;
-    CK_C_GetFunctionList xCkGetFunctionList = NULL;
-
-    /* Allocate an internal context. */
-    pxCtx = ( TLSContext_t * ) pvPortMalloc( sizeof( TLSContext_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    if( NULL != pxCtx )
-    {
-        memset( pxCtx, 0, sizeof( TLSContext_t ) );
-        *ppvContext = pxCtx;
-
-        /* Initialize the context. */
-        pxCtx->pcDestination = pxParams->pcDestination;
-        pxCtx->pcServerCertificate = pxParams->pcServerCertificate;
-        pxCtx->ulServerCertificateLength = pxParams->ulServerCertificateLength;
-        pxCtx->ppcAlpnProtocols = pxParams->ppcAlpnProtocols;
-        pxCtx->ulAlpnProtocolsCount = pxParams->ulAlpnProtocolsCount;
-        pxCtx->xNetworkRecv = pxParams->pxNetworkRecv;
-        pxCtx->xNetworkSend = pxParams->pxNetworkSend;
-        pxCtx->pvCallerContext = pxParams->pvCallerContext;
-
-        /* Get the function pointer list for the PKCS#11 module. */
-        xCkGetFunctionList = C_GetFunctionList;
-        xResult = ( BaseType_t ) xCkGetFunctionList( &pxCtx->pxP11FunctionList );
-
-        /* Ensure that the PKCS #11 module is initialized and create a session. */
-        if( xResult == CKR_OK )
-        {
-            xResult = xInitializePkcs11Session( &pxCtx->xP11Session );
-
-            /* It is ok if the module was previously initialized. */
-            if( xResult == CKR_CRYPTOKI_ALREADY_INITIALIZED )
-            {
-                xResult = CKR_OK;
-            }
-        }
-
-        if( xResult == CKR_OK )
-        {
-            mbedtls_ctr_drbg_init( &pxCtx->xMbedDrbgCtx );
-            mbedTLSResult = mbedtls_ctr_drbg_seed( &pxCtx->xMbedDrbgCtx,
-                                                   prvEntropyCallback,
-                                                   pxCtx,
-                                                   NULL,
-                                                   0 );
-
-            if( 0 != mbedTLSResult )
-            {
-                TLS_PRINT( ( "ERROR: Failed to setup DRBG seed %s : %s \r\n",
-                             mbedtlsHighLevelCodeOrDefault( mbedTLSResult ),
-                             mbedtlsLowLevelCodeOrDefault( mbedTLSResult ) ) );
-                xResult = CKR_FUNCTION_FAILED;
-            }
-        }
-    }
-    else
-    {
-        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
-    }
-
-    return xResult;
-}
-
-/*-----------------------------------------------------------*/
-
-#ifdef MBEDTLS_DEBUG_C
-    static void prvTlsDebugPrint( void * ctx,
-                                  int lLevel,
-                                  const char * pcFile,
-                                  int lLine,
-                                  const char * pcStr )
-    {
-        /* Unused parameters. */
-        ( void ) ctx;
-        ( void ) pcFile;
-        ( void ) lLine;
-
-        /* Send the debug string to the portable logger. */
-        vLoggingPrintf( "mbedTLS: |%d| %s", lLevel, pcStr );
-    }
-#endif /* ifdef MBEDTLS_DEBUG_C */
-
-/*-----------------------------------------------------------*/
-
-BaseType_t TLS_Connect( void * pvContext )
+static int prvParseRootCertificates( TLSContext_t * pxCtx,
+                                     mbedtls_x509_crt * pxRootCertificates )
 {
-    BaseType_t xResult = 0;
-    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-
-    /* Initialize mbedTLS structures. */
-    mbedtls_ssl_init( &pxCtx->xMbedSslCtx );
-    mbedtls_ssl_config_init( &pxCtx->xMbedSslConfig );
-    mbedtls_x509_crt_init( &pxCtx->xMbedX509CA );
+    int xResult = 0;
 
-    /* Decode the root certificate: either the default or the override. */
     if( NULL != pxCtx->pcServerCertificate )
     {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
+        xResult = mbedtls_x509_crt_parse( pxRootCertificates,
                                           ( const unsigned char * ) pxCtx->pcServerCertificate,
                                           pxCtx->ulServerCertificateLength );
 
@@ -818,19 +774,19 @@ BaseType_t TLS_Connect( void * pvContext )
     }
     else
     {
-        xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
+        xResult = mbedtls_x509_crt_parse( pxRootCertificates,
                                           ( const unsigned char * ) tlsVERISIGN_ROOT_CERTIFICATE_PEM,
                                           tlsVERISIGN_ROOT_CERTIFICATE_LENGTH );
 
         if( 0 == xResult )
         {
-            xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
+            xResult = mbedtls_x509_crt_parse( pxRootCertificates,
                                               ( const unsigned char * ) tlsATS1_ROOT_CERTIFICATE_PEM,
                                               tlsATS1_ROOT_CERTIFICATE_LENGTH );
 
             if( 0 == xResult )
             {
-                xResult = mbedtls_x509_crt_parse( &pxCtx->xMbedX509CA,
+                xResult = mbedtls_x509_crt_parse( pxRootCertificates,
                                                   ( const unsigned char * ) tlsSTARFIELD_ROOT_CERTIFICATE_PEM,
                                                   tlsSTARFIELD_ROOT_CERTIFICATE_LENGTH );
             }
@@ -845,8 +801,1037 @@ BaseType_t TLS_Connect( void * pvContext )
         }
     }
 
-    /* Start with protocol defaults. */
-    if( 0 == xResult )
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigCACHE_CREDENTIALS == 1 )
+
+/**
+ * @brief Free a credential cache that has no users left.
+ *
+ * @param[in] pxCache The credential cache.
+ */
+    static void prvFreeCredentialCache( TLSCredentialCache_t * pxCache )
+    {
+        mbedtls_x509_crt_free( &pxCache->xMbedX509CA );
+        mbedtls_x509_crt_free( &pxCache->xMbedX509Cli );
+        vPortFree( pxCache );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Drop a reference to a credential cache.
+ *
+ * @param[in] pxCache The credential cache.
+ */
+    static void prvReleaseCredentialCache( TLSCredentialCache_t * pxCache )
+    {
+        uint32_t ulReferenceCount;
+
+        taskENTER_CRITICAL();
+        {
+            pxCache->ulReferenceCount--;
+            ulReferenceCount = pxCache->ulReferenceCount;
+        }
+        taskEXIT_CRITICAL();
+
+        if( 0U == ulReferenceCount )
+        {
+            prvFreeCredentialCache( pxCache );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Stop handing out a credential cache to new connections, if it is
+ * still the current one.
+ *
+ * @param[in] pxCache The credential cache.
+ */
+    static void prvInvalidateCredentialCache( TLSCredentialCache_t * pxCache )
+    {
+        BaseType_t xDropped = pdFALSE;
+
+        taskENTER_CRITICAL();
+        {
+            if( ( NULL != pxCache ) && ( pxCredentialCache == pxCache ) )
+            {
+                pxCredentialCache = NULL;
+                xDropped = pdTRUE;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( pdTRUE == xDropped )
+        {
+            /* Drop the reference that was held by pxCredentialCache. */
+            prvReleaseCredentialCache( pxCache );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a reference to the credential cache, read and parse the
+ * credentials if there is no cache yet.
+ *
+ * @param[in] pxCtx Caller TLS context, holding a logged-in PKCS #11 session.
+ *
+ * @return Zero on success.
+ */
+    static int prvAcquireCredentialCache( TLSContext_t * pxCtx )
+    {
+        BaseType_t xResult = CKR_OK;
+        TLSCredentialCache_t * pxCache = NULL;
+        TLSCredentialCache_t * pxNewCache = NULL;
+
+        taskENTER_CRITICAL();
+        {
+            pxCache = pxCredentialCache;
+
+            if( NULL != pxCache )
+            {
+                pxCache->ulReferenceCount++;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( NULL == pxCache )
+        {
+            pxNewCache = ( TLSCredentialCache_t * ) pvPortMalloc( sizeof( TLSCredentialCache_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+            if( NULL == pxNewCache )
+            {
+                xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+            }
+            else
+            {
+                memset( pxNewCache, 0, sizeof( TLSCredentialCache_t ) );
+                mbedtls_x509_crt_init( &pxNewCache->xMbedX509CA );
+                mbedtls_x509_crt_init( &pxNewCache->xMbedX509Cli );
+
+                xResult = prvReadClientCredential( pxCtx,
+                                                   &pxNewCache->xP11PrivateKey,
+                                                   &pxNewCache->xKeyType,
+                                                   &pxNewCache->xMbedX509Cli );
+            }
+
+            /* Parse the root CA certificates of this connection. Later
+             * connections can use them if they trust the same certificates. */
+            if( CKR_OK == xResult )
+            {
+                xResult = prvParseRootCertificates( pxCtx, &pxNewCache->xMbedX509CA );
+            }
+
+            if( CKR_OK == xResult )
+            {
+                if( NULL == pxCtx->pcServerCertificate )
+                {
+                    pxNewCache->xDefaultServerCertificate = pdTRUE;
+                }
+                else
+                {
+                    xResult = mbedtls_sha256_ret( ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                                  pxCtx->ulServerCertificateLength,
+                                                  pxNewCache->ucServerCertificateHash,
+                                                  0 );
+                }
+            }
+
+            if( CKR_OK == xResult )
+            {
+                taskENTER_CRITICAL();
+                {
+                    if( NULL == pxCredentialCache )
+                    {
+                        /* One reference for pxCredentialCache, one for the caller. */
+                        pxNewCache->ulReferenceCount = 2U;
+                        pxCredentialCache = pxNewCache;
+                        pxCache = pxNewCache;
+                        pxNewCache = NULL;
+                        ulCredentialCacheLoads++;
+                    }
+                    else
+                    {
+                        /* Another connection has created the cache in the mean time. */
+                        pxCache = pxCredentialCache;
+                        pxCache->ulReferenceCount++;
+                    }
+                }
+                taskEXIT_CRITICAL();
+            }
+
+            if( NULL != pxNewCache )
+            {
+                prvFreeCredentialCache( pxNewCache );
+            }
+        }
+
+        pxCtx->pxCredentials = pxCache;
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_FlushCredentialCache( void )
+    {
+        prvInvalidateCredentialCache( pxCredentialCache );
+    }
+
+/*-----------------------------------------------------------*/
+
+    uint32_t TLS_GetCredentialCacheLoads( void )
+    {
+        return ulCredentialCacheLoads;
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+
+/**
+ * @brief Helper for setting up potentially hardware-based cryptographic context
+ * for the client TLS certificate and private key.
+ *
+ * @param Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvInitializeClientCredential( TLSContext_t * pxCtx )
+{
+    BaseType_t xResult = CKR_OK;
+    mbedtls_pk_type_t xKeyAlgo = ( mbedtls_pk_type_t ) ~0;
+    mbedtls_x509_crt * pxClientCertificate = &pxCtx->xMbedX509Cli;
+
+    /* Initialize the mbed contexts. */
+    mbedtls_x509_crt_init( &pxCtx->xMbedX509Cli );
+
+    if( pxCtx->xP11Session == CK_INVALID_HANDLE )
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
+    }
+
+    /* Put the module in authenticated mode. */
+    if( CKR_OK == xResult )
+    {
+        pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_STARTED;
+        xResult = ( BaseType_t ) pxCtx->pxP11FunctionList->C_Login( pxCtx->xP11Session,
+                                                                    CKU_USER,
+                                                                    ( CK_UTF8CHAR_PTR ) configPKCS11_DEFAULT_USER_PIN,
+                                                                    sizeof( configPKCS11_DEFAULT_USER_PIN ) - 1 );
+    }
+
+    if( CKR_OK == xResult )
+    {
+        #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+            {
+                /* Use the credentials that were read and parsed before. The
+                 * object handle of the private key stays valid across sessions. */
+                xResult = prvAcquireCredentialCache( pxCtx );
+
+                if( CKR_OK == xResult )
+                {
+                    pxCtx->xP11PrivateKey = pxCtx->pxCredentials->xP11PrivateKey;
+                    pxCtx->xKeyType = pxCtx->pxCredentials->xKeyType;
+                    pxClientCertificate = &pxCtx->pxCredentials->xMbedX509Cli;
+                }
+            }
+        #else
+            {
+                xResult = prvReadClientCredential( pxCtx,
+                                                   &pxCtx->xP11PrivateKey,
+                                                   &pxCtx->xKeyType,
+                                                   &pxCtx->xMbedX509Cli );
+            }
+        #endif /* if ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+    }
+
+    /* Map the PKCS #11 key type to an mbedTLS algorithm. */
+    if( xResult == CKR_OK )
+    {
+        switch( pxCtx->xKeyType )
+        {
+            case CKK_RSA:
+                xKeyAlgo = MBEDTLS_PK_RSA;
+                break;
+
+            case CKK_EC:
+                xKeyAlgo = MBEDTLS_PK_ECKEY;
+                break;
+
+            default:
+                xResult = CKR_ATTRIBUTE_VALUE_INVALID;
+                break;
+        }
+    }
+
+    /* Map the mbedTLS algorithm to its internal metadata. */
+    if( xResult == CKR_OK )
+    {
+        memcpy( &pxCtx->xMbedPkInfo, mbedtls_pk_info_from_type( xKeyAlgo ), sizeof( mbedtls_pk_info_t ) );
+
+        pxCtx->xMbedPkInfo.sign_func = prvPrivateKeySigningCallback;
+        pxCtx->xMbedPkCtx.pk_info = &pxCtx->xMbedPkInfo;
+        pxCtx->xMbedPkCtx.pk_ctx = pxCtx;
+    }
+
+    /* Attach the client certificate(s) and private key to the TLS configuration. */
+    if( 0 == xResult )
+    {
+        xResult = mbedtls_ssl_conf_own_cert( &pxCtx->xMbedSslConfig,
+                                             pxClientCertificate,
+                                             &pxCtx->xMbedPkCtx );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Helper for setting up the root CA certificates to verify the server
+ * certificate with.
+ *
+ * @param Caller context.
+ *
+ * @return Zero on success.
+ */
+static int prvInitializeRootCertificates( TLSContext_t * pxCtx )
+{
+    int xResult = 0;
+    mbedtls_x509_crt * pxRootCertificates = &pxCtx->xMbedX509CA;
+
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        BaseType_t xUseCache = pdFALSE;
+        unsigned char ucHash[ 32 ];
+
+        /* The cached chain can be used if it was parsed from the same
+         * certificates. */
+        if( NULL != pxCtx->pxCredentials )
+        {
+            if( NULL == pxCtx->pcServerCertificate )
+            {
+                xUseCache = pxCtx->pxCredentials->xDefaultServerCertificate;
+            }
+            else if( ( pdFALSE == pxCtx->pxCredentials->xDefaultServerCertificate ) &&
+                     ( 0 == mbedtls_sha256_ret( ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                                pxCtx->ulServerCertificateLength,
+                                                ucHash,
+                                                0 ) ) &&
+                     ( 0 == memcmp( ucHash, pxCtx->pxCredentials->ucServerCertificateHash, sizeof( ucHash ) ) ) )
+            {
+                xUseCache = pdTRUE;
+            }
+            else
+            {
+                /* This connection trusts other certificates. */
+            }
+        }
+
+        if( pdFALSE != xUseCache )
+        {
+            pxRootCertificates = &pxCtx->pxCredentials->xMbedX509CA;
+        }
+        else
+    #endif /* if ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+    {
+        xResult = prvParseRootCertificates( pxCtx, &pxCtx->xMbedX509CA );
+    }
+
+    if( 0 == xResult )
+    {
+        /* Set issuer certificate. */
+        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, pxRootCertificates, NULL );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+
+/**
+ * @brief Take the session cache mutex, create it if needed.
+ *
+ * @return pdTRUE if the mutex was taken.
+ */
+    static BaseType_t prvLockSessionCache( void )
+    {
+        SemaphoreHandle_t xMutex = xSessionCacheMutex;
+        BaseType_t xLocked = pdFALSE;
+
+        if( NULL == xMutex )
+        {
+            xMutex = xSemaphoreCreateMutex();
+
+            if( NULL != xMutex )
+            {
+                taskENTER_CRITICAL();
+                {
+                    if( NULL == xSessionCacheMutex )
+                    {
+                        xSessionCacheMutex = xMutex;
+                        xMutex = NULL;
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( NULL != xMutex )
+                {
+                    /* Another task has created the mutex in the mean time. */
+                    vSemaphoreDelete( xMutex );
+                }
+            }
+
+            xMutex = xSessionCacheMutex;
+        }
+
+        if( NULL != xMutex )
+        {
+            xLocked = xSemaphoreTake( xMutex, portMAX_DELAY );
+        }
+
+        return xLocked;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Look up the cached session for the server of a connection.
+ * The session cache must be locked.
+ *
+ * @param[in] pxCtx Caller TLS context.
+ *
+ * @return The entry, or NULL if there is no session for this server.
+ */
+    static TLSSessionCacheEntry_t * prvFindCachedSession( const TLSContext_t * pxCtx )
+    {
+        TLSSessionCacheEntry_t * pxEntry = NULL;
+        size_t xIndex;
+
+        for( xIndex = 0; xIndex < ( size_t ) tlsconfigSESSION_CACHE_ENTRIES; xIndex++ )
+        {
+            if( ( pdFALSE != xSessionCache[ xIndex ].xInUse ) &&
+                ( xSessionCache[ xIndex ].usDestinationPort == pxCtx->usDestinationPort ) &&
+                ( 0 == memcmp( xSessionCache[ xIndex ].ucDestinationHash,
+                               pxCtx->ucDestinationHash,
+                               sizeof( pxCtx->ucDestinationHash ) ) ) )
+            {
+                pxEntry = &xSessionCache[ xIndex ];
+                break;
+            }
+        }
+
+        return pxEntry;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Free the session of a cache entry. The session cache must be locked.
+ *
+ * @param[in] pxEntry The cache entry.
+ */
+    static void prvFreeCachedSession( TLSSessionCacheEntry_t * pxEntry )
+    {
+        if( pdFALSE != pxEntry->xInUse )
+        {
+            mbedtls_ssl_session_free( &pxEntry->xSession );
+            pxEntry->xInUse = pdFALSE;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Hash the server name of a connection with the root CAs that it
+ * trusts, so that a session is only resumed with the same trust anchor.
+ *
+ * @param[in] pxCtx Caller TLS context, with a server name.
+ * @param[out] pucHash SHA-256 of the server name and trusted root CAs.
+ *
+ * @return Zero on success, otherwise an mbedTLS error code.
+ */
+    static int prvHashSessionKey( const TLSContext_t * pxCtx,
+                                  unsigned char * pucHash )
+    {
+        static const char cDefaultRootCAs[] = "default root CAs";
+        mbedtls_sha256_context xSha256;
+        int xResult;
+
+        mbedtls_sha256_init( &xSha256 );
+        xResult = mbedtls_sha256_starts_ret( &xSha256, 0 );
+
+        if( 0 == xResult )
+        {
+            /* Include the terminator to separate the name from the roots. */
+            xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                 ( const unsigned char * ) pxCtx->pcDestination,
+                                                 strlen( pxCtx->pcDestination ) + 1U );
+        }
+
+        if( 0 == xResult )
+        {
+            if( NULL != pxCtx->pcServerCertificate )
+            {
+                xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                     ( const unsigned char * ) pxCtx->pcServerCertificate,
+                                                     pxCtx->ulServerCertificateLength );
+            }
+            else
+            {
+                xResult = mbedtls_sha256_update_ret( &xSha256,
+                                                     ( const unsigned char * ) cDefaultRootCAs,
+                                                     sizeof( cDefaultRootCAs ) );
+            }
+        }
+
+        if( 0 == xResult )
+        {
+            xResult = mbedtls_sha256_finish_ret( &xSha256, pucHash );
+        }
+
+        mbedtls_sha256_free( &xSha256 );
+
+        return xResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Offer the cached session for the server of a connection, if any.
+ *
+ * A session is only looked up for connections that have a server name, so
+ * that it is never offered to another server, and is keyed on the trusted
+ * root CAs so that it never bypasses a different trust anchor.
+ *
+ * @param[in] pxCtx Caller TLS context, with an SSL context that has been set up.
+ */
+    static void prvOfferCachedSession( TLSContext_t * pxCtx )
+    {
+        TLSSessionCacheEntry_t * pxEntry;
+
+        if( ( NULL != pxCtx->pcDestination ) &&
+            ( 0 == prvHashSessionKey( pxCtx, pxCtx->ucDestinationHash ) ) )
+        {
+            pxCtx->xSessionCacheable = pdTRUE;
+        }
+
+        if( ( pdFALSE != pxCtx->xSessionCacheable ) && ( pdFALSE != prvLockSessionCache() ) )
+        {
+            pxEntry = prvFindCachedSession( pxCtx );
+
+            /* A session that can not be set results in a full handshake. */
+            if( ( NULL != pxEntry ) &&
+                ( 0 == mbedtls_ssl_set_session( &pxCtx->xMbedSslCtx, &pxEntry->xSession ) ) )
+            {
+                pxEntry->xLastUsed = xTaskGetTickCount();
+                pxCtx->xSessionOffered = pdTRUE;
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Save the session of a successful handshake, or forget the session
+ * that was offered for a failed one, and update the handshake counters.
+ *
+ * @param[in] pxCtx Caller TLS context.
+ * @param[in] xResult The result of the handshake.
+ */
+    static void prvUpdateSessionCache( TLSContext_t * pxCtx,
+                                       BaseType_t xResult )
+    {
+        TLSSessionCacheEntry_t * pxEntry;
+        size_t xIndex;
+        TickType_t xNow;
+
+        if( ( pdFALSE != pxCtx->xSessionCacheable ) && ( pdFALSE != prvLockSessionCache() ) )
+        {
+            pxEntry = prvFindCachedSession( pxCtx );
+
+            if( 0 == xResult )
+            {
+                /* Only a resumed handshake skips the server certificate. */
+                if( ( pdFALSE != pxCtx->xSessionOffered ) && ( pdFALSE == pxCtx->xServerCertificateVerified ) )
+                {
+                    xHandshakeCounters.ulResumedHandshakes++;
+                }
+                else
+                {
+                    xHandshakeCounters.ulFullHandshakes++;
+                }
+
+                if( NULL == pxEntry )
+                {
+                    /* Use a free entry, or replace the least recently used
+                     * session. */
+                    xNow = xTaskGetTickCount();
+                    pxEntry = &xSessionCache[ 0 ];
+
+                    for( xIndex = 0; xIndex < ( size_t ) tlsconfigSESSION_CACHE_ENTRIES; xIndex++ )
+                    {
+                        if( pdFALSE == xSessionCache[ xIndex ].xInUse )
+                        {
+                            pxEntry = &xSessionCache[ xIndex ];
+                            break;
+                        }
+
+                        if( ( xNow - xSessionCache[ xIndex ].xLastUsed ) > ( xNow - pxEntry->xLastUsed ) )
+                        {
+                            pxEntry = &xSessionCache[ xIndex ];
+                        }
+                    }
+                }
+
+                /* Store the session, a ticket that the server may have renewed
+                 * included. */
+                prvFreeCachedSession( pxEntry );
+                mbedtls_ssl_session_init( &pxEntry->xSession );
+
+                if( 0 == mbedtls_ssl_get_session( &pxCtx->xMbedSslCtx, &pxEntry->xSession ) )
+                {
+                    pxEntry->xInUse = pdTRUE;
+                    pxEntry->usDestinationPort = pxCtx->usDestinationPort;
+                    memcpy( pxEntry->ucDestinationHash, pxCtx->ucDestinationHash, sizeof( pxEntry->ucDestinationHash ) );
+                    pxEntry->xLastUsed = xTaskGetTickCount();
+                }
+                else
+                {
+                    mbedtls_ssl_session_free( &pxEntry->xSession );
+                }
+            }
+            else if( ( NULL != pxEntry ) && ( pdFALSE != pxCtx->xSessionOffered ) )
+            {
+                /* Do not offer a session again that may have caused the
+                 * failure. */
+                prvFreeCachedSession( pxEntry );
+            }
+            else
+            {
+                /* Nothing to update. */
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_FlushSessionCache( void )
+    {
+        size_t xIndex;
+
+        if( pdFALSE != prvLockSessionCache() )
+        {
+            for( xIndex = 0; xIndex < ( size_t ) tlsconfigSESSION_CACHE_ENTRIES; xIndex++ )
+            {
+                prvFreeCachedSession( &xSessionCache[ xIndex ] );
+            }
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+    void TLS_GetHandshakeCounters( TLSHandshakeCounters_t * pxCounters )
+    {
+        if( pdFALSE != prvLockSessionCache() )
+        {
+            *pxCounters = xHandshakeCounters;
+
+            ( void ) xSemaphoreGive( xSessionCacheMutex );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigCACHE_SESSIONS == 1 ) */
+
+/**
+ * @brief Helper to seed the entropy module used by the DRBG. Periodically this
+ * this function will be called to get more random data from the TRNG.
+ *
+ * @param[in] tlsContext The TLS context.
+ * @param[out] outputBuffer The output buffer to return the generated random data.
+ * @param[in] outputBufferLength Length of the output buffer.
+ *
+ * @return Zero on success, otherwise a negative error code telling the cause of the error.
+ */
+static int prvEntropyCallback( void * tlsContext,
+                               unsigned char * outputBuffer,
+                               size_t outputBufferLength )
+{
+    int ret = MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+    CK_RV xResult = CKR_OK;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) tlsContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( pxCtx->xP11Session != CK_INVALID_HANDLE )
+    {
+        xResult = C_GenerateRandom( pxCtx->xP11Session,
+                                    outputBuffer,
+                                    outputBufferLength );
+    }
+    else
+    {
+        xResult = CKR_SESSION_HANDLE_INVALID;
+        TLS_PRINT( ( "Error: PKCS #11 session was not initialized.\r\n" ) );
+    }
+
+    if( xResult == CKR_OK )
+    {
+        ret = 0;
+    }
+    else
+    {
+        TLS_PRINT( ( "Error: PKCS #11 C_GenerateRandom failed with error code:" \
+                     "%d\r\n", xResult ) );
+    }
+
+    return ret;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Asks the server to send records of at most the configured length.
+ *
+ * @param[in] pxCtx The TLS context.
+ *
+ * @return Zero on success, or a negative error code if the length cannot be
+ * negotiated.
+ */
+static int prvConfigureMaxFragmentLength( TLSContext_t * pxCtx )
+{
+    int xResult = 0;
+    uint32_t ulLength = pxCtx->ulMaxFragmentLength;
+    unsigned char ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+
+    /* Fall back to the build setting. */
+    if( 0U == ulLength )
+    {
+        ulLength = ( uint32_t ) tlsconfigMAX_FRAGMENT_LENGTH;
+    }
+
+    /* RFC 6066 only defines these lengths. */
+    switch( ulLength )
+    {
+        case 0U:
+            break;
+
+        case 512U:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+            break;
+
+        case 1024U:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+            break;
+
+        case 2048U:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+            break;
+
+        case 4096U:
+            ucCode = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+            break;
+
+        default:
+            TLS_PRINT( ( "ERROR: Unsupported max fragment length %u \r\n", ( unsigned ) ulLength ) );
+            xResult = MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+            break;
+    }
+
+    if( ( 0 == xResult ) && ( MBEDTLS_SSL_MAX_FRAG_LEN_NONE != ucCode ) )
+    {
+        #if defined( MBEDTLS_SSL_MAX_FRAGMENT_LENGTH )
+            xResult = mbedtls_ssl_conf_max_frag_len( &pxCtx->xMbedSslConfig, ucCode );
+        #else
+            TLS_PRINT( ( "ERROR: Max fragment length negotiation is not enabled in mbedTLS \r\n" ) );
+            xResult = MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE;
+        #endif
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+
+/**
+ * @brief Allocates the buffer used by TLS_SendMore, once the size of the
+ * records is known.
+ *
+ * Runs without the buffer if it cannot be allocated, or if the size of the
+ * records is not known.
+ *
+ * @param[in] pxCtx The TLS context, after a successful handshake.
+ */
+    static void prvAllocateSendBuffer( TLSContext_t * pxCtx )
+    {
+        size_t xSize = ( size_t ) tlsconfigSEND_BUFFER_SIZE;
+        int lMaxPayload = mbedtls_ssl_get_max_out_record_payload( &pxCtx->xMbedSslCtx );
+
+        /* The buffer must fit in one record, so that prvFlushSendBuffer
+         * either sends all of it or nothing. */
+        if( 0 >= lMaxPayload )
+        {
+            xSize = 0;
+        }
+        else if( ( size_t ) lMaxPayload < xSize )
+        {
+            xSize = ( size_t ) lMaxPayload;
+        }
+        else
+        {
+            /* The configured size fits. */
+        }
+
+        pxCtx->xSendBufferLength = 0;
+        pxCtx->xSendBufferBlocked = pdFALSE;
+        pxCtx->pucSendBuffer = NULL;
+
+        if( 0U != xSize )
+        {
+            pxCtx->pucSendBuffer = ( unsigned char * ) pvPortMalloc( xSize ); /*lint !e9079 Allow casting void* to other types. */
+        }
+
+        if( NULL != pxCtx->pucSendBuffer )
+        {
+            pxCtx->xSendBufferSize = xSize;
+        }
+        else
+        {
+            pxCtx->xSendBufferSize = 0;
+            TLS_PRINT( ( "WARN: No memory to queue sends, sending each write in its own record. \r\n" ) );
+        }
+    }
+#endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Encrypts and sends bytes until all are sent, the socket has no room
+ * left, or an error occurs.
+ *
+ * @param[in] pxCtx The TLS context.
+ * @param[in] pucMsg Plaintext to send.
+ * @param[in] xMsgLength Length of pucMsg.
+ *
+ * @return Number of bytes sent, or a negative error code. The context is
+ * invalidated on error.
+ */
+static BaseType_t prvWrite( TLSContext_t * pxCtx,
+                            const unsigned char * pucMsg,
+                            size_t xMsgLength )
+{
+    BaseType_t xResult = 0;
+    size_t xWritten = 0;
+
+    while( xWritten < xMsgLength )
+    {
+        xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx,
+                                     pucMsg + xWritten,
+                                     xMsgLength - xWritten );
+
+        if( 0 < xResult )
+        {
+            /* Sent data, so update the tally and keep looping. */
+            xWritten += ( size_t ) xResult;
+        }
+        else if( ( 0 == xResult ) || ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) )
+        {
+            /* No data sent. The secure sockets
+             * API supports non-blocking send, so stop the loop but don't
+             * flag an error. */
+            xResult = 0;
+            break;
+        }
+        else if( MBEDTLS_ERR_SSL_WANT_WRITE != xResult )
+        {
+            /* Hard error: invalidate the context and stop. */
+            prvFreeContext( pxCtx );
+            break;
+        }
+    }
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xWritten;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+
+/**
+ * @brief Sends the bytes queued by TLS_SendMore as one record.
+ *
+ * The buffer fits in one record, so it is sent completely or not at all.
+ * When the socket has no room, mbedTLS keeps the encrypted record, and sends
+ * it when it is given the same bytes again. Nothing may be added to the
+ * buffer until then.
+ *
+ * @param[in] pxCtx The TLS context.
+ *
+ * @return Number of bytes still queued, which is zero unless the socket had
+ * no room left, or a negative error code.
+ */
+    static BaseType_t prvFlushSendBuffer( TLSContext_t * pxCtx )
+    {
+        BaseType_t xResult = 0;
+
+        if( 0U != pxCtx->xSendBufferLength )
+        {
+            xResult = prvWrite( pxCtx, pxCtx->pucSendBuffer, pxCtx->xSendBufferLength );
+
+            if( 0 < xResult )
+            {
+                pxCtx->xSendBufferLength = 0;
+                pxCtx->xSendBufferBlocked = pdFALSE;
+            }
+            else if( 0 == xResult )
+            {
+                pxCtx->xSendBufferBlocked = pdTRUE;
+            }
+            else
+            {
+                /* The context was freed. */
+            }
+        }
+
+        if( 0 <= xResult )
+        {
+            xResult = ( BaseType_t ) pxCtx->xSendBufferLength;
+        }
+
+        return xResult;
+    }
+#endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
+/*
+ * Interface routines.
+ */
+
+BaseType_t TLS_Init( void ** ppvContext,
+                     TLSParams_t * pxParams )
+{
+    BaseType_t xResult = CKR_OK;
+    int mbedTLSResult = 0;
+    TLSContext_t * pxCtx = NULL;
+    CK_C_GetFunctionList xCkGetFunctionList = NULL;
+
+    /* Allocate an internal context. */
+    pxCtx = ( TLSContext_t * ) pvPortMalloc( sizeof( TLSContext_t ) ); /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( NULL != pxCtx )
+    {
+        memset( pxCtx, 0, sizeof( TLSContext_t ) );
+        *ppvContext = pxCtx;
+
+        /* Initialize the context. */
+        pxCtx->pcDestination = pxParams->pcDestination;
+        pxCtx->pcServerCertificate = pxParams->pcServerCertificate;
+        pxCtx->ulServerCertificateLength = pxParams->ulServerCertificateLength;
+        pxCtx->ppcAlpnProtocols = pxParams->ppcAlpnProtocols;
+        pxCtx->ulAlpnProtocolsCount = pxParams->ulAlpnProtocolsCount;
+        pxCtx->xNetworkRecv = pxParams->pxNetworkRecv;
+        pxCtx->xNetworkSend = pxParams->pxNetworkSend;
+        pxCtx->pvCallerContext = pxParams->pvCallerContext;
+
+        pxCtx->ulMaxFragmentLength = pxParams->ulMaxFragmentLength;
+
+        #if ( tlsconfigCACHE_SESSIONS == 1 )
+            pxCtx->usDestinationPort = pxParams->usDestinationPort;
+        #endif
+
+        /* Get the function pointer list for the PKCS#11 module. */
+        xCkGetFunctionList = C_GetFunctionList;
+        xResult = ( BaseType_t ) xCkGetFunctionList( &pxCtx->pxP11FunctionList );
+
+        /* Ensure that the PKCS #11 module is initialized and create a session. */
+        if( xResult == CKR_OK )
+        {
+            xResult = xInitializePkcs11Session( &pxCtx->xP11Session );
+
+            /* It is ok if the module was previously initialized. */
+            if( xResult == CKR_CRYPTOKI_ALREADY_INITIALIZED )
+            {
+                xResult = CKR_OK;
+            }
+        }
+
+        if( xResult == CKR_OK )
+        {
+            mbedtls_ctr_drbg_init( &pxCtx->xMbedDrbgCtx );
+            mbedTLSResult = mbedtls_ctr_drbg_seed( &pxCtx->xMbedDrbgCtx,
+                                                   prvEntropyCallback,
+                                                   pxCtx,
+                                                   NULL,
+                                                   0 );
+
+            if( 0 != mbedTLSResult )
+            {
+                TLS_PRINT( ( "ERROR: Failed to setup DRBG seed %s : %s \r\n",
+                             mbedtlsHighLevelCodeOrDefault( mbedTLSResult ),
+                             mbedtlsLowLevelCodeOrDefault( mbedTLSResult ) ) );
+                xResult = CKR_FUNCTION_FAILED;
+            }
+        }
+    }
+    else
+    {
+        xResult = ( BaseType_t ) CKR_HOST_MEMORY;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+#ifdef MBEDTLS_DEBUG_C
+    static void prvTlsDebugPrint( void * ctx,
+                                  int lLevel,
+                                  const char * pcFile,
+                                  int lLine,
+                                  const char * pcStr )
+    {
+        /* Unused parameters. */
+        ( void ) ctx;
+        ( void ) pcFile;
+        ( void ) lLine;
+
+        /* Send the debug string to the portable logger. */
+        vLoggingPrintf( "mbedTLS: |%d| %s", lLevel, pcStr );
+    }
+#endif /* ifdef MBEDTLS_DEBUG_C */
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Connect( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    /* Initialize mbedTLS structures. */
+    mbedtls_ssl_init( &pxCtx->xMbedSslCtx );
+    mbedtls_ssl_config_init( &pxCtx->xMbedSslConfig );
+    mbedtls_x509_crt_init( &pxCtx->xMbedX509CA );
+
+    /* Start with protocol defaults. */
+    if( 0 == xResult )
     {
         xResult = mbedtls_ssl_config_defaults( &pxCtx->xMbedSslConfig,
                                                MBEDTLS_SSL_IS_CLIENT,
@@ -874,13 +1859,25 @@ BaseType_t TLS_Connect( void * pvContext )
         /* Set the RNG callback. */
         mbedtls_ssl_conf_rng( &pxCtx->xMbedSslConfig, &prvGenerateRandomBytes, pxCtx ); /*lint !e546 Nothing wrong here. */
 
-        /* Set issuer certificate. */
-        mbedtls_ssl_conf_ca_chain( &pxCtx->xMbedSslConfig, &pxCtx->xMbedX509CA, NULL );
+        #if defined( MBEDTLS_SSL_SESSION_TICKETS )
+            /* Only ask for a session ticket if it can be used later. */
+            #if ( tlsconfigCACHE_SESSIONS == 1 )
+                mbedtls_ssl_conf_session_tickets( &pxCtx->xMbedSslConfig, MBEDTLS_SSL_SESSION_TICKETS_ENABLED );
+            #else
+                mbedtls_ssl_conf_session_tickets( &pxCtx->xMbedSslConfig, MBEDTLS_SSL_SESSION_TICKETS_DISABLED );
+            #endif
+        #endif
 
         /* Configure the SSL context for the device credentials. */
         xResult = prvInitializeClientCredential( pxCtx );
     }
 
+    if( 0 == xResult )
+    {
+        /* Decode the root certificate: either the default or the override. */
+        xResult = prvInitializeRootCertificates( pxCtx );
+    }
+
     if( ( 0 == xResult ) && ( NULL != pxCtx->ppcAlpnProtocols ) )
     {
         /* Include an application protocol list in the TLS ClientHello
@@ -890,6 +1887,12 @@ BaseType_t TLS_Connect( void * pvContext )
             pxCtx->ppcAlpnProtocols );
     }
 
+    if( 0 == xResult )
+    {
+        /* Ask for smaller records, if the I/O buffers were sized for them. */
+        xResult = prvConfigureMaxFragmentLength( pxCtx );
+    }
+
     #ifdef MBEDTLS_DEBUG_C
 
         /* If mbedTLS is being compiled with debug support, assume that the
@@ -919,6 +1922,11 @@ BaseType_t TLS_Connect( void * pvContext )
                              prvNetworkRecv,
                              NULL );
 
+        #if ( tlsconfigCACHE_SESSIONS == 1 )
+            /* Try to resume the last session with this server. */
+            prvOfferCachedSession( pxCtx );
+        #endif
+
         /* Negotiate. */
         while( 0 != ( xResult = mbedtls_ssl_handshake( &pxCtx->xMbedSslCtx ) ) )
         {
@@ -937,10 +1945,18 @@ BaseType_t TLS_Connect( void * pvContext )
         }
     }
 
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        prvUpdateSessionCache( pxCtx, xResult );
+    #endif
+
     /* Keep track of successful completion of the handshake. */
     if( 0 == xResult )
     {
         pxCtx->xTLSHandshakeState = TLS_HANDSHAKE_SUCCESSFUL;
+
+        #if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+            prvAllocateSendBuffer( pxCtx );
+        #endif
     }
     else if( xResult > 0 )
     {
@@ -953,6 +1969,24 @@ BaseType_t TLS_Connect( void * pvContext )
     mbedtls_x509_crt_free( &pxCtx->xMbedX509CA );
     mbedtls_x509_crt_free( &pxCtx->xMbedX509Cli );
 
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        if( NULL != pxCtx->pxCredentials )
+        {
+            /* The server rejected the client certificate, the server certificate
+             * could not be verified, or the private key could not be used: the
+             * stored credentials may have changed. */
+            if( ( MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE == xResult ) ||
+                ( MBEDTLS_ERR_X509_CERT_VERIFY_FAILED == xResult ) ||
+                ( TLS_ERROR_SIGN == xResult ) )
+            {
+                prvInvalidateCredentialCache( pxCtx->pxCredentials );
+            }
+
+            prvReleaseCredentialCache( pxCtx->pxCredentials );
+            pxCtx->pxCredentials = NULL;
+        }
+    #endif
+
     return xResult;
 }
 
@@ -1007,41 +2041,121 @@ BaseType_t TLS_Recv( void * pvContext,
 
 /*-----------------------------------------------------------*/
 
+BaseType_t TLS_Peek( void * pvContext,
+                     const unsigned char ** ppucData )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    unsigned char ucUnused = 0;
+
+    if( ( NULL != pxCtx ) && ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
+    {
+        /* Decrypt the next record once the current one has been consumed. A
+         * read of zero bytes leaves the plaintext in the record buffer. */
+        if( 0U == mbedtls_ssl_get_bytes_avail( &pxCtx->xMbedSslCtx ) )
+        {
+            do
+            {
+                xResult = mbedtls_ssl_read( &pxCtx->xMbedSslCtx, &ucUnused, 0 );
+            } while( ( xResult == MBEDTLS_ERR_SSL_WANT_READ ) );
+        }
+    }
+    else
+    {
+        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+    }
+
+    if( xResult >= 0 )
+    {
+        /* If no data is available, no data was received (and there is no
+         * error), as for TLS_Recv. */
+        xResult = ( BaseType_t ) mbedtls_ssl_get_bytes_avail( &pxCtx->xMbedSslCtx );
+        *ppucData = pxCtx->xMbedSslCtx.in_offt;
+    }
+    else
+    {
+        /* xResult < 0 is a hard error, so invalidate the context and stop. */
+        prvFreeContext( pxCtx );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void TLS_Consume( void * pvContext,
+                  size_t xLength )
+{
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+    mbedtls_ssl_context * pxSslCtx = &pxCtx->xMbedSslCtx;
+
+    configASSERT( xLength <= mbedtls_ssl_get_bytes_avail( pxSslCtx ) );
+
+    /* Same bookkeeping as at the end of mbedtls_ssl_read, without the copy. */
+    pxSslCtx->in_msglen -= xLength;
+
+    if( 0U == pxSslCtx->in_msglen )
+    {
+        /* All bytes of the record consumed. */
+        pxSslCtx->in_offt = NULL;
+        pxSslCtx->keep_current_message = 0;
+    }
+    else
+    {
+        pxSslCtx->in_offt += xLength;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength )
 {
     BaseType_t xResult = 0;
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-    size_t xWritten = 0;
+    size_t xQueued = 0;
 
     if( ( NULL != pxCtx ) && ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
     {
-        while( xWritten < xMsgLength )
-        {
-            xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx,
-                                         pucMsg + xWritten,
-                                         xMsgLength - xWritten );
-
-            if( 0 < xResult )
-            {
-                /* Sent data, so update the tally and keep looping. */
-                xWritten += ( size_t ) xResult;
-            }
-            else if( ( 0 == xResult ) || ( -pdFREERTOS_ERRNO_ENOSPC == xResult ) )
+        #if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+            if( pdFALSE != pxCtx->xSendBufferBlocked )
             {
-                /* No data sent. The secure sockets
-                 * API supports non-blocking send, so stop the loop but don't
-                 * flag an error. */
-                xResult = 0;
-                break;
+                /* Retry the queued record. This message is written after
+                 * it, in its own record. */
+                xResult = prvFlushSendBuffer( pxCtx );
             }
-            else if( MBEDTLS_ERR_SSL_WANT_WRITE != xResult )
+            else if( 0U != pxCtx->xSendBufferLength )
             {
-                /* Hard error: invalidate the context and stop. */
-                prvFreeContext( pxCtx );
-                break;
+                /* Send the bytes queued by TLS_SendMore in the same record as
+                 * the start of this message. */
+                xQueued = pxCtx->xSendBufferSize - pxCtx->xSendBufferLength;
+
+                if( xQueued > xMsgLength )
+                {
+                    xQueued = xMsgLength;
+                }
+
+                memcpy( pxCtx->pucSendBuffer + pxCtx->xSendBufferLength, pucMsg, xQueued );
+                pxCtx->xSendBufferLength += xQueued;
+                xResult = prvFlushSendBuffer( pxCtx );
             }
+        #endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
+        if( 0 == xResult )
+        {
+            xResult = prvWrite( pxCtx, pucMsg + xQueued, xMsgLength - xQueued );
+        }
+        else if( 0 < xResult )
+        {
+            /* The socket is full. The rest of the queue is sent by the next
+             * call. */
+            xResult = 0;
+        }
+
+        if( 0 <= xResult )
+        {
+            xResult += ( BaseType_t ) xQueued;
         }
     }
     else
@@ -1049,16 +2163,74 @@ BaseType_t TLS_Send( void * pvContext,
         xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
     }
 
-    if( 0 <= xResult )
-    {
-        xResult = ( BaseType_t ) xWritten;
-    }
-
     return xResult;
 }
 
 /*-----------------------------------------------------------*/
 
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+    BaseType_t TLS_SendMore( void * pvContext,
+                             const unsigned char * pucMsg,
+                             size_t xMsgLength )
+    {
+        BaseType_t xResult = 0;
+        TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+        size_t xAccepted = 0;
+        size_t xCopy = 0;
+
+        if( ( NULL != pxCtx ) && ( TLS_HANDSHAKE_SUCCESSFUL == pxCtx->xTLSHandshakeState ) )
+        {
+            if( 0U == pxCtx->xSendBufferSize )
+            {
+                /* There is no buffer to queue into. */
+                xResult = TLS_Send( pvContext, pucMsg, xMsgLength );
+            }
+            else
+            {
+                if( pdFALSE != pxCtx->xSendBufferBlocked )
+                {
+                    /* Retry the queued record before queueing more. */
+                    xResult = prvFlushSendBuffer( pxCtx );
+                }
+
+                while( ( xAccepted < xMsgLength ) && ( 0 == xResult ) )
+                {
+                    xCopy = pxCtx->xSendBufferSize - pxCtx->xSendBufferLength;
+
+                    if( xCopy > ( xMsgLength - xAccepted ) )
+                    {
+                        xCopy = xMsgLength - xAccepted;
+                    }
+
+                    memcpy( pxCtx->pucSendBuffer + pxCtx->xSendBufferLength, pucMsg + xAccepted, xCopy );
+                    pxCtx->xSendBufferLength += xCopy;
+                    xAccepted += xCopy;
+
+                    /* Write each record as soon as it is full. Stop if the
+                     * socket is full. */
+                    if( pxCtx->xSendBufferLength == pxCtx->xSendBufferSize )
+                    {
+                        xResult = prvFlushSendBuffer( pxCtx );
+                    }
+                }
+
+                if( 0 <= xResult )
+                {
+                    xResult = ( BaseType_t ) xAccepted;
+                }
+            }
+        }
+        else
+        {
+            xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+        }
+
+        return xResult;
+    }
+#endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
+/*-----------------------------------------------------------*/
+
 void TLS_Cleanup( void * pvContext )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
@@ -26,6 +26,11 @@
 /* Standard includes. */
 #include <string.h>
 
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
 /* Test framework includes. */
 #include "unity_fixture.h"
 #include "aws_test_runner.h"
@@ -47,6 +52,13 @@
 #include "iot_pkcs11_config.h"
 #include "iot_pkcs11.h"
 
+/* TLS include. */
+#include "iot_tls.h"
+
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+    #include "iot_default_root_certificates.h"
+#endif
+
 /*
  * Length of elliptic curve credentials included from aws_clientcredential_keys.h.
  */
@@ -70,6 +82,67 @@ static const uint32_t tlstestCLIENT_UNTRUSTED_PRIVATE_KEY_PEM_LENGTH = sizeof( t
 static const uint32_t tlstestCLIENT_BYOC_CERTIFICATE_PEM_LENGTH = sizeof( tlstestCLIENT_BYOC_CERTIFICATE_PEM );
 static const uint32_t tlstestCLIENT_BYOC_PRIVATE_KEY_PEM_LENGTH = sizeof( tlstestCLIENT_BYOC_PRIVATE_KEY_PEM );
 
+/*
+ * Parallel handshake benchmark, run by the Full_TLS_PARALLEL group when
+ * testrunnerFULL_TLS_PARALLEL_ENABLED is 1. It needs heap for
+ * tlstestPARALLEL_HANDSHAKE_TASKS connections at once, and a server that
+ * accepts them. These can be configured in the test configuration.
+ */
+#ifndef tlstestPARALLEL_HANDSHAKE_TASKS
+    #define tlstestPARALLEL_HANDSHAKE_TASKS    ( 4 )
+#endif
+
+#ifndef tlstestHANDSHAKES_PER_TASK
+    #define tlstestHANDSHAKES_PER_TASK    ( 4 )
+#endif
+
+#ifndef tlstestHANDSHAKE_TASK_STACK_SIZE
+    #define tlstestHANDSHAKE_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+#endif
+
+#ifndef tlstestHANDSHAKE_TASK_PRIORITY
+    #define tlstestHANDSHAKE_TASK_PRIORITY    ( tskIDLE_PRIORITY )
+#endif
+
+#ifndef tlstestHANDSHAKE_TIMEOUT_MS
+    #define tlstestHANDSHAKE_TIMEOUT_MS    ( 300000 )
+#endif
+
+/* Parameters and result of one handshake task. */
+typedef struct HandshakeTaskParams
+{
+    BaseType_t xTaskNumber;
+    EventGroupHandle_t xDoneEvents;
+    SocketsSockaddr_t * pxServerAddress;
+    uint32_t ulSucceeded;
+} HandshakeTaskParams_t;
+
+/* Static, because tasks that time out may still write to them. */
+static HandshakeTaskParams_t xHandshakeTaskParams[ tlstestPARALLEL_HANDSHAKE_TASKS ];
+
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+
+/* TLS_SendMore collects at most one record. */
+    #if ( tlsconfigMAX_FRAGMENT_LENGTH != 0 ) && ( tlsconfigMAX_FRAGMENT_LENGTH < tlsconfigSEND_BUFFER_SIZE )
+        #define tlstestSEND_BUFFER_SIZE    ( tlsconfigMAX_FRAGMENT_LENGTH )
+    #else
+        #define tlstestSEND_BUFFER_SIZE    ( tlsconfigSEND_BUFFER_SIZE )
+    #endif
+
+/* The records that the TLS library writes after the handshake. They are
+ * counted instead of sent, so the server never sees them. */
+    typedef struct SendCapture
+    {
+        Socket_t xSocket;
+        BaseType_t xCapturing;
+        BaseType_t xSocketFull;
+        uint32_t ulRecords;
+    } SendCapture_t;
+
+    static SendCapture_t xSendCapture;
+    static unsigned char ucSendData[ tlstestSEND_BUFFER_SIZE + 1 ];
+#endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
 /*-----------------------------------------------------------*/
 
 TEST_GROUP( Full_TLS );
@@ -93,6 +166,37 @@ TEST_GROUP_RUNNER( Full_TLS )
         RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectMalformedCert );
         RUN_TEST_CASE( Full_TLS, AFQP_TLS_ConnectUntrustedCert );
     #endif
+    RUN_TEST_CASE( Full_TLS, AFQP_TLS_PeekConsume );
+    #if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_SendMoreOneRecord );
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_SendMoreFullBuffer );
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_SendFlush );
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_SendMoreSocketFull );
+    #endif
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_ResumeSession );
+    #endif
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_CredentialCacheReuse );
+        RUN_TEST_CASE( Full_TLS, AFQP_TLS_CredentialCacheInvalidation );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_TLS_PARALLEL );
+
+TEST_SETUP( Full_TLS_PARALLEL )
+{
+}
+
+TEST_TEAR_DOWN( Full_TLS_PARALLEL )
+{
+}
+
+TEST_GROUP_RUNNER( Full_TLS_PARALLEL )
+{
+    RUN_TEST_CASE( Full_TLS_PARALLEL, AFQP_TLS_ParallelHandshakes );
 }
 
 /*-----------------------------------------------------------*/
@@ -121,6 +225,21 @@ static void prvSecureSocketClose( Socket_t xSocket )
 }
 /*-----------------------------------------------------------*/
 
+/* The TLS library may hold on to the credentials that were read for an
+ * earlier connection, and to sessions that were negotiated with them. Make it
+ * read them again after re-provisioning. */
+static void prvCredentialsChanged( void )
+{
+    #if ( tlsconfigCACHE_CREDENTIALS == 1 )
+        TLS_FlushCredentialCache();
+    #endif
+
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        TLS_FlushSessionCache();
+    #endif
+}
+/*-----------------------------------------------------------*/
+
 static void prvConnectWithProvisioning( ProvisioningParams_t * pxProvisioningParams,
                                         BaseType_t xConnectExpectedToSucceed )
 {
@@ -135,6 +254,7 @@ static void prvConnectWithProvisioning( ProvisioningParams_t * pxProvisioningPar
     {
         /* Provision the device with the supplied parameters. */
         vAlternateKeyProvisioning( pxProvisioningParams );
+        prvCredentialsChanged();
 
         /* Create socket. */
         xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
@@ -196,6 +316,7 @@ static void prvConnectWithProvisioning( ProvisioningParams_t * pxProvisioningPar
          * device with default RSA certs so that subsequent tests
          * are not changed. */
         vDevModeKeyProvisioning();
+        prvCredentialsChanged();
     }
     else
     {
@@ -221,6 +342,7 @@ static void prvExpectFailAfterDataSentWithProvisioning( ProvisioningParams_t * p
     {
         /* Provision the device with the supplied parameters. */
         vAlternateKeyProvisioning( pxProvisioningParams );
+        prvCredentialsChanged();
 
         /* Create socket. */
         xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
@@ -274,6 +396,7 @@ static void prvExpectFailAfterDataSentWithProvisioning( ProvisioningParams_t * p
      * device with default certs so that subsequent tests
      * are not changed. */
     vDevModeKeyProvisioning();
+    prvCredentialsChanged();
 }
 /*-----------------------------------------------------------*/
 
@@ -374,3 +497,588 @@ TEST( Full_TLS, AFQP_TLS_ConnectBYOCCredentials )
                                 );
 }
 /*-----------------------------------------------------------*/
+
+/* Network callbacks of the TLS library on a plain socket. */
+static BaseType_t prvSocketSend( void * pvCallerContext,
+                                 const unsigned char * pucData,
+                                 size_t xDataLength )
+{
+    return SOCKETS_Send( ( Socket_t ) pvCallerContext, pucData, xDataLength, 0 );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSocketRecv( void * pvCallerContext,
+                                 unsigned char * pucReceiveBuffer,
+                                 size_t xReceiveLength )
+{
+    return SOCKETS_Recv( ( Socket_t ) pvCallerContext, pucReceiveBuffer, xReceiveLength, 0 );
+}
+/*-----------------------------------------------------------*/
+
+/* The replies of the MQTT broker are read where the TLS library decrypted
+ * them. A partly consumed record is returned again from the first byte that
+ * was not consumed, and the next record is only read when the current one has
+ * been consumed completely. */
+TEST( Full_TLS, AFQP_TLS_PeekConsume )
+{
+    const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+    const size_t xClientIdLength = strlen( clientcredentialIOT_THING_NAME );
+    const unsigned char ucPingRequest[] = { 0xC0, 0x00 };
+    const unsigned char ucDisconnect[] = { 0xE0, 0x00 };
+    unsigned char ucConnect[ 14 + 64 ];
+    size_t xConnectLength;
+    SocketsSockaddr_t xServerAddress = { 0 };
+    TLSParams_t xTLSParams = { 0 };
+    Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+    void * pvContext = NULL;
+    const unsigned char * pucData = NULL;
+    const unsigned char * pucDataAgain = NULL;
+    BaseType_t xResult;
+
+    TEST_ASSERT_LESS_OR_EQUAL( sizeof( ucConnect ) - 14U, xClientIdLength );
+
+    /* MQTT 3.1.1 CONNECT with a clean session and a keep-alive of 60 seconds. */
+    xConnectLength = 14U + xClientIdLength;
+    ucConnect[ 0 ] = 0x10;
+    ucConnect[ 1 ] = ( unsigned char ) ( xConnectLength - 2U );
+    memcpy( &ucConnect[ 2 ], "\x00\x04MQTT\x04\x02\x00\x3C", 10 );
+    ucConnect[ 12 ] = ( unsigned char ) ( xClientIdLength >> 8 );
+    ucConnect[ 13 ] = ( unsigned char ) xClientIdLength;
+    memcpy( &ucConnect[ 14 ], clientcredentialIOT_THING_NAME, xClientIdLength );
+
+    if( TEST_PROTECT() )
+    {
+        xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( SOCKETS_INVALID_SOCKET, xSocket );
+
+        xServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+        xServerAddress.usPort = SOCKETS_htons( clientcredentialMQTT_BROKER_PORT );
+        xServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+        xResult = SOCKETS_Connect( xSocket, &xServerAddress, sizeof( xServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+        xTLSParams.ulSize = sizeof( xTLSParams );
+        xTLSParams.pcDestination = pcAWSIoTAddress;
+        xTLSParams.usDestinationPort = xServerAddress.usPort;
+        xTLSParams.pvCallerContext = xSocket;
+        xTLSParams.pxNetworkRecv = prvSocketRecv;
+        xTLSParams.pxNetworkSend = prvSocketSend;
+
+        xResult = TLS_Init( &pvContext, &xTLSParams );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS_Init failed" );
+
+        xResult = TLS_Connect( pvContext );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS_Connect failed" );
+
+        TEST_ASSERT_EQUAL_INT32( xConnectLength, TLS_Send( pvContext, ucConnect, xConnectLength ) );
+
+        /* CONNACK, connection accepted. */
+        TEST_ASSERT_EQUAL_INT32( 4, TLS_Peek( pvContext, &pucData ) );
+        TEST_ASSERT_EQUAL_HEX8( 0x20, pucData[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0x02, pucData[ 1 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0x00, pucData[ 3 ] );
+
+        TLS_Consume( pvContext, 1 );
+        TEST_ASSERT_EQUAL_INT32( 3, TLS_Peek( pvContext, &pucDataAgain ) );
+        TEST_ASSERT_EQUAL_PTR( pucData + 1, pucDataAgain );
+        TLS_Consume( pvContext, 3 );
+
+        /* PINGRESP, in the next record. */
+        TEST_ASSERT_EQUAL_INT32( sizeof( ucPingRequest ), TLS_Send( pvContext, ucPingRequest, sizeof( ucPingRequest ) ) );
+        TEST_ASSERT_EQUAL_INT32( 2, TLS_Peek( pvContext, &pucData ) );
+        TEST_ASSERT_EQUAL_HEX8( 0xD0, pucData[ 0 ] );
+        TEST_ASSERT_EQUAL_HEX8( 0x00, pucData[ 1 ] );
+        TLS_Consume( pvContext, 2 );
+
+        ( void ) TLS_Send( pvContext, ucDisconnect, sizeof( ucDisconnect ) );
+    }
+
+    if( NULL != pvContext )
+    {
+        TLS_Cleanup( pvContext );
+    }
+
+    if( SOCKETS_INVALID_SOCKET != xSocket )
+    {
+        ( void ) SOCKETS_Close( xSocket );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#if ( tlsconfigSEND_BUFFER_SIZE > 0 )
+
+/* Network send callback of the TLS library. Once capturing, it counts the
+ * records, or reports that the socket has no room, as FreeRTOS_send does. */
+    static BaseType_t prvCaptureSend( void * pvCallerContext,
+                                      const unsigned char * pucData,
+                                      size_t xDataLength )
+    {
+        SendCapture_t * pxCapture = ( SendCapture_t * ) pvCallerContext;
+        BaseType_t xResult;
+
+        if( pdFALSE == pxCapture->xCapturing )
+        {
+            xResult = SOCKETS_Send( pxCapture->xSocket, pucData, xDataLength, 0 );
+        }
+        else if( pdFALSE != pxCapture->xSocketFull )
+        {
+            xResult = -pdFREERTOS_ERRNO_ENOSPC;
+        }
+        else
+        {
+            pxCapture->ulRecords++;
+            xResult = ( BaseType_t ) xDataLength;
+        }
+
+        return xResult;
+    }
+/*-----------------------------------------------------------*/
+
+/* Network receive callback of the TLS library. */
+    static BaseType_t prvCaptureRecv( void * pvCallerContext,
+                                      unsigned char * pucReceiveBuffer,
+                                      size_t xReceiveLength )
+    {
+        SendCapture_t * pxCapture = ( SendCapture_t * ) pvCallerContext;
+
+        return SOCKETS_Recv( pxCapture->xSocket, pucReceiveBuffer, xReceiveLength, 0 );
+    }
+/*-----------------------------------------------------------*/
+
+/* Connects to the MQTT broker with the TLS library on a plain socket, and
+ * starts capturing the records that are sent. */
+    static void prvSendCaptureConnect( void ** ppvContext )
+    {
+        const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+        SocketsSockaddr_t xServerAddress = { 0 };
+        TLSParams_t xTLSParams = { 0 };
+        BaseType_t xResult;
+
+        memset( &xSendCapture, 0, sizeof( xSendCapture ) );
+        xSendCapture.xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL( SOCKETS_INVALID_SOCKET, xSendCapture.xSocket );
+
+        xServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+        xServerAddress.usPort = SOCKETS_htons( clientcredentialMQTT_BROKER_PORT );
+        xServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+        xResult = SOCKETS_Connect( xSendCapture.xSocket, &xServerAddress, sizeof( xServerAddress ) );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+        xTLSParams.ulSize = sizeof( xTLSParams );
+        xTLSParams.pcDestination = pcAWSIoTAddress;
+        xTLSParams.usDestinationPort = xServerAddress.usPort;
+        xTLSParams.pvCallerContext = &xSendCapture;
+        xTLSParams.pxNetworkRecv = prvCaptureRecv;
+        xTLSParams.pxNetworkSend = prvCaptureSend;
+
+        xResult = TLS_Init( ppvContext, &xTLSParams );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS_Init failed" );
+
+        xResult = TLS_Connect( *ppvContext );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( 0, xResult, "TLS_Connect failed" );
+
+        xSendCapture.xCapturing = pdTRUE;
+    }
+/*-----------------------------------------------------------*/
+
+/* Frees the TLS context and closes the socket of prvSendCaptureConnect. The
+ * close notification is captured as well. */
+    static void prvSendCaptureClose( void * pvContext )
+    {
+        xSendCapture.xCapturing = pdTRUE;
+        xSendCapture.xSocketFull = pdFALSE;
+
+        if( NULL != pvContext )
+        {
+            TLS_Cleanup( pvContext );
+        }
+
+        if( SOCKETS_INVALID_SOCKET != xSendCapture.xSocket )
+        {
+            ( void ) SOCKETS_Close( xSendCapture.xSocket );
+            xSendCapture.xSocket = SOCKETS_INVALID_SOCKET;
+        }
+    }
+/*-----------------------------------------------------------*/
+
+/* Bytes queued by TLS_SendMore are sent in the record of the next TLS_Send. */
+    TEST( Full_TLS, AFQP_TLS_SendMoreOneRecord )
+    {
+        void * pvContext = NULL;
+
+        if( TEST_PROTECT() )
+        {
+            prvSendCaptureConnect( &pvContext );
+
+            TEST_ASSERT_EQUAL_INT32( 1, TLS_SendMore( pvContext, ucSendData, 1 ) );
+            TEST_ASSERT_EQUAL_INT32( 2, TLS_SendMore( pvContext, ucSendData, 2 ) );
+            TEST_ASSERT_EQUAL_UINT32( 0, xSendCapture.ulRecords );
+
+            TEST_ASSERT_EQUAL_INT32( 3, TLS_Send( pvContext, ucSendData, 3 ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, xSendCapture.ulRecords );
+        }
+
+        prvSendCaptureClose( pvContext );
+    }
+/*-----------------------------------------------------------*/
+
+/* TLS_SendMore writes a record as soon as the buffer is full. */
+    TEST( Full_TLS, AFQP_TLS_SendMoreFullBuffer )
+    {
+        void * pvContext = NULL;
+
+        if( TEST_PROTECT() )
+        {
+            prvSendCaptureConnect( &pvContext );
+
+            TEST_ASSERT_EQUAL_INT32( tlstestSEND_BUFFER_SIZE - 1, TLS_SendMore( pvContext, ucSendData, tlstestSEND_BUFFER_SIZE - 1 ) );
+            TEST_ASSERT_EQUAL_UINT32( 0, xSendCapture.ulRecords );
+
+            TEST_ASSERT_EQUAL_INT32( 1, TLS_SendMore( pvContext, ucSendData, 1 ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, xSendCapture.ulRecords );
+
+            /* Nothing is left to send. */
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, xSendCapture.ulRecords );
+
+            /* A byte more than the buffer stays queued. */
+            TEST_ASSERT_EQUAL_INT32( tlstestSEND_BUFFER_SIZE + 1, TLS_SendMore( pvContext, ucSendData, tlstestSEND_BUFFER_SIZE + 1 ) );
+            TEST_ASSERT_EQUAL_UINT32( 2, xSendCapture.ulRecords );
+
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 3, xSendCapture.ulRecords );
+        }
+
+        prvSendCaptureClose( pvContext );
+    }
+/*-----------------------------------------------------------*/
+
+/* TLS_Send with a length of 0 only sends the queued bytes. */
+    TEST( Full_TLS, AFQP_TLS_SendFlush )
+    {
+        void * pvContext = NULL;
+
+        if( TEST_PROTECT() )
+        {
+            prvSendCaptureConnect( &pvContext );
+
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 0, xSendCapture.ulRecords );
+
+            TEST_ASSERT_EQUAL_INT32( 3, TLS_SendMore( pvContext, ucSendData, 3 ) );
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, xSendCapture.ulRecords );
+
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 1, xSendCapture.ulRecords );
+        }
+
+        prvSendCaptureClose( pvContext );
+    }
+/*-----------------------------------------------------------*/
+
+/* When the socket has no room, mbedTLS keeps the queued record, and it must
+ * be sent before any other bytes are accepted. */
+    TEST( Full_TLS, AFQP_TLS_SendMoreSocketFull )
+    {
+        void * pvContext = NULL;
+
+        if( TEST_PROTECT() )
+        {
+            prvSendCaptureConnect( &pvContext );
+
+            TEST_ASSERT_EQUAL_INT32( 3, TLS_SendMore( pvContext, ucSendData, 3 ) );
+            xSendCapture.xSocketFull = pdTRUE;
+
+            /* Only the bytes that were added to the queued record are
+             * accepted. */
+            TEST_ASSERT_EQUAL_INT32( tlstestSEND_BUFFER_SIZE - 3, TLS_Send( pvContext, ucSendData, tlstestSEND_BUFFER_SIZE ) );
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 5 ) );
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_SendMore( pvContext, ucSendData, 5 ) );
+            TEST_ASSERT_EQUAL_UINT32( 0, xSendCapture.ulRecords );
+
+            /* The queued record goes first, the new bytes in their own
+             * record. */
+            xSendCapture.xSocketFull = pdFALSE;
+            TEST_ASSERT_EQUAL_INT32( 5, TLS_Send( pvContext, ucSendData, 5 ) );
+            TEST_ASSERT_EQUAL_UINT32( 2, xSendCapture.ulRecords );
+
+            /* A full buffer that could not be written is accepted, and sent
+             * by the next call. */
+            xSendCapture.xSocketFull = pdTRUE;
+            TEST_ASSERT_EQUAL_INT32( tlstestSEND_BUFFER_SIZE, TLS_SendMore( pvContext, ucSendData, tlstestSEND_BUFFER_SIZE ) );
+            TEST_ASSERT_EQUAL_UINT32( 2, xSendCapture.ulRecords );
+
+            xSendCapture.xSocketFull = pdFALSE;
+            TEST_ASSERT_EQUAL_INT32( 0, TLS_Send( pvContext, ucSendData, 0 ) );
+            TEST_ASSERT_EQUAL_UINT32( 3, xSendCapture.ulRecords );
+        }
+
+        prvSendCaptureClose( pvContext );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigSEND_BUFFER_SIZE > 0 ) */
+
+#if ( tlsconfigCACHE_SESSIONS == 1 ) || ( tlsconfigCACHE_CREDENTIALS == 1 )
+
+/* Connects to the MQTT broker and disconnects, trusting the given root CA or
+ * the default ones if it is NULL. */
+    static void prvConnectAndDisconnect( const char * pcRootCA,
+                                         uint32_t ulRootCALength )
+    {
+        const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+        SocketsSockaddr_t xMQTTServerAddress = { 0 };
+        Socket_t xSocket;
+        BaseType_t xResult;
+
+        xMQTTServerAddress.ulAddress = SOCKETS_GetHostByName( pcAWSIoTAddress );
+        xMQTTServerAddress.usPort = SOCKETS_htons( clientcredentialMQTT_BROKER_PORT );
+        xMQTTServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+
+        xSocket = prvSecureSocketCreate();
+
+        if( TEST_PROTECT() )
+        {
+            xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt server name indication failed" );
+
+            if( pcRootCA != NULL )
+            {
+                xResult = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_TRUSTED_SERVER_CERTIFICATE, pcRootCA, ulRootCALength );
+                TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket set sock opt trusted server certificate failed" );
+            }
+
+            xResult = SOCKETS_Connect( xSocket, &xMQTTServerAddress, sizeof( xMQTTServerAddress ) );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket connect failed" );
+
+            xResult = SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+            TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket disconnect failed" );
+        }
+
+        prvSecureSocketClose( xSocket );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigCACHE_SESSIONS == 1 ) || ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+
+#if ( tlsconfigCACHE_SESSIONS == 1 )
+
+/* Connects to the MQTT broker and disconnects, and returns the handshake
+ * counters. */
+    static void prvConnectAndCount( const char * pcRootCA,
+                                    uint32_t ulRootCALength,
+                                    TLSHandshakeCounters_t * pxCounters )
+    {
+        prvConnectAndDisconnect( pcRootCA, ulRootCALength );
+        TLS_GetHandshakeCounters( pxCounters );
+    }
+/*-----------------------------------------------------------*/
+
+    TEST( Full_TLS, AFQP_TLS_ResumeSession )
+    {
+        TLSHandshakeCounters_t xBefore = { 0 };
+        TLSHandshakeCounters_t xAfter = { 0 };
+
+        TLS_FlushSessionCache();
+        TLS_GetHandshakeCounters( &xBefore );
+
+        /* Nothing is cached, so the first connection negotiates a session. */
+        prvConnectAndCount( NULL, 0, &xAfter );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulFullHandshakes + 1U, xAfter.ulFullHandshakes );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulResumedHandshakes, xAfter.ulResumedHandshakes );
+        xBefore = xAfter;
+
+        /* The second connection to the same server resumes it. */
+        prvConnectAndCount( NULL, 0, &xAfter );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulFullHandshakes, xAfter.ulFullHandshakes );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulResumedHandshakes + 1U, xAfter.ulResumedHandshakes );
+        xBefore = xAfter;
+
+        /* A connection that trusts other root CAs must verify the server
+         * certificate itself, even though the server is the same. */
+        prvConnectAndCount( tlsATS1_ROOT_CERTIFICATE_PEM, tlsATS1_ROOT_CERTIFICATE_LENGTH, &xAfter );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulFullHandshakes + 1U, xAfter.ulFullHandshakes );
+        TEST_ASSERT_EQUAL_UINT32( xBefore.ulResumedHandshakes, xAfter.ulResumedHandshakes );
+
+        TLS_FlushSessionCache();
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigCACHE_SESSIONS == 1 ) */
+
+#if ( tlsconfigCACHE_CREDENTIALS == 1 )
+
+/* Connections share the credentials that were read for the first of them. */
+    TEST( Full_TLS, AFQP_TLS_CredentialCacheReuse )
+    {
+        uint32_t ulLoads;
+
+        TLS_FlushCredentialCache();
+        ulLoads = TLS_GetCredentialCacheLoads();
+
+        prvConnectAndDisconnect( NULL, 0 );
+        TEST_ASSERT_EQUAL_UINT32( ulLoads + 1U, TLS_GetCredentialCacheLoads() );
+
+        prvConnectAndDisconnect( NULL, 0 );
+        prvConnectAndDisconnect( NULL, 0 );
+        TEST_ASSERT_EQUAL_UINT32( ulLoads + 1U, TLS_GetCredentialCacheLoads() );
+    }
+/*-----------------------------------------------------------*/
+
+/* Provisioning creates new PKCS #11 objects, so that the handle of the
+ * private key in the cache is no longer valid. After the cache has been
+ * flushed, the next connection reads the new credentials and succeeds, and
+ * the connections after it share them again. */
+    TEST( Full_TLS, AFQP_TLS_CredentialCacheInvalidation )
+    {
+        uint32_t ulLoads;
+
+        prvConnectAndDisconnect( NULL, 0 );
+        ulLoads = TLS_GetCredentialCacheLoads();
+
+        vDevModeKeyProvisioning();
+        prvCredentialsChanged();
+        TEST_ASSERT_EQUAL_UINT32( ulLoads, TLS_GetCredentialCacheLoads() );
+
+        prvConnectAndDisconnect( NULL, 0 );
+        TEST_ASSERT_EQUAL_UINT32( ulLoads + 1U, TLS_GetCredentialCacheLoads() );
+
+        prvConnectAndDisconnect( NULL, 0 );
+        TEST_ASSERT_EQUAL_UINT32( ulLoads + 1U, TLS_GetCredentialCacheLoads() );
+    }
+/*-----------------------------------------------------------*/
+#endif /* if ( tlsconfigCACHE_CREDENTIALS == 1 ) */
+
+/* Connects and disconnects tlstestHANDSHAKES_PER_TASK times. Unity asserts
+ * are not used, because they may only be called from the test task. */
+static void prvHandshakeTask( void * pvParameters )
+{
+    HandshakeTaskParams_t * pxParams = ( HandshakeTaskParams_t * ) pvParameters;
+    const char * pcAWSIoTAddress = clientcredentialMQTT_BROKER_ENDPOINT;
+    Socket_t xSocket;
+    uint32_t ulHandshake;
+
+    for( ulHandshake = 0; ulHandshake < tlstestHANDSHAKES_PER_TASK; ulHandshake++ )
+    {
+        xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+
+        if( SOCKETS_INVALID_SOCKET == xSocket )
+        {
+            break;
+        }
+
+        if( ( SOCKETS_ERROR_NONE == SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_REQUIRE_TLS, NULL, 0 ) ) &&
+            ( SOCKETS_ERROR_NONE == SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_SERVER_NAME_INDICATION, pcAWSIoTAddress, 1u + strlen( pcAWSIoTAddress ) ) ) &&
+            ( SOCKETS_ERROR_NONE == SOCKETS_Connect( xSocket, pxParams->pxServerAddress, sizeof( SocketsSockaddr_t ) ) ) )
+        {
+            pxParams->ulSucceeded++;
+            ( void ) SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+        }
+
+        ( void ) SOCKETS_Close( xSocket );
+    }
+
+    ( void ) xEventGroupSetBits( pxParams->xDoneEvents, ( EventBits_t ) ( 1UL << pxParams->xTaskNumber ) );
+    vTaskDelete( NULL );
+}
+/*-----------------------------------------------------------*/
+
+/* Runs the handshake task in xTaskCount tasks at the same time. Returns the
+ * number of successful handshakes, and the time they took in *pulElapsedMs. */
+static uint32_t prvRunHandshakeTasks( BaseType_t xTaskCount,
+                                      SocketsSockaddr_t * pxServerAddress,
+                                      uint32_t * pulElapsedMs )
+{
+    EventGroupHandle_t xDoneEvents;
+    EventBits_t xCreatedBits = 0;
+    EventBits_t xDoneBits = 0;
+    TickType_t xStart;
+    uint32_t ulSucceeded = 0;
+    BaseType_t xTaskNumber;
+
+    xDoneEvents = xEventGroupCreate();
+    TEST_ASSERT_NOT_NULL_MESSAGE( xDoneEvents, "Failed to create the event group." );
+
+    xStart = xTaskGetTickCount();
+
+    for( xTaskNumber = 0; xTaskNumber < xTaskCount; xTaskNumber++ )
+    {
+        xHandshakeTaskParams[ xTaskNumber ].xTaskNumber = xTaskNumber;
+        xHandshakeTaskParams[ xTaskNumber ].xDoneEvents = xDoneEvents;
+        xHandshakeTaskParams[ xTaskNumber ].pxServerAddress = pxServerAddress;
+        xHandshakeTaskParams[ xTaskNumber ].ulSucceeded = 0;
+
+        if( pdPASS == xTaskCreate( prvHandshakeTask,
+                                   "Handshake",
+                                   tlstestHANDSHAKE_TASK_STACK_SIZE,
+                                   &( xHandshakeTaskParams[ xTaskNumber ] ),
+                                   tlstestHANDSHAKE_TASK_PRIORITY,
+                                   NULL ) )
+        {
+            xCreatedBits |= ( EventBits_t ) ( 1UL << xTaskNumber );
+        }
+    }
+
+    if( 0 != xCreatedBits )
+    {
+        xDoneBits = xEventGroupWaitBits( xDoneEvents,
+                                         xCreatedBits,
+                                         pdFALSE,
+                                         pdTRUE,
+                                         pdMS_TO_TICKS( tlstestHANDSHAKE_TIMEOUT_MS ) );
+    }
+
+    *pulElapsedMs = ( uint32_t ) ( ( xTaskGetTickCount() - xStart ) * portTICK_PERIOD_MS );
+
+    /* Tasks that timed out still use the event group. */
+    if( ( xDoneBits & xCreatedBits ) == xCreatedBits )
+    {
+        vEventGroupDelete( xDoneEvents );
+    }
+
+    for( xTaskNumber = 0; xTaskNumber < xTaskCount; xTaskNumber++ )
+    {
+        ulSucceeded += xHandshakeTaskParams[ xTaskNumber ].ulSucceeded;
+    }
+
+    TEST_ASSERT_EQUAL_MESSAGE( xCreatedBits, xDoneBits & xCreatedBits, "Timed out waiting for the handshake tasks." );
+    TEST_ASSERT_EQUAL_MESSAGE( ( ( EventBits_t ) 1UL << xTaskCount ) - 1UL, xCreatedBits, "Failed to create the handshake tasks." );
+
+    return ulSucceeded;
+}
+/*-----------------------------------------------------------*/
+
+/* Compares the handshake rate of one task with the rate of
+ * tlstestPARALLEL_HANDSHAKE_TASKS tasks, which should be higher when the
+ * crypto of different connections does not wait on shared locks. */
+TEST( Full_TLS_PARALLEL, AFQP_TLS_ParallelHandshakes )
+{
+    SocketsSockaddr_t xServerAddress = { 0 };
+    uint32_t ulSucceeded;
+    uint32_t ulElapsedMs;
+
+    xServerAddress.ulAddress = SOCKETS_GetHostByName( clientcredentialMQTT_BROKER_ENDPOINT );
+    xServerAddress.usPort = SOCKETS_htons( clientcredentialMQTT_BROKER_PORT );
+    xServerAddress.ucSocketDomain = SOCKETS_AF_INET;
+    TEST_ASSERT_NOT_EQUAL_MESSAGE( 0, xServerAddress.ulAddress, "DNS lookup failed." );
+
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        /* Measure full handshakes. */
+        TLS_FlushSessionCache();
+    #endif
+
+    ulSucceeded = prvRunHandshakeTasks( 1, &xServerAddress, &ulElapsedMs );
+    configPRINTF( ( "%u handshakes in %u ms with 1 task.\r\n",
+                    ( unsigned ) ulSucceeded, ( unsigned ) ulElapsedMs ) );
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( tlstestHANDSHAKES_PER_TASK, ulSucceeded, "Not all handshakes succeeded." );
+
+    #if ( tlsconfigCACHE_SESSIONS == 1 )
+        TLS_FlushSessionCache();
+    #endif
+
+    ulSucceeded = prvRunHandshakeTasks( tlstestPARALLEL_HANDSHAKE_TASKS, &xServerAddress, &ulElapsedMs );
+    configPRINTF( ( "%u handshakes in %u ms with %u tasks.\r\n",
+                    ( unsigned ) ulSucceeded, ( unsigned ) ulElapsedMs, ( unsigned ) tlstestPARALLEL_HANDSHAKE_TASKS ) );
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( tlstestPARALLEL_HANDSHAKE_TASKS * tlstestHANDSHAKES_PER_TASK, ulSucceeded, "Not all handshakes succeeded." );
+}
+/*-----------------------------------------------------------*/
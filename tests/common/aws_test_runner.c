@@ -129,6 +129,14 @@ static void RunTests( void )
         RUN_TEST_GROUP( Quarantine_OTA_CBOR );
     #endif
 
+    #if ( testrunnerFULL_OTA_DECOMPRESS_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_OTA_DECOMPRESS );
+    #endif
+
+    #if ( testrunnerFULL_OTA_DELTA_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_OTA_DELTA );
+    #endif
+
     #if ( testrunnerFULL_OTA_AGENT_ENABLED == 1 )
         RUN_TEST_GROUP( Full_OTA_AGENT );
     #endif
@@ -162,6 +170,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_TLS );
     #endif
 
+    #if ( testrunnerFULL_TLS_PARALLEL_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_TLS_PARALLEL );
+    #endif
+
     #if ( testrunnerFULL_DEFENDER_ENABLED == 1 )
         RUN_TEST_GROUP( Defender_Unit );
         RUN_TEST_GROUP( Defender_System );
@@ -213,6 +225,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_FREERTOS_TCP );
     #endif
 
+    #if ( testrunnerFULL_FREERTOS_TCP_BENCHMARK_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_FREERTOS_TCP_BENCHMARK );
+    #endif
+
     #if ( testrunnerFULL_SERIALIZER_ENABLED == 1 )
         RUN_TEST_GROUP( Serializer_Unit_CBOR );
         RUN_TEST_GROUP( Serializer_Unit_JSON );
@@ -44,8 +44,10 @@ function(create_test test_name
     target_link_directories(${test_name}  PUBLIC
                             ${CMAKE_CURRENT_BINARY_DIR}/lib
             )
+    # The target name lets ctest run the test through
+    # CMAKE_CROSSCOMPILING_EMULATOR when cross-compiling.
     add_test(NAME ${test_name}
-             COMMAND ${CMAKE_BINARY_DIR}/bin/${test_name}
+             COMMAND ${test_name}
              WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
             )
 endfunction()
@@ -39,6 +39,7 @@
 #define testrunnerFULL_PKCS11_ENABLED               0
 #define testrunnerFULL_WIFI_ENABLED                 0
 #define testrunnerFULL_TLS_ENABLED                  0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED         0
 #define testrunnerFULL_TCP_ENABLED                  1
 #define testrunnerFULL_MQTT_ALPN_ENABLED            0
 #define testrunnerFULL_MQTT_STRESS_TEST_ENABLED     0
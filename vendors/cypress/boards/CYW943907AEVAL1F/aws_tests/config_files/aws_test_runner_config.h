@@ -59,6 +59,7 @@
 #define testrunnerFULL_SHADOWv4_ENABLED               0
 #define testrunnerFULL_TCP_ENABLED                    1
 #define testrunnerFULL_TLS_ENABLED                    0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED           0
 #define testrunnerFULL_SERIALIZER_ENABLED             0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED       0
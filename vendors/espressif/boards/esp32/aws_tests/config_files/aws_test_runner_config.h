@@ -53,6 +53,7 @@
 #define testrunnerFULL_WIFI_ENABLED                    0
 #define testrunnerFULL_MEMORYLEAK_ENABLED              0
 #define testrunnerFULL_TLS_ENABLED                     0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED            0
 #define testrunnerFULL_BLE_END_TO_END_TEST_ENABLED     0
 #define testrunnerFULL_BLE_ENABLED                     0
 #define testrunnerFULL_BLE_STRESS_TEST_ENABLED         0
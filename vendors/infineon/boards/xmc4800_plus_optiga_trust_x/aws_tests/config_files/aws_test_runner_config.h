@@ -51,6 +51,7 @@
 #define testrunnerFULL_WIFI_ENABLED                0
 #define testrunnerFULL_MEMORYLEAK_ENABLED          0
 #define testrunnerFULL_TLS_ENABLED                 testrunnerUNSUPPORTED
+#define testrunnerFULL_TLS_PARALLEL_ENABLED        testrunnerUNSUPPORTED
 #define testrunnerFULL_TASKPOOL_ENABLED            0
 #define testrunnerFULL_SERIALIZER_ENABLED          0
 #define testrunnerFULL_POSIX_ENABLED               0
@@ -58,6 +58,7 @@
 #define testrunnerFULL_SHADOW_ENABLED              0
 #define testrunnerFULL_TCP_ENABLED                 1
 #define testrunnerFULL_TLS_ENABLED                 0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED        0
 #define testrunnerFULL_OTA_AGENT_ENABLED           0
 #define testrunnerFULL_OTA_PAL_ENABLED             0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED        0
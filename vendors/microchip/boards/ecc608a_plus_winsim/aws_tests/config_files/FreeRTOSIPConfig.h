@@ -224,6 +224,12 @@ extern uint32_t ulRand();
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN                            ( 1 )
 
+/* Let the stack send full-size segments as one packet that is split just
+ * before it is handed to the driver, and handle consecutive received data
+ * segments of a connection as one train. */
+#define ipconfigTCP_SEGMENTATION_OFFLOAD               ( 1 )
+#define ipconfigTCP_RX_COALESCING                      ( 1 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
  * contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
  * lower value can save RAM, depending on the buffer management scheme used.  If
@@ -54,6 +54,7 @@
 #define testrunnerFULL_SHADOWv4_ENABLED               0
 #define testrunnerFULL_TCP_ENABLED                    1
 #define testrunnerFULL_TLS_ENABLED                    0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED           0
 #define testrunnerFULL_MEMORYLEAK_ENABLED             0
 #define testrunnerFULL_OTA_CBOR_ENABLED               0
 #define testrunnerFULL_OTA_AGENT_ENABLED              0
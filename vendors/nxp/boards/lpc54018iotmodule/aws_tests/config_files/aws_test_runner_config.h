@@ -47,6 +47,7 @@
 #define testrunnerFULL_CRYPTO_ENABLED              0
 #define testrunnerFULL_MEMORYLEAK_ENABLED          0
 #define testrunnerFULL_TLS_ENABLED                 0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED        0
 #define testrunnerFULL_POSIX_ENABLED               0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED        0
 #define testrunnerFULL_OTA_AGENT_ENABLED           0
@@ -233,6 +233,13 @@ extern void vLoggingPrint( const char * pcMessage );
 extern uint32_t ulRand();
 #define configRAND32()    ulRand()
 
+/* Share the parsed credentials between the TLS connections of the tests. */
+#define tlsconfigCACHE_CREDENTIALS           ( 1 )
+
+/* Collect the small writes made with TLS_SendMore into records of up to this
+ * many bytes. */
+#define tlsconfigSEND_BUFFER_SIZE            ( 2048 )
+
 /* The platform that FreeRTOS is running on. */
 #define configPLATFORM_NAME    "WinSim"
 
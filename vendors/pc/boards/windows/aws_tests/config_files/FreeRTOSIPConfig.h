@@ -78,6 +78,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define ipconfigDNS_CACHE_ADDRESSES_PER_ENTRY      ( 6 )
 #define ipconfigDNS_REQUEST_ATTEMPTS               ( 2 )
 
+/* Asynchronous look-ups share one socket and one request per name, so that the
+ * test of the asynchronous resolver is run. */
+#define ipconfigDNS_USE_CALLBACKS                  ( 1 )
+#define ipconfigDNS_ASYNC_RESOLVER                 ( 1 )
+
 /* The IP stack executes it its own task (although any application task can make
  * use of its services through the published sockets API). ipconfigUDP_TASK_PRIORITY
  * sets the priority of the task that executes the IP stack.  The priority is a
@@ -162,6 +167,14 @@ extern uint32_t ulRand();
  * number of entries that can exist in the ARP table at any one time. */
 #define ipconfigARP_CACHE_ENTRIES                 6
 
+/* Store the rows of the ARP cache in a hash table, so that the tests of the
+ * hashed cache are run. */
+#define ipconfigARP_CACHE_HASH_BUCKETS            4
+
+/* Store the bound sockets in hash tables, so that the test of the hashed
+ * socket lookup is run. */
+#define ipconfigSOCKET_HASH_BUCKETS               8
+
 /* ARP requests that do not result in an ARP response will be re-transmitted a
  * maximum of ipconfigMAX_ARP_RETRANSMISSIONS times before the ARP request is
  * aborted. */
@@ -199,6 +212,20 @@ extern uint32_t ulRand();
 #define ipconfigEVENT_QUEUE_LENGTH \
     ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS + 5 )
 
+/* Let the IP-task handle up to 8 events before it checks its timers again, so
+ * that the test of the batched wake-ups of UDP sockets is run. */
+#define ipconfigIP_TASK_EVENT_BATCH               8
+
+/* The tests are linked with BufferAllocation_3.c, which takes the storage of the
+ * network buffers from three pools of blocks.  Half of the buffers get a small
+ * block, and the pools together have more blocks than there are descriptors, so
+ * that a small request can be served by a bigger pool. */
+#define ipconfigBUFFER_POOL_SMALL_SIZE            ( 128U )
+#define ipconfigBUFFER_POOL_SMALL_COUNT           ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+#define ipconfigBUFFER_POOL_MEDIUM_SIZE           ( 512U )
+#define ipconfigBUFFER_POOL_MEDIUM_COUNT          ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 4 )
+#define ipconfigBUFFER_POOL_LARGE_COUNT           ( ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS / 2 )
+
 /* The address of a socket is the combination of its IP address and its port
  * number.  FreeRTOS_bind() is used to manually allocate a port number to a socket
  * (to 'bind' the socket to a port), but manual binding is not normally necessary
@@ -224,6 +251,19 @@ extern uint32_t ulRand();
 /* USE_WIN: Let TCP use windowing mechanism. */
 #define ipconfigUSE_TCP_WIN                            ( 1 )
 
+/* Congestion control of the TCP window: CUBIC, with NewReno selectable per
+ * socket, so that the tests of both algorithms are run. */
+#define ipconfigTCP_CONGESTION_CONTROL                 ( 2 )
+
+/* Keep the TCP sockets that have a timer running in a list sorted by expiry
+ * time, so that the IP-task only checks the sockets that are due. */
+#define ipconfigTCP_TIMER_QUEUE                        ( 1 )
+
+/* Handle the TCP connections in two worker tasks, so that the tests of the
+ * workers are run.  This can not be combined with ipconfigTCP_RX_COALESCING or
+ * ipconfigTCP_CHECKSUM_WHILE_COPYING. */
+#define ipconfigIP_TCP_WORKER_TASKS                    ( 2 )
+
 /* The MTU is the maximum number of bytes the payload of a network frame can
  * contain.  For normal Ethernet V2 frames the maximum MTU is 1500.  Setting a
  * lower value can save RAM, depending on the buffer management scheme used.  If
@@ -245,7 +285,11 @@ extern uint32_t ulRand();
 
 /* If ipconfigSUPPORT_SELECT_FUNCTION is set to 1 then the FreeRTOS_select()
  * (and associated) API function is available. */
-#define ipconfigSUPPORT_SELECT_FUNCTION                0
+#define ipconfigSUPPORT_SELECT_FUNCTION                1
+
+/* Let FreeRTOS_select() only look at the sockets of a set that have events,
+ * in stead of at all the sockets of the set. */
+#define ipconfigSELECT_USES_READY_LIST                 1
 
 /* If ipconfigFILTER_OUT_NON_ETHERNET_II_FRAMES is set to 1 then Ethernet frames
  * that are not in Ethernet II format will be dropped.  This option is included for
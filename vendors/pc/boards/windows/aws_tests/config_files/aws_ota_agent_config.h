@@ -95,6 +95,81 @@
  */
 #define otaconfigMAX_NUM_REQUEST_MOMENTUM    32U
 
+/**
+ * @brief The maximum number of data requests kept in flight over MQTT.
+ *
+ * When larger than one, the OTA agent requests the next range of missing blocks before the
+ * previous requests have been answered. The number of outstanding requests starts at one,
+ * grows by one for each request that is fully answered and is halved when the request timer
+ * expires. This hides the round trip time on high latency links. Set to 1 to disable pipelining.
+ */
+#define otaconfigMAX_NUM_OUTSTANDING_REQUESTS    1U
+
+/**
+ * @brief Hash the received file blocks as they arrive.
+ *
+ * Set this to 1 to feed each received block to the file signature check as it is ingested, so the
+ * PAL only has to finish the check when the file is closed instead of reading the whole file back.
+ * Blocks that arrive out of order are held back in a small buffer until the blocks before them
+ * have been hashed.
+ */
+#define otaconfigINCREMENTAL_SIGNATURE_CHECK     1U
+
+/**
+ * @brief The number of out of order blocks held back for the incremental signature check.
+ *
+ * If more blocks than this arrive ahead of the next block to hash, the incremental check is
+ * dropped and the PAL hashes the whole file when it is closed.
+ */
+#define otaconfigMAX_NUM_REORDER_BLOCKS          4U
+
+/**
+ * @brief Persist the download progress so an interrupted transfer can be resumed.
+ *
+ * The block bitmap is saved next to the file being received every otaconfigRX_STATE_SAVE_INTERVAL
+ * blocks and when the agent is suspended. After a reset, a job for the same file picks the download
+ * up where it left off instead of starting over.
+ */
+#define otaconfigRESUMABLE_DOWNLOAD              1U
+
+/**
+ * @brief The number of blocks received between saves of the download progress.
+ */
+#define otaconfigRX_STATE_SAVE_INTERVAL          16U
+
+/**
+ * @brief Accept files that are binary patches against the running image.
+ *
+ * A job marks such a file with "delta": 1. The patch is applied as it is received, reading the
+ * running image through prvPAL_ReadBaseImage() and writing the new image with prvPAL_WriteBlock(),
+ * so only the patch is transferred.
+ */
+#define otaconfigDELTA_UPDATE                    1U
+
+/**
+ * @brief Size in bytes of each of the two buffers used to apply a delta patch.
+ *
+ * One holds part of the running image and the other the new image before it is written, so this
+ * is also the size of the writes made to the new image.
+ */
+#define otaconfigDELTA_BUFFER_SIZE               512U
+
+/**
+ * @brief Accept files that are compressed for transfer.
+ *
+ * A job marks such a file with "compression": 1. The file is decompressed as it is received and
+ * only the decompressed file is written with prvPAL_WriteBlock().
+ */
+#define otaconfigCOMPRESSED_FILES                1U
+
+/**
+ * @brief Size in bytes of the history kept while decompressing a file.
+ *
+ * Must be a power of 2 no larger than 65536, and at least the window size the file was
+ * compressed with. It is also the size of the writes made to the decompressed file.
+ */
+#define otaconfigDECOMPRESS_WINDOW_SIZE          1024U
+
 /**
  * @brief The number of data buffers reserved by the OTA agent.
  *
@@ -53,4 +53,9 @@
  */
 #define AWS_IOT_SECURE_SOCKETS_METRICS_ENABLED    ( 1 )
 
+/**
+ * @brief Enable SOCKETS_Peek and SOCKETS_Consume.
+ */
+#define socketsconfigENABLE_ZERO_COPY_RECV        ( 1 )
+
 #endif /* _AWS_SECURE_SOCKETS_CONFIG_H_ */
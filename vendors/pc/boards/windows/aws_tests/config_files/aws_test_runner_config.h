@@ -41,6 +41,7 @@
 #define testrunnerFULL_TASKPOOL_ENABLED               0
 #define testrunnerFULL_CRYPTO_ENABLED                 0
 #define testrunnerFULL_FREERTOS_TCP_ENABLED           0
+#define testrunnerFULL_FREERTOS_TCP_BENCHMARK_ENABLED 0
 #define testrunnerFULL_DEFENDER_ENABLED               0
 #define testrunnerFULL_GGD_ENABLED                    0
 #define testrunnerFULL_GGD_HELPER_ENABLED             0
@@ -55,9 +56,12 @@
 #define testrunnerFULL_SHADOWv4_ENABLED               0
 #define testrunnerFULL_TCP_ENABLED                    1
 #define testrunnerFULL_TLS_ENABLED                    0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED           1
 #define testrunnerFULL_MEMORYLEAK_ENABLED             0
 #define testrunnerFULL_OTA_CBOR_ENABLED               0
 #define testrunnerFULL_OTA_AGENT_ENABLED              0
+#define testrunnerFULL_OTA_DECOMPRESS_ENABLED         0
+#define testrunnerFULL_OTA_DELTA_ENABLED              0
 #define testrunnerFULL_OTA_PAL_ENABLED                0
 #define testrunnerFULL_SERIALIZER_ENABLED             0
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED         0
@@ -27,6 +27,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <Windows.h>
 #include "FreeRTOS.h"
 #include "iot_crypto.h"
 #include "aws_iot_ota_pal.h"
@@ -42,6 +44,10 @@ static uint8_t * prvPAL_ReadAndAssumeCertificate( const uint8_t * const pucCertN
 
 /*-----------------------------------------------------------*/
 
+#if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+    static char * prvPAL_GetRxStatePath( const OTA_FileContext_t * const C );
+#endif
+
 static inline BaseType_t prvContextValidate( OTA_FileContext_t * C )
 {
     return( ( C != NULL ) &&
@@ -263,16 +269,35 @@ static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
     uint32_t ulBytesRead;
     uint32_t ulSignerCertSize;
     uint8_t * pucBuf, * pucSignerCert;
-    void * pvSigVerifyContext;
+    void * pvSigVerifyContext = NULL;
+    BaseType_t xFileHashed = pdFALSE;
 
     if( prvContextValidate( C ) == pdTRUE )
     {
-        /* Verify an ECDSA-SHA256 signature. */
-        if( pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256 ) )
+        if( ( C->pvSigVerifyContext != NULL ) && ( C->ulHashedBytes == C->ulFileSize ) )
         {
-            eResult = kOTA_Err_SignatureCheckFailed;
+            /* The OTA agent hashed every block as it was received so there is no need to read the file back. */
+            pvSigVerifyContext = C->pvSigVerifyContext;
+            C->pvSigVerifyContext = NULL;
+            xFileHashed = pdTRUE;
         }
         else
+        {
+            if( C->pvSigVerifyContext != NULL )
+            {
+                /* The running hash is incomplete. Free it and hash the whole file instead. */
+                ( void ) CRYPTO_SignatureVerificationFinal( C->pvSigVerifyContext, NULL, 0, NULL, 0 );
+                C->pvSigVerifyContext = NULL;
+            }
+
+            /* Verify an ECDSA-SHA256 signature. */
+            if( pdFALSE == CRYPTO_SignatureVerificationStart( &pvSigVerifyContext, cryptoASYMMETRIC_ALGORITHM_ECDSA, cryptoHASH_ALGORITHM_SHA256 ) )
+            {
+                eResult = kOTA_Err_SignatureCheckFailed;
+            }
+        }
+
+        if( eResult == kOTA_Err_None )
         {
             OTA_LOG_L1( "[%s] Started %s signature verification, file: %s\r\n", OTA_METHOD_NAME,
                         cOTA_JSON_FileSignatureKey, ( const char * ) C->pucCertFilepath );
@@ -280,44 +305,53 @@ static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
 
             if( pucSignerCert != NULL )
             {
-                pucBuf = pvPortMalloc( OTA_PAL_WIN_BUF_SIZE ); /*lint !e9079 Allow conversion. */
-
-                if( pucBuf != NULL )
+                if( xFileHashed == pdFALSE )
                 {
-                    /* Rewind the received file to the beginning. */
-                    if( fseek( C->pxFile, 0L, SEEK_SET ) == 0 ) /*lint !e586
-                                                                  * C standard library call is being used for portability. */
+                    pucBuf = pvPortMalloc( OTA_PAL_WIN_BUF_SIZE ); /*lint !e9079 Allow conversion. */
+
+                    if( pucBuf != NULL )
                     {
-                        do
+                        /* Rewind the received file to the beginning. */
+                        if( fseek( C->pxFile, 0L, SEEK_SET ) == 0 ) /*lint !e586
+                                                                      * C standard library call is being used for portability. */
                         {
-                            ulBytesRead = fread( pucBuf, 1, OTA_PAL_WIN_BUF_SIZE, C->pxFile ); /*lint !e586
-                                                                                               * C standard library call is being used for portability. */
-                            /* Include the file chunk in the signature validation. Zero size is OK. */
-                            CRYPTO_SignatureVerificationUpdate( pvSigVerifyContext, pucBuf, ulBytesRead );
-                        } while( ulBytesRead > 0UL );
-
-                        if( pdFALSE == CRYPTO_SignatureVerificationFinal( pvSigVerifyContext,
-                                                                          ( char * ) pucSignerCert,
-                                                                          ( size_t ) ulSignerCertSize,
-                                                                          C->pxSignature->ucData,
-                                                                          C->pxSignature->usSize ) ) /*lint !e732 !e9034 Allow comparison in this context. */
+                            do
+                            {
+                                ulBytesRead = fread( pucBuf, 1, OTA_PAL_WIN_BUF_SIZE, C->pxFile ); /*lint !e586
+                                                                                                   * C standard library call is being used for portability. */
+                                /* Include the file chunk in the signature validation. Zero size is OK. */
+                                CRYPTO_SignatureVerificationUpdate( pvSigVerifyContext, pucBuf, ulBytesRead );
+                            } while( ulBytesRead > 0UL );
+
+                            xFileHashed = pdTRUE;
+                        }
+                        else
                         {
+                            OTA_LOG_L1( "[%s] ERROR - Failed to rewind the received file.\r\n", OTA_METHOD_NAME );
                             eResult = kOTA_Err_SignatureCheckFailed;
                         }
-						pvSigVerifyContext = NULL;	/* The context has been freed by CRYPTO_SignatureVerificationFinal(). */
+
+                        /* Free the temporary file page buffer. */
+                        vPortFree( pucBuf );
                     }
                     else
                     {
-                        /* Nothing special to do. */
+                        OTA_LOG_L1( "[%s] ERROR - Failed to allocate buffer memory.\r\n", OTA_METHOD_NAME );
+                        eResult = kOTA_Err_OutOfMemory;
                     }
-
-                    /* Free the temporary file page buffer. */
-                    vPortFree( pucBuf );
                 }
-                else
+
+                if( xFileHashed == pdTRUE )
                 {
-                    OTA_LOG_L1( "[%s] ERROR - Failed to allocate buffer memory.\r\n", OTA_METHOD_NAME );
-                    eResult = kOTA_Err_OutOfMemory;
+                    if( pdFALSE == CRYPTO_SignatureVerificationFinal( pvSigVerifyContext,
+                                                                      ( char * ) pucSignerCert,
+                                                                      ( size_t ) ulSignerCertSize,
+                                                                      C->pxSignature->ucData,
+                                                                      C->pxSignature->usSize ) ) /*lint !e732 !e9034 Allow comparison in this context. */
+                    {
+                        eResult = kOTA_Err_SignatureCheckFailed;
+                    }
+                    pvSigVerifyContext = NULL;	/* The context has been freed by CRYPTO_SignatureVerificationFinal(). */
                 }
 
                 /* Free the signer certificate that we now own after prvReadAndAssumeCertificate(). */
@@ -327,6 +361,12 @@ static OTA_Err_t prvPAL_CheckFileSignature( OTA_FileContext_t * const C )
             {
                 eResult = kOTA_Err_BadSignerCert;
             }
+
+            if( pvSigVerifyContext != NULL )
+            {
+                /* Free the verification context when the check did not run to completion. */
+                ( void ) CRYPTO_SignatureVerificationFinal( pvSigVerifyContext, NULL, 0, NULL, 0 );
+            }
         }
     }
     else
@@ -441,6 +481,208 @@ static uint8_t * prvPAL_ReadAndAssumeCertificate( const uint8_t * const pucCertN
 
 /*-----------------------------------------------------------*/
 
+#if ( OTA_RESUMABLE_DOWNLOAD == 1 )
+
+/* The download state is kept next to the file being received, in "<file path>.state". */
+    static char * prvPAL_GetRxStatePath( const OTA_FileContext_t * const C )
+    {
+        static const char cStateSuffix[] = ".state";
+        char * pcStatePath = NULL;
+        size_t xPathLen;
+
+        if( ( C != NULL ) && ( C->pucFilePath != NULL ) )
+        {
+            xPathLen = strlen( ( const char * ) C->pucFilePath );
+            pcStatePath = pvPortMalloc( xPathLen + sizeof( cStateSuffix ) );
+
+            if( pcStatePath != NULL )
+            {
+                ( void ) memcpy( pcStatePath, C->pucFilePath, xPathLen );
+                ( void ) memcpy( &pcStatePath[ xPathLen ], cStateSuffix, sizeof( cStateSuffix ) );
+            }
+        }
+
+        return pcStatePath;
+    }
+
+/*-----------------------------------------------------------*/
+
+    OTA_Err_t prvPAL_ResumeFileForRx( OTA_FileContext_t * const C )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvPAL_ResumeFileForRx" );
+
+        OTA_Err_t eResult = kOTA_Err_RxFileCreateFailed;
+        long lFileSize;
+
+        if( ( C != NULL ) && ( C->pucFilePath != NULL ) )
+        {
+            /* Open the partial file without truncating it. */
+            C->pxFile = fopen( ( const char * ) C->pucFilePath, "r+b" ); /*lint !e586
+                                                                           * C standard library call is being used for portability. */
+
+            if( C->pxFile != NULL )
+            {
+                if( fseek( C->pxFile, 0L, SEEK_END ) == 0 )
+                {
+                    lFileSize = ftell( C->pxFile );
+
+                    /* A file larger than the one being received was not written by this download. A compressed
+                     * file is written out decompressed, so its size on disk is not bounded by C->ulFileSize. */
+                    if( ( lFileSize >= 0L ) &&
+                        ( ( C->ulCompression != OTA_COMPRESSION_NONE ) || ( ( uint32_t ) lFileSize <= C->ulFileSize ) ) )
+                    {
+                        eResult = kOTA_Err_None;
+                        OTA_LOG_L1( "[%s] Receive file reopened.\r\n", OTA_METHOD_NAME );
+                    }
+                }
+
+                if( eResult != kOTA_Err_None )
+                {
+                    ( void ) fclose( C->pxFile ); /*lint !e586
+                                                   * C standard library call is being used for portability. */
+                    C->pxFile = NULL;
+                }
+            }
+        }
+
+        return eResult; /*lint !e480 !e481 Exiting function without calling fclose.
+                         * Context file handle state is managed by this API. */
+    }
+
+/*-----------------------------------------------------------*/
+
+    OTA_Err_t prvPAL_SaveRxState( OTA_FileContext_t * const C,
+                                  const uint8_t * pucState,
+                                  uint32_t ulStateSize )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvPAL_SaveRxState" );
+
+        OTA_Err_t eResult = kOTA_Err_FileClose;
+        char * pcStatePath = prvPAL_GetRxStatePath( C );
+        FILE * pxStateFile;
+
+        if( pcStatePath != NULL )
+        {
+            if( pucState == NULL )
+            {
+                /* Nothing to resume any more. It is fine if there was no state to erase. */
+                ( void ) remove( pcStatePath ); /*lint !e586
+                                                 * C standard library call is being used for portability. */
+                eResult = kOTA_Err_None;
+            }
+            /* The bitmap must never claim blocks that are still only in the stdio buffer. */
+            else if( ( C->pxFile != NULL ) && ( fflush( C->pxFile ) != 0 ) )
+            {
+                OTA_LOG_L1( "[%s] ERROR - Failed to flush the receive file.\r\n", OTA_METHOD_NAME );
+            }
+            else
+            {
+                pxStateFile = fopen( pcStatePath, "wb" ); /*lint !e586
+                                                           * C standard library call is being used for portability. */
+
+                if( pxStateFile != NULL )
+                {
+                    if( fwrite( pucState, 1, ulStateSize, pxStateFile ) == ulStateSize )
+                    {
+                        eResult = kOTA_Err_None;
+                    }
+
+                    if( fclose( pxStateFile ) != 0 ) /*lint !e586
+                                                      * C standard library call is being used for portability. */
+                    {
+                        eResult = kOTA_Err_FileClose;
+                    }
+                }
+            }
+
+            vPortFree( pcStatePath );
+        }
+
+        return eResult;
+    }
+
+/*-----------------------------------------------------------*/
+
+    uint32_t prvPAL_LoadRxState( OTA_FileContext_t * const C,
+                                 uint8_t * pucState,
+                                 uint32_t ulMaxStateSize )
+    {
+        uint32_t ulStateSize = 0;
+        char * pcStatePath = prvPAL_GetRxStatePath( C );
+        FILE * pxStateFile;
+
+        if( pcStatePath != NULL )
+        {
+            pxStateFile = fopen( pcStatePath, "rb" ); /*lint !e586
+                                                       * C standard library call is being used for portability. */
+
+            if( pxStateFile != NULL )
+            {
+                ulStateSize = ( uint32_t ) fread( pucState, 1, ulMaxStateSize, pxStateFile );
+                ( void ) fclose( pxStateFile ); /*lint !e586
+                                                 * C standard library call is being used for portability. */
+            }
+
+            vPortFree( pcStatePath );
+        }
+
+        return ulStateSize;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( OTA_RESUMABLE_DOWNLOAD == 1 ) */
+
+#if ( OTA_DELTA_UPDATE == 1 )
+
+/* The running image of the Windows simulator is its own executable. */
+    int16_t prvPAL_ReadBaseImage( OTA_FileContext_t * const C,
+                                  uint32_t ulOffset,
+                                  uint8_t * const pacData,
+                                  uint32_t ulBlockSize )
+    {
+        DEFINE_OTA_METHOD_NAME( "prvPAL_ReadBaseImage" );
+
+        char cImagePath[ MAX_PATH ];
+        DWORD xPathLen;
+        FILE * pxImage;
+        int16_t sBytesRead = -1;
+
+        ( void ) C;
+
+        xPathLen = GetModuleFileNameA( NULL, cImagePath, sizeof( cImagePath ) );
+
+        if( ( xPathLen > 0U ) && ( xPathLen < sizeof( cImagePath ) ) )
+        {
+            pxImage = fopen( cImagePath, "rb" ); /*lint !e586
+                                                  * C standard library call is being used for portability. */
+
+            if( pxImage != NULL )
+            {
+                if( fseek( pxImage, ( long ) ulOffset, SEEK_SET ) == 0 ) /*lint !e586
+                                                                          * C standard library call is being used for portability. */
+                {
+                    sBytesRead = ( int16_t ) fread( pacData, 1, ulBlockSize, pxImage ); /*lint !e586
+                                                                                        * C standard library call is being used for portability. */
+                }
+
+                ( void ) fclose( pxImage ); /*lint !e586
+                                             * C standard library call is being used for portability. */
+            }
+        }
+
+        if( sBytesRead < 0 )
+        {
+            OTA_LOG_L1( "[%s] ERROR - Failed to read the running image at offset %u.\r\n", OTA_METHOD_NAME, ulOffset );
+        }
+
+        return sBytesRead;
+    }
+
+/*-----------------------------------------------------------*/
+
+#endif /* if ( OTA_DELTA_UPDATE == 1 ) */
+
 OTA_Err_t prvPAL_ResetDevice( void )
 {
     /* Return no error.  Windows implementation does not reset device. */
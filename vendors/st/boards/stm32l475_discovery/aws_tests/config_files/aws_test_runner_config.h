@@ -52,6 +52,7 @@
 #define testrunnerFULL_WIFI_ENABLED                0
 #define testrunnerFULL_MEMORYLEAK_ENABLED          0
 #define testrunnerFULL_TLS_ENABLED                 0
+#define testrunnerFULL_TLS_PARALLEL_ENABLED        0
 #define testrunnerFULL_POSIX_ENABLED               0
 #define testrunnerFULL_HTTPS_CLIENT_ENABLED        0
 #define testrunnerFULL_COMMON_IO_ENABLED           0